@@ -6,6 +6,12 @@
 #include "AppState_Benchmark01.h"
 #include "AppState_Benchmark02.h"
 #include "AppState_Benchmark03.h"
+#include "AppState_Benchmark04.h"
+#include "AppState_Benchmark06.h"
+#include "AppState_Benchmark07.h"
+#include "AppState_Benchmark08.h"
+#include "AppState_Benchmark09.h"
+#include "AppState_Benchmark10.h"
 #include "AppState_MainScreen.h"
 #include "AppState_ResultScreen.h"
 
@@ -22,6 +28,17 @@ AppStateManager::AppStateManager(Context* context)
     appStates_.Insert({APPSTATEID_BENCHMARK01, MakeShared<AppState_Benchmark01>(context_)});
     appStates_.Insert({APPSTATEID_BENCHMARK02, MakeShared<AppState_Benchmark02>(context_)});
     appStates_.Insert({APPSTATEID_BENCHMARK03, MakeShared<AppState_Benchmark03>(context_)});
+    appStates_.Insert({APPSTATEID_BENCHMARK04, MakeShared<AppState_Benchmark04>(context_, false)});
+    appStates_.Insert({APPSTATEID_BENCHMARK05, MakeShared<AppState_Benchmark04>(context_, true)});
+#ifdef URHO3D_PHYSICS2D
+    appStates_.Insert({APPSTATEID_BENCHMARK06, MakeShared<AppState_Benchmark06>(context_)});
+#endif
+    appStates_.Insert({APPSTATEID_BENCHMARK07, MakeShared<AppState_Benchmark07>(context_)});
+#ifdef URHO3D_URHO2D
+    appStates_.Insert({APPSTATEID_BENCHMARK08, MakeShared<AppState_Benchmark08>(context_)});
+#endif
+    appStates_.Insert({APPSTATEID_BENCHMARK09, MakeShared<AppState_Benchmark09>(context_)});
+    appStates_.Insert({APPSTATEID_BENCHMARK10, MakeShared<AppState_Benchmark10>(context_)});
 }
 
 void AppStateManager::Apply()
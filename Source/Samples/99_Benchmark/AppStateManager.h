@@ -15,6 +15,13 @@ inline constexpr AppStateId APPSTATEID_RESULTSCREEN = 2;
 inline constexpr AppStateId APPSTATEID_BENCHMARK01 = 3;
 inline constexpr AppStateId APPSTATEID_BENCHMARK02 = 4;
 inline constexpr AppStateId APPSTATEID_BENCHMARK03 = 5;
+inline constexpr AppStateId APPSTATEID_BENCHMARK04 = 6;
+inline constexpr AppStateId APPSTATEID_BENCHMARK05 = 7;
+inline constexpr AppStateId APPSTATEID_BENCHMARK06 = 8;
+inline constexpr AppStateId APPSTATEID_BENCHMARK07 = 9;
+inline constexpr AppStateId APPSTATEID_BENCHMARK08 = 10;
+inline constexpr AppStateId APPSTATEID_BENCHMARK09 = 11;
+inline constexpr AppStateId APPSTATEID_BENCHMARK10 = 12;
 
 class AppStateManager : public U3D::Object
 {
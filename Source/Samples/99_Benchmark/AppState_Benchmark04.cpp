@@ -0,0 +1,225 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "AppState_Benchmark04.h"
+#include "AppStateManager.h"
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/GraphicsAPI/IndexBuffer.h>
+#include <Urho3D/GraphicsAPI/VertexBuffer.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/SceneEvents.h>
+#include <Urho3D/UI/Text.h>
+#include <Urho3D/UI/UI.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static const String LOAD_STATS_STR = "Load Stats";
+
+// 512 x 512 vertices with position, normal, UV and tangent, about 19 MB of vertex and index data
+static constexpr i32 GRID_SIZE = 512;
+
+void AppState_Benchmark04::OnEnter()
+{
+    assert(!scene_);
+    scene_ = new Scene(context_);
+    scene_->CreateComponent<Octree>();
+
+    Node* zoneNode = scene_->CreateChild();
+    Zone* zone = zoneNode->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(-1000.f, 1000.f));
+    zone->SetAmbientColor(Color(0.5f, 0.5f, 0.5f));
+    zone->SetFogColor(Color(0.3f, 0.6f, 0.9f));
+    zone->SetFogStart(10000.f);
+    zone->SetFogEnd(10000.f);
+
+    Node* lightNode = scene_->CreateChild();
+    lightNode->SetRotation(Quaternion(45.f, 45.f, 0.f));
+    Light* light = lightNode->CreateComponent<Light>();
+    light->SetLightType(LIGHT_DIRECTIONAL);
+
+    Node* cameraNode = scene_->CreateChild("Camera");
+    cameraNode->SetPosition(Vector3(0.f, 6.f, -9.f));
+    cameraNode->SetRotation(Quaternion(35.f, 0.f, 0.f));
+    cameraNode->CreateComponent<Camera>();
+
+    // Keep the file in memory, so that only parsing and buffer creation are measured
+    SharedPtr<Model> model = CreateGridModel();
+    VectorBuffer saved;
+    if (packed_)
+        model->SavePacked(saved);
+    else
+        model->Save(saved);
+    modelData_ = saved.GetBuffer();
+
+    Node* modelNode = scene_->CreateChild();
+    staticModel_ = modelNode->CreateComponent<StaticModel>();
+    staticModel_->SetModel(model);
+    staticModel_->SetMaterial(GetSubsystem<ResourceCache>()->GetResource<Material>("Materials/StoneTiled.xml"));
+
+    numLoads_ = 0;
+    beginLoadUSec_ = 0;
+    endLoadUSec_ = 0;
+    peakMemory_ = 0;
+    retainedMemory_ = 0;
+
+    Text* statsElement = GetSubsystem<UI>()->GetRoot()->CreateChild<Text>(LOAD_STATS_STR);
+    statsElement->SetStyleAuto();
+    statsElement->SetTextEffect(TE_SHADOW);
+    statsElement->SetPosition(10, 30);
+
+    GetSubsystem<Input>()->SetMouseVisible(false);
+    SetupViewport();
+    SubscribeToEvent(scene_, E_SCENEUPDATE, URHO3D_HANDLER(AppState_Benchmark04, HandleSceneUpdate));
+    fpsCounter_.Clear();
+}
+
+void AppState_Benchmark04::OnLeave()
+{
+    if (numLoads_)
+        URHO3D_LOGINFO(name_ + ": " + GetLoadStats());
+
+    UIElement* statsElement = GetSubsystem<UI>()->GetRoot()->GetChild(LOAD_STATS_STR);
+    if (statsElement)
+        statsElement->Remove();
+
+    DestroyViewport();
+    scene_ = nullptr;
+    modelData_.Clear();
+}
+
+SharedPtr<Model> AppState_Benchmark04::CreateGridModel()
+{
+    // Rolling hills, so that the surface is lit and the normals and tangents are not all the same
+    constexpr float SPACING = 16.f / (GRID_SIZE - 1);
+    Vector<float> vertexData;
+    vertexData.Reserve(GRID_SIZE * GRID_SIZE * 12);
+    for (i32 z = 0; z < GRID_SIZE; ++z)
+    {
+        for (i32 x = 0; x < GRID_SIZE; ++x)
+        {
+            float posX = x * SPACING - 8.f;
+            float posZ = z * SPACING - 8.f;
+            float height = 0.5f * Sin(posX * 90.f) * Cos(posZ * 90.f);
+            float slopeX = 0.5f * 90.f * M_DEGTORAD * Cos(posX * 90.f) * Cos(posZ * 90.f);
+            float slopeZ = -0.5f * 90.f * M_DEGTORAD * Sin(posX * 90.f) * Sin(posZ * 90.f);
+            Vector3 normal = Vector3(-slopeX, 1.f, -slopeZ).Normalized();
+            Vector3 tangent = Vector3(1.f, slopeX, 0.f).Normalized();
+
+            vertexData.Push(posX);
+            vertexData.Push(height);
+            vertexData.Push(posZ);
+            vertexData.Push(normal.x_);
+            vertexData.Push(normal.y_);
+            vertexData.Push(normal.z_);
+            vertexData.Push(x * 0.1f);
+            vertexData.Push(z * 0.1f);
+            vertexData.Push(tangent.x_);
+            vertexData.Push(tangent.y_);
+            vertexData.Push(tangent.z_);
+            vertexData.Push(1.f);
+        }
+    }
+
+    Vector<u32> indexData;
+    indexData.Reserve((GRID_SIZE - 1) * (GRID_SIZE - 1) * 6);
+    for (i32 z = 0; z < GRID_SIZE - 1; ++z)
+    {
+        for (i32 x = 0; x < GRID_SIZE - 1; ++x)
+        {
+            u32 i = z * GRID_SIZE + x;
+            indexData.Push(i);
+            indexData.Push(i + GRID_SIZE);
+            indexData.Push(i + 1);
+            indexData.Push(i + 1);
+            indexData.Push(i + GRID_SIZE);
+            indexData.Push(i + GRID_SIZE + 1);
+        }
+    }
+
+    // Buffers must be shadowed to be saved
+    SharedPtr<VertexBuffer> vb = MakeShared<VertexBuffer>(context_);
+    vb->SetShadowed(true);
+    vb->SetSize(GRID_SIZE * GRID_SIZE, VertexElements::Position | VertexElements::Normal | VertexElements::TexCoord1 |
+        VertexElements::Tangent);
+    vb->SetData(vertexData.Buffer());
+
+    SharedPtr<IndexBuffer> ib = MakeShared<IndexBuffer>(context_);
+    ib->SetShadowed(true);
+    ib->SetSize(indexData.Size(), true);
+    ib->SetData(indexData.Buffer());
+
+    SharedPtr<Geometry> geometry = MakeShared<Geometry>(context_);
+    geometry->SetVertexBuffer(0, vb);
+    geometry->SetIndexBuffer(ib);
+    geometry->SetDrawRange(TRIANGLE_LIST, 0, indexData.Size());
+
+    SharedPtr<Model> model = MakeShared<Model>(context_);
+    model->SetNumGeometries(1);
+    model->SetGeometry(0, 0, geometry);
+    model->SetBoundingBox(BoundingBox(Vector3(-8.f, -0.5f, -8.f), Vector3(8.f, 0.5f, 8.f)));
+    model->SetVertexBuffers({vb}, {0}, {0});
+    model->SetIndexBuffers({ib});
+    return model;
+}
+
+String AppState_Benchmark04::GetLoadStats() const
+{
+    return ToString("BeginLoad %.2f ms, EndLoad %.2f ms, peak memory %d KB, retained memory %d KB",
+        beginLoadUSec_ / (numLoads_ * 1000.0), endLoadUSec_ / (numLoads_ * 1000.0), peakMemory_ / 1024,
+        retainedMemory_ / 1024);
+}
+
+void AppState_Benchmark04::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+
+    fpsCounter_.Update(timeStep);
+    UpdateCurrentFpsElement();
+
+    if (GetSubsystem<Input>()->GetKeyDown(KEY_ESCAPE))
+    {
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_MAINSCREEN);
+        return;
+    }
+
+    // Load the way the resource cache loads in the background: BeginLoad() stages the data and EndLoad() uploads it.
+    // The staged data and the loaded model coexist at the end of EndLoad(), which is the peak
+    SharedPtr<Model> model = MakeShared<Model>(context_);
+    MemoryBuffer source(modelData_);
+    HiresTimer timer;
+    model->SetAsyncLoadState(ASYNC_LOADING);
+    model->BeginLoad(source);
+    beginLoadUSec_ += timer.GetUSec(true);
+    i32 stagedMemory = model->GetLoadDataSize();
+    model->EndLoad();
+    endLoadUSec_ += timer.GetUSec(false);
+    model->SetAsyncLoadState(ASYNC_DONE);
+
+    ++numLoads_;
+    retainedMemory_ = model->GetMemoryUse();
+    peakMemory_ = Max(peakMemory_, stagedMemory + retainedMemory_);
+
+    // Show the model that was loaded last
+    staticModel_->SetModel(model);
+
+    Text* statsElement = GetSubsystem<UI>()->GetRoot()->GetChildStaticCast<Text>(LOAD_STATS_STR);
+    statsElement->SetText(GetLoadStats());
+
+    if (fpsCounter_.GetTotalTime() >= 30.f)
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_RESULTSCREEN);
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "AppState_Base.h"
+
+#include <Urho3D/Graphics/StaticModel.h>
+
+// Loading a large generated model from memory every frame, in either the regular or the packed format.
+// BeginLoad() and EndLoad() are timed separately, and the CPU memory held during and after loading is reported
+class AppState_Benchmark04 : public AppState_Base
+{
+public:
+    URHO3D_OBJECT(AppState_Benchmark04, AppState_Base);
+
+private:
+    bool packed_;
+    U3D::Vector<byte> modelData_;
+    U3D::WeakPtr<U3D::StaticModel> staticModel_;
+
+    i32 numLoads_ = 0;
+    long long beginLoadUSec_ = 0;
+    long long endLoadUSec_ = 0;
+    i32 peakMemory_ = 0;
+    i32 retainedMemory_ = 0;
+
+public:
+    AppState_Benchmark04(U3D::Context* context, bool packed)
+        : AppState_Base(context)
+        , packed_(packed)
+    {
+        name_ = packed ? "Packed Model Loading" : "Model Loading";
+    }
+
+    void OnEnter() override;
+    void OnLeave() override;
+
+    U3D::SharedPtr<U3D::Model> CreateGridModel();
+    U3D::String GetLoadStats() const;
+
+    void HandleSceneUpdate(U3D::StringHash eventType, U3D::VariantMap& eventData);
+};
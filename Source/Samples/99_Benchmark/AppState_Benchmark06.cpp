@@ -0,0 +1,163 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#ifdef URHO3D_PHYSICS2D
+
+#include "AppState_Benchmark06.h"
+#include "AppStateManager.h"
+
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/Physics2D/CollisionBox2D.h>
+#include <Urho3D/Physics2D/CollisionCircle2D.h>
+#include <Urho3D/Physics2D/PhysicsEvents2D.h>
+#include <Urho3D/Physics2D/PhysicsWorld2D.h>
+#include <Urho3D/Physics2D/RigidBody2D.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/SceneEvents.h>
+#include <Urho3D/Urho2D/Sprite2D.h>
+#include <Urho3D/Urho2D/StaticSprite2D.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static constexpr i32 NUM_BODIES = 2000;
+static constexpr i32 NUM_RESPAWNS = 20;
+static constexpr float BIN_HALF_WIDTH = 8.f;
+
+void AppState_Benchmark06::OnEnter()
+{
+    assert(!scene_);
+    scene_ = new Scene(context_);
+    scene_->CreateComponent<Octree>();
+    PhysicsWorld2D* physicsWorld = scene_->CreateComponent<PhysicsWorld2D>();
+
+    Node* zoneNode = scene_->CreateChild();
+    Zone* zone = zoneNode->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(-1000.f, 1000.f));
+    zone->SetFogColor(Color(0.3f, 0.6f, 0.9f));
+    zone->SetFogStart(10000.f);
+    zone->SetFogEnd(10000.f);
+
+    Node* cameraNode = scene_->CreateChild("Camera");
+    cameraNode->SetPosition(Vector3(0.f, 7.f, -10.f));
+    Camera* camera = cameraNode->CreateComponent<Camera>();
+    camera->SetOrthographic(true);
+    camera->SetOrthoSize(18.f);
+
+    // Bin made of the ground and two walls
+    Sprite2D* boxSprite = GetSubsystem<ResourceCache>()->GetResource<Sprite2D>("Urho2D/Box.png");
+    const Vector3 wallPositions[] = {{0.f, -0.5f, 0.f}, {-BIN_HALF_WIDTH, 7.f, 0.f}, {BIN_HALF_WIDTH, 7.f, 0.f}};
+    const Vector3 wallScales[] = {{2.f * BIN_HALF_WIDTH / 0.32f, 1.f, 1.f}, {1.f, 15.f / 0.32f, 1.f}, {1.f, 15.f / 0.32f, 1.f}};
+    for (i32 i = 0; i < 3; ++i)
+    {
+        Node* wallNode = scene_->CreateChild();
+        wallNode->SetPosition(wallPositions[i]);
+        wallNode->SetScale(wallScales[i]);
+        wallNode->CreateComponent<RigidBody2D>();
+        wallNode->CreateComponent<StaticSprite2D>()->SetSprite(boxSprite);
+        wallNode->CreateComponent<CollisionBox2D>()->SetSize(Vector2(0.32f, 0.32f));
+    }
+
+    SetRandomSeed(1);
+    bodyNodes_.Clear();
+    for (i32 i = 0; i < NUM_BODIES; ++i)
+        CreateBody(Vector2(Random(-BIN_HALF_WIDTH + 0.5f, BIN_HALF_WIDTH - 0.5f), 1.f + i * 0.02f), i % 2 == 1);
+
+    respawnTimer_ = 0.f;
+    numContacts_ = 0;
+
+    GetSubsystem<Input>()->SetMouseVisible(false);
+    SetupViewport();
+    SubscribeToEvent(scene_, E_SCENEUPDATE, URHO3D_HANDLER(AppState_Benchmark06, HandleSceneUpdate));
+    SubscribeToEvent(physicsWorld, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(AppState_Benchmark06, HandlePhysicsPostStep));
+    fpsCounter_.Clear();
+}
+
+void AppState_Benchmark06::OnLeave()
+{
+    DestroyViewport();
+    bodyNodes_.Clear();
+    scene_ = nullptr;
+}
+
+void AppState_Benchmark06::CreateBody(const Vector2& pos, bool ball)
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+
+    Node* node = scene_->CreateChild();
+    node->SetPosition2D(pos);
+
+    RigidBody2D* body = node->CreateComponent<RigidBody2D>();
+    body->SetBodyType(BT_DYNAMIC);
+
+    StaticSprite2D* sprite = node->CreateComponent<StaticSprite2D>();
+
+    if (ball)
+    {
+        sprite->SetSprite(cache->GetResource<Sprite2D>("Urho2D/Ball.png"));
+        CollisionCircle2D* circle = node->CreateComponent<CollisionCircle2D>();
+        circle->SetRadius(0.16f);
+        circle->SetDensity(1.f);
+        circle->SetFriction(0.5f);
+        circle->SetRestitution(0.1f);
+    }
+    else
+    {
+        sprite->SetSprite(cache->GetResource<Sprite2D>("Urho2D/Box.png"));
+        CollisionBox2D* box = node->CreateComponent<CollisionBox2D>();
+        box->SetSize(Vector2(0.32f, 0.32f));
+        box->SetDensity(1.f);
+        box->SetFriction(0.5f);
+        box->SetRestitution(0.1f);
+    }
+
+    bodyNodes_.Push(WeakPtr<Node>(node));
+}
+
+void AppState_Benchmark06::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+
+    fpsCounter_.Update(timeStep);
+    UpdateCurrentFpsElement();
+
+    if (GetSubsystem<Input>()->GetKeyDown(KEY_ESCAPE))
+    {
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_MAINSCREEN);
+        return;
+    }
+
+    // Keep the pile moving: drop bodies from the bottom of the pile back in at the top
+    respawnTimer_ += timeStep;
+    if (respawnTimer_ >= 0.25f)
+    {
+        respawnTimer_ = 0.f;
+        for (i32 i = 0; i < NUM_RESPAWNS; ++i)
+        {
+            WeakPtr<Node> node = bodyNodes_[0];
+            bodyNodes_.Erase(0);
+            if (node)
+                node->Remove();
+            CreateBody(Vector2(Random(-BIN_HALF_WIDTH + 0.5f, BIN_HALF_WIDTH - 0.5f), 14.f), i % 2 == 1);
+        }
+    }
+
+    if (fpsCounter_.GetTotalTime() >= 30.f)
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_RESULTSCREEN);
+}
+
+void AppState_Benchmark06::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+{
+    // Process all contacts of the step at once instead of subscribing to per-contact events
+    PhysicsWorld2D* physicsWorld = scene_->GetComponent<PhysicsWorld2D>();
+    for (const PhysicsWorld2D::ContactInfo& contact : physicsWorld->GetBeginContacts())
+        numContacts_ += contact.numPoints_;
+    for (const PhysicsWorld2D::ContactInfo& contact : physicsWorld->GetEndContacts())
+        numContacts_ -= contact.numPoints_;
+}
+
+#endif // URHO3D_PHYSICS2D
@@ -0,0 +1,33 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "AppState_Base.h"
+
+// Many 2D rigid bodies piling up in a box, contacts are processed once per step
+class AppState_Benchmark06 : public AppState_Base
+{
+public:
+    URHO3D_OBJECT(AppState_Benchmark06, AppState_Base);
+
+private:
+    U3D::Vector<U3D::WeakPtr<U3D::Node>> bodyNodes_;
+    float respawnTimer_ = 0.f;
+    i32 numContacts_ = 0;
+
+public:
+    AppState_Benchmark06(U3D::Context* context)
+        : AppState_Base(context)
+    {
+        name_ = "2D Physics Contacts";
+    }
+
+    void OnEnter() override;
+    void OnLeave() override;
+
+    void CreateBody(const U3D::Vector2& pos, bool ball);
+
+    void HandleSceneUpdate(U3D::StringHash eventType, U3D::VariantMap& eventData);
+    void HandlePhysicsPostStep(U3D::StringHash eventType, U3D::VariantMap& eventData);
+};
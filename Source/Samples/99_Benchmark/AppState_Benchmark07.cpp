@@ -0,0 +1,106 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "AppState_Benchmark07.h"
+#include "AppStateManager.h"
+
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+// Per thread, including the main thread
+static constexpr i32 NUM_THREAD_MESSAGES = 500;
+
+void AppState_Benchmark07::OnEnter()
+{
+    assert(!scene_);
+    scene_ = new Scene(context_);
+    scene_->CreateComponent<Octree>();
+
+    Node* zoneNode = scene_->CreateChild();
+    Zone* zone = zoneNode->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(-1000.f, 1000.f));
+    zone->SetFogColor(Color(0.3f, 0.6f, 0.9f));
+
+    Node* cameraNode = scene_->CreateChild("Camera");
+    cameraNode->CreateComponent<Camera>();
+
+    // Messages go to the log file only, so that the console does not dominate the result
+    Log* log = GetSubsystem<Log>();
+    if (log)
+    {
+        oldAsync_ = log->IsAsync();
+        oldQuiet_ = log->IsQuiet();
+        oldLevel_ = log->GetLevel();
+        log->SetLevel(LOG_INFO);
+        log->SetQuiet(true);
+        log->SetAsync(true);
+    }
+
+    frameNumber_ = 0;
+    messageNumbers_.Resize((GetSubsystem<WorkQueue>()->GetNumThreads() + 1) * NUM_THREAD_MESSAGES);
+    for (i32 i = 0; i < messageNumbers_.Size(); ++i)
+        messageNumbers_[i] = i;
+
+    GetSubsystem<Input>()->SetMouseVisible(false);
+    SetupViewport();
+    SubscribeToEvent(scene_, E_SCENEUPDATE, URHO3D_HANDLER(AppState_Benchmark07, HandleSceneUpdate));
+    fpsCounter_.Clear();
+}
+
+void AppState_Benchmark07::OnLeave()
+{
+    Log* log = GetSubsystem<Log>();
+    if (log)
+    {
+        log->SetAsync(oldAsync_);
+        log->SetQuiet(oldQuiet_);
+        log->SetLevel(oldLevel_);
+    }
+
+    DestroyViewport();
+    scene_ = nullptr;
+}
+
+void AppState_Benchmark07::LogMessagesWork(const WorkItem* item, i32 threadIndex)
+{
+    auto* state = reinterpret_cast<AppState_Benchmark07*>(item->aux_);
+    auto* start = reinterpret_cast<i32*>(item->start_);
+    auto* end = reinterpret_cast<i32*>(item->end_);
+    for (i32* number = start; number != end; ++number)
+    {
+        URHO3D_LOGINFOF("Thread %d frame %d message %d value %f name %s", threadIndex, state->frameNumber_, *number,
+            *number * 0.5f, state->name_.CString());
+    }
+}
+
+void AppState_Benchmark07::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+
+    fpsCounter_.Update(timeStep);
+    UpdateCurrentFpsElement();
+
+    if (GetSubsystem<Input>()->GetKeyDown(KEY_ESCAPE))
+    {
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_MAINSCREEN);
+        return;
+    }
+
+    ++frameNumber_;
+
+    // The main thread logs its share while completing the work
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    queue->RunParallel(LogMessagesWork, messageNumbers_.Buffer(), messageNumbers_.Size(), 0, this);
+
+    if (fpsCounter_.GetTotalTime() >= 30.f)
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_RESULTSCREEN);
+}
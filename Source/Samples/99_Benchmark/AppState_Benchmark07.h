@@ -0,0 +1,40 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "AppState_Base.h"
+
+namespace Urho3D
+{
+struct WorkItem;
+}
+
+// Formatted log messages from the main thread and the worker threads every frame, written by the background log writer
+class AppState_Benchmark07 : public AppState_Base
+{
+public:
+    URHO3D_OBJECT(AppState_Benchmark07, AppState_Base);
+
+private:
+    bool oldAsync_ = false;
+    bool oldQuiet_ = false;
+    int oldLevel_ = 0;
+    i32 frameNumber_ = 0;
+    // Numbers of the messages logged every frame, split into one range per thread
+    U3D::Vector<i32> messageNumbers_;
+
+public:
+    AppState_Benchmark07(U3D::Context* context)
+        : AppState_Base(context)
+    {
+        name_ = "Log Throughput";
+    }
+
+    void OnEnter() override;
+    void OnLeave() override;
+
+    static void LogMessagesWork(const U3D::WorkItem* item, i32 threadIndex);
+
+    void HandleSceneUpdate(U3D::StringHash eventType, U3D::VariantMap& eventData);
+};
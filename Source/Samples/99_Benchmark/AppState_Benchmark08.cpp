@@ -0,0 +1,185 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#ifdef URHO3D_URHO2D
+
+#include "AppState_Benchmark08.h"
+#include "AppStateManager.h"
+
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/Math/MaxRectsPacker.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/SceneEvents.h>
+#include <Urho3D/Urho2D/Sprite2D.h>
+#include <Urho3D/Urho2D/StaticSprite2D.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static constexpr i32 NUM_IMAGES = 1000;
+static constexpr i32 MIN_PAGE_SIZE = 256;
+static constexpr i32 MAX_PAGE_SIZE = 4096;
+// Size of the box image in pixels
+static constexpr float BOX_SIZE = 32.f;
+
+// One page size to try
+struct PackTrial
+{
+    const Vector<IntVector2>* imageSizes_{};
+    i32 width_{};
+    i32 height_{};
+    Vector<IntRect> rects_;
+    Vector<bool> rotated_;
+    bool packed_{};
+};
+
+void AppState_Benchmark08::OnEnter()
+{
+    assert(!scene_);
+    scene_ = new Scene(context_);
+    scene_->CreateComponent<Octree>();
+
+    Node* zoneNode = scene_->CreateChild();
+    Zone* zone = zoneNode->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(-1000.f, 1000.f));
+    zone->SetFogColor(Color(0.3f, 0.6f, 0.9f));
+    zone->SetFogStart(10000.f);
+    zone->SetFogEnd(10000.f);
+
+    Node* cameraNode = scene_->CreateChild("Camera");
+    cameraNode->SetPosition(Vector3(0.f, 0.f, -10.f));
+    Camera* camera = cameraNode->CreateComponent<Camera>();
+    camera->SetOrthographic(true);
+
+    // Same texture area as the box, marked as stored rotated
+    sprite_ = GetSubsystem<ResourceCache>()->GetResource<Sprite2D>("Urho2D/Box.png");
+    rotatedSprite_ = new Sprite2D(context_);
+    rotatedSprite_->SetTexture(sprite_->GetTexture());
+    rotatedSprite_->SetRectangle(sprite_->GetRectangle());
+    rotatedSprite_->SetRotated(true);
+
+    SetRandomSeed(1);
+    imageSizes_.Clear();
+    for (i32 i = 0; i < NUM_IMAGES; ++i)
+    {
+        // Mostly small images with some long ones, which pack better when rotated
+        i32 width = 8 + Random(56);
+        i32 height = i % 5 ? 8 + Random(56) : 96 + Random(64);
+        imageSizes_.Push(IntVector2(width, height));
+    }
+    Sort(imageSizes_.Begin(), imageSizes_.End(), [](const IntVector2& lhs, const IntVector2& rhs)
+    {
+        i32 lhsSide = Max(lhs.x_, lhs.y_);
+        i32 rhsSide = Max(rhs.x_, rhs.y_);
+        return lhsSide != rhsSide ? lhsSide > rhsSide : lhs.x_ * lhs.y_ > rhs.x_ * rhs.y_;
+    });
+
+    imageNodes_.Clear();
+    for (i32 i = 0; i < NUM_IMAGES; ++i)
+    {
+        Node* node = scene_->CreateChild();
+        StaticSprite2D* staticSprite = node->CreateComponent<StaticSprite2D>();
+        staticSprite->SetSprite(sprite_);
+        staticSprite->SetColor(Color(Random(0.5f, 1.f), Random(0.5f, 1.f), Random(0.5f, 1.f)));
+        imageNodes_.Push(WeakPtr<Node>(node));
+    }
+
+    GetSubsystem<Input>()->SetMouseVisible(false);
+    SetupViewport();
+    SubscribeToEvent(scene_, E_SCENEUPDATE, URHO3D_HANDLER(AppState_Benchmark08, HandleSceneUpdate));
+    fpsCounter_.Clear();
+}
+
+void AppState_Benchmark08::OnLeave()
+{
+    DestroyViewport();
+    imageNodes_.Clear();
+    sprite_ = nullptr;
+    rotatedSprite_ = nullptr;
+    scene_ = nullptr;
+}
+
+void AppState_Benchmark08::PackPageWork(const WorkItem* item, i32 /*threadIndex*/)
+{
+    auto& trial = *reinterpret_cast<PackTrial*>(item->start_);
+    const Vector<IntVector2>& imageSizes = *trial.imageSizes_;
+    trial.rects_.Resize(imageSizes.Size());
+    trial.rotated_.Resize(imageSizes.Size());
+
+    MaxRectsPacker packer(trial.width_, trial.height_, MAXRECTS_BEST_SHORT_SIDE_FIT, true);
+    for (i32 i = 0; i < imageSizes.Size(); ++i)
+    {
+        bool rotated;
+        if (!packer.Insert(imageSizes[i].x_, imageSizes[i].y_, trial.rects_[i], rotated))
+            return;
+        trial.rotated_[i] = rotated;
+    }
+
+    trial.packed_ = true;
+}
+
+void AppState_Benchmark08::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+
+    fpsCounter_.Update(timeStep);
+    UpdateCurrentFpsElement();
+
+    if (GetSubsystem<Input>()->GetKeyDown(KEY_ESCAPE))
+    {
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_MAINSCREEN);
+        return;
+    }
+
+    // Try all page sizes in parallel and take the smallest that holds all images
+    Vector<PackTrial> trials;
+    for (i32 width = MIN_PAGE_SIZE; width <= MAX_PAGE_SIZE; width *= 2)
+    {
+        for (i32 height = MIN_PAGE_SIZE; height <= MAX_PAGE_SIZE; height *= 2)
+        {
+            PackTrial trial;
+            trial.imageSizes_ = &imageSizes_;
+            trial.width_ = width;
+            trial.height_ = height;
+            trials.Push(trial);
+        }
+    }
+
+    GetSubsystem<WorkQueue>()->RunParallel(PackPageWork, trials.Buffer(), trials.Size(), trials.Size());
+
+    const PackTrial* best = nullptr;
+    for (const PackTrial& trial : trials)
+    {
+        if (trial.packed_ && (!best || trial.width_ * trial.height_ < best->width_ * best->height_))
+            best = &trial;
+    }
+
+    if (best)
+    {
+        // Show the page in the middle of the view. Rotated images are turned back by the sprite and by the node
+        Vector2 pageCenter(best->width_ * 0.5f, best->height_ * 0.5f);
+        scene_->GetChild("Camera")->GetComponent<Camera>()->SetOrthoSize(best->height_ * PIXEL_SIZE * 1.1f);
+
+        for (i32 i = 0; i < imageNodes_.Size(); ++i)
+        {
+            Node* node = imageNodes_[i];
+            const IntRect& rect = best->rects_[i];
+            bool rotated = best->rotated_[i];
+            Vector2 center = Vector2(rect.left_ + rect.right_, rect.top_ + rect.bottom_) * 0.5f - pageCenter;
+            node->SetPosition2D(Vector2(center.x_, -center.y_) * PIXEL_SIZE);
+            node->SetRotation2D(rotated ? -90.f : 0.f);
+            node->SetScale2D(Vector2(imageSizes_[i].x_ / BOX_SIZE, imageSizes_[i].y_ / BOX_SIZE));
+            node->GetComponent<StaticSprite2D>()->SetSprite(rotated ? rotatedSprite_ : sprite_);
+        }
+    }
+
+    if (fpsCounter_.GetTotalTime() >= 30.f)
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_RESULTSCREEN);
+}
+
+#endif // def URHO3D_URHO2D
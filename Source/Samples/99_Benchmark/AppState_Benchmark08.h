@@ -0,0 +1,46 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#ifdef URHO3D_URHO2D
+
+#include "AppState_Base.h"
+
+#include <Urho3D/Urho2D/Sprite2D.h>
+
+namespace Urho3D
+{
+struct WorkItem;
+}
+
+// Packing a thousand sprite rectangles with rotation into the smallest page every frame, trying the page sizes in
+// parallel, and drawing the result with rotated sprites
+class AppState_Benchmark08 : public AppState_Base
+{
+public:
+    URHO3D_OBJECT(AppState_Benchmark08, AppState_Base);
+
+private:
+    // Image sizes in pixels, largest first
+    U3D::Vector<U3D::IntVector2> imageSizes_;
+    U3D::Vector<U3D::WeakPtr<U3D::Node>> imageNodes_;
+    U3D::SharedPtr<U3D::Sprite2D> sprite_;
+    U3D::SharedPtr<U3D::Sprite2D> rotatedSprite_;
+
+public:
+    AppState_Benchmark08(U3D::Context* context)
+        : AppState_Base(context)
+    {
+        name_ = "Sprite Packing";
+    }
+
+    void OnEnter() override;
+    void OnLeave() override;
+
+    static void PackPageWork(const U3D::WorkItem* item, i32 threadIndex);
+
+    void HandleSceneUpdate(U3D::StringHash eventType, U3D::VariantMap& eventData);
+};
+
+#endif // def URHO3D_URHO2D
@@ -0,0 +1,113 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "AppState_Benchmark09.h"
+#include "AppStateManager.h"
+
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/Scene/SceneEvents.h>
+#include <Urho3D/UI/UI.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static constexpr i32 NUM_ROWS = 100;
+static constexpr i32 NUM_COLUMNS = 100;
+
+static void AddAttribute(XMLElement& element, const String& name, const String& value)
+{
+    XMLElement attribute = element.CreateChild("attribute");
+    attribute.SetAttribute("name", name);
+    attribute.SetAttribute("value", value);
+}
+
+void AppState_Benchmark09::OnEnter()
+{
+    assert(!scene_);
+    scene_ = new Scene(context_);
+    scene_->CreateComponent<Octree>();
+
+    Node* zoneNode = scene_->CreateChild();
+    Zone* zone = zoneNode->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(-1000.f, 1000.f));
+    zone->SetFogColor(Color(0.3f, 0.6f, 0.9f));
+
+    Node* cameraNode = scene_->CreateChild("Camera");
+    cameraNode->CreateComponent<Camera>();
+
+    // A window with rows of buttons. The button style is based on another style, so applying it nests style loading
+    layout_ = new XMLFile(context_);
+    XMLElement windowElem = layout_->CreateRoot("element");
+    windowElem.SetAttribute("type", "Window");
+    AddAttribute(windowElem, "Position", "10 34");
+    AddAttribute(windowElem, "Layout Mode", "Vertical");
+    AddAttribute(windowElem, "Layout Spacing", "1");
+    AddAttribute(windowElem, "Layout Border", "4 4 4 4");
+
+    for (i32 i = 0; i < NUM_ROWS; ++i)
+    {
+        XMLElement rowElem = windowElem.CreateChild("element");
+        AddAttribute(rowElem, "Layout Mode", "Horizontal");
+        AddAttribute(rowElem, "Layout Spacing", "1");
+
+        for (i32 j = 0; j < NUM_COLUMNS; ++j)
+        {
+            XMLElement buttonElem = rowElem.CreateChild("element");
+            buttonElem.SetAttribute("type", "Button");
+            AddAttribute(buttonElem, "Min Size", "2 4");
+            AddAttribute(buttonElem, "Layout Flex Scale", String(1 + (i + j) % 3) + " 1");
+        }
+    }
+
+    GetSubsystem<Input>()->SetMouseVisible(false);
+    SetupViewport();
+    SubscribeToEvent(scene_, E_SCENEUPDATE, URHO3D_HANDLER(AppState_Benchmark09, HandleSceneUpdate));
+    fpsCounter_.Clear();
+}
+
+void AppState_Benchmark09::OnLeave()
+{
+    if (window_)
+        window_->Remove();
+
+    DestroyViewport();
+    layout_ = nullptr;
+    scene_ = nullptr;
+}
+
+void AppState_Benchmark09::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+
+    fpsCounter_.Update(timeStep);
+    UpdateCurrentFpsElement();
+
+    if (GetSubsystem<Input>()->GetKeyDown(KEY_ESCAPE))
+    {
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_MAINSCREEN);
+        return;
+    }
+
+    // Create all elements again
+    UI* ui = GetSubsystem<UI>();
+    UIElement* root = ui->GetRoot();
+    if (window_)
+        window_->Remove();
+
+    SharedPtr<UIElement> window = ui->LoadLayout(layout_, root->GetDefaultStyle());
+    root->AddChild(window);
+    window_ = window;
+
+    // Then resize the window back and forth, which lays out every row and button again
+    Graphics* graphics = GetSubsystem<Graphics>();
+    float scale = 0.7f + 0.25f * Sin(fpsCounter_.GetTotalTime() * 90.f);
+    window->SetSize((i32)(graphics->GetWidth() * scale), (i32)((graphics->GetHeight() - 44) * scale));
+
+    if (fpsCounter_.GetTotalTime() >= 30.f)
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_RESULTSCREEN);
+}
@@ -0,0 +1,33 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "AppState_Base.h"
+
+#include <Urho3D/Resource/XMLFile.h>
+#include <Urho3D/UI/UIElement.h>
+
+// Loading a styled UI layout of ten thousand elements from XML every frame, and resizing its window so that all of them
+// are laid out again
+class AppState_Benchmark09 : public AppState_Base
+{
+public:
+    URHO3D_OBJECT(AppState_Benchmark09, AppState_Base);
+
+private:
+    U3D::SharedPtr<U3D::XMLFile> layout_;
+    U3D::WeakPtr<U3D::UIElement> window_;
+
+public:
+    AppState_Benchmark09(U3D::Context* context)
+        : AppState_Base(context)
+    {
+        name_ = "UI Layout";
+    }
+
+    void OnEnter() override;
+    void OnLeave() override;
+
+    void HandleSceneUpdate(U3D::StringHash eventType, U3D::VariantMap& eventData);
+};
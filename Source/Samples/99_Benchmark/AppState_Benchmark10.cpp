@@ -0,0 +1,152 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "AppState_Benchmark10.h"
+#include "AppStateManager.h"
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/Log.h>
+#ifdef URHO3D_PHYSICS
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#endif
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/SceneEvents.h>
+#include <Urho3D/UI/Text.h>
+#include <Urho3D/UI/UI.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static const String UNLOAD_STATS_STR = "Unload Stats";
+
+static constexpr i32 NUM_GROUPS = 50;
+static constexpr i32 NUM_NODES_PER_GROUP = 100;
+
+void AppState_Benchmark10::OnEnter()
+{
+    assert(!scene_);
+    scene_ = new Scene(context_);
+    scene_->CreateComponent<Octree>();
+
+    Node* zoneNode = scene_->CreateChild();
+    Zone* zone = zoneNode->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(-1000.f, 1000.f));
+    zone->SetFogColor(Color(0.3f, 0.6f, 0.9f));
+    zone->SetFogStart(10000.f);
+    zone->SetFogEnd(10000.f);
+
+    Node* cameraNode = scene_->CreateChild("Camera");
+    cameraNode->CreateComponent<Camera>();
+
+    // The content lives in a scene of its own, so that unloading it does not take the camera with it
+    contentScene_ = new Scene(context_);
+
+    numUnloads_ = 0;
+    numClears_ = 0;
+    unloadUSec_ = 0;
+    clearUSec_ = 0;
+
+    Text* statsElement = GetSubsystem<UI>()->GetRoot()->CreateChild<Text>(UNLOAD_STATS_STR);
+    statsElement->SetStyleAuto();
+    statsElement->SetTextEffect(TE_SHADOW);
+    statsElement->SetPosition(10, 30);
+
+    GetSubsystem<Input>()->SetMouseVisible(false);
+    SetupViewport();
+    SubscribeToEvent(scene_, E_SCENEUPDATE, URHO3D_HANDLER(AppState_Benchmark10, HandleSceneUpdate));
+    fpsCounter_.Clear();
+}
+
+void AppState_Benchmark10::OnLeave()
+{
+    if (numUnloads_ && numClears_)
+        URHO3D_LOGINFO(name_ + ": " + GetUnloadStats());
+
+    UIElement* statsElement = GetSubsystem<UI>()->GetRoot()->GetChild(UNLOAD_STATS_STR);
+    if (statsElement)
+        statsElement->Remove();
+
+    DestroyViewport();
+    contentScene_ = nullptr;
+    scene_ = nullptr;
+}
+
+void AppState_Benchmark10::CreateContent()
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    Model* boxModel = cache->GetResource<Model>("Models/Box.mdl");
+
+    contentScene_->CreateComponent<Octree>();
+#ifdef URHO3D_PHYSICS
+    contentScene_->CreateComponent<PhysicsWorld>();
+#endif
+
+    for (i32 i = 0; i < NUM_GROUPS; ++i)
+    {
+        Node* groupNode = contentScene_->CreateChild("Group");
+        groupNode->AddTag("Group");
+        groupNode->SetPosition(Vector3(i * 3.f, 0.f, 0.f));
+
+        for (i32 j = 0; j < NUM_NODES_PER_GROUP; ++j)
+        {
+            Node* node = groupNode->CreateChild("Box");
+            node->SetPosition(Vector3(0.f, j * 1.5f, 0.f));
+            node->CreateComponent<StaticModel>()->SetModel(boxModel);
+#ifdef URHO3D_PHYSICS
+            node->CreateComponent<RigidBody>()->SetMass(1.f);
+            node->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+#endif
+        }
+    }
+}
+
+String AppState_Benchmark10::GetUnloadStats() const
+{
+    return ToString("%d nodes, Unload %.2f ms, Clear %.2f ms", NUM_GROUPS * (NUM_NODES_PER_GROUP + 1),
+        numUnloads_ ? unloadUSec_ / (numUnloads_ * 1000.0) : 0.0, numClears_ ? clearUSec_ / (numClears_ * 1000.0) : 0.0);
+}
+
+void AppState_Benchmark10::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+
+    fpsCounter_.Update(timeStep);
+    UpdateCurrentFpsElement();
+
+    if (GetSubsystem<Input>()->GetKeyDown(KEY_ESCAPE))
+    {
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_MAINSCREEN);
+        return;
+    }
+
+    // Only the removal is timed. Alternate between the two methods, so that both see the same allocator state
+    CreateContent();
+    HiresTimer timer;
+    if (numUnloads_ <= numClears_)
+    {
+        contentScene_->Unload();
+        unloadUSec_ += timer.GetUSec(false);
+        ++numUnloads_;
+    }
+    else
+    {
+        contentScene_->Clear();
+        clearUSec_ += timer.GetUSec(false);
+        ++numClears_;
+    }
+
+    Text* statsElement = GetSubsystem<UI>()->GetRoot()->GetChildStaticCast<Text>(UNLOAD_STATS_STR);
+    statsElement->SetText(GetUnloadStats());
+
+    if (fpsCounter_.GetTotalTime() >= 30.f)
+        GetSubsystem<AppStateManager>()->SetRequiredAppStateId(APPSTATEID_RESULTSCREEN);
+}
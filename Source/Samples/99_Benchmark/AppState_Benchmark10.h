@@ -0,0 +1,37 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "AppState_Base.h"
+
+// A large tree of nodes with drawables and rigid bodies is built every frame in a separate scene and then removed,
+// alternating between Scene::Unload() and Scene::Clear(). The average removal times are reported
+class AppState_Benchmark10 : public AppState_Base
+{
+public:
+    URHO3D_OBJECT(AppState_Benchmark10, AppState_Base);
+
+private:
+    U3D::SharedPtr<U3D::Scene> contentScene_;
+
+    i32 numUnloads_ = 0;
+    i32 numClears_ = 0;
+    long long unloadUSec_ = 0;
+    long long clearUSec_ = 0;
+
+public:
+    AppState_Benchmark10(U3D::Context* context)
+        : AppState_Base(context)
+    {
+        name_ = "Scene Unload";
+    }
+
+    void OnEnter() override;
+    void OnLeave() override;
+
+    void CreateContent();
+    U3D::String GetUnloadStats() const;
+
+    void HandleSceneUpdate(U3D::StringHash eventType, U3D::VariantMap& eventData);
+};
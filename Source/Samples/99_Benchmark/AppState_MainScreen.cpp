@@ -20,6 +20,13 @@ static const String MAIN_SCREEN_WINDOW_STR = "Main Screen Window";
 static const String BENCHMARK_01_STR = "Benchmark 01";
 static const String BENCHMARK_02_STR = "Benchmark 02";
 static const String BENCHMARK_03_STR = "Benchmark 03";
+static const String BENCHMARK_04_STR = "Benchmark 04";
+static const String BENCHMARK_05_STR = "Benchmark 05";
+static const String BENCHMARK_06_STR = "Benchmark 06";
+static const String BENCHMARK_07_STR = "Benchmark 07";
+static const String BENCHMARK_08_STR = "Benchmark 08";
+static const String BENCHMARK_09_STR = "Benchmark 09";
+static const String BENCHMARK_10_STR = "Benchmark 10";
 
 void AppState_MainScreen::HandleButtonPressed(StringHash eventType, VariantMap& eventData)
 {
@@ -32,6 +39,20 @@ void AppState_MainScreen::HandleButtonPressed(StringHash eventType, VariantMap&
         appStateManager->SetRequiredAppStateId(APPSTATEID_BENCHMARK02);
     else if (pressedButton->GetName() == BENCHMARK_03_STR)
         appStateManager->SetRequiredAppStateId(APPSTATEID_BENCHMARK03);
+    else if (pressedButton->GetName() == BENCHMARK_04_STR)
+        appStateManager->SetRequiredAppStateId(APPSTATEID_BENCHMARK04);
+    else if (pressedButton->GetName() == BENCHMARK_05_STR)
+        appStateManager->SetRequiredAppStateId(APPSTATEID_BENCHMARK05);
+    else if (pressedButton->GetName() == BENCHMARK_06_STR)
+        appStateManager->SetRequiredAppStateId(APPSTATEID_BENCHMARK06);
+    else if (pressedButton->GetName() == BENCHMARK_07_STR)
+        appStateManager->SetRequiredAppStateId(APPSTATEID_BENCHMARK07);
+    else if (pressedButton->GetName() == BENCHMARK_08_STR)
+        appStateManager->SetRequiredAppStateId(APPSTATEID_BENCHMARK08);
+    else if (pressedButton->GetName() == BENCHMARK_09_STR)
+        appStateManager->SetRequiredAppStateId(APPSTATEID_BENCHMARK09);
+    else if (pressedButton->GetName() == BENCHMARK_10_STR)
+        appStateManager->SetRequiredAppStateId(APPSTATEID_BENCHMARK10);
 }
 
 void AppState_MainScreen::CreateButton(const String& name, const String& text, Window& parent)
@@ -67,6 +88,17 @@ void AppState_MainScreen::CreateGui()
     CreateButton(BENCHMARK_01_STR, appStateManager->GetName(APPSTATEID_BENCHMARK01), *window);
     CreateButton(BENCHMARK_02_STR, appStateManager->GetName(APPSTATEID_BENCHMARK02), *window);
     CreateButton(BENCHMARK_03_STR, appStateManager->GetName(APPSTATEID_BENCHMARK03), *window);
+    CreateButton(BENCHMARK_04_STR, appStateManager->GetName(APPSTATEID_BENCHMARK04), *window);
+    CreateButton(BENCHMARK_05_STR, appStateManager->GetName(APPSTATEID_BENCHMARK05), *window);
+#ifdef URHO3D_PHYSICS2D
+    CreateButton(BENCHMARK_06_STR, appStateManager->GetName(APPSTATEID_BENCHMARK06), *window);
+#endif
+    CreateButton(BENCHMARK_07_STR, appStateManager->GetName(APPSTATEID_BENCHMARK07), *window);
+#ifdef URHO3D_URHO2D
+    CreateButton(BENCHMARK_08_STR, appStateManager->GetName(APPSTATEID_BENCHMARK08), *window);
+#endif
+    CreateButton(BENCHMARK_09_STR, appStateManager->GetName(APPSTATEID_BENCHMARK09), *window);
+    CreateButton(BENCHMARK_10_STR, appStateManager->GetName(APPSTATEID_BENCHMARK10), *window);
 }
 
 void AppState_MainScreen::DestroyGui()
@@ -4,6 +4,7 @@
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Core/ProcessUtils.h>
 #include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
 #include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/Graphics/AnimatedModel.h>
 #include <Urho3D/Graphics/Animation.h>
@@ -30,6 +31,7 @@
 #endif
 
 #include <assimp/config.h>
+#include <assimp/cfileio.h>
 #include <assimp/cimport.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -65,6 +67,64 @@ struct OutScene
     Vector<unsigned> nodeModelIndices_;
 };
 
+// Vertex and index data of one geometry, written on a worker thread
+struct GeometryBuildTask
+{
+    aiMesh* mesh_{};
+    byte* vertexData_{};
+    byte* indexData_{};
+    unsigned startVertexOffset_{};
+    bool largeIndices_{};
+    bool isSkinned_{};
+    Matrix3x4 vertexTransform_;
+    Matrix3 normalTransform_;
+    Vector<Vector<unsigned char>> blendIndices_;
+    Vector<Vector<float>> blendWeights_;
+    BoundingBox box_;
+    Vector3 center_;
+};
+
+// Animation whose tracks are built on a worker thread
+struct AnimationBuildTask
+{
+    OutModel* model_{};
+    aiAnimation* anim_{};
+    SharedPtr<Animation> outAnim_;
+    String outName_;
+    float startTime_{};
+    float importStartTime_{};
+    float importEndTime_{};
+    float tickConversion_{};
+    // Warnings are printed from the main thread in animation order
+    Vector<String> warnings_;
+};
+
+// One input of a batch import
+struct BatchItem
+{
+    String inputName_;
+    String relativeName_;
+    String outName_;
+    // Arguments for the import process
+    Vector<String> arguments_;
+    // Other files the last import read, such as material libraries and textures
+    Vector<String> dependencies_;
+    unsigned size_{};
+    hash32 hash_{};
+    bool skipped_{};
+    int exitCode_{};
+    long long usec_{};
+};
+
+// Input of a previous batch import
+struct BatchManifestEntry
+{
+    // Hash of the input, its dependencies and the import options
+    hash32 hash_{};
+    // Other files the import read
+    Vector<String> dependencies_;
+};
+
 // FBX transform chain
 enum TransformationComp
 {
@@ -144,7 +204,9 @@ bool noOverwriteTexture_ = false;
 bool noOverwriteNewerTexture_ = false;
 bool checkUniqueModel_ = true;
 bool moveToBindPose_ = false;
+bool savePackedModels_ = false;
 unsigned maxBones_ = 64;
+int numWorkerThreads_ = -1;
 Vector<String> nonSkinningBoneIncludes_;
 Vector<String> nonSkinningBoneExcludes_;
 
@@ -156,6 +218,10 @@ float defaultTicksPerSecond_ = 4800.0f;
 float importStartTime_ = 0.0f;
 float importEndTime_ = 0.0f;
 bool suppressFbxPivotNodes_ = true;
+// File to write the other files an import read to, for batch imports
+String depsName_;
+// Files Assimp tried to read during the import, when writing dependencies
+HashSet<String> readFiles_;
 
 int main(int argc, char** argv);
 void Run(const Vector<String>& arguments);
@@ -171,6 +237,8 @@ void CollectAnimations(OutModel* model = nullptr);
 void BuildBoneCollisionInfo(OutModel& model);
 void BuildAndSaveModel(OutModel& model);
 void BuildAndSaveAnimations(OutModel* model = nullptr);
+void BuildAnimationTracks(AnimationBuildTask& task);
+void BuildGeometryData(GeometryBuildTask& task);
 
 void ExportScene(const String& outName, bool asPrefab);
 void CollectSceneModels(OutScene& scene, aiNode* node);
@@ -184,6 +252,18 @@ void CopyTextures(const HashSet<String>& usedTextures, const String& sourcePath)
 
 void CombineLods(const Vector<float>& lodDistances, const Vector<String>& modelNames, const String& outName);
 
+aiFile* OpenRecordedFile(aiFileIO* fileIO, const char* fileName, const char* mode);
+void CloseRecordedFile(aiFileIO* fileIO, aiFile* file);
+void SaveDependencies(const String& fileName, const String& inFile, const HashSet<String>& usedTextures);
+
+void RunBatch(const Vector<String>& arguments);
+void CollectBatchInputs(Vector<BatchItem>& items, const String& inputName, const String& outDir, const String& extension);
+void HashBatchInput(BatchItem& item, hash32 optionsHash);
+void LoadBatchDependencies(BatchItem& item, const String& fileName);
+void LoadBatchManifest(HashMap<String, BatchManifestEntry>& manifest, const String& fileName);
+void SaveBatchManifest(const HashMap<String, BatchManifestEntry>& manifest, const String& fileName);
+void SaveBatchReport(const Vector<BatchItem>& items, const String& fileName);
+
 void GetMeshesUnderNode(Vector<Pair<aiNode*, aiMesh*>>& dest, aiNode* node);
 unsigned GetMeshIndex(aiMesh* mesh);
 unsigned GetBoneIndex(OutModel& model, const String& boneName);
@@ -251,6 +331,11 @@ void Run(const Vector<String>& arguments)
             "dump        Dump scene node structure. No output file is generated\n"
             "lod         Combine several Urho3D models as LOD levels of the output model\n"
             "            Syntax: lod <dist0> <mdl0> <dist1 <mdl1> ... <output file>\n"
+            "batch       Import many input files concurrently into an output directory.\n"
+            "            Syntax: batch <input dir or list file> <output dir> [options]\n"
+            "            A list file names one input per line. Other options are passed on\n"
+            "            to each import. Unchanged inputs are skipped using a manifest of\n"
+            "            content hashes kept in the output directory\n"
             "\n"
             "Options:\n"
             "-b          Save scene in binary format, default format is XML\n"
@@ -284,9 +369,20 @@ void Run(const Vector<String>& arguments)
             "-ctn        Check and do not overwrite if texture has newer timestamp\n"
             "-am         Export all meshes even if identical (scene mode only)\n"
             "-bp         Move bones to bind pose before saving model\n"
+            "-pk         Save models in the packed format, which loads with fewer reads\n"
             "-split <start> <end> (animation model only)\n"
             "            Split animation, will only import from start frame to end frame\n"
             "-np         Do not suppress $fbx pivot nodes (FBX files only)\n"
+            "-w <n>      Number of worker threads for building geometries and animations.\n"
+            "            Default is the number of logical CPUs minus one\n"
+            "-deps <f>   Write the other files the import read, such as material libraries\n"
+            "            and textures, to a file one per line. Used by batch imports\n"
+            "\n"
+            "Batch options:\n"
+            "-bc <cmd>   Command to run for each input: model, anim, scene or node. Default model\n"
+            "-jobs <n>   Number of concurrent imports. Default is the number of logical CPUs\n"
+            "-force      Import all inputs even if unchanged since the last batch\n"
+            "-report <f> Write the import time of each input to a tab-separated file\n"
         );
     }
 
@@ -437,6 +533,18 @@ void Run(const Vector<String>& arguments)
                 checkUniqueModel_ = false;
             else if (argument == "bp")
                 moveToBindPose_ = true;
+            else if (argument == "pk")
+                savePackedModels_ = true;
+            else if (argument == "w" && !value.Empty())
+            {
+                numWorkerThreads_ = Max(ToI32(value), 0);
+                ++i;
+            }
+            else if (argument == "deps" && !value.Empty())
+            {
+                depsName_ = GetInternalPath(value);
+                ++i;
+            }
             else if (argument == "split")
             {
                 String value2 = i + 2 < arguments.Size() ? arguments[i + 2] : String::EMPTY;
@@ -449,6 +557,11 @@ void Run(const Vector<String>& arguments)
         }
     }
 
+    if (numWorkerThreads_ < 0)
+        numWorkerThreads_ = (int)GetNumLogicalCPUs() - 1;
+    if (numWorkerThreads_ > 0 && command != "batch")
+        context_->GetSubsystem<WorkQueue>()->CreateThreads(numWorkerThreads_);
+
     if (command == "model" || command == "scene" || command == "anim" || command == "node" || command == "dump")
     {
         String inFile = arguments[1];
@@ -483,6 +596,10 @@ void Run(const Vector<String>& arguments)
 
         PrintLine("Reading file " + inFile);
 
+        // Record the files Assimp reads when the dependencies are needed
+        aiFileIO recordingFileIO{OpenRecordedFile, CloseRecordedFile, nullptr};
+        aiFileIO* fileIO = depsName_.Empty() ? nullptr : &recordingFileIO;
+
         if (!inFile.EndsWith(".fbx", false))
             suppressFbxPivotNodes_ = false;
 
@@ -501,13 +618,13 @@ void Run(const Vector<String>& arguments)
             aiSetImportPropertyInteger(aiprops, AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, 0);                //**false, default = true;
             aiSetImportPropertyInteger(aiprops, AI_CONFIG_IMPORT_FBX_OPTIMIZE_EMPTY_ANIMATION_CURVES, 1);//default = true;
 
-            scene_ = aiImportFileExWithProperties(GetNativePath(inFile).CString(), flags, nullptr, aiprops);
+            scene_ = aiImportFileExWithProperties(GetNativePath(inFile).CString(), flags, fileIO, aiprops);
 
             // prevent processing animation suppression, both cannot work simultaneously
             suppressFbxPivotNodes_ = false;
         }
         else
-            scene_ = aiImportFile(GetNativePath(inFile).CString(), flags);
+            scene_ = aiImportFileEx(GetNativePath(inFile).CString(), flags, fileIO);
 
         if (!scene_)
             ErrorExit("Could not open or parse input file " + inFile + ": " + String(aiGetErrorString()));
@@ -546,13 +663,18 @@ void Run(const Vector<String>& arguments)
             ExportScene(outFile, asPrefab);
         }
 
+        HashSet<String> usedTextures;
         if (!noMaterials_)
         {
-            HashSet<String> usedTextures;
             ExportMaterials(usedTextures);
             if (!noTextures_)
                 CopyTextures(usedTextures, GetPath(inFile));
+            else
+                usedTextures.Clear();
         }
+
+        if (!depsName_.Empty())
+            SaveDependencies(depsName_, inFile, usedTextures);
     }
     else if (command == "lod")
     {
@@ -593,6 +715,8 @@ void Run(const Vector<String>& arguments)
 
         CombineLods(lodDistances, modelNames, outFile);
     }
+    else if (command == "batch")
+        RunBatch(arguments);
     else
         ErrorExit("Unrecognized command " + command);
 }
@@ -1023,6 +1147,9 @@ void BuildAndSaveModel(OutModel& model)
     unsigned startIndexOffset = 0;
     unsigned destGeomIndex = 0;
     bool isSkinned = model.bones_.Size() > 0;
+    // Reserve up front so that the tasks do not move while the work queue refers to them
+    Vector<GeometryBuildTask> geometryTasks;
+    geometryTasks.Reserve(numValidGeometries);
 
     outModel->SetNumGeometries(numValidGeometries);
 
@@ -1063,14 +1190,19 @@ void BuildAndSaveModel(OutModel& model)
             startIndexOffset = 0;
         }
 
+        geometryTasks.Resize(geometryTasks.Size() + 1);
+        GeometryBuildTask& task = geometryTasks.Back();
+        task.mesh_ = mesh;
+        task.largeIndices_ = largeIndices;
+        task.isSkinned_ = isSkinned;
+        task.startVertexOffset_ = startVertexOffset;
+
         // Get the world transform of the mesh for baking into the vertices
-        Matrix3x4 vertexTransform;
-        Matrix3 normalTransform;
         Vector3 pos, scale;
         Quaternion rot;
         GetPosRotScale(GetMeshBakingTransform(model.meshNodes_[i], model.rootNode_), pos, rot, scale);
-        vertexTransform = Matrix3x4(pos, rot, scale);
-        normalTransform = rot.RotationMatrix();
+        task.vertexTransform_ = Matrix3x4(pos, rot, scale);
+        task.normalTransform_ = rot.RotationMatrix();
 
         SharedPtr<Geometry> geom(new Geometry(context_));
 
@@ -1080,51 +1212,14 @@ void BuildAndSaveModel(OutModel& model)
         if (model.bones_.Size() > 0 && !mesh->HasBones())
             PrintLine("Warning: model has bones but geometry " + String(i) + " has no skinning information");
 
-        byte* vertexData = vb->GetShadowData();
-        byte* indexData = ib->GetShadowData();
+        task.vertexData_ = vb->GetShadowData() + startVertexOffset * vb->GetVertexSize();
+        task.indexData_ = ib->GetShadowData() + startIndexOffset * ib->GetIndexSize();
 
-        // Build the index data
-        if (!largeIndices)
-        {
-            unsigned short* dest = (unsigned short*)indexData + startIndexOffset;
-            for (unsigned j = 0; j < mesh->mNumFaces; ++j)
-                WriteShortIndices(dest, mesh, j, startVertexOffset);
-        }
-        else
-        {
-            unsigned* dest = (unsigned*)indexData + startIndexOffset;
-            for (unsigned j = 0; j < mesh->mNumFaces; ++j)
-                WriteLargeIndices(dest, mesh, j, startVertexOffset);
-        }
-
-        // Build the vertex data
-        // If there are bones, get blend data
-        Vector<Vector<unsigned char>> blendIndices;
-        Vector<Vector<float>> blendWeights;
+        // Get blend data now, as it may print warnings or exit on error. The vertex and index data are written later
+        // for all geometries in parallel
         Vector<i32> boneMappings;
         if (model.bones_.Size())
-            GetBlendData(model, mesh, model.meshNodes_[i], boneMappings, blendIndices, blendWeights);
-
-        auto* dest = (float*)((unsigned char*)vertexData + startVertexOffset * vb->GetVertexSize());
-        for (unsigned j = 0; j < mesh->mNumVertices; ++j)
-            WriteVertex(dest, mesh, j, isSkinned, box, vertexTransform, normalTransform, blendIndices, blendWeights);
-
-        // Calculate the geometry center
-        Vector3 center = Vector3::ZERO;
-        if (validFaces)
-        {
-            for (unsigned j = 0; j < mesh->mNumFaces; ++j)
-            {
-                if (mesh->mFaces[j].mNumIndices == 3)
-                {
-                    center += vertexTransform * ToVector3(mesh->mVertices[mesh->mFaces[j].mIndices[0]]);
-                    center += vertexTransform * ToVector3(mesh->mVertices[mesh->mFaces[j].mIndices[1]]);
-                    center += vertexTransform * ToVector3(mesh->mVertices[mesh->mFaces[j].mIndices[2]]);
-                }
-            }
-
-            center /= (float)validFaces * 3;
-        }
+            GetBlendData(model, mesh, model.meshNodes_[i], boneMappings, task.blendIndices_, task.blendWeights_);
 
         // Define the geometry
         geom->SetIndexBuffer(ib);
@@ -1132,7 +1227,6 @@ void BuildAndSaveModel(OutModel& model)
         geom->SetDrawRange(TRIANGLE_LIST, startIndexOffset, validFaces * 3, true);
         outModel->SetNumGeometryLodLevels(destGeomIndex, 1);
         outModel->SetGeometry(destGeomIndex, 0, geom);
-        outModel->SetGeometryCenter(destGeomIndex, center);
         if (model.bones_.Size() > maxBones_)
             allBoneMappings.Push(boneMappings);
 
@@ -1141,6 +1235,17 @@ void BuildAndSaveModel(OutModel& model)
         ++destGeomIndex;
     }
 
+    context_->GetSubsystem<WorkQueue>()->RunParallel([](const WorkItem* item, i32 /*threadIndex*/)
+    {
+        BuildGeometryData(*reinterpret_cast<GeometryBuildTask*>(item->start_));
+    }, geometryTasks.Buffer(), geometryTasks.Size(), geometryTasks.Size());
+
+    for (unsigned i = 0; i < geometryTasks.Size(); ++i)
+    {
+        box.Merge(geometryTasks[i].box_);
+        outModel->SetGeometryCenter(i, geometryTasks[i].center_);
+    }
+
     // Define the model buffers and bounding box
     Vector<i32> emptyMorphRange;
     outModel->SetVertexBuffers(vbVector, emptyMorphRange, emptyMorphRange);
@@ -1202,7 +1307,10 @@ void BuildAndSaveModel(OutModel& model)
     File outFile(context_);
     if (!outFile.Open(model.outName_, FILE_WRITE))
         ErrorExit("Could not open output file " + model.outName_);
-    outModel->Save(outFile);
+    if (savePackedModels_)
+        outModel->SavePacked(outFile);
+    else
+        outModel->Save(outFile);
 
     // If exporting materials, also save material list for use by the editor
     if (!noMaterials_ && saveMaterialList_)
@@ -1219,6 +1327,52 @@ void BuildAndSaveModel(OutModel& model)
     }
 }
 
+void BuildGeometryData(GeometryBuildTask& task)
+{
+    aiMesh* mesh = task.mesh_;
+
+    // Build the index data
+    if (!task.largeIndices_)
+    {
+        auto* dest = (unsigned short*)task.indexData_;
+        for (unsigned j = 0; j < mesh->mNumFaces; ++j)
+            WriteShortIndices(dest, mesh, j, task.startVertexOffset_);
+    }
+    else
+    {
+        auto* dest = (unsigned*)task.indexData_;
+        for (unsigned j = 0; j < mesh->mNumFaces; ++j)
+            WriteLargeIndices(dest, mesh, j, task.startVertexOffset_);
+    }
+
+    // Build the vertex data
+    auto* dest = (float*)task.vertexData_;
+    for (unsigned j = 0; j < mesh->mNumVertices; ++j)
+    {
+        WriteVertex(dest, mesh, j, task.isSkinned_, task.box_, task.vertexTransform_, task.normalTransform_,
+            task.blendIndices_, task.blendWeights_);
+    }
+
+    // Calculate the geometry center
+    Vector3 center = Vector3::ZERO;
+    unsigned validFaces = GetNumValidFaces(mesh);
+    if (validFaces)
+    {
+        for (unsigned j = 0; j < mesh->mNumFaces; ++j)
+        {
+            if (mesh->mFaces[j].mNumIndices == 3)
+            {
+                center += task.vertexTransform_ * ToVector3(mesh->mVertices[mesh->mFaces[j].mIndices[0]]);
+                center += task.vertexTransform_ * ToVector3(mesh->mVertices[mesh->mFaces[j].mIndices[1]]);
+                center += task.vertexTransform_ * ToVector3(mesh->mVertices[mesh->mFaces[j].mIndices[2]]);
+            }
+        }
+
+        center /= (float)validFaces * 3;
+    }
+    task.center_ = center;
+}
+
 void BuildAndSaveAnimations(OutModel* model)
 {
     // extrapolate anim
@@ -1226,6 +1380,9 @@ void BuildAndSaveAnimations(OutModel* model)
 
     // build and save anim
     const Vector<aiAnimation*>& animations = model ? model->animations_ : sceneAnimations_;
+    // Reserve up front so that the tasks do not move while the work queue refers to them
+    Vector<AnimationBuildTask> animationTasks;
+    animationTasks.Reserve(animations.Size());
 
     for (unsigned i = 0; i < animations.Size(); ++i)
     {
@@ -1276,194 +1433,229 @@ void BuildAndSaveAnimations(OutModel* model)
         outAnim->SetAnimationName(animName);
         outAnim->SetLength(duration * tickConversion);
 
-        PrintLine("Writing animation " + animName + " length " + String(outAnim->GetLength()));
-        for (unsigned j = 0; j < anim->mNumChannels; ++j)
-        {
-            aiNodeAnim* channel = anim->mChannels[j];
-            String channelName = FromAIString(channel->mNodeName);
-            aiNode* boneNode = nullptr;
+        AnimationBuildTask task;
+        task.model_ = model;
+        task.anim_ = anim;
+        task.outAnim_ = outAnim;
+        task.outName_ = animOutName;
+        task.startTime_ = startTime;
+        task.importStartTime_ = thisImportStartTime;
+        task.importEndTime_ = thisImportEndTime;
+        task.tickConversion_ = tickConversion;
+        animationTasks.Push(task);
+    }
 
-            if (model)
-            {
-                unsigned boneIndex;
-                i32 pos = channelName.Find("_$AssimpFbx$");
+    // Animations are independent of each other, so build their tracks in parallel
+    context_->GetSubsystem<WorkQueue>()->RunParallel([](const WorkItem* item, i32 /*threadIndex*/)
+    {
+        BuildAnimationTracks(*reinterpret_cast<AnimationBuildTask*>(item->start_));
+    }, animationTasks.Buffer(), animationTasks.Size(), animationTasks.Size());
 
-                if (!suppressFbxPivotNodes_ || pos == String::NPOS)
-                {
-                    boneIndex = GetBoneIndex(*model, channelName);
-                    if (boneIndex == M_MAX_UNSIGNED)
-                    {
-                        PrintLine("Warning: skipping animation track " + channelName + " not found in model skeleton");
-                        outAnim->RemoveTrack(channelName);
-                        continue;
-                    }
-                    boneNode = model->bones_[boneIndex];
-                }
-                else
-                {
-                    channelName = channelName.Substring(0, pos);
+    for (unsigned i = 0; i < animationTasks.Size(); ++i)
+    {
+        AnimationBuildTask& task = animationTasks[i];
+        PrintLine("Writing animation " + task.outAnim_->GetAnimationName() + " length " + String(task.outAnim_->GetLength()));
+        for (unsigned j = 0; j < task.warnings_.Size(); ++j)
+            PrintLine(task.warnings_[j]);
 
-                    // every first $fbx animation channel for a bone will consolidate other $fbx animation to a single channel
-                    // skip subsequent $fbx animation channel for the same bone
-                    if (outAnim->GetTrack(channelName) != nullptr)
-                        continue;
+        File outFile(context_);
+        if (!outFile.Open(task.outName_, FILE_WRITE))
+            ErrorExit("Could not open output file " + task.outName_);
+        task.outAnim_->Save(outFile);
+    }
+}
 
-                    boneIndex = GetPivotlessBoneIndex(*model, channelName);
-                    if (boneIndex == M_MAX_UNSIGNED)
-                    {
-                        PrintLine("Warning: skipping animation track " + channelName + " not found in model skeleton");
-                        outAnim->RemoveTrack(channelName);
-                        continue;
-                    }
+void BuildAnimationTracks(AnimationBuildTask& task)
+{
+    OutModel* model = task.model_;
+    aiAnimation* anim = task.anim_;
+    Animation* outAnim = task.outAnim_;
+    float startTime = task.startTime_;
+    float thisImportStartTime = task.importStartTime_;
+    float thisImportEndTime = task.importEndTime_;
+    float tickConversion = task.tickConversion_;
 
-                    boneNode = model->pivotlessBones_[boneIndex];
-                }
-            }
-            else
+    for (unsigned j = 0; j < anim->mNumChannels; ++j)
+    {
+        aiNodeAnim* channel = anim->mChannels[j];
+        String channelName = FromAIString(channel->mNodeName);
+        aiNode* boneNode = nullptr;
+
+        if (model)
+        {
+            unsigned boneIndex;
+            i32 pos = channelName.Find("_$AssimpFbx$");
+
+            if (!suppressFbxPivotNodes_ || pos == String::NPOS)
             {
-                boneNode = GetNode(channelName, scene_->mRootNode);
-                if (!boneNode)
+                boneIndex = GetBoneIndex(*model, channelName);
+                if (boneIndex == M_MAX_UNSIGNED)
                 {
-                    PrintLine("Warning: skipping animation track " + channelName + " whose scene node was not found");
+                    task.warnings_.Push("Warning: skipping animation track " + channelName + " not found in model skeleton");
                     outAnim->RemoveTrack(channelName);
                     continue;
                 }
+                boneNode = model->bones_[boneIndex];
             }
-
-            // To export single frame animation, check if first key frame is identical to bone transformation
-            aiVector3D bonePos, boneScale;
-            aiQuaternion boneRot;
-            boneNode->mTransformation.Decompose(boneScale, boneRot, bonePos);
-
-            bool posEqual = true;
-            bool scaleEqual = true;
-            bool rotEqual = true;
-
-            if (channel->mNumPositionKeys > 0 && !ToVector3(bonePos).Equals(ToVector3(channel->mPositionKeys[0].mValue)))
-                posEqual = false;
-            if (channel->mNumScalingKeys > 0 && !ToVector3(boneScale).Equals(ToVector3(channel->mScalingKeys[0].mValue)))
-                scaleEqual = false;
-            if (channel->mNumRotationKeys > 0 && !ToQuaternion(boneRot).Equals(ToQuaternion(channel->mRotationKeys[0].mValue)))
-                rotEqual = false;
-
-            AnimationTrack* track = outAnim->CreateTrack(channelName);
-
-            // Check which channels are used
-            track->channelMask_ = AnimationChannels::None;
-            if (channel->mNumPositionKeys > 1 || !posEqual)
-                track->channelMask_ |= AnimationChannels::Position;
-            if (channel->mNumRotationKeys > 1 || !rotEqual)
-                track->channelMask_ |= AnimationChannels::Rotation;
-            if (channel->mNumScalingKeys > 1 || !scaleEqual)
-                track->channelMask_ |= AnimationChannels::Scale;
-            // Check for redundant identity scale in all keyframes and remove in that case
-            if (!!(track->channelMask_ & AnimationChannels::Scale))
+            else
             {
-                bool redundantScale = true;
-                for (unsigned k = 0; k < channel->mNumScalingKeys; ++k)
+                channelName = channelName.Substring(0, pos);
+
+                // every first $fbx animation channel for a bone will consolidate other $fbx animation to a single channel
+                // skip subsequent $fbx animation channel for the same bone
+                if (outAnim->GetTrack(channelName) != nullptr)
+                    continue;
+
+                boneIndex = GetPivotlessBoneIndex(*model, channelName);
+                if (boneIndex == M_MAX_UNSIGNED)
                 {
-                    float SCALE_EPSILON = 0.000001f;
-                    Vector3 scaleVec = ToVector3(channel->mScalingKeys[k].mValue);
-                    if (fabsf(scaleVec.x_ - 1.0f) >= SCALE_EPSILON || fabsf(scaleVec.y_ - 1.0f) >= SCALE_EPSILON ||
-                        fabsf(scaleVec.z_ - 1.0f) >= SCALE_EPSILON)
-                    {
-                        redundantScale = false;
-                        break;
-                    }
+                    task.warnings_.Push("Warning: skipping animation track " + channelName + " not found in model skeleton");
+                    outAnim->RemoveTrack(channelName);
+                    continue;
                 }
-                if (redundantScale)
-                    track->channelMask_ &= ~AnimationChannels::Scale;
-            }
 
-            if (!track->channelMask_)
+                boneNode = model->pivotlessBones_[boneIndex];
+            }
+        }
+        else
+        {
+            boneNode = GetNode(channelName, scene_->mRootNode);
+            if (!boneNode)
             {
-                PrintLine("Warning: skipping animation track " + channelName + " with no keyframes");
+                task.warnings_.Push("Warning: skipping animation track " + channelName + " whose scene node was not found");
                 outAnim->RemoveTrack(channelName);
                 continue;
             }
+        }
 
-            // Currently only same amount of keyframes is supported
-            // Note: should also check the times of individual keyframes for match
-            if ((channel->mNumPositionKeys > 1 && channel->mNumRotationKeys > 1 && channel->mNumPositionKeys != channel->mNumRotationKeys) ||
-                (channel->mNumPositionKeys > 1 && channel->mNumScalingKeys > 1 && channel->mNumPositionKeys != channel->mNumScalingKeys) ||
-                (channel->mNumRotationKeys > 1 && channel->mNumScalingKeys > 1 && channel->mNumRotationKeys != channel->mNumScalingKeys))
+        // To export single frame animation, check if first key frame is identical to bone transformation
+        aiVector3D bonePos, boneScale;
+        aiQuaternion boneRot;
+        boneNode->mTransformation.Decompose(boneScale, boneRot, bonePos);
+
+        bool posEqual = true;
+        bool scaleEqual = true;
+        bool rotEqual = true;
+
+        if (channel->mNumPositionKeys > 0 && !ToVector3(bonePos).Equals(ToVector3(channel->mPositionKeys[0].mValue)))
+            posEqual = false;
+        if (channel->mNumScalingKeys > 0 && !ToVector3(boneScale).Equals(ToVector3(channel->mScalingKeys[0].mValue)))
+            scaleEqual = false;
+        if (channel->mNumRotationKeys > 0 && !ToQuaternion(boneRot).Equals(ToQuaternion(channel->mRotationKeys[0].mValue)))
+            rotEqual = false;
+
+        AnimationTrack* track = outAnim->CreateTrack(channelName);
+
+        // Check which channels are used
+        track->channelMask_ = AnimationChannels::None;
+        if (channel->mNumPositionKeys > 1 || !posEqual)
+            track->channelMask_ |= AnimationChannels::Position;
+        if (channel->mNumRotationKeys > 1 || !rotEqual)
+            track->channelMask_ |= AnimationChannels::Rotation;
+        if (channel->mNumScalingKeys > 1 || !scaleEqual)
+            track->channelMask_ |= AnimationChannels::Scale;
+        // Check for redundant identity scale in all keyframes and remove in that case
+        if (!!(track->channelMask_ & AnimationChannels::Scale))
+        {
+            bool redundantScale = true;
+            for (unsigned k = 0; k < channel->mNumScalingKeys; ++k)
             {
-                PrintLine("Warning: differing amounts of channel keyframes, skipping animation track " + channelName);
-                outAnim->RemoveTrack(channelName);
-                continue;
+                float SCALE_EPSILON = 0.000001f;
+                Vector3 scaleVec = ToVector3(channel->mScalingKeys[k].mValue);
+                if (fabsf(scaleVec.x_ - 1.0f) >= SCALE_EPSILON || fabsf(scaleVec.y_ - 1.0f) >= SCALE_EPSILON ||
+                    fabsf(scaleVec.z_ - 1.0f) >= SCALE_EPSILON)
+                {
+                    redundantScale = false;
+                    break;
+                }
             }
+            if (redundantScale)
+                track->channelMask_ &= ~AnimationChannels::Scale;
+        }
 
-            unsigned keyFrames = channel->mNumPositionKeys;
-            if (channel->mNumRotationKeys > keyFrames)
-                keyFrames = channel->mNumRotationKeys;
-            if (channel->mNumScalingKeys > keyFrames)
-                keyFrames = channel->mNumScalingKeys;
+        if (!track->channelMask_)
+        {
+            task.warnings_.Push("Warning: skipping animation track " + channelName + " with no keyframes");
+            outAnim->RemoveTrack(channelName);
+            continue;
+        }
 
-            for (unsigned k = 0; k < keyFrames; ++k)
+        // Currently only same amount of keyframes is supported
+        // Note: should also check the times of individual keyframes for match
+        if ((channel->mNumPositionKeys > 1 && channel->mNumRotationKeys > 1 && channel->mNumPositionKeys != channel->mNumRotationKeys) ||
+            (channel->mNumPositionKeys > 1 && channel->mNumScalingKeys > 1 && channel->mNumPositionKeys != channel->mNumScalingKeys) ||
+            (channel->mNumRotationKeys > 1 && channel->mNumScalingKeys > 1 && channel->mNumRotationKeys != channel->mNumScalingKeys))
+        {
+            task.warnings_.Push("Warning: differing amounts of channel keyframes, skipping animation track " + channelName);
+            outAnim->RemoveTrack(channelName);
+            continue;
+        }
+
+        unsigned keyFrames = channel->mNumPositionKeys;
+        if (channel->mNumRotationKeys > keyFrames)
+            keyFrames = channel->mNumRotationKeys;
+        if (channel->mNumScalingKeys > keyFrames)
+            keyFrames = channel->mNumScalingKeys;
+
+        for (unsigned k = 0; k < keyFrames; ++k)
+        {
+            AnimationKeyFrame kf;
+            kf.time_ = 0.0f;
+            kf.position_ = Vector3::ZERO;
+            kf.rotation_ = Quaternion::IDENTITY;
+            kf.scale_ = Vector3::ONE;
+
+            // Get time for the keyframe. Adjust with animation's start time
+            if (!!(track->channelMask_ & AnimationChannels::Position) && k < channel->mNumPositionKeys)
+                kf.time_ = ((float)channel->mPositionKeys[k].mTime - startTime);
+            else if (!!(track->channelMask_ & AnimationChannels::Rotation) && k < channel->mNumRotationKeys)
+                kf.time_ = ((float)channel->mRotationKeys[k].mTime - startTime);
+            else if (!!(track->channelMask_ & AnimationChannels::Scale) && k < channel->mNumScalingKeys)
+                kf.time_ = ((float)channel->mScalingKeys[k].mTime - startTime);
+
+            // Make sure time stays positive
+            kf.time_ = Max(kf.time_, 0.0f);
+
+            // Start with the bone's base transform
+            aiMatrix4x4 boneTransform = boneNode->mTransformation;
+            aiVector3D pos, scale;
+            aiQuaternion rot;
+            boneTransform.Decompose(scale, rot, pos);
+            // Then apply the active channels
+            if (!!(track->channelMask_ & AnimationChannels::Position) && k < channel->mNumPositionKeys)
+                pos = channel->mPositionKeys[k].mValue;
+            if (!!(track->channelMask_ & AnimationChannels::Rotation) && k < channel->mNumRotationKeys)
+                rot = channel->mRotationKeys[k].mValue;
+            if (!!(track->channelMask_ & AnimationChannels::Scale) && k < channel->mNumScalingKeys)
+                scale = channel->mScalingKeys[k].mValue;
+
+            // If root bone, transform with nodes in between model root node (if any)
+            if (model && boneNode == model->rootBone_)
             {
-                AnimationKeyFrame kf;
-                kf.time_ = 0.0f;
-                kf.position_ = Vector3::ZERO;
-                kf.rotation_ = Quaternion::IDENTITY;
-                kf.scale_ = Vector3::ONE;
-
-                // Get time for the keyframe. Adjust with animation's start time
-                if (!!(track->channelMask_ & AnimationChannels::Position) && k < channel->mNumPositionKeys)
-                    kf.time_ = ((float)channel->mPositionKeys[k].mTime - startTime);
-                else if (!!(track->channelMask_ & AnimationChannels::Rotation) && k < channel->mNumRotationKeys)
-                    kf.time_ = ((float)channel->mRotationKeys[k].mTime - startTime);
-                else if (!!(track->channelMask_ & AnimationChannels::Scale) && k < channel->mNumScalingKeys)
-                    kf.time_ = ((float)channel->mScalingKeys[k].mTime - startTime);
-
-                // Make sure time stays positive
-                kf.time_ = Max(kf.time_, 0.0f);
-
-                // Start with the bone's base transform
-                aiMatrix4x4 boneTransform = boneNode->mTransformation;
-                aiVector3D pos, scale;
-                aiQuaternion rot;
-                boneTransform.Decompose(scale, rot, pos);
-                // Then apply the active channels
-                if (!!(track->channelMask_ & AnimationChannels::Position) && k < channel->mNumPositionKeys)
-                    pos = channel->mPositionKeys[k].mValue;
-                if (!!(track->channelMask_ & AnimationChannels::Rotation) && k < channel->mNumRotationKeys)
-                    rot = channel->mRotationKeys[k].mValue;
-                if (!!(track->channelMask_ & AnimationChannels::Scale) && k < channel->mNumScalingKeys)
-                    scale = channel->mScalingKeys[k].mValue;
-
-                // If root bone, transform with nodes in between model root node (if any)
-                if (model && boneNode == model->rootBone_)
-                {
-                    aiMatrix4x4 transMat, scaleMat, rotMat;
-                    aiMatrix4x4::Translation(pos, transMat);
-                    aiMatrix4x4::Scaling(scale, scaleMat);
-                    rotMat = aiMatrix4x4(rot.GetMatrix());
-                    aiMatrix4x4 tform = transMat * rotMat * scaleMat;
-                    aiMatrix4x4 tformOld = tform;
-                    tform = GetDerivedTransform(tform, boneNode, model->rootNode_, false);
-                    // Do not decompose if did not actually change
-                    if (tform != tformOld)
-                        tform.Decompose(scale, rot, pos);
-                }
+                aiMatrix4x4 transMat, scaleMat, rotMat;
+                aiMatrix4x4::Translation(pos, transMat);
+                aiMatrix4x4::Scaling(scale, scaleMat);
+                rotMat = aiMatrix4x4(rot.GetMatrix());
+                aiMatrix4x4 tform = transMat * rotMat * scaleMat;
+                aiMatrix4x4 tformOld = tform;
+                tform = GetDerivedTransform(tform, boneNode, model->rootNode_, false);
+                // Do not decompose if did not actually change
+                if (tform != tformOld)
+                    tform.Decompose(scale, rot, pos);
+            }
 
-                if (!!(track->channelMask_ & AnimationChannels::Position))
-                    kf.position_ = ToVector3(pos);
-                if (!!(track->channelMask_ & AnimationChannels::Rotation))
-                    kf.rotation_ = ToQuaternion(rot);
-                if (!!(track->channelMask_ & AnimationChannels::Scale))
-                    kf.scale_ = ToVector3(scale);
-                if (kf.time_ >= thisImportStartTime && kf.time_ <= thisImportEndTime)
-                {
-                    kf.time_ = (kf.time_ - thisImportStartTime) * tickConversion;
-                    track->keyFrames_.Push(kf);
-                }
+            if (!!(track->channelMask_ & AnimationChannels::Position))
+                kf.position_ = ToVector3(pos);
+            if (!!(track->channelMask_ & AnimationChannels::Rotation))
+                kf.rotation_ = ToQuaternion(rot);
+            if (!!(track->channelMask_ & AnimationChannels::Scale))
+                kf.scale_ = ToVector3(scale);
+            if (kf.time_ >= thisImportStartTime && kf.time_ <= thisImportEndTime)
+            {
+                kf.time_ = (kf.time_ - thisImportStartTime) * tickConversion;
+                track->keyFrames_.Push(kf);
             }
         }
-
-        File outFile(context_);
-        if (!outFile.Open(animOutName, FILE_WRITE))
-            ErrorExit("Could not open output file " + animOutName);
-        outAnim->Save(outFile);
     }
 }
 
@@ -2116,7 +2308,454 @@ void CombineLods(const Vector<float>& lodDistances, const Vector<String>& modelN
     File outFile(context_);
     if (!outFile.Open(outName, FILE_WRITE))
         ErrorExit("Could not open output file " + outName);
-    outModel->Save(outFile);
+    if (savePackedModels_)
+        outModel->SavePacked(outFile);
+    else
+        outModel->Save(outFile);
+}
+
+aiFile* OpenRecordedFile(aiFileIO* /*fileIO*/, const char* fileName, const char* mode)
+{
+    // Assimp also opens files to check whether they exist, so record files that are missing too. Creating one may
+    // change the import
+    String name = GetInternalPath(String(fileName));
+    bool write = mode[0] == 'w' || mode[0] == 'a';
+    if (!write)
+    {
+        readFiles_.Insert(name);
+        if (!context_->GetSubsystem<FileSystem>()->FileExists(name))
+            return nullptr;
+    }
+
+    auto* file = new File(context_);
+    if (!file->Open(name, write ? FILE_WRITE : FILE_READ))
+    {
+        delete file;
+        return nullptr;
+    }
+
+    auto* ret = new aiFile();
+    ret->UserData = reinterpret_cast<aiUserData>(file);
+    ret->ReadProc = [](aiFile* aiFile, char* buffer, size_t size, size_t count) -> size_t
+    {
+        auto* file = reinterpret_cast<File*>(aiFile->UserData);
+        return size ? (size_t)file->Read(buffer, (i32)(size * count)) / size : 0;
+    };
+    ret->WriteProc = [](aiFile* aiFile, const char* buffer, size_t size, size_t count) -> size_t
+    {
+        auto* file = reinterpret_cast<File*>(aiFile->UserData);
+        return size ? (size_t)file->Write(buffer, (i32)(size * count)) / size : 0;
+    };
+    ret->TellProc = [](aiFile* aiFile) -> size_t
+    {
+        return (size_t)reinterpret_cast<File*>(aiFile->UserData)->GetPosition();
+    };
+    ret->FileSizeProc = [](aiFile* aiFile) -> size_t
+    {
+        return (size_t)reinterpret_cast<File*>(aiFile->UserData)->GetSize();
+    };
+    ret->SeekProc = [](aiFile* aiFile, size_t offset, aiOrigin origin) -> aiReturn
+    {
+        // Offsets from the end are negative
+        auto* file = reinterpret_cast<File*>(aiFile->UserData);
+        i64 position = (i64)offset;
+        if (origin == aiOrigin_CUR)
+            position += file->GetPosition();
+        else if (origin == aiOrigin_END)
+            position += file->GetSize();
+        if (position < 0 || position > file->GetSize())
+            return aiReturn_FAILURE;
+        file->Seek(position);
+        return aiReturn_SUCCESS;
+    };
+    ret->FlushProc = [](aiFile* aiFile)
+    {
+        reinterpret_cast<File*>(aiFile->UserData)->Flush();
+    };
+    return ret;
+}
+
+void CloseRecordedFile(aiFileIO* /*fileIO*/, aiFile* file)
+{
+    delete reinterpret_cast<File*>(file->UserData);
+    delete file;
+}
+
+void SaveDependencies(const String& fileName, const String& inFile, const HashSet<String>& usedTextures)
+{
+    // Material libraries and other files Assimp read, and the textures copied from the input directory. Embedded
+    // textures are part of the input
+    HashSet<String> dependencies = readFiles_;
+    String sourcePath = GetPath(inFile);
+    for (HashSet<String>::ConstIterator i = usedTextures.Begin(); i != usedTextures.End(); ++i)
+    {
+        if (i->Length() && i->At(0) != '*')
+            dependencies.Insert(sourcePath + *i);
+    }
+    dependencies.Erase(GetInternalPath(inFile));
+
+    Vector<String> sorted;
+    for (HashSet<String>::ConstIterator i = dependencies.Begin(); i != dependencies.End(); ++i)
+        sorted.Push(*i);
+    Sort(sorted.Begin(), sorted.End());
+
+    File file(context_);
+    if (!file.Open(fileName, FILE_WRITE))
+        ErrorExit("Could not open output file " + fileName);
+    for (unsigned i = 0; i < sorted.Size(); ++i)
+        file.WriteLine(sorted[i]);
+}
+
+void RunBatch(const Vector<String>& arguments)
+{
+    if (arguments.Size() < 3 || arguments[2][0] == '-')
+        ErrorExit("No output directory defined");
+
+    auto* fileSystem = context_->GetSubsystem<FileSystem>();
+    String inputName = GetInternalPath(arguments[1]);
+    String outDir = AddTrailingSlash(GetInternalPath(arguments[2]));
+    String command = "model";
+    String reportName;
+    unsigned numJobs = GetNumLogicalCPUs();
+    bool force = false;
+    bool threadsDefined = false;
+
+    // Other options are passed on to each import. They are part of the content hash, so changing them imports again
+    Vector<String> importOptions;
+    for (unsigned i = 3; i < arguments.Size(); ++i)
+    {
+        String argument = arguments[i].ToLower();
+        String value = i + 1 < arguments.Size() ? arguments[i + 1] : String::EMPTY;
+
+        if (argument == "-bc" && !value.Empty())
+        {
+            command = value.ToLower();
+            ++i;
+        }
+        else if (argument == "-jobs" && !value.Empty())
+        {
+            numJobs = Max(ToU32(value), 1U);
+            ++i;
+        }
+        else if (argument == "-report" && !value.Empty())
+        {
+            reportName = GetInternalPath(value);
+            ++i;
+        }
+        else if (argument == "-force")
+            force = true;
+        else
+        {
+            if (argument == "-w")
+                threadsDefined = true;
+            importOptions.Push(arguments[i]);
+        }
+    }
+
+    String extension;
+    if (command == "model")
+        extension = ".mdl";
+    else if (command == "anim")
+        extension = ".ani";
+    else if (command == "scene" || command == "node")
+        extension = saveBinary_ ? ".bin" : (saveJson_ ? ".json" : ".xml");
+    else
+        ErrorExit("Unsupported batch command " + command);
+
+    // Divide the CPUs between the concurrent imports unless told otherwise
+    if (!threadsDefined)
+    {
+        importOptions.Push("-w");
+        importOptions.Push(String(Max((int)GetNumLogicalCPUs() / (int)numJobs - 1, 0)));
+    }
+
+    Vector<BatchItem> items;
+    CollectBatchInputs(items, inputName, outDir, extension);
+    if (items.Empty())
+        ErrorExit("No input files found in " + inputName);
+
+    // The main thread takes part in the work, so one thread less is needed
+    context_->GetSubsystem<WorkQueue>()->CreateThreads(numJobs - 1);
+
+    HiresTimer batchTimer;
+    hash32 optionsHash = StringHash(command + " " + String::Joined(importOptions, " ")).Value();
+
+    String manifestName = outDir + "AssetImporterManifest.txt";
+    HashMap<String, BatchManifestEntry> manifest;
+    if (!force)
+        LoadBatchManifest(manifest, manifestName);
+
+    // An input is unchanged only if the files its last import read are unchanged too
+    for (unsigned i = 0; i < items.Size(); ++i)
+    {
+        HashMap<String, BatchManifestEntry>::ConstIterator entry = manifest.Find(items[i].relativeName_);
+        if (entry != manifest.End())
+            items[i].dependencies_ = entry->second_.dependencies_;
+    }
+
+    // Hash the input files in parallel, as reading thousands of files dominates a batch where little has changed
+    context_->GetSubsystem<WorkQueue>()->RunParallel([](const WorkItem* item, i32 /*threadIndex*/)
+    {
+        HashBatchInput(*reinterpret_cast<BatchItem*>(item->start_), *reinterpret_cast<hash32*>(item->aux_));
+    }, items.Buffer(), items.Size(), items.Size(), &optionsHash);
+
+    unsigned numSkipped = 0;
+    for (unsigned i = 0; i < items.Size(); ++i)
+    {
+        BatchItem& item = items[i];
+
+        // Animation output names are derived from the animations, so only check the output file for other commands
+        HashMap<String, BatchManifestEntry>::ConstIterator entry = manifest.Find(item.relativeName_);
+        if (entry != manifest.End() && entry->second_.hash_ == item.hash_ &&
+            (command == "anim" || fileSystem->FileExists(item.outName_)))
+        {
+            item.skipped_ = true;
+            ++numSkipped;
+            continue;
+        }
+
+        // Create the output subdirectories, as imports only create the resource subdirectories
+        String outPath = GetPath(item.outName_);
+        Vector<String> dirs = outPath.Substring(outDir.Length()).Split('/');
+        String dir = outDir;
+        fileSystem->CreateDir(dir);
+        for (unsigned j = 0; j < dirs.Size(); ++j)
+        {
+            dir += dirs[j] + "/";
+            fileSystem->CreateDir(dir);
+        }
+
+        item.arguments_.Push(command);
+        item.arguments_.Push(item.inputName_);
+        item.arguments_.Push(item.outName_);
+        item.arguments_.Push(importOptions);
+        item.arguments_.Push("-deps");
+        item.arguments_.Push(item.outName_ + ".deps");
+    }
+
+    PrintLine("Importing " + String(items.Size() - numSkipped) + " of " + String(items.Size()) + " files with " +
+        String(numJobs) + " concurrent imports");
+
+    // Each import runs in its own process, as the importer keeps its state in globals. Start the largest inputs first
+    // so that a big file does not run alone at the end
+    Sort(items.Begin(), items.End(), [](const BatchItem& lhs, const BatchItem& rhs) { return lhs.size_ > rhs.size_; });
+    context_->GetSubsystem<WorkQueue>()->RunParallel([](const WorkItem* item, i32 /*threadIndex*/)
+    {
+        auto& batchItem = *reinterpret_cast<BatchItem*>(item->start_);
+        if (batchItem.skipped_)
+            return;
+
+        auto* fileSystem = context_->GetSubsystem<FileSystem>();
+        HiresTimer timer;
+        batchItem.exitCode_ = fileSystem->SystemRun(fileSystem->GetProgramDir() + "AssetImporter", batchItem.arguments_);
+        batchItem.usec_ = timer.GetUSec(false);
+
+        // Hash again with the files this import read, which may differ from the last import
+        String depsName = batchItem.outName_ + ".deps";
+        if (batchItem.exitCode_ == 0)
+        {
+            LoadBatchDependencies(batchItem, depsName);
+            HashBatchInput(batchItem, *reinterpret_cast<hash32*>(item->aux_));
+        }
+        if (fileSystem->FileExists(depsName))
+            fileSystem->Delete(depsName);
+    }, items.Buffer(), items.Size(), items.Size(), &optionsHash);
+
+    Vector<String> failed;
+    for (unsigned i = 0; i < items.Size(); ++i)
+    {
+        const BatchItem& item = items[i];
+        if (item.skipped_)
+            continue;
+
+        if (item.exitCode_ == 0)
+        {
+            BatchManifestEntry& entry = manifest[item.relativeName_];
+            entry.hash_ = item.hash_;
+            entry.dependencies_ = item.dependencies_;
+        }
+        else
+        {
+            manifest.Erase(item.relativeName_);
+            failed.Push(item.inputName_);
+        }
+    }
+
+    SaveBatchManifest(manifest, manifestName);
+    if (!reportName.Empty())
+        SaveBatchReport(items, reportName);
+
+    PrintLine("Batch finished in " + String(batchTimer.GetUSec(false) / 1000000.0f) + " s: " +
+        String(items.Size() - numSkipped - failed.Size()) + " imported, " + String(numSkipped) + " unchanged, " +
+        String(failed.Size()) + " failed");
+    for (unsigned i = 0; i < failed.Size(); ++i)
+        PrintLine("Failed: " + failed[i]);
+
+    if (!failed.Empty())
+        ErrorExit("Batch import failed for " + String(failed.Size()) + " files");
+}
+
+void CollectBatchInputs(Vector<BatchItem>& items, const String& inputName, const String& outDir, const String& extension)
+{
+    auto* fileSystem = context_->GetSubsystem<FileSystem>();
+    Vector<Pair<String, String>> inputs;
+
+    if (fileSystem->DirExists(inputName))
+    {
+        // Take all files Assimp can read, keeping their subdirectories in the output. Skip the output directory if it
+        // is inside the input, as some output formats are also readable
+        String inputDir = AddTrailingSlash(inputName);
+        Vector<String> files;
+        fileSystem->ScanDir(files, inputDir, "*", SCAN_FILES, true);
+        for (unsigned i = 0; i < files.Size(); ++i)
+        {
+            if (aiIsExtensionSupported(GetExtension(files[i]).CString()) && !(inputDir + files[i]).StartsWith(outDir))
+                inputs.Push(MakePair(inputDir + files[i], files[i]));
+        }
+    }
+    else
+    {
+        // One input per line, relative to the list file. Empty lines and lines starting with # are ignored
+        File listFile(context_);
+        if (!listFile.Open(inputName))
+            ErrorExit("Could not open input list " + inputName);
+
+        String listPath = GetPath(inputName);
+        while (!listFile.IsEof())
+        {
+            String line = GetInternalPath(listFile.ReadLine().Trimmed());
+            if (line.Empty() || line[0] == '#')
+                continue;
+
+            if (IsAbsolutePath(line))
+                inputs.Push(MakePair(line, GetFileNameAndExtension(line)));
+            else
+                inputs.Push(MakePair(listPath + line, line));
+        }
+    }
+
+    items.Reserve(inputs.Size());
+    for (unsigned i = 0; i < inputs.Size(); ++i)
+    {
+        BatchItem item;
+        item.inputName_ = inputs[i].first_;
+        item.relativeName_ = inputs[i].second_;
+        item.outName_ = outDir + ReplaceExtension(inputs[i].second_, extension);
+        items.Push(item);
+    }
+}
+
+void HashBatchInput(BatchItem& item, hash32 optionsHash)
+{
+    // Combine the options with the checksums of the input and its dependencies. Missing dependencies are hashed by
+    // name only, so that creating one imports again
+    item.hash_ = optionsHash;
+    Vector<String> files;
+    files.Push(item.inputName_);
+    files.Push(item.dependencies_);
+
+    for (unsigned i = 0; i < files.Size(); ++i)
+    {
+        File file(context_);
+        hash32 checksum = 0;
+        if (context_->GetSubsystem<FileSystem>()->FileExists(files[i]) && file.Open(files[i]))
+        {
+            if (!i)
+                item.size_ = file.GetSize();
+            checksum = file.GetChecksum();
+        }
+
+        if (i)
+        {
+            for (unsigned j = 0; j < files[i].Length(); ++j)
+                item.hash_ = SDBMHash(item.hash_, (u8)files[i][j]);
+        }
+        for (unsigned j = 0; j < 4; ++j)
+            item.hash_ = SDBMHash(item.hash_, (u8)(checksum >> (j * 8)));
+    }
+}
+
+void LoadBatchDependencies(BatchItem& item, const String& fileName)
+{
+    item.dependencies_.Clear();
+
+    File file(context_);
+    if (!context_->GetSubsystem<FileSystem>()->FileExists(fileName) || !file.Open(fileName))
+        return;
+
+    while (!file.IsEof())
+    {
+        String line = file.ReadLine();
+        if (!line.Empty())
+            item.dependencies_.Push(line);
+    }
+}
+
+void LoadBatchManifest(HashMap<String, BatchManifestEntry>& manifest, const String& fileName)
+{
+    File file(context_);
+    if (!context_->GetSubsystem<FileSystem>()->FileExists(fileName) || !file.Open(fileName))
+        return;
+
+    // Each input is a line with the content hash in hex followed by the input name relative to the batch input, and
+    // then a line starting with a tab for each dependency
+    BatchManifestEntry* entry = nullptr;
+    while (!file.IsEof())
+    {
+        String line = file.ReadLine();
+        if (line.StartsWith("\t"))
+        {
+            if (entry && line.Length() > 1)
+                entry->dependencies_.Push(line.Substring(1));
+        }
+        else if (line.Length() > 9)
+        {
+            entry = &manifest[line.Substring(9)];
+            entry->hash_ = ToU32(line.Substring(0, 8), 16);
+            entry->dependencies_.Clear();
+        }
+    }
+}
+
+void SaveBatchManifest(const HashMap<String, BatchManifestEntry>& manifest, const String& fileName)
+{
+    File file(context_);
+    if (!file.Open(fileName, FILE_WRITE))
+    {
+        PrintLine("Warning: could not write batch manifest " + fileName);
+        return;
+    }
+
+    for (HashMap<String, BatchManifestEntry>::ConstIterator i = manifest.Begin(); i != manifest.End(); ++i)
+    {
+        file.WriteLine(ToStringHex(i->second_.hash_) + " " + i->first_);
+        for (unsigned j = 0; j < i->second_.dependencies_.Size(); ++j)
+            file.WriteLine("\t" + i->second_.dependencies_[j]);
+    }
+}
+
+void SaveBatchReport(const Vector<BatchItem>& items, const String& fileName)
+{
+    File file(context_);
+    if (!file.Open(fileName, FILE_WRITE))
+    {
+        PrintLine("Warning: could not write batch report " + fileName);
+        return;
+    }
+
+    // Slowest first, as those are the ones worth looking at
+    Vector<const BatchItem*> sorted;
+    for (unsigned i = 0; i < items.Size(); ++i)
+        sorted.Push(&items[i]);
+    Sort(sorted.Begin(), sorted.End(), [](const BatchItem* lhs, const BatchItem* rhs) { return lhs->usec_ > rhs->usec_; });
+
+    file.WriteLine("Seconds\tResult\tSize\tInput");
+    for (unsigned i = 0; i < sorted.Size(); ++i)
+    {
+        const BatchItem& item = *sorted[i];
+        String result = item.skipped_ ? "unchanged" : (item.exitCode_ == 0 ? "imported" : "failed");
+        file.WriteLine(String(item.usec_ / 1000000.0f) + "\t" + result + "\t" + String(item.size_) + "\t" + item.inputName_);
+    }
 }
 
 void GetMeshesUnderNode(Vector<Pair<aiNode*, aiMesh*>>& dest, aiNode* node)
@@ -4,9 +4,12 @@
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Core/ProcessUtils.h>
 #include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
 #include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/MaxRectsPacker.h>
 #include <Urho3D/Resource/Image.h>
 #include <Urho3D/Resource/XMLElement.h>
 #include <Urho3D/Resource/XMLFile.h>
@@ -23,9 +26,8 @@
 
 using namespace Urho3D;
 
-// number of nodes allocated to each packer info.  since this packer is not suited for real time purposes we can over allocate.
-const int PACKER_NUM_NODES = 4096;
 const int MAX_TEXTURE_SIZE = 2048;
+const int MIN_TEXTURE_SIZE = 4;
 
 int main(int argc, char** argv);
 void Run(Vector<String>& arguments);
@@ -35,8 +37,14 @@ class PackerInfo : public RefCounted
 public:
     String path;
     String name;
+    // loaded RGBA image, before trimming
+    SharedPtr<Image> image;
+    // set by a worker thread if loading fails
+    String error;
     int x{};
     int y{};
+    int page{};
+    bool rotated{};
     int offsetX{};
     int offsetY{};
     int width{};
@@ -53,6 +61,75 @@ public:
     ~PackerInfo() override = default;
 };
 
+// free rectangle choice for the MaxRects packer, same values as MaxRectsHeuristic. skyline uses the stb packer instead
+enum PackerHeuristic
+{
+    HEURISTIC_BSSF = 0,
+    HEURISTIC_BLSF,
+    HEURISTIC_BAF,
+    HEURISTIC_BL,
+    HEURISTIC_SKYLINE
+};
+
+struct PackerOptions
+{
+    Context* context{};
+    bool trim{};
+    int frameWidth{};
+    int frameHeight{};
+    int padX{};
+    int padY{};
+    int offsetX{};
+    int offsetY{};
+    int extrude{};
+    bool allowRotation{};
+    PackerHeuristic heuristic{HEURISTIC_BSSF};
+    Vector<SharedPtr<Image>> pages;
+};
+
+// rectangle to pack. id is the index of the packer info
+struct PackerRect
+{
+    int id{};
+    // image size
+    int width{};
+    int height{};
+    // padding and extrusion around the image, which do not turn with it
+    int padWidth{};
+    int padHeight{};
+    int x{};
+    int y{};
+    int page{};
+    bool rotated{};
+    bool packed{};
+
+    // return the size taken on the page
+    int GetWidth(bool rotated_) const { return (rotated_ ? height : width) + padWidth; }
+    int GetHeight(bool rotated_) const { return (rotated_ ? width : height) + padHeight; }
+};
+
+// one page size to try, packed on a worker thread
+struct PackerTrial
+{
+    Vector<PackerRect> rects;
+    const PackerOptions* options{};
+    int page{};
+    int width{};
+    int height{};
+    int numPacked{};
+};
+
+// sprite position read from a previous sprite sheet
+struct PreviousSprite
+{
+    int page{};
+    int x{};
+    int y{};
+    int width{};
+    int height{};
+    bool rotated{};
+};
+
 void Help()
 {
     ErrorExit("Usage: SpritePacker -options <input file> <input file> <output png file>\n"
@@ -66,6 +143,15 @@ void Help()
         "-frameHeight Sets a fixed height for image and centers within frame.\n"
         "-frameWidth Sets a fixed width for image and centers within frame.\n"
         "-trim Trims excess transparent space from individual images offsets by frame size.\n"
+        "-extrude Repeats the edge pixels of each image outwards by this many pixels.\n"
+        "-rotate Allows images to be rotated 90 degrees clockwise to pack tighter. Rotated images are marked with\n"
+        "   the rotated attribute, which SpriteSheet2D reads to draw them upright.\n"
+        "-heuristic Sets the packing method: bssf, blsf, baf or bl for MaxRects best short side, best long side,\n"
+        "   best area or bottom left fit, or skyline. Default is bssf.\n"
+        "-maxSize Sets the maximum page size. Images that do not fit go to further pages named\n"
+        "   <output>_1.png and so on. Default is 2048.\n"
+        "-incremental Keeps the positions of images whose size did not change since the last run, and does nothing\n"
+        "   if no input is newer than the output.\n"
         "-xml \'path\' Generates an SpriteSheet xml file at path.\n"
         "-debug Draws allocation boxes on sprite.\n");
 }
@@ -84,6 +170,223 @@ int main(int argc, char** argv)
     return 0;
 }
 
+// load, convert and trim one image on a worker thread. errors are reported from the main thread
+void LoadImageWork(const WorkItem* item, i32 /*threadIndex*/)
+{
+    PackerInfo* packerInfo = reinterpret_cast<SharedPtr<PackerInfo>*>(item->start_)->Get();
+    const PackerOptions& options = *reinterpret_cast<const PackerOptions*>(item->aux_);
+
+    File file(options.context, packerInfo->path);
+    SharedPtr<Image> image(new Image(options.context));
+    if (!image->Load(file))
+    {
+        packerInfo->error = "Could not load image " + packerInfo->path + ".";
+        return;
+    }
+
+    if (image->IsCompressed())
+    {
+        packerInfo->error = packerInfo->path + " is compressed. Compressed images are not allowed.";
+        return;
+    }
+
+    if (image->GetComponents() != 4)
+        image = image->ConvertToRGBA();
+    if (!image)
+    {
+        packerInfo->error = "Could not convert image " + packerInfo->path + " to RGBA.";
+        return;
+    }
+
+    int imageWidth = image->GetWidth();
+    int imageHeight = image->GetHeight();
+    int trimOffsetX = 0;
+    int trimOffsetY = 0;
+    int adjustedWidth = imageWidth;
+    int adjustedHeight = imageHeight;
+
+    if (options.trim)
+    {
+        int minX = imageWidth;
+        int minY = imageHeight;
+        int maxX = 0;
+        int maxY = 0;
+
+        const unsigned char* data = image->GetData();
+        for (int y = 0; y < imageHeight; ++y)
+        {
+            for (int x = 0; x < imageWidth; ++x)
+            {
+                bool found = data[(y * imageWidth + x) * 4 + 3] != 0;
+                if (found) {
+                    minX = Min(minX, x);
+                    minY = Min(minY, y);
+                    maxX = Max(maxX, x);
+                    maxY = Max(maxY, y);
+                }
+            }
+        }
+
+        // keep a single pixel of a fully transparent image
+        if (minX > maxX)
+        {
+            minX = maxX = 0;
+            minY = maxY = 0;
+        }
+
+        trimOffsetX = minX;
+        trimOffsetY = minY;
+        adjustedWidth = maxX - minX + 1;
+        adjustedHeight = maxY - minY + 1;
+    }
+
+    if (options.trim)
+    {
+        packerInfo->frameWidth = imageWidth;
+        packerInfo->frameHeight = imageHeight;
+    }
+    else if (options.frameWidth || options.frameHeight)
+    {
+        packerInfo->frameWidth = options.frameWidth;
+        packerInfo->frameHeight = options.frameHeight;
+    }
+    packerInfo->width = adjustedWidth;
+    packerInfo->height = adjustedHeight;
+    packerInfo->offsetX -= trimOffsetX;
+    packerInfo->offsetY -= trimOffsetY;
+    packerInfo->image = image;
+}
+
+// copy one image to its page, then extrude its edges. images do not overlap, so pages can be written in parallel
+void BlitImageWork(const WorkItem* item, i32 /*threadIndex*/)
+{
+    PackerInfo* packerInfo = reinterpret_cast<SharedPtr<PackerInfo>*>(item->start_)->Get();
+    const PackerOptions& options = *reinterpret_cast<const PackerOptions*>(item->aux_);
+
+    Image* page = options.pages[packerInfo->page];
+    int pageWidth = page->GetWidth();
+    auto* dest = reinterpret_cast<unsigned*>(page->GetData());
+    const auto* src = reinterpret_cast<const unsigned*>(packerInfo->image->GetData());
+    int srcWidth = packerInfo->image->GetWidth();
+    int left = packerInfo->x + options.offsetX + options.extrude;
+    int top = packerInfo->y + options.offsetY + options.extrude;
+    int width = packerInfo->rotated ? packerInfo->height : packerInfo->width;
+    int height = packerInfo->rotated ? packerInfo->width : packerInfo->height;
+
+    for (int y = 0; y < packerInfo->height; ++y)
+    {
+        const unsigned* srcRow = src + (y - packerInfo->offsetY) * srcWidth - packerInfo->offsetX;
+        if (!packerInfo->rotated)
+            memcpy(dest + (top + y) * pageWidth + left, srcRow, packerInfo->width * sizeof(unsigned));
+        else
+        {
+            for (int x = 0; x < packerInfo->width; ++x)
+                dest[(top + x) * pageWidth + left + packerInfo->height - 1 - y] = srcRow[x];
+        }
+    }
+
+    if (options.extrude)
+    {
+        for (int y = top; y < top + height; ++y)
+        {
+            unsigned* row = dest + y * pageWidth;
+            for (int e = 1; e <= options.extrude; ++e)
+            {
+                row[left - e] = row[left];
+                row[left + width - 1 + e] = row[left + width - 1];
+            }
+        }
+
+        int rowLength = (width + 2 * options.extrude) * sizeof(unsigned);
+        unsigned* firstRow = dest + top * pageWidth + left - options.extrude;
+        unsigned* lastRow = dest + (top + height - 1) * pageWidth + left - options.extrude;
+        for (int e = 1; e <= options.extrude; ++e)
+        {
+            memcpy(firstRow - e * pageWidth, firstRow, rowLength);
+            memcpy(lastRow + e * pageWidth, lastRow, rowLength);
+        }
+    }
+}
+
+// pack the rectangles not packed yet onto a page, around those already on it. return the number packed
+int PackPage(Vector<PackerRect>& rects, int page, int width, int height, const PackerOptions& options)
+{
+    int numPacked = 0;
+
+    if (options.heuristic == HEURISTIC_SKYLINE)
+    {
+        Vector<stbrp_rect> packerRects;
+        for (unsigned i = 0; i < rects.Size(); ++i)
+        {
+            if (!rects[i].packed)
+            {
+                stbrp_rect packerRect{};
+                packerRect.id = i;
+                packerRect.w = rects[i].GetWidth(false);
+                packerRect.h = rects[i].GetHeight(false);
+                packerRects.Push(packerRect);
+            }
+        }
+
+        // the packer works best with as many nodes as the page is wide
+        Vector<stbrp_node> packerMemory(width);
+        stbrp_context packerContext;
+        stbrp_init_target(&packerContext, width, height, packerMemory.Buffer(), width);
+        stbrp_pack_rects(&packerContext, packerRects.Buffer(), packerRects.Size());
+
+        for (const stbrp_rect& packerRect : packerRects)
+        {
+            if (packerRect.was_packed)
+            {
+                PackerRect& rect = rects[packerRect.id];
+                rect.x = packerRect.x;
+                rect.y = packerRect.y;
+                rect.page = page;
+                rect.packed = true;
+                ++numPacked;
+            }
+        }
+        return numPacked;
+    }
+
+    MaxRectsPacker packer(width, height, (MaxRectsHeuristic)options.heuristic, options.allowRotation);
+    for (const PackerRect& rect : rects)
+    {
+        if (rect.packed && rect.page == page)
+            packer.Occupy(IntRect(rect.x, rect.y, rect.x + rect.GetWidth(rect.rotated), rect.y + rect.GetHeight(rect.rotated)));
+    }
+
+    // rects are sorted largest first, which suits MaxRects best
+    for (PackerRect& rect : rects)
+    {
+        IntRect placed;
+        bool rotated;
+        if (!rect.packed && packer.Insert(rect.width, rect.height, placed, rotated, IntVector2(rect.padWidth, rect.padHeight)))
+        {
+            rect.x = placed.left_;
+            rect.y = placed.top_;
+            rect.rotated = rotated;
+            rect.page = page;
+            rect.packed = true;
+            ++numPacked;
+        }
+    }
+    return numPacked;
+}
+
+void PackTrialWork(const WorkItem* item, i32 /*threadIndex*/)
+{
+    auto& trial = *reinterpret_cast<PackerTrial*>(item->start_);
+    trial.numPacked = PackPage(trial.rects, trial.page, trial.width, trial.height, *trial.options);
+}
+
+String GetPageFileName(const String& fileName, int page)
+{
+    if (!page)
+        return fileName;
+    return GetPath(fileName) + GetFileName(fileName) + "_" + String(page) + GetExtension(fileName, false);
+}
+
 void Run(Vector<String>& arguments)
 {
     if (arguments.Size() < 2)
@@ -92,11 +395,15 @@ void Run(Vector<String>& arguments)
     SharedPtr<Context> context(new Context());
     context->RegisterSubsystem(new FileSystem(context));
     context->RegisterSubsystem(new Log(context));
+    context->RegisterSubsystem(new WorkQueue(context));
     auto* fileSystem = context->GetSubsystem<FileSystem>();
+    auto* workQueue = context->GetSubsystem<WorkQueue>();
 
     Vector<String> inputFiles;
     String outputFile;
     String spriteSheetFileName;
+    PackerOptions options;
+    options.context = context;
     bool debug = false;
     unsigned padX = 0;
     unsigned padY = 0;
@@ -104,8 +411,10 @@ void Run(Vector<String>& arguments)
     unsigned offsetY = 0;
     unsigned frameWidth = 0;
     unsigned frameHeight = 0;
+    int maxSize = MAX_TEXTURE_SIZE;
     bool help = false;
     bool trim = false;
+    bool incremental = false;
 
     while (arguments.Size() > 0)
     {
@@ -124,6 +433,21 @@ void Run(Vector<String>& arguments)
             else if (arg == "-frameWidth") { frameWidth = ToU32(arguments[0]); arguments.Erase(0); }
             else if (arg == "-frameHeight") { frameHeight = ToU32(arguments[0]); arguments.Erase(0); }
             else if (arg == "-trim") { trim = true; }
+            else if (arg == "-extrude") { options.extrude = ToU32(arguments[0]); arguments.Erase(0); }
+            else if (arg == "-rotate") { options.allowRotation = true; }
+            else if (arg == "-maxSize") { maxSize = Max(ToI32(arguments[0]), MIN_TEXTURE_SIZE); arguments.Erase(0); }
+            else if (arg == "-incremental") { incremental = true; }
+            else if (arg == "-heuristic")
+            {
+                String heuristic = arguments[0].ToLower();
+                arguments.Erase(0);
+                if (heuristic == "bssf") options.heuristic = HEURISTIC_BSSF;
+                else if (heuristic == "blsf") options.heuristic = HEURISTIC_BLSF;
+                else if (heuristic == "baf") options.heuristic = HEURISTIC_BAF;
+                else if (heuristic == "bl") options.heuristic = HEURISTIC_BL;
+                else if (heuristic == "skyline") options.heuristic = HEURISTIC_SKYLINE;
+                else ErrorExit("Unknown packing heuristic " + heuristic + ".");
+            }
             else if (arg == "-xml")  { spriteSheetFileName = arguments[0]; arguments.Erase(0); }
             else if (arg == "-h")  { help = true; break; }
             else if (arg == "-debug")  { debug = true; }
@@ -141,6 +465,9 @@ void Run(Vector<String>& arguments)
     if (frameWidth ^ frameHeight)
         ErrorExit("Both frameHeight and frameWidth must be omitted or specified.");
 
+    if (options.allowRotation && options.heuristic == HEURISTIC_SKYLINE)
+        ErrorExit("The skyline packer does not support rotation.");
+
     // take last input file as output
     if (inputFiles.Size() > 1)
     {
@@ -168,181 +495,269 @@ void Run(Vector<String>& arguments)
     offsetX = Min((int)offsetX, (int)padX);
     offsetY = Min((int)offsetY, (int)padY);
 
-    Vector<SharedPtr<PackerInfo>> packerInfos;
-
-    for (const String& path : inputFiles)
+    options.trim = trim;
+    options.frameWidth = frameWidth;
+    options.frameHeight = frameHeight;
+    options.padX = padX;
+    options.padY = padY;
+    options.offsetX = offsetX;
+    options.offsetY = offsetY;
+
+    // stored in the sprite sheet so that an incremental run can tell whether the previous layout is still valid
+    String layoutOptions = String(padX) + " " + String(padY) + " " + String(offsetX) + " " + String(offsetY) + " " +
+        String(frameWidth) + " " + String(frameHeight) + " " + String(trim) + " " + String(options.extrude) + " " +
+        String(options.allowRotation) + " " + String((int)options.heuristic) + " " + String(maxSize);
+
+    // read the previous sprite sheet pages
+    HashMap<String, PreviousSprite> previousSprites;
+    Vector<IntVector2> previousPageSizes;
+    int numPreviousPages = 0;
+    while (fileSystem->FileExists(GetPageFileName(spriteSheetFileName, numPreviousPages)))
+        ++numPreviousPages;
+
+    if (incremental)
     {
-        String name = ReplaceExtension(GetFileName(path), "");
-        File file(context, path);
-        Image image(context);
-
-        if (!image.Load(file))
-            ErrorExit("Could not load image " + path + ".");
-
-        if (image.IsCompressed())
-            ErrorExit(path + " is compressed. Compressed images are not allowed.");
+        unsigned outputTime = M_MAX_UNSIGNED;
+        for (int i = 0; i < numPreviousPages; ++i)
+        {
+            String pageFileName = GetPageFileName(spriteSheetFileName, i);
+            File file(context, pageFileName);
+            XMLFile xml(context);
+            XMLElement root;
+            if (xml.Load(file))
+                root = xml.GetRoot("TextureAtlas");
+            if (!root || root.GetAttribute("packerOptions") != layoutOptions ||
+                !fileSystem->FileExists(GetPageFileName(outputFile, i)))
+            {
+                URHO3D_LOGINFO("Previous sprite sheet " + pageFileName + " was made with other options. Repacking all images.");
+                previousSprites.Clear();
+                previousPageSizes.Clear();
+                break;
+            }
 
-        SharedPtr<PackerInfo> packerInfo(new PackerInfo(path, name));
-        int imageWidth = image.GetWidth();
-        int imageHeight = image.GetHeight();
-        int trimOffsetX = 0;
-        int trimOffsetY = 0;
-        int adjustedWidth = imageWidth;
-        int adjustedHeight = imageHeight;
+            outputTime = Min(outputTime, fileSystem->GetLastModifiedTime(GetPageFileName(outputFile, i)));
+            outputTime = Min(outputTime, fileSystem->GetLastModifiedTime(pageFileName));
+            previousPageSizes.Push(IntVector2(root.GetI32("width"), root.GetI32("height")));
+            for (XMLElement subTexture = root.GetChild("SubTexture"); subTexture; subTexture = subTexture.GetNext("SubTexture"))
+            {
+                PreviousSprite& sprite = previousSprites[subTexture.GetAttribute("name")];
+                sprite.page = i;
+                sprite.x = subTexture.GetI32("x");
+                sprite.y = subTexture.GetI32("y");
+                sprite.width = subTexture.GetI32("width");
+                sprite.height = subTexture.GetI32("height");
+                sprite.rotated = subTexture.GetBool("rotated");
+            }
+        }
 
-        if (trim)
+        // nothing to do if the same images are packed and none changed since
+        if (previousSprites.Size() == inputFiles.Size())
         {
-            int minX = imageWidth;
-            int minY = imageHeight;
-            int maxX = 0;
-            int maxY = 0;
-
-            for (int y = 0; y < imageHeight; ++y)
+            bool upToDate = true;
+            for (const String& inputFile : inputFiles)
             {
-                for (int x = 0; x < imageWidth; ++x)
+                if (!previousSprites.Contains(ReplaceExtension(GetFileName(inputFile), "")) ||
+                    fileSystem->GetLastModifiedTime(inputFile) > outputTime)
                 {
-                    bool found = (image.GetPixelInt(x, y) & 0x000000ffu) != 0;
-                    if (found) {
-                        minX = Min(minX, x);
-                        minY = Min(minY, y);
-                        maxX = Max(maxX, x);
-                        maxY = Max(maxY, y);
-                    }
+                    upToDate = false;
+                    break;
                 }
             }
 
-            trimOffsetX = minX;
-            trimOffsetY = minY;
-            adjustedWidth = maxX - minX + 1;
-            adjustedHeight = maxY - minY + 1;
+            if (upToDate)
+            {
+                URHO3D_LOGINFO("Sprite sheet is up to date.");
+                return;
+            }
         }
+    }
 
-        if (trim)
-        {
-            packerInfo->frameWidth = imageWidth;
-            packerInfo->frameHeight = imageHeight;
-        }
-        else if (frameWidth || frameHeight)
-        {
-            packerInfo->frameWidth = frameWidth;
-            packerInfo->frameHeight = frameHeight;
-        }
-        packerInfo->width = adjustedWidth;
-        packerInfo->height = adjustedHeight;
-        packerInfo->offsetX -= trimOffsetX;
-        packerInfo->offsetY -= trimOffsetY;
-        packerInfos.Push(packerInfo);
+    HiresTimer totalTimer;
+    HiresTimer stepTimer;
+
+    Vector<SharedPtr<PackerInfo>> packerInfos;
+    for (const String& path : inputFiles)
+    {
+        String name = ReplaceExtension(GetFileName(path), "");
+        packerInfos.Push(SharedPtr<PackerInfo>(new PackerInfo(path, name)));
     }
 
-    int packedWidth = MAX_TEXTURE_SIZE;
-    int packedHeight = MAX_TEXTURE_SIZE;
+    // decode and trim on all cores
+    workQueue->CreateThreads(Max((int)GetNumLogicalCPUs() - 1, 0));
+    workQueue->RunParallel(LoadImageWork, packerInfos.Buffer(), packerInfos.Size(), packerInfos.Size(), &options);
+    for (const SharedPtr<PackerInfo>& packerInfo : packerInfos)
     {
-        // fill up an list of tries in increasing size and take the first win
-        Vector<IntVector2> tries;
-        for(unsigned x=2; x<11; ++x)
-        {
-            for(unsigned y=2; y<11; ++y)
-                tries.Push(IntVector2((1u<<x), (1u<<y)));
-        }
+        if (!packerInfo->error.Empty())
+            ErrorExit(packerInfo->error);
+    }
 
-        // Load rectangles
-        stbrp_rect* packerRects = new stbrp_rect[packerInfos.Size()];
-        for (i32 i = 0; i < packerInfos.Size(); ++i)
-        {
-            PackerInfo* packerInfo = packerInfos[i];
-            stbrp_rect* packerRect = &packerRects[i];
-            packerRect->id = i;
-            packerRect->h = packerInfo->height + padY;
-            packerRect->w = packerInfo->width + padX;
-        }
+    long long loadTime = stepTimer.GetUSec(true);
 
-        bool success = false;
-        while (tries.Size() > 0)
-        {
-            IntVector2 size = tries[0];
-            tries.Erase(0);
-            bool fit = true;
-            int textureHeight = size.y_;
-            int textureWidth = size.x_;
-            if (success && textureHeight * textureWidth > packedWidth * packedHeight)
-                continue;
+    Vector<PackerRect> rects;
+    long long totalSpriteArea = 0;
+    for (unsigned i = 0; i < packerInfos.Size(); ++i)
+    {
+        PackerInfo* packerInfo = packerInfos[i];
+        PackerRect rect;
+        rect.id = i;
+        rect.width = packerInfo->width;
+        rect.height = packerInfo->height;
+        rect.padWidth = padX + 2 * options.extrude;
+        rect.padHeight = padY + 2 * options.extrude;
+
+        // pages are square at most, so rotation can not help an image fit
+        if (rect.GetWidth(false) > maxSize || rect.GetHeight(false) > maxSize)
+            ErrorExit("Image " + packerInfo->path + " does not fit the max sprite sheet texture size " + String(maxSize) +
+                "x" + String(maxSize) + ".");
+
+        totalSpriteArea += packerInfo->width * packerInfo->height;
+        rects.Push(rect);
+    }
 
-            stbrp_context packerContext;
-            stbrp_node packerMemory[PACKER_NUM_NODES];
-            stbrp_init_target(&packerContext, textureWidth, textureHeight, packerMemory, PACKER_NUM_NODES);
-            if (!stbrp_pack_rects(&packerContext, packerRects, packerInfos.Size()))
+    // largest first
+    Sort(rects.Begin(), rects.End(), [](const PackerRect& lhs, const PackerRect& rhs)
+    {
+        int lhsSide = Max(lhs.GetWidth(false), lhs.GetHeight(false));
+        int rhsSide = Max(rhs.GetWidth(false), rhs.GetHeight(false));
+        return lhsSide != rhsSide ? lhsSide > rhsSide :
+            lhs.GetWidth(false) * lhs.GetHeight(false) > rhs.GetWidth(false) * rhs.GetHeight(false);
+    });
+
+    // keep the previous positions of images with the same size, on their previous pages. pages left empty are dropped
+    Vector<IntVector2> pageSizes;
+    int numKept = 0;
+    if (!previousSprites.Empty() && options.heuristic != HEURISTIC_SKYLINE)
+    {
+        for (unsigned i = 0; i < previousPageSizes.Size(); ++i)
+        {
+            MaxRectsPacker packer(previousPageSizes[i].x_, previousPageSizes[i].y_, (MaxRectsHeuristic)options.heuristic);
+            int numOnPage = 0;
+            for (PackerRect& rect : rects)
             {
-                // check to see if everything fit
-                fit = false;
+                PackerInfo* packerInfo = packerInfos[rect.id];
+                HashMap<String, PreviousSprite>::Iterator j = previousSprites.Find(packerInfo->name);
+                if (j == previousSprites.End() || j->second_.page != (int)i || j->second_.width != packerInfo->width ||
+                    j->second_.height != packerInfo->height)
+                    continue;
+
+                // only one image of the same name can keep the position
+                PreviousSprite sprite = j->second_;
+                previousSprites.Erase(j);
+                int cellX = sprite.x - offsetX - options.extrude;
+                int cellY = sprite.y - offsetY - options.extrude;
+                IntRect cell(cellX, cellY, cellX + rect.GetWidth(sprite.rotated), cellY + rect.GetHeight(sprite.rotated));
+                if (cellX < 0 || cellY < 0 || !packer.Occupy(cell))
+                    continue;
+
+                rect.x = cellX;
+                rect.y = cellY;
+                rect.rotated = sprite.rotated;
+                rect.page = pageSizes.Size();
+                rect.packed = true;
+                ++numOnPage;
             }
 
-            if (fit)
+            if (numOnPage)
             {
-                success = true;
-                // distribute values to packer info
-                for (i32 i = 0; i < packerInfos.Size(); ++i)
-                {
-                    stbrp_rect* packerRect = &packerRects[i];
-                    PackerInfo* packerInfo = packerInfos[packerRect->id];
-                    packerInfo->x = packerRect->x;
-                    packerInfo->y = packerRect->y;
-                }
-                packedWidth = size.x_;
-                packedHeight = size.y_;
+                pageSizes.Push(previousPageSizes[i]);
+                numKept += numOnPage;
             }
         }
-        delete[] packerRects;
-        if (!success)
-            ErrorExit("Could not allocate for all images.  The max sprite sheet texture size is " + String(MAX_TEXTURE_SIZE) + "x" + String(MAX_TEXTURE_SIZE) + ".");
-    }
-
-    // create image for spritesheet
-    Image spriteSheetImage(context);
-    spriteSheetImage.SetSize(packedWidth, packedHeight, 4);
-
-    // zero out image
-    spriteSheetImage.SetData(nullptr);
 
-    XMLFile xml(context);
-    XMLElement root = xml.CreateRoot("TextureAtlas");
-    root.SetAttribute("imagePath", GetFileNameAndExtension(outputFile));
+        // new and changed images fill the gaps of the kept pages first
+        for (unsigned i = 0; i < pageSizes.Size(); ++i)
+            PackPage(rects, i, pageSizes[i].x_, pageSizes[i].y_, options);
+    }
 
-    for (const SharedPtr<PackerInfo>& packerInfo : packerInfos)
+    for (;;)
     {
-        XMLElement subTexture = root.CreateChild("SubTexture");
-        subTexture.SetString("name", packerInfo->name);
-        subTexture.SetI32("x", packerInfo->x + offsetX);
-        subTexture.SetI32("y", packerInfo->y + offsetY);
-        subTexture.SetI32("width", packerInfo->width);
-        subTexture.SetI32("height", packerInfo->height);
-
-        if (packerInfo->frameWidth || packerInfo->frameHeight)
+        long long remainingArea = 0;
+        for (const PackerRect& rect : rects)
         {
-            subTexture.SetI32("frameWidth", packerInfo->frameWidth);
-            subTexture.SetI32("frameHeight", packerInfo->frameHeight);
-            subTexture.SetI32("offsetX", packerInfo->offsetX);
-            subTexture.SetI32("offsetY", packerInfo->offsetY);
+            if (!rect.packed)
+                remainingArea += rect.GetWidth(false) * rect.GetHeight(false);
         }
+        if (!remainingArea)
+            break;
 
-        URHO3D_LOGINFO("Transferring " + packerInfo->path + " to sprite sheet.");
-
-        File file(context, packerInfo->path);
-        Image image(context);
-        if (!image.Load(file))
-            ErrorExit("Could not load image " + packerInfo->path + ".");
+        // try all page sizes that could hold the remaining images in parallel and take the smallest that holds them
+        Vector<PackerTrial> trials;
+        for (int width = MIN_TEXTURE_SIZE; width <= maxSize; width *= 2)
+        {
+            for (int height = MIN_TEXTURE_SIZE; height <= maxSize; height *= 2)
+            {
+                if ((long long)width * height < remainingArea)
+                    continue;
+
+                PackerTrial trial;
+                trial.options = &options;
+                trial.page = pageSizes.Size();
+                trial.width = width;
+                trial.height = height;
+                trials.Push(trial);
+            }
+        }
+        Sort(trials.Begin(), trials.End(), [](const PackerTrial& lhs, const PackerTrial& rhs)
+        {
+            int lhsArea = lhs.width * lhs.height;
+            int rhsArea = rhs.width * rhs.height;
+            return lhsArea != rhsArea ? lhsArea < rhsArea : Max(lhs.width, lhs.height) < Max(rhs.width, rhs.height);
+        });
+        for (PackerTrial& trial : trials)
+            trial.rects = rects;
+        workQueue->RunParallel(PackTrialWork, trials.Buffer(), trials.Size(), trials.Size());
+
+        int numRemaining = 0;
+        for (const PackerRect& rect : rects)
+        {
+            if (!rect.packed)
+                ++numRemaining;
+        }
 
-        for (int y = 0; y < packerInfo->height; ++y)
+        bool done = false;
+        for (PackerTrial& trial : trials)
         {
-            for (int x = 0; x < packerInfo->width; ++x)
+            if (trial.numPacked == numRemaining)
             {
-                unsigned color = image.GetPixelInt(x - packerInfo->offsetX, y - packerInfo->offsetY);
-                spriteSheetImage.SetPixelInt(
-                    packerInfo->x + offsetX + x,
-                    packerInfo->y + offsetY + y, color);
+                rects.Swap(trial.rects);
+                pageSizes.Push(IntVector2(trial.width, trial.height));
+                done = true;
+                break;
             }
         }
+        if (done)
+            break;
+
+        // fill a full size page and continue with the rest
+        if (!PackPage(rects, pageSizes.Size(), maxSize, maxSize, options))
+            ErrorExit("Could not allocate for all images.  The max sprite sheet texture size is " + String(maxSize) + "x" + String(maxSize) + ".");
+        pageSizes.Push(IntVector2(maxSize, maxSize));
+    }
+
+    // distribute values to packer info
+    for (const PackerRect& rect : rects)
+    {
+        PackerInfo* packerInfo = packerInfos[rect.id];
+        packerInfo->x = rect.x;
+        packerInfo->y = rect.y;
+        packerInfo->page = rect.page;
+        packerInfo->rotated = rect.rotated;
     }
 
+    long long packTime = stepTimer.GetUSec(true);
+
+    // create and zero out the images for the pages
+    for (const IntVector2& size : pageSizes)
+    {
+        SharedPtr<Image> spriteSheetImage(new Image(context));
+        spriteSheetImage->SetSize(size.x_, size.y_, 4);
+        spriteSheetImage->SetData(nullptr);
+        options.pages.Push(spriteSheetImage);
+    }
+
+    URHO3D_LOGINFO("Transferring " + String(packerInfos.Size()) + " images to sprite sheet.");
+    workQueue->RunParallel(BlitImageWork, packerInfos.Buffer(), packerInfos.Size(), packerInfos.Size(), &options);
+
     if (debug)
     {
         unsigned OUTER_BOUNDS_DEBUG_COLOR = Color::BLUE.ToU32();
@@ -351,6 +766,12 @@ void Run(Vector<String>& arguments)
         URHO3D_LOGINFO("Drawing debug information.");
         for (const SharedPtr<PackerInfo>& packerInfo : packerInfos)
         {
+            Image& spriteSheetImage = *options.pages[packerInfo->page];
+            int width = packerInfo->rotated ? packerInfo->height : packerInfo->width;
+            int height = packerInfo->rotated ? packerInfo->width : packerInfo->height;
+            int innerX = packerInfo->x + offsetX + options.extrude;
+            int innerY = packerInfo->y + offsetY + options.extrude;
+
             // Draw outer bounds
             for (int x = 0; x < packerInfo->frameWidth; ++x)
             {
@@ -364,24 +785,83 @@ void Run(Vector<String>& arguments)
             }
 
             // Draw inner bounds
-            for (int x = 0; x < packerInfo->width; ++x)
+            for (int x = 0; x < width; ++x)
+            {
+                spriteSheetImage.SetPixelInt(innerX + x, innerY, INNER_BOUNDS_DEBUG_COLOR);
+                spriteSheetImage.SetPixelInt(innerX + x, innerY + height, INNER_BOUNDS_DEBUG_COLOR);
+            }
+            for (int y = 0; y < height; ++y)
             {
-                spriteSheetImage.SetPixelInt(packerInfo->x + offsetX + x, packerInfo->y + offsetY, INNER_BOUNDS_DEBUG_COLOR);
-                spriteSheetImage.SetPixelInt(packerInfo->x + offsetX + x, packerInfo->y + offsetY + packerInfo->height, INNER_BOUNDS_DEBUG_COLOR);
+                spriteSheetImage.SetPixelInt(innerX, innerY + y, INNER_BOUNDS_DEBUG_COLOR);
+                spriteSheetImage.SetPixelInt(innerX + width, innerY + y, INNER_BOUNDS_DEBUG_COLOR);
             }
-            for (int y = 0; y < packerInfo->height; ++y)
+        }
+    }
+
+    long long pageSpriteArea = 0;
+    long long totalPageArea = 0;
+    for (unsigned i = 0; i < pageSizes.Size(); ++i)
+    {
+        XMLFile xml(context);
+        XMLElement root = xml.CreateRoot("TextureAtlas");
+        root.SetAttribute("imagePath", GetFileNameAndExtension(GetPageFileName(outputFile, i)));
+        root.SetI32("width", pageSizes[i].x_);
+        root.SetI32("height", pageSizes[i].y_);
+        root.SetAttribute("packerOptions", layoutOptions);
+
+        int numSprites = 0;
+        pageSpriteArea = 0;
+        for (const SharedPtr<PackerInfo>& packerInfo : packerInfos)
+        {
+            if (packerInfo->page != (int)i)
+                continue;
+
+            XMLElement subTexture = root.CreateChild("SubTexture");
+            subTexture.SetString("name", packerInfo->name);
+            subTexture.SetI32("x", packerInfo->x + offsetX + options.extrude);
+            subTexture.SetI32("y", packerInfo->y + offsetY + options.extrude);
+            subTexture.SetI32("width", packerInfo->width);
+            subTexture.SetI32("height", packerInfo->height);
+            if (packerInfo->rotated)
+                subTexture.SetBool("rotated", true);
+
+            if (packerInfo->frameWidth || packerInfo->frameHeight)
             {
-                spriteSheetImage.SetPixelInt(packerInfo->x + offsetX, packerInfo->y + offsetY + y, INNER_BOUNDS_DEBUG_COLOR);
-                spriteSheetImage.SetPixelInt(packerInfo->x + offsetX + packerInfo->width, packerInfo->y + offsetY + y, INNER_BOUNDS_DEBUG_COLOR);
+                subTexture.SetI32("frameWidth", packerInfo->frameWidth);
+                subTexture.SetI32("frameHeight", packerInfo->frameHeight);
+                subTexture.SetI32("offsetX", packerInfo->offsetX);
+                subTexture.SetI32("offsetY", packerInfo->offsetY);
             }
+
+            ++numSprites;
+            pageSpriteArea += packerInfo->width * packerInfo->height;
         }
+
+        int pageArea = pageSizes[i].x_ * pageSizes[i].y_;
+        totalPageArea += pageArea;
+        URHO3D_LOGINFO("Page " + String(i) + ": " + String(pageSizes[i].x_) + "x" + String(pageSizes[i].y_) + ", " +
+            String(numSprites) + " images, " + String(100.0f * pageSpriteArea / pageArea) + "% used.");
+
+        URHO3D_LOGINFO("Saving output image.");
+        options.pages[i]->SavePNG(GetPageFileName(outputFile, i));
+
+        URHO3D_LOGINFO("Saving SpriteSheet xml file.");
+        File spriteSheetFile(context);
+        spriteSheetFile.Open(GetPageFileName(spriteSheetFileName, i), FILE_WRITE);
+        xml.Save(spriteSheetFile);
     }
 
-    URHO3D_LOGINFO("Saving output image.");
-    spriteSheetImage.SavePNG(outputFile);
+    // remove pages left over from a previous run with more pages
+    for (int i = pageSizes.Size(); i < numPreviousPages; ++i)
+    {
+        fileSystem->Delete(GetPageFileName(spriteSheetFileName, i));
+        fileSystem->Delete(GetPageFileName(outputFile, i));
+    }
 
-    URHO3D_LOGINFO("Saving SpriteSheet xml file.");
-    File spriteSheetFile(context);
-    spriteSheetFile.Open(spriteSheetFileName, FILE_WRITE);
-    xml.Save(spriteSheetFile);
+    long long writeTime = stepTimer.GetUSec(false);
+    URHO3D_LOGINFO("Packed " + String(packerInfos.Size()) + " images on " + String(pageSizes.Size()) + " pages, " +
+        String(100.0f * totalSpriteArea / totalPageArea) + "% used" +
+        (incremental ? ", " + String(numKept) + " images kept their position" : String::EMPTY) + ".");
+    URHO3D_LOGINFO("Load " + String(loadTime / 1000) + " ms, pack " + String(packTime / 1000) + " ms, write " +
+        String(writeTime / 1000) + " ms, total " + String(totalTimer.GetUSec(false) / 1000) + " ms.");
 }
@@ -0,0 +1,163 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../ForceAssert.h"
+
+#include <Urho3D/Core/AsyncOperation.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/FrameScheduler.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+/// Run frames until all operations have completed.
+static void RunFrames(Context* context, std::initializer_list<AsyncOperation*> operations)
+{
+    auto* scheduler = context->GetSubsystem<FrameScheduler>();
+
+    for (i32 i = 0; i < 5000; ++i)
+    {
+        bool completed = true;
+        for (AsyncOperation* operation : operations)
+            completed &= operation->IsCompleted();
+        if (completed)
+            return;
+
+        scheduler->SendEvent(E_BEGINFRAME);
+        scheduler->Update(-1);
+        Time::Sleep(1);
+    }
+
+    assert(false);
+}
+
+static void TestChaining()
+{
+    SharedPtr<AsyncOperation> first(new AsyncOperation());
+    SharedPtr<AsyncValue<i32>> second(new AsyncValue<i32>());
+    Vector<i32> steps;
+
+    // Functions run in the order they were added, and may complete other operations
+    first->Then([&]() { steps.Push(1); second->Complete(first->IsSucceeded() ? 10 : -10); });
+    first->Then([&]() { steps.Push(2); });
+    second->Then([&]() { steps.Push(second->GetValue()); });
+    assert(steps.Empty());
+    assert(!first->IsCompleted() && !second->IsCompleted());
+
+    first->Complete();
+    assert(steps.Size() == 3 && steps[0] == 1 && steps[1] == 10 && steps[2] == 2);
+    assert(first->IsSucceeded() && second->IsSucceeded() && second->GetValue() == 10);
+
+    // Completing again does nothing, and functions added afterwards run immediately
+    first->Complete(false);
+    assert(first->IsSucceeded());
+    first->Then([&]() { steps.Push(3); });
+    assert(steps.Size() == 4 && steps[3] == 3);
+
+    SharedPtr<AsyncValue<String>> failed(new AsyncValue<String>());
+    failed->SetValue("Partial");
+    failed->Complete(false);
+    assert(failed->IsCompleted() && !failed->IsSucceeded() && failed->GetValue() == "Partial");
+}
+
+static void TestRunAsync(Context* context)
+{
+    auto* queue = context->GetSubsystem<WorkQueue>();
+
+    // Without worker threads the functions run in the main thread from the frame scheduler. With them they run in the
+    // workers. Either way the operations complete only at the start of a frame
+    for (i32 numThreads = 0; numThreads <= 1; ++numThreads)
+    {
+        if (numThreads)
+            queue->CreateThreads(numThreads);
+
+        i32 result = 0;
+        SharedPtr<AsyncOperation> operation = queue->RunAsync([&result]() { result = 5; });
+        SharedPtr<AsyncValue<i32>> value = queue->RunAsync<i32>([]() { return 6 * 7; });
+        assert(!operation->IsCompleted() && !value->IsCompleted());
+
+        // Chain more work from the completion
+        SharedPtr<AsyncValue<i32>> chained;
+        value->Then([&]() { chained = queue->RunAsync<i32>([previous = value->GetValue()]() { return previous + 1; }); });
+
+        RunFrames(context, {operation, value});
+        assert(result == 5);
+        assert(value->IsSucceeded() && value->GetValue() == 42);
+        assert(chained);
+
+        RunFrames(context, {chained});
+        assert(chained->IsSucceeded() && chained->GetValue() == 43);
+    }
+}
+
+static void TestGetResourceAsync(Context* context)
+{
+    auto* fileSystem = context->GetSubsystem<FileSystem>();
+    auto* cache = context->GetSubsystem<ResourceCache>();
+
+    String dir = fileSystem->GetTemporaryDir() + "Urho3DTestAsyncResources/";
+    fileSystem->CreateDir(dir);
+    {
+        File file(context, dir + "Test.xml", FILE_WRITE);
+        file.WriteLine("<test value=\"1\" />");
+    }
+    cache->AddResourceDir(dir);
+
+    SharedPtr<AsyncValue<SharedPtr<XMLFile>>> first = cache->GetResourceAsync<XMLFile>("Test.xml");
+    SharedPtr<AsyncValue<SharedPtr<XMLFile>>> second = cache->GetResourceAsync<XMLFile>("Test.xml");
+    SharedPtr<AsyncValue<SharedPtr<XMLFile>>> missing = cache->GetResourceAsync<XMLFile>("Missing.xml");
+    assert(!first->IsCompleted() && !second->IsCompleted());
+
+    RunFrames(context, {first, second, missing});
+    assert(first->IsSucceeded() && first->GetValue());
+    assert(first->GetValue()->GetRoot().GetName() == "test");
+    assert(second->IsSucceeded() && second->GetValue() == first->GetValue());
+    assert(!missing->IsSucceeded() && !missing->GetValue());
+
+    // A loaded resource completes immediately
+    SharedPtr<AsyncValue<SharedPtr<XMLFile>>> loaded = cache->GetResourceAsync<XMLFile>("Test.xml");
+    assert(loaded->IsCompleted() && loaded->GetValue() == first->GetValue());
+
+    cache->RemoveResourceDir(dir);
+    fileSystem->Delete(dir + "Test.xml");
+}
+
+static void TestNextFrame(Context* context)
+{
+    auto* scheduler = context->GetSubsystem<FrameScheduler>();
+
+    SharedPtr<AsyncOperation> next = scheduler->NextFrame();
+    SharedPtr<AsyncOperation> after;
+    next->Then([&]() { after = scheduler->NextFrame(); });
+    assert(!next->IsCompleted());
+
+    // An operation requested on completion belongs to the frame after
+    scheduler->SendEvent(E_BEGINFRAME);
+    assert(next->IsCompleted() && next->IsSucceeded());
+    assert(after && !after->IsCompleted());
+
+    scheduler->SendEvent(E_BEGINFRAME);
+    assert(after->IsCompleted());
+}
+
+void Test_Core_AsyncOperation()
+{
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new FrameScheduler(context));
+    context->RegisterSubsystem(new WorkQueue(context));
+    context->RegisterSubsystem(new FileSystem(context));
+    context->RegisterSubsystem(new ResourceCache(context));
+    XMLFile::RegisterObject(context);
+
+    TestChaining();
+    TestRunAsync(context);
+    TestGetResourceAsync(context);
+    TestNextFrame(context);
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+// Compiled as C++20 when the compiler supports it, see CMakeLists.txt
+
+#include "../ForceAssert.h"
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Coroutine.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+static AsyncTask WaitForOperations(SharedPtr<AsyncOperation> first, SharedPtr<AsyncValue<i32>> second, Vector<i32>& steps)
+{
+    steps.Push(1);
+    bool success = co_await first;
+    steps.Push(success ? 2 : -2);
+    i32 value = co_await second;
+    steps.Push(value);
+}
+
+static AsyncTask WaitForTask(AsyncTask task, Vector<i32>& steps)
+{
+    co_await task;
+    steps.Push(100);
+}
+
+static AsyncTask WaitForWork(WorkQueue* queue, i32& result)
+{
+    result = co_await queue->RunAsync<i32>([]() { return 6 * 7; });
+}
+
+#endif
+
+void Test_Core_Coroutine()
+{
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new WorkQueue(context));
+
+    // The coroutine runs until the first operation that has not completed, and resumes when it completes
+    SharedPtr<AsyncOperation> first(new AsyncOperation());
+    SharedPtr<AsyncValue<i32>> second(new AsyncValue<i32>());
+    Vector<i32> steps;
+    AsyncTask task = WaitForOperations(first, second, steps);
+    AsyncTask outer = WaitForTask(task, steps);
+    assert(steps.Size() == 1 && steps[0] == 1);
+    assert(!task.IsCompleted() && !outer.IsCompleted());
+
+    first->Complete();
+    assert(steps.Size() == 2 && steps[1] == 2);
+
+    second->Complete(7);
+    assert(steps.Size() == 4 && steps[2] == 7 && steps[3] == 100);
+    assert(task.IsCompleted() && outer.IsCompleted());
+
+    // Completed operations do not suspend
+    steps.Clear();
+    AsyncTask immediate = WaitForOperations(first, second, steps);
+    assert(immediate.IsCompleted());
+    assert(steps.Size() == 3 && steps[1] == 2 && steps[2] == 7);
+
+    // Work queue results resume the coroutine at the start of a frame
+    auto* queue = context->GetSubsystem<WorkQueue>();
+    i32 result = 0;
+    AsyncTask work = WaitForWork(queue, result);
+    for (i32 i = 0; i < 100 && !work.IsCompleted(); ++i)
+        queue->SendEvent(E_BEGINFRAME);
+    assert(work.IsCompleted() && result == 42);
+#endif
+}
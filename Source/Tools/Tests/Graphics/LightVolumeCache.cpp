@@ -0,0 +1,163 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../ForceAssert.h"
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static constexpr i32 NUM_BOXES = 300;
+static constexpr i32 NUM_FRAMES = 300;
+
+static Vector3 RandomPosition()
+{
+    return Vector3(Random(-40.0f, 40.0f), Random(-10.0f, 10.0f), Random(-40.0f, 40.0f));
+}
+
+static void CreateBox(Scene* scene, Model* model, Vector<WeakPtr<Node>>& boxes)
+{
+    Node* node = scene->CreateChild("Box");
+    node->SetPosition(RandomPosition());
+    node->CreateComponent<StaticModel>()->SetModel(model);
+    boxes.Push(WeakPtr<Node>(node));
+}
+
+// Reference query that does not use the cache
+static Vector<Drawable*> QueryLightVolume(Octree* octree, Light* light)
+{
+    Vector<Drawable*> result;
+    if (light->GetLightType() == LIGHT_SPOT)
+    {
+        FrustumOctreeQuery query(result, light->GetFrustum(), DrawableTypes::Geometry);
+        octree->GetDrawables(query);
+    }
+    else
+    {
+        SphereOctreeQuery query(result, Sphere(light->GetNode()->GetWorldPosition(), light->GetRange()),
+            DrawableTypes::Geometry);
+        octree->GetDrawables(query);
+    }
+    Sort(result.Begin(), result.End());
+    return result;
+}
+
+// Move, add and remove boxes. Some boxes are removed and added back, so that the same drawable pointer leaves and
+// reenters the octree at another position
+static void ChangeBoxes(Scene* scene, Model* model, Vector<WeakPtr<Node>>& boxes)
+{
+    for (i32 i = 0; i < 10; ++i)
+    {
+        Node* node = boxes[Rand() % boxes.Size()];
+        if (i % 2)
+            node->Translate(Vector3(Random(-2.0f, 2.0f), 0.0f, Random(-2.0f, 2.0f)));
+        else
+            node->SetPosition(RandomPosition());
+    }
+
+    for (i32 i = 0; i < 2; ++i)
+    {
+        i32 index = Rand() % boxes.Size();
+        SharedPtr<Node> node(boxes[index]);
+        node->Remove();
+        node->SetPosition(RandomPosition());
+        scene->AddChild(node);
+    }
+
+    for (i32 i = 0; i < 3; ++i)
+    {
+        i32 index = Rand() % boxes.Size();
+        boxes[index]->Remove();
+        boxes.EraseSwap(index);
+        CreateBox(scene, model, boxes);
+    }
+}
+
+void Test_Graphics_LightVolumeCache()
+{
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new WorkQueue(context));
+    Octree::RegisterObject(context);
+    Light::RegisterObject(context);
+    StaticModel::RegisterObject(context);
+
+    SharedPtr<Scene> scene(new Scene(context));
+    Octree* octree = scene->CreateComponent<Octree>();
+
+    SharedPtr<Model> model(new Model(context));
+    model->SetBoundingBox(BoundingBox(-0.5f, 0.5f));
+
+    Node* spotNode = scene->CreateChild("Spot");
+    spotNode->SetPosition(Vector3(0.0f, 0.0f, -30.0f));
+    Light* spotLight = spotNode->CreateComponent<Light>();
+    spotLight->SetLightType(LIGHT_SPOT);
+    spotLight->SetRange(50.0f);
+    spotLight->SetFov(45.0f);
+
+    Node* pointNode = scene->CreateChild("Point");
+    pointNode->SetPosition(Vector3(10.0f, 0.0f, 10.0f));
+    Light* pointLight = pointNode->CreateComponent<Light>();
+    pointLight->SetLightType(LIGHT_POINT);
+    pointLight->SetRange(20.0f);
+
+    SetRandomSeed(1234);
+    Vector<WeakPtr<Node>> boxes;
+    for (i32 i = 0; i < NUM_BOXES; ++i)
+        CreateBox(scene, model, boxes);
+
+    FrameInfo frame;
+    frame.timeStep_ = 1.0f / 60.0f;
+    i32 numSpotQueries = 0;
+    i32 numPointQueries = 0;
+
+    for (i32 i = 0; i < NUM_FRAMES; ++i)
+    {
+        frame.frameNumber_ = i + 1;
+
+        // Changes before the octree update, as from scene update logic
+        scene->Update(frame.timeStep_);
+        ChangeBoxes(scene, model, boxes);
+
+        // Occasionally change the lights, or leave a frame without the octree update so that the changes are discarded
+        if (i % 23 == 0)
+            spotNode->Rotate(Quaternion(5.0f, Vector3::UP));
+        if (i % 29 == 0)
+            pointNode->Translate(Vector3(1.0f, 0.0f, 0.0f));
+        if (i % 17 == 0)
+            continue;
+
+        octree->Update(frame);
+
+        // Changes after the octree update, as from another view's events, are pending until the next update
+        if (i % 3 == 0)
+            ChangeBoxes(scene, model, boxes);
+
+        const Vector<Drawable*>& spotDrawables = spotLight->GetVolumeDrawables(octree);
+        assert(spotDrawables == QueryLightVolume(octree, spotLight));
+        if (!spotDrawables.Empty())
+            ++numSpotQueries;
+
+        // Leave the point light unqueried on some frames, so that its cache falls more than one update behind
+        if (i % 5 != 0)
+        {
+            const Vector<Drawable*>& pointDrawables = pointLight->GetVolumeDrawables(octree);
+            assert(pointDrawables == QueryLightVolume(octree, pointLight));
+            if (!pointDrawables.Empty())
+                ++numPointQueries;
+        }
+    }
+
+    // Make sure the lights actually saw drawables
+    assert(numSpotQueries > NUM_FRAMES / 2);
+    assert(numPointQueries > NUM_FRAMES / 2);
+}
@@ -0,0 +1,198 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../ForceAssert.h"
+
+#include <Urho3D/Graphics/TriangleBVH.h>
+#include <Urho3D/Math/Frustum.h>
+#include <Urho3D/Math/Ray.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static const i32 GRID_SIZE = 10;
+
+// Two stacked grids of upward facing quads, one at y = 0 and one at y = 1 covering only half of the area
+static void CreateGrids(Vector<Vector3>& vertices, Vector<u16>& indices)
+{
+    for (i32 layer = 0; layer < 2; ++layer)
+    {
+        i32 width = layer ? GRID_SIZE / 2 : GRID_SIZE;
+        u16 first = (u16)vertices.Size();
+
+        for (i32 z = 0; z <= GRID_SIZE; ++z)
+        {
+            for (i32 x = 0; x <= width; ++x)
+                vertices.Push(Vector3((float)x, (float)layer, (float)z));
+        }
+
+        for (i32 z = 0; z < GRID_SIZE; ++z)
+        {
+            for (i32 x = 0; x < width; ++x)
+            {
+                u16 v0 = first + (u16)(z * (width + 1) + x);
+                u16 v1 = v0 + 1;
+                u16 v2 = v0 + (u16)(width + 1);
+                u16 v3 = v2 + 1;
+                indices.Push(v0);
+                indices.Push(v2);
+                indices.Push(v1);
+                indices.Push(v1);
+                indices.Push(v2);
+                indices.Push(v3);
+            }
+        }
+    }
+}
+
+static bool ContainsTriangle(const Vector<u32>& triangles, u32 i0, u32 i1, u32 i2)
+{
+    for (i32 i = 0; i + 2 < triangles.Size(); i += 3)
+    {
+        if (triangles[i] == i0 && triangles[i + 1] == i1 && triangles[i + 2] == i2)
+            return true;
+    }
+
+    return false;
+}
+
+static BoundingBox GetTriangleBox(const Vector<Vector3>& vertices, u32 i0, u32 i1, u32 i2)
+{
+    BoundingBox box(vertices[i0], vertices[i0]);
+    box.Merge(vertices[i1]);
+    box.Merge(vertices[i2]);
+    return box;
+}
+
+void Test_Graphics_TriangleBVH()
+{
+    Vector<Vector3> vertices;
+    Vector<u16> indices;
+    CreateGrids(vertices, indices);
+
+    const byte* vertexData = reinterpret_cast<const byte*>(&vertices[0]);
+    const byte* indexData = reinterpret_cast<const byte*>(&indices[0]);
+    const i32 vertexSize = sizeof(Vector3);
+    const i32 numTriangles = indices.Size() / 3;
+
+    // Empty input
+    {
+        TriangleBVH bvh;
+        assert(!bvh.Build(nullptr, vertexSize, indexData, sizeof(u16), 0, indices.Size()));
+        assert(!bvh.Build(vertexData, vertexSize, indexData, sizeof(u16), 0, 2));
+        assert(bvh.GetNumTriangles() == 0);
+        assert(bvh.GetNumNodes() == 0);
+
+        Vector<u32> triangles;
+        bvh.GetTriangles(triangles, BoundingBox(-100.0f, 100.0f));
+        assert(triangles.Empty());
+        assert(bvh.GetHitDistance(Ray(Vector3(0.5f, 10.0f, 0.5f), Vector3::DOWN)) == M_INFINITY);
+    }
+
+    TriangleBVH bvh;
+    assert(bvh.Build(vertexData, vertexSize, indexData, sizeof(u16), 0, indices.Size()));
+    assert(bvh.GetNumTriangles() == numTriangles);
+    assert(bvh.GetNumNodes() > 1);
+    assert(bvh.GetBoundingBox().min_.Equals(Vector3(0.0f, 0.0f, 0.0f)));
+    assert(bvh.GetBoundingBox().max_.Equals(Vector3((float)GRID_SIZE, 1.0f, (float)GRID_SIZE)));
+
+    // Box query returns each triangle once, and every triangle touching the box
+    {
+        BoundingBox queryBox(Vector3(2.2f, -0.5f, 3.7f), Vector3(6.1f, 0.5f, 5.3f));
+        Vector<u32> triangles;
+        bvh.GetTriangles(triangles, queryBox);
+        assert(triangles.Size() % 3 == 0);
+        assert(triangles.Size() < indices.Size());
+
+        for (i32 i = 0; i < indices.Size(); i += 3)
+        {
+            bool touches = queryBox.IsInside(GetTriangleBox(vertices, indices[i], indices[i + 1], indices[i + 2])) != OUTSIDE;
+            if (touches)
+                assert(ContainsTriangle(triangles, indices[i], indices[i + 1], indices[i + 2]));
+        }
+
+        for (i32 i = 0; i < triangles.Size(); i += 3)
+        {
+            for (i32 j = i + 3; j < triangles.Size(); j += 3)
+                assert(triangles[i] != triangles[j] || triangles[i + 1] != triangles[j + 1] || triangles[i + 2] != triangles[j + 2]);
+        }
+
+        // A box containing everything returns all triangles
+        Vector<u32> all;
+        bvh.GetTriangles(all, BoundingBox(-100.0f, 100.0f));
+        assert(all.Size() == indices.Size());
+    }
+
+    // Frustum query returns every triangle touching the frustum
+    {
+        Frustum frustum;
+        frustum.DefineOrtho(2.0f, 1.0f, 1.0f, 0.0f, 4.0f, Matrix3x4(Vector3(3.0f, 2.0f, 6.0f),
+            Quaternion(90.0f, Vector3::RIGHT), 1.0f));
+        Vector<u32> triangles;
+        bvh.GetTriangles(triangles, frustum);
+        assert(!triangles.Empty());
+        assert(triangles.Size() < indices.Size());
+
+        for (i32 i = 0; i < indices.Size(); i += 3)
+        {
+            bool touches = frustum.IsInside(GetTriangleBox(vertices, indices[i], indices[i + 1], indices[i + 2])) != OUTSIDE;
+            if (touches)
+                assert(ContainsTriangle(triangles, indices[i], indices[i + 1], indices[i + 2]));
+        }
+    }
+
+    // Ray hits match testing every triangle
+    for (i32 i = 0; i < 100; ++i)
+    {
+        float x = 0.05f + (float)(i % 10) * 0.99f;
+        float z = 0.13f + (float)(i / 10) * 0.97f;
+        Ray rays[] = {
+            Ray(Vector3(x, 10.0f, z), Vector3::DOWN),
+            Ray(Vector3(x, 10.0f, z), Vector3(0.3f, -1.0f, 0.2f)),
+            Ray(Vector3(x, -10.0f, z), Vector3::UP),
+            Ray(Vector3(x, 0.5f, z), Vector3::FORWARD),
+        };
+
+        for (const Ray& ray : rays)
+        {
+            float expected = ray.HitDistance(vertexData, vertexSize, indexData, sizeof(u16), 0, indices.Size());
+            i32 triangle = NINDEX;
+            float distance = bvh.GetHitDistance(ray, &triangle);
+
+            if (expected == M_INFINITY)
+            {
+                assert(distance == M_INFINITY);
+                assert(triangle == NINDEX);
+            }
+            else
+            {
+                assert(Abs(distance - expected) < 1e-4f);
+                assert(triangle >= 0 && triangle < numTriangles);
+
+                const u32* hit = bvh.GetTriangleVertices(triangle);
+                float hitDistance = ray.HitDistance(vertices[hit[0]], vertices[hit[1]], vertices[hit[2]]);
+                assert(Abs(hitDistance - expected) < 1e-4f);
+            }
+        }
+    }
+
+    // The upper grid is hit first where it exists, and back faces are not hit
+    assert(Abs(bvh.GetHitDistance(Ray(Vector3(2.5f, 10.0f, 2.5f), Vector3::DOWN)) - 9.0f) < 1e-4f);
+    assert(Abs(bvh.GetHitDistance(Ray(Vector3(7.5f, 10.0f, 2.5f), Vector3::DOWN)) - 10.0f) < 1e-4f);
+    assert(bvh.GetHitDistance(Ray(Vector3(2.5f, -10.0f, 2.5f), Vector3::UP)) == M_INFINITY);
+    assert(bvh.GetHitDistance(Ray(Vector3(20.0f, 10.0f, 2.5f), Vector3::DOWN)) == M_INFINITY);
+
+    // Non-indexed build gives the same hits
+    {
+        Vector<Vector3> unindexed;
+        for (i32 i = 0; i < indices.Size(); ++i)
+            unindexed.Push(vertices[indices[i]]);
+
+        TriangleBVH flat;
+        assert(flat.Build(reinterpret_cast<const byte*>(&unindexed[0]), vertexSize, 0, unindexed.Size()));
+        assert(flat.GetNumTriangles() == numTriangles);
+        assert(Abs(flat.GetHitDistance(Ray(Vector3(2.5f, 10.0f, 2.5f), Vector3::DOWN)) - 9.0f) < 1e-4f);
+        assert(Abs(flat.GetHitDistance(Ray(Vector3(7.5f, 10.0f, 2.5f), Vector3::DOWN)) - 10.0f) < 1e-4f);
+    }
+}
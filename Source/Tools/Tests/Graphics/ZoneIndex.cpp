@@ -0,0 +1,115 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../ForceAssert.h"
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/Graphics/ZoneIndex.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Scene/Node.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static Zone* CreateZone(Context* context, Vector<SharedPtr<Node>>& nodes, const Vector3& position, const Quaternion& rotation,
+    const BoundingBox& box, int priority)
+{
+    SharedPtr<Node> node(new Node(context));
+    node->SetPosition(position);
+    node->SetRotation(rotation);
+    SharedPtr<Zone> zone(new Zone(context));
+    node->AddComponent(zone, 0, LOCAL);
+    zone->SetBoundingBox(box);
+    zone->SetPriority(priority);
+    nodes.Push(node);
+    return zone;
+}
+
+// Reference search over all zones
+static Zone* FindZoneLinear(const Vector<Zone*>& zones, const Vector3& point, mask32 zoneMask, mask32 viewMask)
+{
+    Zone* bestZone = nullptr;
+    int bestPriority = M_MIN_INT;
+
+    for (Zone* zone : zones)
+    {
+        if ((zone->GetZoneMask() & zoneMask) && (zone->GetViewMask() & viewMask) && zone->IsInside(point) &&
+            zone->GetPriority() > bestPriority)
+        {
+            bestZone = zone;
+            bestPriority = zone->GetPriority();
+        }
+    }
+
+    return bestZone;
+}
+
+void Test_Graphics_ZoneIndex()
+{
+    SharedPtr<Context> context(new Context());
+    Vector<SharedPtr<Node>> nodes;
+    Vector<Zone*> zones;
+
+    // Empty index
+    {
+        ZoneIndex index;
+        index.Build(zones);
+        assert(index.GetNumZones() == 0);
+        assert(!index.FindZone(Vector3::ZERO, M_MAX_UNSIGNED, M_MAX_UNSIGNED));
+    }
+
+    // Random rotated zones with unique priorities, some overlapping, a few with restricted masks
+    SetRandomSeed(1234);
+    for (i32 i = 0; i < 200; ++i)
+    {
+        Vector3 position(Random(-100.0f, 100.0f), Random(-20.0f, 20.0f), Random(-100.0f, 100.0f));
+        Quaternion rotation(Random(0.0f, 360.0f), Vector3::UP);
+        Vector3 halfSize(Random(1.0f, 15.0f), Random(1.0f, 10.0f), Random(1.0f, 15.0f));
+        Zone* zone = CreateZone(context, nodes, position, rotation, BoundingBox(-halfSize, halfSize), i * 3 % 200 * 2);
+        if (i % 7 == 0)
+            zone->SetZoneMask(2);
+        if (i % 11 == 0)
+            zone->SetViewMask(4);
+        zones.Push(zone);
+    }
+
+    // A default-sized zone spanning everything, and a large zone that covers too many cells for the grid
+    zones.Push(CreateZone(context, nodes, Vector3::ZERO, Quaternion::IDENTITY, BoundingBox(-1000.0f, 1000.0f), -1));
+    zones.Push(CreateZone(context, nodes, Vector3(50.0f, 0.0f, 50.0f), Quaternion::IDENTITY, BoundingBox(-60.0f, 60.0f), 151));
+
+    ZoneIndex index;
+    index.Build(zones);
+    assert(index.GetNumZones() == zones.Size());
+    assert(index.GetGridSize().x_ > 1 && index.GetGridSize().y_ > 1 && index.GetGridSize().z_ > 1);
+
+    const mask32 masks[][2] = {
+        {M_MAX_UNSIGNED, M_MAX_UNSIGNED},
+        {1, M_MAX_UNSIGNED},
+        {2, M_MAX_UNSIGNED},
+        {M_MAX_UNSIGNED, 4},
+    };
+
+    for (i32 i = 0; i < 5000; ++i)
+    {
+        // Mostly inside the zones, some outside the grid bounds
+        Vector3 point(Random(-130.0f, 130.0f), Random(-40.0f, 40.0f), Random(-130.0f, 130.0f));
+        for (const auto& mask : masks)
+            assert(index.FindZone(point, mask[0], mask[1]) == FindZoneLinear(zones, point, mask[0], mask[1]));
+    }
+
+    // Outside all zones
+    assert(!index.FindZone(Vector3(5000.0f, 0.0f, 0.0f), M_MAX_UNSIGNED, M_MAX_UNSIGNED));
+
+    // Zones are stored by pointer, so the index reflects a moved zone only after rebuilding
+    Zone* moved = zones[0];
+    moved->SetPriority(1000);
+    moved->GetNode()->SetPosition(Vector3(500.0f, 0.0f, 500.0f));
+    index.Build(zones);
+    assert(index.FindZone(Vector3(500.0f, 0.0f, 500.0f), M_MAX_UNSIGNED, M_MAX_UNSIGNED) == moved);
+
+    index.Clear();
+    assert(index.GetNumZones() == 0);
+    assert(!index.FindZone(Vector3::ZERO, M_MAX_UNSIGNED, M_MAX_UNSIGNED));
+}
@@ -4,12 +4,30 @@
 #include <iostream>
 
 void Test_Container_Str();
+void Test_Core_AsyncOperation();
+void Test_Core_Coroutine();
+void Test_Graphics_LightVolumeCache();
+void Test_Graphics_TriangleBVH();
+void Test_Graphics_ZoneIndex();
 void Test_Math_BigInt();
+void Test_Math_MaxRectsPacker();
+void Test_Resource_ResourceIndex();
+void Test_Resource_ResourceManifest();
+void Test_Scene_SceneUnload();
 
 void Run()
 {
     Test_Container_Str();
+    Test_Core_AsyncOperation();
+    Test_Core_Coroutine();
+    Test_Graphics_LightVolumeCache();
+    Test_Graphics_TriangleBVH();
+    Test_Graphics_ZoneIndex();
     Test_Math_BigInt();
+    Test_Math_MaxRectsPacker();
+    Test_Resource_ResourceIndex();
+    Test_Resource_ResourceManifest();
+    Test_Scene_SceneUnload();
 }
 
 int main(int argc, char* argv[])
@@ -0,0 +1,139 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../ForceAssert.h"
+
+#include <Urho3D/Math/MaxRectsPacker.h>
+#include <Urho3D/Math/Random.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static bool Overlaps(const IntRect& lhs, const IntRect& rhs)
+{
+    return lhs.left_ < rhs.right_ && rhs.left_ < lhs.right_ && lhs.top_ < rhs.bottom_ && rhs.top_ < lhs.bottom_;
+}
+
+// Placed rectangles lie inside the page and do not overlap each other or any free rectangle
+static void CheckPacking(const MaxRectsPacker& packer, const Vector<IntRect>& placed)
+{
+    i32 area = 0;
+    for (i32 i = 0; i < placed.Size(); ++i)
+    {
+        const IntRect& rect = placed[i];
+        assert(rect.left_ >= 0 && rect.top_ >= 0 && rect.right_ <= packer.GetWidth() && rect.bottom_ <= packer.GetHeight());
+        area += rect.Width() * rect.Height();
+
+        for (i32 j = i + 1; j < placed.Size(); ++j)
+            assert(!Overlaps(rect, placed[j]));
+        for (const IntRect& freeRect : packer.GetFreeRects())
+            assert(!Overlaps(rect, freeRect));
+    }
+
+    assert(packer.GetUsedArea() == area);
+}
+
+void Test_Math_MaxRectsPacker()
+{
+    IntRect rect;
+    bool rotated;
+
+    // Empty packer and empty rectangles
+    {
+        MaxRectsPacker packer;
+        assert(packer.GetFreeRects().Empty());
+        assert(!packer.Insert(1, 1, rect, rotated));
+
+        packer.Reset(16, 16);
+        assert(!packer.Insert(0, 4, rect, rotated));
+        assert(!packer.Occupy(IntRect(2, 2, 2, 6)));
+        assert(packer.GetUsedArea() == 0);
+    }
+
+    // Equal squares fill the page exactly, after which nothing fits
+    {
+        MaxRectsPacker packer(100, 100);
+        Vector<IntRect> placed;
+        for (i32 i = 0; i < 16; ++i)
+        {
+            assert(packer.Insert(25, 25, rect, rotated));
+            assert(!rotated);
+            assert(rect.Width() == 25 && rect.Height() == 25);
+            placed.Push(rect);
+        }
+
+        CheckPacking(packer, placed);
+        assert(packer.GetUsedArea() == 100 * 100);
+        assert(packer.GetFreeRects().Empty());
+        assert(!packer.Insert(1, 1, rect, rotated));
+    }
+
+    // Rotation is used only when allowed, and padding is added after rotating
+    {
+        MaxRectsPacker packer(100, 10);
+        assert(!packer.Insert(10, 100, rect, rotated));
+
+        packer.Reset(102, 10, MAXRECTS_BEST_SHORT_SIDE_FIT, true);
+        assert(packer.Insert(10, 100, rect, rotated, IntVector2(2, 0)));
+        assert(rotated);
+        assert(rect == IntRect(0, 0, 102, 10));
+
+        // Squares are never rotated
+        packer.Reset(64, 64, MAXRECTS_BEST_SHORT_SIDE_FIT, true);
+        assert(packer.Insert(20, 20, rect, rotated));
+        assert(!rotated);
+    }
+
+    // Occupied areas are kept out of later insertions and can not be occupied twice
+    {
+        MaxRectsPacker packer(64, 64);
+        Vector<IntRect> placed;
+        placed.Push(IntRect(16, 16, 48, 48));
+        assert(packer.Occupy(placed.Back()));
+        assert(!packer.Occupy(IntRect(40, 40, 56, 56)));
+        assert(!packer.Occupy(IntRect(60, 60, 70, 70)));
+        assert(packer.Occupy(IntRect(0, 0, 16, 16)));
+        placed.Push(IntRect(0, 0, 16, 16));
+
+        while (packer.Insert(8, 8, rect, rotated))
+            placed.Push(rect);
+
+        CheckPacking(packer, placed);
+        assert(packer.GetUsedArea() == 64 * 64);
+    }
+
+    // Random sizes with every heuristic, with and without rotation
+    const MaxRectsHeuristic heuristics[] = {MAXRECTS_BEST_SHORT_SIDE_FIT, MAXRECTS_BEST_LONG_SIDE_FIT, MAXRECTS_BEST_AREA_FIT,
+        MAXRECTS_BOTTOM_LEFT};
+    for (MaxRectsHeuristic heuristic : heuristics)
+    {
+        for (i32 allowRotation = 0; allowRotation < 2; ++allowRotation)
+        {
+            SetRandomSeed(1234);
+            MaxRectsPacker packer(256, 128, heuristic, allowRotation != 0);
+            assert(packer.GetHeuristic() == heuristic);
+            Vector<IntRect> placed;
+            i32 numRotated = 0;
+
+            for (i32 i = 0; i < 300; ++i)
+            {
+                i32 width = 1 + Random(40);
+                i32 height = 1 + Random(12);
+                if (!packer.Insert(width, height, rect, rotated, IntVector2(1, 1)))
+                    continue;
+
+                assert(rect.Width() == (rotated ? height : width) + 1);
+                assert(rect.Height() == (rotated ? width : height) + 1);
+                if (rotated)
+                    ++numRotated;
+                placed.Push(rect);
+            }
+
+            CheckPacking(packer, placed);
+            assert(allowRotation || numRotated == 0);
+            // Packs at least most of the page
+            assert(packer.GetUsedArea() > 256 * 128 * 3 / 4);
+        }
+    }
+}
@@ -0,0 +1,156 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../ForceAssert.h"
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Resource/ResourceIndex.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static void CreateTestFile(Context* context, const String& fileName)
+{
+    File file(context, fileName, FILE_WRITE);
+    file.WriteString(fileName);
+}
+
+void Test_Resource_ResourceIndex()
+{
+    SharedPtr<Context> context(new Context());
+    SharedPtr<FileSystem> fileSystem(new FileSystem(context));
+
+    String root = fileSystem->GetTemporaryDir() + "UrhoResourceIndexTest" + String(Time::GetTimeSinceEpoch()) + "/";
+    String dir = root + "Data/";
+    fileSystem->CreateDir(dir + "Sub/Deep");
+    fileSystem->CreateDir(dir + "Other");
+    CreateTestFile(context, dir + "a.txt");
+    CreateTestFile(context, dir + ".hidden");
+    CreateTestFile(context, dir + "Sub/b.txt");
+    CreateTestFile(context, dir + "Sub/Deep/c.txt");
+    CreateTestFile(context, dir + "Other/d.txt");
+
+    ResourceIndex index;
+    index.AddDir(fileSystem, dir);
+    assert(index.IsIndexed(dir));
+    assert(!index.IsIndexed(root));
+    assert(index.GetNumFiles() == 5);
+    assert(index.Contains(dir, "a.txt"));
+    assert(index.Contains(dir, ".hidden"));
+    assert(index.Contains(dir, "Sub/Deep/c.txt"));
+    assert(!index.Contains(dir, "Sub"));
+    assert(!index.Contains(dir, "c.txt"));
+
+    // Files and directories added or removed after scanning
+    CreateTestFile(context, dir + "Sub/e.txt");
+    index.UpdateFile(fileSystem, dir, "Sub/e.txt");
+    assert(index.Contains(dir, "Sub/e.txt"));
+
+    fileSystem->Delete(dir + "a.txt");
+    index.UpdateFile(fileSystem, dir, "a.txt");
+    assert(!index.Contains(dir, "a.txt"));
+
+    fileSystem->Rename(dir + "Other", root + "Other");
+    index.UpdateFile(fileSystem, dir, "Other");
+    assert(!index.Contains(dir, "Other/d.txt"));
+
+    fileSystem->Rename(root + "Other", dir + "Other");
+    index.UpdateFile(fileSystem, dir, "Other");
+    assert(index.Contains(dir, "Other/d.txt"));
+    assert(index.GetNumFiles() == 5);
+
+    Vector<String> resourceDirs;
+    resourceDirs.Push(dir);
+
+    // Save and load round trip, with a change made right after saving. Modification times have a resolution of one
+    // second, so the change must be found even if the directory's modification time looks the same
+    VectorBuffer saved;
+    assert(index.Save(saved));
+    CreateTestFile(context, dir + "Sub/Deep/f.txt");
+    {
+        ResourceIndex loaded;
+        MemoryBuffer source(saved.GetBuffer());
+        assert(loaded.Load(source, fileSystem, resourceDirs));
+        assert(loaded.GetNumFiles() == 6);
+        assert(loaded.Contains(dir, "Sub/Deep/f.txt"));
+        assert(loaded.Contains(dir, "Other/d.txt"));
+    }
+
+    // Directories no longer used are dropped, new ones are scanned
+    {
+        Vector<String> otherDirs;
+        otherDirs.Push(dir + "Other/");
+        ResourceIndex loaded;
+        MemoryBuffer source(saved.GetBuffer());
+        assert(loaded.Load(source, fileSystem, otherDirs));
+        assert(!loaded.IsIndexed(dir));
+        assert(loaded.Contains(dir + "Other/", "d.txt"));
+        assert(loaded.GetNumFiles() == 1);
+    }
+
+    // Truncated or corrupt data is rejected
+    for (i32 size = 0; size < (i32)saved.GetSize(); ++size)
+    {
+        ResourceIndex loaded;
+        MemoryBuffer source(saved.GetData(), size);
+        assert(!loaded.Load(source, fileSystem, resourceDirs));
+        assert(!loaded.IsIndexed(dir));
+    }
+    {
+        VectorBuffer corrupt;
+        corrupt.WriteFileID("RIDX");
+        corrupt.WriteU32(0);
+        corrupt.WriteVLE(1000000);
+        ResourceIndex loaded;
+        MemoryBuffer source(corrupt.GetBuffer());
+        assert(!loaded.Load(source, fileSystem, resourceDirs));
+    }
+
+    // A parallel recursive scan returns the same entries in the same order as a scan on one thread
+    for (i32 i = 0; i < 6; ++i)
+    {
+        for (i32 j = 0; j < 4; ++j)
+        {
+            String subDir = dir + "Tree" + String(i) + "/" + String(j) + "/";
+            fileSystem->CreateDir(subDir + "Leaf");
+            CreateTestFile(context, subDir + "g.txt");
+            CreateTestFile(context, subDir + "Leaf/h.txt");
+        }
+    }
+
+    Vector<String> expected;
+    fileSystem->ScanDir(expected, dir, "*", SCAN_FILES | SCAN_DIRS, true);
+
+    context->RegisterSubsystem(new WorkQueue(context));
+    context->GetSubsystem<WorkQueue>()->CreateThreads(3);
+
+    Vector<String> parallel;
+    fileSystem->ScanDir(parallel, dir, "*", SCAN_FILES | SCAN_DIRS, true);
+    assert(parallel == expected);
+
+    Vector<String> filtered;
+    fileSystem->ScanDir(expected, dir, "*.txt", SCAN_FILES, true);
+    context->RemoveSubsystem<WorkQueue>();
+    fileSystem->ScanDir(filtered, dir, "*.txt", SCAN_FILES, true);
+    assert(filtered == expected);
+    assert(filtered.Size() == 53);
+
+    // Clean up the files. Directories are left empty where the file system cannot delete them
+    fileSystem->ScanDir(filtered, root, "*", SCAN_FILES | SCAN_HIDDEN, true);
+    for (const String& name : filtered)
+        fileSystem->Delete(root + name);
+    fileSystem->ScanDir(filtered, root, "*", SCAN_DIRS, true);
+    for (i32 i = filtered.Size() - 1; i >= 0; --i)
+    {
+        if (!filtered[i].EndsWith("."))
+            fileSystem->Delete(root + filtered[i]);
+    }
+    fileSystem->Delete(root);
+}
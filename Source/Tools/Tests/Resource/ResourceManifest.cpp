@@ -0,0 +1,134 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../ForceAssert.h"
+
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Resource/ResourceManifest.h>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static ResourceLoadRecord CreateRecord(const String& type, const String& name, i32 parent, i32 depth, u32 size,
+    long long queuedMSec, long long loadedMSec, long long finishedMSec)
+{
+    ResourceLoadRecord record;
+    record.type_ = StringHash(type);
+    record.name_ = name;
+    record.parent_ = parent;
+    record.depth_ = depth;
+    record.size_ = size;
+    record.queuedUSec_ = queuedMSec * 1000;
+    record.loadedUSec_ = loadedMSec * 1000;
+    record.finishedUSec_ = finishedMSec * 1000;
+    record.requested_ = true;
+    record.success_ = true;
+    return record;
+}
+
+void Test_Resource_ResourceManifest()
+{
+    // A material with a texture and a technique, the technique with a shader, and a model. The technique and its shader
+    // load last, holding up the material
+    Vector<ResourceLoadRecord> records;
+    records.Push(CreateRecord("Material", "Materials/A.xml", -1, 0, 100, 0, 100, 500));
+    records.Push(CreateRecord("Texture2D", "Textures/A.png", 0, 1, 5000, 10, 400, 450));
+    records.Push(CreateRecord("Technique", "Techniques/T.xml", 0, 1, 300, 20, 420, 460));
+    records.Push(CreateRecord("Shader", "Shaders/S.glsl", 2, 2, 300, 30, 430, 470));
+    records.Push(CreateRecord("Model", "Models/M.mdl", -1, 0, 5000, 5, 200, 300));
+    records.Push(CreateRecord("Texture2D", "Textures/B.png", 0, 1, 300, 40, 120, 440));
+
+    // Only prefetched, failed, or never finished resources are not part of the load
+    records.Push(CreateRecord("Texture2D", "Textures/Unused.png", -1, 0, 9000, 0, 50, 60));
+    records.Back().requested_ = false;
+    records.Push(CreateRecord("Texture2D", "Textures/Missing.png", 0, 1, 0, 50, 60, 70));
+    records.Back().success_ = false;
+    records.Push(CreateRecord("Texture2D", "Textures/Pending.png", 0, 1, 700, 50, 600, -1));
+
+    ResourceManifest manifest;
+    manifest.SetRecords(records);
+
+    // Deepest first, then largest, then by name
+    const Vector<ResourceManifestEntry>& resources = manifest.GetResources();
+    assert(resources.Size() == 6);
+    assert(resources[0].name_ == "Shaders/S.glsl" && resources[0].depth_ == 2);
+    assert(resources[1].name_ == "Textures/A.png" && resources[1].type_ == StringHash("Texture2D"));
+    assert(resources[2].name_ == "Techniques/T.xml");
+    assert(resources[3].name_ == "Textures/B.png");
+    assert(resources[4].name_ == "Models/M.mdl" && resources[4].size_ == 5000);
+    assert(resources[5].name_ == "Materials/A.xml");
+    assert(manifest.GetTotalSize() == 11000);
+
+    // Save and load round trip
+    VectorBuffer saved;
+    assert(manifest.Save(saved));
+    {
+        ResourceManifest loaded;
+        MemoryBuffer source(saved.GetBuffer());
+        assert(loaded.Load(source));
+        assert(loaded.GetResources().Size() == resources.Size());
+        for (i32 i = 0; i < resources.Size(); ++i)
+        {
+            const ResourceManifestEntry& entry = loaded.GetResources()[i];
+            assert(entry.type_ == resources[i].type_);
+            assert(entry.name_ == resources[i].name_);
+            assert(entry.size_ == resources[i].size_);
+            assert(entry.depth_ == resources[i].depth_);
+        }
+    }
+
+    // Truncated or foreign data is rejected and leaves the manifest empty
+    for (i32 size = 0; size < (i32)saved.GetSize(); ++size)
+    {
+        ResourceManifest loaded;
+        MemoryBuffer source(saved.GetData(), size);
+        assert(!loaded.Load(source));
+        assert(loaded.GetResources().Empty());
+    }
+    {
+        VectorBuffer foreign;
+        foreign.WriteFileID("RIDX");
+        foreign.WriteVLE(0);
+        ResourceManifest loaded;
+        MemoryBuffer source(foreign.GetBuffer());
+        assert(!loaded.Load(source));
+    }
+
+    // An empty manifest is valid
+    {
+        ResourceManifest empty;
+        VectorBuffer buffer;
+        assert(empty.Save(buffer));
+        ResourceManifest loaded;
+        MemoryBuffer source(buffer.GetBuffer());
+        assert(loaded.Load(source));
+        assert(loaded.GetResources().Empty());
+        assert(loaded.GetTotalSize() == 0);
+    }
+
+    // The critical path follows the dependency that loaded last for as long as it loaded after its parent
+    ResourceLoadReport report = CreateResourceLoadReport(records);
+    assert(report.numResources_ == 6);
+    assert(report.totalSize_ == 11000);
+    assert(report.totalUSec_ == 500000);
+    assert(report.criticalPathUSec_ == 500000);
+    assert(report.criticalPath_.Size() == 3);
+    assert(report.criticalPath_[0] == "Materials/A.xml");
+    assert(report.criticalPath_[1] == "Techniques/T.xml");
+    assert(report.criticalPath_[2] == "Shaders/S.glsl");
+    assert(report.ToString() ==
+        "6 resources (10 KB) in 500 ms, critical path 500 ms: Materials/A.xml -> Techniques/T.xml -> Shaders/S.glsl");
+
+    // Parents that depend on each other do not make the critical path loop
+    records[0].parent_ = 2;
+    report = CreateResourceLoadReport(records);
+    assert(report.criticalPath_.Size() <= records.Size());
+
+    // Nothing recorded
+    report = CreateResourceLoadReport(Vector<ResourceLoadRecord>());
+    assert(report.numResources_ == 0);
+    assert(report.criticalPath_.Empty());
+    assert(report.ToString() == "0 resources (0 KB) in 0 ms, critical path 0 ms");
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../ForceAssert.h"
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+#ifdef URHO3D_PHYSICS
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+static constexpr i32 NUM_GROUPS = 10;
+static constexpr i32 NUM_NODES_PER_GROUP = 100;
+
+void Test_Scene_SceneUnload()
+{
+    SharedPtr<Context> context(new Context());
+    Octree::RegisterObject(context);
+    StaticModel::RegisterObject(context);
+#ifdef URHO3D_PHYSICS
+    PhysicsWorld::RegisterObject(context);
+    RigidBody::RegisterObject(context);
+    CollisionShape::RegisterObject(context);
+#endif
+
+    // Keep the octree and physics world alive after they are removed, to check that nothing is left in them
+    SharedPtr<Scene> scene(new Scene(context));
+    SharedPtr<Octree> octree(scene->CreateComponent<Octree>());
+#ifdef URHO3D_PHYSICS
+    SharedPtr<PhysicsWorld> physicsWorld(scene->CreateComponent<PhysicsWorld>());
+#endif
+
+    WeakPtr<Node> firstNode;
+    WeakPtr<StaticModel> firstDrawable;
+    for (i32 i = 0; i < NUM_GROUPS; ++i)
+    {
+        Node* group = scene->CreateChild("Group");
+        group->AddTag("Group");
+
+        for (i32 j = 0; j < NUM_NODES_PER_GROUP; ++j)
+        {
+            Node* node = group->CreateChild();
+            node->SetPosition(Vector3(i * 2.0f, 0.0f, j * 2.0f));
+            StaticModel* drawable = node->CreateComponent<StaticModel>();
+#ifdef URHO3D_PHYSICS
+            node->CreateComponent<RigidBody>()->SetMass(1.0f);
+            node->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+#endif
+
+            if (!firstNode)
+            {
+                firstNode = node;
+                firstDrawable = drawable;
+            }
+        }
+    }
+
+    assert(octree->GetNumDrawables() == NUM_GROUPS * NUM_NODES_PER_GROUP);
+#ifdef URHO3D_PHYSICS
+    assert(physicsWorld->GetWorld()->getNumCollisionObjects() == NUM_GROUPS * NUM_NODES_PER_GROUP);
+#endif
+
+    SharedPtr<Node> receiver(new Node(context));
+    i32 numRemovalEvents = 0;
+    i32 numUnloadingEvents = 0;
+    receiver->SubscribeToEvent(scene, E_NODEREMOVED, [&](StringHash, VariantMap&) { ++numRemovalEvents; });
+    receiver->SubscribeToEvent(scene, E_COMPONENTREMOVED, [&](StringHash, VariantMap&) { ++numRemovalEvents; });
+    receiver->SubscribeToEvent(E_SCENEUNLOADING, [&](StringHash, VariantMap& eventData)
+    {
+        assert(eventData[SceneUnloading::P_SCENE].GetPtr() == scene);
+        ++numUnloadingEvents;
+    });
+
+    // Regular removal is signaled
+    firstNode->Remove();
+    assert(numRemovalEvents == 1);
+    assert(!firstNode && !firstDrawable);
+    numRemovalEvents = 0;
+
+    WeakPtr<Node> lastNode(scene->GetChildren().Back()->GetChildren().Back());
+    WeakPtr<StaticModel> lastDrawable(lastNode->GetComponent<StaticModel>());
+
+    scene->Unload();
+
+    assert(numUnloadingEvents == 1);
+    assert(numRemovalEvents == 0);
+    assert(scene->GetNumChildren() == 0 && scene->GetNumComponents() == 0);
+    assert(!lastNode && !lastDrawable);
+    Vector<Node*> taggedNodes;
+    assert(!scene->GetNodesWithTag(taggedNodes, "Group") || taggedNodes.Empty());
+
+    assert(!octree->GetScene());
+    assert(octree->GetNumDrawables() == 0);
+#ifdef URHO3D_PHYSICS
+    assert(!physicsWorld->GetScene());
+    assert(physicsWorld->GetWorld()->getNumCollisionObjects() == 0);
+#endif
+
+    // The scene can be filled again
+    Octree* newOctree = scene->CreateComponent<Octree>();
+    scene->CreateChild()->CreateComponent<StaticModel>();
+    assert(newOctree->GetNumDrawables() == 1);
+    assert(octree->GetNumDrawables() == 0);
+}
@@ -0,0 +1,40 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../Precompiled.h"
+
+#include "../Core/AsyncOperation.h"
+#include "../Core/Thread.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+AsyncOperation::~AsyncOperation() = default;
+
+void AsyncOperation::Then(const AsyncContinuation& function)
+{
+    if (completed_)
+        function();
+    else
+        continuations_.Push(function);
+}
+
+void AsyncOperation::Complete(bool success)
+{
+    assert(Thread::IsMainThread());
+    if (completed_)
+        return;
+
+    completed_ = true;
+    succeeded_ = success;
+
+    // Take the functions out first, as they may release the last reference to this operation
+    Vector<AsyncContinuation> continuations;
+    continuations.Swap(continuations_);
+    for (const AsyncContinuation& function : continuations)
+        function();
+}
+
+}
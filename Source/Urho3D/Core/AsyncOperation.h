@@ -0,0 +1,71 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "../Base/PrimitiveTypes.h"
+#include "../Container/Ptr.h"
+#include "../Container/Vector.h"
+
+#include <functional>
+
+namespace Urho3D
+{
+
+/// Function called in the main thread when an asynchronous operation completes.
+using AsyncContinuation = std::function<void()>;
+
+/// Asynchronous operation that completes in the main thread, such as a background loaded resource or a work queue job. Functions can be chained to run on completion, and with C++20 it can be awaited in a coroutine, see Coroutine.h.
+/// @nobind
+class URHO3D_API AsyncOperation : public RefCounted
+{
+public:
+    /// Construct.
+    AsyncOperation() = default;
+    /// Destruct.
+    ~AsyncOperation() override;
+
+    /// Add a function to call in the main thread on completion. Called immediately if already completed.
+    void Then(const AsyncContinuation& function);
+    /// Complete and call the functions waiting for completion. Must be called in the main thread and only once.
+    void Complete(bool success = true);
+
+    /// Return whether completed.
+    bool IsCompleted() const { return completed_; }
+    /// Return whether completed successfully.
+    bool IsSucceeded() const { return succeeded_; }
+
+private:
+    /// Functions to call on completion.
+    Vector<AsyncContinuation> continuations_;
+    /// Completed flag.
+    bool completed_{};
+    /// Success flag.
+    bool succeeded_{};
+};
+
+/// Asynchronous operation with a result value.
+/// @nobind
+template <class T> class AsyncValue : public AsyncOperation
+{
+public:
+    using AsyncOperation::Complete;
+
+    /// Set the result. Can be called from a worker thread before completing.
+    void SetValue(const T& value) { value_ = value; }
+    /// Set the result and complete.
+    void Complete(const T& value, bool success = true)
+    {
+        value_ = value;
+        AsyncOperation::Complete(success);
+    }
+
+    /// Return the result.
+    const T& GetValue() const { return value_; }
+
+private:
+    /// Result.
+    T value_{};
+};
+
+}
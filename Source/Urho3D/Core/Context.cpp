@@ -66,17 +66,22 @@ void EventReceiverGroup::Add(Object* object)
 
 void EventReceiverGroup::Remove(Object* object)
 {
-    if (inSend_ > 0)
+    // Search from the end, as receivers are usually destroyed in reverse order of creation, for example when a scene is
+    // unloaded. Searching from the start would make removing many receivers of the same event quadratic
+    for (i32 i = receivers_.Size() - 1; i >= 0; --i)
     {
-        Vector<Object*>::Iterator i = receivers_.Find(object);
-        if (i != receivers_.End())
+        if (receivers_[i] == object)
         {
-            (*i) = nullptr;
-            dirty_ = true;
+            if (inSend_ > 0)
+            {
+                receivers_[i] = nullptr;
+                dirty_ = true;
+            }
+            else
+                receivers_.Erase(i);
+            return;
         }
     }
-    else
-        receivers_.Remove(object);
 }
 
 void RemoveNamedAttribute(HashMap<StringHash, Vector<AttributeInfo>>& attributes, StringHash objectType, const char* name)
@@ -0,0 +1,109 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+/// \file
+
+#pragma once
+
+#include "../Core/AsyncOperation.h"
+
+// The engine is built as C++17, so the coroutine types are header-only and available to applications built as C++20
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+
+namespace Urho3D
+{
+
+/// Awaiter that suspends a coroutine until an asynchronous operation completes, and resumes it in the main thread.
+/// @nobind
+template <class Operation> class AsyncAwaiter
+{
+public:
+    /// Construct with the operation to wait for.
+    explicit AsyncAwaiter(const SharedPtr<Operation>& operation) :
+        operation_(operation)
+    {
+        assert(operation_);
+    }
+
+    /// Return whether the operation has already completed, in which case the coroutine does not suspend.
+    bool await_ready() const { return operation_->IsCompleted(); }
+    /// Resume the coroutine on completion.
+    void await_suspend(std::coroutine_handle<> handle) { operation_->Then([handle]() { handle.resume(); }); }
+    /// Return whether the operation succeeded, or its result if it has one.
+    auto await_resume() const
+    {
+        if constexpr (std::is_same_v<Operation, AsyncOperation>)
+            return operation_->IsSucceeded();
+        else
+            return operation_->GetValue();
+    }
+
+private:
+    /// Operation.
+    SharedPtr<Operation> operation_;
+};
+
+/// Coroutine return type. The coroutine starts immediately and runs in the main thread until it first waits for an operation that has not completed. Its own completion can be awaited in turn.
+/// @nobind
+class AsyncTask
+{
+public:
+    /// Coroutine promise.
+    struct promise_type
+    {
+        /// Return the task of the coroutine.
+        AsyncTask get_return_object() { return AsyncTask(operation_); }
+        /// Start immediately.
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        /// Destroy the coroutine when it finishes.
+        std::suspend_never final_suspend() noexcept { return {}; }
+        /// Complete the task, resuming coroutines waiting for it.
+        void return_void() { operation_->Complete(); }
+        /// The engine does not use exceptions, so terminate.
+        void unhandled_exception() { std::terminate(); }
+
+        /// Operation completed when the coroutine finishes.
+        SharedPtr<AsyncOperation> operation_{new AsyncOperation()};
+    };
+
+    /// Return the operation completed when the coroutine finishes.
+    const SharedPtr<AsyncOperation>& GetOperation() const { return operation_; }
+    /// Return whether the coroutine has finished.
+    bool IsCompleted() const { return operation_->IsCompleted(); }
+
+private:
+    /// Construct with the operation of the coroutine.
+    explicit AsyncTask(const SharedPtr<AsyncOperation>& operation) :
+        operation_(operation)
+    {
+    }
+
+    /// Operation completed when the coroutine finishes.
+    SharedPtr<AsyncOperation> operation_;
+};
+
+/// Wait for an operation in a coroutine. Resumes with whether it succeeded.
+inline AsyncAwaiter<AsyncOperation> operator co_await(const SharedPtr<AsyncOperation>& operation)
+{
+    return AsyncAwaiter<AsyncOperation>(operation);
+}
+
+/// Wait for an operation in a coroutine. Resumes with its result.
+template <class T> AsyncAwaiter<AsyncValue<T>> operator co_await(const SharedPtr<AsyncValue<T>>& operation)
+{
+    return AsyncAwaiter<AsyncValue<T>>(operation);
+}
+
+/// Wait for another coroutine to finish.
+inline AsyncAwaiter<AsyncOperation> operator co_await(const AsyncTask& task)
+{
+    return AsyncAwaiter<AsyncOperation>(task.GetOperation());
+}
+
+}
+
+#endif
@@ -0,0 +1,302 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../Precompiled.h"
+
+#include "../Core/CoreEvents.h"
+#include "../Core/FrameScheduler.h"
+#include "../Core/Profiler.h"
+#include "../IO/Log.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Time left unused before the frame deadline, as tasks check their time limit only between units of work.
+static const long long SLACK_MARGIN_USEC = 500;
+
+/// Recurring frame task.
+struct FrameTask : public RefCounted
+{
+    /// ID.
+    u32 id_{};
+    /// Owner. Null if the task has no owner.
+    WeakPtr<Object> owner_;
+    /// Whether an owner was given.
+    bool hasOwner_{};
+    /// Name for statistics and starvation reports.
+    String name_;
+    /// Work function.
+    FrameTaskFunction function_;
+    /// Priority.
+    i32 priority_{};
+    /// Minimum time per frame.
+    long long sliceUSec_{};
+    /// Maximum time to wait with work remaining before running outside the budget.
+    long long maxDelayUSec_{};
+    /// Scheduler clock time since which the task has been waiting to run.
+    long long waitStart_{};
+    /// Update in which the task last ran.
+    u32 lastUpdate_{M_MAX_UNSIGNED};
+    /// Whether work remains.
+    bool pending_{true};
+    /// Whether the task has been starved and not yet run within the budget since.
+    bool starved_{};
+    /// Removed flag. Removed tasks may still be referenced by an update in progress.
+    bool removed_{};
+    /// Number of times run.
+    i32 numRuns_{};
+    /// Total time used.
+    long long usedUSec_{};
+    /// Number of times starved.
+    i32 numStarved_{};
+
+    /// Return whether can run.
+    bool IsRunnable() const { return pending_ && !removed_ && (!hasOwner_ || !owner_.Expired()); }
+};
+
+FrameScheduler::FrameScheduler(Context* context) :
+    Object(context),
+    nextTaskId_(1),
+    updateNumber_(0),
+    defaultBudgetMs_(5),
+    lastBudget_(0),
+    lastUsed_(0),
+    numOverdueJobs_(0)
+{
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(FrameScheduler, HandleBeginFrame));
+}
+
+FrameScheduler::~FrameScheduler() = default;
+
+u32 FrameScheduler::AddTask(Object* owner, const String& name, const FrameTaskFunction& function, i32 priority, int sliceMs,
+    int maxDelayMs)
+{
+    SharedPtr<FrameTask> task(new FrameTask());
+    task->id_ = nextTaskId_++;
+    task->owner_ = owner;
+    task->hasOwner_ = owner != nullptr;
+    task->name_ = name;
+    task->function_ = function;
+    task->priority_ = priority;
+    task->sliceUSec_ = Max(sliceMs, 1) * 1000LL;
+    task->maxDelayUSec_ = Max(maxDelayMs, 0) * 1000LL;
+    task->waitStart_ = clock_.GetUSec(false);
+
+    // Keep the order by priority, with tasks of equal priority in the order they were added
+    Vector<SharedPtr<FrameTask>>::Iterator i = tasks_.Begin();
+    while (i != tasks_.End() && (*i)->priority_ >= priority)
+        ++i;
+    tasks_.Insert(i, task);
+
+    return task->id_;
+}
+
+void FrameScheduler::RemoveTask(u32 id)
+{
+    for (Vector<SharedPtr<FrameTask>>::Iterator i = tasks_.Begin(); i != tasks_.End(); ++i)
+    {
+        if ((*i)->id_ == id)
+        {
+            (*i)->removed_ = true;
+            tasks_.Erase(i);
+            return;
+        }
+    }
+}
+
+void FrameScheduler::WakeTask(u32 id)
+{
+    FrameTask* task = FindTask(id);
+    if (task && !task->pending_)
+    {
+        task->pending_ = true;
+        task->waitStart_ = clock_.GetUSec(false);
+    }
+}
+
+void FrameScheduler::SetTaskSlice(u32 id, int sliceMs)
+{
+    FrameTask* task = FindTask(id);
+    if (task)
+        task->sliceUSec_ = Max(sliceMs, 1) * 1000LL;
+}
+
+void FrameScheduler::Post(const FrameJobFunction& function, i32 priority, int deadlineMs)
+{
+    Job job;
+    job.function_ = function;
+    job.priority_ = priority;
+    job.deadline_ = clock_.GetUSec(false) + Max(deadlineMs, 0) * 1000LL;
+
+    Vector<Job>::Iterator i = jobs_.Begin();
+    while (i != jobs_.End() && i->priority_ >= priority)
+        ++i;
+    jobs_.Insert(i, job);
+}
+
+SharedPtr<AsyncOperation> FrameScheduler::NextFrame()
+{
+    SharedPtr<AsyncOperation> operation(new AsyncOperation());
+    nextFrameOperations_.Push(operation);
+    return operation;
+}
+
+void FrameScheduler::Update(long long slackUSec)
+{
+    URHO3D_PROFILE(UpdateFrameScheduler);
+
+    HiresTimer timer;
+    long long now = clock_.GetUSec(false);
+    long long budget = slackUSec >= 0 ? Max(slackUSec - SLACK_MARGIN_USEC, 0LL) : defaultBudgetMs_ * 1000LL;
+
+    // Forget tasks whose owner is gone
+    for (Vector<SharedPtr<FrameTask>>::Iterator i = tasks_.Begin(); i != tasks_.End();)
+    {
+        if ((*i)->hasOwner_ && (*i)->owner_.Expired())
+        {
+            (*i)->removed_ = true;
+            i = tasks_.Erase(i);
+        }
+        else
+            ++i;
+    }
+
+    // Run from a copy, as tasks may add and remove tasks
+    Vector<SharedPtr<FrameTask>> tasks = tasks_;
+
+    // Work that has waited too long runs first, whether or not there is time left
+    for (const SharedPtr<FrameTask>& task : tasks)
+    {
+        if (task->IsRunnable() && now - task->waitStart_ >= task->maxDelayUSec_)
+        {
+            if (!task->starved_)
+            {
+                URHO3D_LOGWARNINGF("Frame task %s waited over %d ms, running it outside the frame budget", task->name_.CString(),
+                    (int)(task->maxDelayUSec_ / 1000));
+                task->starved_ = true;
+            }
+
+            ++task->numStarved_;
+            RunTask(*task, task->sliceUSec_);
+        }
+    }
+
+    for (i32 i = 0; i < jobs_.Size();)
+    {
+        if (jobs_[i].deadline_ <= now)
+        {
+            ++numOverdueJobs_;
+            RunJob(i);
+        }
+        else
+            ++i;
+    }
+
+    // Then share the time left by priority, each task running once
+    i32 taskIndex = 0;
+    for (;;)
+    {
+        long long remaining = budget - timer.GetUSec(false);
+        if (remaining <= 0)
+            break;
+
+        while (taskIndex < tasks.Size() && (!tasks[taskIndex]->IsRunnable() || tasks[taskIndex]->lastUpdate_ == updateNumber_))
+            ++taskIndex;
+        FrameTask* task = taskIndex < tasks.Size() ? tasks[taskIndex].Get() : nullptr;
+
+        if (!jobs_.Empty() && (!task || jobs_.Front().priority_ > task->priority_))
+            RunJob(0);
+        else if (task)
+        {
+            task->starved_ = false;
+            RunTask(*task, Max(remaining, task->sliceUSec_));
+        }
+        else
+            break;
+    }
+
+    // Tasks with work left get at least their slice every frame, also when the frame deadline has already passed, so that
+    // loading does not slow down with vsync or long frames
+    for (const SharedPtr<FrameTask>& task : tasks)
+    {
+        if (task->IsRunnable() && task->lastUpdate_ != updateNumber_)
+            RunTask(*task, task->sliceUSec_);
+    }
+
+    lastBudget_ = budget;
+    lastUsed_ = timer.GetUSec(false);
+    ++updateNumber_;
+}
+
+void FrameScheduler::ResetStats()
+{
+    for (const SharedPtr<FrameTask>& task : tasks_)
+    {
+        task->numRuns_ = 0;
+        task->usedUSec_ = 0;
+        task->numStarved_ = 0;
+    }
+
+    numOverdueJobs_ = 0;
+}
+
+Vector<FrameTaskStats> FrameScheduler::GetTaskStats() const
+{
+    Vector<FrameTaskStats> ret;
+
+    for (const SharedPtr<FrameTask>& task : tasks_)
+    {
+        FrameTaskStats stats;
+        stats.name_ = task->name_;
+        stats.priority_ = task->priority_;
+        stats.pending_ = task->pending_;
+        stats.numRuns_ = task->numRuns_;
+        stats.usedUSec_ = task->usedUSec_;
+        stats.numStarved_ = task->numStarved_;
+        ret.Push(stats);
+    }
+
+    return ret;
+}
+
+FrameTask* FrameScheduler::FindTask(u32 id) const
+{
+    for (const SharedPtr<FrameTask>& task : tasks_)
+    {
+        if (task->id_ == id)
+            return task;
+    }
+
+    return nullptr;
+}
+
+void FrameScheduler::RunTask(FrameTask& task, long long maxUSec)
+{
+    HiresTimer timer;
+    task.pending_ = task.function_(maxUSec);
+    task.usedUSec_ += timer.GetUSec(false);
+    ++task.numRuns_;
+    task.lastUpdate_ = updateNumber_;
+    task.waitStart_ = clock_.GetUSec(false);
+}
+
+void FrameScheduler::RunJob(i32 index)
+{
+    // The job may queue more jobs, so take it out first
+    FrameJobFunction function = jobs_[index].function_;
+    jobs_.Erase(index);
+    function();
+}
+
+void FrameScheduler::HandleBeginFrame(StringHash /*eventType*/, VariantMap& /*eventData*/)
+{
+    // Operations requested by the functions waiting for these belong to the frame after
+    Vector<SharedPtr<AsyncOperation>> operations;
+    operations.Swap(nextFrameOperations_);
+    for (const SharedPtr<AsyncOperation>& operation : operations)
+        operation->Complete();
+}
+
+}
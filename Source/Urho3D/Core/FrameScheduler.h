@@ -0,0 +1,133 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "../Core/AsyncOperation.h"
+#include "../Core/Object.h"
+#include "../Core/Timer.h"
+
+#include <functional>
+
+namespace Urho3D
+{
+
+/// Work function of a frame task. Called in the main thread with the time in microseconds it may use. Return true if work remains.
+using FrameTaskFunction = std::function<bool(long long)>;
+/// Function of a one-shot frame job.
+using FrameJobFunction = std::function<void()>;
+
+/// Frame task priority for loading, such as async scene loading and finishing background loaded resources.
+inline constexpr i32 FT_PRIORITY_HIGH = 200;
+/// Frame task priority for regular deferred work.
+inline constexpr i32 FT_PRIORITY_NORMAL = 100;
+/// Frame task priority for work that can wait, such as reloading changed resources.
+inline constexpr i32 FT_PRIORITY_LOW = 0;
+
+struct FrameTask;
+
+/// Frame task statistics since the last reset.
+/// @nobind
+struct FrameTaskStats
+{
+    /// Task name.
+    String name_;
+    /// Priority.
+    i32 priority_{};
+    /// Whether work remains.
+    bool pending_{};
+    /// Number of times run.
+    i32 numRuns_{};
+    /// Total time used in microseconds.
+    long long usedUSec_{};
+    /// Number of times the task waited longer than its maximum delay and was run outside the budget.
+    i32 numStarved_{};
+};
+
+/// %Frame scheduler subsystem. Runs deferred main thread work in the time left before the frame deadline, highest priority first. Each task with work left also gets its minimum slice every frame. Work that has waited longer than its maximum delay runs first, which is reported as starvation.
+class URHO3D_API FrameScheduler : public Object
+{
+    URHO3D_OBJECT(FrameScheduler, Object);
+
+public:
+    /// Construct.
+    explicit FrameScheduler(Context* context);
+    /// Destruct.
+    ~FrameScheduler() override;
+
+    /// Add a recurring task and return its ID. The task is called every frame while it has work remaining, and is removed when the owner is destroyed. The slice is the minimum time it gets each frame, even when no time is left before the frame deadline.
+    u32 AddTask(Object* owner, const String& name, const FrameTaskFunction& function, i32 priority, int sliceMs, int maxDelayMs = 100);
+    /// Remove a task. Can be called from a task.
+    void RemoveTask(u32 id);
+    /// Tell a task that it has work to do.
+    void WakeTask(u32 id);
+    /// Set the minimum time a task gets each frame.
+    void SetTaskSlice(u32 id, int sliceMs);
+    /// Queue a one-shot job. It runs when there is time left, highest priority first, or after the deadline at the latest.
+    void Post(const FrameJobFunction& function, i32 priority = FT_PRIORITY_NORMAL, int deadlineMs = 100);
+    /// Return an operation that completes at the start of the next frame.
+    SharedPtr<AsyncOperation> NextFrame();
+    /// Run tasks and jobs. Called by the engine before the frame limiter waits, with the time left until the frame deadline in microseconds, or -1 if the frame rate is not limited.
+    void Update(long long slackUSec);
+    /// Set the budget in milliseconds per frame when the frame rate is not limited.
+    void SetDefaultBudgetMs(int ms) { defaultBudgetMs_ = Max(ms, 0); }
+    /// Reset statistics.
+    void ResetStats();
+
+    /// Return the budget in milliseconds per frame when the frame rate is not limited.
+    int GetDefaultBudgetMs() const { return defaultBudgetMs_; }
+    /// Return the budget of the last update in microseconds.
+    long long GetLastBudget() const { return lastBudget_; }
+    /// Return the time used by the last update in microseconds.
+    long long GetLastUsed() const { return lastUsed_; }
+    /// Return number of queued jobs.
+    i32 GetNumJobs() const { return jobs_.Size(); }
+    /// Return number of jobs run after their deadline since the last reset.
+    i32 GetNumOverdueJobs() const { return numOverdueJobs_; }
+    /// Return statistics of all tasks.
+    Vector<FrameTaskStats> GetTaskStats() const;
+
+private:
+    /// Queued one-shot job.
+    struct Job
+    {
+        /// Function.
+        FrameJobFunction function_;
+        /// Priority.
+        i32 priority_;
+        /// Deadline in scheduler clock microseconds.
+        long long deadline_;
+    };
+
+    /// Return a task by ID, or null if not found.
+    FrameTask* FindTask(u32 id) const;
+    /// Run a task and update its statistics.
+    void RunTask(FrameTask& task, long long maxUSec);
+    /// Remove a job from the queue and run it.
+    void RunJob(i32 index);
+    /// Handle frame start event. Complete the operations waiting for the next frame.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+
+    /// Tasks sorted by descending priority.
+    Vector<SharedPtr<FrameTask>> tasks_;
+    /// Jobs sorted by descending priority, oldest first within a priority.
+    Vector<Job> jobs_;
+    /// Operations to complete at the start of the next frame.
+    Vector<SharedPtr<AsyncOperation>> nextFrameOperations_;
+    /// Scheduler clock for delays and deadlines.
+    HiresTimer clock_;
+    /// Next task ID.
+    u32 nextTaskId_;
+    /// Update counter.
+    u32 updateNumber_;
+    /// Budget in milliseconds when the frame rate is not limited.
+    int defaultBudgetMs_;
+    /// Budget of the last update.
+    long long lastBudget_;
+    /// Time used by the last update.
+    long long lastUsed_;
+    /// Number of jobs run after their deadline.
+    i32 numOverdueJobs_;
+};
+
+}
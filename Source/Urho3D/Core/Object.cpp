@@ -435,6 +435,16 @@ bool Object::HasSubscribedToEvent(Object* sender, StringHash eventType) const
         return FindSpecificEventHandler(sender, eventType) != nullptr;
 }
 
+bool Object::HasEventReceivers(StringHash eventType) const
+{
+    EventReceiverGroup* group = context_->GetEventReceivers(const_cast<Object*>(this), eventType);
+    if (group && !group->receivers_.Empty())
+        return true;
+
+    group = context_->GetEventReceivers(eventType);
+    return group && !group->receivers_.Empty();
+}
+
 const String& Object::GetCategory() const
 {
     const HashMap<String, Vector<StringHash>>& objectCategories = context_->GetObjectCategories();
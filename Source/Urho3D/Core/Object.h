@@ -146,6 +146,9 @@ public:
     bool HasSubscribedToEvent(StringHash eventType) const;
     /// Return whether has subscribed to a specific sender's event.
     bool HasSubscribedToEvent(Object* sender, StringHash eventType) const;
+    /// Return whether an event sent by this object would reach any receiver. Allows skipping the preparation of event data nobody listens to.
+    /// @nobind
+    bool HasEventReceivers(StringHash eventType) const;
 
     /// Return whether has subscribed to any event.
     bool HasEventHandlers() const { return !eventHandlers_.Empty(); }
@@ -3,6 +3,8 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/HashMap.h"
+#include "../Container/Sort.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/StringUtils.h"
 #include "../IO/FileSystem.h"
@@ -476,6 +478,177 @@ unsigned GetNumLogicalCPUs()
 #endif
 }
 
+#if defined(__linux__)
+/// Read the first line of a sysfs file. Return empty if the file does not exist.
+static String ReadSysFsLine(const String& fileName)
+{
+    String line;
+    FILE* fp = fopen(fileName.CString(), "r");
+    if (fp)
+    {
+        char buffer[4096];
+        if (fgets(buffer, sizeof buffer, fp))
+            line = String(buffer).Trimmed();
+        fclose(fp);
+    }
+    return line;
+}
+
+/// Parse a sysfs CPU or node list such as "0-3,8-11".
+static Vector<i32> ParseSysFsList(const String& list)
+{
+    Vector<i32> values;
+    Vector<String> ranges = list.Split(',');
+    for (const String& range : ranges)
+    {
+        Vector<String> ends = range.Split('-');
+        i32 first = ToI32(ends[0]);
+        i32 last = ends.Size() > 1 ? ToI32(ends[1]) : first;
+        for (i32 value = first; value <= last; ++value)
+            values.Push(value);
+    }
+    return values;
+}
+
+/// Return a dense index for a key, assigning the next free one if the key is new.
+static i32 GetDenseIndex(HashMap<i32, i32>& indices, i32 key)
+{
+    HashMap<i32, i32>::Iterator i = indices.Find(key);
+    if (i != indices.End())
+        return i->second_;
+
+    i32 index = indices.Size();
+    indices[key] = index;
+    return index;
+}
+
+/// Read the processor topology from sysfs. Return false if not available.
+static bool GetSysFsTopology(CpuTopology& topology)
+{
+    Vector<i32> online = ParseSysFsList(ReadSysFsLine("/sys/devices/system/cpu/online"));
+    if (online.Empty())
+        return false;
+
+    // Kernels without NUMA support have no node directory, in which case everything stays on node 0
+    HashMap<i32, i32> cpuNodes;
+    Vector<i32> nodes = ParseSysFsList(ReadSysFsLine("/sys/devices/system/node/online"));
+    for (i32 node : nodes)
+    {
+        Vector<i32> nodeCpus = ParseSysFsList(ReadSysFsLine(ToString("/sys/devices/system/node/node%d/cpulist", node)));
+        for (i32 cpu : nodeCpus)
+            cpuNodes[cpu] = node;
+    }
+
+    // Cores and cache groups are identified by their lowest logical CPU, as core IDs repeat across packages
+    HashMap<i32, i32> cores;
+    HashMap<i32, i32> packages;
+    HashMap<i32, i32> cacheGroups;
+    HashMap<i32, i32> numaNodes;
+
+    for (i32 cpu : online)
+    {
+        String cpuDir = ToString("/sys/devices/system/cpu/cpu%d/", cpu);
+
+        Vector<i32> siblings = ParseSysFsList(ReadSysFsLine(cpuDir + "topology/thread_siblings_list"));
+        if (!siblings.Contains(cpu))
+            return false;
+
+        String package = ReadSysFsLine(cpuDir + "topology/physical_package_id");
+        i32 packageId = package.Empty() ? 0 : ToI32(package);
+
+        // Find the highest cache level. Without cache information treat each package as one group
+        i32 cacheKey = -1 - packageId;
+        i32 cacheLevel = 0;
+        for (i32 i = 0;; ++i)
+        {
+            String cacheDir = cpuDir + ToString("cache/index%d/", i);
+            String level = ReadSysFsLine(cacheDir + "level");
+            if (level.Empty())
+                break;
+
+            Vector<i32> sharing = ParseSysFsList(ReadSysFsLine(cacheDir + "shared_cpu_list"));
+            if (ToI32(level) > cacheLevel && !sharing.Empty())
+            {
+                cacheLevel = ToI32(level);
+                cacheKey = sharing.Front();
+            }
+        }
+
+        HashMap<i32, i32>::ConstIterator node = cpuNodes.Find(cpu);
+
+        LogicalCpu logicalCpu;
+        logicalCpu.index_ = cpu;
+        logicalCpu.core_ = GetDenseIndex(cores, siblings.Front());
+        logicalCpu.smtIndex_ = siblings.IndexOf(cpu);
+        logicalCpu.package_ = GetDenseIndex(packages, packageId);
+        logicalCpu.cacheGroup_ = GetDenseIndex(cacheGroups, cacheKey);
+        logicalCpu.numaNode_ = GetDenseIndex(numaNodes, node != cpuNodes.End() ? node->second_ : 0);
+        topology.cpus_.Push(logicalCpu);
+    }
+
+    topology.numCores_ = cores.Size();
+    topology.numPackages_ = packages.Size();
+    topology.numCacheGroups_ = cacheGroups.Size();
+    topology.numNumaNodes_ = numaNodes.Size();
+    return true;
+}
+#endif
+
+/// Detect the processor topology.
+static CpuTopology DetectCpuTopology()
+{
+    CpuTopology topology;
+
+#if defined(__linux__)
+    if (GetSysFsTopology(topology))
+        return topology;
+    topology.cpus_.Clear();
+#endif
+
+    i32 numLogical = Max((i32)GetNumLogicalCPUs(), 1);
+    i32 numPhysical = Clamp((i32)GetNumPhysicalCPUs(), 1, numLogical);
+    i32 threadsPerCore = numLogical / numPhysical;
+
+    for (i32 i = 0; i < numLogical; ++i)
+    {
+        LogicalCpu logicalCpu;
+        logicalCpu.index_ = i;
+        logicalCpu.core_ = Min(i / threadsPerCore, numPhysical - 1);
+        logicalCpu.smtIndex_ = i - logicalCpu.core_ * threadsPerCore;
+        topology.cpus_.Push(logicalCpu);
+    }
+
+    topology.numCores_ = numPhysical;
+    topology.numPackages_ = topology.numCacheGroups_ = topology.numNumaNodes_ = 1;
+    return topology;
+}
+
+const CpuTopology& GetCpuTopology()
+{
+    static const CpuTopology topology = DetectCpuTopology();
+    return topology;
+}
+
+Vector<i32> GetCpuPlacementOrder()
+{
+    Vector<LogicalCpu> cpus = GetCpuTopology().cpus_;
+    Sort(cpus.Begin(), cpus.End(), [](const LogicalCpu& lhs, const LogicalCpu& rhs)
+    {
+        if (lhs.smtIndex_ != rhs.smtIndex_)
+            return lhs.smtIndex_ < rhs.smtIndex_;
+        if (lhs.numaNode_ != rhs.numaNode_)
+            return lhs.numaNode_ < rhs.numaNode_;
+        if (lhs.cacheGroup_ != rhs.cacheGroup_)
+            return lhs.cacheGroup_ < rhs.cacheGroup_;
+        return lhs.core_ < rhs.core_;
+    });
+
+    Vector<i32> order;
+    for (const LogicalCpu& cpu : cpus)
+        order.Push(cpu.index_);
+    return order;
+}
+
 void SetMiniDumpDir(const String& pathName)
 {
     miniDumpDir = AddTrailingSlash(pathName);
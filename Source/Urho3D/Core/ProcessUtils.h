@@ -12,6 +12,38 @@ namespace Urho3D
 
 class Mutex;
 
+/// Logical CPU and its place in the processor topology. Cores, packages, cache groups and NUMA nodes are numbered from zero in order of their lowest logical CPU.
+struct LogicalCpu
+{
+    /// Operating system index of the logical CPU.
+    i32 index_{};
+    /// Physical core.
+    i32 core_{};
+    /// Index among the SMT siblings of the physical core.
+    i32 smtIndex_{};
+    /// Physical package (socket).
+    i32 package_{};
+    /// Group of cores sharing the last level cache, for example an AMD CCX.
+    i32 cacheGroup_{};
+    /// NUMA node.
+    i32 numaNode_{};
+};
+
+/// Processor topology.
+struct CpuTopology
+{
+    /// Online logical CPUs in index order.
+    Vector<LogicalCpu> cpus_;
+    /// Number of physical cores.
+    i32 numCores_{};
+    /// Number of physical packages.
+    i32 numPackages_{};
+    /// Number of last level cache groups.
+    i32 numCacheGroups_{};
+    /// Number of NUMA nodes.
+    i32 numNumaNodes_{};
+};
+
 /// Initialize the FPU to round-to-nearest, single precision mode.
 URHO3D_API void InitFPU();
 /// Display an error dialog with the specified title and message.
@@ -48,6 +80,10 @@ URHO3D_API String GetPlatform();
 URHO3D_API unsigned GetNumPhysicalCPUs();
 /// Return the number of logical CPUs (different from physical if hyperthreading is used).
 URHO3D_API unsigned GetNumLogicalCPUs();
+/// Return the processor topology. Read from sysfs on Linux, elsewhere estimated from the CPU counts with SMT siblings numbered consecutively. Detected on first call.
+URHO3D_API const CpuTopology& GetCpuTopology();
+/// Return logical CPUs in the order threads should be placed on them to avoid sharing cores: one per physical core, filling a NUMA node and cache group before moving to the next, followed by the SMT siblings.
+URHO3D_API Vector<i32> GetCpuPlacementOrder();
 /// Set minidump write location as an absolute path. If empty, uses default (UserProfile/AppData/Roaming/urho3D/crashdumps) Minidumps are only supported on MSVC compiler.
 URHO3D_API void SetMiniDumpDir(const String& pathName);
 /// Return minidump write location.
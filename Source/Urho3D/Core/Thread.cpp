@@ -3,6 +3,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/ProcessUtils.h"
 #include "../Core/Thread.h"
 
 #ifdef _WIN32
@@ -11,6 +12,11 @@
 #include <pthread.h>
 #include <sched.h>
 #include <unistd.h>
+#include <ctime>
+#if defined(__linux__) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 #endif
 
 #include "../DebugNew.h"
@@ -28,11 +34,65 @@ static DWORD WINAPI ThreadFunctionStatic(void* data)
     return 0;
 }
 
+/// Return the Windows priority value for a thread priority.
+static int GetWin32Priority(ThreadPriority priority)
+{
+    switch (priority)
+    {
+    case ThreadPriority::Low:
+        return THREAD_PRIORITY_BELOW_NORMAL;
+    case ThreadPriority::High:
+        return THREAD_PRIORITY_ABOVE_NORMAL;
+    default:
+        return THREAD_PRIORITY_NORMAL;
+    }
+}
+
+/// Return the affinity mask for a logical CPU, or the process mask for -1.
+static DWORD_PTR GetAffinityMask(int cpuIndex)
+{
+    if (cpuIndex >= 0)
+        return (DWORD_PTR)1 << cpuIndex;
+
+    DWORD_PTR processMask, systemMask;
+    GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+    return processMask;
+}
+
 #else
 
+#if defined(__linux__) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
+/// Return the nice value for a thread priority.
+static int GetNiceValue(ThreadPriority priority)
+{
+    switch (priority)
+    {
+    case ThreadPriority::Low:
+        return 10;
+    case ThreadPriority::High:
+        return -5;
+    default:
+        return 0;
+    }
+}
+
+/// Fill the CPU set for a logical CPU, or with the CPUs of the calling thread for -1.
+static void GetCpuSet(cpu_set_t& cpuSet, int cpuIndex)
+{
+    if (cpuIndex >= 0)
+    {
+        CPU_ZERO(&cpuSet);
+        CPU_SET(cpuIndex, &cpuSet);
+    }
+    else
+        sched_getaffinity(0, sizeof cpuSet, &cpuSet);
+}
+#endif
+
 static void* ThreadFunctionStatic(void* data)
 {
     auto* thread = static_cast<Thread*>(data);
+    thread->ApplyStartSettings();
     thread->ThreadFunction();
     pthread_exit((void*)nullptr);
     return nullptr;
@@ -45,7 +105,10 @@ ThreadID Thread::mainThreadID;
 
 Thread::Thread() :
     handle_(nullptr),
-    shouldRun_(false)
+    shouldRun_(false),
+    priority_(ThreadPriority::Normal),
+    affinity_(-1),
+    nativeId_(0)
 {
 }
 
@@ -62,14 +125,29 @@ bool Thread::Run()
         return false;
 
     shouldRun_ = true;
+    nativeId_ = 0;
 #ifdef _WIN32
     handle_ = CreateThread(nullptr, 0, ThreadFunctionStatic, this, 0, nullptr);
+    if (handle_ && priority_ != ThreadPriority::Normal)
+        SetThreadPriority((HANDLE)handle_, GetWin32Priority(priority_));
+    if (handle_ && affinity_ >= 0)
+        SetThreadAffinityMask((HANDLE)handle_, GetAffinityMask(affinity_));
 #else
     handle_ = new pthread_t;
     pthread_attr_t type;
     pthread_attr_init(&type);
     pthread_attr_setdetachstate(&type, PTHREAD_CREATE_JOINABLE);
+#if defined(__linux__) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
+    // Pin before starting so that the thread never runs on another CPU and touches memory from there
+    if (affinity_ >= 0)
+    {
+        cpu_set_t cpuSet;
+        GetCpuSet(cpuSet, affinity_);
+        pthread_attr_setaffinity_np(&type, sizeof cpuSet, &cpuSet);
+    }
+#endif
     pthread_create((pthread_t*)handle_, &type, ThreadFunctionStatic, this);
+    pthread_attr_destroy(&type);
 #endif
     return handle_ != nullptr;
 #else
@@ -112,6 +190,33 @@ void Thread::SetPriority(int priority)
 #endif // URHO3D_THREADING
 }
 
+void Thread::SetPriority(ThreadPriority priority)
+{
+    priority_ = priority;
+#ifdef URHO3D_THREADING
+#ifdef _WIN32
+    if (handle_)
+        SetThreadPriority((HANDLE)handle_, GetWin32Priority(priority));
+#elif defined(__linux__) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
+    // Before the thread has stored its ID it will apply the priority itself
+    int nativeId = nativeId_;
+    if (nativeId)
+        setpriority(PRIO_PROCESS, (id_t)nativeId, GetNiceValue(priority));
+#endif
+#endif // URHO3D_THREADING
+}
+
+void Thread::ApplyStartSettings()
+{
+#if defined(URHO3D_THREADING) && defined(__linux__) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
+    // The nice value belongs to the kernel thread, so apply a priority requested before starting from here
+    nativeId_ = (int)syscall(SYS_gettid);
+    ThreadPriority priority = priority_;
+    if (priority != ThreadPriority::Normal)
+        setpriority(PRIO_PROCESS, (id_t)nativeId_, GetNiceValue(priority));
+#endif
+}
+
 void Thread::SetMainThread()
 {
     mainThreadID = GetCurrentThreadID();
@@ -142,30 +247,57 @@ bool Thread::IsMainThread()
 bool Thread::SetAffinity(int cpuIndex)
 {
 #ifdef URHO3D_THREADING
-#if defined(__linux__) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
-    if (!handle_)
+#ifdef _WIN32
+    if (cpuIndex >= (int)(sizeof(DWORD_PTR) * 8))
         return false;
 
-    // Phase 1.2: Set CPU affinity using sched_setaffinity
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
-    CPU_SET(cpuIndex, &cpuset);
+    affinity_ = Max(cpuIndex, -1);
+    if (handle_)
+        return SetThreadAffinityMask((HANDLE)handle_, GetAffinityMask(affinity_)) != 0;
+    return true;
+#elif defined(__linux__) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
+    if (cpuIndex >= CPU_SETSIZE)
+        return false;
 
-    auto* thread = (pthread_t*)handle_;
-    if (pthread_setaffinity_np(*thread, sizeof(cpu_set_t), &cpuset) != 0)
+    affinity_ = Max(cpuIndex, -1);
+    if (handle_)
     {
-        return false;
+        cpu_set_t cpuSet;
+        GetCpuSet(cpuSet, affinity_);
+        return pthread_setaffinity_np(*(pthread_t*)handle_, sizeof cpuSet, &cpuSet) == 0;
     }
     return true;
 #else
     // CPU affinity not supported on this platform
     return false;
-#endif // __linux__
+#endif
 #else
     return false;
 #endif // URHO3D_THREADING
 }
 
+long long Thread::GetCpuTime() const
+{
+#ifdef URHO3D_THREADING
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (handle_ && GetThreadTimes((HANDLE)handle_, &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        // Thread times are in 100 nanosecond units
+        unsigned long long kernel = ((unsigned long long)kernelTime.dwHighDateTime << 32u) | kernelTime.dwLowDateTime;
+        unsigned long long user = ((unsigned long long)userTime.dwHighDateTime << 32u) | userTime.dwLowDateTime;
+        return (long long)((kernel + user) / 10);
+    }
+#elif defined(__linux__) && !defined(__EMSCRIPTEN__)
+    clockid_t clockId;
+    timespec time;
+    if (handle_ && !pthread_getcpuclockid(*(pthread_t*)handle_, &clockId) && !clock_gettime(clockId, &time))
+        return time.tv_sec * 1000000LL + time.tv_nsec / 1000;
+#endif
+#endif // URHO3D_THREADING
+    return -1;
+}
+
 int Thread::GetNumCores()
 {
 #ifdef URHO3D_THREADING
@@ -186,33 +318,18 @@ int Thread::GetNumCores()
 
 int Thread::GetNumNumaNodes()
 {
-#ifdef URHO3D_THREADING
-#if defined(__linux__) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
-    // Try to get NUMA nodes using libnuma if available
-    // For now, return 1 (single node) as fallback
-    // Full NUMA support would require linking against libnuma
-    return 1;
-#else
-    return 1;
-#endif
-#else
-    return 1;
-#endif // URHO3D_THREADING
+    return GetCpuTopology().numNumaNodes_;
 }
 
 int Thread::GetCoreNumaNode(int coreIndex)
 {
-#ifdef URHO3D_THREADING
-#if defined(__linux__) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__)
-    // Would require libnuma for actual implementation
-    // For now, return -1 (unknown)
-    return -1;
-#else
-    return -1;
-#endif
-#else
+    for (const LogicalCpu& cpu : GetCpuTopology().cpus_)
+    {
+        if (cpu.index_ == coreIndex)
+            return cpu.numaNode_;
+    }
+
     return -1;
-#endif // URHO3D_THREADING
 }
 
 }
@@ -9,6 +9,8 @@
 #include <Urho3D/Urho3D.h>
 #endif
 
+#include <atomic>
+
 #ifndef _WIN32
 #include <pthread.h>
 using ThreadID = pthread_t;
@@ -19,6 +21,17 @@ using ThreadID = unsigned;
 namespace Urho3D
 {
 
+/// Scheduling priority of a thread.
+enum class ThreadPriority
+{
+    /// Below normal, for background work such as resource loading and logging.
+    Low = 0,
+    /// Operating system default.
+    Normal,
+    /// Above normal. Usually needs privileges on Linux.
+    High
+};
+
 /// Operating system thread.
 class URHO3D_API Thread
 {
@@ -35,16 +48,25 @@ public:
     bool Run();
     /// Set the running flag to false and wait for the thread to finish.
     void Stop();
-    /// Set thread priority. The thread must have been started first.
+    /// Set thread priority as a platform-specific value. The thread must have been started first.
     void SetPriority(int priority);
-
-    /// Set CPU affinity for this thread (Linux only via sched_setaffinity).
-    /// cpuIndex: CPU core number to pin to (0-based)
-    /// Returns true if successful
+    /// Set scheduling priority. Can be called before or after starting the thread. On Linux this sets the nice value of the thread, and returning to normal after lowering may need privileges.
+    void SetPriority(ThreadPriority priority);
+    /// Set CPU affinity to a single logical CPU, or -1 to allow the CPUs of the process. Can be called before or after starting the thread. Return false if not supported on this platform (only Windows and Linux) or if fails.
     bool SetAffinity(int cpuIndex);
 
+    /// Apply the priority requested before starting. Called by the thread itself before ThreadFunction().
+    /// @nobind
+    void ApplyStartSettings();
+
     /// Return whether thread exists.
     bool IsStarted() const { return handle_ != nullptr; }
+    /// Return scheduling priority.
+    ThreadPriority GetPriority() const { return priority_; }
+    /// Return logical CPU the thread is pinned to, or -1 if not pinned.
+    int GetAffinity() const { return affinity_; }
+    /// Return CPU time used by the thread in microseconds, or -1 if not started or not supported on this platform.
+    long long GetCpuTime() const;
 
     /// Set the current thread as the main thread.
     static void SetMainThread();
@@ -54,13 +76,11 @@ public:
     /// Return whether is executing in the main thread.
     static bool IsMainThread();
 
-    /// Get the number of logical CPU cores available
+    /// Return the number of logical CPUs available.
     static int GetNumCores();
-
-    /// Get the number of NUMA nodes (1 if NUMA not available)
+    /// Return the number of NUMA nodes, 1 if NUMA is not available.
     static int GetNumNumaNodes();
-
-    /// Get CPU core to NUMA node mapping (returns -1 if not available)
+    /// Return the NUMA node of a logical CPU, or -1 if not an online CPU.
     static int GetCoreNumaNode(int coreIndex);
 
 protected:
@@ -68,6 +88,12 @@ protected:
     void* handle_;
     /// Running flag.
     volatile bool shouldRun_;
+    /// Scheduling priority.
+    std::atomic<ThreadPriority> priority_;
+    /// Logical CPU to pin to, or -1 for any.
+    int affinity_;
+    /// Kernel thread ID once running, needed to set the nice value on Linux.
+    std::atomic<int> nativeId_;
 
     /// Main thread's thread ID.
     static ThreadID mainThreadID;
@@ -4,14 +4,32 @@
 #include "../Precompiled.h"
 
 #include "../Core/CoreEvents.h"
+#include "../Core/FrameScheduler.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
 #include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 
 namespace Urho3D
 {
 
+/// Function and operation of a work item queued with RunAsync().
+struct AsyncWork
+{
+    /// Function to run.
+    std::function<void()> function_;
+    /// Operation to complete.
+    SharedPtr<AsyncOperation> operation_;
+};
+
+/// Work function of a work item queued with RunAsync().
+static void RunAsyncWork(const WorkItem* item, i32 /*threadIndex*/)
+{
+    static_cast<AsyncWork*>(item->aux_)->function_();
+}
+
 /// Worker thread managed by the work queue.
 class WorkerThread : public Thread, public RefCounted
 {
@@ -34,12 +52,15 @@ public:
 #endif
         // Init FPU state first
         InitFPU();
-        owner_->ProcessItems(index_);
+        owner_->ProcessItems(index_, counters_);
     }
 
     /// Return thread index.
     i32 GetIndex() const { return index_; }
 
+    /// Statistics.
+    WorkQueue::ThreadCounters counters_;
+
 private:
     /// Work queue.
     WorkQueue* owner_;
@@ -55,9 +76,18 @@ WorkQueue::WorkQueue(Context* context) :
     completing_(false),
     tolerance_(10),
     lastSize_(0),
-    maxNonThreadedWorkMs_(5)
+    maxNonThreadedWorkMs_(5),
+    nonThreadedTask_(0),
+    threadAffinity_(false)
 {
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WorkQueue, HandleBeginFrame));
+
+    frameScheduler_ = GetSubsystem<FrameScheduler>();
+    if (frameScheduler_)
+    {
+        nonThreadedTask_ = frameScheduler_->AddTask(this, "NonThreadedWork",
+            [this](long long maxUSec) { return CompleteNonThreaded(maxUSec); }, FT_PRIORITY_NORMAL, maxNonThreadedWorkMs_);
+    }
 }
 
 WorkQueue::~WorkQueue()
@@ -68,6 +98,13 @@ WorkQueue::~WorkQueue()
 
     for (const SharedPtr<WorkerThread>& thread : threads_)
         thread->Stop();
+
+    // Free the functions of async work that did not complete. Their operations are left pending
+    for (const SharedPtr<WorkItem>& item : workItems_)
+    {
+        if (item->workFunction_ == RunAsyncWork)
+            delete static_cast<AsyncWork*>(item->aux_);
+    }
 }
 
 void WorkQueue::CreateThreads(i32 numThreads)
@@ -83,12 +120,30 @@ void WorkQueue::CreateThreads(i32 numThreads)
     // Start threads in paused mode
     Pause();
 
+    // Skip the first physical core, where the main thread is likely to stay when it has it to itself. Threads beyond
+    // the available logical CPUs are left unpinned
+    Vector<i32> cpus;
+    if (threadAffinity_)
+        cpus = GetCpuPlacementOrder();
+
     for (i32 i = 0; i < numThreads; ++i)
     {
         SharedPtr<WorkerThread> thread(new WorkerThread(this, i + 1));
+        if (i + 1 < cpus.Size())
+            thread->SetAffinity(cpus[i + 1]);
         thread->Run();
         threads_.Push(thread);
     }
+
+    if (threadAffinity_)
+    {
+        String pinned;
+        for (const SharedPtr<WorkerThread>& thread : threads_)
+            pinned.AppendWithFormat(" %d", thread->GetAffinity());
+        URHO3D_LOGINFO("Pinned worker threads to CPUs" + pinned);
+    }
+
+    ResetThreadStats();
 #else
     URHO3D_LOGERROR("Can not create worker threads as threading is disabled");
 #endif
@@ -157,6 +212,8 @@ void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
         queueMutex_.Release();
         paused_ = false;
     }
+    else if (frameScheduler_)
+        frameScheduler_->WakeTask(nonThreadedTask_);
 }
 
 bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
@@ -248,8 +305,7 @@ void WorkQueue::Complete(i32 priority)
                 WorkItem* item = queue_.Front();
                 queue_.PopFront();
                 queueMutex_.Release();
-                item->workFunction_(item, 0);
-                item->completed_ = true;
+                ExecuteItem(item, 0, mainThreadCounters_);
             }
             else
             {
@@ -274,8 +330,7 @@ void WorkQueue::Complete(i32 priority)
         {
             WorkItem* item = queue_.Front();
             queue_.PopFront();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            ExecuteItem(item, 0, mainThreadCounters_);
         }
     }
 
@@ -283,6 +338,60 @@ void WorkQueue::Complete(i32 priority)
     completing_ = false;
 }
 
+SharedPtr<AsyncOperation> WorkQueue::RunAsync(const std::function<void()>& function, i32 priority)
+{
+    SharedPtr<AsyncOperation> operation(new AsyncOperation());
+
+    SharedPtr<WorkItem> item = GetFreeItem();
+    item->workFunction_ = RunAsyncWork;
+    item->aux_ = new AsyncWork{function, operation};
+    item->priority_ = priority;
+    AddWorkItem(item);
+
+    return operation;
+}
+
+void WorkQueue::RunParallelRanges(void (*workFunction)(const WorkItem*, i32), void* elements, i32 count, i32 elementSize,
+    i32 numRanges, void* aux)
+{
+    if (count <= 0)
+        return;
+
+    bool threaded = threads_.Size() && !completing_ && Thread::IsMainThread();
+    if (numRanges <= 0)
+        numRanges = threaded ? threads_.Size() + 1 : 1;
+    numRanges = Min(numRanges, count);
+    i32 rangeSize = (count + numRanges - 1) / numRanges;
+    auto* data = static_cast<u8*>(elements);
+
+    if (!threaded)
+    {
+        WorkItem item;
+        item.workFunction_ = workFunction;
+        item.aux_ = aux;
+        for (i32 start = 0; start < count; start += rangeSize)
+        {
+            item.start_ = data + (size_t)start * elementSize;
+            item.end_ = data + (size_t)Min(start + rangeSize, count) * elementSize;
+            workFunction(&item, 0);
+        }
+        return;
+    }
+
+    for (i32 start = 0; start < count; start += rangeSize)
+    {
+        SharedPtr<WorkItem> item = GetFreeItem();
+        item->priority_ = WI_MAX_PRIORITY;
+        item->workFunction_ = workFunction;
+        item->start_ = data + (size_t)start * elementSize;
+        item->end_ = data + (size_t)Min(start + rangeSize, count) * elementSize;
+        item->aux_ = aux;
+        AddWorkItem(item);
+    }
+
+    Complete(WI_MAX_PRIORITY);
+}
+
 bool WorkQueue::IsCompleted(i32 priority) const
 {
     assert(priority >= 0);
@@ -295,7 +404,98 @@ bool WorkQueue::IsCompleted(i32 priority) const
     return true;
 }
 
-void WorkQueue::ProcessItems(i32 threadIndex)
+void WorkQueue::SetNonThreadedWorkMs(int ms)
+{
+    maxNonThreadedWorkMs_ = Max(ms, 1);
+    if (frameScheduler_)
+        frameScheduler_->SetTaskSlice(nonThreadedTask_, maxNonThreadedWorkMs_);
+}
+
+void WorkQueue::SetCollectThreadStats(bool enable)
+{
+    if (enable && !collectThreadStats_.load(std::memory_order_relaxed))
+        ResetThreadStats();
+
+    collectThreadStats_.store(enable, std::memory_order_relaxed);
+}
+
+void WorkQueue::ResetThreadStats()
+{
+    mainThreadCounters_.numItems_.store(0, std::memory_order_relaxed);
+    mainThreadCounters_.busyUSec_.store(0, std::memory_order_relaxed);
+
+    for (const SharedPtr<WorkerThread>& thread : threads_)
+    {
+        ThreadCounters& counters = thread->counters_;
+        counters.numItems_.store(0, std::memory_order_relaxed);
+        counters.busyUSec_.store(0, std::memory_order_relaxed);
+        counters.cpuTimeAtReset_ = thread->GetCpuTime();
+    }
+
+    statsTimer_.Reset();
+}
+
+WorkQueueThreadStats WorkQueue::GetThreadStats(i32 index)
+{
+    WorkQueueThreadStats stats;
+    if (index < 0 || index > threads_.Size())
+        return stats;
+
+    const ThreadCounters& counters = index ? threads_[index - 1]->counters_ : mainThreadCounters_;
+    stats.numItems_ = counters.numItems_.load(std::memory_order_relaxed);
+    stats.busyUSec_ = counters.busyUSec_.load(std::memory_order_relaxed);
+    stats.elapsedUSec_ = statsTimer_.GetUSec(false);
+
+    if (index)
+    {
+        WorkerThread* thread = threads_[index - 1];
+        stats.cpu_ = thread->GetAffinity();
+        long long cpuTime = thread->GetCpuTime();
+        if (cpuTime >= 0 && counters.cpuTimeAtReset_ >= 0)
+            stats.cpuUSec_ = cpuTime - counters.cpuTimeAtReset_;
+    }
+
+    return stats;
+}
+
+bool WorkQueue::CompleteNonThreaded(long long maxUSec)
+{
+    if (!threads_.Empty() || queue_.Empty())
+        return false;
+
+    URHO3D_PROFILE(CompleteWorkNonthreaded);
+
+    HiresTimer timer;
+
+    while (!queue_.Empty() && timer.GetUSec(false) < maxUSec)
+    {
+        WorkItem* item = queue_.Front();
+        queue_.PopFront();
+        ExecuteItem(item, 0, mainThreadCounters_);
+    }
+
+    return !queue_.Empty();
+}
+
+void WorkQueue::ExecuteItem(WorkItem* item, i32 threadIndex, ThreadCounters& counters)
+{
+    if (collectThreadStats_.load(std::memory_order_relaxed))
+    {
+        HiresTimer timer;
+        item->workFunction_(item, threadIndex);
+        // Only this thread writes its counters, so plain loads and stores are enough
+        counters.busyUSec_.store(counters.busyUSec_.load(std::memory_order_relaxed) + timer.GetUSec(false),
+            std::memory_order_relaxed);
+        counters.numItems_.store(counters.numItems_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    else
+        item->workFunction_(item, threadIndex);
+
+    // Set last, as the main thread may reuse the item as soon as it sees it completed
+    item->completed_ = true;
+}
+
+void WorkQueue::ProcessItems(i32 threadIndex, ThreadCounters& counters)
 {
     assert(threadIndex >= 0);
 
@@ -318,8 +518,7 @@ void WorkQueue::ProcessItems(i32 threadIndex)
                 WorkItem* item = queue_.Front();
                 queue_.PopFront();
                 queueMutex_.Release();
-                item->workFunction_(item, threadIndex);
-                item->completed_ = true;
+                ExecuteItem(item, threadIndex, counters);
             }
             else
             {
@@ -339,10 +538,18 @@ void WorkQueue::PurgeCompleted(i32 priority)
     // Purge completed work items and send completion events. Do not signal items lower than priority threshold,
     // as those may be user submitted and lead to eg. scene manipulation that could happen in the middle of the
     // render update, which is not allowed
+    Vector<SharedPtr<AsyncOperation>> completedOperations;
     for (List<SharedPtr<WorkItem>>::Iterator i = workItems_.Begin(); i != workItems_.End();)
     {
         if ((*i)->completed_ && (*i)->priority_ >= priority)
         {
+            if ((*i)->workFunction_ == RunAsyncWork)
+            {
+                auto* work = static_cast<AsyncWork*>((*i)->aux_);
+                completedOperations.Push(work->operation_);
+                delete work;
+            }
+
             if ((*i)->sendEvent_)
             {
                 using namespace WorkItemCompleted;
@@ -358,6 +565,10 @@ void WorkQueue::PurgeCompleted(i32 priority)
         else
             ++i;
     }
+
+    // Complete operations last, as the functions waiting for them may queue and complete more work
+    for (const SharedPtr<AsyncOperation>& operation : completedOperations)
+        operation->Complete();
 }
 
 void WorkQueue::PurgePool()
@@ -395,21 +606,9 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
 
 void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
-    // If no worker threads, complete low-priority work here
-    if (threads_.Empty() && !queue_.Empty())
-    {
-        URHO3D_PROFILE(CompleteWorkNonthreaded);
-
-        HiresTimer timer;
-
-        while (!queue_.Empty() && timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000LL)
-        {
-            WorkItem* item = queue_.Front();
-            queue_.PopFront();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
-        }
-    }
+    // If no worker threads and no frame scheduler, complete low-priority work here
+    if (!nonThreadedTask_ || !frameScheduler_)
+        CompleteNonThreaded(maxNonThreadedWorkMs_ * 1000LL);
 
     // Complete and signal items down to the lowest priority
     PurgeCompleted(0);
@@ -4,8 +4,10 @@
 #pragma once
 
 #include "../Container/List.h"
+#include "../Core/AsyncOperation.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
+#include "../Core/Timer.h"
 
 #include <atomic>
 
@@ -20,6 +22,7 @@ URHO3D_EVENT(E_WORKITEMCOMPLETED, WorkItemCompleted)
 
 inline constexpr i32 WI_MAX_PRIORITY = M_MAX_INT;
 
+class FrameScheduler;
 class WorkerThread;
 
 /// Work queue item.
@@ -48,6 +51,25 @@ private:
     bool pooled_{};
 };
 
+/// Work queue thread utilization statistics since the last reset.
+/// @nobind
+struct WorkQueueThreadStats
+{
+    /// Logical CPU the thread is pinned to, or -1 if not pinned.
+    i32 cpu_{-1};
+    /// Number of work items executed.
+    i32 numItems_{};
+    /// Time spent executing work items in microseconds.
+    long long busyUSec_{};
+    /// CPU time used by the thread in microseconds, including spinning while waiting for work. -1 if not available.
+    long long cpuUSec_{-1};
+    /// Time since the reset in microseconds.
+    long long elapsedUSec_{};
+
+    /// Return the fraction of time spent executing work items.
+    float GetUtilization() const { return elapsedUSec_ > 0 ? (float)busyUSec_ / (float)elapsedUSec_ : 0.0f; }
+};
+
 /// Work queue subsystem for multithreading.
 class URHO3D_API WorkQueue : public Object
 {
@@ -77,15 +99,39 @@ public:
     void Resume();
     /// Finish all queued work which has at least the specified priority. Main thread will also execute priority work. Pause worker threads if no more work remains.
     void Complete(i32 priority);
+    /// Run a function in a worker thread, or in the main thread during the frame if there are no worker threads. Return an operation that completes in the main thread at the start of the frame after the function has run.
+    SharedPtr<AsyncOperation> RunAsync(const std::function<void()>& function, i32 priority = 0);
+    /// Run a function that returns a value in a worker thread. Return an operation that completes with the value.
+    template <class T> SharedPtr<AsyncValue<T>> RunAsync(const std::function<T()>& function, i32 priority = 0);
+    /// Run a work function on ranges of an array with the maximum priority and wait for all to finish. The work function gets the range as the work item start and end pointers. The array is split into the given number of ranges, or one range per thread including the main thread if zero. Runs the ranges in the calling thread with thread index 0 if there are no worker threads, if not called from the main thread or if already completing.
+    /// @nobind
+    template <class T> void RunParallel(void (*workFunction)(const WorkItem*, i32), T* elements, i32 count, i32 numRanges = 0,
+        void* aux = nullptr)
+    {
+        RunParallelRanges(workFunction, elements, count, (i32)sizeof(T), numRanges, aux);
+    }
+
+    /// Set whether to pin worker threads to separate physical cores, leaving the first core to the main thread. Must be called before CreateThreads().
+    void SetThreadAffinity(bool enable) { threadAffinity_ = enable; }
+    /// Set whether to collect thread utilization statistics. Off by default, as timing each work item has a cost. Enabling resets the statistics.
+    void SetCollectThreadStats(bool enable);
+    /// Reset thread utilization statistics.
+    void ResetThreadStats();
 
     /// Set the pool telerance before it starts deleting pool items.
     void SetTolerance(int tolerance) { tolerance_ = tolerance; }
 
-    /// Set how many milliseconds maximum per frame to spend on low-priority work, when there are no worker threads.
-    void SetNonThreadedWorkMs(int ms) { maxNonThreadedWorkMs_ = Max(ms, 1); }
+    /// Set how many milliseconds maximum per frame to spend on low-priority work, when there are no worker threads. With the frame scheduler the work uses the time left in the frame instead, and this is the minimum time it gets every frame.
+    void SetNonThreadedWorkMs(int ms);
 
     /// Return number of worker threads.
     i32 GetNumThreads() const { return threads_.Size(); }
+    /// Return whether worker threads are pinned to physical cores.
+    bool GetThreadAffinity() const { return threadAffinity_; }
+    /// Return whether thread utilization statistics are collected.
+    bool GetCollectThreadStats() const { return collectThreadStats_.load(std::memory_order_relaxed); }
+    /// Return utilization statistics of a thread since the last reset. Work item counts and busy times stay zero unless collecting is enabled. Index 0 is the main thread, which executes work in Complete(), and worker threads follow.
+    WorkQueueThreadStats GetThreadStats(i32 index);
 
     /// Return whether all work with at least the specified priority is finished.
     bool IsCompleted(i32 priority) const;
@@ -99,8 +145,26 @@ public:
     int GetNonThreadedWorkMs() const { return maxNonThreadedWorkMs_; }
 
 private:
+    /// Running totals of a thread's statistics, updated only by the thread itself.
+    struct ThreadCounters
+    {
+        /// Work items executed.
+        std::atomic<i32> numItems_{};
+        /// Time spent executing work items in microseconds.
+        std::atomic<long long> busyUSec_{};
+        /// Thread CPU time at the last reset.
+        long long cpuTimeAtReset_{};
+    };
+
+    /// Run a work function on ranges of an array of elements of the given size. Called by RunParallel().
+    void RunParallelRanges(void (*workFunction)(const WorkItem*, i32), void* elements, i32 count, i32 elementSize, i32 numRanges,
+        void* aux);
+    /// Execute a work item and update statistics.
+    void ExecuteItem(WorkItem* item, i32 threadIndex, ThreadCounters& counters);
+    /// Execute low-priority work in the main thread when there are no worker threads. Return true if work remains.
+    bool CompleteNonThreaded(long long maxUSec);
     /// Process work items until shut down. Called by the worker threads.
-    void ProcessItems(i32 threadIndex);
+    void ProcessItems(i32 threadIndex, ThreadCounters& counters);
     /// Purge completed work items which have at least the specified priority, and send completion events as necessary.
     void PurgeCompleted(i32 priority);
     /// Purge the pool to reduce allocation where its unneeded.
@@ -134,6 +198,28 @@ private:
     i32 lastSize_;
     /// Maximum milliseconds per frame to spend on low-priority work, when there are no worker threads.
     int maxNonThreadedWorkMs_;
+    /// Frame scheduler for non-threaded work.
+    WeakPtr<FrameScheduler> frameScheduler_;
+    /// Frame scheduler task for non-threaded work, or 0 if there is no frame scheduler.
+    u32 nonThreadedTask_;
+    /// Pin worker threads to physical cores flag.
+    bool threadAffinity_;
+    /// Collect thread utilization statistics flag.
+    std::atomic<bool> collectThreadStats_{};
+    /// Main thread statistics.
+    ThreadCounters mainThreadCounters_;
+    /// Time since the statistics were reset.
+    HiresTimer statsTimer_;
 };
 
+template <class T> SharedPtr<AsyncValue<T>> WorkQueue::RunAsync(const std::function<T()>& function, i32 priority)
+{
+    SharedPtr<AsyncValue<T>> result(new AsyncValue<T>());
+    AsyncValue<T>* value = result.Get();
+    SharedPtr<AsyncOperation> operation = RunAsync([function, value]() { value->SetValue(function()); }, priority);
+    AsyncOperation* source = operation.Get();
+    operation->Then([result, source]() { result->Complete(source->IsSucceeded()); });
+    return result;
+}
+
 }
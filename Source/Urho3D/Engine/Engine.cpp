@@ -7,6 +7,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/EventProfiler.h"
+#include "../Core/FrameScheduler.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/WorkQueue.h"
 #include "../Engine/Console.h"
@@ -104,6 +105,7 @@ Engine::Engine(Context* context) :
 
     // Create subsystems which do not depend on engine initialization or startup parameters
     context_->RegisterSubsystem(new Time(context_));
+    context_->RegisterSubsystem(new FrameScheduler(context_));
     context_->RegisterSubsystem(new WorkQueue(context_));
 #ifdef URHO3D_PROFILING
     context_->RegisterSubsystem(new Profiler(context_));
@@ -231,9 +233,14 @@ bool Engine::Initialize(const VariantMap& parameters)
     // Set amount of worker threads according to the available physical CPU cores. Using also hyperthreaded cores results in
     // unpredictable extra synchronization overhead. Also reserve one core for the main thread
 #ifdef URHO3D_THREADING
+    const CpuTopology& topology = GetCpuTopology();
+    URHO3D_LOGINFOF("CPU topology: %d logical CPUs, %d cores, %d packages, %d cache groups, %d NUMA nodes",
+        topology.cpus_.Size(), topology.numCores_, topology.numPackages_, topology.numCacheGroups_, topology.numNumaNodes_);
+
     unsigned numThreads = GetParameter(parameters, EP_WORKER_THREADS, true).GetBool() ? GetNumPhysicalCPUs() - 1 : 0;
     if (numThreads)
     {
+        GetSubsystem<WorkQueue>()->SetThreadAffinity(GetParameter(parameters, EP_WORKER_THREAD_AFFINITY, false).GetBool());
         GetSubsystem<WorkQueue>()->CreateThreads(numThreads);
 
         URHO3D_LOGINFOF("Created %u worker thread%s", numThreads, numThreads > 1 ? "s" : "");
@@ -758,6 +765,7 @@ void Engine::ApplyFrameLimit()
         maxFps = Min(maxInactiveFps_, maxFps);
 
     long long elapsed = 0;
+    long long targetMax = 0;
 
 #ifndef __EMSCRIPTEN__
     // Perform waiting loop if maximum FPS set
@@ -768,11 +776,18 @@ void Engine::ApplyFrameLimit()
     // instead of waiting ourselves
     if (maxFps < 60)
 #endif
+        targetMax = 1000000LL / maxFps;
+#endif
+
+    // Run deferred work in the time left before the frame deadline, or within the default budget if there is no deadline
+    auto* frameScheduler = GetSubsystem<FrameScheduler>();
+    if (frameScheduler)
+        frameScheduler->Update(targetMax ? Max(targetMax - frameTimer_.GetUSec(false), 0LL) : -1);
+
+    if (targetMax)
     {
         URHO3D_PROFILE(ApplyFrameLimit);
 
-        long long targetMax = 1000000LL / maxFps;
-
         for (;;)
         {
             elapsed = frameTimer_.GetUSec(false);
@@ -787,7 +802,6 @@ void Engine::ApplyFrameLimit()
             }
         }
     }
-#endif
 
     elapsed = frameTimer_.GetUSec(true);
 #ifdef URHO3D_TESTING
@@ -874,6 +888,8 @@ VariantMap Engine::ParseParameters(const Vector<String>& arguments)
                 ret[EP_LOW_QUALITY_SHADOWS] = true;
             else if (argument == "nothreads")
                 ret[EP_WORKER_THREADS] = false;
+            else if (argument == "pinthreads")
+                ret[EP_WORKER_THREAD_AFFINITY] = true;
             else if (argument == "v")
                 ret[EP_VSYNC] = true;
             else if (argument == "t")
@@ -56,5 +56,6 @@ static const String EP_WINDOW_RESIZABLE = "WindowResizable";
 static const String EP_WINDOW_TITLE = "WindowTitle";
 static const String EP_WINDOW_WIDTH = "WindowWidth";
 static const String EP_WORKER_THREADS = "WorkerThreads";
+static const String EP_WORKER_THREAD_AFFINITY = "WorkerThreadAffinity";
 
 }
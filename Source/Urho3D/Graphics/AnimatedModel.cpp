@@ -156,6 +156,22 @@ void AnimatedModel::ProcessRayQuery(const RayOctreeQuery& query, Vector<RayQuery
     const Vector<Bone>& bones = skeleton_.GetBones();
     Sphere boneSphere;
 
+    // Without any bone hitboxes, test the triangles of the bind pose mesh instead of reporting no hits
+    bool hasBoneCollision = false;
+    for (const Bone& bone : bones)
+    {
+        if (bone.node_ && (bone.collisionMask_ & (BONECOLLISION_BOX | BONECOLLISION_SPHERE)))
+        {
+            hasBoneCollision = true;
+            break;
+        }
+    }
+    if (!hasBoneCollision)
+    {
+        StaticModel::ProcessRayQuery(query, results);
+        return;
+    }
+
     for (i32 i = 0; i < bones.Size(); ++i)
     {
         const Bone& bone = bones[i];
@@ -304,6 +304,8 @@ struct LightBatchQueue
     bool negative_;
     /// Shadow map depth texture.
     Texture2D* shadowMap_;
+    /// Shadow atlas key if the shadow map is a shadow atlas region, otherwise 0.
+    hash64 shadowAtlasKey_{};
     /// Lit geometry draw calls, base (replace blend mode).
     BatchQueue litBaseBatches_;
     /// Lit geometry draw calls, non-base (additive).
@@ -21,11 +21,57 @@
 
 #include "../DebugNew.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
 namespace Urho3D
 {
 
 extern const char* GEOMETRY_CATEGORY;
 
+/// Vertex elements whose layout matches CustomGeometryVertex exactly, allowing vertices to be copied as is.
+static const VertexElements FULL_VERTEX_ELEMENTS = VertexElements::Position | VertexElements::Normal | VertexElements::Color |
+    VertexElements::TexCoord1 | VertexElements::Tangent;
+static_assert(sizeof(CustomGeometryVertex) == 13 * sizeof(float), "CustomGeometryVertex must not contain padding");
+
+/// Contiguous range of bytes to copy from a CustomGeometryVertex into the vertex buffer.
+struct CustomGeometryCopyRange
+{
+    unsigned offset_;
+    unsigned size_;
+};
+
+/// Return bounding box of vertex positions.
+static BoundingBox GetVertexBoundingBox(const CustomGeometryVertex* vertices, unsigned count)
+{
+    if (!count)
+        return BoundingBox();
+
+#ifdef URHO3D_SSE
+    // The fourth lane reads the first normal component and is ignored
+    __m128 boxMin = _mm_loadu_ps(&vertices[0].position_.x_);
+    __m128 boxMax = boxMin;
+    for (unsigned i = 1; i < count; ++i)
+    {
+        __m128 position = _mm_loadu_ps(&vertices[i].position_.x_);
+        boxMin = _mm_min_ps(boxMin, position);
+        boxMax = _mm_max_ps(boxMax, position);
+    }
+
+    alignas(16) float minValues[4];
+    alignas(16) float maxValues[4];
+    _mm_store_ps(minValues, boxMin);
+    _mm_store_ps(maxValues, boxMax);
+    return BoundingBox(Vector3(minValues), Vector3(maxValues));
+#else
+    BoundingBox box;
+    for (unsigned i = 0; i < count; ++i)
+        box.Merge(vertices[i].position_);
+    return box;
+#endif
+}
+
 CustomGeometry::CustomGeometry(Context* context)
     : Drawable(context, DrawableTypes::Geometry)
     , vertexBuffer_(new VertexBuffer(context))
@@ -319,9 +365,8 @@ void CustomGeometry::Commit()
     for (unsigned i = 0; i < vertices_.Size(); ++i)
     {
         totalVertices += vertices_[i].Size();
-
-        for (unsigned j = 0; j < vertices_[i].Size(); ++j)
-            boundingBox_.Merge(vertices_[i][j].position_);
+        if (vertices_[i].Size())
+            boundingBox_.Merge(GetVertexBoundingBox(vertices_[i].Buffer(), vertices_[i].Size()));
     }
 
     // Make sure world-space bounding box will be updated
@@ -334,6 +379,25 @@ void CustomGeometry::Commit()
 
     if (totalVertices)
     {
+        // Resolve the element mask into as few contiguous copies per vertex as possible, instead of testing each element per vertex
+        CustomGeometryCopyRange ranges[5];
+        unsigned numRanges = 0;
+        const VertexElements elements[] = {VertexElements::Position, VertexElements::Normal, VertexElements::Color,
+            VertexElements::TexCoord1, VertexElements::Tangent};
+        const unsigned offsets[] = {offsetof(CustomGeometryVertex, position_), offsetof(CustomGeometryVertex, normal_),
+            offsetof(CustomGeometryVertex, color_), offsetof(CustomGeometryVertex, texCoord_), offsetof(CustomGeometryVertex, tangent_)};
+        const unsigned sizes[] = {sizeof(Vector3), sizeof(Vector3), sizeof(color32), sizeof(Vector2), sizeof(Vector4)};
+        for (unsigned i = 0; i < 5; ++i)
+        {
+            // Position is always written
+            if (i && !(elementMask_ & elements[i]))
+                continue;
+            if (numRanges && ranges[numRanges - 1].offset_ + ranges[numRanges - 1].size_ == offsets[i])
+                ranges[numRanges - 1].size_ += sizes[i];
+            else
+                ranges[numRanges++] = {offsets[i], sizes[i]};
+        }
+
         auto* dest = (unsigned char*)vertexBuffer_->Lock(0, totalVertices, true);
         if (dest)
         {
@@ -341,35 +405,35 @@ void CustomGeometry::Commit()
 
             for (unsigned i = 0; i < vertices_.Size(); ++i)
             {
-                unsigned vertexCount = 0;
+                unsigned vertexCount = vertices_[i].Size();
+                const auto* src = reinterpret_cast<const unsigned char*>(vertices_[i].Buffer());
 
-                for (unsigned j = 0; j < vertices_[i].Size(); ++j)
+                if (elementMask_ == FULL_VERTEX_ELEMENTS)
                 {
-                    *((Vector3*)dest) = vertices_[i][j].position_;
-                    dest += sizeof(Vector3);
-
-                    if (!!(elementMask_ & VertexElements::Normal))
-                    {
-                        *((Vector3*)dest) = vertices_[i][j].normal_;
-                        dest += sizeof(Vector3);
-                    }
-                    if (!!(elementMask_ & VertexElements::Color))
-                    {
-                        *((unsigned*)dest) = vertices_[i][j].color_;
-                        dest += sizeof(unsigned);
-                    }
-                    if (!!(elementMask_ & VertexElements::TexCoord1))
+                    memcpy(dest, src, vertexCount * sizeof(CustomGeometryVertex));
+                    dest += vertexCount * sizeof(CustomGeometryVertex);
+                }
+                else if (numRanges == 1)
+                {
+                    const unsigned offset = ranges[0].offset_;
+                    const unsigned size = ranges[0].size_;
+                    for (unsigned j = 0; j < vertexCount; ++j)
                     {
-                        *((Vector2*)dest) = vertices_[i][j].texCoord_;
-                        dest += sizeof(Vector2);
+                        memcpy(dest, src + j * sizeof(CustomGeometryVertex) + offset, size);
+                        dest += size;
                     }
-                    if (!!(elementMask_ & VertexElements::Tangent))
+                }
+                else
+                {
+                    for (unsigned j = 0; j < vertexCount; ++j)
                     {
-                        *((Vector4*)dest) = vertices_[i][j].tangent_;
-                        dest += sizeof(Vector4);
+                        const unsigned char* vertex = src + j * sizeof(CustomGeometryVertex);
+                        for (unsigned k = 0; k < numRanges; ++k)
+                        {
+                            memcpy(dest, vertex + ranges[k].offset_, ranges[k].size_);
+                            dest += ranges[k].size_;
+                        }
                     }
-
-                    ++vertexCount;
                 }
 
                 geometries_[i]->SetVertexBuffer(0, vertexBuffer_);
@@ -28,6 +28,91 @@ static const unsigned MAX_LINES = 1000000;
 // Cap the amount of triangles to prevent crash.
 static const unsigned MAX_TRIANGLES = 100000;
 
+static float* WriteLines(float* dest, const Vector<DebugLine>& lines)
+{
+    for (const DebugLine& line : lines)
+    {
+        dest[0] = line.start_.x_;
+        dest[1] = line.start_.y_;
+        dest[2] = line.start_.z_;
+        ((unsigned&)dest[3]) = line.color_;
+        dest[4] = line.end_.x_;
+        dest[5] = line.end_.y_;
+        dest[6] = line.end_.z_;
+        ((unsigned&)dest[7]) = line.color_;
+
+        dest += 8;
+    }
+
+    return dest;
+}
+
+static float* WriteTriangles(float* dest, const Vector<DebugTriangle>& triangles)
+{
+    for (const DebugTriangle& triangle : triangles)
+    {
+        dest[0] = triangle.v1_.x_;
+        dest[1] = triangle.v1_.y_;
+        dest[2] = triangle.v1_.z_;
+        ((unsigned&)dest[3]) = triangle.color_;
+
+        dest[4] = triangle.v2_.x_;
+        dest[5] = triangle.v2_.y_;
+        dest[6] = triangle.v2_.z_;
+        ((unsigned&)dest[7]) = triangle.color_;
+
+        dest[8] = triangle.v3_.x_;
+        dest[9] = triangle.v3_.y_;
+        dest[10] = triangle.v3_.z_;
+        ((unsigned&)dest[11]) = triangle.color_;
+
+        dest += 12;
+    }
+
+    return dest;
+}
+
+void DebugGeometry::AddLine(const Vector3& start, const Vector3& end, unsigned color, bool depthTest)
+{
+    (depthTest ? lines_ : noDepthLines_).Push(DebugLine(start, end, color));
+    dirty_ = true;
+}
+
+void DebugGeometry::AddLines(const DebugLine* lines, i32 count, bool depthTest)
+{
+    if (!lines || count <= 0)
+        return;
+
+    Vector<DebugLine>& dest = depthTest ? lines_ : noDepthLines_;
+    dest.Insert(dest.End(), lines, lines + count);
+    dirty_ = true;
+}
+
+void DebugGeometry::AddTriangle(const Vector3& v1, const Vector3& v2, const Vector3& v3, unsigned color, bool depthTest)
+{
+    (depthTest ? triangles_ : noDepthTriangles_).Push(DebugTriangle(v1, v2, v3, color));
+    dirty_ = true;
+}
+
+void DebugGeometry::AddTriangles(const DebugTriangle* triangles, i32 count, bool depthTest)
+{
+    if (!triangles || count <= 0)
+        return;
+
+    Vector<DebugTriangle>& dest = depthTest ? triangles_ : noDepthTriangles_;
+    dest.Insert(dest.End(), triangles, triangles + count);
+    dirty_ = true;
+}
+
+void DebugGeometry::Clear()
+{
+    lines_.Clear();
+    noDepthLines_.Clear();
+    triangles_.Clear();
+    noDepthTriangles_.Clear();
+    dirty_ = true;
+}
+
 DebugRenderer::DebugRenderer(Context* context) :
     Component(context),
     lineAntiAlias_(false)
@@ -97,6 +182,34 @@ void DebugRenderer::AddTriangle(const Vector3& v1, const Vector3& v2, const Vect
         noDepthTriangles_.Push(DebugTriangle(v1, v2, v3, color));
 }
 
+void DebugRenderer::AddLines(const DebugLine* lines, i32 count, bool depthTest)
+{
+    if (!lines || count <= 0)
+        return;
+
+    i32 numLines = lines_.Size() + noDepthLines_.Size();
+    count = Min(count, (i32)MAX_LINES - numLines);
+    if (count <= 0)
+        return;
+
+    Vector<DebugLine>& dest = depthTest ? lines_ : noDepthLines_;
+    dest.Insert(dest.End(), lines, lines + count);
+}
+
+void DebugRenderer::AddTriangles(const DebugTriangle* triangles, i32 count, bool depthTest)
+{
+    if (!triangles || count <= 0)
+        return;
+
+    i32 numTriangles = triangles_.Size() + noDepthTriangles_.Size();
+    count = Min(count, (i32)MAX_TRIANGLES - numTriangles);
+    if (count <= 0)
+        return;
+
+    Vector<DebugTriangle>& dest = depthTest ? triangles_ : noDepthTriangles_;
+    dest.Insert(dest.End(), triangles, triangles + count);
+}
+
 void DebugRenderer::AddPolygon(const Vector3& v1, const Vector3& v2, const Vector3& v3, const Vector3& v4, const Color& color, bool depthTest)
 {
     AddTriangle(v1, v2, v3, color, depthTest);
@@ -465,6 +578,28 @@ void DebugRenderer::AddQuad(const Vector3& center, float width, float height, co
     AddLine(v3, v0, uintColor, depthTest);
 }
 
+void DebugRenderer::AddGeometry(DebugGeometry* geometry)
+{
+    if (geometry)
+        geometries_.Push(SharedPtr<DebugGeometry>(geometry));
+}
+
+void DebugRenderer::AddPersistentGeometry(DebugGeometry* geometry)
+{
+    if (geometry && !persistentGeometries_.Contains(SharedPtr<DebugGeometry>(geometry)))
+        persistentGeometries_.Push(SharedPtr<DebugGeometry>(geometry));
+}
+
+void DebugRenderer::RemovePersistentGeometry(DebugGeometry* geometry)
+{
+    persistentGeometries_.Remove(SharedPtr<DebugGeometry>(geometry));
+}
+
+void DebugRenderer::RemoveAllPersistentGeometry()
+{
+    persistentGeometries_.Clear();
+}
+
 void DebugRenderer::Render()
 {
     if (!HasContent())
@@ -480,111 +615,120 @@ void DebugRenderer::Render()
     ShaderVariation* ps = graphics->GetShader(PS, "Basic", "VERTEXCOLOR");
 
     i32 numVertices = (lines_.Size() + noDepthLines_.Size()) * 2 + (triangles_.Size() + noDepthTriangles_.Size()) * 3;
-    // Resize the vertex buffer if too small or much too large
-    if (vertexBuffer_->GetVertexCount() < numVertices || vertexBuffer_->GetVertexCount() > numVertices * 2)
-        vertexBuffer_->SetSize(numVertices, VertexElements::Position | VertexElements::Color, true);
-
-    auto* dest = (float*)vertexBuffer_->Lock(0, numVertices, true);
-    if (!dest)
-        return;
-
-    for (const DebugLine& line : lines_)
+    if (numVertices)
     {
-        dest[0] = line.start_.x_;
-        dest[1] = line.start_.y_;
-        dest[2] = line.start_.z_;
-        ((unsigned&)dest[3]) = line.color_;
-        dest[4] = line.end_.x_;
-        dest[5] = line.end_.y_;
-        dest[6] = line.end_.z_;
-        ((unsigned&)dest[7]) = line.color_;
+        // Resize the vertex buffer if too small or much too large
+        if (vertexBuffer_->GetVertexCount() < numVertices || vertexBuffer_->GetVertexCount() > numVertices * 2)
+            vertexBuffer_->SetSize(numVertices, VertexElements::Position | VertexElements::Color, true);
 
-        dest += 8;
-    }
+        auto* dest = (float*)vertexBuffer_->Lock(0, numVertices, true);
+        if (!dest)
+            return;
 
-    for (const DebugLine& line : noDepthLines_)
-    {
-        dest[0] = line.start_.x_;
-        dest[1] = line.start_.y_;
-        dest[2] = line.start_.z_;
-        ((unsigned&)dest[3]) = line.color_;
-        dest[4] = line.end_.x_;
-        dest[5] = line.end_.y_;
-        dest[6] = line.end_.z_;
-        ((unsigned&)dest[7]) = line.color_;
+        dest = WriteLines(dest, lines_);
+        dest = WriteLines(dest, noDepthLines_);
+        dest = WriteTriangles(dest, triangles_);
+        WriteTriangles(dest, noDepthTriangles_);
 
-        dest += 8;
+        vertexBuffer_->Unlock();
     }
 
-    for (const DebugTriangle& triangle : triangles_)
+    graphics->SetColorWrite(true);
+    graphics->SetCullMode(CULL_NONE);
+    graphics->SetLineAntiAlias(lineAntiAlias_);
+    graphics->SetScissorTest(false);
+    graphics->SetStencilTest(false);
+    graphics->SetShaders(vs, ps);
+    graphics->SetShaderParameter(VSP_VIEW, view_);
+    graphics->SetShaderParameter(VSP_VIEWINV, view_.Inverse());
+    graphics->SetShaderParameter(VSP_VIEWPROJ, gpuProjection_ * view_);
+    graphics->SetShaderParameter(PSP_MATDIFFCOLOR, Color(1.0f, 1.0f, 1.0f, 1.0f));
+
+    if (numVertices)
     {
-        dest[0] = triangle.v1_.x_;
-        dest[1] = triangle.v1_.y_;
-        dest[2] = triangle.v1_.z_;
-        ((unsigned&)dest[3]) = triangle.color_;
+        graphics->SetShaderParameter(VSP_MODEL, Matrix3x4::IDENTITY);
+        graphics->SetVertexBuffer(vertexBuffer_);
+        DrawVertices(graphics, lines_.Size(), noDepthLines_.Size(), triangles_.Size(), noDepthTriangles_.Size());
+    }
 
-        dest[4] = triangle.v2_.x_;
-        dest[5] = triangle.v2_.y_;
-        dest[6] = triangle.v2_.z_;
-        ((unsigned&)dest[7]) = triangle.color_;
+    // Retained geometry uses its own vertex buffers, so only changed geometry costs an upload
+    for (DebugGeometry* geometry : geometries_)
+        DrawGeometry(graphics, geometry);
+    for (DebugGeometry* geometry : persistentGeometries_)
+        DrawGeometry(graphics, geometry);
 
-        dest[8] = triangle.v3_.x_;
-        dest[9] = triangle.v3_.y_;
-        dest[10] = triangle.v3_.z_;
-        ((unsigned&)dest[11]) = triangle.color_;
+    graphics->SetLineAntiAlias(false);
+}
 
-        dest += 12;
-    }
+bool DebugRenderer::IsInside(const BoundingBox& box) const
+{
+    return frustum_.IsInsideFast(box) == INSIDE;
+}
 
-    for (const DebugTriangle& triangle : noDepthTriangles_)
-    {
-        dest[0] = triangle.v1_.x_;
-        dest[1] = triangle.v1_.y_;
-        dest[2] = triangle.v1_.z_;
-        ((unsigned&)dest[3]) = triangle.color_;
+bool DebugRenderer::HasContent() const
+{
+    return !(lines_.Empty() && noDepthLines_.Empty() && triangles_.Empty() && noDepthTriangles_.Empty() &&
+        geometries_.Empty() && persistentGeometries_.Empty());
+}
 
-        dest[4] = triangle.v2_.x_;
-        dest[5] = triangle.v2_.y_;
-        dest[6] = triangle.v2_.z_;
-        ((unsigned&)dest[7]) = triangle.color_;
+void DebugRenderer::DrawGeometry(Graphics* graphics, DebugGeometry* geometry)
+{
+    if (geometry->IsEmpty())
+        return;
 
-        dest[8] = triangle.v3_.x_;
-        dest[9] = triangle.v3_.y_;
-        dest[10] = triangle.v3_.z_;
-        ((unsigned&)dest[11]) = triangle.color_;
+    if (!geometry->vertexBuffer_)
+    {
+        geometry->vertexBuffer_ = new VertexBuffer(context_);
+        // Not shadowed, as the geometry keeps its lines and triangles. Lost data is rewritten from them instead
+        geometry->vertexBuffer_->SetShadowed(false);
+        geometry->dirty_ = true;
+    }
 
-        dest += 12;
+    VertexBuffer* vertexBuffer = geometry->vertexBuffer_;
+    if (geometry->dirty_ || vertexBuffer->IsDataLost())
+    {
+        i32 numVertices = geometry->GetNumLines() * 2 + geometry->GetNumTriangles() * 3;
+        if (vertexBuffer->GetVertexCount() != numVertices)
+            vertexBuffer->SetSize(numVertices, VertexElements::Position | VertexElements::Color);
+
+        auto* dest = (float*)vertexBuffer->Lock(0, numVertices, true);
+        if (!dest)
+            return;
+
+        dest = WriteLines(dest, geometry->lines_);
+        dest = WriteLines(dest, geometry->noDepthLines_);
+        dest = WriteTriangles(dest, geometry->triangles_);
+        WriteTriangles(dest, geometry->noDepthTriangles_);
+
+        vertexBuffer->Unlock();
+        vertexBuffer->ClearDataLost();
+        geometry->dirty_ = false;
     }
 
-    vertexBuffer_->Unlock();
+    graphics->SetShaderParameter(VSP_MODEL, geometry->transform_);
+    graphics->SetVertexBuffer(vertexBuffer);
+    DrawVertices(graphics, geometry->lines_.Size(), geometry->noDepthLines_.Size(), geometry->triangles_.Size(),
+        geometry->noDepthTriangles_.Size());
+}
 
+void DebugRenderer::DrawVertices(Graphics* graphics, i32 numLines, i32 numNoDepthLines, i32 numTriangles,
+    i32 numNoDepthTriangles)
+{
     graphics->SetBlendMode(lineAntiAlias_ ? BLEND_ALPHA : BLEND_REPLACE);
-    graphics->SetColorWrite(true);
-    graphics->SetCullMode(CULL_NONE);
     graphics->SetDepthWrite(true);
-    graphics->SetLineAntiAlias(lineAntiAlias_);
-    graphics->SetScissorTest(false);
-    graphics->SetStencilTest(false);
-    graphics->SetShaders(vs, ps);
-    graphics->SetShaderParameter(VSP_MODEL, Matrix3x4::IDENTITY);
-    graphics->SetShaderParameter(VSP_VIEW, view_);
-    graphics->SetShaderParameter(VSP_VIEWINV, view_.Inverse());
-    graphics->SetShaderParameter(VSP_VIEWPROJ, gpuProjection_ * view_);
-    graphics->SetShaderParameter(PSP_MATDIFFCOLOR, Color(1.0f, 1.0f, 1.0f, 1.0f));
-    graphics->SetVertexBuffer(vertexBuffer_);
 
     unsigned start = 0;
     unsigned count = 0;
-    if (lines_.Size())
+    if (numLines)
     {
-        count = lines_.Size() * 2;
+        count = numLines * 2;
         graphics->SetDepthTest(CMP_LESSEQUAL);
         graphics->Draw(LINE_LIST, start, count);
         start += count;
     }
-    if (noDepthLines_.Size())
+    if (numNoDepthLines)
     {
-        count = noDepthLines_.Size() * 2;
+        count = numNoDepthLines * 2;
         graphics->SetDepthTest(CMP_ALWAYS);
         graphics->Draw(LINE_LIST, start, count);
         start += count;
@@ -593,31 +737,19 @@ void DebugRenderer::Render()
     graphics->SetBlendMode(BLEND_ALPHA);
     graphics->SetDepthWrite(false);
 
-    if (triangles_.Size())
+    if (numTriangles)
     {
-        count = triangles_.Size() * 3;
+        count = numTriangles * 3;
         graphics->SetDepthTest(CMP_LESSEQUAL);
         graphics->Draw(TRIANGLE_LIST, start, count);
         start += count;
     }
-    if (noDepthTriangles_.Size())
+    if (numNoDepthTriangles)
     {
-        count = noDepthTriangles_.Size() * 3;
+        count = numNoDepthTriangles * 3;
         graphics->SetDepthTest(CMP_ALWAYS);
         graphics->Draw(TRIANGLE_LIST, start, count);
     }
-
-    graphics->SetLineAntiAlias(false);
-}
-
-bool DebugRenderer::IsInside(const BoundingBox& box) const
-{
-    return frustum_.IsInsideFast(box) == INSIDE;
-}
-
-bool DebugRenderer::HasContent() const
-{
-    return !(lines_.Empty() && noDepthLines_.Empty() && triangles_.Empty() && noDepthTriangles_.Empty());
 }
 
 void DebugRenderer::HandleEndFrame(StringHash eventType, VariantMap& eventData)
@@ -632,6 +764,7 @@ void DebugRenderer::HandleEndFrame(StringHash eventType, VariantMap& eventData)
     noDepthLines_.Clear();
     triangles_.Clear();
     noDepthTriangles_.Clear();
+    geometries_.Clear();
 
     if (lines_.Capacity() > linesSize * 2)
         lines_.Reserve(linesSize);
@@ -12,6 +12,7 @@ namespace Urho3D
 
 class BoundingBox;
 class Camera;
+class Graphics;
 class Polyhedron;
 class Drawable;
 class Light;
@@ -68,6 +69,54 @@ struct DebugTriangle
     unsigned color_{};
 };
 
+/// Debug lines and triangles that are kept between frames. The vertex buffer is only updated when the geometry changes.
+class URHO3D_API DebugGeometry : public RefCounted
+{
+    friend class DebugRenderer;
+
+public:
+    /// Construct empty.
+    DebugGeometry() = default;
+
+    /// Add a line.
+    void AddLine(const Vector3& start, const Vector3& end, unsigned color, bool depthTest = true);
+    /// Add lines.
+    void AddLines(const DebugLine* lines, i32 count, bool depthTest = true);
+    /// Add a solid triangle.
+    void AddTriangle(const Vector3& v1, const Vector3& v2, const Vector3& v3, unsigned color, bool depthTest = true);
+    /// Add solid triangles.
+    void AddTriangles(const DebugTriangle* triangles, i32 count, bool depthTest = true);
+    /// Remove all lines and triangles.
+    void Clear();
+    /// Set the transform applied when rendering.
+    void SetTransform(const Matrix3x4& transform) { transform_ = transform; }
+
+    /// Return the transform applied when rendering.
+    const Matrix3x4& GetTransform() const { return transform_; }
+    /// Return number of lines.
+    i32 GetNumLines() const { return lines_.Size() + noDepthLines_.Size(); }
+    /// Return number of triangles.
+    i32 GetNumTriangles() const { return triangles_.Size() + noDepthTriangles_.Size(); }
+    /// Return whether has nothing to render.
+    bool IsEmpty() const { return !GetNumLines() && !GetNumTriangles(); }
+
+private:
+    /// Lines rendered with depth test.
+    Vector<DebugLine> lines_;
+    /// Lines rendered without depth test.
+    Vector<DebugLine> noDepthLines_;
+    /// Triangles rendered with depth test.
+    Vector<DebugTriangle> triangles_;
+    /// Triangles rendered without depth test.
+    Vector<DebugTriangle> noDepthTriangles_;
+    /// Transform applied when rendering.
+    Matrix3x4 transform_;
+    /// Vertex buffer. Created on first render.
+    SharedPtr<VertexBuffer> vertexBuffer_;
+    /// Vertex buffer needs update flag.
+    bool dirty_{};
+};
+
 /// Debug geometry rendering component. Should be added only to the root scene node.
 class URHO3D_API DebugRenderer : public Component
 {
@@ -95,6 +144,10 @@ public:
     void AddTriangle(const Vector3& v1, const Vector3& v2, const Vector3& v3, const Color& color, bool depthTest = true);
     /// Add a solid triangle with color already converted to unsigned.
     void AddTriangle(const Vector3& v1, const Vector3& v2, const Vector3& v3, unsigned color, bool depthTest = true);
+    /// Add lines.
+    void AddLines(const DebugLine* lines, i32 count, bool depthTest = true);
+    /// Add solid triangles.
+    void AddTriangles(const DebugTriangle* triangles, i32 count, bool depthTest = true);
     /// Add a solid quadrangular polygon.
     void AddPolygon(const Vector3& v1, const Vector3& v2, const Vector3& v3, const Vector3& v4, const Color& color, bool depthTest = true);
     /// Add a solid quadrangular polygon with color already converted to unsigned.
@@ -130,6 +183,14 @@ public:
     void AddCross(const Vector3& center, float size, const Color& color, bool depthTest = true);
     /// Add a quad on the XZ plane.
     void AddQuad(const Vector3& center, float width, float height, const Color& color, bool depthTest = true);
+    /// Add retained geometry to be rendered on this frame.
+    void AddGeometry(DebugGeometry* geometry);
+    /// Add retained geometry to be rendered on every frame until removed.
+    void AddPersistentGeometry(DebugGeometry* geometry);
+    /// Remove retained geometry added with AddPersistentGeometry().
+    void RemovePersistentGeometry(DebugGeometry* geometry);
+    /// Remove all retained geometry added with AddPersistentGeometry().
+    void RemoveAllPersistentGeometry();
 
     /// Update vertex buffer and render all debug lines. The viewport and rendertarget should be set before.
     void Render();
@@ -155,6 +216,10 @@ public:
 private:
     /// Handle end of frame. Clear debug geometry.
     void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+    /// Render retained geometry, updating its vertex buffer first if it has changed.
+    void DrawGeometry(Graphics* graphics, DebugGeometry* geometry);
+    /// Draw lines and triangles from the currently set vertex buffer, in the order they are written to it.
+    void DrawVertices(Graphics* graphics, i32 numLines, i32 numNoDepthLines, i32 numTriangles, i32 numNoDepthTriangles);
 
     /// Lines rendered with depth test.
     Vector<DebugLine> lines_;
@@ -164,6 +229,10 @@ private:
     Vector<DebugTriangle> triangles_;
     /// Triangles rendered without depth test.
     Vector<DebugTriangle> noDepthTriangles_;
+    /// Retained geometry rendered on this frame.
+    Vector<SharedPtr<DebugGeometry>> geometries_;
+    /// Retained geometry rendered on every frame.
+    Vector<SharedPtr<DebugGeometry>> persistentGeometries_;
     /// View transform.
     Matrix3x4 view_;
     /// Projection transform.
@@ -5,6 +5,8 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Camera.h"
@@ -13,6 +15,7 @@
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/Tangent.h"
+#include "../Graphics/TriangleBVH.h"
 #include "../GraphicsAPI/IndexBuffer.h"
 #include "../GraphicsAPI/VertexBuffer.h"
 #include "../IO/Log.h"
@@ -21,6 +24,10 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -73,7 +80,121 @@ static DecalVertex ClipEdge(const DecalVertex& v0, const DecalVertex& v1, float
     return ret;
 }
 
-static void ClipPolygon(Vector<DecalVertex>& dest, const Vector<DecalVertex>& src, const Plane& plane, bool skinned)
+/// Decal being built, either immediately or in a worker thread.
+struct DecalTask : public RefCounted
+{
+    /// Decal frustum in target space.
+    Frustum frustum_;
+    /// Decal normal in target space.
+    Vector3 decalNormal_;
+    /// Normal cutoff for faces.
+    float normalCutoff_{};
+    /// View transform for UV calculation.
+    Matrix3x4 uvView_;
+    /// Projection for UV calculation.
+    Matrix4 uvProjection_;
+    /// Top left UV.
+    Vector2 topLeftUV_;
+    /// Bottom right UV.
+    Vector2 bottomRightUV_;
+    /// Transform from target space to the decal set's local space.
+    Matrix3x4 vertexTransform_;
+    /// Target geometries.
+    Vector<SharedPtr<Geometry>> geometries_;
+    /// Target batch indices corresponding to the geometries.
+    Vector<unsigned> batchIndices_;
+    /// Triangle BVHs corresponding to the geometries, or null to test all triangles. Referenced here so that the main thread keeps them alive while a worker uses them.
+    Vector<SharedPtr<TriangleBVH>> bvhs_;
+    /// Resulting decal.
+    Decal decal_;
+    /// Work item when building asynchronously.
+    SharedPtr<WorkItem> item_;
+};
+
+void BuildDecalWork(const WorkItem* item, i32 threadIndex)
+{
+    auto* decalSet = reinterpret_cast<DecalSet*>(item->aux_);
+    auto* task = reinterpret_cast<DecalTask*>(item->start_);
+
+    decalSet->BuildDecal(*task, nullptr);
+}
+
+static bool IsFaceOutside(const Frustum& frustum, const Vector3& v0, const Vector3& v1, const Vector3& v2)
+{
+#ifdef URHO3D_SSE
+    // Test the three vertices against one plane at a time, four lanes with the last vertex duplicated
+    __m128 x = _mm_set_ps(v2.x_, v2.x_, v1.x_, v0.x_);
+    __m128 y = _mm_set_ps(v2.y_, v2.y_, v1.y_, v0.y_);
+    __m128 z = _mm_set_ps(v2.z_, v2.z_, v1.z_, v0.z_);
+    __m128 zero = _mm_setzero_ps();
+
+    for (i32 i = PLANE_FAR; i >= 0; --i)
+    {
+        const Plane& plane = frustum.planes_[i];
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.normal_.x_)),
+            _mm_mul_ps(y, _mm_set1_ps(plane.normal_.y_))), _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.normal_.z_)),
+            _mm_set1_ps(plane.d_)));
+        if (_mm_movemask_ps(_mm_cmplt_ps(distance, zero)) == 0xf)
+            return true;
+    }
+
+    return false;
+#else
+    for (i32 i = PLANE_FAR; i >= 0; --i)
+    {
+        const Plane& plane = frustum.planes_[i];
+        if (plane.Distance(v0) < 0.0f && plane.Distance(v1) < 0.0f && plane.Distance(v2) < 0.0f)
+            return true;
+    }
+
+    return false;
+#endif
+}
+
+/// Compute the distances of polygon vertices to a plane. Return the number of vertices in front of the plane.
+static i32 GetPlaneDistances(Vector<float>& dest, const Vector<DecalVertex>& src, const Plane& plane)
+{
+    dest.Resize(src.Size());
+    i32 numInside = 0;
+    i32 i = 0;
+
+#ifdef URHO3D_SSE
+    // Four vertices per iteration
+    __m128 nx = _mm_set1_ps(plane.normal_.x_);
+    __m128 ny = _mm_set1_ps(plane.normal_.y_);
+    __m128 nz = _mm_set1_ps(plane.normal_.z_);
+    __m128 d = _mm_set1_ps(plane.d_);
+    __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= src.Size(); i += 4)
+    {
+        const Vector3& p0 = src[i].position_;
+        const Vector3& p1 = src[i + 1].position_;
+        const Vector3& p2 = src[i + 2].position_;
+        const Vector3& p3 = src[i + 3].position_;
+        __m128 x = _mm_set_ps(p3.x_, p2.x_, p1.x_, p0.x_);
+        __m128 y = _mm_set_ps(p3.y_, p2.y_, p1.y_, p0.y_);
+        __m128 z = _mm_set_ps(p3.z_, p2.z_, p1.z_, p0.z_);
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, nx), _mm_mul_ps(y, ny)), _mm_add_ps(_mm_mul_ps(z, nz), d));
+        _mm_storeu_ps(&dest[i], distance);
+
+        int insideMask = _mm_movemask_ps(_mm_cmpge_ps(distance, zero));
+        numInside += (insideMask & 1) + ((insideMask >> 1) & 1) + ((insideMask >> 2) & 1) + ((insideMask >> 3) & 1);
+    }
+#endif
+
+    for (; i < src.Size(); ++i)
+    {
+        dest[i] = plane.Distance(src[i].position_);
+        if (dest[i] >= 0.0f)
+            ++numInside;
+    }
+
+    return numInside;
+}
+
+static void ClipPolygon(Vector<DecalVertex>& dest, const Vector<DecalVertex>& src, const Vector<float>& distances,
+    bool skinned)
 {
     unsigned last = 0;
     float lastDistance = 0.0f;
@@ -84,7 +205,7 @@ static void ClipPolygon(Vector<DecalVertex>& dest, const Vector<DecalVertex>& sr
 
     for (unsigned i = 0; i < src.Size(); ++i)
     {
-        float distance = plane.Distance(src[i].position_);
+        float distance = distances[i];
         if (distance >= 0.0f)
         {
             if (lastDistance < 0.0f)
@@ -103,7 +224,7 @@ static void ClipPolygon(Vector<DecalVertex>& dest, const Vector<DecalVertex>& sr
     }
 
     // Recheck the distances of the last and first vertices and add the final clipped vertex if applicable
-    float distance = plane.Distance(src[0].position_);
+    float distance = distances[0];
     if ((lastDistance < 0.0f && distance >= 0.0f) || (lastDistance >= 0.0f && distance < 0.0f))
         dest.Push(ClipEdge(src[last], src[0], lastDistance, distance, skinned));
 }
@@ -140,6 +261,7 @@ DecalSet::DecalSet(Context* context) :
     numIndices_(0),
     maxVertices_(DEFAULT_MAX_VERTICES),
     maxIndices_(DEFAULT_MAX_INDICES),
+    numNewDecals_(0),
     optimizeBufferSize_(false),
     skinned_(false),
     bufferDirty_(true),
@@ -155,7 +277,10 @@ DecalSet::DecalSet(Context* context) :
     batches_[0].geometryType_ = GEOM_STATIC_NOINSTANCING;
 }
 
-DecalSet::~DecalSet() = default;
+DecalSet::~DecalSet()
+{
+    CancelPendingDecals();
+}
 
 void DecalSet::RegisterObject(Context* context)
 {
@@ -208,7 +333,7 @@ void DecalSet::UpdateBatches(const FrameInfo& frame)
 
 void DecalSet::UpdateGeometry(const FrameInfo& frame)
 {
-    if (bufferDirty_ || vertexBuffer_->IsDataLost() || indexBuffer_->IsDataLost())
+    if (bufferDirty_ || numNewDecals_ || vertexBuffer_->IsDataLost() || indexBuffer_->IsDataLost())
         UpdateBuffers();
 
     if (skinningDirty_)
@@ -217,7 +342,7 @@ void DecalSet::UpdateGeometry(const FrameInfo& frame)
 
 UpdateGeometryType DecalSet::GetUpdateGeometryType()
 {
-    if (bufferDirty_ || vertexBuffer_->IsDataLost() || indexBuffer_->IsDataLost())
+    if (bufferDirty_ || numNewDecals_ || vertexBuffer_->IsDataLost() || indexBuffer_->IsDataLost())
         return UPDATE_MAIN_THREAD;
     else if (skinningDirty_)
         return UPDATE_WORKER_THREAD;
@@ -284,6 +409,50 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
 {
     URHO3D_PROFILE(AddDecal);
 
+    DecalTask task;
+    if (!PrepareDecal(task, target, worldPosition, worldRotation, size, aspectRatio, depth, topLeftUV, bottomRightUV, timeToLive,
+        normalCutoff, subGeometry))
+        return false;
+
+    BuildDecal(task, target);
+    return CommitDecal(task.decal_);
+}
+
+bool DecalSet::AddDecalAsync(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size,
+    float aspectRatio, float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive, float normalCutoff,
+    unsigned subGeometry)
+{
+    // Skinned decals need the target's skeleton while gathering faces, so they are always added immediately
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue || !queue->GetNumThreads() || dynamic_cast<AnimatedModel*>(target))
+        return AddDecal(target, worldPosition, worldRotation, size, aspectRatio, depth, topLeftUV, bottomRightUV, timeToLive,
+            normalCutoff, subGeometry);
+
+    URHO3D_PROFILE(AddDecalAsync);
+
+    SharedPtr<DecalTask> task(new DecalTask());
+    if (!PrepareDecal(*task, target, worldPosition, worldRotation, size, aspectRatio, depth, topLeftUV, bottomRightUV, timeToLive,
+        normalCutoff, subGeometry))
+        return false;
+
+    if (pendingTasks_.Empty())
+        SubscribeToEvent(queue, E_WORKITEMCOMPLETED, URHO3D_HANDLER(DecalSet, HandleWorkItemCompleted));
+
+    task->item_ = queue->GetFreeItem();
+    task->item_->priority_ = 0;
+    task->item_->sendEvent_ = true;
+    task->item_->workFunction_ = BuildDecalWork;
+    task->item_->start_ = task.Get();
+    task->item_->aux_ = this;
+    pendingTasks_.Push(task);
+    queue->AddWorkItem(task->item_);
+    return true;
+}
+
+bool DecalSet::PrepareDecal(DecalTask& task, Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation,
+    float size, float aspectRatio, float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive,
+    float normalCutoff, unsigned subGeometry)
+{
     // Do not add decals in headless mode
     if (!node_ || !GetSubsystem<Graphics>())
         return false;
@@ -353,45 +522,81 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
     }
 
     // Build the decal frustum
-    Frustum decalFrustum;
     Matrix3x4 frustumTransform = targetTransform * Matrix3x4(adjustedWorldPosition, worldRotation, 1.0f);
-    decalFrustum.DefineOrtho(size, aspectRatio, 1.0, 0.0f, depth, frustumTransform);
-
-    Vector3 decalNormal = (targetTransform * Vector4(worldRotation * Vector3::BACK, 0.0f)).Normalized();
+    task.frustum_.DefineOrtho(size, aspectRatio, 1.0, 0.0f, depth, frustumTransform);
+    task.decalNormal_ = (targetTransform * Vector4(worldRotation * Vector3::BACK, 0.0f)).Normalized();
+    task.normalCutoff_ = normalCutoff;
+
+    // Projection for calculating UVs
+    task.uvView_ = frustumTransform.Inverse();
+    task.uvProjection_ = Matrix4::ZERO;
+    task.uvProjection_.m11_ = (1.0f / (size * 0.5f));
+    task.uvProjection_.m00_ = task.uvProjection_.m11_ / aspectRatio;
+    task.uvProjection_.m22_ = 1.0f / depth;
+    task.uvProjection_.m33_ = 1.0f;
+    task.topLeftUV_ = topLeftUV;
+    task.bottomRightUV_ = bottomRightUV;
+
+    // Transform from the target geometry to this node's local space
+    task.vertexTransform_ = skinned_ ? Matrix3x4::IDENTITY :
+        node_->GetWorldTransform().Inverse() * target->GetNode()->GetWorldTransform();
+    task.decal_.timeToLive_ = timeToLive;
+
+    // Morphed models may have their vertex positions changed from the data the triangle BVH was built from
+    bool useBVH = !animatedModel || animatedModel->GetMorphs().Empty();
+
+    // Use either a specified subgeometry in the target, or all. Take the most accurate LOD level if possible
+    unsigned numBatches = target->GetBatches().Size();
+    unsigned firstBatch = subGeometry < numBatches ? subGeometry : 0;
+    unsigned lastBatch = subGeometry < numBatches ? subGeometry + 1 : numBatches;
+    for (unsigned i = firstBatch; i < lastBatch; ++i)
+    {
+        Geometry* geometry = target->GetLodGeometry(i, 0);
+        task.geometries_.Push(SharedPtr<Geometry>(geometry));
+        task.batchIndices_.Push(i);
+        // Build or fetch the BVH here, so that the worker does not touch the geometry's reference
+        task.bvhs_.Push(SharedPtr<TriangleBVH>(useBVH && geometry ? geometry->GetTriangleBVH() : nullptr));
+    }
 
-    decals_.Resize(decals_.Size() + 1);
-    Decal& newDecal = decals_.Back();
-    newDecal.timeToLive_ = timeToLive;
+    return true;
+}
 
+void DecalSet::BuildDecal(DecalTask& task, Drawable* target)
+{
     Vector<Vector<DecalVertex>> faces;
     Vector<DecalVertex> tempFace;
+    Vector<float> distances;
 
-    unsigned numBatches = target->GetBatches().Size();
+    for (unsigned i = 0; i < task.geometries_.Size(); ++i)
+        GetFaces(faces, target, task.geometries_[i], task.batchIndices_[i], task.frustum_, task.decalNormal_,
+            task.normalCutoff_, task.bvhs_[i]);
 
-    // Use either a specified subgeometry in the target, or all
-    if (subGeometry < numBatches)
-        GetFaces(faces, target, subGeometry, decalFrustum, decalNormal, normalCutoff);
-    else
+    // Clip the acquired faces against all frustum planes. Most faces lie entirely inside a plane and need no copy
+    for (unsigned j = 0; j < faces.Size(); ++j)
     {
-        for (unsigned i = 0; i < numBatches; ++i)
-            GetFaces(faces, target, i, decalFrustum, decalNormal, normalCutoff);
-    }
+        Vector<DecalVertex>& face = faces[j];
 
-    // Clip the acquired faces against all frustum planes
-    for (const auto& plane : decalFrustum.planes_)
-    {
-        for (unsigned j = 0; j < faces.Size(); ++j)
+        for (const auto& plane : task.frustum_.planes_)
         {
-            Vector<DecalVertex>& face = faces[j];
             if (face.Empty())
+                break;
+
+            i32 numInside = GetPlaneDistances(distances, face, plane);
+            if (numInside == face.Size())
                 continue;
+            if (!numInside)
+            {
+                face.Clear();
+                break;
+            }
 
-            ClipPolygon(tempFace, face, plane, skinned_);
-            face = tempFace;
+            ClipPolygon(tempFace, face, distances, skinned_);
+            face.Swap(tempFace);
         }
     }
 
     // Now triangulate the resulting faces into decal vertices
+    Decal& decal = task.decal_;
     for (unsigned i = 0; i < faces.Size(); ++i)
     {
         Vector<DecalVertex>& face = faces[i];
@@ -400,51 +605,52 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
 
         for (unsigned j = 2; j < face.Size(); ++j)
         {
-            newDecal.AddVertex(face[0]);
-            newDecal.AddVertex(face[j - 1]);
-            newDecal.AddVertex(face[j]);
+            decal.AddVertex(face[0]);
+            decal.AddVertex(face[j - 1]);
+            decal.AddVertex(face[j]);
         }
     }
 
+    // Limits are checked when committing the decal, as they may change while an asynchronous decal is being built
+    if (decal.vertices_.Empty())
+        return;
+
+    // Calculate UVs, transform vertices to this node's local space and generate tangents
+    CalculateUVs(decal, task.uvView_, task.uvProjection_, task.topLeftUV_, task.bottomRightUV_);
+    TransformVertices(decal, task.vertexTransform_);
+    GenerateTangents(&decal.vertices_[0], sizeof(DecalVertex), &decal.indices_[0], sizeof(unsigned short), 0,
+        decal.indices_.Size(), offsetof(DecalVertex, normal_), offsetof(DecalVertex, texCoord_), offsetof(DecalVertex,
+        tangent_));
+
+    decal.CalculateBoundingBox();
+}
+
+bool DecalSet::CommitDecal(Decal& decal)
+{
     // Check if resulted in no triangles
-    if (newDecal.vertices_.Empty())
-    {
-        decals_.Pop();
+    if (decal.vertices_.Empty())
         return true;
-    }
 
-    if (newDecal.vertices_.Size() > maxVertices_)
+    if (decal.vertices_.Size() > maxVertices_)
     {
-        URHO3D_LOGWARNING("Can not add decal, vertex count " + String(newDecal.vertices_.Size()) + " exceeds maximum " +
+        URHO3D_LOGWARNING("Can not add decal, vertex count " + String(decal.vertices_.Size()) + " exceeds maximum " +
                    String(maxVertices_));
-        decals_.Pop();
         return false;
     }
-    if (newDecal.indices_.Size() > maxIndices_)
+    if (decal.indices_.Size() > maxIndices_)
     {
-        URHO3D_LOGWARNING("Can not add decal, index count " + String(newDecal.indices_.Size()) + " exceeds maximum " +
+        URHO3D_LOGWARNING("Can not add decal, index count " + String(decal.indices_.Size()) + " exceeds maximum " +
                    String(maxIndices_));
-        decals_.Pop();
         return false;
     }
 
-    // Calculate UVs
-    Matrix4 projection(Matrix4::ZERO);
-    projection.m11_ = (1.0f / (size * 0.5f));
-    projection.m00_ = projection.m11_ / aspectRatio;
-    projection.m22_ = 1.0f / depth;
-    projection.m33_ = 1.0f;
-
-    CalculateUVs(newDecal, frustumTransform.Inverse(), projection, topLeftUV, bottomRightUV);
-
-    // Transform vertices to this node's local space and generate tangents
-    Matrix3x4 decalTransform = node_->GetWorldTransform().Inverse() * target->GetNode()->GetWorldTransform();
-    TransformVertices(newDecal, skinned_ ? Matrix3x4::IDENTITY : decalTransform);
-    GenerateTangents(&newDecal.vertices_[0], sizeof(DecalVertex), &newDecal.indices_[0], sizeof(unsigned short), 0,
-        newDecal.indices_.Size(), offsetof(DecalVertex, normal_), offsetof(DecalVertex, texCoord_), offsetof(DecalVertex,
-        tangent_));
+    decals_.Resize(decals_.Size() + 1);
+    Decal& newDecal = decals_.Back();
+    newDecal.timeToLive_ = decal.timeToLive_;
+    newDecal.boundingBox_ = decal.boundingBox_;
+    newDecal.vertices_.Swap(decal.vertices_);
+    newDecal.indices_.Swap(decal.indices_);
 
-    newDecal.CalculateBoundingBox();
     numVertices_ += newDecal.vertices_.Size();
     numIndices_ += newDecal.indices_.Size();
 
@@ -458,10 +664,35 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
     if (newDecal.timeToLive_ > 0.0f && !subscribed_)
         UpdateEventSubscription(false);
 
-    MarkDecalsDirty();
+    // Unless the buffers already need a full rewrite, only the new decal needs to be appended
+    ++numNewDecals_;
+    UpdateDrawRange();
+    MarkBoundingBoxDirty();
     return true;
 }
 
+void DecalSet::CancelPendingDecals()
+{
+    if (pendingTasks_.Empty())
+        return;
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    for (unsigned i = 0; i < pendingTasks_.Size(); ++i)
+    {
+        // If the work item has already started, wait for it, as it references this decal set
+        SharedPtr<WorkItem> item = pendingTasks_[i]->item_;
+        if (queue && !queue->RemoveWorkItem(item))
+        {
+            while (!item->completed_)
+                Time::Sleep(0);
+        }
+    }
+
+    pendingTasks_.Clear();
+    if (queue)
+        UnsubscribeFromEvent(queue, E_WORKITEMCOMPLETED);
+}
+
 void DecalSet::RemoveDecals(unsigned num)
 {
     while (num-- && decals_.Size())
@@ -470,6 +701,8 @@ void DecalSet::RemoveDecals(unsigned num)
 
 void DecalSet::RemoveAllDecals()
 {
+    CancelPendingDecals();
+
     if (!decals_.Empty())
     {
         decals_.Clear();
@@ -674,11 +907,9 @@ void DecalSet::OnWorldBoundingBoxUpdate()
     }
 }
 
-void DecalSet::GetFaces(Vector<Vector<DecalVertex>>& faces, Drawable* target, unsigned batchIndex, const Frustum& frustum,
-    const Vector3& decalNormal, float normalCutoff)
+void DecalSet::GetFaces(Vector<Vector<DecalVertex>>& faces, Drawable* target, Geometry* geometry, unsigned batchIndex,
+    const Frustum& frustum, const Vector3& decalNormal, float normalCutoff, TriangleBVH* bvh)
 {
-    // Try to use the most accurate LOD level if possible
-    Geometry* geometry = target->GetLodGeometry(batchIndex, 0);
     if (!geometry || geometry->GetPrimitiveType() != TRIANGLE_LIST)
         return;
 
@@ -740,7 +971,20 @@ void DecalSet::GetFaces(Vector<Vector<DecalVertex>>& faces, Drawable* target, un
         }
     }
 
-    if (indexData)
+    // Test only the triangles in BVH leaves touching the decal frustum. The BVH is built from the same vertex indexing as the
+    // vertex buffer shadow data, and is cached in the geometry for all drawables sharing it
+    if (bvh)
+    {
+        Vector<u32> candidates;
+        bvh->GetTriangles(candidates, frustum);
+
+        for (unsigned i = 0; i + 2 < candidates.Size(); i += 3)
+        {
+            GetFace(faces, target, batchIndex, candidates[i], candidates[i + 1], candidates[i + 2], positionData, normalData,
+                skinningData, positionStride, normalStride, skinningStride, frustum, decalNormal, normalCutoff);
+        }
+    }
+    else if (indexData)
     {
         unsigned indexStart = geometry->GetIndexStart();
         unsigned indexCount = geometry->GetIndexCount();
@@ -821,12 +1065,8 @@ void DecalSet::GetFace(Vector<Vector<DecalVertex>>& faces, Drawable* target, uns
         return;
 
     // Check if face is culled completely by any of the planes
-    for (i32 i = PLANE_FAR; i >= 0; --i)
-    {
-        const Plane& plane = frustum.planes_[i];
-        if (plane.Distance(v0) < 0.0f && plane.Distance(v1) < 0.0f && plane.Distance(v2) < 0.0f)
-            return;
-    }
+    if (IsFaceOutside(frustum, v0, v1, v2))
+        return;
 
     faces.Resize(faces.Size() + 1);
     Vector<DecalVertex>& face = faces.Back();
@@ -969,14 +1209,26 @@ List<Decal>::Iterator DecalSet::RemoveDecal(List<Decal>::Iterator i)
     return decals_.Erase(i);
 }
 
+void DecalSet::UpdateDrawRange()
+{
+    // The buffers are resized to match in UpdateGeometry() before the next draw
+    geometry_->SetDrawRange(TRIANGLE_LIST, 0, numIndices_, 0, numVertices_, false);
+}
+
 void DecalSet::MarkDecalsDirty()
+{
+    UpdateDrawRange();
+    MarkBoundingBoxDirty();
+    bufferDirty_ = true;
+}
+
+void DecalSet::MarkBoundingBoxDirty()
 {
     if (!boundingBoxDirty_)
     {
         boundingBoxDirty_ = true;
         OnMarkedDirty(node_);
     }
-    bufferDirty_ = true;
 }
 
 void DecalSet::CalculateBoundingBox()
@@ -994,21 +1246,45 @@ void DecalSet::UpdateBuffers()
     unsigned newVBSize = optimizeBufferSize_ ? numVertices_ : maxVertices_;
     unsigned newIBSize = optimizeBufferSize_ ? numIndices_ : maxIndices_;
 
+    // If decals have only been added since the last update and the buffers keep their size, write just the new decals
+    bool append = !bufferDirty_ && numNewDecals_ && !vertexBuffer_->IsDataLost() && !indexBuffer_->IsDataLost() &&
+        vertexBuffer_->GetElementMask() == newElementMask && vertexBuffer_->GetVertexCount() == newVBSize &&
+        indexBuffer_->GetIndexCount() == newIBSize;
+
     if (vertexBuffer_->GetElementMask() != newElementMask || vertexBuffer_->GetVertexCount() != newVBSize)
         vertexBuffer_->SetSize(newVBSize, newElementMask);
     if (indexBuffer_->GetIndexCount() != newIBSize)
         indexBuffer_->SetSize(newIBSize, false);
     geometry_->SetVertexBuffer(0, vertexBuffer_);
-    geometry_->SetDrawRange(TRIANGLE_LIST, 0, numIndices_, 0, numVertices_);
 
-    float* vertices = numVertices_ ? (float*)vertexBuffer_->Lock(0, numVertices_) : nullptr;
-    unsigned short* indices = numIndices_ ? (unsigned short*)indexBuffer_->Lock(0, numIndices_) : nullptr;
+    List<Decal>::ConstIterator first = decals_.Begin();
+    unsigned vertexStart = 0;
+    unsigned indexStart = 0;
+
+    if (append)
+    {
+        first = decals_.End();
+        for (unsigned i = 0; i < numNewDecals_ && first != decals_.Begin(); ++i)
+            --first;
+        vertexStart = numVertices_;
+        indexStart = numIndices_;
+        for (List<Decal>::ConstIterator i = first; i != decals_.End(); ++i)
+        {
+            vertexStart -= i->vertices_.Size();
+            indexStart -= i->indices_.Size();
+        }
+    }
+
+    unsigned vertexCount = numVertices_ - vertexStart;
+    unsigned indexCount = numIndices_ - indexStart;
+    float* vertices = vertexCount ? (float*)vertexBuffer_->Lock(vertexStart, vertexCount) : nullptr;
+    unsigned short* indices = indexCount ? (unsigned short*)indexBuffer_->Lock(indexStart, indexCount) : nullptr;
 
     if (vertices && indices)
     {
-        unsigned short indexStart = 0;
+        auto indexOffset = (unsigned short)vertexStart;
 
-        for (List<Decal>::ConstIterator i = decals_.Begin(); i != decals_.End(); ++i)
+        for (List<Decal>::ConstIterator i = first; i != decals_.End(); ++i)
         {
             for (unsigned j = 0; j < i->vertices_.Size(); ++j)
             {
@@ -1036,9 +1312,9 @@ void DecalSet::UpdateBuffers()
             }
 
             for (unsigned j = 0; j < i->indices_.Size(); ++j)
-                *indices++ = i->indices_[j] + indexStart;
+                *indices++ = i->indices_[j] + indexOffset;
 
-            indexStart += i->vertices_.Size();
+            indexOffset += i->vertices_.Size();
         }
     }
 
@@ -1047,6 +1323,7 @@ void DecalSet::UpdateBuffers()
     indexBuffer_->Unlock();
     indexBuffer_->ClearDataLost();
     bufferDirty_ = false;
+    numNewDecals_ = 0;
 }
 
 void DecalSet::UpdateSkinning()
@@ -1136,6 +1413,27 @@ void DecalSet::UpdateEventSubscription(bool checkAllDecals)
     }
 }
 
+void DecalSet::HandleWorkItemCompleted(StringHash eventType, VariantMap& eventData)
+{
+    using namespace WorkItemCompleted;
+
+    auto* item = static_cast<WorkItem*>(eventData[P_ITEM].GetPtr());
+
+    for (unsigned i = 0; i < pendingTasks_.Size(); ++i)
+    {
+        if (pendingTasks_[i]->item_ == item)
+        {
+            SharedPtr<DecalTask> task = pendingTasks_[i];
+            pendingTasks_.Erase(i);
+            if (pendingTasks_.Empty())
+                UnsubscribeFromEvent(GetSubsystem<WorkQueue>(), E_WORKITEMCOMPLETED);
+
+            CommitDecal(task->decal_);
+            break;
+        }
+    }
+}
+
 void DecalSet::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
 {
     using namespace ScenePostUpdate;
@@ -13,6 +13,9 @@ namespace Urho3D
 
 class IndexBuffer;
 class VertexBuffer;
+struct DecalTask;
+class TriangleBVH;
+struct WorkItem;
 
 /// %Decal vertex.
 struct DecalVertex
@@ -85,6 +88,8 @@ class URHO3D_API DecalSet : public Drawable
 {
     URHO3D_OBJECT(DecalSet, Drawable);
 
+    friend void BuildDecalWork(const WorkItem* item, i32 threadIndex);
+
 public:
     /// Construct.
     explicit DecalSet(Context* context);
@@ -123,9 +128,13 @@ public:
     bool AddDecal(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size, float aspectRatio,
         float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive = 0.0f, float normalCutoff = 0.1f,
         unsigned subGeometry = M_MAX_UNSIGNED);
+    /// Add a decal like AddDecal, but gather and clip the target geometry in a worker thread. The decal is added on the main thread when the work completes, using the transforms at the time of this call. Skinned targets, or running without worker threads, fall back to AddDecal. Return true if the decal was queued or added successfully.
+    bool AddDecalAsync(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size, float aspectRatio,
+        float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive = 0.0f, float normalCutoff = 0.1f,
+        unsigned subGeometry = M_MAX_UNSIGNED);
     /// Remove n oldest decals.
     void RemoveDecals(unsigned num);
-    /// Remove all decals.
+    /// Remove all decals, including decals still being built asynchronously.
     void RemoveAllDecals();
 
     /// Return material.
@@ -136,6 +145,9 @@ public:
     /// @property
     unsigned GetNumDecals() const { return decals_.Size(); }
 
+    /// Return number of decals still being built asynchronously.
+    unsigned GetNumPendingDecals() const { return pendingTasks_.Size(); }
+
     /// Retur number of vertices in the decals.
     /// @property
     unsigned GetNumVertices() const { return numVertices_; }
@@ -172,9 +184,19 @@ protected:
     void OnMarkedDirty(Node* node) override;
 
 private:
+    /// Check the target and calculate the decal frustum, UV projection and target geometries. Return true if successful.
+    bool PrepareDecal(DecalTask& task, Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation,
+        float size, float aspectRatio, float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive,
+        float normalCutoff, unsigned subGeometry);
+    /// Gather, clip and triangulate the target faces into the task's decal. The target is only accessed for skinned decals. Safe to call from a worker thread for static decals.
+    void BuildDecal(DecalTask& task, Drawable* target);
+    /// Check limits and add a built decal. Return true if successful.
+    bool CommitDecal(Decal& decal);
+    /// Cancel decals being built asynchronously, waiting for any that have already started.
+    void CancelPendingDecals();
     /// Get triangle faces from the target geometry.
-    void GetFaces(Vector<Vector<DecalVertex>>& faces, Drawable* target, unsigned batchIndex, const Frustum& frustum,
-        const Vector3& decalNormal, float normalCutoff);
+    void GetFaces(Vector<Vector<DecalVertex>>& faces, Drawable* target, Geometry* geometry, unsigned batchIndex,
+        const Frustum& frustum, const Vector3& decalNormal, float normalCutoff, TriangleBVH* bvh);
     /// Get triangle face from the target geometry.
     void GetFace
         (Vector<Vector<DecalVertex>>& faces, Drawable* target, unsigned batchIndex, unsigned i0, unsigned i1, unsigned i2,
@@ -191,8 +213,12 @@ private:
     void TransformVertices(Decal& decal, const Matrix3x4& transform);
     /// Remove a decal by iterator and return iterator to the next decal.
     List<Decal>::Iterator RemoveDecal(List<Decal>::Iterator i);
-    /// Mark decals and the bounding box dirty.
+    /// Set the draw range to cover all decals. Called on the main thread whenever the vertex or index count changes.
+    void UpdateDrawRange();
+    /// Mark decals and the bounding box dirty. The vertex and index buffers will be fully rewritten.
     void MarkDecalsDirty();
+    /// Mark the bounding box dirty.
+    void MarkBoundingBoxDirty();
     /// Recalculate the local-space bounding box.
     void CalculateBoundingBox();
     /// Rewrite decal vertex and index buffers.
@@ -207,6 +233,8 @@ private:
     void UpdateEventSubscription(bool checkAllDecals);
     /// Handle scene post-update event.
     void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle work item completed event for asynchronously built decals.
+    void HandleWorkItemCompleted(StringHash eventType, VariantMap& eventData);
 
     /// Geometry.
     SharedPtr<Geometry> geometry_;
@@ -216,6 +244,8 @@ private:
     SharedPtr<IndexBuffer> indexBuffer_;
     /// Decals.
     List<Decal> decals_;
+    /// Decals being built in worker threads.
+    Vector<SharedPtr<DecalTask>> pendingTasks_;
     /// Bones used for skinned decals.
     Vector<Bone> bones_;
     /// Skinning matrices.
@@ -228,6 +258,8 @@ private:
     unsigned maxVertices_;
     /// Maximum indices.
     unsigned maxIndices_;
+    /// Decals added since the last buffer update, which can be appended without rewriting the whole buffers.
+    unsigned numNewDecals_;
     /// Optimize buffer sizes flag.
     bool optimizeBufferSize_;
     /// Skinned mode flag.
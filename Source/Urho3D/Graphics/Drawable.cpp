@@ -41,6 +41,7 @@ Drawable::Drawable(Context* context, DrawableTypes drawableType) :
     occluder_(false),
     occludee_(true),
     updateQueued_(false),
+    drawableChangeIndex_(NINDEX),
     zoneDirty_(false),
     octant_(nullptr),
     zone_(nullptr),
@@ -375,7 +376,12 @@ void Drawable::AddToOctree()
     {
         auto* octree = scene->GetComponent<Octree>();
         if (octree)
+        {
             octree->InsertDrawable(this);
+            octree->MarkDrawableChanged(this);
+            if (drawableType_ == DrawableTypes::Zone)
+                octree->MarkZoneIndexDirty();
+        }
         else
             URHO3D_LOGERROR("No Octree component in scene, drawable will not render");
     }
@@ -398,6 +404,7 @@ void Drawable::RemoveFromOctree()
         OnRemoveFromOctree();
 
         octant_->RemoveDrawable(this);
+        octree->MarkDrawableRemoved(this);
     }
 }
 
@@ -121,7 +121,7 @@ public:
     /// Prepare geometry for rendering.
     virtual void UpdateGeometry(const FrameInfo& frame) { }
 
-    /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
+    /// Return whether a geometry update is necessary, and if it can happen in a worker thread. Queried again after a worker thread update, so returning UPDATE_MAIN_THREAD at that point gets a second update call on the main thread, for example to upload data generated on the worker.
     virtual UpdateGeometryType GetUpdateGeometryType() { return UPDATE_NONE; }
 
     /// Return the geometry for a specific LOD level.
@@ -364,6 +364,8 @@ protected:
     bool occludee_;
     /// Octree update queued flag.
     bool updateQueued_;
+    /// Index in the octree's drawable changes since the last update, or NINDEX if not recorded.
+    i32 drawableChangeIndex_;
     /// Zone inconclusive or dirtied flag.
     bool zoneDirty_;
     /// Octree octant.
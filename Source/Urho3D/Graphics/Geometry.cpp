@@ -3,8 +3,11 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/Mutex.h"
+#include "../Core/Profiler.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
+#include "../Graphics/TriangleBVH.h"
 #include "../GraphicsAPI/IndexBuffer.h"
 #include "../GraphicsAPI/VertexBuffer.h"
 #include "../IO/Log.h"
@@ -15,6 +18,11 @@
 namespace Urho3D
 {
 
+/// Mutex for lazy triangle BVH construction, shared by all geometries as builds are rare.
+static Mutex triangleBVHMutex;
+/// Minimum number of triangles for raycasts to build and use the triangle BVH instead of testing every triangle.
+static const i32 MIN_BVH_RAYCAST_TRIANGLES = 64;
+
 Geometry::Geometry(Context* context) :
     Object(context),
     primitiveType_(TRIANGLE_LIST),
@@ -58,12 +66,14 @@ bool Geometry::SetVertexBuffer(i32 index, VertexBuffer* buffer)
     }
 
     vertexBuffers_[index] = buffer;
+    ResetTriangleBVH();
     return true;
 }
 
 void Geometry::SetIndexBuffer(IndexBuffer* buffer)
 {
     indexBuffer_ = buffer;
+    ResetTriangleBVH();
 }
 
 bool Geometry::SetDrawRange(PrimitiveType type, i32 indexStart, i32 indexCount, bool getUsedVertexRange/* = true*/)
@@ -102,6 +112,7 @@ bool Geometry::SetDrawRange(PrimitiveType type, i32 indexStart, i32 indexCount,
         vertexCount_ = 0;
     }
 
+    ResetTriangleBVH();
     return true;
 }
 
@@ -135,6 +146,7 @@ bool Geometry::SetDrawRange(PrimitiveType type, i32 indexStart, i32 indexCount,
     vertexStart_ = vertexStart;
     vertexCount_ = vertexCount;
 
+    ResetTriangleBVH();
     return true;
 }
 
@@ -151,6 +163,7 @@ void Geometry::SetRawVertexData(const SharedArrayPtr<byte>& data, const Vector<V
     rawVertexData_ = data;
     rawVertexSize_ = VertexBuffer::GetVertexSize(elements);
     rawElements_ = elements;
+    ResetTriangleBVH();
 }
 
 void Geometry::SetRawVertexData(const SharedArrayPtr<byte>& data, VertexElements elementMask)
@@ -158,6 +171,7 @@ void Geometry::SetRawVertexData(const SharedArrayPtr<byte>& data, VertexElements
     rawVertexData_ = data;
     rawVertexSize_ = VertexBuffer::GetVertexSize(elementMask);
     rawElements_ = VertexBuffer::GetElements(elementMask);
+    ResetTriangleBVH();
 }
 
 void Geometry::SetRawIndexData(const SharedArrayPtr<byte>& data, i32 indexSize)
@@ -165,6 +179,7 @@ void Geometry::SetRawIndexData(const SharedArrayPtr<byte>& data, i32 indexSize)
     assert(indexSize >= 0);
     rawIndexData_ = data;
     rawIndexSize_ = indexSize;
+    ResetTriangleBVH();
 }
 
 void Geometry::Draw(Graphics* graphics)
@@ -317,10 +332,95 @@ float Geometry::GetHitDistance(const Ray& ray, Vector3* outNormal, Vector2* outU
         outUV = nullptr;
     }
 
+    i32 numTriangles = (indexData ? indexCount_ : vertexCount_) / 3;
+    if (primitiveType_ == TRIANGLE_LIST && numTriangles >= MIN_BVH_RAYCAST_TRIANGLES)
+    {
+        TriangleBVH* bvh = GetTriangleBVH();
+        if (bvh)
+        {
+            i32 triangle;
+            float distance = bvh->GetHitDistance(ray, &triangle);
+            if (triangle == NINDEX)
+            {
+                if (outUV)
+                    *outUV = Vector2::ZERO;
+                return distance;
+            }
+
+            // Only the nearest triangle needs the normal and barycentric coordinates
+            if (outNormal || outUV)
+            {
+                const u32* indices = bvh->GetTriangleVertices(triangle);
+                const byte* vertices[3];
+                for (i32 i = 0; i < 3; ++i)
+                    vertices[i] = vertexData + indices[i] * vertexSize;
+
+                const Vector3& v0 = *reinterpret_cast<const Vector3*>(vertices[0]);
+                const Vector3& v1 = *reinterpret_cast<const Vector3*>(vertices[1]);
+                const Vector3& v2 = *reinterpret_cast<const Vector3*>(vertices[2]);
+                if (outNormal)
+                    *outNormal = (v1 - v0).CrossProduct(v2 - v0);
+
+                // Default to the first vertex in case rounding makes the scalar test miss a borderline hit
+                Vector3 barycentric(1.0f, 0.0f, 0.0f);
+                ray.HitDistance(v0, v1, v2, nullptr, &barycentric);
+
+                if (outUV)
+                {
+                    const Vector2& uv0 = *reinterpret_cast<const Vector2*>(vertices[0] + uvOffset);
+                    const Vector2& uv1 = *reinterpret_cast<const Vector2*>(vertices[1] + uvOffset);
+                    const Vector2& uv2 = *reinterpret_cast<const Vector2*>(vertices[2] + uvOffset);
+                    *outUV = uv0 * barycentric.x_ + uv1 * barycentric.y_ + uv2 * barycentric.z_;
+                }
+            }
+
+            return distance;
+        }
+    }
+
     return indexData ? ray.HitDistance(vertexData, vertexSize, indexData, indexSize, indexStart_, indexCount_, outNormal, outUV,
         uvOffset) : ray.HitDistance(vertexData, vertexSize, vertexStart_, vertexCount_, outNormal, outUV, uvOffset);
 }
 
+TriangleBVH* Geometry::GetTriangleBVH() const
+{
+    if (primitiveType_ != TRIANGLE_LIST)
+        return nullptr;
+
+    MutexLock lock(triangleBVHMutex);
+
+    if (!triangleBVH_)
+    {
+        const byte* vertexData;
+        const byte* indexData;
+        i32 vertexSize;
+        i32 indexSize;
+        const Vector<VertexElement>* elements;
+
+        GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+        if (!vertexData || !elements || VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION) != 0)
+            return nullptr;
+
+        URHO3D_PROFILE(BuildTriangleBVH);
+
+        SharedPtr<TriangleBVH> bvh(new TriangleBVH());
+        bool success = indexData ? bvh->Build(vertexData, vertexSize, indexData, indexSize, indexStart_, indexCount_) :
+            bvh->Build(vertexData, vertexSize, vertexStart_, vertexCount_);
+        if (!success)
+            return nullptr;
+
+        triangleBVH_ = bvh;
+    }
+
+    return triangleBVH_.Get();
+}
+
+void Geometry::ResetTriangleBVH()
+{
+    MutexLock lock(triangleBVHMutex);
+    triangleBVH_.Reset();
+}
+
 bool Geometry::IsInside(const Ray& ray) const
 {
     const byte* vertexData;
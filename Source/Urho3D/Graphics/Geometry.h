@@ -13,6 +13,7 @@ namespace Urho3D
 class IndexBuffer;
 class Ray;
 class Graphics;
+class TriangleBVH;
 class VertexBuffer;
 
 /// Defines one or more vertex buffers, an index buffer and a draw range.
@@ -101,12 +102,17 @@ public:
     float GetHitDistance(const Ray& ray, Vector3* outNormal = nullptr, Vector2* outUV = nullptr) const;
     /// Return whether or not the ray is inside geometry.
     bool IsInside(const Ray& ray) const;
+    /// Return triangle BVH built from the raw data, building it on first use. Return null if not a triangle list or no raw data. The BVH is owned by the geometry and released when the data changes; a worker thread may only use one that the main thread holds a reference to.
+    TriangleBVH* GetTriangleBVH() const;
 
     /// Return whether has empty draw range.
     /// @property
     bool IsEmpty() const { return indexCount_ == 0 && vertexCount_ == 0; }
 
 private:
+    /// Discard the triangle BVH after the geometry data changes.
+    void ResetTriangleBVH();
+
     /// Vertex buffers.
     Vector<SharedPtr<VertexBuffer>> vertexBuffers_;
     /// Index buffer.
@@ -133,6 +139,8 @@ private:
     i32 rawVertexSize_;
     /// Raw index data override size.
     i32 rawIndexSize_;
+    /// Lazily built triangle BVH. Reset whenever buffers, raw data or the draw range change.
+    mutable SharedPtr<TriangleBVH> triangleBVH_;
 };
 
 }
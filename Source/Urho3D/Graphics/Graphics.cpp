@@ -4,6 +4,8 @@
 #include "../Precompiled.h"
 
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Animation.h"
 #include "../Graphics/AnimationController.h"
@@ -338,6 +340,11 @@ void Graphics::Raise() const
     SDL_RaiseWindow(window_);
 }
 
+static void PrepareShaderWork(const WorkItem* item, i32/* threadIndex*/)
+{
+    static_cast<ShaderVariation*>(item->aux_)->Prepare();
+}
+
 void Graphics::BeginDumpShaders(const String& fileName)
 {
     shaderPrecache_ = new ShaderPrecache(context_, fileName);
@@ -355,6 +362,49 @@ void Graphics::PrecacheShaders(Deserializer& source)
     ShaderPrecache::LoadShaders(this, source);
 }
 
+void Graphics::PrepareShaders(const Vector<ShaderVariation*>& variations)
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue)
+        return;
+
+    URHO3D_PROFILE(PrepareShaders);
+
+    for (ShaderVariation* variation : variations)
+    {
+        if (!variation || variation->GetGPUObject())
+            continue;
+
+        HashMap<ShaderVariation*, SharedPtr<WorkItem>>::ConstIterator i = pendingShaders_.Find(variation);
+        if (i != pendingShaders_.End())
+        {
+            // Already queued by this call, or a background compilation that is now needed immediately
+            if (i->second_->priority_ == WI_MAX_PRIORITY)
+                continue;
+            CancelPendingShader(variation);
+        }
+
+        if (variation->IsPrepared() || !variation->GetCompilerOutput().Empty())
+            continue;
+
+        QueueShader(variation, WI_MAX_PRIORITY);
+    }
+
+    // Completing also purges the finished items, which releases them from the pending list
+    queue->Complete(WI_MAX_PRIORITY);
+}
+
+void Graphics::SetAsyncShaders(bool enable)
+{
+    if (enable == asyncShaders_)
+        return;
+
+    if (!enable)
+        CancelPendingShaders();
+
+    asyncShaders_ = enable;
+}
+
 void Graphics::SetShaderCacheDir(const String& path)
 {
     String trimmedPath = path.Trimmed();
@@ -578,6 +628,135 @@ void Graphics::OnScreenModeChanged()
     SendEvent(E_SCREENMODE, eventData);
 }
 
+bool Graphics::RequestShader(ShaderVariation* variation)
+{
+    if (!variation || variation->GetGPUObject())
+        return true;
+
+    // While queued, the variation may only be inspected through the prepared flag
+    if (pendingShaders_.Contains(variation))
+        return variation->IsPrepared();
+
+    // Prepared or failed variations are created, or reported, by the backend as usual
+    if (variation->IsPrepared() || !variation->GetCompilerOutput().Empty())
+        return true;
+
+    if (!GetSubsystem<WorkQueue>())
+        return true;
+
+    QueueShader(variation, 0);
+    return false;
+}
+
+/// Vertex shader defines that select how the geometry is read and transformed. Fallbacks keep them so that vertices are
+/// placed correctly, while the pixel shader outputs do not depend on them.
+static const char* geometryDefines[] =
+{
+    "SKINNED",
+    "INSTANCED",
+    "BILLBOARD",
+    "DIRBILLBOARD",
+    "TRAILFACECAM",
+    "TRAILBONE"
+};
+
+ShaderVariation* Graphics::GetFallbackShader(ShaderVariation* variation) const
+{
+    Shader* owner = variation ? variation->GetOwner() : nullptr;
+    if (!owner)
+        return nullptr;
+
+    String fallbackDefines;
+    if (variation->GetShaderType() == VS)
+    {
+        Vector<String> defines = variation->GetDefines().Split(' ');
+        for (const String& define : defines)
+        {
+            for (const char* geometryDefine : geometryDefines)
+            {
+                if (define == geometryDefine)
+                {
+                    if (!fallbackDefines.Empty())
+                        fallbackDefines += ' ';
+                    fallbackDefines += define;
+                    break;
+                }
+            }
+        }
+    }
+
+    // The fallback is compiled immediately when set, which is not possible while it is being prepared in the background.
+    // This is also the case when the requested variation has no other defines, so that it is its own fallback
+    ShaderVariation* fallback = owner->GetVariation(variation->GetShaderType(), fallbackDefines);
+    return pendingShaders_.Contains(fallback) ? nullptr : fallback;
+}
+
+void Graphics::QueueShader(ShaderVariation* variation, i32 priority)
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+
+    if (pendingShaders_.Empty())
+        SubscribeToEvent(queue, E_WORKITEMCOMPLETED, URHO3D_HANDLER(Graphics, HandleWorkItemCompleted));
+
+    SharedPtr<WorkItem> item = queue->GetFreeItem();
+    item->priority_ = priority;
+    item->sendEvent_ = true;
+    item->workFunction_ = PrepareShaderWork;
+    item->aux_ = variation;
+
+    // Keep the variation alive until the item has been purged, even if its shader is released meanwhile
+    variation->AddRef();
+    pendingShaders_[variation] = item;
+    queue->AddWorkItem(item);
+}
+
+void Graphics::CancelPendingShader(ShaderVariation* variation)
+{
+    HashMap<ShaderVariation*, SharedPtr<WorkItem>>::Iterator i = pendingShaders_.Find(variation);
+    if (i == pendingShaders_.End())
+        return;
+
+    // If the work item has already started, wait for it. Its completion event will find no pending entry
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (queue && !queue->RemoveWorkItem(i->second_))
+    {
+        while (!i->second_->completed_)
+            Time::Sleep(0);
+    }
+
+    pendingShaders_.Erase(i);
+    variation->ReleaseRef();
+
+    if (pendingShaders_.Empty() && queue)
+        UnsubscribeFromEvent(queue, E_WORKITEMCOMPLETED);
+}
+
+void Graphics::CancelPendingShaders()
+{
+    while (pendingShaders_.Size())
+        CancelPendingShader(pendingShaders_.Begin()->first_);
+}
+
+void Graphics::HandleWorkItemCompleted(StringHash eventType, VariantMap& eventData)
+{
+    using namespace WorkItemCompleted;
+
+    auto* item = static_cast<WorkItem*>(eventData[P_ITEM].GetPtr());
+    if (item->workFunction_ != PrepareShaderWork)
+        return;
+
+    auto* variation = static_cast<ShaderVariation*>(item->aux_);
+    HashMap<ShaderVariation*, SharedPtr<WorkItem>>::Iterator i = pendingShaders_.Find(variation);
+    if (i == pendingShaders_.End() || i->second_ != item)
+        return;
+
+    pendingShaders_.Erase(i);
+    variation->ReleaseRef();
+
+    if (pendingShaders_.Empty())
+        UnsubscribeFromEvent(GetSubsystem<WorkQueue>(), E_WORKITEMCOMPLETED);
+}
+
 Graphics::Graphics(Context* context, GAPI gapi)
     : Object(context)
 {
@@ -607,6 +786,8 @@ Graphics::Graphics(Context* context, GAPI gapi)
 
 Graphics::~Graphics()
 {
+    CancelPendingShaders();
+
     GAPI gapi = Graphics::GetGAPI();
 
 #ifdef URHO3D_OPENGL
@@ -1000,6 +1181,32 @@ void Graphics::SetIndexBuffer(IndexBuffer* buffer)
 
 void Graphics::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
 {
+    if (asyncShaders_)
+    {
+        bool vsReady = RequestShader(vs);
+        bool psReady = RequestShader(ps);
+
+        // Replace both shaders even if only one is missing, as the fallbacks are only guaranteed to be compatible with each
+        // other
+        if (!vsReady || !psReady)
+        {
+            ShaderVariation* vsFallback = GetFallbackShader(vs);
+            ShaderVariation* psFallback = GetFallbackShader(ps);
+            if ((vs && !vsFallback) || (ps && !psFallback))
+            {
+                // No fallback available, for example when the fallback variation is itself being compiled. Finish
+                // compiling the requested variations now instead
+                CancelPendingShader(vs);
+                CancelPendingShader(ps);
+            }
+            else
+            {
+                vs = vsFallback;
+                ps = psFallback;
+            }
+        }
+    }
+
     GAPI gapi = Graphics::GetGAPI();
 
 #ifdef URHO3D_OPENGL
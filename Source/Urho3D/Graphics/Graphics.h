@@ -57,6 +57,7 @@ class GraphicsImpl_D3D11;
 #endif
 
 struct ShaderParameter;
+struct WorkItem;
 
 #ifdef URHO3D_OPENGL
 // Note: ShaderProgram_OGL class is purposefully API-specific. It should not be used by Urho3D client applications.
@@ -330,6 +331,13 @@ public:
     void EndDumpShaders();
     /// Precache shader variations from an XML file generated with BeginDumpShaders().
     void PrecacheShaders(Deserializer& source);
+    /// Prepare shader variations for compilation on worker threads and wait until finished. The variations are created when first set.
+    void PrepareShaders(const Vector<ShaderVariation*>& variations);
+    /// Set whether to compile new shader variations on worker threads. Until a variation is ready, draws using it fall back to the shaders' variations without defines.
+    /// @property
+    void SetAsyncShaders(bool enable);
+    /// Stop compiling shader variations on worker threads, waiting for any that have already started. They are queued again when next set.
+    void CancelPendingShaders();
     /// Set shader cache directory, Direct3D only. This can either be an absolute path or a path within the resource system.
     /// @property
     void SetShaderCacheDir(const String& path);
@@ -653,6 +661,13 @@ public:
     /// @property
     const String& GetShaderCacheDir() const { return shaderCacheDir_; }
 
+    /// Return whether new shader variations are compiled on worker threads.
+    /// @property
+    bool GetAsyncShaders() const { return asyncShaders_; }
+
+    /// Return number of shader variations being compiled on worker threads.
+    i32 GetNumPendingShaders() const { return pendingShaders_.Size(); }
+
     /// Return current rendertarget width and height.
     IntVector2 GetRenderTargetDimensions() const;
 
@@ -766,6 +781,17 @@ private:
     /// Called when screen mode is successfully changed by the backend.
     void OnScreenModeChanged();
 
+    /// Return whether a shader variation is ready to be set. Queue it for background compilation if not.
+    bool RequestShader(ShaderVariation* variation);
+    /// Return the variation to use while a shader variation is being compiled, or null if not available. Vertex shader fallbacks keep the geometry type defines.
+    ShaderVariation* GetFallbackShader(ShaderVariation* variation) const;
+    /// Queue a shader variation to be prepared on a worker thread.
+    void QueueShader(ShaderVariation* variation, i32 priority);
+    /// Remove a shader variation from background compilation, waiting for it if it has already started.
+    void CancelPendingShader(ShaderVariation* variation);
+    /// Handle a finished background shader compilation.
+    void HandleWorkItemCompleted(StringHash eventType, VariantMap& eventData);
+
 #ifdef URHO3D_D3D11
     /// Create the application window.
     bool OpenWindow_D3D11(int width, int height, bool resizable, bool borderless);
@@ -1247,6 +1273,10 @@ private:
     mutable String lastShaderName_;
     /// Shader precache utility.
     SharedPtr<ShaderPrecache> shaderPrecache_;
+    /// Shader variations being prepared on worker threads. Each holds a reference to the variation until finished.
+    HashMap<ShaderVariation*, SharedPtr<WorkItem>> pendingShaders_;
+    /// Asynchronous shader compilation flag.
+    bool asyncShaders_{};
 #ifdef URHO3D_VULKAN
     /// Vulkan profiler utility.
     SharedPtr<VulkanProfiler> vulkanProfiler_;
@@ -3,12 +3,14 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Sort.h"
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Light.h"
+#include "../Graphics/Octree.h"
 #include "../Graphics/OctreeQuery.h"
 #include "../GraphicsAPI/Texture2D.h"
 #include "../GraphicsAPI/TextureCube.h"
@@ -619,6 +621,76 @@ void Light::SetIntensitySortValue(const BoundingBox& box)
     }
 }
 
+void Light::OnRemoveFromOctree()
+{
+    // Cached drawables may be destroyed while the light is outside the octree
+    volumeCache_.Reset();
+}
+
+const Vector<Drawable*>& Light::GetVolumeDrawables(Octree* octree)
+{
+    LightVolumeCache& cache = volumeCache_;
+    LightType type = lightType_;
+    Vector3 position = node_->GetWorldPosition();
+    Quaternion rotation = node_->GetWorldRotation();
+    Sphere sphere(position, range_);
+    Frustum frustum;
+    if (type == LIGHT_SPOT)
+        frustum = GetFrustum();
+
+    // The cache stays valid if the light is unchanged and no drawable has entered or left its volume. Changes from
+    // the last octree update only need to be checked if the cache was validated on the previous frame; if older,
+    // requery. Only one view processes the light at a time, so the cache can be modified from a worker thread
+    u32 epoch = octree->GetChangeEpoch();
+    bool valid = cache.octree_ == octree && cache.lightType_ == type && cache.position_ == position &&
+        cache.range_ == range_ && (type != LIGHT_SPOT || (cache.rotation_ == rotation &&
+        cache.fov_ == fov_ && cache.aspectRatio_ == aspectRatio_));
+
+    if (valid && cache.epoch_ != epoch)
+    {
+        if (cache.epoch_ != octree->GetPreviousChangeEpoch())
+            valid = false;
+        else if (type == LIGHT_SPOT)
+            valid = !octree->CheckDrawableChanges(frustum, cache.drawables_, false);
+        else
+            valid = !octree->CheckDrawableChanges(sphere, cache.drawables_, false);
+    }
+    // Drawables removed or moved after the octree update, for example by another view's events, are checked each time
+    if (valid)
+    {
+        if (type == LIGHT_SPOT)
+            valid = !octree->CheckDrawableChanges(frustum, cache.drawables_, true);
+        else
+            valid = !octree->CheckDrawableChanges(sphere, cache.drawables_, true);
+    }
+
+    if (!valid)
+    {
+        if (type == LIGHT_SPOT)
+        {
+            FrustumOctreeQuery octreeQuery(cache.drawables_, frustum, DrawableTypes::Geometry);
+            octree->GetDrawables(octreeQuery);
+        }
+        else
+        {
+            SphereOctreeQuery octreeQuery(cache.drawables_, sphere, DrawableTypes::Geometry);
+            octree->GetDrawables(octreeQuery);
+        }
+        Sort(cache.drawables_.Begin(), cache.drawables_.End());
+
+        cache.octree_ = octree;
+        cache.lightType_ = type;
+        cache.position_ = position;
+        cache.rotation_ = rotation;
+        cache.range_ = range_;
+        cache.fov_ = fov_;
+        cache.aspectRatio_ = aspectRatio_;
+    }
+
+    cache.epoch_ = epoch;
+    return cache.drawables_;
+}
+
 void Light::SetLightQueue(LightBatchQueue* queue)
 {
     lightQueue_ = queue;
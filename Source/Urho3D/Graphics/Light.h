@@ -14,6 +14,7 @@ namespace Urho3D
 {
 
 class Camera;
+class Octree;
 struct LightBatchQueue;
 
 /// %Light types.
@@ -129,6 +130,38 @@ struct URHO3D_API FocusParameters
     float minView_;
 };
 
+/// Geometry drawables inside a spot or point light's volume, kept across frames until the light or the drawables around it change. Updated by Light::GetVolumeDrawables().
+struct LightVolumeCache
+{
+    /// Invalidate and release the drawables.
+    void Reset()
+    {
+        octree_ = nullptr;
+        epoch_ = 0;
+        drawables_.Clear();
+        drawables_.Compact();
+    }
+
+    /// Octree the drawables were queried from.
+    Octree* octree_{};
+    /// Octree change epoch up to which the drawables are known to be valid.
+    u32 epoch_{};
+    /// Light type at the time of the query.
+    LightType lightType_{};
+    /// Light world position at the time of the query.
+    Vector3 position_;
+    /// Light world rotation at the time of the query.
+    Quaternion rotation_;
+    /// Light range at the time of the query.
+    float range_{};
+    /// Spotlight field of view at the time of the query.
+    float fov_{};
+    /// Spotlight aspect ratio at the time of the query.
+    float aspectRatio_{};
+    /// Geometry drawables of any view mask inside the light volume, sorted by address.
+    Vector<Drawable*> drawables_;
+};
+
 /// %Light component.
 class URHO3D_API Light : public Drawable
 {
@@ -349,6 +382,9 @@ public:
 
     /// Return light queue. Called by View.
     LightBatchQueue* GetLightQueue() const { return lightQueue_; }
+    /// Return geometry drawables inside a spot or point light's volume, using the volume cache when still valid. Filtering by view mask is left to the caller. Called by View.
+    /// @nobind
+    const Vector<Drawable*>& GetVolumeDrawables(Octree* octree);
 
     /// Return a divisor value based on intensity for calculating the sort value.
     float GetIntensityDivisor(float attenuation = 1.0f) const
@@ -371,6 +407,8 @@ public:
 protected:
     /// Recalculate the world-space bounding box.
     void OnWorldBoundingBoxUpdate() override;
+    /// Handle removal from octree.
+    void OnRemoveFromOctree() override;
 
 private:
     /// Validate shadow focus.
@@ -403,6 +441,8 @@ private:
     SharedPtr<Texture> shapeTexture_;
     /// Light queue.
     LightBatchQueue* lightQueue_;
+    /// Light volume query cache.
+    LightVolumeCache volumeCache_;
     /// Specular intensity.
     float specularIntensity_;
     /// Brightness multiplier.
@@ -14,8 +14,10 @@
 #include "../GraphicsAPI/Texture2DArray.h"
 #include "../GraphicsAPI/Texture3D.h"
 #include "../GraphicsAPI/TextureCube.h"
+#include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/VectorBuffer.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
@@ -138,6 +140,24 @@ StringHash ParseTextureTypeXml(ResourceCache* cache, const String& filename)
 
 static TechniqueEntry noEntry;
 
+/// Compiled binary material format version. Increment when the layout changes to invalidate cached files.
+static const u32 MATERIAL_BINARY_VERSION = 1;
+
+/// Return the type of a texture defined by an XML file, which may be a cube map, a volume texture or an array.
+static StringHash GetTextureTypeXml(ResourceCache* cache, TextureUnit unit, const String& name)
+{
+#ifdef DESKTOP_GRAPHICS
+    StringHash type = ParseTextureTypeXml(cache, name);
+    if (!type && unit == TU_VOLUMEMAP)
+        type = Texture3D::GetTypeStatic();
+
+    if (type == Texture3D::GetTypeStatic() || type == Texture2DArray::GetTypeStatic())
+        return type;
+#endif
+
+    return TextureCube::GetTypeStatic();
+}
+
 bool CompareTechniqueEntries(const TechniqueEntry& lhs, const TechniqueEntry& rhs)
 {
     if (lhs.lodDistance_ != rhs.lodDistance_)
@@ -196,6 +216,24 @@ bool Material::BeginLoad(Deserializer& source)
     if (!graphics)
         return true;
 
+    saveCacheFileName_.Clear();
+
+    // Compiled binary materials need no parsing
+    i64 start = source.GetPosition();
+    String fileID = source.ReadFileID();
+    source.Seek(start);
+    if (fileID == "UMAT")
+        return BeginLoadBinary(source);
+
+    String cacheFileName = GetSubsystem<ResourceCache>()->GetCompiledCacheFileName(GetName(), ".umat");
+    if (!cacheFileName.Empty())
+        return BeginLoadCached(source, cacheFileName);
+
+    return BeginLoadText(source);
+}
+
+bool Material::BeginLoadText(Deserializer& source)
+{
     String extension = GetExtension(source.GetName());
 
     bool success = false;
@@ -245,11 +283,112 @@ bool Material::EndLoad()
         success = Load(rootVal);
     }
 
+    if (!loadBinaryData_.Empty())
+    {
+        MemoryBuffer buffer(loadBinaryData_);
+        success = LoadBinary(buffer);
+    }
+
+    // Write the compiled cache now that technique and texture references have been resolved
+    if (success && !saveCacheFileName_.Empty())
+    {
+        File cacheFile(context_);
+        if (cacheFile.Open(saveCacheFileName_, FILE_WRITE))
+            SaveBinary(cacheFile, sourceHash_, sourceSize_);
+    }
+
     loadXMLFile_.Reset();
     loadJSONFile_.Reset();
+    loadBinaryData_.Clear();
+    saveCacheFileName_.Clear();
     return success;
 }
 
+bool Material::BeginLoadCached(Deserializer& source, const String& cacheFileName)
+{
+    Vector<byte> sourceData((i32)source.GetSize());
+    if (!sourceData.Empty())
+        source.Read(sourceData.Buffer(), sourceData.Size());
+    hash32 sourceHash = StringHash::CalculateData(sourceData.Buffer(), sourceData.Size());
+
+    if (GetSubsystem<FileSystem>()->FileExists(cacheFileName))
+    {
+        File cacheFile(context_, cacheFileName);
+        if (cacheFile.ReadFileID() == "UMAT" && cacheFile.ReadU32() == MATERIAL_BINARY_VERSION &&
+            cacheFile.ReadString() == GetName() && cacheFile.ReadI32() == sourceData.Size() && cacheFile.ReadU32() == sourceHash)
+        {
+            cacheFile.Seek(0);
+            if (BeginLoadBinary(cacheFile))
+                return true;
+        }
+    }
+
+    // Missing or stale cache, load the source instead
+    MemoryBuffer sourceBuffer(sourceData);
+    sourceBuffer.SetName(source.GetName());
+    if (!BeginLoadText(sourceBuffer))
+        return false;
+
+    saveCacheFileName_ = cacheFileName;
+    sourceHash_ = sourceHash;
+    sourceSize_ = sourceData.Size();
+    return true;
+}
+
+bool Material::BeginLoadBinary(Deserializer& source)
+{
+    ResetToDefaults();
+    loadXMLFile_.Reset();
+    loadJSONFile_.Reset();
+
+    loadBinaryData_.Resize((i32)(source.GetSize() - source.GetPosition()));
+    if (!loadBinaryData_.Empty())
+        source.Read(loadBinaryData_.Buffer(), loadBinaryData_.Size());
+
+    MemoryBuffer buffer(loadBinaryData_);
+    if (buffer.ReadFileID() != "UMAT" || buffer.ReadU32() != MATERIAL_BINARY_VERSION)
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid compiled material file");
+        loadBinaryData_.Clear();
+        return false;
+    }
+
+    // If async loading, request the techniques & textures to also be loaded. Their names come first in the data
+    if (GetAsyncLoadState() == ASYNC_LOADING)
+    {
+        auto* cache = GetSubsystem<ResourceCache>();
+
+        // Skip source info and shader defines
+        buffer.ReadString();
+        buffer.ReadI32();
+        buffer.ReadU32();
+        buffer.ReadString();
+        buffer.ReadString();
+
+        unsigned numTechniques = buffer.ReadVLE();
+        for (unsigned i = 0; i < numTechniques; ++i)
+        {
+            cache->BackgroundLoadResource<Technique>(buffer.ReadString(), true, this);
+            buffer.ReadU8();
+            buffer.ReadFloat();
+        }
+
+        unsigned numTextures = buffer.ReadVLE();
+        for (unsigned i = 0; i < numTextures; ++i)
+        {
+            auto unit = (TextureUnit)buffer.ReadU8();
+            StringHash type = buffer.ReadStringHash();
+            String name = buffer.ReadString();
+            // The definition file may have changed type since compiling
+            if (GetExtension(name) == ".xml")
+                type = GetTextureTypeXml(cache, unit, name);
+            cache->BackgroundLoadResource(type, name, true, this);
+        }
+    }
+
+    return true;
+}
+
 bool Material::BeginLoadXML(Deserializer& source)
 {
     ResetToDefaults();
@@ -890,6 +1029,198 @@ bool Material::Save(JSONValue& dest) const
     return true;
 }
 
+bool Material::LoadBinary(Deserializer& source)
+{
+    ResetToDefaults();
+
+    if (source.ReadFileID() != "UMAT")
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid compiled material file");
+        return false;
+    }
+
+    u32 version = source.ReadU32();
+    if (version != MATERIAL_BINARY_VERSION)
+    {
+        URHO3D_LOGERROR("Unsupported compiled material version " + String(version) + " in " + source.GetName());
+        return false;
+    }
+
+    // Source name, size and hash are only needed for validating the compiled cache
+    source.ReadString();
+    source.ReadI32();
+    source.ReadU32();
+
+    auto* cache = GetSubsystem<ResourceCache>();
+
+    vertexShaderDefines_ = source.ReadString();
+    pixelShaderDefines_ = source.ReadString();
+
+    techniques_.Clear();
+    unsigned numTechniques = source.ReadVLE();
+    for (unsigned i = 0; i < numTechniques; ++i)
+    {
+        String name = source.ReadString();
+        auto qualityLevel = (MaterialQuality)source.ReadU8();
+        float lodDistance = source.ReadFloat();
+        auto* tech = cache->GetResource<Technique>(name);
+        if (tech)
+            techniques_.Push(TechniqueEntry(tech, qualityLevel, lodDistance));
+    }
+
+    SortTechniques();
+    ApplyShaderDefines();
+
+    unsigned numTextures = source.ReadVLE();
+    for (unsigned i = 0; i < numTextures; ++i)
+    {
+        auto unit = (TextureUnit)source.ReadU8();
+        StringHash type = source.ReadStringHash();
+        String name = source.ReadString();
+        // Only textures defined by an XML file can change type without the material source changing, so look up
+        // just those again instead of trusting the stored type
+        if (GetExtension(name) == ".xml")
+            type = GetTextureTypeXml(cache, unit, name);
+        if (unit < MAX_TEXTURE_UNITS)
+            SetTexture(unit, dynamic_cast<Texture*>(cache->GetResource(type, name)));
+    }
+
+    // Parameter values are stored already parsed
+    batchedParameterUpdate_ = true;
+    unsigned numParameters = source.ReadVLE();
+    for (unsigned i = 0; i < numParameters; ++i)
+    {
+        String name = source.ReadString();
+        SetShaderParameter(name, source.ReadVariant());
+    }
+    batchedParameterUpdate_ = false;
+
+    unsigned numAnimations = source.ReadVLE();
+    for (unsigned i = 0; i < numAnimations; ++i)
+    {
+        String name = source.ReadString();
+        String animationXML = source.ReadString();
+        auto wrapMode = (WrapMode)source.ReadU8();
+        float speed = source.ReadFloat();
+
+        SharedPtr<XMLFile> xml(new XMLFile(context_));
+        SharedPtr<ValueAnimation> animation(new ValueAnimation(context_));
+        if (!xml->FromString(animationXML) || !animation->LoadXML(xml->GetRoot()))
+        {
+            URHO3D_LOGERROR("Could not load parameter animation");
+            return false;
+        }
+
+        SetShaderParameterAnimation(name, animation, wrapMode, speed);
+    }
+
+    SetCullMode((CullMode)source.ReadU8());
+    SetShadowCullMode((CullMode)source.ReadU8());
+    SetFillMode((FillMode)source.ReadU8());
+    float constantBias = source.ReadFloat();
+    float slopeScaledBias = source.ReadFloat();
+    SetDepthBias(BiasParameters(constantBias, slopeScaledBias));
+    SetAlphaToCoverage(source.ReadBool());
+    SetLineAntiAlias(source.ReadBool());
+    SetRenderOrder(source.ReadI8());
+    SetOcclusion(source.ReadBool());
+
+    RefreshShaderParameterHash();
+    RefreshMemoryUse();
+    return true;
+}
+
+bool Material::SaveBinary(Serializer& dest, hash32 sourceHash, i32 sourceSize) const
+{
+    if (!dest.WriteFileID("UMAT"))
+    {
+        URHO3D_LOGERROR("Can not save compiled material");
+        return false;
+    }
+
+    dest.WriteU32(MATERIAL_BINARY_VERSION);
+    dest.WriteString(GetName());
+    dest.WriteI32(sourceSize);
+    dest.WriteU32(sourceHash);
+
+    dest.WriteString(vertexShaderDefines_);
+    dest.WriteString(pixelShaderDefines_);
+
+    // Write techniques
+    unsigned numTechniques = 0;
+    for (const TechniqueEntry& entry : techniques_)
+    {
+        if (entry.technique_)
+            ++numTechniques;
+    }
+
+    dest.WriteVLE(numTechniques);
+    for (const TechniqueEntry& entry : techniques_)
+    {
+        if (!entry.technique_)
+            continue;
+
+        dest.WriteString(entry.technique_->GetName());
+        dest.WriteU8((u8)entry.qualityLevel_);
+        dest.WriteFloat(entry.lodDistance_);
+    }
+
+    // Write textures with their resolved types, so that loading needs no texture definition file lookups except for
+    // the textures defined by XML files
+    unsigned numTextures = 0;
+    for (HashMap<TextureUnit, SharedPtr<Texture>>::ConstIterator i = textures_.Begin(); i != textures_.End(); ++i)
+    {
+        if (i->second_)
+            ++numTextures;
+    }
+
+    dest.WriteVLE(numTextures);
+    for (HashMap<TextureUnit, SharedPtr<Texture>>::ConstIterator i = textures_.Begin(); i != textures_.End(); ++i)
+    {
+        if (!i->second_)
+            continue;
+
+        dest.WriteU8((u8)i->first_);
+        dest.WriteStringHash(i->second_->GetType());
+        dest.WriteString(i->second_->GetName());
+    }
+
+    // Write shader parameters
+    dest.WriteVLE(shaderParameters_.Size());
+    for (HashMap<StringHash, MaterialShaderParameter>::ConstIterator i = shaderParameters_.Begin(); i != shaderParameters_.End(); ++i)
+    {
+        dest.WriteString(i->second_.name_);
+        dest.WriteVariant(i->second_.value_);
+    }
+
+    // Write shader parameter animations as XML, as they are rare and have no binary format of their own
+    dest.WriteVLE(shaderParameterAnimationInfos_.Size());
+    for (HashMap<StringHash, SharedPtr<ShaderParameterAnimationInfo>>::ConstIterator i = shaderParameterAnimationInfos_.Begin();
+         i != shaderParameterAnimationInfos_.End(); ++i)
+    {
+        ShaderParameterAnimationInfo* info = i->second_;
+        SharedPtr<XMLFile> xml(new XMLFile(context_));
+        XMLElement animationElem = xml->CreateRoot("parameteranimation");
+        if (!info->GetAnimation()->SaveXML(animationElem))
+            return false;
+
+        dest.WriteString(info->GetName());
+        dest.WriteString(xml->ToString(String::EMPTY));
+        dest.WriteU8((u8)info->GetWrapMode());
+        dest.WriteFloat(info->GetSpeed());
+    }
+
+    dest.WriteU8((u8)cullMode_);
+    dest.WriteU8((u8)shadowCullMode_);
+    dest.WriteU8((u8)fillMode_);
+    dest.WriteFloat(depthBias_.constantBias_);
+    dest.WriteFloat(depthBias_.slopeScaledBias_);
+    dest.WriteBool(alphaToCoverage_);
+    dest.WriteBool(lineAntiAlias_);
+    dest.WriteI8(renderOrder_);
+    return dest.WriteBool(occlusion_);
+}
+
 void Material::SetNumTechniques(i32 num)
 {
     assert(num >= 0);
@@ -116,6 +116,11 @@ public:
     /// Save to a JSON value. Return true if successful.
     bool Save(JSONValue& dest) const;
 
+    /// Load from compiled binary data. Technique and texture references are loaded from the resource cache. Return true if successful.
+    bool LoadBinary(Deserializer& source);
+    /// Save to compiled binary data with resolved parameter values and texture types. The source hash is used by the compiled resource cache to detect changes. Return true if successful.
+    bool SaveBinary(Serializer& dest, hash32 sourceHash = 0, i32 sourceSize = 0) const;
+
     /// Set number of techniques.
     /// @property
     void SetNumTechniques(i32 num);
@@ -278,6 +283,12 @@ private:
     bool BeginLoadJSON(Deserializer& source);
     /// Helper function for loading XML files.
     bool BeginLoadXML(Deserializer& source);
+    /// Helper function for loading XML or JSON files.
+    bool BeginLoadText(Deserializer& source);
+    /// Helper function for loading compiled binary files.
+    bool BeginLoadBinary(Deserializer& source);
+    /// Load from the compiled resource cache if it matches the source. Otherwise load the source and remember to write the cache in EndLoad().
+    bool BeginLoadCached(Deserializer& source, const String& cacheFileName);
 
     /// Reset to defaults.
     void ResetToDefaults();
@@ -336,6 +347,14 @@ private:
     SharedPtr<XMLFile> loadXMLFile_;
     /// JSON file used while loading.
     SharedPtr<JSONFile> loadJSONFile_;
+    /// Compiled binary data used while loading.
+    Vector<byte> loadBinaryData_;
+    /// Compiled cache file to write after loading from XML or JSON, empty if none.
+    String saveCacheFileName_;
+    /// Hash of the source data for the compiled cache.
+    hash32 sourceHash_{};
+    /// Size of the source data for the compiled cache.
+    i32 sourceSize_{};
     /// Associated scene for shader parameter animation updates.
     WeakPtr<Scene> scene_;
 };
@@ -14,6 +14,8 @@
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/VectorBuffer.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
 
@@ -42,6 +44,57 @@ unsigned LookupIndexBuffer(IndexBuffer* buffer, const Vector<SharedPtr<IndexBuff
     return 0;
 }
 
+/// Packed model format version.
+static const u32 PACKED_MODEL_VERSION = 1;
+/// Alignment of the packed data block and of each stream inside it.
+static const i32 PACKED_MODEL_ALIGNMENT = 16;
+
+static VertexElement DecodeVertexElement(unsigned elementDesc)
+{
+    auto type = (VertexElementType)(elementDesc & 0xffu);
+    auto semantic = (VertexElementSemantic)((elementDesc >> 8u) & 0xffu);
+    auto index = (unsigned char)((elementDesc >> 16u) & 0xffu);
+    return VertexElement(type, semantic, index);
+}
+
+static unsigned EncodeVertexElement(const VertexElement& element)
+{
+    return ((unsigned)element.type_) | (((unsigned)element.semantic_) << 8u) | (((unsigned)element.index_) << 16u);
+}
+
+static unsigned GetMorphVertexSize(VertexElements elementMask)
+{
+    // Base size: size of each vertex index
+    unsigned vertexSize = sizeof(unsigned);
+    // Add size of individual elements
+    if (!!(elementMask & VertexElements::Position))
+        vertexSize += sizeof(Vector3);
+    if (!!(elementMask & VertexElements::Normal))
+        vertexSize += sizeof(Vector3);
+    if (!!(elementMask & VertexElements::Tangent))
+        vertexSize += sizeof(Vector3);
+    return vertexSize;
+}
+
+static i32 AlignPackedOffset(i64 offset)
+{
+    return (i32)((offset + PACKED_MODEL_ALIGNMENT - 1) & ~(i64)(PACKED_MODEL_ALIGNMENT - 1));
+}
+
+/// Return whether a stream lies inside a packed data block.
+static bool IsPackedRangeValid(u32 offset, u64 size, u32 dataSize)
+{
+    return offset <= dataSize && size <= dataSize - offset;
+}
+
+/// Reserve space for a stream in the packed data block and return its offset.
+static i32 AllocatePackedData(i32& dataSize, i32 size)
+{
+    i32 offset = dataSize;
+    dataSize = AlignPackedOffset(dataSize + size);
+    return offset;
+}
+
 Model::Model(Context* context) :
     ResourceWithMetadata(context)
 {
@@ -58,7 +111,7 @@ bool Model::BeginLoad(Deserializer& source)
 {
     // Check ID
     String fileID = source.ReadFileID();
-    if (fileID != "UMDL" && fileID != "UMD2")
+    if (fileID != "UMDL" && fileID != "UMD2" && fileID != "UMDP")
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid model file");
         return false;
@@ -72,6 +125,11 @@ bool Model::BeginLoad(Deserializer& source)
     morphs_.Clear();
     vertexBuffers_.Clear();
     indexBuffers_.Clear();
+    loadPackedData_.Reset();
+    loadPackedDataSize_ = 0;
+
+    if (fileID == "UMDP")
+        return BeginLoadPacked(source);
 
     unsigned memoryUse = sizeof(Model);
     bool async = GetAsyncLoadState() == ASYNC_LOADING;
@@ -97,13 +155,7 @@ bool Model::BeginLoad(Deserializer& source)
             desc.vertexElements_.Clear();
             unsigned numElements = source.ReadU32();
             for (unsigned j = 0; j < numElements; ++j)
-            {
-                unsigned elementDesc = source.ReadU32();
-                auto type = (VertexElementType)(elementDesc & 0xffu);
-                auto semantic = (VertexElementSemantic)((elementDesc >> 8u) & 0xffu);
-                auto index = (unsigned char)((elementDesc >> 16u) & 0xffu);
-                desc.vertexElements_.Push(VertexElement(type, semantic, index));
-            }
+                desc.vertexElements_.Push(DecodeVertexElement(source.ReadU32()));
         }
 
         morphRangeStarts_[i] = source.ReadU32();
@@ -170,6 +222,304 @@ bool Model::BeginLoad(Deserializer& source)
     }
 
     // Read geometries
+    if (!LoadGeometries(source, memoryUse))
+        return false;
+
+    // Read morphs
+    unsigned numMorphs = source.ReadU32();
+    morphs_.Reserve(numMorphs);
+    for (unsigned i = 0; i < numMorphs; ++i)
+    {
+        ModelMorph newMorph;
+
+        newMorph.name_ = source.ReadString();
+        newMorph.nameHash_ = newMorph.name_;
+        newMorph.weight_ = 0.0f;
+        unsigned numBuffers = source.ReadU32();
+
+        for (unsigned j = 0; j < numBuffers; ++j)
+        {
+            VertexBufferMorph newBuffer;
+            unsigned bufferIndex = source.ReadU32();
+
+            newBuffer.elementMask_ = VertexElements{source.ReadU32()};
+            newBuffer.vertexCount_ = source.ReadU32();
+
+            unsigned vertexSize = GetMorphVertexSize(newBuffer.elementMask_);
+            newBuffer.dataSize_ = newBuffer.vertexCount_ * vertexSize;
+            newBuffer.morphData_ = new byte[newBuffer.dataSize_];
+
+            source.Read(&newBuffer.morphData_[0], newBuffer.vertexCount_ * vertexSize);
+
+            newMorph.buffers_[bufferIndex] = newBuffer;
+            memoryUse += sizeof(VertexBufferMorph) + newBuffer.vertexCount_ * vertexSize;
+        }
+
+        morphs_.Push(newMorph);
+        memoryUse += sizeof(ModelMorph);
+    }
+
+    FinishBeginLoad(source, memoryUse);
+    return true;
+}
+
+bool Model::EndLoad()
+{
+    // Upload vertex buffer data
+    for (unsigned i = 0; i < vertexBuffers_.Size(); ++i)
+    {
+        VertexBuffer* buffer = vertexBuffers_[i];
+        VertexBufferDesc& desc = loadVBData_[i];
+        // Packed models keep all buffers in one block, uploaded straight from it
+        const byte* data = desc.data_ ? desc.data_.Get() : loadPackedData_ ? loadPackedData_.Get() + desc.dataOffset_ : nullptr;
+        if (data)
+        {
+            buffer->SetShadowed(true);
+            buffer->SetSize(desc.vertexCount_, desc.vertexElements_);
+            buffer->SetData(data);
+        }
+    }
+
+    // Upload index buffer data
+    for (unsigned i = 0; i < indexBuffers_.Size(); ++i)
+    {
+        IndexBuffer* buffer = indexBuffers_[i];
+        IndexBufferDesc& desc = loadIBData_[i];
+        const byte* data = desc.data_ ? desc.data_.Get() : loadPackedData_ ? loadPackedData_.Get() + desc.dataOffset_ : nullptr;
+        if (data)
+        {
+            buffer->SetShadowed(true);
+            buffer->SetSize(desc.indexCount_, desc.indexSize_ > sizeof(unsigned short));
+            buffer->SetData(data);
+        }
+    }
+
+    // Set up geometries
+    for (unsigned i = 0; i < geometries_.Size(); ++i)
+    {
+        for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+        {
+            Geometry* geometry = geometries_[i][j];
+            GeometryDesc& desc = loadGeometries_[i][j];
+            geometry->SetVertexBuffer(0, vertexBuffers_[desc.vbRef_]);
+            geometry->SetIndexBuffer(indexBuffers_[desc.ibRef_]);
+            geometry->SetDrawRange(desc.type_, desc.indexStart_, desc.indexCount_);
+        }
+    }
+
+    loadVBData_.Clear();
+    loadIBData_.Clear();
+    loadGeometries_.Clear();
+    loadPackedData_.Reset();
+    loadPackedDataSize_ = 0;
+    return true;
+}
+
+bool Model::BeginLoadPacked(Deserializer& source)
+{
+    u32 version = source.ReadU32();
+    if (version != PACKED_MODEL_VERSION)
+    {
+        URHO3D_LOGERROR("Unsupported packed model version " + String(version) + " in " + source.GetName());
+        return false;
+    }
+
+    unsigned memoryUse = sizeof(Model);
+    bool async = GetAsyncLoadState() == ASYNC_LOADING;
+
+    // Read all tables with a single read and parse them from memory
+    Vector<byte> tableData(source.ReadU32());
+    if (tableData.Empty() || source.Read(tableData.Buffer(), tableData.Size()) != tableData.Size())
+    {
+        URHO3D_LOGERROR("Truncated packed model " + source.GetName());
+        return false;
+    }
+    MemoryBuffer tables(tableData);
+
+    // Every stream is checked against the data block, and the block against the file, before anything is read from them
+    auto invalidData = [&](const char* what)
+    {
+        URHO3D_LOGERROR("Invalid " + String(what) + " in packed model " + source.GetName());
+        loadVBData_.Clear();
+        loadIBData_.Clear();
+        loadGeometries_.Clear();
+        return false;
+    };
+
+    i64 dataStart = AlignPackedOffset(source.GetPosition());
+    u32 dataSize = tables.ReadU32();
+    if (dataSize > (u32)M_MAX_INT || dataStart + dataSize > source.GetSize())
+        return invalidData("data block size");
+
+    // Read vertex buffer descriptions. The data is read from the packed block afterward
+    unsigned numVertexBuffers = tables.ReadU32();
+    if (numVertexBuffers > tables.GetSize())
+        return invalidData("vertex buffer count");
+    vertexBuffers_.Reserve(numVertexBuffers);
+    morphRangeStarts_.Resize(numVertexBuffers);
+    morphRangeCounts_.Resize(numVertexBuffers);
+    loadVBData_.Resize(numVertexBuffers);
+    for (unsigned i = 0; i < numVertexBuffers; ++i)
+    {
+        VertexBufferDesc& desc = loadVBData_[i];
+        u32 vertexCount = tables.ReadU32();
+        desc.vertexElements_.Clear();
+        unsigned numElements = tables.ReadU32();
+        if (numElements > tables.GetSize())
+            return invalidData("vertex declaration");
+        for (unsigned j = 0; j < numElements; ++j)
+            desc.vertexElements_.Push(DecodeVertexElement(tables.ReadU32()));
+        morphRangeStarts_[i] = tables.ReadU32();
+        morphRangeCounts_[i] = tables.ReadU32();
+        u64 size = (u64)vertexCount * VertexBuffer::GetVertexSize(desc.vertexElements_);
+        u32 offset = tables.ReadU32();
+        if (!IsPackedRangeValid(offset, size, dataSize))
+            return invalidData("vertex data range");
+        desc.vertexCount_ = (i32)vertexCount;
+        desc.dataSize_ = (i32)size;
+        desc.dataOffset_ = (i32)offset;
+        desc.data_.Reset();
+
+        vertexBuffers_.Push(SharedPtr<VertexBuffer>(new VertexBuffer(context_)));
+        memoryUse += sizeof(VertexBuffer) + desc.dataSize_;
+    }
+
+    // Read index buffer descriptions
+    unsigned numIndexBuffers = tables.ReadU32();
+    if (numIndexBuffers > tables.GetSize())
+        return invalidData("index buffer count");
+    indexBuffers_.Reserve(numIndexBuffers);
+    loadIBData_.Resize(numIndexBuffers);
+    for (unsigned i = 0; i < numIndexBuffers; ++i)
+    {
+        IndexBufferDesc& desc = loadIBData_[i];
+        u32 indexCount = tables.ReadU32();
+        u32 indexSize = tables.ReadU32();
+        if (indexSize != sizeof(u16) && indexSize != sizeof(u32))
+            return invalidData("index size");
+        u64 size = (u64)indexCount * indexSize;
+        u32 offset = tables.ReadU32();
+        if (!IsPackedRangeValid(offset, size, dataSize))
+            return invalidData("index data range");
+        desc.indexCount_ = (i32)indexCount;
+        desc.indexSize_ = (i32)indexSize;
+        desc.dataSize_ = (i32)size;
+        desc.dataOffset_ = (i32)offset;
+        desc.data_.Reset();
+
+        indexBuffers_.Push(SharedPtr<IndexBuffer>(new IndexBuffer(context_)));
+        memoryUse += sizeof(IndexBuffer) + desc.dataSize_;
+    }
+
+    if (!LoadGeometries(tables, memoryUse))
+        return false;
+
+    // Read morph descriptions. Their data is read from the packed block afterward
+    struct MorphDataRef
+    {
+        i32 morphIndex_;
+        i32 bufferIndex_;
+        i32 offset_;
+    };
+
+    unsigned numMorphs = tables.ReadU32();
+    if (numMorphs > tables.GetSize())
+        return invalidData("morph count");
+    morphs_.Resize(numMorphs);
+    Vector<MorphDataRef> morphDataRefs;
+    for (unsigned i = 0; i < numMorphs; ++i)
+    {
+        ModelMorph& newMorph = morphs_[i];
+        newMorph.name_ = tables.ReadString();
+        newMorph.nameHash_ = newMorph.name_;
+        newMorph.weight_ = 0.0f;
+        memoryUse += sizeof(ModelMorph);
+
+        unsigned numBuffers = tables.ReadU32();
+        for (unsigned j = 0; j < numBuffers; ++j)
+        {
+            unsigned bufferIndex = tables.ReadU32();
+            if (bufferIndex >= numVertexBuffers)
+                return invalidData("morph vertex buffer index");
+            VertexBufferMorph& newBuffer = newMorph.buffers_[bufferIndex];
+            newBuffer.elementMask_ = VertexElements{tables.ReadU32()};
+            u32 vertexCount = tables.ReadU32();
+            u64 size = (u64)vertexCount * GetMorphVertexSize(newBuffer.elementMask_);
+            u32 offset = tables.ReadU32();
+            if (!IsPackedRangeValid(offset, size, dataSize))
+                return invalidData("morph data range");
+            newBuffer.vertexCount_ = (i32)vertexCount;
+            newBuffer.dataSize_ = (i32)size;
+            newBuffer.morphData_ = new byte[newBuffer.dataSize_];
+            morphDataRefs.Push({(i32)i, (i32)bufferIndex, (i32)offset});
+            memoryUse += sizeof(VertexBufferMorph) + newBuffer.dataSize_;
+        }
+    }
+
+    FinishBeginLoad(tables, memoryUse);
+
+    // Read the data block
+    source.Seek(dataStart);
+    if (async)
+    {
+        // Read everything at once into one allocation. Buffers are uploaded from it during EndLoad()
+        loadPackedData_ = new byte[dataSize];
+        loadPackedDataSize_ = (i32)dataSize;
+        if (source.Read(loadPackedData_.Get(), dataSize) != (i32)dataSize)
+        {
+            URHO3D_LOGERROR("Truncated packed model " + source.GetName());
+            loadPackedData_.Reset();
+            loadPackedDataSize_ = 0;
+            return false;
+        }
+
+        for (const MorphDataRef& ref : morphDataRefs)
+        {
+            VertexBufferMorph& morphBuffer = morphs_[ref.morphIndex_].buffers_[ref.bufferIndex_];
+            memcpy(morphBuffer.morphData_.Get(), loadPackedData_.Get() + ref.offset_, morphBuffer.dataSize_);
+        }
+    }
+    else
+    {
+        // If not async loading, read straight into the locked buffers. Streams are stored in reading order, so seeks only
+        // skip alignment padding
+        for (unsigned i = 0; i < numVertexBuffers; ++i)
+        {
+            VertexBuffer* buffer = vertexBuffers_[i];
+            const VertexBufferDesc& desc = loadVBData_[i];
+            buffer->SetShadowed(true);
+            buffer->SetSize(desc.vertexCount_, desc.vertexElements_);
+            source.Seek(dataStart + desc.dataOffset_);
+            void* dest = buffer->Lock(0, desc.vertexCount_);
+            source.Read(dest, desc.dataSize_);
+            buffer->Unlock();
+        }
+
+        for (unsigned i = 0; i < numIndexBuffers; ++i)
+        {
+            IndexBuffer* buffer = indexBuffers_[i];
+            const IndexBufferDesc& desc = loadIBData_[i];
+            buffer->SetShadowed(true);
+            buffer->SetSize(desc.indexCount_, desc.indexSize_ > sizeof(unsigned short));
+            source.Seek(dataStart + desc.dataOffset_);
+            void* dest = buffer->Lock(0, desc.indexCount_);
+            source.Read(dest, desc.dataSize_);
+            buffer->Unlock();
+        }
+
+        for (const MorphDataRef& ref : morphDataRefs)
+        {
+            VertexBufferMorph& morphBuffer = morphs_[ref.morphIndex_].buffers_[ref.bufferIndex_];
+            source.Seek(dataStart + ref.offset_);
+            source.Read(morphBuffer.morphData_.Get(), morphBuffer.dataSize_);
+        }
+    }
+
+    return true;
+}
+
+bool Model::LoadGeometries(Deserializer& source, unsigned& memoryUse)
+{
     unsigned numGeometries = source.ReadU32();
     geometries_.Reserve(numGeometries);
     geometryBoneMappings_.Reserve(numGeometries);
@@ -232,49 +582,11 @@ bool Model::BeginLoad(Deserializer& source)
 
         geometries_.Push(geometryLodLevels);
     }
+    return true;
+}
 
-    // Read morphs
-    unsigned numMorphs = source.ReadU32();
-    morphs_.Reserve(numMorphs);
-    for (unsigned i = 0; i < numMorphs; ++i)
-    {
-        ModelMorph newMorph;
-
-        newMorph.name_ = source.ReadString();
-        newMorph.nameHash_ = newMorph.name_;
-        newMorph.weight_ = 0.0f;
-        unsigned numBuffers = source.ReadU32();
-
-        for (unsigned j = 0; j < numBuffers; ++j)
-        {
-            VertexBufferMorph newBuffer;
-            unsigned bufferIndex = source.ReadU32();
-
-            newBuffer.elementMask_ = VertexElements{source.ReadU32()};
-            newBuffer.vertexCount_ = source.ReadU32();
-
-            // Base size: size of each vertex index
-            unsigned vertexSize = sizeof(unsigned);
-            // Add size of individual elements
-            if (!!(newBuffer.elementMask_ & VertexElements::Position))
-                vertexSize += sizeof(Vector3);
-            if (!!(newBuffer.elementMask_ & VertexElements::Normal))
-                vertexSize += sizeof(Vector3);
-            if (!!(newBuffer.elementMask_ & VertexElements::Tangent))
-                vertexSize += sizeof(Vector3);
-            newBuffer.dataSize_ = newBuffer.vertexCount_ * vertexSize;
-            newBuffer.morphData_ = new byte[newBuffer.dataSize_];
-
-            source.Read(&newBuffer.morphData_[0], newBuffer.vertexCount_ * vertexSize);
-
-            newMorph.buffers_[bufferIndex] = newBuffer;
-            memoryUse += sizeof(VertexBufferMorph) + newBuffer.vertexCount_ * vertexSize;
-        }
-
-        morphs_.Push(newMorph);
-        memoryUse += sizeof(ModelMorph);
-    }
-
+void Model::FinishBeginLoad(Deserializer& source, unsigned memoryUse)
+{
     // Read skeleton
     skeleton_.Load(source);
     memoryUse += skeleton_.GetNumBones() * sizeof(Bone);
@@ -295,93 +607,157 @@ bool Model::BeginLoad(Deserializer& source)
     SharedPtr<XMLFile> file(cache->GetTempResource<XMLFile>(xmlName, false));
     if (file)
         LoadMetadataFromXML(file->GetRoot());
-
     SetMemoryUse(memoryUse);
-    return true;
 }
 
-bool Model::EndLoad()
+bool Model::Save(Serializer& dest) const
 {
-    // Upload vertex buffer data
+    // Write ID
+    if (!dest.WriteFileID("UMD2"))
+        return false;
+
+    // Write vertex buffers
+    dest.WriteU32(vertexBuffers_.Size());
     for (unsigned i = 0; i < vertexBuffers_.Size(); ++i)
     {
         VertexBuffer* buffer = vertexBuffers_[i];
-        VertexBufferDesc& desc = loadVBData_[i];
-        if (desc.data_)
-        {
-            buffer->SetShadowed(true);
-            buffer->SetSize(desc.vertexCount_, desc.vertexElements_);
-            buffer->SetData(desc.data_.Get());
-        }
+        dest.WriteU32(buffer->GetVertexCount());
+        const Vector<VertexElement>& elements = buffer->GetElements();
+        dest.WriteU32(elements.Size());
+        for (unsigned j = 0; j < elements.Size(); ++j)
+            dest.WriteU32(EncodeVertexElement(elements[j]));
+        dest.WriteU32(morphRangeStarts_[i]);
+        dest.WriteU32(morphRangeCounts_[i]);
+        dest.Write(buffer->GetShadowData(), buffer->GetVertexCount() * buffer->GetVertexSize());
     }
-
-    // Upload index buffer data
+    // Write index buffers
+    dest.WriteU32(indexBuffers_.Size());
     for (unsigned i = 0; i < indexBuffers_.Size(); ++i)
     {
         IndexBuffer* buffer = indexBuffers_[i];
-        IndexBufferDesc& desc = loadIBData_[i];
-        if (desc.data_)
-        {
-            buffer->SetShadowed(true);
-            buffer->SetSize(desc.indexCount_, desc.indexSize_ > sizeof(unsigned short));
-            buffer->SetData(desc.data_.Get());
-        }
+        dest.WriteU32(buffer->GetIndexCount());
+        dest.WriteU32(buffer->GetIndexSize());
+        dest.Write(buffer->GetShadowData(), buffer->GetIndexCount() * buffer->GetIndexSize());
     }
+    SaveGeometries(dest);
 
-    // Set up geometries
-    for (unsigned i = 0; i < geometries_.Size(); ++i)
+    // Write morphs
+    dest.WriteU32(morphs_.Size());
+    for (unsigned i = 0; i < morphs_.Size(); ++i)
     {
-        for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+        dest.WriteString(morphs_[i].name_);
+        dest.WriteU32(morphs_[i].buffers_.Size());
+
+        // Write morph vertex buffers
+        for (HashMap<i32, VertexBufferMorph>::ConstIterator j = morphs_[i].buffers_.Begin();
+             j != morphs_[i].buffers_.End(); ++j)
         {
-            Geometry* geometry = geometries_[i][j];
-            GeometryDesc& desc = loadGeometries_[i][j];
-            geometry->SetVertexBuffer(0, vertexBuffers_[desc.vbRef_]);
-            geometry->SetIndexBuffer(indexBuffers_[desc.ibRef_]);
-            geometry->SetDrawRange(desc.type_, desc.indexStart_, desc.indexCount_);
+            dest.WriteU32(j->first_);
+            dest.WriteU32(ToU32(j->second_.elementMask_));
+            dest.WriteU32(j->second_.vertexCount_);
+            dest.Write(j->second_.morphData_.Get(), GetMorphVertexSize(j->second_.elementMask_) * j->second_.vertexCount_);
         }
     }
 
-    loadVBData_.Clear();
-    loadIBData_.Clear();
-    loadGeometries_.Clear();
+    SaveSkeletonAndBounds(dest);
+    SaveMetadataFile(dest);
     return true;
 }
 
-bool Model::Save(Serializer& dest) const
+bool Model::SavePacked(Serializer& dest) const
 {
-    // Write ID
-    if (!dest.WriteFileID("UMD2"))
-        return false;
+    // Write all tables to memory first, assigning each stream its place in the data block
+    VectorBuffer tables;
+    i32 dataSize = 0;
+    tables.WriteU32(0); // Data block size, filled in at the end
 
-    // Write vertex buffers
-    dest.WriteU32(vertexBuffers_.Size());
+    tables.WriteU32(vertexBuffers_.Size());
     for (unsigned i = 0; i < vertexBuffers_.Size(); ++i)
     {
         VertexBuffer* buffer = vertexBuffers_[i];
-        dest.WriteU32(buffer->GetVertexCount());
+        tables.WriteU32(buffer->GetVertexCount());
         const Vector<VertexElement>& elements = buffer->GetElements();
-        dest.WriteU32(elements.Size());
+        tables.WriteU32(elements.Size());
         for (unsigned j = 0; j < elements.Size(); ++j)
-        {
-            unsigned elementDesc = ((unsigned)elements[j].type_) |
-                (((unsigned)elements[j].semantic_) << 8u) |
-                (((unsigned)elements[j].index_) << 16u);
-            dest.WriteU32(elementDesc);
-        }
-        dest.WriteU32(morphRangeStarts_[i]);
-        dest.WriteU32(morphRangeCounts_[i]);
-        dest.Write(buffer->GetShadowData(), buffer->GetVertexCount() * buffer->GetVertexSize());
+            tables.WriteU32(EncodeVertexElement(elements[j]));
+        tables.WriteU32(morphRangeStarts_[i]);
+        tables.WriteU32(morphRangeCounts_[i]);
+        tables.WriteU32(AllocatePackedData(dataSize, buffer->GetVertexCount() * buffer->GetVertexSize()));
     }
-    // Write index buffers
-    dest.WriteU32(indexBuffers_.Size());
+
+    tables.WriteU32(indexBuffers_.Size());
     for (unsigned i = 0; i < indexBuffers_.Size(); ++i)
     {
         IndexBuffer* buffer = indexBuffers_[i];
-        dest.WriteU32(buffer->GetIndexCount());
-        dest.WriteU32(buffer->GetIndexSize());
-        dest.Write(buffer->GetShadowData(), buffer->GetIndexCount() * buffer->GetIndexSize());
+        tables.WriteU32(buffer->GetIndexCount());
+        tables.WriteU32(buffer->GetIndexSize());
+        tables.WriteU32(AllocatePackedData(dataSize, buffer->GetIndexCount() * buffer->GetIndexSize()));
+    }
+
+    SaveGeometries(tables);
+
+    tables.WriteU32(morphs_.Size());
+    for (unsigned i = 0; i < morphs_.Size(); ++i)
+    {
+        tables.WriteString(morphs_[i].name_);
+        tables.WriteU32(morphs_[i].buffers_.Size());
+        for (HashMap<i32, VertexBufferMorph>::ConstIterator j = morphs_[i].buffers_.Begin();
+             j != morphs_[i].buffers_.End(); ++j)
+        {
+            tables.WriteU32(j->first_);
+            tables.WriteU32(ToU32(j->second_.elementMask_));
+            tables.WriteU32(j->second_.vertexCount_);
+            tables.WriteU32(AllocatePackedData(dataSize, GetMorphVertexSize(j->second_.elementMask_) * j->second_.vertexCount_));
+        }
     }
-    // Write geometries
+
+    SaveSkeletonAndBounds(tables);
+
+    tables.Seek(0);
+    tables.WriteU32(dataSize);
+
+    if (!dest.WriteFileID("UMDP"))
+        return false;
+    dest.WriteU32(PACKED_MODEL_VERSION);
+    dest.WriteU32(tables.GetSize());
+    dest.Write(tables.GetData(), tables.GetSize());
+
+    // Pad so that the data block starts aligned relative to the start of the file
+    const byte padding[PACKED_MODEL_ALIGNMENT] = {};
+    i32 headerSize = 3 * sizeof(u32) + tables.GetSize();
+    dest.Write(padding, AlignPackedOffset(headerSize) - headerSize);
+
+    // Write the data block in the same order as it was laid out
+    for (VertexBuffer* buffer : vertexBuffers_)
+    {
+        i32 size = buffer->GetVertexCount() * buffer->GetVertexSize();
+        dest.Write(buffer->GetShadowData(), size);
+        dest.Write(padding, AlignPackedOffset(size) - size);
+    }
+
+    for (IndexBuffer* buffer : indexBuffers_)
+    {
+        i32 size = buffer->GetIndexCount() * buffer->GetIndexSize();
+        dest.Write(buffer->GetShadowData(), size);
+        dest.Write(padding, AlignPackedOffset(size) - size);
+    }
+
+    for (const ModelMorph& morph : morphs_)
+    {
+        for (HashMap<i32, VertexBufferMorph>::ConstIterator j = morph.buffers_.Begin(); j != morph.buffers_.End(); ++j)
+        {
+            i32 size = GetMorphVertexSize(j->second_.elementMask_) * j->second_.vertexCount_;
+            dest.Write(j->second_.morphData_.Get(), size);
+            dest.Write(padding, AlignPackedOffset(size) - size);
+        }
+    }
+
+    SaveMetadataFile(dest);
+    return true;
+}
+
+void Model::SaveGeometries(Serializer& dest) const
+{
     dest.WriteU32(geometries_.Size());
     for (unsigned i = 0; i < geometries_.Size(); ++i)
     {
@@ -403,36 +779,10 @@ bool Model::Save(Serializer& dest) const
             dest.WriteU32(geometry->GetIndexCount());
         }
     }
+}
 
-    // Write morphs
-    dest.WriteU32(morphs_.Size());
-    for (unsigned i = 0; i < morphs_.Size(); ++i)
-    {
-        dest.WriteString(morphs_[i].name_);
-        dest.WriteU32(morphs_[i].buffers_.Size());
-
-        // Write morph vertex buffers
-        for (HashMap<i32, VertexBufferMorph>::ConstIterator j = morphs_[i].buffers_.Begin();
-             j != morphs_[i].buffers_.End(); ++j)
-        {
-            dest.WriteU32(j->first_);
-            dest.WriteU32(ToU32(j->second_.elementMask_));
-            dest.WriteU32(j->second_.vertexCount_);
-
-            // Base size: size of each vertex index
-            unsigned vertexSize = sizeof(unsigned);
-            // Add size of individual elements
-            if (!!(j->second_.elementMask_ & VertexElements::Position))
-                vertexSize += sizeof(Vector3);
-            if (!!(j->second_.elementMask_ & VertexElements::Normal))
-                vertexSize += sizeof(Vector3);
-            if (!!(j->second_.elementMask_ & VertexElements::Tangent))
-                vertexSize += sizeof(Vector3);
-
-            dest.Write(j->second_.morphData_.Get(), vertexSize * j->second_.vertexCount_);
-        }
-    }
-
+void Model::SaveSkeletonAndBounds(Serializer& dest) const
+{
     // Write skeleton
     skeleton_.Save(dest);
 
@@ -442,8 +792,10 @@ bool Model::Save(Serializer& dest) const
     // Write geometry centers
     for (unsigned i = 0; i < geometryCenters_.Size(); ++i)
         dest.WriteVector3(geometryCenters_[i]);
+}
 
-    // Write metadata
+void Model::SaveMetadataFile(Serializer& dest) const
+{
     if (HasMetadata())
     {
         auto* destFile = dynamic_cast<File*>(&dest);
@@ -461,8 +813,6 @@ bool Model::Save(Serializer& dest) const
         else
             URHO3D_LOGWARNING("Can not save model metadata when not saving into a file");
     }
-
-    return true;
 }
 
 void Model::SetBoundingBox(const BoundingBox& box)
@@ -779,4 +1129,20 @@ i32 Model::GetMorphRangeCount(i32 bufferIndex) const
     return bufferIndex < vertexBuffers_.Size() ? morphRangeCounts_[bufferIndex] : 0;
 }
 
+i32 Model::GetLoadDataSize() const
+{
+    i32 size = loadPackedDataSize_;
+    for (const VertexBufferDesc& desc : loadVBData_)
+    {
+        if (desc.data_)
+            size += desc.dataSize_;
+    }
+    for (const IndexBufferDesc& desc : loadIBData_)
+    {
+        if (desc.data_)
+            size += desc.dataSize_;
+    }
+    return size;
+}
+
 }
@@ -55,6 +55,8 @@ struct VertexBufferDesc
     i32 dataSize_;
     /// Vertex data.
     SharedArrayPtr<byte> data_;
+    /// Offset of vertex data in a packed model's data block, used when the data is not stored separately.
+    i32 dataOffset_{};
 };
 
 /// Description of index buffer data for asynchronous loading.
@@ -68,6 +70,8 @@ struct IndexBufferDesc
     i32 dataSize_;
     /// Index data.
     SharedArrayPtr<byte> data_;
+    /// Offset of index data in a packed model's data block, used when the data is not stored separately.
+    i32 dataOffset_{};
 };
 
 /// Description of a geometry for asynchronous loading.
@@ -105,6 +109,8 @@ public:
     bool EndLoad() override;
     /// Save resource. Return true if successful.
     bool Save(Serializer& dest) const override;
+    /// Save in the packed format, where all vertex, index and morph data is stored after the tables in one aligned block. Loads with fewer reads and allocations. Model buffers must be shadowed. Return true if successful.
+    bool SavePacked(Serializer& dest) const;
 
     /// Set local-space bounding box.
     /// @property
@@ -193,8 +199,24 @@ public:
     i32 GetMorphRangeStart(i32 bufferIndex) const;
     /// Return vertex buffer morph range vertex count.
     i32 GetMorphRangeCount(i32 bufferIndex) const;
+    /// Return size in bytes of the buffer data read by BeginLoad() and held until EndLoad() uploads it.
+    /// @nobind
+    i32 GetLoadDataSize() const;
 
 private:
+    /// Load the packed format after the file ID.
+    bool BeginLoadPacked(Deserializer& source);
+    /// Read geometry descriptions. Return false if they reference nonexistent buffers.
+    bool LoadGeometries(Deserializer& source, unsigned& memoryUse);
+    /// Read skeleton, bounding box and geometry centers, load metadata and set memory use.
+    void FinishBeginLoad(Deserializer& source, unsigned memoryUse);
+    /// Write geometry descriptions.
+    void SaveGeometries(Serializer& dest) const;
+    /// Write skeleton, bounding box and geometry centers.
+    void SaveSkeletonAndBounds(Serializer& dest) const;
+    /// Write metadata to an XML file next to the destination file.
+    void SaveMetadataFile(Serializer& dest) const;
+
     /// Bounding box.
     BoundingBox boundingBox_;
     /// Skeleton.
@@ -221,6 +243,10 @@ private:
     Vector<IndexBufferDesc> loadIBData_;
     /// Geometry definitions for asynchronous loading.
     Vector<Vector<GeometryDesc>> loadGeometries_;
+    /// Packed model data block for asynchronous loading.
+    SharedArrayPtr<byte> loadPackedData_;
+    /// Size of the packed model data block.
+    i32 loadPackedDataSize_{};
 };
 
 }
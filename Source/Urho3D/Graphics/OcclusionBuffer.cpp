@@ -200,18 +200,7 @@ void OcclusionBuffer::DrawTriangles()
     {
         // Threaded
         auto* queue = GetSubsystem<WorkQueue>();
-
-        for (Vector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
-        {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = WI_MAX_PRIORITY;
-            item->workFunction_ = DrawOcclusionBatchWork;
-            item->aux_ = this;
-            item->start_ = &(*i);
-            queue->AddWorkItem(item);
-        }
-
-        queue->Complete(WI_MAX_PRIORITY);
+        queue->RunParallel(DrawOcclusionBatchWork, batches_.Buffer(), batches_.Size(), batches_.Size(), this);
 
         MergeBuffers();
         depthHierarchyDirty_ = true;
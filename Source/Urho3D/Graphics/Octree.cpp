@@ -15,6 +15,8 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
+#include <algorithm>
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -26,6 +28,15 @@ namespace Urho3D
 
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
+/// Maximum geometry drawable changes recorded between updates. Beyond this light volume caches are requeried.
+static const i32 MAX_DRAWABLE_CHANGES = 4096;
+/// Change grid cells per axis.
+static const i32 DRAWABLE_CHANGE_GRID_SIZE = 4;
+/// Total change grid cells.
+static const i32 NUM_DRAWABLE_CHANGE_CELLS = DRAWABLE_CHANGE_GRID_SIZE * DRAWABLE_CHANGE_GRID_SIZE * DRAWABLE_CHANGE_GRID_SIZE;
+
+/// Last octree change epoch handed out. Octree updates happen only in the main thread.
+static u32 lastChangeEpoch = 0;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
@@ -49,6 +60,22 @@ inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResu
     return lhs.distance_ < rhs.distance_;
 }
 
+inline bool CompareDrawableChanges(const OctreeDrawableChange& lhs, const OctreeDrawableChange& rhs)
+{
+    return lhs.drawable_ < rhs.drawable_;
+}
+
+inline bool CompareDrawableChangeToDrawable(const OctreeDrawableChange& lhs, Drawable* rhs)
+{
+    return lhs.drawable_ < rhs;
+}
+
+/// Return whether a recorded drawable change intersects a volume.
+template <class T> static bool IsChangeInside(const OctreeDrawableChange& change, const T& volume)
+{
+    return change.box_.Defined() && volume.IsInsideFast(change.box_) != OUTSIDE;
+}
+
 Octant::Octant(const BoundingBox& box, i32 level, Octant* parent, Octree* root, i32 index/* = ROOT_INDEX*/) :
     level_(level),
     parent_(parent),
@@ -191,15 +218,46 @@ void Octant::ResetRoot()
 
 void Octant::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
 {
-    if (debug && debug->IsInside(worldBoundingBox_))
-    {
-        debug->AddBoundingBox(worldBoundingBox_, Color(0.25f, 0.25f, 0.25f), depthTest);
+    if (!debug)
+        return;
 
-        for (auto& child : children_)
-        {
-            if (child)
-                child->DrawDebugGeometry(debug, depthTest);
-        }
+    // Gather the edges of all visible octants first, then add them as one line list
+    Vector<DebugLine> lines;
+    GetDebugLines(debug, lines, Color(0.25f, 0.25f, 0.25f).ToU32());
+    debug->AddLines(lines.Buffer(), lines.Size(), depthTest);
+}
+
+void Octant::GetDebugLines(const DebugRenderer* debug, Vector<DebugLine>& lines, color32 color) const
+{
+    if (!debug->IsInside(worldBoundingBox_))
+        return;
+
+    const Vector3& min = worldBoundingBox_.min_;
+    const Vector3& max = worldBoundingBox_.max_;
+    Vector3 v1(max.x_, min.y_, min.z_);
+    Vector3 v2(max.x_, max.y_, min.z_);
+    Vector3 v3(min.x_, max.y_, min.z_);
+    Vector3 v4(min.x_, min.y_, max.z_);
+    Vector3 v5(max.x_, min.y_, max.z_);
+    Vector3 v6(min.x_, max.y_, max.z_);
+
+    lines.Push(DebugLine(min, v1, color));
+    lines.Push(DebugLine(v1, v2, color));
+    lines.Push(DebugLine(v2, v3, color));
+    lines.Push(DebugLine(v3, min, color));
+    lines.Push(DebugLine(v4, v5, color));
+    lines.Push(DebugLine(v5, max, color));
+    lines.Push(DebugLine(max, v6, color));
+    lines.Push(DebugLine(v6, v4, color));
+    lines.Push(DebugLine(min, v4, color));
+    lines.Push(DebugLine(v1, v5, color));
+    lines.Push(DebugLine(v2, max, color));
+    lines.Push(DebugLine(v3, v6, color));
+
+    for (auto& child : children_)
+    {
+        if (child)
+            child->GetDebugLines(debug, lines, color);
     }
 }
 
@@ -367,30 +425,9 @@ void Octree::Update(const FrameInfo& frame)
         auto* queue = GetSubsystem<WorkQueue>();
         scene->BeginThreadedUpdate();
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = Max((int)(drawableUpdates_.Size() / numWorkItems), 1);
-
-        Vector<Drawable*>::Iterator start = drawableUpdates_.Begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
-        {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = WI_MAX_PRIORITY;
-            item->workFunction_ = UpdateDrawablesWork;
-            item->aux_ = const_cast<FrameInfo*>(&frame);
-
-            Vector<Drawable*>::Iterator end = drawableUpdates_.End();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
-
-        queue->Complete(WI_MAX_PRIORITY);
+        // One range of drawables for each thread
+        queue->RunParallel(UpdateDrawablesWork, drawableUpdates_.Buffer(), drawableUpdates_.Size(), 0,
+            const_cast<FrameInfo*>(&frame));
         scene->EndThreadedUpdate();
     }
 
@@ -440,6 +477,8 @@ void Octree::Update(const FrameInfo& frame)
             // Skip if no octant or does not belong to this octree anymore
             if (!octant || octant->GetRoot() != this)
                 continue;
+            // Record the new bounds even if the octant stays the same, as the drawable may have entered or left a light volume
+            MarkDrawableChanged(drawable);
             // Skip if still fits the current octant
             if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
                 continue;
@@ -459,6 +498,15 @@ void Octree::Update(const FrameInfo& frame)
     }
 
     drawableUpdates_.Clear();
+
+    // Start a new change epoch. Changes made after this are checked by light volume caches in addition to the completed ones
+    drawableChanges_.Swap(pendingDrawableChanges_);
+    drawableChangesOverflow_ = pendingDrawableChangesOverflow_;
+    ClearPendingDrawableChanges();
+    BuildDrawableChangeGrid();
+    previousChangeEpoch_ = changeEpoch_;
+    changeEpoch_ = ++lastChangeEpoch;
+    updatedSinceSceneUpdate_ = true;
 }
 
 void Octree::AddManualDrawable(Drawable* drawable)
@@ -467,6 +515,9 @@ void Octree::AddManualDrawable(Drawable* drawable)
         return;
 
     AddDrawable(drawable);
+    MarkDrawableChanged(drawable);
+    if (drawable->GetDrawableType() == DrawableTypes::Zone)
+        MarkZoneIndexDirty();
 }
 
 void Octree::RemoveManualDrawable(Drawable* drawable)
@@ -476,7 +527,60 @@ void Octree::RemoveManualDrawable(Drawable* drawable)
 
     Octant* octant = drawable->GetOctant();
     if (octant && octant->GetRoot() == this)
+    {
         octant->RemoveDrawable(drawable);
+        MarkDrawableRemoved(drawable);
+        if (drawable->GetDrawableType() == DrawableTypes::Zone)
+            MarkZoneIndexDirty();
+    }
+}
+
+void Octree::MarkDrawableChanged(Drawable* drawable)
+{
+    if (!(drawable->GetDrawableType() & DrawableTypes::Geometry) || pendingDrawableChangesOverflow_)
+        return;
+
+    // Update the existing record if the drawable has already changed since the last update
+    i32 index = drawable->drawableChangeIndex_;
+    if (index >= 0 && index < pendingDrawableChanges_.Size() && pendingDrawableChanges_[index].drawable_ == drawable)
+    {
+        pendingDrawableChanges_[index].box_ = drawable->GetWorldBoundingBox();
+        return;
+    }
+
+    if (pendingDrawableChanges_.Size() >= MAX_DRAWABLE_CHANGES)
+    {
+        ClearPendingDrawableChanges();
+        pendingDrawableChangesOverflow_ = true;
+        return;
+    }
+
+    drawable->drawableChangeIndex_ = pendingDrawableChanges_.Size();
+    pendingDrawableChanges_.Push({drawable, drawable->GetWorldBoundingBox()});
+}
+
+void Octree::MarkDrawableRemoved(Drawable* drawable)
+{
+    if (!(drawable->GetDrawableType() & DrawableTypes::Geometry) || pendingDrawableChangesOverflow_)
+        return;
+
+    // The drawable may be destroyed after removal, so forget its record index
+    i32 index = drawable->drawableChangeIndex_;
+    drawable->drawableChangeIndex_ = NINDEX;
+    if (index >= 0 && index < pendingDrawableChanges_.Size() && pendingDrawableChanges_[index].drawable_ == drawable)
+    {
+        pendingDrawableChanges_[index].box_ = BoundingBox();
+        return;
+    }
+
+    if (pendingDrawableChanges_.Size() >= MAX_DRAWABLE_CHANGES)
+    {
+        ClearPendingDrawableChanges();
+        pendingDrawableChangesOverflow_ = true;
+        return;
+    }
+
+    pendingDrawableChanges_.Push({drawable, BoundingBox()});
 }
 
 void Octree::GetDrawables(OctreeQuery& query) const
@@ -556,12 +660,212 @@ void Octree::CancelUpdate(Drawable* drawable)
     drawable->updateQueued_ = false;
 }
 
+void Octree::UpdateZoneIndex()
+{
+    if (!zoneIndexDirty_)
+        return;
+
+    URHO3D_PROFILE(UpdateZoneIndex);
+
+    Vector<Drawable*> zones;
+    AllContentOctreeQuery query(zones, DrawableTypes::Zone, DEFAULT_VIEWMASK);
+    GetDrawables(query);
+    zoneIndex_.Build(reinterpret_cast<Vector<Zone*>&>(zones));
+    zoneIndexDirty_ = false;
+}
+
 void Octree::DrawDebugGeometry(bool depthTest)
 {
     auto* debug = GetComponent<DebugRenderer>();
     DrawDebugGeometry(debug, depthTest);
 }
 
+void Octree::OnSceneSet(Scene* scene)
+{
+    if (scene)
+        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(Octree, HandleSceneUpdate));
+    else
+        UnsubscribeFromEvent(E_SCENEUPDATE);
+}
+
+void Octree::ClearPendingDrawableChanges()
+{
+    // Records of removed drawables have already forgotten their index
+    for (const OctreeDrawableChange& change : pendingDrawableChanges_)
+    {
+        if (change.box_.Defined())
+            change.drawable_->drawableChangeIndex_ = NINDEX;
+    }
+
+    pendingDrawableChanges_.Clear();
+    pendingDrawableChangesOverflow_ = false;
+}
+
+void Octree::BuildDrawableChangeGrid()
+{
+    drawableChangeCells_.Clear();
+    drawableChangeCellStarts_.Clear();
+    if (drawableChanges_.Empty())
+        return;
+
+    // Sort by drawable for looking up cached drawables, then bucket the changed bounds into a coarse grid over the octree
+    Sort(drawableChanges_.Begin(), drawableChanges_.End(), CompareDrawableChanges);
+    drawableChangeGridBox_ = worldBoundingBox_;
+    drawableChangeCellStarts_.Resize(NUM_DRAWABLE_CHANGE_CELLS + 1);
+    for (i32& start : drawableChangeCellStarts_)
+        start = 0;
+
+    IntVector3 min, max;
+    for (const OctreeDrawableChange& change : drawableChanges_)
+    {
+        if (!change.box_.Defined())
+            continue;
+
+        GetDrawableChangeCells(change.box_, min, max);
+        for (i32 z = min.z_; z <= max.z_; ++z)
+        {
+            for (i32 y = min.y_; y <= max.y_; ++y)
+            {
+                for (i32 x = min.x_; x <= max.x_; ++x)
+                    ++drawableChangeCellStarts_[((z * DRAWABLE_CHANGE_GRID_SIZE + y) * DRAWABLE_CHANGE_GRID_SIZE + x) + 1];
+            }
+        }
+    }
+
+    for (i32 i = 0; i < NUM_DRAWABLE_CHANGE_CELLS; ++i)
+        drawableChangeCellStarts_[i + 1] += drawableChangeCellStarts_[i];
+
+    drawableChangeCells_.Resize(drawableChangeCellStarts_.Back());
+    Vector<i32> cellEnds(drawableChangeCellStarts_);
+    for (i32 i = 0; i < drawableChanges_.Size(); ++i)
+    {
+        const OctreeDrawableChange& change = drawableChanges_[i];
+        if (!change.box_.Defined())
+            continue;
+
+        GetDrawableChangeCells(change.box_, min, max);
+        for (i32 z = min.z_; z <= max.z_; ++z)
+        {
+            for (i32 y = min.y_; y <= max.y_; ++y)
+            {
+                for (i32 x = min.x_; x <= max.x_; ++x)
+                    drawableChangeCells_[cellEnds[(z * DRAWABLE_CHANGE_GRID_SIZE + y) * DRAWABLE_CHANGE_GRID_SIZE + x]++] = i;
+            }
+        }
+    }
+}
+
+void Octree::GetDrawableChangeCells(const BoundingBox& box, IntVector3& min, IntVector3& max) const
+{
+    // Bounds outside the grid are clamped to the border cells
+    Vector3 scale = Vector3::ONE * (float)DRAWABLE_CHANGE_GRID_SIZE / drawableChangeGridBox_.Size();
+    Vector3 minCell = (box.min_ - drawableChangeGridBox_.min_) * scale;
+    Vector3 maxCell = (box.max_ - drawableChangeGridBox_.min_) * scale;
+    const float maxIndex = (float)(DRAWABLE_CHANGE_GRID_SIZE - 1);
+
+    min = IntVector3((i32)Clamp(minCell.x_, 0.0f, maxIndex), (i32)Clamp(minCell.y_, 0.0f, maxIndex),
+        (i32)Clamp(minCell.z_, 0.0f, maxIndex));
+    max = IntVector3((i32)Clamp(maxCell.x_, 0.0f, maxIndex), (i32)Clamp(maxCell.y_, 0.0f, maxIndex),
+        (i32)Clamp(maxCell.z_, 0.0f, maxIndex));
+}
+
+template <class T> bool Octree::CheckDrawableChangesInternal(const T& volume, const Vector<Drawable*>& drawables, bool pending) const
+{
+    Drawable* const* begin = drawables.Buffer();
+    Drawable* const* end = begin + drawables.Size();
+
+    // Membership changes if a drawable is inside the volume now but not in the list, or vice versa. Drawables that move
+    // within the volume do not invalidate the list
+    if (pending)
+    {
+        // Changes since the last update are usually few, so check all of them
+        if (pendingDrawableChangesOverflow_)
+            return true;
+
+        for (const OctreeDrawableChange& change : pendingDrawableChanges_)
+        {
+            if (IsChangeInside(change, volume) != std::binary_search(begin, end, change.drawable_))
+                return true;
+        }
+
+        return false;
+    }
+
+    if (drawableChangesOverflow_)
+        return true;
+    if (drawableChanges_.Empty())
+        return false;
+
+    // Entered drawables: only the changes bucketed to the grid cells overlapping the volume can be inside it
+    IntVector3 min, max;
+    GetDrawableChangeCells(BoundingBox(volume), min, max);
+    for (i32 z = min.z_; z <= max.z_; ++z)
+    {
+        for (i32 y = min.y_; y <= max.y_; ++y)
+        {
+            for (i32 x = min.x_; x <= max.x_; ++x)
+            {
+                i32 cell = (z * DRAWABLE_CHANGE_GRID_SIZE + y) * DRAWABLE_CHANGE_GRID_SIZE + x;
+                for (i32 i = drawableChangeCellStarts_[cell]; i < drawableChangeCellStarts_[cell + 1]; ++i)
+                {
+                    const OctreeDrawableChange& change = drawableChanges_[drawableChangeCells_[i]];
+                    if (IsChangeInside(change, volume) && !std::binary_search(begin, end, change.drawable_))
+                        return true;
+                }
+            }
+        }
+    }
+
+    // Left or removed drawables: both lists are sorted, so look up the elements of the shorter list from the longer one
+    if (drawables.Size() < drawableChanges_.Size())
+    {
+        const OctreeDrawableChange* changesBegin = drawableChanges_.Buffer();
+        const OctreeDrawableChange* changesEnd = changesBegin + drawableChanges_.Size();
+        for (Drawable* drawable : drawables)
+        {
+            const OctreeDrawableChange* i = std::lower_bound(changesBegin, changesEnd, drawable, CompareDrawableChangeToDrawable);
+            for (; i != changesEnd && i->drawable_ == drawable; ++i)
+            {
+                if (!IsChangeInside(*i, volume))
+                    return true;
+            }
+        }
+    }
+    else
+    {
+        for (const OctreeDrawableChange& change : drawableChanges_)
+        {
+            if (!IsChangeInside(change, volume) && std::binary_search(begin, end, change.drawable_))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+bool Octree::CheckDrawableChanges(const Frustum& frustum, const Vector<Drawable*>& drawables, bool pending) const
+{
+    return CheckDrawableChangesInternal(frustum, drawables, pending);
+}
+
+bool Octree::CheckDrawableChanges(const Sphere& sphere, const Vector<Drawable*>& drawables, bool pending) const
+{
+    return CheckDrawableChangesInternal(sphere, drawables, pending);
+}
+
+void Octree::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    // If no view updated the octree since the previous scene update, the changes would accumulate without bound.
+    // Discard them, so that light volume caches of this octree get requeried
+    if (!updatedSinceSceneUpdate_ && !pendingDrawableChanges_.Empty())
+    {
+        ClearPendingDrawableChanges();
+        pendingDrawableChangesOverflow_ = true;
+    }
+
+    updatedSinceSceneUpdate_ = false;
+}
+
 void Octree::HandleRenderUpdate(StringHash eventType, VariantMap& eventData)
 {
     // When running in headless mode, update the Octree manually during the RenderUpdate event
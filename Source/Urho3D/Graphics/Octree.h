@@ -6,15 +6,26 @@
 #include "../Core/Mutex.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/OctreeQuery.h"
+#include "../Graphics/ZoneIndex.h"
 
 namespace Urho3D
 {
 
 class Octree;
+struct DebugLine;
 
 static const int NUM_OCTANTS = 8;
 static const i32 ROOT_INDEX = NINDEX;
 
+/// Geometry drawable addition, move or removal recorded by the octree for incremental light volume culling.
+struct OctreeDrawableChange
+{
+    /// Drawable. May already be destroyed if removed, so only compare the pointer.
+    Drawable* drawable_;
+    /// World bounding box after the change. Undefined for removals.
+    BoundingBox box_;
+};
+
 /// %Octree octant.
 /// @nobind
 class URHO3D_API Octant
@@ -90,6 +101,8 @@ protected:
     void GetDrawablesInternal(RayOctreeQuery& query) const;
     /// Return drawable objects only for a threaded ray query, called internally.
     void GetDrawablesOnlyInternal(RayOctreeQuery& query, Vector<Drawable*>& drawables) const;
+    /// Append the edges of this and child octants visible to the debug renderer, called internally.
+    void GetDebugLines(const DebugRenderer* debug, Vector<DebugLine>& lines, color32 color) const;
 
     /// Increase drawable object count recursively.
     void IncDrawableCount()
@@ -181,12 +194,49 @@ public:
     void QueueUpdate(Drawable* drawable);
     /// Cancel drawable object's update.
     void CancelUpdate(Drawable* drawable);
+    /// Mark the zone index as requiring a rebuild. Called when a zone is added, removed, moved or resized.
+    void MarkZoneIndexDirty() { zoneIndexDirty_ = true; }
+    /// Rebuild the zone index if dirty. Must be called from the main thread before querying the index from worker threads.
+    void UpdateZoneIndex();
+
+    /// Return the zone index. Valid after UpdateZoneIndex().
+    const ZoneIndex& GetZoneIndex() const { return zoneIndex_; }
+    /// Record a geometry drawable being added, moved or resized. Each drawable is recorded once per update. Called internally.
+    void MarkDrawableChanged(Drawable* drawable);
+    /// Record a geometry drawable being removed. Called internally.
+    void MarkDrawableRemoved(Drawable* drawable);
+    /// Return whether geometry drawables changed between the previous and the last Update(), or since the last Update() if pending, may have entered the frustum or left the sorted drawable list of the frustum.
+    bool CheckDrawableChanges(const Frustum& frustum, const Vector<Drawable*>& drawables, bool pending) const;
+    /// Return whether geometry drawables changed between the previous and the last Update(), or since the last Update() if pending, may have entered the sphere or left the sorted drawable list of the sphere.
+    bool CheckDrawableChanges(const Sphere& sphere, const Vector<Drawable*>& drawables, bool pending) const;
+    /// Return change epoch of the last Update(). Epochs are unique across all octrees; zero means not updated yet.
+    u32 GetChangeEpoch() const { return changeEpoch_; }
+    /// Return change epoch of the Update() before the last one.
+    u32 GetPreviousChangeEpoch() const { return previousChangeEpoch_; }
+    /// Return geometry drawable changes between the previous and the last Update().
+    const Vector<OctreeDrawableChange>& GetDrawableChanges() const { return drawableChanges_; }
+    /// Return geometry drawable changes since the last Update().
+    const Vector<OctreeDrawableChange>& GetPendingDrawableChanges() const { return pendingDrawableChanges_; }
     /// Visualize the component as debug geometry.
     void DrawDebugGeometry(bool depthTest);
 
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+
 private:
     /// Handle render update in case of headless execution.
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle scene update. Discards drawable changes if the octree has not been updated since the previous scene update.
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    /// Clear geometry drawable changes since the last update.
+    void ClearPendingDrawableChanges();
+    /// Sort the geometry drawable changes of the last update and bucket them into a grid.
+    void BuildDrawableChangeGrid();
+    /// Return the range of change grid cells overlapping a bounding box.
+    void GetDrawableChangeCells(const BoundingBox& box, IntVector3& min, IntVector3& max) const;
+    /// Check geometry drawable changes against a volume and its sorted drawable list.
+    template <class T> bool CheckDrawableChangesInternal(const T& volume, const Vector<Drawable*>& drawables, bool pending) const;
     /// Update octree size.
     void UpdateOctreeSize() { SetSize(worldBoundingBox_, numLevels_); }
 
@@ -198,8 +248,32 @@ private:
     Mutex octreeMutex_;
     /// Ray query temporary list of drawables.
     mutable Vector<Drawable*> rayQueryDrawables_;
+    /// Spatial index of all zones for drawable zone assignment.
+    ZoneIndex zoneIndex_;
+    /// Geometry drawable changes between the previous and the last update.
+    Vector<OctreeDrawableChange> drawableChanges_;
+    /// Geometry drawable changes since the last update.
+    Vector<OctreeDrawableChange> pendingDrawableChanges_;
+    /// Indices to geometry drawable changes of the last update per grid cell.
+    Vector<i32> drawableChangeCells_;
+    /// Start of each grid cell in the cell indices, with an extra end entry.
+    Vector<i32> drawableChangeCellStarts_;
+    /// Bounds of the change grid.
+    BoundingBox drawableChangeGridBox_;
+    /// Too many geometry drawable changes between the previous and the last update to record.
+    bool drawableChangesOverflow_{};
+    /// Too many geometry drawable changes since the last update to record.
+    bool pendingDrawableChangesOverflow_{};
+    /// Updated since the previous scene update flag.
+    bool updatedSinceSceneUpdate_{};
+    /// Change epoch of the last update.
+    u32 changeEpoch_{};
+    /// Change epoch of the update before the last one.
+    u32 previousChangeEpoch_{};
     /// Subdivision level.
     i32 numLevels_;
+    /// Zone index rebuild needed flag.
+    bool zoneIndexDirty_{true};
 };
 
 }
@@ -423,6 +423,16 @@ void Renderer::SetReuseShadowMaps(bool enable)
     reuseShadowMaps_ = enable;
 }
 
+void Renderer::SetShadowAtlasSize(int size)
+{
+    size = size > 0 ? NextPowerOfTwo((unsigned)Max(size, SHADOW_MIN_PIXELS)) : 0;
+    if (size != shadowAtlasSize_)
+    {
+        shadowAtlasSize_ = size;
+        shadowAtlas_.Reset();
+    }
+}
+
 void Renderer::SetMaxShadowMaps(int shadowMaps)
 {
     if (shadowMaps < 1)
@@ -610,6 +620,14 @@ i32 Renderer::GetNumShadowMaps(bool allViews) const
     return numShadowMaps;
 }
 
+float Renderer::GetShadowAtlasOccupancy() const
+{
+    if (!shadowAtlas_)
+        return 0.0f;
+
+    return (float)((double)shadowAtlasUsedArea_ / ((double)shadowAtlas_->GetWidth() * shadowAtlas_->GetHeight()));
+}
+
 i32 Renderer::GetNumOccluders(bool allViews) const
 {
     i32 numOccluders = 0;
@@ -646,6 +664,7 @@ void Renderer::Update(float timeStep)
     numShadowCameras_ = 0;
     numOcclusionBuffers_ = 0;
     updatedOctrees_.Clear();
+    ResetShadowAtlas();
 
     // Reload shaders now if needed
     if (shadersDirty_)
@@ -821,62 +840,9 @@ Geometry* Renderer::GetQuadGeometry()
 
 Texture2D* Renderer::GetShadowMap(Light* light, Camera* camera, i32 viewWidth, i32 viewHeight)
 {
-    assert(viewWidth > 0);
-    assert(viewHeight > 0);
-
-    LightType type = light->GetLightType();
-    const FocusParameters& parameters = light->GetShadowFocus();
-    float size = (float)shadowMapSize_ * light->GetShadowResolution();
-    // Automatically reduce shadow map size when far away
-    if (parameters.autoSize_ && type != LIGHT_DIRECTIONAL)
-    {
-        const Matrix3x4& view = camera->GetView();
-        const Matrix4& projection = camera->GetProjection();
-        BoundingBox lightBox;
-        float lightPixels;
-
-        if (type == LIGHT_POINT)
-        {
-            // Calculate point light pixel size from the projection of its diagonal
-            Vector3 center = view * light->GetNode()->GetWorldPosition();
-            float extent = 0.58f * light->GetRange();
-            lightBox.Define(center + Vector3(extent, extent, extent), center - Vector3(extent, extent, extent));
-        }
-        else
-        {
-            // Calculate spot light pixel size from the projection of its frustum far vertices
-            Frustum lightFrustum = light->GetViewSpaceFrustum(view);
-            lightBox.Define(&lightFrustum.vertices_[4], 4);
-        }
-
-        Vector2 projectionSize = lightBox.Projected(projection).Size();
-        lightPixels = Max(0.5f * (float)viewWidth * projectionSize.x_, 0.5f * (float)viewHeight * projectionSize.y_);
-
-        // Clamp pixel amount to a sufficient minimum to avoid self-shadowing artifacts due to loss of precision
-        if (lightPixels < SHADOW_MIN_PIXELS)
-            lightPixels = SHADOW_MIN_PIXELS;
-
-        size = Min(size, lightPixels);
-    }
-
-    /// \todo Allow to specify maximum shadow maps per resolution, as smaller shadow maps take less memory
-    int width = NextPowerOfTwo((unsigned)size);
-    int height = width;
-
-    // Adjust the size for directional or point light shadow map atlases
-    if (type == LIGHT_DIRECTIONAL)
-    {
-        auto numSplits = (unsigned)light->GetNumShadowSplits();
-        if (numSplits > 1)
-            width *= 2;
-        if (numSplits > 2)
-            height *= 2;
-    }
-    else if (type == LIGHT_POINT)
-    {
-        width *= 2;
-        height *= 3;
-    }
+    IntVector2 size = CalculateShadowMapSize(light, camera, viewWidth, viewHeight);
+    int width = size.x_;
+    int height = size.y_;
 
     int searchKey = width << 16u | height;
     if (shadowMaps_.Contains(searchKey))
@@ -898,91 +864,74 @@ Texture2D* Renderer::GetShadowMap(Light* light, Camera* camera, i32 viewWidth, i
         }
     }
 
-    // Find format and usage of the shadow map
-    unsigned shadowMapFormat = 0;
-    TextureUsage shadowMapUsage = TEXTURE_DEPTHSTENCIL;
-    int multiSample = 1;
+    // If failed to create, store a null pointer so that we will not retry
+    SharedPtr<Texture2D> newShadowMap = CreateShadowMap(width, height);
 
-    switch (shadowQuality_)
-    {
-    case SHADOWQUALITY_SIMPLE_16BIT:
-    case SHADOWQUALITY_PCF_16BIT:
-        shadowMapFormat = graphics_->GetShadowMapFormat();
-        break;
+    shadowMaps_[searchKey].Push(newShadowMap);
+    if (!reuseShadowMaps_)
+        shadowMapAllocations_[searchKey].Push(light);
 
-    case SHADOWQUALITY_SIMPLE_24BIT:
-    case SHADOWQUALITY_PCF_24BIT:
-        shadowMapFormat = graphics_->GetHiresShadowMapFormat();
-        break;
+    return newShadowMap;
+}
 
-    case SHADOWQUALITY_VSM:
-    case SHADOWQUALITY_BLUR_VSM:
-        shadowMapFormat = graphics_->GetRGFloat32Format();
-        shadowMapUsage = TEXTURE_RENDERTARGET;
-        multiSample = vsmMultiSample_;
-        break;
-    }
+bool Renderer::IsShadowAtlasUsed(Light* light) const
+{
+    return shadowAtlas_ && !reuseShadowMaps_ && light->GetLightType() != LIGHT_POINT;
+}
 
-    if (!shadowMapFormat)
-        return nullptr;
+bool Renderer::AllocateShadowAtlasRegion(Light* light, Camera* camera, i32 viewWidth, i32 viewHeight, hash64 key, IntRect& region)
+{
+    if (!IsShadowAtlasUsed(light))
+        return false;
 
-    SharedPtr<Texture2D> newShadowMap(new Texture2D(context_));
-    int retries = 3;
-    unsigned dummyColorFormat = graphics_->GetDummyColorFormat();
+    // Another view has already allocated the same shadow map on this frame
+    HashMap<hash64, ShadowAtlasRegion>::ConstIterator i = shadowAtlasRegions_.Find(key);
+    if (i != shadowAtlasRegions_.End())
+    {
+        region = i->second_.rect_;
+        return true;
+    }
 
-    // Disable mipmaps from the shadow map
-    newShadowMap->SetNumLevels(1);
+    IntVector2 size = CalculateShadowMapSize(light, camera, viewWidth, viewHeight);
+    int splitSize = size.x_;
+    if (light->GetLightType() == LIGHT_DIRECTIONAL && light->GetNumShadowSplits() > 1)
+        splitSize /= 2;
 
-    while (retries)
+    // Lower the resolution until the shadow map fits into the remaining atlas space
+    while (splitSize >= SHADOW_MIN_PIXELS)
     {
-        if (!newShadowMap->SetSize(width, height, shadowMapFormat, shadowMapUsage, multiSample))
+        int x, y;
+        if (shadowAtlasAllocator_.Allocate(size.x_, size.y_, x, y))
         {
-            width >>= 1;
-            height >>= 1;
-            --retries;
+            region = IntRect(x, y, x + size.x_, y + size.y_);
+            shadowAtlasRegions_[key].rect_ = region;
+            shadowAtlasUsedArea_ += (i64)size.x_ * size.y_;
+            return true;
         }
-        else
-        {
-#ifndef GL_ES_VERSION_2_0
-            // OpenGL (desktop) and D3D11: shadow compare mode needs to be specifically enabled for the shadow map
-            newShadowMap->SetFilterMode(FILTER_BILINEAR);
-            newShadowMap->SetShadowCompare(shadowMapUsage == TEXTURE_DEPTHSTENCIL);
-#endif
 
-            if (Graphics::GetGAPI() != GAPI_OPENGL)
-            {
-                // Direct3D9: when shadow compare must be done manually, use nearest filtering so that the filtering of point lights
-                // and other shadowed lights matches
-                newShadowMap->SetFilterMode(graphics_->GetHardwareShadowSupport() ? FILTER_BILINEAR : FILTER_NEAREST);
-            }
-
-            // Create dummy color texture for the shadow map if necessary: Direct3D9, or OpenGL when working around an OS X +
-            // Intel driver bug
-            if (shadowMapUsage == TEXTURE_DEPTHSTENCIL && dummyColorFormat)
-            {
-                // If no dummy color rendertarget for this size exists yet, create one now
-                if (!colorShadowMaps_.Contains(searchKey))
-                {
-                    colorShadowMaps_[searchKey] = new Texture2D(context_);
-                    colorShadowMaps_[searchKey]->SetNumLevels(1);
-                    colorShadowMaps_[searchKey]->SetSize(width, height, dummyColorFormat, TEXTURE_RENDERTARGET);
-                }
-                // Link the color rendertarget to the shadow map
-                newShadowMap->GetRenderSurface()->SetLinkedRenderTarget(colorShadowMaps_[searchKey]->GetRenderSurface());
-            }
-            break;
-        }
+        size.x_ >>= 1;
+        size.y_ >>= 1;
+        splitSize >>= 1;
     }
 
-    // If failed to set size, store a null pointer so that we will not retry
-    if (!retries)
-        newShadowMap.Reset();
+    return false;
+}
 
-    shadowMaps_[searchKey].Push(newShadowMap);
-    if (!reuseShadowMaps_)
-        shadowMapAllocations_[searchKey].Push(light);
+bool Renderer::ClaimShadowAtlasRegion(hash64 key)
+{
+    HashMap<hash64, ShadowAtlasRegion>::Iterator i = shadowAtlasRegions_.Find(key);
+    if (i == shadowAtlasRegions_.End())
+        return true;
 
-    return newShadowMap;
+    // Count only the renders actually skipped. A view sharing a region may not need the shadow map after all
+    if (i->second_.rendered_)
+    {
+        ++numSharedShadowMaps_;
+        return false;
+    }
+
+    i->second_.rendered_ = true;
+    return true;
 }
 
 Texture* Renderer::GetScreenBuffer(int width, int height, unsigned format, int multiSample, bool autoResolve, bool cubemap, bool filtered, bool srgb,
@@ -1901,6 +1850,182 @@ void Renderer::ResetShadowMaps()
     shadowMaps_.Clear();
     shadowMapAllocations_.Clear();
     colorShadowMaps_.Clear();
+    shadowAtlas_.Reset();
+}
+
+void Renderer::ResetShadowAtlas()
+{
+    shadowAtlasRegions_.Clear();
+    shadowAtlasUsedArea_ = 0;
+    numSharedShadowMaps_ = 0;
+
+    bool useAtlas = shadowAtlasSize_ && drawShadows_ && !reuseShadowMaps_ && shadowQuality_ != SHADOWQUALITY_VSM &&
+        shadowQuality_ != SHADOWQUALITY_BLUR_VSM;
+    if (!useAtlas)
+    {
+        shadowAtlas_.Reset();
+        return;
+    }
+
+    if (!shadowAtlas_)
+    {
+        shadowAtlas_ = CreateShadowMap(shadowAtlasSize_, shadowAtlasSize_);
+        if (!shadowAtlas_)
+        {
+            URHO3D_LOGERROR("Failed to create shadow atlas, disabling");
+            shadowAtlasSize_ = 0;
+            return;
+        }
+    }
+
+    shadowAtlasAllocator_.Reset(shadowAtlas_->GetWidth(), shadowAtlas_->GetHeight(), 0, 0, false);
+}
+
+IntVector2 Renderer::CalculateShadowMapSize(Light* light, Camera* camera, i32 viewWidth, i32 viewHeight) const
+{
+    assert(viewWidth > 0);
+    assert(viewHeight > 0);
+
+    LightType type = light->GetLightType();
+    const FocusParameters& parameters = light->GetShadowFocus();
+    float size = (float)shadowMapSize_ * light->GetShadowResolution();
+    // Automatically reduce shadow map size when far away
+    if (parameters.autoSize_ && type != LIGHT_DIRECTIONAL)
+    {
+        const Matrix3x4& view = camera->GetView();
+        const Matrix4& projection = camera->GetProjection();
+        BoundingBox lightBox;
+        float lightPixels;
+
+        if (type == LIGHT_POINT)
+        {
+            // Calculate point light pixel size from the projection of its diagonal
+            Vector3 center = view * light->GetNode()->GetWorldPosition();
+            float extent = 0.58f * light->GetRange();
+            lightBox.Define(center + Vector3(extent, extent, extent), center - Vector3(extent, extent, extent));
+        }
+        else
+        {
+            // Calculate spot light pixel size from the projection of its frustum far vertices
+            Frustum lightFrustum = light->GetViewSpaceFrustum(view);
+            lightBox.Define(&lightFrustum.vertices_[4], 4);
+        }
+
+        Vector2 projectionSize = lightBox.Projected(projection).Size();
+        lightPixels = Max(0.5f * (float)viewWidth * projectionSize.x_, 0.5f * (float)viewHeight * projectionSize.y_);
+
+        // Clamp pixel amount to a sufficient minimum to avoid self-shadowing artifacts due to loss of precision
+        if (lightPixels < SHADOW_MIN_PIXELS)
+            lightPixels = SHADOW_MIN_PIXELS;
+
+        size = Min(size, lightPixels);
+    }
+
+    /// \todo Allow to specify maximum shadow maps per resolution, as smaller shadow maps take less memory
+    int width = NextPowerOfTwo((unsigned)size);
+    int height = width;
+
+    // Adjust the size for directional or point light shadow map atlases
+    if (type == LIGHT_DIRECTIONAL)
+    {
+        auto numSplits = (unsigned)light->GetNumShadowSplits();
+        if (numSplits > 1)
+            width *= 2;
+        if (numSplits > 2)
+            height *= 2;
+    }
+    else if (type == LIGHT_POINT)
+    {
+        width *= 2;
+        height *= 3;
+    }
+
+    return IntVector2(width, height);
+}
+
+SharedPtr<Texture2D> Renderer::CreateShadowMap(int width, int height)
+{
+    // Find format and usage of the shadow map
+    unsigned shadowMapFormat = 0;
+    TextureUsage shadowMapUsage = TEXTURE_DEPTHSTENCIL;
+    int multiSample = 1;
+
+    switch (shadowQuality_)
+    {
+    case SHADOWQUALITY_SIMPLE_16BIT:
+    case SHADOWQUALITY_PCF_16BIT:
+        shadowMapFormat = graphics_->GetShadowMapFormat();
+        break;
+
+    case SHADOWQUALITY_SIMPLE_24BIT:
+    case SHADOWQUALITY_PCF_24BIT:
+        shadowMapFormat = graphics_->GetHiresShadowMapFormat();
+        break;
+
+    case SHADOWQUALITY_VSM:
+    case SHADOWQUALITY_BLUR_VSM:
+        shadowMapFormat = graphics_->GetRGFloat32Format();
+        shadowMapUsage = TEXTURE_RENDERTARGET;
+        multiSample = vsmMultiSample_;
+        break;
+    }
+
+    if (!shadowMapFormat)
+        return SharedPtr<Texture2D>();
+
+    SharedPtr<Texture2D> newShadowMap(new Texture2D(context_));
+    int retries = 3;
+    unsigned dummyColorFormat = graphics_->GetDummyColorFormat();
+
+    // Disable mipmaps from the shadow map
+    newShadowMap->SetNumLevels(1);
+
+    while (retries)
+    {
+        if (!newShadowMap->SetSize(width, height, shadowMapFormat, shadowMapUsage, multiSample))
+        {
+            width >>= 1;
+            height >>= 1;
+            --retries;
+        }
+        else
+        {
+#ifndef GL_ES_VERSION_2_0
+            // OpenGL (desktop) and D3D11: shadow compare mode needs to be specifically enabled for the shadow map
+            newShadowMap->SetFilterMode(FILTER_BILINEAR);
+            newShadowMap->SetShadowCompare(shadowMapUsage == TEXTURE_DEPTHSTENCIL);
+#endif
+
+            if (Graphics::GetGAPI() != GAPI_OPENGL)
+            {
+                // Direct3D9: when shadow compare must be done manually, use nearest filtering so that the filtering of point lights
+                // and other shadowed lights matches
+                newShadowMap->SetFilterMode(graphics_->GetHardwareShadowSupport() ? FILTER_BILINEAR : FILTER_NEAREST);
+            }
+
+            // Create dummy color texture for the shadow map if necessary: Direct3D9, or OpenGL when working around an OS X +
+            // Intel driver bug
+            if (shadowMapUsage == TEXTURE_DEPTHSTENCIL && dummyColorFormat)
+            {
+                // If no dummy color rendertarget for this size exists yet, create one now
+                int searchKey = width << 16u | height;
+                if (!colorShadowMaps_.Contains(searchKey))
+                {
+                    colorShadowMaps_[searchKey] = new Texture2D(context_);
+                    colorShadowMaps_[searchKey]->SetNumLevels(1);
+                    colorShadowMaps_[searchKey]->SetSize(width, height, dummyColorFormat, TEXTURE_RENDERTARGET);
+                }
+                // Link the color rendertarget to the shadow map
+                newShadowMap->GetRenderSurface()->SetLinkedRenderTarget(colorShadowMaps_[searchKey]->GetRenderSurface());
+            }
+            break;
+        }
+    }
+
+    if (!retries)
+        newShadowMap.Reset();
+
+    return newShadowMap;
 }
 
 void Renderer::ResetBuffers()
@@ -10,6 +10,7 @@
 #include "../Graphics/Batch.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Viewport.h"
+#include "../Math/AreaAllocator.h"
 #include "../Math/Color.h"
 
 namespace Urho3D
@@ -223,6 +224,9 @@ public:
     /// Set maximum number of shadow maps created for one resolution. Only has effect if reuse of shadow maps is disabled.
     /// @property
     void SetMaxShadowMaps(int shadowMaps);
+    /// Set shadow atlas size, or 0 to disable (default). Only has effect if reuse of shadow maps is disabled. Directional and spot light shadow maps are then packed into one atlas by priority each frame, lowering the resolution of lights that do not fit. Lights that do not fit even at the minimum resolution get separate shadow maps. Point lights and VSM shadows use separate shadow maps.
+    /// @property
+    void SetShadowAtlasSize(int size);
     /// Set dynamic instancing on/off. When on (default), drawables using the same static-type geometry and material will be automatically combined to an instanced draw call.
     /// @property
     void SetDynamicInstancing(bool enable);
@@ -334,6 +338,13 @@ public:
     /// @property
     int GetMaxShadowMaps() const { return maxShadowMaps_; }
 
+    /// Return shadow atlas size, 0 if disabled.
+    /// @property
+    int GetShadowAtlasSize() const { return shadowAtlasSize_; }
+
+    /// Return shadow atlas texture, or null if not created.
+    Texture2D* GetShadowAtlas() const { return shadowAtlas_; }
+
     /// Return whether dynamic instancing is in use.
     /// @property
     bool GetDynamicInstancing() const { return dynamicInstancing_; }
@@ -402,6 +413,12 @@ public:
     /// Return number of occluders rendered.
     /// @property
     i32 GetNumOccluders(bool allViews = false) const;
+    /// Return fraction of the shadow atlas area allocated on this frame.
+    /// @property
+    float GetShadowAtlasOccupancy() const;
+    /// Return number of shadow map renders avoided on this frame by sharing shadow atlas regions between views.
+    /// @property
+    i32 GetNumSharedShadowMaps() const { return numSharedShadowMaps_; }
 
     /// Return the default zone.
     /// @property
@@ -448,6 +465,12 @@ public:
     Geometry* GetQuadGeometry();
     /// Allocate a shadow map. If shadow map reuse is disabled, a different map is returned each time.
     Texture2D* GetShadowMap(Light* light, Camera* camera, i32 viewWidth, i32 viewHeight);
+    /// Return whether a light's shadow map should be allocated from the shadow atlas.
+    bool IsShadowAtlasUsed(Light* light) const;
+    /// Allocate a shadow atlas region for a light. The key identifies the light's shadow cameras and casters; if another view already allocated a region with the same key on this frame, that region is returned so its shadow map is rendered only once. Return true if successful.
+    bool AllocateShadowAtlasRegion(Light* light, Camera* camera, i32 viewWidth, i32 viewHeight, hash64 key, IntRect& region);
+    /// Claim the shadow atlas region with the key for rendering on this frame. Return false if it has been rendered already.
+    bool ClaimShadowAtlasRegion(hash64 key);
     /// Allocate a rendertarget or depth-stencil texture for deferred rendering or postprocessing. Should only be called during actual rendering, not before.
     Texture* GetScreenBuffer
         (int width, int height, unsigned format, int multiSample, bool autoResolve, bool cubemap, bool filtered, bool srgb, hash32 persistentKey = 0);
@@ -505,6 +528,12 @@ private:
     void RemoveUnusedBuffers();
     /// Reset shadow map allocation counts.
     void ResetShadowMapAllocations();
+    /// Reset shadow atlas allocations for a new frame, creating the atlas if necessary.
+    void ResetShadowAtlas();
+    /// Return shadow map texture size for a light, including the split layout of directional and point lights.
+    IntVector2 CalculateShadowMapSize(Light* light, Camera* camera, i32 viewWidth, i32 viewHeight) const;
+    /// Create a shadow map texture in the current shadow quality's format. Size is halved on failure. Return null if could not be created.
+    SharedPtr<Texture2D> CreateShadowMap(int width, int height);
     /// Reset screem buffer allocation counts.
     void ResetScreenBufferAllocations();
     /// Remove all shadow maps. Called when global shadow map resolution or format is changed.
@@ -556,6 +585,20 @@ private:
     HashMap<int, SharedPtr<Texture2D>> colorShadowMaps_;
     /// Shadow map allocations by resolution.
     HashMap<int, Vector<Light*>> shadowMapAllocations_;
+    /// Shadow atlas texture.
+    SharedPtr<Texture2D> shadowAtlas_;
+    /// Shadow atlas area allocator, reset each frame.
+    AreaAllocator shadowAtlasAllocator_;
+    /// Shadow atlas region allocated on this frame.
+    struct ShadowAtlasRegion
+    {
+        /// Region rectangle.
+        IntRect rect_;
+        /// Rendered flag.
+        bool rendered_{};
+    };
+    /// Shadow atlas regions allocated on this frame by key.
+    HashMap<hash64, ShadowAtlasRegion> shadowAtlasRegions_;
     /// Instance of shadow map filter.
     Object* shadowMapFilterInstance_{};
     /// Function pointer of shadow map filter.
@@ -604,6 +647,12 @@ private:
     int vsmMultiSample_{1};
     /// Maximum number of shadow maps per resolution.
     int maxShadowMaps_{1};
+    /// Shadow atlas size, 0 if disabled.
+    int shadowAtlasSize_{};
+    /// Shadow atlas area allocated on this frame in pixels.
+    i64 shadowAtlasUsedArea_{};
+    /// Number of shadow map renders avoided by sharing on this frame.
+    i32 numSharedShadowMaps_{};
     /// Minimum number of instances required in a batch group to render as instanced.
     int minInstances_{2};
     /// Maximum sorted instances per batch group.
@@ -4,6 +4,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Thread.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Material.h"
@@ -16,6 +17,10 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
 namespace Urho3D
 {
 
@@ -34,6 +39,73 @@ inline bool CompareTails(TrailPoint* lhs, TrailPoint* rhs)
     return lhs->sortDistance_ > rhs->sortDistance_;
 }
 
+/// Convert elapsed lengths to smoothstepped color factors in place and output the matching scales.
+static void CalculateTrailFactors(float* factors, float* scales, unsigned count, float trailLength, float endScale, float startScale)
+{
+    const float invLength = trailLength > 0.0f ? 1.0f / trailLength : 0.0f;
+    const float scaleRange = startScale - endScale;
+    unsigned i = 0;
+
+#ifdef URHO3D_SSE
+    const __m128 invLengthVec = _mm_set1_ps(invLength);
+    const __m128 endScaleVec = _mm_set1_ps(endScale);
+    const __m128 scaleRangeVec = _mm_set1_ps(scaleRange);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 t = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(factors + i), invLengthVec), zero), one);
+        __m128 factor = _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(three, _mm_mul_ps(two, t)));
+        _mm_storeu_ps(factors + i, factor);
+        _mm_storeu_ps(scales + i, _mm_add_ps(endScaleVec, _mm_mul_ps(scaleRangeVec, factor)));
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        float t = Clamp(factors[i] * invLength, 0.0f, 1.0f);
+        float factor = t * t * (3.0f - 2.0f * t);
+        factors[i] = factor;
+        scales[i] = endScale + scaleRange * factor;
+    }
+}
+
+/// Write one face camera trail vertex: position, color, UV, forward vector and width.
+static inline void WriteFaceCameraVertex(float* dest, const TrailPoint& point, color32 color, float factor, float elapsed, float width)
+{
+    dest[0] = point.position_.x_;
+    dest[1] = point.position_.y_;
+    dest[2] = point.position_.z_;
+    ((color32&)dest[3]) = color;
+    dest[4] = factor;
+    dest[5] = elapsed;
+    dest[6] = point.forward_.x_;
+    dest[7] = point.forward_.y_;
+    dest[8] = point.forward_.z_;
+    dest[9] = width;
+}
+
+/// Write one bone trail vertex: position, forward vector as normal, color, UV, parent position and scale.
+static inline void WriteBoneVertex(float* dest, const TrailPoint& point, color32 color, float factor, float elapsed, float scale)
+{
+    dest[0] = point.position_.x_;
+    dest[1] = point.position_.y_;
+    dest[2] = point.position_.z_;
+    dest[3] = point.forward_.x_;
+    dest[4] = point.forward_.y_;
+    dest[5] = point.forward_.z_;
+    ((color32&)dest[6]) = color;
+    dest[7] = factor;
+    dest[8] = elapsed;
+    dest[9] = point.parentPos_.x_;
+    dest[10] = point.parentPos_.y_;
+    dest[11] = point.parentPos_.z_;
+    dest[12] = scale;
+}
+
 TrailPoint::TrailPoint(const Vector3& position, const Vector3& forward) :
     position_{position},
     forward_{forward}
@@ -50,6 +122,7 @@ RibbonTrail::RibbonTrail(Context* context) :
     transforms_(Matrix3x4::IDENTITY),
     bufferSizeDirty_(false),
     bufferDirty_(true),
+    vertexDataDirty_(false),
     previousPosition_(Vector3::ZERO),
     numPoints_(0),
     lifetime_(1.0f),
@@ -380,14 +453,20 @@ void RibbonTrail::UpdateGeometry(const FrameInfo& frame)
     if (bufferSizeDirty_ || indexBuffer_->IsDataLost())
         UpdateBufferSize();
 
-    if (bufferDirty_ || vertexBuffer_->IsDataLost())
-        UpdateVertexBuffer(frame);
+    if (bufferDirty_ || (vertexBuffer_->IsDataLost() && !vertexDataDirty_))
+        UpdateVertexData(frame);
+
+    // When generated in a worker thread, the upload happens on the second update call on the main thread
+    if (vertexDataDirty_ && Thread::IsMainThread())
+        UploadVertexData();
 }
 
 UpdateGeometryType RibbonTrail::GetUpdateGeometryType()
 {
-    if (bufferDirty_ || bufferSizeDirty_ || vertexBuffer_->IsDataLost() || indexBuffer_->IsDataLost())
+    if (bufferSizeDirty_ || indexBuffer_->IsDataLost() || vertexDataDirty_)
         return UPDATE_MAIN_THREAD;
+    else if (bufferDirty_ || vertexBuffer_->IsDataLost())
+        return UPDATE_WORKER_THREAD;
     else
         return UPDATE_NONE;
 }
@@ -501,7 +580,7 @@ void RibbonTrail::UpdateBufferSize()
     indexBuffer_->ClearDataLost();
 }
 
-void RibbonTrail::UpdateVertexBuffer(const FrameInfo& frame)
+void RibbonTrail::UpdateVertexData(const FrameInfo& frame)
 {
     // If using animation LOD, accumulate time and see if it is time to update
     if (animationLodBias_ > 0.0f && lodDistance_ > 0.0f)
@@ -543,122 +622,70 @@ void RibbonTrail::UpdateVertexBuffer(const FrameInfo& frame)
 
     // Update individual trail elapsed length
     float trailLength = 0.0f;
+    pointFactors_.Resize(numPoints_);
     for(unsigned i = 0; i < numPoints_; ++i)
     {
         float length = i == 0 ? 0.0f : (points_[i].position_ - points_[i-1].position_).Length();
         trailLength += length;
         points_[i].elapsedLength_ = trailLength;
+        pointFactors_[i] = trailLength;
         if (i < numPoints_ - 1)
             points_[i].next_ = &points_[i+1];
     }
 
+    // Evaluate color and scale once per point, as each point is shared by two segments
+    pointScales_.Resize(numPoints_);
+    pointColors_.Resize(numPoints_);
+    CalculateTrailFactors(pointFactors_.Buffer(), pointScales_.Buffer(), numPoints_, trailLength, endScale_, startScale_);
+    for (unsigned i = 0; i < numPoints_; ++i)
+        pointColors_[i] = endColor_.Lerp(startColor_, pointFactors_[i]).ToU32();
+
     batches_[0].geometry_->SetDrawRange(TRIANGLE_LIST, 0, (numPoints_ - 1) * indexPerSegment, false);
     bufferDirty_ = false;
     forceUpdate_ = false;
 
-    auto* dest = (float*)vertexBuffer_->Lock(0, (numPoints_ - 1) * vertexPerSegment, true);
-    if (!dest)
-        return;
+    const TrailPoint* firstPoint = points_.Buffer();
+    const unsigned vertexFloats = trailType_ == TT_BONE ? 13 : 10;
+    vertexData_.Resize((numPoints_ - 1) * vertexPerSegment * vertexFloats);
+    float* dest = vertexData_.Buffer();
 
     // Generate trail mesh
     if (trailType_ == TT_FACE_CAMERA)
     {
         for (unsigned i = 0; i < numPoints_; ++i)
         {
-            TrailPoint& point = *sortedPoints_[i];
+            const TrailPoint& point = *sortedPoints_[i];
 
             if (sortedPoints_[i] == &points_.Back()) continue;
 
             // This point
-            float factor = SmoothStep(0.0f, trailLength, point.elapsedLength_);
-            color32 c = endColor_.Lerp(startColor_, factor).ToU32();
-            float width = Lerp(width_ * endScale_, width_ * startScale_, factor);
+            unsigned index = (unsigned)(&point - firstPoint);
+            float factor = pointFactors_[index];
+            color32 c = pointColors_[index];
+            float width = width_ * pointScales_[index];
 
             // Next point
-            float nextFactor = SmoothStep(0.0f, trailLength, point.next_->elapsedLength_);
-            color32 nextC = endColor_.Lerp(startColor_, nextFactor).ToU32();
-            float nextWidth = Lerp(width_ * endScale_, width_ * startScale_, nextFactor);
+            float nextFactor = pointFactors_[index + 1];
+            color32 nextC = pointColors_[index + 1];
+            float nextWidth = width_ * pointScales_[index + 1];
 
             // First row
-            dest[0] = point.position_.x_;
-            dest[1] = point.position_.y_;
-            dest[2] = point.position_.z_;
-            ((color32&)dest[3]) = c;
-            dest[4] = factor;
-            dest[5] = 0.0f;
-            dest[6] = point.forward_.x_;
-            dest[7] = point.forward_.y_;
-            dest[8] = point.forward_.z_;
-            dest[9] = width;
-
-            dest[10] = point.next_->position_.x_;
-            dest[11] = point.next_->position_.y_;
-            dest[12] = point.next_->position_.z_;
-            ((color32&)dest[13]) = nextC;
-            dest[14] = nextFactor;
-            dest[15] = 0.0f;
-            dest[16] = point.next_->forward_.x_;
-            dest[17] = point.next_->forward_.y_;
-            dest[18] = point.next_->forward_.z_;
-            dest[19] = nextWidth;
-
+            WriteFaceCameraVertex(dest, point, c, factor, 0.0f, width);
+            WriteFaceCameraVertex(dest + 10, *point.next_, nextC, nextFactor, 0.0f, nextWidth);
             dest += 20;
 
             // Middle rows
             for (unsigned j = 0; j < (tailColumn_ - 1); ++j)
             {
                 float elapsed = 1.0f / tailColumn_ * (j + 1);
-                float midWidth = width - elapsed * 2.0f * width;
-                float nextMidWidth = nextWidth - elapsed * 2.0f * nextWidth;
-
-                dest[0] = point.position_.x_;
-                dest[1] = point.position_.y_;
-                dest[2] = point.position_.z_;
-                ((color32&)dest[3]) = c;
-                dest[4] = factor;
-                dest[5] = elapsed;
-                dest[6] = point.forward_.x_;
-                dest[7] = point.forward_.y_;
-                dest[8] = point.forward_.z_;
-                dest[9] = midWidth;
-
-                dest[10] = point.next_->position_.x_;
-                dest[11] = point.next_->position_.y_;
-                dest[12] = point.next_->position_.z_;
-                ((color32&)dest[13]) = nextC;
-                dest[14] = nextFactor;
-                dest[15] = elapsed;
-                dest[16] = point.next_->forward_.x_;
-                dest[17] = point.next_->forward_.y_;
-                dest[18] = point.next_->forward_.z_;
-                dest[19] = nextMidWidth;
-
+                WriteFaceCameraVertex(dest, point, c, factor, elapsed, width - elapsed * 2.0f * width);
+                WriteFaceCameraVertex(dest + 10, *point.next_, nextC, nextFactor, elapsed, nextWidth - elapsed * 2.0f * nextWidth);
                 dest += 20;
             }
 
             // Last row
-            dest[0] = point.position_.x_;
-            dest[1] = point.position_.y_;
-            dest[2] = point.position_.z_;
-            ((unsigned&)dest[3]) = c;
-            dest[4] = factor;
-            dest[5] = 1.0f;
-            dest[6] = point.forward_.x_;
-            dest[7] = point.forward_.y_;
-            dest[8] = point.forward_.z_;
-            dest[9] = -width;
-
-            dest[10] = point.next_->position_.x_;
-            dest[11] = point.next_->position_.y_;
-            dest[12] = point.next_->position_.z_;
-            ((unsigned&)dest[13]) = nextC;
-            dest[14] = nextFactor;
-            dest[15] = 1.0f;
-            dest[16] = point.next_->forward_.x_;
-            dest[17] = point.next_->forward_.y_;
-            dest[18] = point.next_->forward_.z_;
-            dest[19] = -nextWidth;
-
+            WriteFaceCameraVertex(dest, point, c, factor, 1.0f, -width);
+            WriteFaceCameraVertex(dest + 10, *point.next_, nextC, nextFactor, 1.0f, -nextWidth);
             dest += 20;
         }
     }
@@ -666,128 +693,61 @@ void RibbonTrail::UpdateVertexBuffer(const FrameInfo& frame)
     {
         for (unsigned i = 0; i < numPoints_; ++i)
         {
-            TrailPoint& point = *sortedPoints_[i];
+            const TrailPoint& point = *sortedPoints_[i];
 
             if (sortedPoints_[i] == &points_.Back()) continue;
 
             // This point
-            float factor = SmoothStep(0.0f, trailLength, point.elapsedLength_);
-            color32 c = endColor_.Lerp(startColor_, factor).ToU32();
+            unsigned index = (unsigned)(&point - firstPoint);
+            float factor = pointFactors_[index];
+            color32 c = pointColors_[index];
 
-            float rightScale = Lerp(endScale_, startScale_, factor);
+            float rightScale = pointScales_[index];
             float shift = (rightScale - 1.0f) / 2.0f;
             float leftScale = 0.0f - shift;
 
             // Next point
-            float nextFactor = SmoothStep(0.0f, trailLength, point.next_->elapsedLength_);
-            color32 nextC = endColor_.Lerp(startColor_, nextFactor).ToU32();
+            float nextFactor = pointFactors_[index + 1];
+            color32 nextC = pointColors_[index + 1];
 
-            float nextRightScale = Lerp(endScale_, startScale_, nextFactor);
+            float nextRightScale = pointScales_[index + 1];
             float nextShift = (nextRightScale - 1.0f) / 2.0f;
             float nextLeftScale = 0.0f - nextShift;
 
             // First row
-            dest[0] = point.position_.x_;
-            dest[1] = point.position_.y_;
-            dest[2] = point.position_.z_;
-            dest[3] = point.forward_.x_;
-            dest[4] = point.forward_.y_;
-            dest[5] = point.forward_.z_;
-            ((color32&)dest[6]) = c;
-            dest[7] = factor;
-            dest[8] = 0.0f;
-            dest[9] = point.parentPos_.x_;
-            dest[10] = point.parentPos_.y_;
-            dest[11] = point.parentPos_.z_;
-            dest[12] = leftScale;
-
-            dest[13] = point.next_->position_.x_;
-            dest[14] = point.next_->position_.y_;
-            dest[15] = point.next_->position_.z_;
-            dest[16] = point.next_->forward_.x_;
-            dest[17] = point.next_->forward_.y_;
-            dest[18] = point.next_->forward_.z_;
-            ((color32&)dest[19]) = nextC;
-            dest[20] = nextFactor;
-            dest[21] = 0.0f;
-            dest[22] = point.next_->parentPos_.x_;
-            dest[23] = point.next_->parentPos_.y_;
-            dest[24] = point.next_->parentPos_.z_;
-            dest[25] = nextLeftScale;
-
+            WriteBoneVertex(dest, point, c, factor, 0.0f, leftScale);
+            WriteBoneVertex(dest + 13, *point.next_, nextC, nextFactor, 0.0f, nextLeftScale);
             dest += 26;
 
             // Middle row
             for (unsigned j = 0; j < (tailColumn_ - 1); ++j)
             {
                 float elapsed = 1.0f / tailColumn_ * (j + 1);
-
-                dest[0] = point.position_.x_;
-                dest[1] = point.position_.y_;
-                dest[2] = point.position_.z_;
-                dest[3] = point.forward_.x_;
-                dest[4] = point.forward_.y_;
-                dest[5] = point.forward_.z_;
-                ((color32&)dest[6]) = c;
-                dest[7] = factor;
-                dest[8] = elapsed;
-                dest[9] = point.parentPos_.x_;
-                dest[10] = point.parentPos_.y_;
-                dest[11] = point.parentPos_.z_;
-                dest[12] = Lerp(leftScale, rightScale, elapsed);
-
-                dest[13] = point.next_->position_.x_;
-                dest[14] = point.next_->position_.y_;
-                dest[15] = point.next_->position_.z_;
-                dest[16] = point.next_->forward_.x_;
-                dest[17] = point.next_->forward_.y_;
-                dest[18] = point.next_->forward_.z_;
-                ((color32&)dest[19]) = nextC;
-                dest[20] = nextFactor;
-                dest[21] = elapsed;
-                dest[22] = point.next_->parentPos_.x_;
-                dest[23] = point.next_->parentPos_.y_;
-                dest[24] = point.next_->parentPos_.z_;
-                dest[25] = Lerp(nextLeftScale, nextRightScale, elapsed);
-
+                WriteBoneVertex(dest, point, c, factor, elapsed, Lerp(leftScale, rightScale, elapsed));
+                WriteBoneVertex(dest + 13, *point.next_, nextC, nextFactor, elapsed, Lerp(nextLeftScale, nextRightScale, elapsed));
                 dest += 26;
             }
 
             // Last row
-            dest[0] = point.position_.x_;
-            dest[1] = point.position_.y_;
-            dest[2] = point.position_.z_;
-            dest[3] = point.forward_.x_;
-            dest[4] = point.forward_.y_;
-            dest[5] = point.forward_.z_;
-            ((color32&)dest[6]) = c;
-            dest[7] = factor;
-            dest[8] = 1.0f;
-            dest[9] = point.parentPos_.x_;
-            dest[10] = point.parentPos_.y_;
-            dest[11] = point.parentPos_.z_;
-            dest[12] = rightScale;
-
-            dest[13] = point.next_->position_.x_;
-            dest[14] = point.next_->position_.y_;
-            dest[15] = point.next_->position_.z_;
-            dest[16] = point.next_->forward_.x_;
-            dest[17] = point.next_->forward_.y_;
-            dest[18] = point.next_->forward_.z_;
-            ((color32&)dest[19]) = nextC;
-            dest[20] = nextFactor;
-            dest[21] = 1.0f;
-            dest[22] = point.next_->parentPos_.x_;
-            dest[23] = point.next_->parentPos_.y_;
-            dest[24] = point.next_->parentPos_.z_;
-            dest[25] = nextRightScale;
-
+            WriteBoneVertex(dest, point, c, factor, 1.0f, rightScale);
+            WriteBoneVertex(dest + 13, *point.next_, nextC, nextFactor, 1.0f, nextRightScale);
             dest += 26;
         }
     }
 
-    vertexBuffer_->Unlock();
-    vertexBuffer_->ClearDataLost();
+    vertexDataDirty_ = true;
+}
+
+void RibbonTrail::UploadVertexData()
+{
+    vertexDataDirty_ = false;
+
+    if (numPoints_ < 2 || vertexData_.Empty())
+        return;
+
+    unsigned vertexPerSegment = 4 + (tailColumn_ - 1) * 2;
+    if (vertexBuffer_->SetDataRange(vertexData_.Buffer(), 0, (numPoints_ - 1) * vertexPerSegment, true))
+        vertexBuffer_->ClearDataLost();
 }
 
 void RibbonTrail::SetLifetime(float time)
@@ -207,8 +207,10 @@ private:
 
     /// Resize RibbonTrail vertex and index buffers.
     void UpdateBufferSize();
-    /// Rewrite RibbonTrail vertex buffer.
-    void UpdateVertexBuffer(const FrameInfo& frame);
+    /// Generate RibbonTrail vertex data. Safe to call from a worker thread.
+    void UpdateVertexData(const FrameInfo& frame);
+    /// Upload generated vertex data to the vertex buffer. Must be called from the main thread.
+    void UploadVertexData();
     /// Update/Rebuild tail mesh only if position changed (called by UpdateBatches()).
     void UpdateTail(float timeStep);
     /// Geometry.
@@ -223,6 +225,16 @@ private:
     bool bufferSizeDirty_;
     /// Vertex buffer needs rewrite flag.
     bool bufferDirty_;
+    /// Generated vertex data needs upload flag.
+    bool vertexDataDirty_;
+    /// Generated vertex data.
+    Vector<float> vertexData_;
+    /// Per-point color factors.
+    Vector<float> pointFactors_;
+    /// Per-point width scales.
+    Vector<float> pointScales_;
+    /// Per-point colors.
+    Vector<color32> pointColors_;
     /// Previous position of tail.
     Vector3 previousPosition_;
     /// Distance between points. Basically is tail length.
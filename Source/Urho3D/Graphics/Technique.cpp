@@ -9,7 +9,10 @@
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Technique.h"
 #include "../GraphicsAPI/ShaderVariation.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
 
@@ -54,6 +57,9 @@ static const char* lightingModeNames[] =
     nullptr
 };
 
+/// Compiled binary technique format version. Increment when the layout changes to invalidate cached files.
+static const u32 TECHNIQUE_BINARY_VERSION = 1;
+
 Pass::Pass(const String& name) :
     blendMode_(BLEND_REPLACE),
     cullMode_(MAX_CULLMODES),
@@ -241,9 +247,151 @@ bool Technique::BeginLoad(Deserializer& source)
 {
     passes_.Clear();
     cloneTechniques_.Clear();
+    saveCacheFileName_.Clear();
 
     SetMemoryUse(sizeof(Technique));
 
+    // Compiled binary techniques need no parsing
+    i64 start = source.GetPosition();
+    String fileID = source.ReadFileID();
+    source.Seek(start);
+    if (fileID == "UTEC")
+        return LoadBinary(source);
+
+    String cacheFileName = GetSubsystem<ResourceCache>()->GetCompiledCacheFileName(GetName(), ".utec");
+    if (cacheFileName.Empty())
+        return LoadXML(source);
+
+    Vector<byte> sourceData((i32)source.GetSize());
+    if (!sourceData.Empty())
+        source.Read(sourceData.Buffer(), sourceData.Size());
+    hash32 sourceHash = StringHash::CalculateData(sourceData.Buffer(), sourceData.Size());
+
+    if (GetSubsystem<FileSystem>()->FileExists(cacheFileName))
+    {
+        File cacheFile(context_, cacheFileName);
+        if (cacheFile.ReadFileID() == "UTEC" && cacheFile.ReadU32() == TECHNIQUE_BINARY_VERSION &&
+            cacheFile.ReadString() == GetName() && cacheFile.ReadI32() == sourceData.Size() && cacheFile.ReadU32() == sourceHash)
+        {
+            cacheFile.Seek(0);
+            if (LoadBinary(cacheFile))
+                return true;
+        }
+    }
+
+    // Missing or stale cache, load the source. The cache is rewritten in EndLoad(), as this may be a worker thread
+    MemoryBuffer sourceBuffer(sourceData);
+    sourceBuffer.SetName(source.GetName());
+    if (!LoadXML(sourceBuffer))
+        return false;
+
+    saveCacheFileName_ = cacheFileName;
+    sourceHash_ = sourceHash;
+    sourceSize_ = sourceData.Size();
+    return true;
+}
+
+bool Technique::EndLoad()
+{
+    if (!saveCacheFileName_.Empty())
+    {
+        File cacheFile(context_);
+        if (cacheFile.Open(saveCacheFileName_, FILE_WRITE))
+            SaveBinary(cacheFile, sourceHash_, sourceSize_);
+        saveCacheFileName_.Clear();
+    }
+
+    return true;
+}
+
+bool Technique::LoadBinary(Deserializer& source)
+{
+    passes_.Clear();
+    cloneTechniques_.Clear();
+
+    if (source.ReadFileID() != "UTEC")
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid compiled technique file");
+        return false;
+    }
+
+    u32 version = source.ReadU32();
+    if (version != TECHNIQUE_BINARY_VERSION)
+    {
+        URHO3D_LOGERROR("Unsupported compiled technique version " + String(version) + " in " + source.GetName());
+        return false;
+    }
+
+    // Source name, size and hash are only needed for validating the compiled cache
+    source.ReadString();
+    source.ReadI32();
+    source.ReadU32();
+
+    isDesktop_ = source.ReadBool();
+
+    // Passes are stored with global shaders and defines already merged in
+    unsigned numPasses = source.ReadVLE();
+    for (unsigned i = 0; i < numPasses; ++i)
+    {
+        Pass* newPass = CreatePass(source.ReadString());
+        newPass->SetIsDesktop(source.ReadBool());
+        newPass->SetVertexShader(source.ReadString());
+        newPass->SetPixelShader(source.ReadString());
+        newPass->SetVertexShaderDefines(source.ReadString());
+        newPass->SetPixelShaderDefines(source.ReadString());
+        newPass->SetVertexShaderDefineExcludes(source.ReadString());
+        newPass->SetPixelShaderDefineExcludes(source.ReadString());
+        newPass->SetLightingMode((PassLightingMode)source.ReadU8());
+        newPass->SetBlendMode((BlendMode)source.ReadU8());
+        newPass->SetCullMode((CullMode)source.ReadU8());
+        newPass->SetDepthTestMode((CompareMode)source.ReadU8());
+        newPass->SetDepthWrite(source.ReadBool());
+        newPass->SetAlphaToCoverage(source.ReadBool());
+    }
+
+    return true;
+}
+
+bool Technique::SaveBinary(Serializer& dest, hash32 sourceHash, i32 sourceSize) const
+{
+    if (!dest.WriteFileID("UTEC"))
+    {
+        URHO3D_LOGERROR("Can not save compiled technique");
+        return false;
+    }
+
+    dest.WriteU32(TECHNIQUE_BINARY_VERSION);
+    dest.WriteString(GetName());
+    dest.WriteI32(sourceSize);
+    dest.WriteU32(sourceHash);
+
+    dest.WriteBool(isDesktop_);
+
+    Vector<Pass*> passes = GetPasses();
+    dest.WriteVLE(passes.Size());
+    for (Pass* pass : passes)
+    {
+        dest.WriteString(pass->GetName());
+        dest.WriteBool(pass->IsDesktop());
+        dest.WriteString(pass->GetVertexShader());
+        dest.WriteString(pass->GetPixelShader());
+        dest.WriteString(pass->GetVertexShaderDefines());
+        dest.WriteString(pass->GetPixelShaderDefines());
+        dest.WriteString(pass->GetVertexShaderDefineExcludes());
+        dest.WriteString(pass->GetPixelShaderDefineExcludes());
+        dest.WriteU8((u8)pass->GetLightingMode());
+        dest.WriteU8((u8)pass->GetBlendMode());
+        dest.WriteU8((u8)pass->GetCullMode());
+        dest.WriteU8((u8)pass->GetDepthTestMode());
+        dest.WriteBool(pass->GetDepthWrite());
+        dest.WriteBool(pass->GetAlphaToCoverage());
+    }
+
+    return true;
+}
+
+bool Technique::LoadXML(Deserializer& source)
+{
     SharedPtr<XMLFile> xml(new XMLFile(context_));
     if (!xml->Load(source))
         return false;
@@ -211,6 +211,13 @@ public:
 
     /// Load resource from stream. May be called from a worker thread. Return true if successful.
     bool BeginLoad(Deserializer& source) override;
+    /// Finish resource loading. Always called from the main thread. Return true if successful.
+    bool EndLoad() override;
+
+    /// Load from compiled binary data. Return true if successful.
+    bool LoadBinary(Deserializer& source);
+    /// Save to compiled binary data. The source hash is used by the compiled resource cache to detect changes. Return true if successful.
+    bool SaveBinary(Serializer& dest, hash32 sourceHash = 0, i32 sourceSize = 0) const;
 
     /// Set whether requires desktop level hardware.
     /// @property{set_desktop}
@@ -297,6 +304,9 @@ public:
     static i32 shadowPassIndex;
 
 private:
+    /// Load from XML data. Return true if successful.
+    bool LoadXML(Deserializer& source);
+
     /// Require desktop GPU flag.
     bool isDesktop_;
     /// Cached desktop GPU support flag.
@@ -305,6 +315,12 @@ private:
     Vector<SharedPtr<Pass>> passes_;
     /// Cached clones with added shader compilation defines.
     HashMap<Pair<StringHash, StringHash>, SharedPtr<Technique>> cloneTechniques_;
+    /// Compiled cache file to write after loading from XML, empty if none.
+    String saveCacheFileName_;
+    /// Hash of the source data for the compiled cache.
+    hash32 sourceHash_{};
+    /// Size of the source data for the compiled cache.
+    i32 sourceSize_{};
 
     /// Pass index assignments.
     static HashMap<String, i32> passIndices;
@@ -0,0 +1,446 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../Precompiled.h"
+
+#include "../Graphics/TriangleBVH.h"
+#include "../Math/Frustum.h"
+#include "../Math/Ray.h"
+
+#include <algorithm>
+
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Maximum number of triangles in a leaf node. Matches the SIMD width of the ray test.
+static const i32 MAX_LEAF_TRIANGLES = 4;
+/// Number of components stored per triangle for ray tests: first vertex, first edge and second edge.
+static const i32 NUM_TRIANGLE_COMPONENTS = 9;
+
+/// Return reciprocal of a ray direction component, or zero for a ray parallel to the axis.
+static inline float GetInverseDirection(float value)
+{
+    return Abs(value) < M_EPSILON ? 0.0f : 1.0f / value;
+}
+
+/// Narrow the ray's entry and exit distances by the box's extent on one axis. Return false if the ray misses the extent.
+static inline bool ClipBoxAxis(float origin, float invDirection, float min, float max, float& tMin, float& tMax)
+{
+    // A parallel ray is either inside the extent for its whole length or misses it. Testing this directly keeps rays lying
+    // exactly on a box face from missing, as triangles on the face are still hit
+    if (invDirection == 0.0f)
+        return origin >= min && origin <= max;
+
+    float t1 = (min - origin) * invDirection;
+    float t2 = (max - origin) * invDirection;
+    tMin = Max(tMin, Min(t1, t2));
+    tMax = Min(tMax, Max(t1, t2));
+    return true;
+}
+
+/// Return distance to where the ray enters the box, or infinity if it misses, using precalculated reciprocal direction.
+static inline float HitBoxDistance(const Vector3& origin, const Vector3& invDirection, const BoundingBox& box)
+{
+    float tMin = -M_INFINITY;
+    float tMax = M_INFINITY;
+
+    if (!ClipBoxAxis(origin.x_, invDirection.x_, box.min_.x_, box.max_.x_, tMin, tMax) ||
+        !ClipBoxAxis(origin.y_, invDirection.y_, box.min_.y_, box.max_.y_, tMin, tMax) ||
+        !ClipBoxAxis(origin.z_, invDirection.z_, box.min_.z_, box.max_.z_, tMin, tMax))
+        return M_INFINITY;
+
+    if (tMax < 0.0f || tMin > tMax)
+        return M_INFINITY;
+    return Max(tMin, 0.0f);
+}
+
+bool TriangleBVH::Build(const byte* vertexData, i32 vertexSize, const byte* indexData, i32 indexSize, i32 indexStart,
+    i32 indexCount)
+{
+    nodes_.Clear();
+    indices_.Clear();
+    triangleData_.Clear();
+
+    if (!vertexData || !indexData || !vertexSize || indexCount < 3)
+        return false;
+
+    Vector<u32> triangles;
+    triangles.Resize(indexCount / 3 * 3);
+
+    if (indexSize == sizeof(u16))
+    {
+        const u16* indices = reinterpret_cast<const u16*>(indexData) + indexStart;
+        for (i32 i = 0; i < triangles.Size(); ++i)
+            triangles[i] = indices[i];
+    }
+    else
+    {
+        const u32* indices = reinterpret_cast<const u32*>(indexData) + indexStart;
+        for (i32 i = 0; i < triangles.Size(); ++i)
+            triangles[i] = indices[i];
+    }
+
+    return BuildFromIndices(vertexData, vertexSize, triangles);
+}
+
+bool TriangleBVH::Build(const byte* vertexData, i32 vertexSize, i32 vertexStart, i32 vertexCount)
+{
+    nodes_.Clear();
+    indices_.Clear();
+    triangleData_.Clear();
+
+    if (!vertexData || !vertexSize || vertexCount < 3)
+        return false;
+
+    Vector<u32> triangles;
+    triangles.Resize(vertexCount / 3 * 3);
+    for (i32 i = 0; i < triangles.Size(); ++i)
+        triangles[i] = (u32)(vertexStart + i);
+
+    return BuildFromIndices(vertexData, vertexSize, triangles);
+}
+
+void TriangleBVH::GetTriangles(Vector<u32>& result, const Frustum& frustum) const
+{
+    if (nodes_.Empty())
+        return;
+
+    // Iterative traversal with a small explicit stack. Fully inside subtrees are added without further tests
+    i32 stack[64];
+    bool insideStack[64];
+    i32 stackSize = 0;
+    stack[stackSize] = 0;
+    insideStack[stackSize++] = false;
+
+    while (stackSize)
+    {
+        --stackSize;
+        i32 index = stack[stackSize];
+        bool inside = insideStack[stackSize];
+        const Node& node = nodes_[index];
+
+        if (!inside)
+        {
+            Intersection intersection = frustum.IsInside(node.box_);
+            if (intersection == OUTSIDE)
+                continue;
+            inside = intersection == INSIDE;
+        }
+
+        if (node.count_)
+            AddLeafTriangles(result, node);
+        else
+        {
+            stack[stackSize] = node.first_;
+            insideStack[stackSize++] = inside;
+            stack[stackSize] = index + 1;
+            insideStack[stackSize++] = inside;
+        }
+    }
+}
+
+float TriangleBVH::GetHitDistance(const Ray& ray, i32* outTriangle) const
+{
+    float nearest = M_INFINITY;
+    i32 nearestTriangle = NINDEX;
+
+    if (nodes_.Size())
+    {
+        const Vector3& origin = ray.origin_;
+        Vector3 invDirection(GetInverseDirection(ray.direction_.x_), GetInverseDirection(ray.direction_.y_),
+            GetInverseDirection(ray.direction_.z_));
+
+        // Front-to-back traversal. Subtrees entered beyond the nearest hit so far are skipped
+        i32 stack[64];
+        float distanceStack[64];
+        i32 stackSize = 0;
+
+        float rootDistance = HitBoxDistance(origin, invDirection, nodes_[0].box_);
+        if (rootDistance < M_INFINITY)
+        {
+            stack[stackSize] = 0;
+            distanceStack[stackSize++] = rootDistance;
+        }
+
+        while (stackSize)
+        {
+            --stackSize;
+            if (distanceStack[stackSize] >= nearest)
+                continue;
+
+            i32 index = stack[stackSize];
+            const Node& node = nodes_[index];
+
+            if (node.count_)
+            {
+                HitLeafTriangles(ray, node, nearest, nearestTriangle);
+                continue;
+            }
+
+            i32 left = index + 1;
+            i32 right = node.first_;
+            float leftDistance = HitBoxDistance(origin, invDirection, nodes_[left].box_);
+            float rightDistance = HitBoxDistance(origin, invDirection, nodes_[right].box_);
+
+            // Push the farther child first so that the nearer one is visited first
+            if (leftDistance > rightDistance)
+            {
+                Swap(left, right);
+                Swap(leftDistance, rightDistance);
+            }
+            if (rightDistance < nearest)
+            {
+                stack[stackSize] = right;
+                distanceStack[stackSize++] = rightDistance;
+            }
+            if (leftDistance < nearest)
+            {
+                stack[stackSize] = left;
+                distanceStack[stackSize++] = leftDistance;
+            }
+        }
+    }
+
+    if (outTriangle)
+        *outTriangle = nearestTriangle;
+    return nearest;
+}
+
+void TriangleBVH::GetTriangles(Vector<u32>& result, const BoundingBox& box) const
+{
+    if (nodes_.Empty())
+        return;
+
+    i32 stack[64];
+    i32 stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize)
+    {
+        i32 index = stack[--stackSize];
+        const Node& node = nodes_[index];
+        if (box.IsInsideFast(node.box_) == OUTSIDE)
+            continue;
+
+        if (node.count_)
+            AddLeafTriangles(result, node);
+        else
+        {
+            stack[stackSize++] = node.first_;
+            stack[stackSize++] = index + 1;
+        }
+    }
+}
+
+bool TriangleBVH::BuildFromIndices(const byte* vertexData, i32 vertexSize, Vector<u32>& triangles)
+{
+    i32 numTriangles = triangles.Size() / 3;
+    if (!numTriangles)
+        return false;
+
+    Vector<BoundingBox> boxes(numTriangles);
+    Vector<Vector3> centers(numTriangles);
+    Vector<i32> order(numTriangles);
+
+    for (i32 i = 0; i < numTriangles; ++i)
+    {
+        const Vector3& v0 = *reinterpret_cast<const Vector3*>(vertexData + triangles[i * 3] * vertexSize);
+        const Vector3& v1 = *reinterpret_cast<const Vector3*>(vertexData + triangles[i * 3 + 1] * vertexSize);
+        const Vector3& v2 = *reinterpret_cast<const Vector3*>(vertexData + triangles[i * 3 + 2] * vertexSize);
+        boxes[i] = BoundingBox(v0, v0);
+        boxes[i].Merge(v1);
+        boxes[i].Merge(v2);
+        centers[i] = boxes[i].Center();
+        order[i] = i;
+    }
+
+    // A balanced tree has at most 2 * (leaves) - 1 nodes
+    nodes_.Reserve(2 * ((numTriangles + MAX_LEAF_TRIANGLES - 1) / MAX_LEAF_TRIANGLES) + 1);
+    BuildNode(order, 0, numTriangles, boxes, centers);
+
+    // Store triangle vertex indices in leaf order so that each leaf references a contiguous range
+    indices_.Resize(numTriangles * 3);
+    for (i32 i = 0; i < numTriangles; ++i)
+    {
+        i32 src = order[i] * 3;
+        indices_[i * 3] = triangles[src];
+        indices_[i * 3 + 1] = triangles[src + 1];
+        indices_[i * 3 + 2] = triangles[src + 2];
+    }
+
+    // Store the ray test data in the same order. The padding consists of degenerate triangles that never report a hit
+    triangleDataStride_ = numTriangles + MAX_LEAF_TRIANGLES - 1;
+    triangleData_.Resize(triangleDataStride_ * NUM_TRIANGLE_COMPONENTS);
+    for (float& value : triangleData_)
+        value = 0.0f;
+
+    float* data = triangleData_.Buffer();
+    for (i32 i = 0; i < numTriangles; ++i)
+    {
+        const Vector3& v0 = *reinterpret_cast<const Vector3*>(vertexData + indices_[i * 3] * vertexSize);
+        const Vector3& v1 = *reinterpret_cast<const Vector3*>(vertexData + indices_[i * 3 + 1] * vertexSize);
+        const Vector3& v2 = *reinterpret_cast<const Vector3*>(vertexData + indices_[i * 3 + 2] * vertexSize);
+        Vector3 edge1 = v1 - v0;
+        Vector3 edge2 = v2 - v0;
+        const float components[NUM_TRIANGLE_COMPONENTS] = {v0.x_, v0.y_, v0.z_, edge1.x_, edge1.y_, edge1.z_, edge2.x_, edge2.y_,
+            edge2.z_};
+        for (i32 j = 0; j < NUM_TRIANGLE_COMPONENTS; ++j)
+            data[j * triangleDataStride_ + i] = components[j];
+    }
+
+    return true;
+}
+
+i32 TriangleBVH::BuildNode(Vector<i32>& order, i32 first, i32 count, const Vector<BoundingBox>& boxes,
+    const Vector<Vector3>& centers)
+{
+    i32 nodeIndex = nodes_.Size();
+    nodes_.Resize(nodeIndex + 1);
+
+    BoundingBox box;
+    BoundingBox centerBox;
+    for (i32 i = first; i < first + count; ++i)
+    {
+        box.Merge(boxes[order[i]]);
+        centerBox.Merge(centers[order[i]]);
+    }
+
+    nodes_[nodeIndex].box_ = box;
+
+    if (count <= MAX_LEAF_TRIANGLES)
+    {
+        nodes_[nodeIndex].first_ = first;
+        nodes_[nodeIndex].count_ = count;
+        return nodeIndex;
+    }
+
+    // Split at the median along the longest axis of the triangle centers. This keeps the tree balanced and the depth
+    // logarithmic, which bounds the traversal stack
+    Vector3 size = centerBox.Size();
+    i32 axis = 0;
+    if (size.y_ > size.x_)
+        axis = 1;
+    if (size.z_ > size.Data()[axis])
+        axis = 2;
+
+    i32 half = count / 2;
+    i32* start = &order[first];
+    std::nth_element(start, start + half, start + count,
+        [&centers, axis](i32 lhs, i32 rhs) { return centers[lhs].Data()[axis] < centers[rhs].Data()[axis]; });
+
+    BuildNode(order, first, half, boxes, centers);
+    i32 right = BuildNode(order, first + half, count - half, boxes, centers);
+
+    // The node array may have been reallocated by the recursive calls
+    nodes_[nodeIndex].first_ = right;
+    nodes_[nodeIndex].count_ = 0;
+    return nodeIndex;
+}
+
+void TriangleBVH::AddLeafTriangles(Vector<u32>& result, const Node& node) const
+{
+    const u32* start = &indices_[node.first_ * 3];
+    result.Insert(result.End(), start, start + node.count_ * 3);
+}
+
+void TriangleBVH::HitLeafTriangles(const Ray& ray, const Node& node, float& nearest, i32& nearestTriangle) const
+{
+    // Same Moller-Trumbore test as Ray::HitDistance(), including the backface rejection
+    const float* data = triangleData_.Buffer() + node.first_;
+    const i32 stride = triangleDataStride_;
+
+#ifdef URHO3D_SSE
+    // Test all triangles of the leaf at once. Lanes past the leaf's own triangles test the next triangles in order, which
+    // are still valid hits, or the degenerate padding
+    __m128 ox = _mm_set1_ps(ray.origin_.x_);
+    __m128 oy = _mm_set1_ps(ray.origin_.y_);
+    __m128 oz = _mm_set1_ps(ray.origin_.z_);
+    __m128 dx = _mm_set1_ps(ray.direction_.x_);
+    __m128 dy = _mm_set1_ps(ray.direction_.y_);
+    __m128 dz = _mm_set1_ps(ray.direction_.z_);
+
+    __m128 v0x = _mm_loadu_ps(data);
+    __m128 v0y = _mm_loadu_ps(data + stride);
+    __m128 v0z = _mm_loadu_ps(data + stride * 2);
+    __m128 e1x = _mm_loadu_ps(data + stride * 3);
+    __m128 e1y = _mm_loadu_ps(data + stride * 4);
+    __m128 e1z = _mm_loadu_ps(data + stride * 5);
+    __m128 e2x = _mm_loadu_ps(data + stride * 6);
+    __m128 e2y = _mm_loadu_ps(data + stride * 7);
+    __m128 e2z = _mm_loadu_ps(data + stride * 8);
+
+    // p = direction x edge2
+    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+    // t = origin - v0, q = t x edge1
+    __m128 tx = _mm_sub_ps(ox, v0x);
+    __m128 ty = _mm_sub_ps(oy, v0y);
+    __m128 tz = _mm_sub_ps(oz, v0z);
+    __m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz));
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+    __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz));
+    __m128 n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz));
+
+    __m128 zero = _mm_setzero_ps();
+    __m128 mask = _mm_cmpge_ps(det, _mm_set1_ps(M_EPSILON));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+    mask = _mm_and_ps(mask, _mm_cmple_ps(u, det));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+    mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), det));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(n, zero));
+
+    int hits = _mm_movemask_ps(mask);
+    if (!hits)
+        return;
+
+    alignas(16) float distances[4];
+    _mm_store_ps(distances, _mm_div_ps(n, det));
+    for (i32 i = 0; i < 4; ++i)
+    {
+        if ((hits & (1 << i)) && distances[i] < nearest)
+        {
+            nearest = distances[i];
+            nearestTriangle = node.first_ + i;
+        }
+    }
+#else
+    for (i32 i = 0; i < node.count_; ++i)
+    {
+        Vector3 v0(data[i], data[stride + i], data[stride * 2 + i]);
+        Vector3 edge1(data[stride * 3 + i], data[stride * 4 + i], data[stride * 5 + i]);
+        Vector3 edge2(data[stride * 6 + i], data[stride * 7 + i], data[stride * 8 + i]);
+
+        Vector3 p(ray.direction_.CrossProduct(edge2));
+        float det = edge1.DotProduct(p);
+        if (det < M_EPSILON)
+            continue;
+        Vector3 t(ray.origin_ - v0);
+        float u = t.DotProduct(p);
+        if (u < 0.0f || u > det)
+            continue;
+        Vector3 q(t.CrossProduct(edge1));
+        float v = ray.direction_.DotProduct(q);
+        if (v < 0.0f || u + v > det)
+            continue;
+        float distance = edge2.DotProduct(q) / det;
+        if (distance >= 0.0f && distance < nearest)
+        {
+            nearest = distance;
+            nearestTriangle = node.first_ + i;
+        }
+    }
+#endif
+}
+
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "../Container/RefCounted.h"
+#include "../Container/Vector.h"
+#include "../Math/BoundingBox.h"
+
+namespace Urho3D
+{
+
+class Frustum;
+class Ray;
+
+/// Bounding volume hierarchy over the triangles of a geometry's CPU-side vertex and index data, for fast spatial queries.
+/// @nobind
+class URHO3D_API TriangleBVH : public RefCounted
+{
+public:
+    /// Construct empty.
+    TriangleBVH() = default;
+
+    /// Build from indexed triangle list data. Positions must be Vector3 at the start of each vertex. Return true if any triangles were added.
+    bool Build(const byte* vertexData, i32 vertexSize, const byte* indexData, i32 indexSize, i32 indexStart, i32 indexCount);
+    /// Build from non-indexed triangle list data. Positions must be Vector3 at the start of each vertex. Return true if any triangles were added.
+    bool Build(const byte* vertexData, i32 vertexSize, i32 vertexStart, i32 vertexCount);
+
+    /// Return vertex index triplets of triangles whose leaf bounds intersect the frustum. Appends to the result.
+    void GetTriangles(Vector<u32>& result, const Frustum& frustum) const;
+    /// Return vertex index triplets of triangles whose leaf bounds intersect the box. Appends to the result.
+    void GetTriangles(Vector<u32>& result, const BoundingBox& box) const;
+    /// Return distance to the nearest front-facing triangle hit by the ray, or infinity if no hit. Optionally return the hit triangle's index for GetTriangleVertices().
+    float GetHitDistance(const Ray& ray, i32* outTriangle = nullptr) const;
+    /// Return the vertex index triplet of a triangle.
+    const u32* GetTriangleVertices(i32 triangle) const { return &indices_[triangle * 3]; }
+
+    /// Return bounding box of all triangles.
+    const BoundingBox& GetBoundingBox() const { return nodes_.Size() ? nodes_[0].box_ : emptyBox_; }
+    /// Return number of triangles.
+    i32 GetNumTriangles() const { return indices_.Size() / 3; }
+    /// Return number of nodes.
+    i32 GetNumNodes() const { return nodes_.Size(); }
+    /// Return approximate memory use in bytes.
+    i32 GetMemoryUse() const
+    {
+        return sizeof(TriangleBVH) + nodes_.Capacity() * sizeof(Node) + indices_.Capacity() * sizeof(u32) +
+            triangleData_.Capacity() * sizeof(float);
+    }
+
+private:
+    /// Tree node. Interior nodes have the left child immediately after them.
+    struct Node
+    {
+        /// Bounds of all triangles below the node.
+        BoundingBox box_;
+        /// First triangle for leaves, right child index for interior nodes.
+        i32 first_;
+        /// Number of triangles for leaves, zero for interior nodes.
+        i32 count_;
+    };
+
+    /// Build from gathered triangle vertex indices.
+    bool BuildFromIndices(const byte* vertexData, i32 vertexSize, Vector<u32>& triangles);
+    /// Build a subtree recursively and return its node index.
+    i32 BuildNode(Vector<i32>& order, i32 first, i32 count, const Vector<BoundingBox>& boxes, const Vector<Vector3>& centers);
+    /// Append leaf triangles to the result.
+    void AddLeafTriangles(Vector<u32>& result, const Node& node) const;
+    /// Test the ray against leaf triangles and update the nearest hit.
+    void HitLeafTriangles(const Ray& ray, const Node& node, float& nearest, i32& nearestTriangle) const;
+
+    /// Nodes, root first.
+    Vector<Node> nodes_;
+    /// Triangle vertex indices in leaf order.
+    Vector<u32> indices_;
+    /// First vertex and the two edges of each triangle in leaf order, one array per component for SIMD ray tests. Padded to allow loading four triangles from any leaf.
+    Vector<float> triangleData_;
+    /// Size of each component array in triangleData_.
+    i32 triangleDataStride_{};
+    /// Empty bounding box to return when not built.
+    BoundingBox emptyBox_;
+};
+
+}
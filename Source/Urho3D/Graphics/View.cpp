@@ -3,6 +3,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Sort.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
@@ -873,7 +874,9 @@ void View::GetDrawables()
         octree_->GetDrawables(query);
     }
 
-    // Check drawable occlusion, find zones for moved drawables and collect geometries & lights in worker threads
+    // Check drawable occlusion, find zones for moved drawables and collect geometries & lights in worker threads.
+    // The zone index is shared by all views of the octree and only rebuilt when zones have changed
+    octree_->UpdateZoneIndex();
     {
         for (PerThreadSceneResult& result : sceneResults_)
         {
@@ -883,30 +886,8 @@ void View::GetDrawables()
             result.maxZ_ = 0.0f;
         }
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = tempDrawables.Size() / numWorkItems;
-
-        Vector<Drawable*>::Iterator start = tempDrawables.Begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
-        {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = WI_MAX_PRIORITY;
-            item->workFunction_ = CheckVisibilityWork;
-            item->aux_ = this;
-
-            Vector<Drawable*>::Iterator end = tempDrawables.End();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
-
-        queue->Complete(WI_MAX_PRIORITY);
+        // One range of drawables for each thread
+        queue->RunParallel(CheckVisibilityWork, tempDrawables.Buffer(), tempDrawables.Size(), 0, this);
     }
 
     // Combine lights, geometries & scene Z range from the threads
@@ -970,21 +951,10 @@ void View::ProcessLights()
     lightQueryResults_.Resize(lights_.Size());
 
     for (i32 i = 0; i < lightQueryResults_.Size(); ++i)
-    {
-        SharedPtr<WorkItem> item = queue->GetFreeItem();
-        item->priority_ = WI_MAX_PRIORITY;
-        item->workFunction_ = ProcessLightWork;
-        item->aux_ = this;
-
-        LightQueryResult& query = lightQueryResults_[i];
-        query.light_ = lights_[i];
-
-        item->start_ = &query;
-        queue->AddWorkItem(item);
-    }
+        lightQueryResults_[i].light_ = lights_[i];
 
-    // Ensure all lights have been processed before proceeding
-    queue->Complete(WI_MAX_PRIORITY);
+    // One work item per light, and all processed before proceeding
+    queue->RunParallel(ProcessLightWork, lightQueryResults_.Buffer(), lightQueryResults_.Size(), lightQueryResults_.Size(), this);
 }
 
 void View::GetLightBatches()
@@ -1008,6 +978,8 @@ void View::GetLightBatches()
         maxLightsDrawables_.Clear();
         i32 maxSortedInstances = renderer_->GetMaxSortedInstances();
 
+        AllocateShadowAtlasRegions();
+
         for (Vector<LightQueryResult>::Iterator i = lightQueryResults_.Begin(); i != lightQueryResults_.End(); ++i)
         {
             LightQueryResult& query = *i;
@@ -1029,6 +1001,7 @@ void View::GetLightBatches()
                 lightQueue.light_ = light;
                 lightQueue.negative_ = light->IsNegative();
                 lightQueue.shadowMap_ = nullptr;
+                lightQueue.shadowAtlasKey_ = 0;
                 lightQueue.litBaseBatches_.Clear(maxSortedInstances);
                 lightQueue.litBatches_.Clear(maxSortedInstances);
                 if (forwardLightsCommand_)
@@ -1043,10 +1016,24 @@ void View::GetLightBatches()
                 }
                 lightQueue.volumeBatches_.Clear();
 
-                // Allocate shadow map now
+                // Allocate shadow map now, unless already allocated from the shadow atlas. Lights that did not fit into
+                // the atlas get a shadow map of their own
+                IntRect shadowMapRegion;
                 if (shadowSplits > 0)
                 {
-                    lightQueue.shadowMap_ = renderer_->GetShadowMap(light, cullCamera_, viewSize_.x_, viewSize_.y_);
+                    if (query.shadowAtlasRegion_.Width())
+                    {
+                        lightQueue.shadowMap_ = renderer_->GetShadowAtlas();
+                        lightQueue.shadowAtlasKey_ = query.shadowAtlasKey_;
+                        shadowMapRegion = query.shadowAtlasRegion_;
+                    }
+                    else
+                    {
+                        lightQueue.shadowMap_ = renderer_->GetShadowMap(light, cullCamera_, viewSize_.x_, viewSize_.y_);
+                        if (lightQueue.shadowMap_)
+                            shadowMapRegion = IntRect(0, 0, lightQueue.shadowMap_->GetWidth(), lightQueue.shadowMap_->GetHeight());
+                    }
+
                     // If did not manage to get a shadow map, convert the light to unshadowed
                     if (!lightQueue.shadowMap_)
                         shadowSplits = 0;
@@ -1064,7 +1051,7 @@ void View::GetLightBatches()
                     shadowQueue.shadowBatches_.Clear(maxSortedInstances);
 
                     // Setup the shadow split viewport and finalize shadow camera parameters
-                    shadowQueue.shadowViewport_ = GetShadowMapViewport(light, j, lightQueue.shadowMap_);
+                    shadowQueue.shadowViewport_ = GetShadowMapViewport(light, j, shadowMapRegion);
                     FinalizeShadowCamera(shadowCamera, light, shadowQueue.shadowViewport_, query.shadowCasterBox_[j]);
 
                     // Loop through shadow casters
@@ -1356,6 +1343,14 @@ void View::UpdateGeometries()
 
     // Finally ensure all threaded work has completed
     queue->Complete(WI_MAX_PRIORITY);
+
+    // Drawables that generated their data on a worker thread may still need to upload it to the GPU
+    for (Vector<Drawable*>::ConstIterator i = threadedGeometries_.Begin(); i != threadedGeometries_.End(); ++i)
+    {
+        if (*i && (*i)->GetUpdateGeometryType() == UPDATE_MAIN_THREAD)
+            (*i)->UpdateGeometry(frame_);
+    }
+
     geometriesUpdated_ = true;
 }
 
@@ -2288,29 +2283,22 @@ void View::ProcessLight(LightQueryResult& query, i32 threadIndex)
         break;
 
     case LIGHT_SPOT:
-        {
-            FrustumOctreeQuery octreeQuery(tempDrawables, light->GetFrustum(), DrawableTypes::Geometry,
-                cullCamera_->GetViewMask());
-            octree_->GetDrawables(octreeQuery);
-
-            for (Drawable* tempDrawable : tempDrawables)
-            {
-                if (tempDrawable->IsInView(frame_) && (GetLightMask(tempDrawable) & lightMask))
-                    query.litGeometries_.Push(tempDrawable);
-            }
-        }
-        break;
-
     case LIGHT_POINT:
         {
-            SphereOctreeQuery octreeQuery(tempDrawables, Sphere(light->GetNode()->GetWorldPosition(), light->GetRange()),
-                DrawableTypes::Geometry, cullCamera_->GetViewMask());
-            octree_->GetDrawables(octreeQuery);
+            // The light volume query does not depend on the camera and is cached, so only filter it by view here.
+            // Drawables outside the view are kept for shadow casting
+            const Vector<Drawable*>& volumeDrawables = light->GetVolumeDrawables(octree_);
+            unsigned viewMask = cullCamera_->GetViewMask();
+            tempDrawables.Clear();
 
-            for (Drawable* tempDrawable : tempDrawables)
+            for (Drawable* volumeDrawable : volumeDrawables)
             {
-                if (tempDrawable->IsInView(frame_) && (GetLightMask(tempDrawable) & lightMask))
-                    query.litGeometries_.Push(tempDrawable);
+                if (!(volumeDrawable->GetViewMask() & viewMask))
+                    continue;
+
+                tempDrawables.Push(volumeDrawable);
+                if (volumeDrawable->IsInView(frame_) && (GetLightMask(volumeDrawable) & lightMask))
+                    query.litGeometries_.Push(volumeDrawable);
             }
         }
         break;
@@ -2475,10 +2463,12 @@ bool View::IsShadowCasterVisible(Drawable* drawable, BoundingBox lightViewBox, C
     }
 }
 
-IntRect View::GetShadowMapViewport(Light* light, int splitIndex, Texture2D* shadowMap)
+IntRect View::GetShadowMapViewport(Light* light, int splitIndex, const IntRect& region)
 {
-    int width = shadowMap->GetWidth();
-    int height = shadowMap->GetHeight();
+    int x = region.left_;
+    int y = region.top_;
+    int width = region.Width();
+    int height = region.Height();
 
     switch (light->GetLightType())
     {
@@ -2486,25 +2476,100 @@ IntRect View::GetShadowMapViewport(Light* light, int splitIndex, Texture2D* shad
         {
             int numSplits = light->GetNumShadowSplits();
             if (numSplits == 1)
-                return {0, 0, width, height};
+                return region;
             else if (numSplits == 2)
-                return {splitIndex * width / 2, 0, (splitIndex + 1) * width / 2, height};
+                return {x + splitIndex * width / 2, y, x + (splitIndex + 1) * width / 2, y + height};
             else
-                return {(splitIndex & 1) * width / 2, (splitIndex / 2) * height / 2,
-                    ((splitIndex & 1) + 1) * width / 2, (splitIndex / 2 + 1) * height / 2};
+                return {x + (splitIndex & 1) * width / 2, y + (splitIndex / 2) * height / 2,
+                    x + ((splitIndex & 1) + 1) * width / 2, y + (splitIndex / 2 + 1) * height / 2};
         }
 
     case LIGHT_SPOT:
-        return {0, 0, width, height};
+        return region;
 
     case LIGHT_POINT:
-        return {(splitIndex & 1) * width / 2, (splitIndex / 2) * height / 3,
-            ((splitIndex & 1) + 1) * width / 2, (splitIndex / 2 + 1) * height / 3};
+        return {x + (splitIndex & 1) * width / 2, y + (splitIndex / 2) * height / 3,
+            x + ((splitIndex & 1) + 1) * width / 2, y + (splitIndex / 2 + 1) * height / 3};
     }
 
     return {};
 }
 
+void View::AllocateShadowAtlasRegions()
+{
+    for (LightQueryResult& query : lightQueryResults_)
+    {
+        query.shadowAtlasRegion_ = IntRect::ZERO;
+        query.shadowAtlasKey_ = 0;
+    }
+
+    if (!renderer_->GetShadowAtlas())
+        return;
+
+    // Directional lights come first, then lights by their approximate screen coverage, so that the least important lights
+    // lose resolution if the atlas runs out of space
+    Vector<Pair<float, i32>> order;
+    for (i32 i = 0; i < lightQueryResults_.Size(); ++i)
+    {
+        const LightQueryResult& query = lightQueryResults_[i];
+        Light* light = query.light_;
+        if (light->GetPerVertex() || query.litGeometries_.Empty() || !query.numSplits_ || !renderer_->IsShadowAtlasUsed(light))
+            continue;
+
+        float priority = M_INFINITY;
+        if (light->GetLightType() != LIGHT_DIRECTIONAL)
+        {
+            float distance = cullCamera_->GetDistance(light->GetNode()->GetWorldPosition()) - light->GetRange();
+            priority = light->GetRange() / Max(distance, cullCamera_->GetNearClip());
+        }
+        order.Push(MakePair(-priority, i));
+    }
+
+    Sort(order.Begin(), order.End());
+
+    for (const Pair<float, i32>& entry : order)
+    {
+        LightQueryResult& query = lightQueryResults_[entry.second_];
+        hash64 key = GetShadowAtlasKey(query);
+        if (renderer_->AllocateShadowAtlasRegion(query.light_, cullCamera_, viewSize_.x_, viewSize_.y_, key, query.shadowAtlasRegion_))
+            query.shadowAtlasKey_ = key;
+    }
+}
+
+hash64 View::GetShadowAtlasKey(const LightQueryResult& query) const
+{
+    // FNV-1a over everything that affects the finished shadow map. Views with equal keys render identical shadow maps
+    hash64 hash = 14695981039346656037ULL;
+    auto addData = [&hash](const void* data, i32 size)
+    {
+        const auto* bytes = reinterpret_cast<const u8*>(data);
+        for (i32 i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    };
+
+    addData(&query.light_, sizeof(Light*));
+    addData(&viewSize_, sizeof(IntVector2));
+    addData(&query.numSplits_, sizeof(i32));
+
+    for (i32 i = 0; i < query.numSplits_; ++i)
+    {
+        Camera* shadowCamera = query.shadowCameras_[i];
+        const float cameraParameters[] = {shadowCamera->IsOrthographic() ? 1.0f : 0.0f, shadowCamera->GetOrthoSize(),
+            shadowCamera->GetFov(), shadowCamera->GetAspectRatio(), shadowCamera->GetNearClip(), shadowCamera->GetFarClip(),
+            shadowCamera->GetZoom(), query.shadowNearSplits_[i], query.shadowFarSplits_[i]};
+        addData(cameraParameters, sizeof cameraParameters);
+        addData(&shadowCamera->GetNode()->GetWorldTransform(), sizeof(Matrix3x4));
+        addData(&query.shadowCasterBox_[i].min_, sizeof(Vector3));
+        addData(&query.shadowCasterBox_[i].max_, sizeof(Vector3));
+
+        i32 numCasters = query.shadowCasterEnd_[i] - query.shadowCasterBegin_[i];
+        if (numCasters > 0)
+            addData(&query.shadowCasters_[query.shadowCasterBegin_[i]], numCasters * (i32)sizeof(Drawable*));
+    }
+
+    return hash;
+}
+
 void View::SetupShadowCameras(LightQueryResult& query)
 {
     Light* light = query.light_;
@@ -2765,7 +2830,6 @@ void View::QuantizeDirLightShadowCamera(Camera* shadowCamera, Light* light, cons
 void View::FindZone(Drawable* drawable)
 {
     Vector3 center = drawable->GetWorldBoundingBox().Center();
-    int bestPriority = M_MIN_INT;
     Zone* newZone = nullptr;
 
     // If bounding box center is in view, the zone assignment is conclusive also for next frames. Otherwise it is temporary
@@ -2779,18 +2843,7 @@ void View::FindZone(Drawable* drawable)
         (drawable->GetZoneMask() & lastZone->GetZoneMask()) && lastZone->IsInside(center))
         newZone = lastZone;
     else
-    {
-        for (Vector<Zone*>::Iterator i = zones_.Begin(); i != zones_.End(); ++i)
-        {
-            Zone* zone = *i;
-            int priority = zone->GetPriority();
-            if (priority > bestPriority && (drawable->GetZoneMask() & zone->GetZoneMask()) && zone->IsInside(center))
-            {
-                newZone = zone;
-                bestPriority = priority;
-            }
-        }
-    }
+        newZone = octree_->GetZoneIndex().FindZone(center, drawable->GetZoneMask(), cullCamera_->GetViewMask());
 
     drawable->SetZone(newZone, temporary);
 }
@@ -3037,9 +3090,10 @@ void View::SetupLightVolumeBatch(Batch& batch)
 
 bool View::NeedRenderShadowMap(const LightBatchQueue& queue)
 {
-    // Must have a shadow map, and either forward or deferred lit batches
+    // Must have a shadow map, and either forward or deferred lit batches. A shared shadow atlas region may also have been
+    // rendered by another view already
     return queue.shadowMap_ && (!queue.litBatches_.IsEmpty() || !queue.litBaseBatches_.IsEmpty() ||
-        !queue.volumeBatches_.Empty());
+        !queue.volumeBatches_.Empty()) && (!queue.shadowAtlasKey_ || renderer_->ClaimShadowAtlasRegion(queue.shadowAtlasKey_));
 }
 
 void View::RenderShadowMap(const LightBatchQueue& queue)
@@ -3065,8 +3119,21 @@ void View::RenderShadowMap(const LightBatchQueue& queue)
         // Disable other render targets
         for (i32 i = 1; i < MAX_RENDERTARGETS; ++i)
             graphics_->SetRenderTarget(i, (RenderSurface*) nullptr);
-        graphics_->SetViewport(IntRect(0, 0, shadowMap->GetWidth(), shadowMap->GetHeight()));
-        graphics_->Clear(CLEAR_DEPTH);
+
+        // Clear only the light's own splits in the shadow atlas, as other lights' regions may already have been rendered
+        if (queue.shadowAtlasKey_)
+        {
+            for (const ShadowBatchQueue& shadowQueue : queue.shadowSplits_)
+            {
+                graphics_->SetViewport(shadowQueue.shadowViewport_);
+                graphics_->Clear(CLEAR_DEPTH);
+            }
+        }
+        else
+        {
+            graphics_->SetViewport(IntRect(0, 0, shadowMap->GetWidth(), shadowMap->GetHeight()));
+            graphics_->Clear(CLEAR_DEPTH);
+        }
     }
     else // if the shadow map is a color rendertarget
     {
@@ -63,6 +63,10 @@ struct LightQueryResult
     float shadowFarSplits_[MAX_LIGHT_SPLITS];
     /// Shadow map split count.
     i32 numSplits_;
+    /// Shadow atlas region. Empty if the shadow map is not in the atlas.
+    IntRect shadowAtlasRegion_;
+    /// Shadow atlas key identifying the shadow cameras and casters.
+    hash64 shadowAtlasKey_;
 };
 
 /// Scene render pass info.
@@ -264,8 +268,12 @@ private:
     /// Check visibility of one shadow caster.
     bool IsShadowCasterVisible(Drawable* drawable, BoundingBox lightViewBox, Camera* shadowCamera, const Matrix3x4& lightView,
         const Frustum& lightViewFrustum, const BoundingBox& lightViewFrustumBox);
-    /// Return the viewport for a shadow map split.
-    IntRect GetShadowMapViewport(Light* light, int splitIndex, Texture2D* shadowMap);
+    /// Return the viewport for a shadow map split within the light's shadow map region.
+    IntRect GetShadowMapViewport(Light* light, int splitIndex, const IntRect& region);
+    /// Allocate shadow atlas regions for shadowed lights in priority order.
+    void AllocateShadowAtlasRegions();
+    /// Return shadow atlas key for a light's shadow cameras and casters before they are finalized.
+    hash64 GetShadowAtlasKey(const LightQueryResult& query) const;
     /// Find and set a new zone for a drawable when it has moved.
     void FindZone(Drawable* drawable);
     /// Return material technique, considering the drawable's LOD distance.
@@ -280,7 +288,7 @@ private:
     void PrepareInstancingBuffer();
     /// Set up a light volume rendering batch.
     void SetupLightVolumeBatch(Batch& batch);
-    /// Check whether a light queue needs shadow rendering.
+    /// Check whether a light queue needs shadow rendering. Claims the light's shared shadow atlas region for rendering.
     bool NeedRenderShadowMap(const LightBatchQueue& queue);
     /// Render a shadow map.
     void RenderShadowMap(const LightBatchQueue& queue);
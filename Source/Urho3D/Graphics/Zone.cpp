@@ -129,6 +129,8 @@ void Zone::SetFogHeightScale(float scale)
 void Zone::SetPriority(int priority)
 {
     priority_ = priority;
+    if (octant_)
+        octant_->GetRoot()->MarkZoneIndexDirty();
     MarkNetworkUpdate();
 }
 
@@ -221,6 +223,8 @@ void Zone::OnMarkedDirty(Node* node)
 
     // Clear zone reference from all drawables inside the bounding box, and mark gradient dirty in neighbor zones
     ClearDrawablesZone();
+    if (octant_)
+        octant_->GetRoot()->MarkZoneIndexDirty();
 
     inverseWorldDirty_ = true;
 }
@@ -301,6 +305,8 @@ void Zone::UpdateAmbientGradient()
 void Zone::OnRemoveFromOctree()
 {
     ClearDrawablesZone();
+    if (octant_)
+        octant_->GetRoot()->MarkZoneIndexDirty();
 }
 
 void Zone::ClearDrawablesZone()
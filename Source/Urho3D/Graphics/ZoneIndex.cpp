@@ -0,0 +1,213 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Graphics/Zone.h"
+#include "../Graphics/ZoneIndex.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Maximum number of cells per grid axis.
+static const i32 MAX_ZONE_GRID_SIZE = 64;
+/// Zones overlapping more cells than this are kept in the global list instead of being replicated.
+static const i32 MAX_CELLS_PER_ZONE = 512;
+
+/// Zone with its position in the input order for a stable priority sort.
+struct ZoneIndexEntry
+{
+    Zone* zone_;
+    i32 order_;
+};
+
+static bool CompareZoneIndexEntries(const ZoneIndexEntry& lhs, const ZoneIndexEntry& rhs)
+{
+    int lhsPriority = lhs.zone_->GetPriority();
+    int rhsPriority = rhs.zone_->GetPriority();
+    return lhsPriority != rhsPriority ? lhsPriority > rhsPriority : lhs.order_ < rhs.order_;
+}
+
+void ZoneIndex::Build(const Vector<Zone*>& zones)
+{
+    Clear();
+
+    Vector<ZoneIndexEntry> entries;
+    entries.Reserve(zones.Size());
+    for (i32 i = 0; i < zones.Size(); ++i)
+    {
+        if (zones[i] && zones[i]->GetWorldBoundingBox().Defined())
+            entries.Push({zones[i], i});
+    }
+
+    numZones_ = entries.Size();
+    if (!numZones_)
+        return;
+
+    // Sort once by decreasing priority so that the first matching zone in any cell list is the best one
+    Sort(entries.Begin(), entries.End(), CompareZoneIndexEntries);
+
+    // Grid bounds cover only zones of finite size. Huge zones would stretch the grid and are tested separately
+    Vector<ZoneIndexEntry> bounded;
+    bounded.Reserve(entries.Size());
+    for (const ZoneIndexEntry& entry : entries)
+    {
+        const BoundingBox& box = entry.zone_->GetWorldBoundingBox();
+        if (box.Size().LengthSquared() < M_LARGE_VALUE * M_LARGE_VALUE)
+        {
+            bounds_.Merge(box);
+            bounded.Push(entry);
+        }
+        else
+            globalZones_.Push(entry.zone_);
+    }
+
+    if (bounded.Empty())
+        return;
+
+    // Aim for a few zones per cell on average; resolution grows with the cube root of the zone count
+    i32 cellsPerAxis = Clamp(CeilToInt(cbrtf((float)bounded.Size())) * 2, 1, MAX_ZONE_GRID_SIZE);
+    Vector3 boundsSize = bounds_.Size();
+    gridSize_ = IntVector3(boundsSize.x_ > M_EPSILON ? cellsPerAxis : 1, boundsSize.y_ > M_EPSILON ? cellsPerAxis : 1,
+        boundsSize.z_ > M_EPSILON ? cellsPerAxis : 1);
+    invCellSize_ = Vector3(
+        boundsSize.x_ > M_EPSILON ? (float)gridSize_.x_ / boundsSize.x_ : 0.0f,
+        boundsSize.y_ > M_EPSILON ? (float)gridSize_.y_ / boundsSize.y_ : 0.0f,
+        boundsSize.z_ > M_EPSILON ? (float)gridSize_.z_ / boundsSize.z_ : 0.0f);
+
+    i32 numCells = gridSize_.x_ * gridSize_.y_ * gridSize_.z_;
+    cellStarts_.Resize(numCells + 1);
+    for (i32& start : cellStarts_)
+        start = 0;
+
+    // Two passes: count zones per cell, then fill. Iterating in priority order keeps each cell's list sorted
+    Vector<ZoneIndexEntry> gridZones;
+    gridZones.Reserve(bounded.Size());
+    for (const ZoneIndexEntry& entry : bounded)
+    {
+        const BoundingBox& box = entry.zone_->GetWorldBoundingBox();
+        IntVector3 minCell = GetCellCoords(box.min_);
+        IntVector3 maxCell = GetCellCoords(box.max_);
+        i32 numZoneCells = (maxCell.x_ - minCell.x_ + 1) * (maxCell.y_ - minCell.y_ + 1) * (maxCell.z_ - minCell.z_ + 1);
+        if (numZoneCells > MAX_CELLS_PER_ZONE)
+        {
+            globalZones_.Push(entry.zone_);
+            continue;
+        }
+
+        gridZones.Push(entry);
+        for (i32 z = minCell.z_; z <= maxCell.z_; ++z)
+        {
+            for (i32 y = minCell.y_; y <= maxCell.y_; ++y)
+            {
+                for (i32 x = minCell.x_; x <= maxCell.x_; ++x)
+                    ++cellStarts_[(z * gridSize_.y_ + y) * gridSize_.x_ + x];
+            }
+        }
+    }
+
+    i32 total = 0;
+    for (i32 i = 0; i < numCells; ++i)
+    {
+        i32 count = cellStarts_[i];
+        cellStarts_[i] = total;
+        total += count;
+    }
+    cellStarts_[numCells] = total;
+
+    cellZones_.Resize(total);
+    Vector<i32> fill(cellStarts_);
+    for (const ZoneIndexEntry& entry : gridZones)
+    {
+        const BoundingBox& box = entry.zone_->GetWorldBoundingBox();
+        IntVector3 minCell = GetCellCoords(box.min_);
+        IntVector3 maxCell = GetCellCoords(box.max_);
+        for (i32 z = minCell.z_; z <= maxCell.z_; ++z)
+        {
+            for (i32 y = minCell.y_; y <= maxCell.y_; ++y)
+            {
+                for (i32 x = minCell.x_; x <= maxCell.x_; ++x)
+                    cellZones_[fill[(z * gridSize_.y_ + y) * gridSize_.x_ + x]++] = entry.zone_;
+            }
+        }
+    }
+
+    // Zones moved to the global list while filling the grid may have broken its ordering
+    if (globalZones_.Size() > 1)
+    {
+        Vector<ZoneIndexEntry> globalEntries;
+        globalEntries.Reserve(globalZones_.Size());
+        for (i32 i = 0; i < globalZones_.Size(); ++i)
+            globalEntries.Push({globalZones_[i], i});
+        Sort(globalEntries.Begin(), globalEntries.End(), CompareZoneIndexEntries);
+        for (i32 i = 0; i < globalEntries.Size(); ++i)
+            globalZones_[i] = globalEntries[i].zone_;
+    }
+}
+
+void ZoneIndex::Clear()
+{
+    globalZones_.Clear();
+    cellZones_.Clear();
+    cellStarts_.Clear();
+    bounds_.Clear();
+    invCellSize_ = Vector3::ZERO;
+    gridSize_ = IntVector3::ZERO;
+    numZones_ = 0;
+}
+
+Zone* ZoneIndex::FindZone(const Vector3& point, mask32 zoneMask, mask32 viewMask) const
+{
+    Zone* bestZone = nullptr;
+    int bestPriority = M_MIN_INT;
+
+    i32 cellIndex = GetCellIndex(point);
+    if (cellIndex != NINDEX)
+    {
+        for (i32 i = cellStarts_[cellIndex]; i < cellStarts_[cellIndex + 1]; ++i)
+        {
+            Zone* zone = cellZones_[i];
+            if ((zone->GetZoneMask() & zoneMask) && (zone->GetViewMask() & viewMask) && zone->IsInside(point))
+            {
+                bestZone = zone;
+                bestPriority = zone->GetPriority();
+                break;
+            }
+        }
+    }
+
+    // Global zones only win with strictly higher priority, and the list is sorted so the search can stop early
+    for (Zone* zone : globalZones_)
+    {
+        int priority = zone->GetPriority();
+        if (priority <= bestPriority)
+            break;
+        if ((zone->GetZoneMask() & zoneMask) && (zone->GetViewMask() & viewMask) && zone->IsInside(point))
+            return zone;
+    }
+
+    return bestZone;
+}
+
+i32 ZoneIndex::GetCellIndex(const Vector3& point) const
+{
+    if (cellStarts_.Empty() || bounds_.IsInside(point) == OUTSIDE)
+        return NINDEX;
+
+    IntVector3 cell = GetCellCoords(point);
+    return (cell.z_ * gridSize_.y_ + cell.y_) * gridSize_.x_ + cell.x_;
+}
+
+IntVector3 ZoneIndex::GetCellCoords(const Vector3& point) const
+{
+    Vector3 local = (point - bounds_.min_) * invCellSize_;
+    return IntVector3(
+        Clamp(FloorToInt(local.x_), 0, gridSize_.x_ - 1),
+        Clamp(FloorToInt(local.y_), 0, gridSize_.y_ - 1),
+        Clamp(FloorToInt(local.z_), 0, gridSize_.z_ - 1));
+}
+
+}
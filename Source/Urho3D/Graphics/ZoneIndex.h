@@ -0,0 +1,56 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Math/BoundingBox.h"
+
+namespace Urho3D
+{
+
+class Zone;
+
+/// Uniform grid over zone world bounding boxes for priority-aware point queries.
+/// @nobind
+class URHO3D_API ZoneIndex
+{
+public:
+    /// Construct empty.
+    ZoneIndex() = default;
+
+    /// Rebuild from a set of zones. Zones are stored by pointer, so the index must be rebuilt when any of them changes or is destroyed.
+    void Build(const Vector<Zone*>& zones);
+    /// Clear the index.
+    void Clear();
+    /// Return the highest priority zone containing the point that matches the zone and view masks, or null if none. Safe to call from worker threads.
+    Zone* FindZone(const Vector3& point, mask32 zoneMask, mask32 viewMask) const;
+
+    /// Return number of indexed zones.
+    i32 GetNumZones() const { return numZones_; }
+    /// Return grid cell counts per axis.
+    const IntVector3& GetGridSize() const { return gridSize_; }
+
+private:
+    /// Return cell index for a point inside the grid bounds.
+    i32 GetCellIndex(const Vector3& point) const;
+    /// Return cell coordinates for a point, clamped to the grid.
+    IntVector3 GetCellCoords(const Vector3& point) const;
+
+    /// Zones that span too many cells to be replicated into the grid, sorted by decreasing priority.
+    Vector<Zone*> globalZones_;
+    /// Zones in each cell, sorted by decreasing priority. Ranges are given by cellStarts_.
+    Vector<Zone*> cellZones_;
+    /// Start offset of each cell's zones in cellZones_. Has one extra element at the end.
+    Vector<i32> cellStarts_;
+    /// Grid bounds.
+    BoundingBox bounds_;
+    /// Reciprocal of cell size.
+    Vector3 invCellSize_;
+    /// Number of cells per axis.
+    IntVector3 gridSize_;
+    /// Number of indexed zones.
+    i32 numZones_{};
+};
+
+}
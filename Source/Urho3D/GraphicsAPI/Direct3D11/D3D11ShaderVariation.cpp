@@ -42,10 +42,8 @@ void ShaderVariation::OnDeviceLost_D3D11()
     // No-op on Direct3D11
 }
 
-bool ShaderVariation::Create_D3D11()
+bool ShaderVariation::Prepare_D3D11()
 {
-    Release_D3D11();
-
     if (!graphics_)
         return false;
 
@@ -55,6 +53,9 @@ bool ShaderVariation::Create_D3D11()
         return false;
     }
 
+    // Bytecode and reflection data are built anew. The shader object, if any, is replaced only by Create_D3D11()
+    ClearByteCode_D3D11();
+
     // Check for up-to-date bytecode on disk
     String path, name, extension;
     SplitPath(owner_->GetName(), path, name, extension);
@@ -72,7 +73,18 @@ bool ShaderVariation::Create_D3D11()
             SaveByteCode_D3D11(binaryShaderName);
     }
 
-    // Then create shader from the bytecode
+    return true;
+}
+
+bool ShaderVariation::Create_D3D11()
+{
+    // Keep the bytecode and reflection data from Prepare_D3D11()
+    ReleaseObject_D3D11();
+
+    if (!graphics_)
+        return false;
+
+    // Create shader from the bytecode loaded or compiled by Prepare_D3D11()
     ID3D11Device* device = graphics_->GetImpl_D3D11()->GetDevice();
     if (type_ == VS)
     {
@@ -107,6 +119,12 @@ bool ShaderVariation::Create_D3D11()
 }
 
 void ShaderVariation::Release_D3D11()
+{
+    ReleaseObject_D3D11();
+    ClearByteCode_D3D11();
+}
+
+void ShaderVariation::ReleaseObject_D3D11()
 {
     if (object_.ptr_)
     {
@@ -128,7 +146,10 @@ void ShaderVariation::Release_D3D11()
 
         URHO3D_SAFE_RELEASE(object_.ptr_);
     }
+}
 
+void ShaderVariation::ClearByteCode_D3D11()
+{
     compilerOutput_.Clear();
 
     for (unsigned i = 0; i < MAX_TEXTURE_UNITS; ++i)
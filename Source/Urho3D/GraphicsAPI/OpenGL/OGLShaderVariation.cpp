@@ -68,25 +68,17 @@ void ShaderVariation::Release_OGL()
     compilerOutput_.Clear();
 }
 
-bool ShaderVariation::Create_OGL()
+bool ShaderVariation::Prepare_OGL()
 {
-    Release_OGL();
-
     if (!owner_)
     {
         compilerOutput_ = "Owner shader has expired";
         return false;
     }
 
-    object_.name_ = glCreateShader(type_ == VS ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER);
-    if (!object_.name_)
-    {
-        compilerOutput_ = "Could not create shader object";
-        return false;
-    }
-
     const String& originalShaderCode = owner_->GetSourceCode(type_);
-    String shaderCode;
+    String& shaderCode = preparedSource_;
+    shaderCode.Clear();
 
     // Check if the shader code contains a version define
     i32 verStart = originalShaderCode.Find('#');
@@ -150,7 +142,21 @@ bool ShaderVariation::Create_OGL()
     else
         shaderCode += originalShaderCode;
 
-    const char* shaderCStr = shaderCode.CString();
+    return true;
+}
+
+bool ShaderVariation::Create_OGL()
+{
+    Release_OGL();
+
+    object_.name_ = glCreateShader(type_ == VS ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER);
+    if (!object_.name_)
+    {
+        compilerOutput_ = "Could not create shader object";
+        return false;
+    }
+
+    const char* shaderCStr = preparedSource_.CString();
     glShaderSource(object_.name_, 1, &shaderCStr, nullptr);
     glCompileShader(object_.name_);
 
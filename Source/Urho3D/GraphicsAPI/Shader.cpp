@@ -68,6 +68,10 @@ bool Shader::BeginLoad(Deserializer& source)
     if (!graphics)
         return false;
 
+    // When reloading, variations must not be prepared from the source code while it changes
+    if (numVariations_ && graphics->GetNumPendingShaders())
+        graphics->CancelPendingShaders();
+
     // Load the shader source code and resolve any includes
     timeStamp_ = 0;
     String shaderCode;
@@ -26,16 +26,7 @@ ShaderPrecache::ShaderPrecache(Context* context, const String& fileName) :
         // If file exists, read the already listed combinations
         File source(context_, fileName);
         xmlFile_.Load(source);
-
-        XMLElement shader = xmlFile_.GetRoot().GetChild("shader");
-        while (shader)
-        {
-            String oldCombination = shader.GetAttribute("vs") + " " + shader.GetAttribute("vsdefines") + " " +
-                                    shader.GetAttribute("ps") + " " + shader.GetAttribute("psdefines");
-            usedCombinations_.Insert(oldCombination);
-
-            shader = shader.GetNext("shader");
-        }
+        AddCombinations(xmlFile_.GetRoot(), true);
     }
 
     // If no file yet or loading failed, create the root element now
@@ -49,7 +40,8 @@ ShaderPrecache::~ShaderPrecache()
 {
     URHO3D_LOGINFO("End dumping shaders");
 
-    if (usedCombinations_.Empty())
+    // Leave the file untouched if this run did not use any new combinations
+    if (!dirty_ || usedCombinations_.Empty())
         return;
 
     File dest(context_, fileName_, FILE_WRITE);
@@ -67,22 +59,67 @@ void ShaderPrecache::StoreShaders(ShaderVariation* vs, ShaderVariation* ps)
         return;
     usedPtrCombinations_.Insert(shaderPair);
 
-    String vsName = vs->GetName();
-    String psName = ps->GetName();
-    const String& vsDefines = vs->GetDefines();
-    const String& psDefines = ps->GetDefines();
-
     // Check for duplicate using strings (needed for combinations loaded from existing file)
-    String newCombination = vsName + " " + vsDefines + " " + psName + " " + psDefines;
+    AddCombination(vs->GetName(), vs->GetDefines(), ps->GetName(), ps->GetDefines());
+}
+
+bool ShaderPrecache::MergeShaders(Deserializer& source)
+{
+    XMLFile xmlFile(context_);
+    if (!xmlFile.Load(source))
+        return false;
+
+    i32 oldSize = usedCombinations_.Size();
+    AddCombinations(xmlFile.GetRoot(), false);
+    URHO3D_LOGDEBUG("Merged " + String(usedCombinations_.Size() - oldSize) + " new shader combinations from " +
+        source.GetName());
+    return true;
+}
+
+bool ShaderPrecache::AddCombination(const String& vs, const String& vsDefines, const String& ps, const String& psDefines)
+{
+    String newCombination = vs + " " + vsDefines + " " + ps + " " + psDefines;
     if (usedCombinations_.Contains(newCombination))
-        return;
+        return false;
     usedCombinations_.Insert(newCombination);
 
     XMLElement shaderElem = xmlFile_.GetRoot().CreateChild("shader");
-    shaderElem.SetAttribute("vs", vsName);
+    shaderElem.SetAttribute("vs", vs);
     shaderElem.SetAttribute("vsdefines", vsDefines);
-    shaderElem.SetAttribute("ps", psName);
+    shaderElem.SetAttribute("ps", ps);
     shaderElem.SetAttribute("psdefines", psDefines);
+    dirty_ = true;
+    return true;
+}
+
+void ShaderPrecache::AddCombinations(const XMLElement& root, bool ownFile)
+{
+    XMLElement shader = root.GetChild("shader");
+    while (shader)
+    {
+        XMLElement next = shader.GetNext("shader");
+        String vs = shader.GetAttribute("vs");
+        String vsDefines = shader.GetAttribute("vsdefines");
+        String ps = shader.GetAttribute("ps");
+        String psDefines = shader.GetAttribute("psdefines");
+
+        if (ownFile)
+        {
+            // The elements are already in the file. Drop repeated ones, which older logs may contain
+            String oldCombination = vs + " " + vsDefines + " " + ps + " " + psDefines;
+            if (usedCombinations_.Contains(oldCombination))
+            {
+                xmlFile_.GetRoot().RemoveChild(shader);
+                dirty_ = true;
+            }
+            else
+                usedCombinations_.Insert(oldCombination);
+        }
+        else
+            AddCombination(vs, vsDefines, ps, psDefines);
+
+        shader = next;
+    }
 }
 
 void ShaderPrecache::LoadShaders(Graphics* graphics, Deserializer& source)
@@ -92,6 +129,9 @@ void ShaderPrecache::LoadShaders(Graphics* graphics, Deserializer& source)
     XMLFile xmlFile(graphics->GetContext());
     xmlFile.Load(source);
 
+    Vector<Pair<ShaderVariation*, ShaderVariation*>> combinations;
+    Vector<ShaderVariation*> variations;
+
     XMLElement shader = xmlFile.GetRoot().GetChild("shader");
     while (shader)
     {
@@ -113,12 +153,19 @@ void ShaderPrecache::LoadShaders(Graphics* graphics, Deserializer& source)
 
         ShaderVariation* vs = graphics->GetShader(VS, shader.GetAttribute("vs"), vsDefines);
         ShaderVariation* ps = graphics->GetShader(PS, shader.GetAttribute("ps"), psDefines);
-        // Set the shaders active to actually compile them
-        graphics->SetShaders(vs, ps);
+        combinations.Push(MakePair(vs, ps));
+        variations.Push(vs);
+        variations.Push(ps);
 
         shader = shader.GetNext("shader");
     }
 
+    // Do the CPU-side work of all variations in parallel, then set the shaders active to create them and link the
+    // programs, which needs the graphics context
+    graphics->PrepareShaders(variations);
+    for (const Pair<ShaderVariation*, ShaderVariation*>& combination : combinations)
+        graphics->SetShaders(combination.first_, combination.second_);
+
     URHO3D_LOGDEBUG("End precaching shaders");
 }
 
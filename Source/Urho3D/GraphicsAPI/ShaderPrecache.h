@@ -21,16 +21,26 @@ class URHO3D_API ShaderPrecache : public Object
 public:
     /// Construct and begin collecting shader combinations. Load existing combinations from XML if the file exists.
     ShaderPrecache(Context* context, const String& fileName);
-    /// Destruct. Write the collected shaders to XML.
+    /// Destruct. Write the collected shaders to XML if any were added.
     ~ShaderPrecache() override;
 
     /// Collect a shader combination. Called by Graphics when shaders have been set.
     void StoreShaders(ShaderVariation* vs, ShaderVariation* ps);
+    /// Merge the combinations from another XML file, such as the log of another run. Duplicates are skipped. Return true if the file could be read.
+    bool MergeShaders(Deserializer& source);
 
-    /// Load shaders from an XML file.
+    /// Return number of collected shader combinations.
+    i32 GetNumCombinations() const { return usedCombinations_.Size(); }
+
+    /// Load shaders from an XML file. The variations are prepared in parallel on worker threads before they are created.
     static void LoadShaders(Graphics* graphics, Deserializer& source);
 
 private:
+    /// Add a combination unless already collected. Return true if added.
+    bool AddCombination(const String& vs, const String& vsDefines, const String& ps, const String& psDefines);
+    /// Add all combinations from XML. If the XML is the collected file itself, remove duplicate elements instead.
+    void AddCombinations(const XMLElement& root, bool ownFile);
+
     /// XML file name.
     String fileName_;
     /// XML file.
@@ -39,6 +49,8 @@ private:
     HashSet<Pair<ShaderVariation*, ShaderVariation*>> usedPtrCombinations_;
     /// Already encountered shader combinations.
     HashSet<String> usedCombinations_;
+    /// Whether the XML file needs to be written.
+    bool dirty_{};
 };
 
 }
@@ -80,6 +80,10 @@ void ShaderVariation::OnDeviceLost()
 
 void ShaderVariation::Release()
 {
+    // Prepared data may be out of date, for example after the shader source has been reloaded
+    preparedSource_.Clear();
+    prepared_.store(false, std::memory_order_release);
+
     GAPI gapi = Graphics::GetGAPI();
 
 #ifdef URHO3D_OPENGL
@@ -98,26 +102,61 @@ void ShaderVariation::Release()
 #endif
 }
 
-bool ShaderVariation::Create()
+bool ShaderVariation::Prepare()
 {
     GAPI gapi = Graphics::GetGAPI();
+    bool success = false;
 
 #ifdef URHO3D_OPENGL
     if (gapi == GAPI_OPENGL)
-        return Create_OGL();
+        success = Prepare_OGL();
 #endif
 
 #ifdef URHO3D_D3D11
     if (gapi == GAPI_D3D11)
-        return Create_D3D11();
+        success = Prepare_D3D11();
 #endif
 
 #ifdef URHO3D_VULKAN
     if (gapi == GAPI_VULKAN)
-        return Create_Vulkan();
+        success = Prepare_Vulkan();
+#endif
+
+    prepareFailed_ = !success;
+    prepared_.store(true, std::memory_order_release);
+    return success;
+}
+
+bool ShaderVariation::Create()
+{
+    if (!IsPrepared())
+        Prepare();
+
+    GAPI gapi = Graphics::GetGAPI();
+    bool success = false;
+
+    if (!prepareFailed_)
+    {
+#ifdef URHO3D_OPENGL
+        if (gapi == GAPI_OPENGL)
+            success = Create_OGL();
+#endif
+
+#ifdef URHO3D_D3D11
+        if (gapi == GAPI_D3D11)
+            success = Create_D3D11();
+#endif
+
+#ifdef URHO3D_VULKAN
+        if (gapi == GAPI_VULKAN)
+            success = Create_Vulkan();
 #endif
+    }
 
-    return {}; // Prevent warning
+    // The prepared data has been consumed. Recreating, for example after device loss, prepares again
+    preparedSource_.Clear();
+    prepared_.store(false, std::memory_order_release);
+    return success;
 }
 
 void ShaderVariation::SetDefines(const String& defines)
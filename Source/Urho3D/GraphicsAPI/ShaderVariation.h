@@ -9,6 +9,8 @@
 #include "../GraphicsAPI/GPUObject.h"
 #include "../GraphicsAPI/GraphicsDefs.h"
 
+#include <atomic>
+
 namespace Urho3D
 {
 
@@ -72,7 +74,9 @@ public:
     /// Release the shader.
     void Release() override;
 
-    /// Compile the shader. Return true if successful.
+    /// Perform the part of compilation that does not need the graphics context: compiling bytecode on Direct3D11 and SPIR-V on Vulkan. On OpenGL only the final source code is built, as the driver compiles on the context thread in Create(). Can be called from a worker thread, as long as the variation is not used elsewhere until it returns. Return true if successful.
+    bool Prepare();
+    /// Compile the shader. Uses the result of Prepare() if already called, otherwise prepares first. Return true if successful.
     bool Create();
     /// Set name.
     void SetName(const String& name);
@@ -112,6 +116,9 @@ public:
     /// Return defines.
     const String& GetDefines() const { return defines_; }
 
+    /// Return whether Prepare() has finished and the variation is waiting for Create().
+    bool IsPrepared() const { return prepared_.load(std::memory_order_acquire); }
+
     /// Return compile error/warning string.
     const String& GetCompilerOutput() const { return compilerOutput_; }
 
@@ -146,6 +153,12 @@ private:
 
     /// Calculate constant buffer sizes from parameters.
     void CalculateConstantBufferSizes_D3D11();
+
+    /// Release the shader object and the shader programs using it, but keep the bytecode.
+    void ReleaseObject_D3D11();
+
+    /// Clear the bytecode, reflection data and compiler output.
+    void ClearByteCode_D3D11();
 #endif // def URHO3D_D3D11
 
     // For proxy functions
@@ -153,6 +166,7 @@ private:
 #ifdef URHO3D_OPENGL
     void OnDeviceLost_OGL();
     void Release_OGL();
+    bool Prepare_OGL();
     bool Create_OGL();
     void SetDefines_OGL(const String& defines);
 #endif // def URHO3D_OPENGL
@@ -160,6 +174,7 @@ private:
 #ifdef URHO3D_D3D11
     void OnDeviceLost_D3D11();
     void Release_D3D11();
+    bool Prepare_D3D11();
     bool Create_D3D11();
     void SetDefines_D3D11(const String& defines);
 #endif // def URHO3D_D3D11
@@ -167,6 +182,7 @@ private:
 #ifdef URHO3D_VULKAN
     void OnDeviceLost_Vulkan();
     void Release_Vulkan();
+    bool Prepare_Vulkan();
     bool Create_Vulkan();
     void SetDefines_Vulkan(const String& defines);
 #endif // def URHO3D_VULKAN
@@ -193,6 +209,12 @@ private:
     String definesClipPlane_;
     /// Shader compile error string.
     String compilerOutput_;
+    /// Final source code built by Prepare(). Used only on OpenGL.
+    String preparedSource_;
+    /// Prepare() finished flag. Written by the preparing thread and cleared by Create().
+    std::atomic<bool> prepared_{};
+    /// Prepare() failure flag.
+    bool prepareFailed_{};
 };
 
 }
@@ -347,13 +347,9 @@ bool VulkanShaderCompiler::CompileWithGlslang(
 {
     try
     {
-        // Initialize glslang library
-        static bool glslangInitialized = false;
-        if (!glslangInitialized)
-        {
-            glslang::InitializeProcess();
-            glslangInitialized = true;
-        }
+        // Initialize glslang library once. Shader variations may be compiled on several worker threads at the same time
+        static const bool glslangInitialized = glslang::InitializeProcess();
+        (void)glslangInitialized;
 
         // Determine shader stage
         EShLanguage stage = EShLangVertex;
@@ -16,10 +16,8 @@
 namespace Urho3D
 {
 
-bool ShaderVariation::Create_Vulkan()
+bool ShaderVariation::Prepare_Vulkan()
 {
-    Release();
-
     Shader* owner = GetOwner();
     if (!owner)
     {
@@ -27,7 +25,10 @@ bool ShaderVariation::Create_Vulkan()
         return false;
     }
 
-    // Get SPIR-V bytecode (compiled or cached)
+    // Compile to SPIR-V from the current source. The result is cached in the bytecode for Create_Vulkan()
+    byteCode_.Clear();
+    compilerOutput_.Clear();
+
     Vector<uint32_t> spirvBytecode;
     if (!VulkanShaderModule::GetOrCompileSPIRV(this, spirvBytecode, compilerOutput_))
     {
@@ -35,6 +36,25 @@ bool ShaderVariation::Create_Vulkan()
         return false;
     }
 
+    return true;
+}
+
+bool ShaderVariation::Create_Vulkan()
+{
+    // Keep the SPIR-V compiled by Prepare_Vulkan()
+    Shader* owner = GetOwner();
+    if (!owner)
+    {
+        compilerOutput_ = "Owner shader is null";
+        return false;
+    }
+
+    if (byteCode_.Empty())
+    {
+        compilerOutput_ = "No SPIR-V bytecode for shader: " + GetFullName();
+        return false;
+    }
+
     // For now, we don't store the shader module here - it will be created on-demand in PrepareDraw
     // This allows for lazy loading and proper GPU resource management
 
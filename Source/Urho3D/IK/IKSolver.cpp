@@ -43,6 +43,7 @@ IKSolver::IKSolver(Context* context) :
     SubscribeToEvent(E_COMPONENTREMOVED, URHO3D_HANDLER(IKSolver, HandleComponentRemoved));
     SubscribeToEvent(E_NODEADDED,        URHO3D_HANDLER(IKSolver, HandleNodeAdded));
     SubscribeToEvent(E_NODEREMOVED,      URHO3D_HANDLER(IKSolver, HandleNodeRemoved));
+    SubscribeToEvent(E_SCENEUNLOADING,   URHO3D_HANDLER(IKSolver, HandleSceneUnloading));
 }
 
 // ----------------------------------------------------------------------------
@@ -700,6 +701,22 @@ void IKSolver::HandleNodeRemoved(StringHash eventType, VariantMap& eventData)
     }
 }
 
+// ----------------------------------------------------------------------------
+void IKSolver::HandleSceneUnloading(StringHash eventType, VariantMap& eventData)
+{
+    using namespace SceneUnloading;
+
+    if (eventData[P_SCENE].GetPtr() != GetScene())
+        return;
+
+    // No node or component removal events will follow, so let go of the
+    // effectors and the tree, which refers to the nodes, now
+    for (Vector<IKEffector*>::ConstIterator it = effectorList_.Begin(); it != effectorList_.End(); ++it)
+        (*it)->SetIKEffectorNode(nullptr);
+
+    DestroyTree();
+}
+
 // ----------------------------------------------------------------------------
 void IKSolver::HandleSceneDrawableUpdateFinished(StringHash eventType, VariantMap& eventData)
 {
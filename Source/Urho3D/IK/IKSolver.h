@@ -335,6 +335,8 @@ private:
     void HandleComponentRemoved(StringHash eventType, VariantMap& eventData);
     void HandleNodeAdded(StringHash eventType, VariantMap& eventData);
     void HandleNodeRemoved(StringHash eventType, VariantMap& eventData);
+    /// Releases the tree when the scene is unloaded in bulk.
+    void HandleSceneUnloading(StringHash eventType, VariantMap& eventData);
     /// Invokes the IK solver.
     void HandleSceneDrawableUpdateFinished(StringHash eventType, VariantMap& eventData);
 
@@ -8,6 +8,7 @@
 #include "../Core/CoreEvents.h"
 #include "../Core/Thread.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
@@ -65,6 +66,47 @@ const char* SDL_IOS_GetDocumentsDir();
 namespace Urho3D
 {
 
+/// Maximum directory levels expanded on the calling thread to find subdirectories for a parallel scan.
+static const i32 MAX_PARALLEL_SCAN_SPLIT_LEVELS = 3;
+/// Subdirectories per thread to aim for when splitting a parallel scan.
+static const i32 PARALLEL_SCAN_DIRS_PER_THREAD = 4;
+
+/// Directory scanned in a parallel directory scan. The top levels are scanned on the calling thread and split into child tasks, the rest by worker threads.
+struct ScanDirTask
+{
+    /// File system.
+    const FileSystem* fileSystem_;
+    /// Full path of the subdirectory.
+    String path_;
+    /// Path the scan started from.
+    const String* startPath_;
+    /// Filter.
+    const String* filter_;
+    /// Scan flags.
+    unsigned flags_;
+    /// Results.
+    Vector<String> result_;
+    /// Child task indices and the result positions their results are inserted at.
+    Vector<Pair<i32, i32>> children_;
+};
+
+/// Append the results of a parallel scan task and its children in the order a non-parallel scan would produce.
+static void AppendScanResults(Vector<String>& result, const Vector<ScanDirTask>& tasks, i32 index)
+{
+    const ScanDirTask& task = tasks[index];
+    i32 start = 0;
+    for (const Pair<i32, i32>& child : task.children_)
+    {
+        for (i32 i = start; i < child.second_; ++i)
+            result.Push(task.result_[i]);
+        start = child.second_;
+        AppendScanResults(result, tasks, child.first_);
+    }
+
+    for (i32 i = start; i < task.result_.Size(); ++i)
+        result.Push(task.result_[i]);
+}
+
 int DoSystemCommand(const String& commandLine, bool redirectToLog, Context* context)
 {
 #if defined(TVOS) || defined(IOS)
@@ -123,6 +165,35 @@ int DoSystemCommand(const String& commandLine, bool redirectToLog, Context* cont
 #endif
 }
 
+#ifdef _WIN32
+/// Quote a command line argument so that the program receives it unchanged, following the rules of CommandLineToArgvW().
+static String QuoteArgument(const String& argument)
+{
+    if (!argument.Empty() && !argument.Contains(' ') && !argument.Contains('\t') && !argument.Contains('\n') &&
+        !argument.Contains('\v') && !argument.Contains('"'))
+        return argument;
+
+    // Backslashes are literal unless they precede a quote, so double them there, including before the closing quote
+    String ret = "\"";
+    i32 numBackslashes = 0;
+    for (i32 i = 0; i < argument.Length(); ++i)
+    {
+        char c = argument[i];
+        if (c == '\\')
+            ++numBackslashes;
+        else
+        {
+            ret += String('\\', c == '"' ? numBackslashes * 2 + 1 : numBackslashes);
+            ret += c;
+            numBackslashes = 0;
+        }
+    }
+    ret += String('\\', numBackslashes * 2);
+    ret += '"';
+    return ret;
+}
+#endif
+
 int DoSystemRun(const String& fileName, const Vector<String>& arguments)
 {
 #ifdef TVOS
@@ -137,7 +208,7 @@ int DoSystemRun(const String& fileName, const Vector<String>& arguments)
 
     String commandLine = "\"" + fixedFileName + "\"";
     for (unsigned i = 0; i < arguments.Size(); ++i)
-        commandLine += " " + arguments[i];
+        commandLine += " " + QuoteArgument(arguments[i]);
 
     STARTUPINFOW startupInfo;
     PROCESS_INFORMATION processInfo;
@@ -171,8 +242,10 @@ int DoSystemRun(const String& fileName, const Vector<String>& arguments)
     }
     else if (pid > 0)
     {
+        // Wait for this child only, as other threads may be running programs at the same time
         int exitCode;
-        wait(&exitCode);
+        if (waitpid(pid, &exitCode, 0) < 0)
+            return -1;
         return exitCode;
     }
     else
@@ -671,7 +744,11 @@ void FileSystem::ScanDir(Vector<String>& result, const String& pathName, const S
     if (CheckAccess(pathName))
     {
         String initialPath = AddTrailingSlash(pathName);
-        ScanDirInternal(result, initialPath, initialPath, filter, flags, recursive);
+        auto* queue = GetSubsystem<WorkQueue>();
+        if (recursive && queue && queue->GetNumThreads() && Thread::IsMainThread())
+            ScanDirParallel(result, initialPath, filter, flags);
+        else
+            ScanDirInternal(result, initialPath, initialPath, filter, flags, recursive);
     }
 }
 
@@ -774,8 +851,67 @@ bool FileSystem::SetLastModifiedTime(const String& fileName, unsigned newTime)
 #endif
 }
 
+void FileSystem::ScanDirParallel(Vector<String>& result, const String& startPath, const String& filter, unsigned flags) const
+{
+    URHO3D_PROFILE(ScanDirParallel);
+
+    auto* queue = GetSubsystem<WorkQueue>();
+
+    // Expand the top levels breadth-first on this thread until there are enough subdirectories to keep the worker
+    // threads busy, then scan each remaining subdirectory's tree as one work item. Each expanded directory remembers
+    // where its subdirectories were found, so that the results can be put back into depth-first order
+    Vector<ScanDirTask> tasks(1);
+    tasks[0].path_ = startPath;
+
+    i32 minDirs = (queue->GetNumThreads() + 1) * PARALLEL_SCAN_DIRS_PER_THREAD;
+    i32 levelStart = 0;
+    for (i32 level = 0; level < MAX_PARALLEL_SCAN_SPLIT_LEVELS; ++level)
+    {
+        i32 levelEnd = tasks.Size();
+        if (levelStart == levelEnd || (level && levelEnd - levelStart >= minDirs))
+            break;
+
+        for (i32 i = levelStart; i < levelEnd; ++i)
+        {
+            Vector<Pair<String, i32>> dirs;
+            ScanDirInternal(tasks[i].result_, tasks[i].path_, startPath, filter, flags, true, &dirs);
+            for (const Pair<String, i32>& dir : dirs)
+            {
+                tasks[i].children_.Push(MakePair(tasks.Size(), dir.second_));
+                tasks.Push(ScanDirTask());
+                tasks.Back().path_ = dir.first_;
+            }
+        }
+
+        levelStart = levelEnd;
+    }
+
+    // One work item per subdirectory, as the trees differ in size
+    i32 numDirs = tasks.Size() - levelStart;
+    for (i32 i = levelStart; i < tasks.Size(); ++i)
+    {
+        ScanDirTask& task = tasks[i];
+        task.fileSystem_ = this;
+        task.startPath_ = &startPath;
+        task.filter_ = &filter;
+        task.flags_ = flags;
+    }
+    if (numDirs)
+        queue->RunParallel(ScanDirWork, &tasks[levelStart], numDirs, numDirs);
+
+    AppendScanResults(result, tasks, 0);
+}
+
+void FileSystem::ScanDirWork(const WorkItem* item, i32 /*threadIndex*/)
+{
+    auto* start = reinterpret_cast<ScanDirTask*>(item->start_);
+    auto* end = reinterpret_cast<ScanDirTask*>(item->end_);
+    for (ScanDirTask* task = start; task != end; ++task)
+        task->fileSystem_->ScanDirInternal(task->result_, task->path_, *task->startPath_, *task->filter_, task->flags_, true);
+}
+
 void FileSystem::ScanDirInternal(Vector<String>& result, String path, const String& startPath,
-    const String& filter, unsigned flags, bool recursive) const
+    const String& filter, unsigned flags, bool recursive, Vector<Pair<String, i32>>* deferredDirs) const
 {
     path = AddTrailingSlash(path);
     String deltaPath;
@@ -807,7 +943,9 @@ void FileSystem::ScanDirInternal(Vector<String>& result, String path, const Stri
                 fileName.Resize(fileName.Length() - sizeof(ASSET_DIR_INDICATOR) / sizeof(char) + 1);
                 if (flags & SCAN_DIRS)
                     result.Push(deltaPath + fileName);
-                if (recursive)
+                if (recursive && deferredDirs)
+                    deferredDirs->Push(MakePair(path + fileName, result.Size()));
+                else if (recursive)
                     ScanDirInternal(result, path + fileName, startPath, filter, flags, recursive);
             }
             else if (flags & SCAN_FILES)
@@ -838,7 +976,12 @@ void FileSystem::ScanDirInternal(Vector<String>& result, String path, const Stri
                     if (flags & SCAN_DIRS)
                         result.Push(deltaPath + fileName);
                     if (recursive && fileName != "." && fileName != "..")
-                        ScanDirInternal(result, path + fileName, startPath, filter, flags, recursive);
+                    {
+                        if (deferredDirs)
+                            deferredDirs->Push(MakePair(path + fileName, result.Size()));
+                        else
+                            ScanDirInternal(result, path + fileName, startPath, filter, flags, recursive);
+                    }
                 }
                 else if (flags & SCAN_FILES)
                 {
@@ -865,15 +1008,35 @@ void FileSystem::ScanDirInternal(Vector<String>& result, String path, const Stri
             bool normalEntry = fileName != "." && fileName != "..";
             if (normalEntry && !(flags & SCAN_HIDDEN) && fileName.StartsWith("."))
                 continue;
-            String pathAndName = path + fileName;
-            if (!stat(pathAndName.CString(), &st))
+
+            // Use the entry type when the file system provides it to avoid a stat() call. Symbolic links still
+            // need one to find out what they point to
+            bool found = true;
+            bool isDirectory;
+#ifdef DT_DIR
+            if (de->d_type != DT_UNKNOWN && de->d_type != DT_LNK)
+                isDirectory = de->d_type == DT_DIR;
+            else
+#endif
+            {
+                String pathAndName = path + fileName;
+                found = !stat(pathAndName.CString(), &st);
+                isDirectory = found && (st.st_mode & S_IFDIR);
+            }
+
+            if (found)
             {
-                if (st.st_mode & S_IFDIR)
+                if (isDirectory)
                 {
                     if (flags & SCAN_DIRS)
                         result.Push(deltaPath + fileName);
                     if (recursive && normalEntry)
-                        ScanDirInternal(result, path + fileName, startPath, filter, flags, recursive);
+                    {
+                        if (deferredDirs)
+                            deferredDirs->Push(MakePair(path + fileName, result.Size()));
+                        else
+                            ScanDirInternal(result, path + fileName, startPath, filter, flags, recursive);
+                    }
                 }
                 else if (flags & SCAN_FILES)
                 {
@@ -11,6 +11,7 @@ namespace Urho3D
 {
 
 class AsyncExecRequest;
+struct WorkItem;
 
 /// Return files.
 static const unsigned SCAN_FILES = 0x1;
@@ -78,7 +79,7 @@ public:
     bool FileExists(const String& fileName) const;
     /// Check if a directory exists.
     bool DirExists(const String& pathName) const;
-    /// Scan a directory for specified files.
+    /// Scan a directory for specified files. Recursive scans from the main thread are split between the worker threads.
     void ScanDir(Vector<String>& result, const String& pathName, const String& filter, unsigned flags, bool recursive) const;
     /// Return the program's directory.
     /// @property
@@ -93,9 +94,13 @@ public:
     String GetTemporaryDir() const;
 
 private:
-    /// Scan directory, called internally.
-    void ScanDirInternal
-        (Vector<String>& result, String path, const String& startPath, const String& filter, unsigned flags, bool recursive) const;
+    /// Scan directory, called internally. If deferred directories are given, subdirectories are added to them along with the result position they would have been recursed into at, instead of being recursed into.
+    void ScanDirInternal(Vector<String>& result, String path, const String& startPath, const String& filter, unsigned flags,
+        bool recursive, Vector<Pair<String, i32>>* deferredDirs = nullptr) const;
+    /// Scan directory recursively using the worker threads, called internally.
+    void ScanDirParallel(Vector<String>& result, const String& startPath, const String& filter, unsigned flags) const;
+    /// Scan a subdirectory in a worker thread.
+    static void ScanDirWork(const WorkItem* item, i32 threadIndex);
     /// Handle begin frame event to check for completed async executions.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
     /// Handle a console command event.
@@ -12,6 +12,7 @@
 #ifdef _WIN32
 #include "../Engine/WinWrapped.h"
 #elif __linux__
+#include <poll.h>
 #include <sys/inotify.h>
 extern "C"
 {
@@ -31,6 +32,218 @@ namespace Urho3D
 static const unsigned BUFFERSIZE = 4096;
 #endif
 
+#ifdef __linux__
+/// Milliseconds the inotify reader thread waits for events before checking whether it should exit.
+static const int INOTIFY_POLL_TIMEOUT = 100;
+/// Events watched with inotify.
+static const unsigned INOTIFY_FLAGS = IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO;
+
+/// Single inotify instance and reader thread shared by all file watchers, so that watching many resource directories does not need one thread and one instance each.
+class InotifyReader : public RefCounted, public Thread
+{
+public:
+    /// Construct.
+    InotifyReader() :
+        handle_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+    {
+    }
+
+    /// Destruct. Stop the reader thread.
+    ~InotifyReader() override
+    {
+        Stop();
+        if (handle_ >= 0)
+            close(handle_);
+    }
+
+    /// Return the shared instance, creating it if no watcher holds it.
+    static SharedPtr<InotifyReader> Get()
+    {
+        static WeakPtr<InotifyReader> instance;
+        static Mutex instanceMutex;
+
+        MutexLock lock(instanceMutex);
+        SharedPtr<InotifyReader> reader = instance.Lock();
+        if (!reader)
+        {
+            reader = new InotifyReader();
+            instance = reader;
+        }
+        return reader;
+    }
+
+    /// Watch a directory for a file watcher. The subdirectory is relative to the watched path, with a trailing slash, or empty for the path itself. Return true if successful.
+    bool AddWatch(FileWatcher* watcher, const String& subDir)
+    {
+        if (handle_ < 0)
+            return false;
+
+        MutexLock lock(watchesMutex_);
+        if (!AddWatchInternal(watcher, subDir))
+            return false;
+
+        if (!IsStarted())
+            Run();
+        return true;
+    }
+
+    /// Remove all watches of a file watcher. No changes are added to it after this returns.
+    void RemoveWatches(FileWatcher* watcher)
+    {
+        MutexLock lock(watchesMutex_);
+        for (HashMap<int, Vector<Watch>>::Iterator i = watches_.Begin(); i != watches_.End();)
+        {
+            Vector<Watch>& watches = i->second_;
+            for (i32 j = watches.Size() - 1; j >= 0; --j)
+            {
+                if (watches[j].watcher_ == watcher)
+                    watches.Erase(j);
+            }
+
+            // The same directory may be watched through several watchers, keep it while any of them remain
+            if (watches.Empty())
+            {
+                inotify_rm_watch(handle_, i->first_);
+                i = watches_.Erase(i);
+            }
+            else
+                ++i;
+        }
+    }
+
+    /// Read events until stopped.
+    void ThreadFunction() override
+    {
+        URHO3D_PROFILE_THREAD("FileWatcher Thread");
+
+        alignas(inotify_event) unsigned char buffer[BUFFERSIZE];
+        pollfd fds{handle_, POLLIN, 0};
+
+        while (shouldRun_)
+        {
+            if (poll(&fds, 1, INOTIFY_POLL_TIMEOUT) <= 0)
+                continue;
+
+            // Drain everything queued so that a burst of changes is handled under one lock
+            MutexLock lock(watchesMutex_);
+            for (;;)
+            {
+                auto length = (int)read(handle_, buffer, sizeof(buffer));
+                if (length <= 0)
+                    break;
+
+                int i = 0;
+                while (i < length)
+                {
+                    auto* event = (inotify_event*)&buffer[i];
+                    HandleEvent(event);
+                    i += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+    }
+
+private:
+    /// Watched directory of a file watcher.
+    struct Watch
+    {
+        /// File watcher.
+        FileWatcher* watcher_;
+        /// Subdirectory relative to the watched path.
+        String subDir_;
+    };
+
+    /// Watch a directory and, if the watcher watches subdirectories, the directories below it. Called with the watches mutex held.
+    bool AddWatchInternal(FileWatcher* watcher, const String& subDir)
+    {
+        if (!AddDirWatch(watcher, subDir))
+            return false;
+
+        if (watcher->watchSubDirs_)
+        {
+            Vector<String> subDirs;
+            watcher->fileSystem_->ScanDir(subDirs, watcher->path_ + subDir, "*", SCAN_DIRS, true);
+            for (const String& dir : subDirs)
+            {
+                // Don't watch ./ or ../ sub-directories
+                String subDirPath = AddTrailingSlash(subDir + dir);
+                if (!subDirPath.EndsWith("./") && !AddDirWatch(watcher, subDirPath))
+                    URHO3D_LOGERROR("Failed to start watching subdirectory path " + watcher->path_ + subDirPath);
+            }
+        }
+
+        return true;
+    }
+
+    /// Watch a single directory. Called with the watches mutex held.
+    bool AddDirWatch(FileWatcher* watcher, const String& subDir)
+    {
+        int wd = inotify_add_watch(handle_, (watcher->path_ + subDir).CString(), INOTIFY_FLAGS);
+        if (wd < 0)
+            return false;
+
+        // Adding an already watched directory returns its existing descriptor
+        Vector<Watch>& watches = watches_[wd];
+        for (const Watch& watch : watches)
+        {
+            if (watch.watcher_ == watcher)
+                return true;
+        }
+        watches.Push({watcher, subDir});
+        return true;
+    }
+
+    /// Pass an event to the watchers of its directory. Called with the watches mutex held.
+    void HandleEvent(const inotify_event* event)
+    {
+        if (event->mask & IN_Q_OVERFLOW)
+        {
+            URHO3D_LOGWARNING("File watcher event queue overflowed, some file changes were not noticed");
+            return;
+        }
+
+        HashMap<int, Vector<Watch>>::Iterator i = watches_.Find(event->wd);
+        if (i == watches_.End())
+            return;
+
+        // The directory was removed or unmounted and the kernel dropped its watch
+        if (event->mask & IN_IGNORED)
+        {
+            watches_.Erase(i);
+            return;
+        }
+
+        // Creations and deletions go to the watchers that want them, as they are not content changes to reload
+        bool modified = event->mask & (IN_MODIFY | IN_MOVE);
+        bool listChanged = event->mask & (IN_CREATE | IN_DELETE | IN_MOVE);
+        if (!event->len || !(modified || listChanged))
+            return;
+
+        // Copy, as watching a new directory below may rehash the map
+        Vector<Watch> watches = i->second_;
+        for (const Watch& watch : watches)
+        {
+            String fileName = watch.subDir_ + event->name;
+            if (modified)
+                watch.watcher_->AddChange(fileName);
+            if (listChanged && watch.watcher_->reportFileListChanges_)
+                watch.watcher_->AddFileListChange(fileName);
+
+            // Directories created or moved in after watching started need their own watches
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)) && watch.watcher_->watchSubDirs_)
+                AddWatchInternal(watch.watcher_, AddTrailingSlash(fileName));
+        }
+    }
+
+    /// Watches by inotify watch descriptor. Several watchers may share a descriptor when their directories overlap.
+    HashMap<int, Vector<Watch>> watches_;
+    /// Mutex for the watches.
+    Mutex watchesMutex_;
+    /// Inotify instance handle.
+    int handle_;
+};
+#endif
+
 FileWatcher::FileWatcher(Context* context) :
     Object(context),
     fileSystem_(GetSubsystem<FileSystem>()),
@@ -38,9 +251,7 @@ FileWatcher::FileWatcher(Context* context) :
     watchSubDirs_(false)
 {
 #ifdef URHO3D_FILEWATCHER
-#ifdef __linux__
-    watchHandle_ = inotify_init();
-#elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
+#if defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
     supported_ = IsFileWatcherSupported();
 #endif
 #endif
@@ -49,11 +260,6 @@ FileWatcher::FileWatcher(Context* context) :
 FileWatcher::~FileWatcher()
 {
     StopWatching();
-#ifdef URHO3D_FILEWATCHER
-#ifdef __linux__
-    close(watchHandle_);
-#endif
-#endif
 }
 
 bool FileWatcher::StartWatching(const String& pathName, bool watchSubDirs)
@@ -95,46 +301,19 @@ bool FileWatcher::StartWatching(const String& pathName, bool watchSubDirs)
         return false;
     }
 #elif defined(__linux__)
-    int flags = IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO;
-    int handle = inotify_add_watch(watchHandle_, pathName.CString(), (unsigned)flags);
+    path_ = AddTrailingSlash(pathName);
+    watchSubDirs_ = watchSubDirs;
+    reader_ = InotifyReader::Get();
 
-    if (handle < 0)
+    if (!reader_->AddWatch(this, String::EMPTY))
     {
         URHO3D_LOGERROR("Failed to start watching path " + pathName);
+        reader_.Reset();
+        path_.Clear();
         return false;
     }
     else
     {
-        // Store the root path here when reconstructed with inotify later
-        dirHandle_[handle] = "";
-        path_ = AddTrailingSlash(pathName);
-        watchSubDirs_ = watchSubDirs;
-
-        if (watchSubDirs_)
-        {
-            Vector<String> subDirs;
-            fileSystem_->ScanDir(subDirs, pathName, "*", SCAN_DIRS, true);
-
-            for (unsigned i = 0; i < subDirs.Size(); ++i)
-            {
-                String subDirFullPath = AddTrailingSlash(path_ + subDirs[i]);
-
-                // Don't watch ./ or ../ sub-directories
-                if (!subDirFullPath.EndsWith("./"))
-                {
-                    handle = inotify_add_watch(watchHandle_, subDirFullPath.CString(), (unsigned)flags);
-                    if (handle < 0)
-                        URHO3D_LOGERROR("Failed to start watching subdirectory path " + subDirFullPath);
-                    else
-                    {
-                        // Store sub-directory to reconstruct later from inotify
-                        dirHandle_[handle] = AddTrailingSlash(subDirs[i]);
-                    }
-                }
-            }
-        }
-        Run();
-
         URHO3D_LOGDEBUG("Started watching path " + pathName);
         return true;
     }
@@ -172,6 +351,17 @@ bool FileWatcher::StartWatching(const String& pathName, bool watchSubDirs)
 
 void FileWatcher::StopWatching()
 {
+#ifdef __linux__
+    // The shared reader thread keeps running for the other watchers
+    if (reader_)
+    {
+        reader_->RemoveWatches(this);
+        reader_.Reset();
+
+        URHO3D_LOGDEBUG("Stopped watching path " + path_);
+        path_.Clear();
+    }
+#else
     if (handle_)
     {
         shouldRun_ = false;
@@ -194,10 +384,6 @@ void FileWatcher::StopWatching()
 
 #ifdef _WIN32
         CloseHandle((HANDLE)dirHandle_);
-#elif defined(__linux__)
-        for (HashMap<int, String>::Iterator i = dirHandle_.Begin(); i != dirHandle_.End(); ++i)
-            inotify_rm_watch(watchHandle_, i->first_);
-        dirHandle_.Clear();
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
         CloseFileWatcher(watcher_);
 #endif
@@ -209,6 +395,7 @@ void FileWatcher::StopWatching()
         URHO3D_LOGDEBUG("Stopped watching path " + path_);
         path_.Clear();
     }
+#endif
 }
 
 void FileWatcher::SetDelay(float interval)
@@ -232,7 +419,8 @@ void FileWatcher::ThreadFunction()
             BUFFERSIZE,
             watchSubDirs_,
             FILE_NOTIFY_CHANGE_FILE_NAME |
-            FILE_NOTIFY_CHANGE_LAST_WRITE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE |
+            (reportFileListChanges_ ? FILE_NOTIFY_CHANGE_DIR_NAME : 0),
             &bytesFilled,
             nullptr,
             nullptr))
@@ -243,7 +431,13 @@ void FileWatcher::ThreadFunction()
             {
                 FILE_NOTIFY_INFORMATION* record = (FILE_NOTIFY_INFORMATION*)&buffer[offset];
 
-                if (record->Action == FILE_ACTION_MODIFIED || record->Action == FILE_ACTION_RENAMED_NEW_NAME)
+                // Additions and removals go to the file list changes only, as they are not content changes to reload
+                bool modified = record->Action == FILE_ACTION_MODIFIED || record->Action == FILE_ACTION_RENAMED_NEW_NAME;
+                bool listChanged = reportFileListChanges_ && (record->Action == FILE_ACTION_ADDED ||
+                    record->Action == FILE_ACTION_REMOVED || record->Action == FILE_ACTION_RENAMED_OLD_NAME ||
+                    record->Action == FILE_ACTION_RENAMED_NEW_NAME);
+
+                if (modified || listChanged)
                 {
                     String fileName;
                     const wchar_t* src = record->FileName;
@@ -252,7 +446,10 @@ void FileWatcher::ThreadFunction()
                         fileName.AppendUTF8(String::DecodeUTF16(src));
 
                     fileName = GetInternalPath(fileName);
-                    AddChange(fileName);
+                    if (modified)
+                        AddChange(fileName);
+                    if (listChanged)
+                        AddFileListChange(fileName);
                 }
 
                 if (!record->NextEntryOffset)
@@ -262,34 +459,6 @@ void FileWatcher::ThreadFunction()
             }
         }
     }
-#elif defined(__linux__)
-    unsigned char buffer[BUFFERSIZE];
-
-    while (shouldRun_)
-    {
-        int i = 0;
-        auto length = (int)read(watchHandle_, buffer, sizeof(buffer));
-
-        if (length < 0)
-            return;
-
-        while (i < length)
-        {
-            auto* event = (inotify_event*)&buffer[i];
-
-            if (event->len > 0)
-            {
-                if (event->mask & IN_MODIFY || event->mask & IN_MOVE)
-                {
-                    String fileName;
-                    fileName = dirHandle_[event->wd] + event->name;
-                    AddChange(fileName);
-                }
-            }
-
-            i += sizeof(inotify_event) + event->len;
-        }
-    }
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
     while (shouldRun_)
     {
@@ -315,6 +484,25 @@ void FileWatcher::AddChange(const String& fileName)
     changes_[fileName].Reset();
 }
 
+void FileWatcher::AddFileListChange(const String& fileName)
+{
+    MutexLock lock(changesMutex_);
+    fileListChanges_.Insert(fileName);
+}
+
+bool FileWatcher::GetNextFileListChanges(Vector<String>& dest)
+{
+    MutexLock lock(changesMutex_);
+
+    if (fileListChanges_.Empty())
+        return false;
+
+    for (const String& fileName : fileListChanges_)
+        dest.Push(fileName);
+    fileListChanges_.Clear();
+    return true;
+}
+
 bool FileWatcher::GetNextChange(String& dest)
 {
     MutexLock lock(changesMutex_);
@@ -339,4 +527,26 @@ bool FileWatcher::GetNextChange(String& dest)
     }
 }
 
+bool FileWatcher::GetNextChanges(Vector<String>& dest)
+{
+    MutexLock lock(changesMutex_);
+
+    auto delayMsec = (unsigned)(delay_ * 1000.0f);
+    i32 oldSize = dest.Size();
+
+    // One pass over the pending changes instead of a search per change. Files still being written stay for a later frame
+    for (HashMap<String, Timer>::Iterator i = changes_.Begin(); i != changes_.End();)
+    {
+        if (i->second_.GetMSec(false) >= delayMsec)
+        {
+            dest.Push(i->first_);
+            i = changes_.Erase(i);
+        }
+        else
+            ++i;
+    }
+
+    return dest.Size() > oldSize;
+}
+
 }
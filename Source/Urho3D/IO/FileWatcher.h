@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "../Container/HashSet.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Core/Thread.h"
@@ -12,19 +13,26 @@ namespace Urho3D
 {
 
 class FileSystem;
+#ifdef __linux__
+class InotifyReader;
+#endif
 
-/// Watches a directory and its subdirectories for files being modified.
+/// Watches a directory and its subdirectories for files being modified. On Linux all watchers share one inotify instance and reader thread.
 class URHO3D_API FileWatcher : public Object, public Thread
 {
     URHO3D_OBJECT(FileWatcher, Object);
 
+#ifdef __linux__
+    friend class InotifyReader;
+#endif
+
 public:
     /// Construct.
     explicit FileWatcher(Context* context);
     /// Destruct.
     ~FileWatcher() override;
 
-    /// Directory watching loop.
+    /// Directory watching loop. Unused on Linux, where the shared inotify reader thread does the watching.
     void ThreadFunction() override;
 
     /// Start watching a directory. Return true if successful.
@@ -37,6 +45,14 @@ public:
     void AddChange(const String& fileName);
     /// Return a file change (true if was found, false if not).
     bool GetNextChange(String& dest);
+    /// Return all file changes whose delay has passed as one batch, each file once. Appends to the destination. Return true if any were found.
+    bool GetNextChanges(Vector<String>& dest);
+    /// Set whether to also report files and directories being added or removed. They are returned separately by GetNextFileListChanges(), without delay. Default false.
+    void SetReportFileListChanges(bool enable) { reportFileListChanges_ = enable; }
+    /// Add a file or directory addition or removal into the file list changes queue.
+    void AddFileListChange(const String& fileName);
+    /// Return all files and directories added or removed since the last call, each once. Appends to the destination. Return true if any were found.
+    bool GetNextFileListChanges(Vector<String>& dest);
 
     /// Return the path being watched, or empty if not watching.
     const String& GetPath() const { return path_; }
@@ -44,6 +60,9 @@ public:
     /// Return the delay in seconds for notifying file changes.
     float GetDelay() const { return delay_; }
 
+    /// Return whether additions and removals are reported.
+    bool GetReportFileListChanges() const { return reportFileListChanges_; }
+
 private:
     /// Filesystem.
     SharedPtr<FileSystem> fileSystem_;
@@ -51,12 +70,16 @@ private:
     String path_;
     /// Pending changes. These will be returned and removed from the list when their timer has exceeded the delay.
     HashMap<String, Timer> changes_;
+    /// Pending file and directory additions and removals.
+    HashSet<String> fileListChanges_;
     /// Mutex for the change buffer.
     Mutex changesMutex_;
     /// Delay in seconds for notifying changes.
     float delay_;
     /// Watch subdirectories flag.
     bool watchSubDirs_;
+    /// Report additions and removals flag.
+    bool reportFileListChanges_{};
 
 #ifdef _WIN32
 
@@ -65,10 +88,8 @@ private:
 
 #elif __linux__
 
-    /// HashMap for the directory and sub-directories (needed for inotify's int handles).
-    HashMap<int, String> dirHandle_;
-    /// Linux inotify needs a handle.
-    int watchHandle_;
+    /// Shared inotify reader holding the watches of the directory and its subdirectories.
+    SharedPtr<InotifyReader> reader_;
 
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
 
@@ -12,8 +12,10 @@
 #include "../IO/File.h"
 #include "../IO/IOEvents.h"
 #include "../IO/Log.h"
+#include "../IO/VectorBuffer.h"
 
 #include <cstdio>
+#include <ctime>
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -39,9 +41,463 @@ const char* logLevelPrefixes[] =
 
 static Log* logInstance = nullptr;
 static bool threadErrorDisplayed = false;
+/// Number of other threads than the main thread queueing a message for the background writer. Stopping the writer waits for it to reach zero, so that no message is left half-queued.
+static std::atomic<i32> numQueueingThreads{};
+
+/// Default number of messages queued for the background writer.
+static const i32 DEFAULT_ASYNC_QUEUE_SIZE = 4096;
+/// Maximum number of messages the background writer writes in one batch.
+static const i32 MAX_ASYNC_BATCH_SIZE = 256;
+
+/// Marks another thread than the main thread as queueing a message for the background writer while in scope.
+struct QueueingThreadScope
+{
+    /// Construct. The increment must be visible before the caller checks whether the writer is enabled.
+    QueueingThreadScope() { numQueueingThreads.fetch_add(1, std::memory_order_seq_cst); }
+    /// Destruct.
+    ~QueueingThreadScope() { numQueueingThreads.fetch_sub(1, std::memory_order_release); }
+};
+
+/// Wait until no other thread is queueing a message for the background writer. The writer must have been disabled first.
+static void WaitForQueueingThreads()
+{
+    while (numQueueingThreads.load(std::memory_order_acquire) > 0)
+        Time::Sleep(0);
+}
+
+/// Format a time in the same way as Time::GetTimeStamp(), but thread-safely.
+static String FormatTimeStamp(time_t time)
+{
+    tm local;
+#ifdef _WIN32
+    localtime_s(&local, &time);
+#else
+    localtime_r(&time, &local);
+#endif
+    char buffer[64];
+    size_t length = strftime(buffer, sizeof buffer, "%a %b %e %H:%M:%S %Y", &local);
+    return String(buffer, (i32)length);
+}
+
+/// Append the bytes of a value to a buffer.
+static void AppendBytes(Vector<u8>& dest, const void* data, i32 size)
+{
+    i32 oldSize = dest.Size();
+    dest.Resize(oldSize + size);
+    memcpy(dest.Buffer() + oldSize, data, (size_t)size);
+}
+
+/// Read a value stored by AppendBytes().
+template <class T> static T ReadBytes(const u8*& source)
+{
+    T value;
+    memcpy(&value, source, sizeof value);
+    source += sizeof value;
+    return value;
+}
+
+/// Store the arguments of a format string so that the background writer can format the message later with
+/// FormatCapturedArgs(). Supports the same specifiers as String::AppendWithFormatArgs(). C strings are copied, as they
+/// may not outlive the log call. Return false if the format string has an unsupported specifier.
+static bool CaptureFormatArgs(Vector<u8>& dest, const char* format, va_list args)
+{
+    dest.Clear();
+
+    for (const char* pos = strchr(format, '%'); pos; pos = strchr(pos + 2, '%'))
+    {
+        switch (pos[1])
+        {
+        case 'd':
+        case 'i':
+        case 'c':
+        case 'x':
+        case 'p':
+            {
+                int arg = va_arg(args, int);
+                AppendBytes(dest, &arg, sizeof arg);
+                break;
+            }
+
+        case 'u':
+            {
+                unsigned arg = va_arg(args, unsigned);
+                AppendBytes(dest, &arg, sizeof arg);
+                break;
+            }
+
+        case 'l':
+            {
+                unsigned long arg = va_arg(args, unsigned long);
+                AppendBytes(dest, &arg, sizeof arg);
+                break;
+            }
+
+        case 'f':
+            {
+                double arg = va_arg(args, double);
+                AppendBytes(dest, &arg, sizeof arg);
+                break;
+            }
+
+        case 's':
+            {
+                const char* arg = va_arg(args, const char*);
+                if (!arg)
+                    arg = "";
+                AppendBytes(dest, arg, (i32)strlen(arg) + 1);
+                break;
+            }
+
+        case '%':
+            break;
+
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Format a message from a format string and the arguments stored by CaptureFormatArgs(), with the same result as
+/// String::AppendWithFormatArgs().
+static void FormatCapturedArgs(String& dest, const String& format, const u8* args)
+{
+    dest.Clear();
+    i32 lastPos = 0;
+
+    for (i32 pos = format.Find('%'); pos != String::NPOS; pos = format.Find('%', lastPos))
+    {
+        dest.Append(format.CString() + lastPos, pos - lastPos);
+        char specifier = format[pos + 1];
+        lastPos = pos + 2;
+
+        switch (specifier)
+        {
+        case 'd':
+        case 'i':
+            dest += String(ReadBytes<int>(args));
+            break;
+
+        case 'u':
+            dest += String(ReadBytes<unsigned>(args));
+            break;
+
+        case 'l':
+            dest += String(ReadBytes<unsigned long>(args));
+            break;
+
+        case 'f':
+            dest += String(ReadBytes<double>(args));
+            break;
+
+        case 'c':
+            dest += (char)ReadBytes<int>(args);
+            break;
+
+        case 's':
+            {
+                auto* arg = reinterpret_cast<const char*>(args);
+                i32 length = (i32)strlen(arg);
+                dest.Append(arg, length);
+                args += length + 1;
+                break;
+            }
+
+        case 'x':
+            {
+                char buf[CONVERSION_BUFFER_LENGTH];
+                int arglen = ::sprintf(buf, "%x", ReadBytes<int>(args));
+                dest.Append(buf, arglen);
+                break;
+            }
+
+        case 'p':
+            {
+                char buf[CONVERSION_BUFFER_LENGTH];
+                int arglen = ::sprintf(buf, "%p", reinterpret_cast<void*>(ReadBytes<int>(args)));
+                dest.Append(buf, arglen);
+                break;
+            }
+
+        default:
+            dest += '%';
+            break;
+        }
+    }
+
+    dest.Append(format.CString() + lastPos, format.Length() - lastPos);
+}
+
+/// Preallocated slot of the background writer's message queue. The message string keeps its capacity between uses.
+struct LogRecord
+{
+    /// Sequence number that hands the slot over between the logging threads and the writer.
+    std::atomic<u32> sequence_;
+    /// Message text, or the format string if the message is formatted by the writer.
+    String message_;
+    /// Arguments of the format string stored by CaptureFormatArgs().
+    Vector<u8> formatArgs_;
+    /// Time of the log call.
+    time_t time_;
+    /// Message level. LOG_RAW for raw messages.
+    int level_;
+    /// Error flag for raw messages.
+    bool error_;
+    /// Whether the log message event still needs to be sent from the main thread.
+    bool sendEvent_;
+    /// Whether the message is a format string to be formatted by the writer.
+    bool deferred_;
+};
+
+/// Background thread that writes queued log messages to the console and the log file. Fed by a bounded lock-free
+/// multiple producer, single consumer queue.
+class LogWriter : public Thread, public RefCounted
+{
+public:
+    /// Construct with queue size, which must be a power of two.
+    LogWriter(Log* log, i32 size) :
+        records_(new LogRecord[size]),
+        mask_((u32)size - 1),
+        log_(log)
+    {
+        for (i32 i = 0; i < size; ++i)
+            records_[i].sequence_.store((u32)i, std::memory_order_relaxed);
+    }
+
+    /// Queue a message. Return false if the queue is full. Safe to call from any thread.
+    bool Push(int level, const String& message, bool error, bool sendEvent)
+    {
+        u32 pos;
+        LogRecord* record = Acquire(pos);
+        if (!record)
+            return false;
+
+        record->message_ = message;
+        record->deferred_ = false;
+        Publish(record, pos, level, error, sendEvent);
+        return true;
+    }
+
+    /// Queue a message to be formatted by the writer. Return false if the queue is full. Safe to call from any thread.
+    bool PushFormat(int level, const char* format, va_list args, bool sendEvent)
+    {
+        u32 pos;
+        LogRecord* record = Acquire(pos);
+        if (!record)
+            return false;
+
+        va_list argsCopy;
+        va_copy(argsCopy, args);
+        record->message_ = format;
+        record->deferred_ = CaptureFormatArgs(record->formatArgs_, format, argsCopy);
+        va_end(argsCopy);
+
+        // Let String report the unsupported specifier
+        if (!record->deferred_)
+        {
+            record->message_.Clear();
+            record->message_.AppendWithFormatArgs(format, args);
+        }
+
+        Publish(record, pos, level, false, sendEvent);
+        return true;
+    }
+
+    /// Write a batch of queued messages. Return true if any were written. Must not be called from several threads at once.
+    bool Process()
+    {
+        u32 pos = dequeuePos_.load(std::memory_order_relaxed);
+        i32 count = 0;
+        bool timeStamp = log_->timeStamp_;
+        bool quiet = log_->quiet_;
+        bool binary = log_->binary_;
+        File* file = log_->logFile_;
+
+        // Report dropped messages before the ones that made it through
+        u32 numDropped = log_->numDroppedMessages_.load(std::memory_order_relaxed);
+        if (numDropped != numReportedDropped_)
+        {
+            AddOutput(LOG_WARNING, "Log queue full, dropped " + String(numDropped - numReportedDropped_) + " messages",
+                time(nullptr), false, timeStamp, quiet, binary, file, false);
+            numReportedDropped_ = numDropped;
+        }
+
+        while (count < MAX_ASYNC_BATCH_SIZE)
+        {
+            LogRecord& record = records_[pos & mask_];
+            if (record.sequence_.load(std::memory_order_acquire) != pos + 1)
+                break;
+
+            if (record.deferred_)
+                FormatCapturedArgs(deferredMessage_, record.message_, record.formatArgs_.Buffer());
+            AddOutput(record.level_, record.deferred_ ? deferredMessage_ : record.message_, record.time_, record.error_,
+                timeStamp, quiet, binary, file, record.sendEvent_);
+            record.sequence_.store(pos + mask_ + 1, std::memory_order_release);
+            ++pos;
+            ++count;
+        }
+
+        dequeuePos_.store(pos, std::memory_order_release);
+
+        // Write the whole batch with one call per stream
+        if (outputBatch_.Length())
+        {
+            PrintUnicode(outputBatch_, false);
+            outputBatch_.Clear();
+        }
+        if (errorBatch_.Length())
+        {
+            PrintUnicode(errorBatch_, true);
+            errorBatch_.Clear();
+        }
+        if (fileBatch_.GetSize())
+        {
+            if (file)
+            {
+                file->Write(fileBatch_.GetData(), fileBatch_.GetSize());
+                file->Flush();
+            }
+            fileBatch_.Clear();
+        }
+        if (eventMessages_.Size())
+        {
+            MutexLock lock(log_->logMutex_);
+            for (const StoredLogMessage& message : eventMessages_)
+                log_->writtenMessages_.Push(message);
+            eventMessages_.Clear();
+        }
+
+        return count > 0;
+    }
+
+    /// Return number of messages queued since the writer was created.
+    u32 GetEnqueuePosition() const { return enqueuePos_.load(std::memory_order_acquire); }
+    /// Return number of messages written since the writer was created.
+    u32 GetDequeuePosition() const { return dequeuePos_.load(std::memory_order_acquire); }
+
+    /// Write messages until stopped.
+    void ThreadFunction() override
+    {
+        while (shouldRun_)
+        {
+            if (!Process())
+                Time::Sleep(1);
+        }
+    }
+
+private:
+    /// Claim the slot at the next queue position. Return null if the queue is full.
+    LogRecord* Acquire(u32& pos)
+    {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            LogRecord* record = &records_[pos & mask_];
+            i32 diff = (i32)(record->sequence_.load(std::memory_order_acquire) - pos);
+            if (diff == 0)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    return record;
+            }
+            else if (diff < 0)
+                return nullptr;
+            else
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    /// Fill in the rest of a claimed slot and hand it over to the writer.
+    void Publish(LogRecord* record, u32 pos, int level, bool error, bool sendEvent)
+    {
+        record->time_ = time(nullptr);
+        record->level_ = level;
+        record->error_ = error;
+        record->sendEvent_ = sendEvent;
+        record->sequence_.store(pos + 1, std::memory_order_release);
+    }
+
+    /// Format a message and add it to the output batches.
+    void AddOutput(int level, const String& message, time_t time, bool error, bool timeStamp, bool quiet, bool binary,
+        File* file, bool sendEvent)
+    {
+        String formattedMessage;
+        if (level != LOG_RAW)
+        {
+            error = level == LOG_ERROR;
+            formattedMessage = logLevelPrefixes[level];
+            formattedMessage += ": " + message;
+            if (timeStamp)
+                formattedMessage = "[" + FormatTimeStamp(time) + "] " + formattedMessage;
+        }
+        else
+            formattedMessage = message;
+
+#if defined(__ANDROID__)
+        int androidLevel = level != LOG_RAW ? ANDROID_LOG_VERBOSE + level : (error ? ANDROID_LOG_ERROR : ANDROID_LOG_INFO);
+        if (!quiet || error)
+            __android_log_print(androidLevel, "Urho3D", "%s", message.CString());
+#elif defined(IOS) || defined(TVOS)
+        SDL_IOS_LogMessage(message.CString());
+#else
+        // If in quiet mode, still print the error message to the standard error stream
+        if (!quiet || error)
+        {
+            String& batch = error ? errorBatch_ : outputBatch_;
+            batch += formattedMessage;
+            if (level != LOG_RAW)
+                batch += '\n';
+        }
+#endif
+
+        if (file)
+        {
+            if (binary)
+            {
+                fileBatch_.WriteU32((u32)time);
+                fileBatch_.WriteI8((i8)level);
+                fileBatch_.WriteU8(error ? 1 : 0);
+                fileBatch_.WriteU32((u32)message.Length());
+                fileBatch_.Write(message.CString(), message.Length());
+            }
+            else if (level != LOG_RAW)
+                fileBatch_.WriteLine(formattedMessage);
+            else
+                fileBatch_.Write(formattedMessage.CString(), formattedMessage.Length());
+        }
+
+        if (sendEvent)
+            eventMessages_.Push(StoredLogMessage(formattedMessage, level != LOG_RAW ? level : (error ? LOG_ERROR : LOG_INFO), error));
+    }
+
+    /// Queue slots.
+    SharedArrayPtr<LogRecord> records_;
+    /// Mask to wrap queue positions to slot indices.
+    u32 mask_;
+    /// Next position to queue to. Kept on its own cache line, as all logging threads modify it.
+    alignas(64) std::atomic<u32> enqueuePos_{};
+    /// Next position to write from.
+    alignas(64) std::atomic<u32> dequeuePos_{};
+    /// Log subsystem.
+    Log* log_;
+    /// Number of dropped messages already reported.
+    u32 numReportedDropped_{};
+    /// Standard output batch.
+    String outputBatch_;
+    /// Standard error batch.
+    String errorBatch_;
+    /// Log file batch.
+    VectorBuffer fileBatch_;
+    /// Written messages from other threads waiting for their events.
+    Vector<StoredLogMessage> eventMessages_;
+    /// Message formatted by the writer.
+    String deferredMessage_;
+};
 
 Log::Log(Context* context) :
     Object(context),
+    asyncQueueSize_(DEFAULT_ASYNC_QUEUE_SIZE),
 #ifdef _DEBUG
     level_(LOG_DEBUG),
 #else
@@ -58,6 +514,15 @@ Log::Log(Context* context) :
 
 Log::~Log()
 {
+    // Other threads either finish queueing or see that the writer is disabled, and the writer is still running to make
+    // room for errors waiting for the queue
+    if (writer_)
+    {
+        async_.store(false, std::memory_order_seq_cst);
+        WaitForQueueingThreads();
+        StopWriter();
+    }
+
     logInstance = nullptr;
 }
 
@@ -74,14 +539,23 @@ void Log::Open(const String& fileName)
             Close();
     }
 
+    // The background writer uses the file, so stop it while the file changes
+    bool writerRunning = writer_ && writer_->IsStarted();
+    if (writerRunning)
+        StopWriter();
+
     logFile_ = new File(context_);
-    if (logFile_->Open(fileName, FILE_WRITE))
+    bool opened = logFile_->Open(fileName, FILE_WRITE);
+    if (!opened)
+        logFile_.Reset();
+
+    if (writerRunning)
+        writer_->Run();
+
+    if (opened)
         Write(LOG_INFO, "Opened log file " + fileName);
     else
-    {
-        logFile_.Reset();
         Write(LOG_ERROR, "Failed to create log file " + fileName);
-    }
 #endif
 }
 
@@ -90,8 +564,16 @@ void Log::Close()
 #if !defined(__ANDROID__) && !defined(IOS) && !defined(TVOS)
     if (logFile_ && logFile_->IsOpen())
     {
+        // Let the background writer write the queued messages to the file first
+        bool writerRunning = writer_ && writer_->IsStarted();
+        if (writerRunning)
+            StopWriter();
+
         logFile_->Close();
         logFile_.Reset();
+
+        if (writerRunning)
+            writer_->Run();
     }
 #endif
 }
@@ -117,6 +599,58 @@ void Log::SetQuiet(bool quiet)
     quiet_ = quiet;
 }
 
+void Log::SetAsync(bool enable)
+{
+    if (enable == async_)
+        return;
+
+    if (enable)
+    {
+        if (!writer_)
+            writer_ = new LogWriter(this, asyncQueueSize_);
+
+        if (!writer_->Run())
+        {
+            URHO3D_LOGERROR("Failed to start log writer thread");
+            return;
+        }
+
+        async_.store(true, std::memory_order_release);
+    }
+    else
+    {
+        async_.store(false, std::memory_order_seq_cst);
+        WaitForQueueingThreads();
+        StopWriter();
+    }
+}
+
+void Log::SetAsyncQueueSize(i32 size)
+{
+    if (writer_)
+    {
+        URHO3D_LOGWARNING("Log writer queue size can not be changed after the writer has been created");
+        return;
+    }
+
+    asyncQueueSize_ = (i32)NextPowerOfTwo((unsigned)Max(size, 2));
+}
+
+void Log::SetBinary(bool enable)
+{
+    binary_ = enable;
+}
+
+void Log::Flush()
+{
+    if (!async_)
+        return;
+
+    u32 target = writer_->GetEnqueuePosition();
+    while ((i32)(writer_->GetDequeuePosition() - target) < 0)
+        Time::Sleep(1);
+}
+
 void Log::WriteFormat(int level, const char* format, ...)
 {
     if (!logInstance)
@@ -129,10 +663,33 @@ void Log::WriteFormat(int level, const char* format, ...)
             return;
     }
 
-    // Forward to normal Write() after formatting the input
-    String message;
     va_list args;
     va_start(args, format);
+
+    // With the background writer, leave formatting to it unless the log message event needs the message right away
+    if (logInstance->async_.load(std::memory_order_acquire))
+    {
+        if (!Thread::IsMainThread())
+        {
+            QueueingThreadScope scope;
+            if (logInstance && logInstance->async_.load(std::memory_order_seq_cst))
+            {
+                WriteAsyncFormat(level, format, args, false);
+                va_end(args);
+                return;
+            }
+        }
+        else if (!logInstance->HasEventReceivers(E_LOGMESSAGE))
+        {
+            if (!logInstance->inWrite_)
+                WriteAsyncFormat(level, format, args, true);
+            va_end(args);
+            return;
+        }
+    }
+
+    // Forward to normal Write() after formatting the input
+    String message;
     message.AppendWithFormatArgs(format, args);
     va_end(args);
 
@@ -152,6 +709,27 @@ void Log::Write(int level, const String& message)
     if (level < LOG_TRACE || level >= LOG_NONE)
         return;
 
+    // With the background writer, filter and queue right away from any thread. Formatting happens in the writer
+    if (logInstance && logInstance->async_.load(std::memory_order_acquire))
+    {
+        if (logInstance->level_ > level)
+            return;
+
+        if (Thread::IsMainThread())
+        {
+            if (!logInstance->inWrite_ && WriteAsync(level, message, false))
+                SendLogMessageEvent(level, message, false);
+            return;
+        }
+
+        QueueingThreadScope scope;
+        if (logInstance && logInstance->async_.load(std::memory_order_seq_cst))
+        {
+            WriteAsync(level, message, false);
+            return;
+        }
+    }
+
     // If not in the main thread, store message for later processing
     if (!Thread::IsMainThread())
     {
@@ -168,6 +746,8 @@ void Log::Write(int level, const String& message)
     if (!logInstance || logInstance->level_ > level || logInstance->inWrite_)
         return;
 
+    logInstance->numMessages_[level - LOG_RAW].fetch_add(1, std::memory_order_relaxed);
+
     String formattedMessage = logLevelPrefixes[level];
     formattedMessage += ": " + message;
     logInstance->lastMessage_ = message;
@@ -211,6 +791,23 @@ void Log::Write(int level, const String& message)
 
 void Log::WriteRaw(const String& message, bool error)
 {
+    if (logInstance && logInstance->async_.load(std::memory_order_acquire))
+    {
+        if (Thread::IsMainThread())
+        {
+            if (!logInstance->inWrite_ && WriteAsync(LOG_RAW, message, error))
+                SendLogMessageEvent(LOG_RAW, message, error);
+            return;
+        }
+
+        QueueingThreadScope scope;
+        if (logInstance && logInstance->async_.load(std::memory_order_seq_cst))
+        {
+            WriteAsync(LOG_RAW, message, error);
+            return;
+        }
+    }
+
     // If not in the main thread, store message for later processing
     if (!Thread::IsMainThread())
     {
@@ -227,6 +824,7 @@ void Log::WriteRaw(const String& message, bool error)
     if (!logInstance || logInstance->inWrite_)
         return;
 
+    logInstance->numMessages_[LOG_RAW - LOG_RAW].fetch_add(1, std::memory_order_relaxed);
     logInstance->lastMessage_ = message;
 
 #if defined(__ANDROID__)
@@ -268,6 +866,95 @@ void Log::WriteRaw(const String& message, bool error)
     logInstance->inWrite_ = false;
 }
 
+bool Log::WriteAsync(int level, const String& message, bool error)
+{
+    // Messages from other threads get their events at the end of the frame, after the writer has formatted them
+    while (!logInstance->writer_->Push(level, message, error, !Thread::IsMainThread()))
+    {
+        if (!WaitForQueue(level, error))
+            return false;
+    }
+
+    logInstance->numMessages_[level - LOG_RAW].fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void Log::WriteAsyncFormat(int level, const char* format, va_list args, bool mainThread)
+{
+    // Messages from other threads get their events at the end of the frame, after the writer has formatted them.
+    // The main thread only gets here when nothing listens to the event
+    while (!logInstance->writer_->PushFormat(level, format, args, !mainThread))
+    {
+        if (!WaitForQueue(level, false))
+            return;
+    }
+
+    logInstance->numMessages_[level - LOG_RAW].fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Log::WaitForQueue(int level, bool error)
+{
+    // Error messages are never dropped
+    if (level != LOG_ERROR && !(level == LOG_RAW && error))
+    {
+        logInstance->numDroppedMessages_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // The main thread stops the writer while the log file changes, so make room itself in that case
+    if (Thread::IsMainThread() && !logInstance->writer_->IsStarted())
+        logInstance->writer_->Process();
+    else
+        Time::Sleep(1);
+
+    return true;
+}
+
+void Log::SendLogMessageEvent(int level, const String& message, bool error)
+{
+    logInstance->lastMessage_ = message;
+
+    // Formatting is left to the writer thread unless someone listens to the event
+    if (!logInstance->HasEventReceivers(E_LOGMESSAGE))
+        return;
+
+    String formattedMessage;
+    if (level != LOG_RAW)
+    {
+        formattedMessage = logLevelPrefixes[level];
+        formattedMessage += ": " + message;
+        if (logInstance->timeStamp_)
+            formattedMessage = "[" + Time::GetTimeStamp() + "] " + formattedMessage;
+    }
+    else
+    {
+        formattedMessage = message;
+        level = error ? LOG_ERROR : LOG_INFO;
+    }
+
+    logInstance->inWrite_ = true;
+
+    using namespace LogMessage;
+
+    VariantMap& eventData = logInstance->GetEventDataMap();
+    eventData[P_MESSAGE] = formattedMessage;
+    eventData[P_LEVEL] = level;
+    logInstance->SendEvent(E_LOGMESSAGE, eventData);
+
+    logInstance->inWrite_ = false;
+}
+
+void Log::StopWriter()
+{
+    writer_->Stop();
+
+    // Write what was queued before stopping. Messages that other threads queue after this stay in the queue until
+    // the writer runs again
+    while (writer_->Process())
+    {
+    }
+}
+
 void Log::HandleEndFrame(StringHash eventType, VariantMap& eventData)
 {
     // If the MainThreadID is not valid, processing this loop can potentially be endless
@@ -281,19 +968,45 @@ void Log::HandleEndFrame(StringHash eventType, VariantMap& eventData)
         return;
     }
 
-    MutexLock lock(logMutex_);
+    // Take the messages out before writing them. Writing may wait for the background writer, which takes the lock to
+    // hand over the messages it has written
+    List<StoredLogMessage> threadMessages;
+    List<StoredLogMessage> writtenMessages;
+    {
+        MutexLock lock(logMutex_);
+        threadMessages.Swap(threadMessages_);
+        writtenMessages.Swap(writtenMessages_);
+    }
 
     // Process messages accumulated from other threads (if any)
-    while (!threadMessages_.Empty())
+    while (!threadMessages.Empty())
     {
-        const StoredLogMessage& stored = threadMessages_.Front();
+        const StoredLogMessage& stored = threadMessages.Front();
 
         if (stored.level_ != LOG_RAW)
             Write(stored.level_, stored.message_);
         else
             WriteRaw(stored.message_, stored.error_);
 
-        threadMessages_.PopFront();
+        threadMessages.PopFront();
+    }
+
+    // Send events for messages from other threads that the background writer has written
+    while (!writtenMessages.Empty())
+    {
+        const StoredLogMessage& stored = writtenMessages.Front();
+
+        inWrite_ = true;
+
+        using namespace LogMessage;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_MESSAGE] = stored.message_;
+        eventData[P_LEVEL] = stored.level_;
+        SendEvent(E_LOGMESSAGE, eventData);
+
+        inWrite_ = false;
+        writtenMessages.PopFront();
     }
 }
 
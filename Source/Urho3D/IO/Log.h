@@ -8,6 +8,8 @@
 #include "../Core/Object.h"
 #include "../Core/StringUtils.h"
 
+#include <atomic>
+
 namespace Urho3D
 {
 
@@ -27,6 +29,7 @@ static const int LOG_ERROR = 4;
 static const int LOG_NONE = 5;
 
 class File;
+class LogWriter;
 
 /// Stored log message from another thread.
 struct StoredLogMessage
@@ -74,6 +77,16 @@ public:
     /// Set quiet mode ie. only print error entries to standard error stream (which is normally redirected to console also). Output to log file is not affected by this mode.
     /// @property
     void SetQuiet(bool quiet);
+    /// Set whether console and log file output is written by a background thread. Log calls then only queue the message, and drop it if the queue is full. Error messages are never dropped, but wait for room in the queue instead. Formatted messages are also formatted by the writer, unless the main thread has to send the log message event. Main thread only.
+    /// @property
+    void SetAsync(bool enable);
+    /// Set maximum number of messages queued for the background writer. Rounded up to a power of two. Takes effect when the background writer is first enabled.
+    void SetAsyncQueueSize(i32 size);
+    /// Set whether the background writer writes binary records to the log file instead of text lines. Each record is the u32 time in seconds since epoch, i8 level (-1 for raw), u8 error flag, u32 length and the UTF-8 message.
+    /// @property
+    void SetBinary(bool enable);
+    /// Wait until the background writer has written all messages queued so far. Main thread only.
+    void Flush();
 
     /// Return logging level.
     /// @property
@@ -83,7 +96,7 @@ public:
     /// @property
     bool GetTimeStamp() const { return timeStamp_; }
 
-    /// Return last log message.
+    /// Return last log message. With the background writer, messages from other threads and main thread messages left for the writer to format do not update it.
     /// @property
     String GetLastMessage() const { return lastMessage_; }
 
@@ -91,6 +104,20 @@ public:
     /// @property
     bool IsQuiet() const { return quiet_; }
 
+    /// Return whether output is written by a background thread.
+    /// @property
+    bool IsAsync() const { return async_; }
+
+    /// Return whether the background writer writes binary records to the log file.
+    /// @property
+    bool IsBinary() const { return binary_; }
+
+    /// Return number of messages of a level that have been output or queued for output. LOG_RAW counts raw messages.
+    u32 GetNumMessages(int level) const { return level >= LOG_RAW && level < LOG_NONE ? numMessages_[level - LOG_RAW].load(std::memory_order_relaxed) : 0; }
+
+    /// Return number of messages dropped because the background writer's queue was full. Error messages are never dropped.
+    u32 GetNumDroppedMessages() const { return numDroppedMessages_.load(std::memory_order_relaxed); }
+
     /// Write to the log. If logging level is higher than the level of the message, the message is ignored.
     /// @nobind
     static void Write(int level, const String& message);
@@ -100,13 +127,35 @@ public:
     static void WriteRaw(const String& message, bool error = false);
 
 private:
+    friend class LogWriter;
+
     /// Handle end of frame. Process the threaded log messages.
     void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+    /// Queue a message for the background writer. Return false if it was dropped.
+    static bool WriteAsync(int level, const String& message, bool error);
+    /// Queue a format string and its arguments for the background writer to format.
+    static void WriteAsyncFormat(int level, const char* format, va_list args, bool mainThread);
+    /// Handle a full background writer queue. Return false if the message should be dropped, or true after waiting for room for an error message.
+    static bool WaitForQueue(int level, bool error);
+    /// Send the log message event for a message written from the main thread.
+    static void SendLogMessageEvent(int level, const String& message, bool error);
+    /// Stop the background writer and write the messages left in its queue.
+    void StopWriter();
 
     /// Mutex for threaded operation.
     Mutex logMutex_;
     /// Log messages from other threads.
     List<StoredLogMessage> threadMessages_;
+    /// Messages from other threads written by the background writer, waiting for their log message events.
+    List<StoredLogMessage> writtenMessages_;
+    /// Background writer.
+    SharedPtr<LogWriter> writer_;
+    /// Number of output or queued messages per level, starting from LOG_RAW.
+    std::atomic<u32> numMessages_[LOG_NONE - LOG_RAW]{};
+    /// Number of messages dropped by the background writer's full queue.
+    std::atomic<u32> numDroppedMessages_{};
+    /// Background writer queue size.
+    i32 asyncQueueSize_;
     /// Log file.
     SharedPtr<File> logFile_;
     /// Last log message.
@@ -119,6 +168,10 @@ private:
     bool inWrite_;
     /// Quiet mode flag.
     bool quiet_;
+    /// Background writer enabled flag.
+    std::atomic<bool> async_{};
+    /// Binary log file records flag.
+    bool binary_{};
 };
 
 #ifdef URHO3D_LOGGING
@@ -0,0 +1,170 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../Precompiled.h"
+
+#include "../Math/MaxRectsPacker.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static bool Contains(const IntRect& outer, const IntRect& inner)
+{
+    return inner.left_ >= outer.left_ && inner.top_ >= outer.top_ && inner.right_ <= outer.right_ &&
+        inner.bottom_ <= outer.bottom_;
+}
+
+MaxRectsPacker::MaxRectsPacker(i32 width, i32 height, MaxRectsHeuristic heuristic, bool allowRotation)
+{
+    Reset(width, height, heuristic, allowRotation);
+}
+
+void MaxRectsPacker::Reset(i32 width, i32 height, MaxRectsHeuristic heuristic, bool allowRotation)
+{
+    size_ = IntVector2(Max(width, 0), Max(height, 0));
+    heuristic_ = heuristic;
+    allowRotation_ = allowRotation;
+    usedArea_ = 0;
+
+    freeRects_.Clear();
+    if (size_.x_ && size_.y_)
+        freeRects_.Push(IntRect(0, 0, size_.x_, size_.y_));
+}
+
+bool MaxRectsPacker::Occupy(const IntRect& rect)
+{
+    if (rect.Width() <= 0 || rect.Height() <= 0)
+        return false;
+
+    // Any free area lies inside at least one maximal free rectangle
+    for (const IntRect& freeRect : freeRects_)
+    {
+        if (Contains(freeRect, rect))
+        {
+            PlaceRect(rect);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool MaxRectsPacker::Insert(i32 width, i32 height, IntRect& rect, bool& rotated, const IntVector2& padding)
+{
+    if (width <= 0 || height <= 0)
+        return false;
+
+    IntRect best;
+    i32 bestScore1 = M_MAX_INT;
+    i32 bestScore2 = M_MAX_INT;
+    bool bestRotated = false;
+
+    for (const IntRect& freeRect : freeRects_)
+    {
+        ScorePosition(freeRect, width + padding.x_, height + padding.y_, false, best, bestScore1, bestScore2, bestRotated);
+        if (allowRotation_ && width != height)
+            ScorePosition(freeRect, height + padding.x_, width + padding.y_, true, best, bestScore1, bestScore2, bestRotated);
+    }
+
+    if (bestScore1 == M_MAX_INT)
+        return false;
+
+    PlaceRect(best);
+    rect = best;
+    rotated = bestRotated;
+    return true;
+}
+
+void MaxRectsPacker::ScorePosition(const IntRect& freeRect, i32 width, i32 height, bool rotated, IntRect& best, i32& bestScore1,
+    i32& bestScore2, bool& bestRotated) const
+{
+    if (width > freeRect.Width() || height > freeRect.Height())
+        return;
+
+    i32 leftoverX = freeRect.Width() - width;
+    i32 leftoverY = freeRect.Height() - height;
+    i32 score1;
+    i32 score2;
+
+    switch (heuristic_)
+    {
+    case MAXRECTS_BEST_LONG_SIDE_FIT:
+        score1 = Max(leftoverX, leftoverY);
+        score2 = Min(leftoverX, leftoverY);
+        break;
+
+    case MAXRECTS_BEST_AREA_FIT:
+        score1 = freeRect.Width() * freeRect.Height() - width * height;
+        score2 = Min(leftoverX, leftoverY);
+        break;
+
+    case MAXRECTS_BOTTOM_LEFT:
+        score1 = freeRect.top_ + height;
+        score2 = freeRect.left_;
+        break;
+
+    default:
+        score1 = Min(leftoverX, leftoverY);
+        score2 = Max(leftoverX, leftoverY);
+        break;
+    }
+
+    if (score1 < bestScore1 || (score1 == bestScore1 && score2 < bestScore2))
+    {
+        best = IntRect(freeRect.left_, freeRect.top_, freeRect.left_ + width, freeRect.top_ + height);
+        bestScore1 = score1;
+        bestScore2 = score2;
+        bestRotated = rotated;
+    }
+}
+
+void MaxRectsPacker::PlaceRect(const IntRect& rect)
+{
+    usedArea_ += rect.Width() * rect.Height();
+
+    // Split every free rectangle the placed one overlaps into up to four maximal parts
+    newFreeRects_.Clear();
+    for (i32 i = 0; i < freeRects_.Size();)
+    {
+        IntRect freeRect = freeRects_[i];
+        if (rect.left_ >= freeRect.right_ || rect.right_ <= freeRect.left_ || rect.top_ >= freeRect.bottom_ ||
+            rect.bottom_ <= freeRect.top_)
+        {
+            ++i;
+            continue;
+        }
+
+        if (rect.left_ > freeRect.left_)
+            newFreeRects_.Push(IntRect(freeRect.left_, freeRect.top_, rect.left_, freeRect.bottom_));
+        if (rect.right_ < freeRect.right_)
+            newFreeRects_.Push(IntRect(rect.right_, freeRect.top_, freeRect.right_, freeRect.bottom_));
+        if (rect.top_ > freeRect.top_)
+            newFreeRects_.Push(IntRect(freeRect.left_, freeRect.top_, freeRect.right_, rect.top_));
+        if (rect.bottom_ < freeRect.bottom_)
+            newFreeRects_.Push(IntRect(freeRect.left_, rect.bottom_, freeRect.right_, freeRect.bottom_));
+
+        freeRects_[i] = freeRects_.Back();
+        freeRects_.Pop();
+    }
+
+    // Drop the new parts that lie inside another free rectangle. The untouched ones were maximal already and can not be
+    // inside a new part, as the parts are smaller than the rectangles they were split from
+    i32 numOldRects = freeRects_.Size();
+    for (i32 i = 0; i < newFreeRects_.Size(); ++i)
+    {
+        const IntRect& newRect = newFreeRects_[i];
+        bool contained = false;
+        for (i32 j = 0; j < numOldRects && !contained; ++j)
+            contained = Contains(freeRects_[j], newRect);
+        // Of identical parts keep the first
+        for (i32 j = 0; j < newFreeRects_.Size() && !contained; ++j)
+            contained = j != i && Contains(newFreeRects_[j], newRect) && (newFreeRects_[j] != newRect || j < i);
+
+        if (!contained)
+            freeRects_.Push(newRect);
+    }
+}
+
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Math/Rect.h"
+
+namespace Urho3D
+{
+
+/// Free rectangle choice of the MaxRects packer.
+enum MaxRectsHeuristic
+{
+    /// Smallest leftover on the shorter side.
+    MAXRECTS_BEST_SHORT_SIDE_FIT = 0,
+    /// Smallest leftover on the longer side.
+    MAXRECTS_BEST_LONG_SIDE_FIT,
+    /// Smallest free rectangle.
+    MAXRECTS_BEST_AREA_FIT,
+    /// Topmost, then leftmost position.
+    MAXRECTS_BOTTOM_LEFT
+};
+
+/// MaxRects rectangle packer. Keeps the list of all maximal free rectangles, which may overlap each other. Packs tighter than AreaAllocator, especially when the rectangles are inserted largest first, but does not grow.
+/// @nobind
+class URHO3D_API MaxRectsPacker
+{
+public:
+    /// Default construct with empty size.
+    MaxRectsPacker() = default;
+    /// Construct with given width and height.
+    MaxRectsPacker(i32 width, i32 height, MaxRectsHeuristic heuristic = MAXRECTS_BEST_SHORT_SIDE_FIT, bool allowRotation = false);
+
+    /// Reset to given width and height and remove all previous allocations.
+    void Reset(i32 width, i32 height, MaxRectsHeuristic heuristic = MAXRECTS_BEST_SHORT_SIDE_FIT, bool allowRotation = false);
+    /// Reserve an area, for example one kept from a previous packing. Return false if the area is not free.
+    bool Occupy(const IntRect& rect);
+    /// Find the best free position for a rectangle and reserve it. If rotation is allowed, the rectangle may be turned 90 degrees, after which the padding is added. Return true if successful, with the reserved area and rotation filled.
+    bool Insert(i32 width, i32 height, IntRect& rect, bool& rotated, const IntVector2& padding = IntVector2::ZERO);
+
+    /// Return the width.
+    i32 GetWidth() const { return size_.x_; }
+    /// Return the height.
+    i32 GetHeight() const { return size_.y_; }
+    /// Return the heuristic.
+    MaxRectsHeuristic GetHeuristic() const { return heuristic_; }
+    /// Return whether rectangles may be rotated.
+    bool GetAllowRotation() const { return allowRotation_; }
+    /// Return the reserved area in pixels.
+    i32 GetUsedArea() const { return usedArea_; }
+    /// Return the maximal free rectangles.
+    const Vector<IntRect>& GetFreeRects() const { return freeRects_; }
+
+private:
+    /// Score a position in a free rectangle and keep it if better than the best so far.
+    void ScorePosition(const IntRect& freeRect, i32 width, i32 height, bool rotated, IntRect& best, i32& bestScore1,
+        i32& bestScore2, bool& bestRotated) const;
+    /// Split the free rectangles around a reserved area.
+    void PlaceRect(const IntRect& rect);
+
+    /// Maximal free rectangles.
+    Vector<IntRect> freeRects_;
+    /// Free rectangles split off while placing. Kept to avoid allocating.
+    Vector<IntRect> newFreeRects_;
+    /// Size.
+    IntVector2 size_;
+    /// Reserved area.
+    i32 usedArea_{};
+    /// Free rectangle choice.
+    MaxRectsHeuristic heuristic_{MAXRECTS_BEST_SHORT_SIDE_FIT};
+    /// Rotation allowed flag.
+    bool allowRotation_{};
+};
+
+}
@@ -48,6 +48,15 @@ StringHash::StringHash(const String& str) noexcept :
 #endif
 }
 
+hash32 StringHash::CalculateData(const void* data, i32 size, hash32 hash)
+{
+    const u8* bytes = static_cast<const u8*>(data);
+    for (i32 i = 0; i < size; ++i)
+        hash = SDBMHash(hash, bytes[i]);
+
+    return hash;
+}
+
 StringHashRegister* StringHash::GetGlobalStringHashRegister()
 {
 #ifdef URHO3D_HASH_DEBUG
@@ -101,6 +101,10 @@ public:
         return hash;
     }
 
+    /// Calculate hash value from binary data.
+    /// @nobind
+    static hash32 CalculateData(const void* data, i32 size, hash32 hash = 0);
+
     /// Get global StringHashRegister. Use for debug purposes only. Return nullptr if URHO3D_HASH_DEBUG is off.
     static StringHashRegister* GetGlobalStringHashRegister();
 
@@ -5,6 +5,7 @@
 
 
 #include "../Core/Context.h"
+#include "../Core/FrameScheduler.h"
 #include "../Core/Profiler.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/Log.h"
@@ -577,28 +578,7 @@ void DynamicNavigationMesh::DrawDebugGeometry(DebugRenderer* debug, bool depthTe
     if (!debug || !navMesh_ || !node_)
         return;
 
-    const Matrix3x4& worldTransform = node_->GetWorldTransform();
-
-    const dtNavMesh* navMesh = navMesh_;
-
-    for (int j = 0; j < navMesh->getMaxTiles(); ++j)
-    {
-        const dtMeshTile* tile = navMesh->getTile(j);
-        assert(tile);
-        if (!tile->header)
-            continue;
-
-        for (int i = 0; i < tile->header->polyCount; ++i)
-        {
-            dtPoly* poly = tile->polys + i;
-            for (unsigned j = 0; j < poly->vertCount; ++j)
-            {
-                debug->AddLine(worldTransform * *reinterpret_cast<const Vector3*>(&tile->verts[poly->verts[j] * 3]),
-                    worldTransform * *reinterpret_cast<const Vector3*>(&tile->verts[poly->verts[(j + 1) % poly->vertCount] * 3]),
-                    Color::YELLOW, depthTest);
-            }
-        }
-    }
+    DrawNavMeshDebugGeometry(debug, depthTest);
 
     Scene* scene = GetScene();
     if (scene)
@@ -1051,11 +1031,25 @@ void DynamicNavigationMesh::ReleaseTileCache()
 
 void DynamicNavigationMesh::OnSceneSet(Scene* scene)
 {
-    // Subscribe to the scene subsystem update, which will trigger the tile cache to update the nav mesh
+    // Rebuild tiles in the time left in the frame, or one tile per scene subsystem update without the frame scheduler
+    auto* frameScheduler = GetSubsystem<FrameScheduler>();
     if (scene)
-        SubscribeToEvent(scene, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(DynamicNavigationMesh, HandleSceneSubsystemUpdate));
+    {
+        if (frameScheduler && !tileCacheTask_)
+        {
+            tileCacheTask_ = frameScheduler->AddTask(this, "UpdateTileCache",
+                [this](long long maxUSec) { return UpdateTileCache(maxUSec); }, FT_PRIORITY_NORMAL, 1);
+        }
+        else if (!frameScheduler)
+            SubscribeToEvent(scene, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(DynamicNavigationMesh, HandleSceneSubsystemUpdate));
+    }
     else
+    {
+        if (frameScheduler && tileCacheTask_)
+            frameScheduler->RemoveTask(tileCacheTask_);
+        tileCacheTask_ = 0;
         UnsubscribeFromEvent(E_SCENESUBSYSTEMUPDATE);
+    }
 }
 
 void DynamicNavigationMesh::AddObstacle(Obstacle* obstacle, bool silent)
@@ -1080,6 +1074,9 @@ void DynamicNavigationMesh::AddObstacle(Obstacle* obstacle, bool silent)
         obstacle->obstacleId_ = refHolder;
         assert(refHolder > 0);
 
+        if (tileCacheTask_)
+            GetSubsystem<FrameScheduler>()->WakeTask(tileCacheTask_);
+
         if (!silent)
         {
             using namespace NavigationObstacleAdded;
@@ -1118,6 +1115,10 @@ void DynamicNavigationMesh::RemoveObstacle(Obstacle* obstacle, bool silent)
             return;
         }
         obstacle->obstacleId_ = 0;
+
+        if (tileCacheTask_)
+            GetSubsystem<FrameScheduler>()->WakeTask(tileCacheTask_);
+
         // Require a node in order to send an event
         if (!silent && obstacle->GetNode())
         {
@@ -1141,4 +1142,25 @@ void DynamicNavigationMesh::HandleSceneSubsystemUpdate(StringHash eventType, Var
         tileCache_->update(eventData[P_TIMESTEP].GetFloat(), navMesh_);
 }
 
+bool DynamicNavigationMesh::UpdateTileCache(long long maxUSec)
+{
+    if (!tileCache_ || !navMesh_)
+        return false;
+
+    // Like the scene subsystem update, do not update while disabled or the scene is paused, but keep the work pending
+    Scene* scene = GetScene();
+    if (!IsEnabledEffective() || !scene || !scene->IsUpdateEnabled())
+        return true;
+
+    URHO3D_PROFILE(UpdateTileCache);
+
+    // Each update rebuilds at most one tile
+    HiresTimer timer;
+    bool upToDate = false;
+    while (!upToDate && timer.GetUSec(false) < maxUSec)
+        tileCache_->update(0.0f, navMesh_, &upToDate);
+
+    return !upToDate;
+}
+
 }
@@ -91,10 +91,12 @@ public:
 protected:
     struct TileCacheData;
 
-    /// Subscribe to events when assigned to a scene.
+    /// Subscribe to events or add the frame scheduler task when assigned to a scene.
     void OnSceneSet(Scene* scene) override;
-    /// Trigger the tile cache to make updates to the nav mesh if necessary.
+    /// Trigger the tile cache to make updates to the nav mesh if necessary. Used when there is no frame scheduler.
     void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    /// Rebuild tiles affected by obstacle changes within a time limit in microseconds. Return true if tiles remain to rebuild.
+    bool UpdateTileCache(long long maxUSec);
 
     /// Used by Obstacle class to add itself to the tile cache, if 'silent' an event will not be raised.
     void AddObstacle(Obstacle* obstacle, bool silent = false);
@@ -122,6 +124,8 @@ private:
 
     /// Detour tile cache instance that works with the nav mesh.
     dtTileCache* tileCache_{};
+    /// Frame scheduler task for tile cache updates, or 0 if not in a scene or there is no frame scheduler.
+    u32 tileCacheTask_{};
 
     /// Used by dtTileCache to allocate blocks of memory.
     std::unique_ptr<dtTileCacheAlloc> allocator_;
@@ -5,6 +5,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
@@ -78,6 +79,49 @@ struct FindPathData
     unsigned char pathFlags_[MAX_POLYS]{};
 };
 
+/// Range of tiles to gather debug lines from.
+struct NavMeshDebugTask
+{
+    // Navigation mesh.
+    const dtNavMesh* navMesh_{};
+    // First tile index.
+    int firstTile_{};
+    // Tile index past the last.
+    int lastTile_{};
+    // Line color.
+    color32 color_{};
+    // Gathered polygon edges.
+    Vector<DebugLine> lines_;
+};
+
+static void GetNavMeshDebugLines(NavMeshDebugTask& task)
+{
+    for (int i = task.firstTile_; i < task.lastTile_; ++i)
+    {
+        const dtMeshTile* tile = task.navMesh_->getTile(i);
+        assert(tile);
+        if (!tile->header)
+            continue;
+
+        for (int j = 0; j < tile->header->polyCount; ++j)
+        {
+            const dtPoly* poly = tile->polys + j;
+            for (unsigned k = 0; k < poly->vertCount; ++k)
+            {
+                task.lines_.Push(DebugLine(
+                    *reinterpret_cast<const Vector3*>(&tile->verts[poly->verts[k] * 3]),
+                    *reinterpret_cast<const Vector3*>(&tile->verts[poly->verts[(k + 1) % poly->vertCount] * 3]),
+                    task.color_));
+            }
+        }
+    }
+}
+
+static void GetNavMeshDebugLinesWork(const WorkItem* item, i32/* threadIndex*/)
+{
+    GetNavMeshDebugLines(*static_cast<NavMeshDebugTask*>(item->start_));
+}
+
 NavigationMesh::NavigationMesh(Context* context) :
     Component(context),
     navMesh_(nullptr),
@@ -145,31 +189,7 @@ void NavigationMesh::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     if (!debug || !navMesh_ || !node_)
         return;
 
-    const Matrix3x4& worldTransform = node_->GetWorldTransform();
-
-    const dtNavMesh* navMesh = navMesh_;
-
-    for (int j = 0; j < navMesh->getMaxTiles(); ++j)
-    {
-        const dtMeshTile* tile = navMesh->getTile(j);
-        assert(tile);
-        if (!tile->header)
-            continue;
-
-        for (int i = 0; i < tile->header->polyCount; ++i)
-        {
-            dtPoly* poly = tile->polys + i;
-            for (unsigned j = 0; j < poly->vertCount; ++j)
-            {
-                debug->AddLine(
-                    worldTransform * *reinterpret_cast<const Vector3*>(&tile->verts[poly->verts[j] * 3]),
-                    worldTransform * *reinterpret_cast<const Vector3*>(&tile->verts[poly->verts[(j + 1) % poly->vertCount] * 3]),
-                    Color::YELLOW,
-                    depthTest
-                );
-            }
-        }
-    }
+    DrawNavMeshDebugGeometry(debug, depthTest);
 
     Scene* scene = GetScene();
     if (scene)
@@ -1547,6 +1567,7 @@ void NavigationMesh::ReleaseNavigationMesh()
 {
     dtFreeNavMesh(navMesh_);
     navMesh_ = nullptr;
+    debugGeometry_.Reset();
 
     dtFreeNavMeshQuery(navMeshQuery_);
     navMeshQuery_ = nullptr;
@@ -1556,6 +1577,61 @@ void NavigationMesh::ReleaseNavigationMesh()
     boundingBox_.Clear();
 }
 
+void NavigationMesh::DrawNavMeshDebugGeometry(DebugRenderer* debug, bool depthTest)
+{
+    const dtNavMesh* navMesh = navMesh_;
+    int maxTiles = navMesh->getMaxTiles();
+
+    // Detour increments a tile's salt whenever it is removed, so the salts and data pointers identify the current tiles
+    hash32 hash = MakeHash(navMesh);
+    CombineHash(hash, depthTest ? 1 : 0);
+    for (int i = 0; i < maxTiles; ++i)
+    {
+        const dtMeshTile* tile = navMesh->getTile(i);
+        if (tile->header)
+        {
+            CombineHash(hash, tile->salt);
+            CombineHash(hash, MakeHash(tile->header));
+        }
+    }
+
+    if (!debugGeometry_ || hash != debugGeometryHash_)
+    {
+        URHO3D_PROFILE(BuildNavMeshDebugGeometry);
+
+        if (!debugGeometry_)
+            debugGeometry_ = new DebugGeometry();
+        else
+            debugGeometry_->Clear();
+        debugGeometryHash_ = hash;
+
+        // Gather the polygon edges of tile ranges in parallel, in local space
+        auto* queue = GetSubsystem<WorkQueue>();
+        i32 numTasks = Clamp(queue ? queue->GetNumThreads() + 1 : 1, 1, Max(maxTiles, 1));
+        int tilesPerTask = (maxTiles + numTasks - 1) / numTasks;
+        Vector<NavMeshDebugTask> tasks(numTasks);
+        for (i32 i = 0; i < numTasks; ++i)
+        {
+            NavMeshDebugTask& task = tasks[i];
+            task.navMesh_ = navMesh;
+            task.firstTile_ = Min(i * tilesPerTask, maxTiles);
+            task.lastTile_ = Min(task.firstTile_ + tilesPerTask, maxTiles);
+            task.color_ = Color::YELLOW.ToU32();
+        }
+
+        if (numTasks > 1)
+            queue->RunParallel(GetNavMeshDebugLinesWork, tasks.Buffer(), numTasks, numTasks);
+        else
+            GetNavMeshDebugLines(tasks[0]);
+
+        for (const NavMeshDebugTask& task : tasks)
+            debugGeometry_->AddLines(task.lines_.Buffer(), task.lines_.Size(), depthTest);
+    }
+
+    debugGeometry_->SetTransform(node_->GetWorldTransform());
+    debug->AddGeometry(debugGeometry_);
+}
+
 void NavigationMesh::SetPartitionType(NavmeshPartitionType partitionType)
 {
     partitionType_ = partitionType;
@@ -32,6 +32,7 @@ enum NavmeshPartitionType
     NAVMESH_PARTITION_MONOTONE
 };
 
+class DebugGeometry;
 class Geometry;
 class NavArea;
 
@@ -320,6 +321,8 @@ protected:
     bool InitializeQuery();
     /// Release the navigation mesh and the query.
     virtual void ReleaseNavigationMesh();
+    /// Add the navigation mesh polygon edges to the debug renderer. They are rebuilt in parallel only when the tiles have changed.
+    void DrawNavMeshDebugGeometry(DebugRenderer* debug, bool depthTest);
 
     /// Identifying name for this navigation mesh.
     String meshName_;
@@ -380,6 +383,10 @@ protected:
     bool drawNavAreas_;
     /// NavAreas for this NavMesh.
     Vector<WeakPtr<NavArea>> areas_;
+    /// Retained polygon edge debug geometry.
+    SharedPtr<DebugGeometry> debugGeometry_;
+    /// Hash of the tiles and depth test mode the debug geometry was built from.
+    hash32 debugGeometryHash_{};
 };
 
 /// Register Navigation library objects.
@@ -16,6 +16,7 @@
 #include "../Physics/PhysicsUtils.h"
 #include "../Physics/PhysicsWorld.h"
 #include "../Physics/RaycastVehicle.h"
+#include "../Physics/RaycastVehicleManager.h"
 #include "../Physics/RigidBody.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
@@ -159,13 +160,21 @@ PhysicsWorld::~PhysicsWorld()
 {
     if (scene_)
     {
-        // Force all remaining constraints, rigid bodies and collision shapes to release themselves
+        // Force all remaining constraints, rigid bodies and collision shapes to release themselves. Constraints go while the
+        // Bullet world still exists, as the bodies must not be referred to by any
         for (Vector<Constraint*>::Iterator i = constraints_.Begin(); i != constraints_.End(); ++i)
             (*i)->ReleaseConstraint();
 
+        // Destroy the Bullet world before releasing the bodies, so that they do not need to be removed from it one by one.
+        // That takes quadratic time with many dynamic bodies
+        world_.reset();
         for (Vector<RigidBody*>::Iterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
             (*i)->ReleaseBody();
 
+        // The geometry caches go away with the world, so do not clean them up after each shape
+        triMeshCache_.Clear();
+        convexCache_.Clear();
+        gimpactTrimeshCache_.Clear();
         for (Vector<CollisionShape*>::Iterator i = collisionShapes_.Begin(); i != collisionShapes_.End(); ++i)
             (*i)->ReleaseShape();
     }
@@ -181,6 +190,14 @@ PhysicsWorld::~PhysicsWorld()
     collisionConfiguration_ = nullptr;
 }
 
+RaycastVehicleManager* PhysicsWorld::GetVehicleManager()
+{
+    if (!vehicleManager_)
+        vehicleManager_ = make_unique<RaycastVehicleManager>(this);
+
+    return vehicleManager_.get();
+}
+
 void PhysicsWorld::RegisterObject(Context* context)
 {
     context->RegisterFactory<PhysicsWorld>(SUBSYSTEM_CATEGORY);
@@ -206,7 +223,7 @@ bool PhysicsWorld::isVisible(const btVector3& aabbMin, const btVector3& aabbMax)
 void PhysicsWorld::drawLine(const btVector3& from, const btVector3& to, const btVector3& color)
 {
     if (debugRenderer_)
-        debugRenderer_->AddLine(ToVector3(from), ToVector3(to), Color(color.x(), color.y(), color.z()), debugDepthTest_);
+        debugLines_.Push(DebugLine(ToVector3(from), ToVector3(to), Color(color.x(), color.y(), color.z()).ToU32()));
 }
 
 void PhysicsWorld::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -219,6 +236,11 @@ void PhysicsWorld::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
         debugDepthTest_ = depthTest;
         world_->debugDrawWorld();
         debugRenderer_ = nullptr;
+
+        // Bullet emits the lines one at a time, so they are buffered and added as one line list. The buffer keeps its
+        // capacity between frames
+        debug->AddLines(debugLines_.Buffer(), debugLines_.Size(), depthTest);
+        debugLines_.Clear();
     }
 }
 
@@ -32,12 +32,14 @@ class Constraint;
 class Model;
 class Node;
 class Ray;
+class RaycastVehicleManager;
 class RigidBody;
 class Scene;
 class Serializer;
 class XMLElement;
 
 struct CollisionGeometryData;
+struct DebugLine;
 
 /// Physics raycast hit.
 struct URHO3D_API PhysicsRaycastResult
@@ -262,6 +264,10 @@ public:
     /// Return the Bullet physics world.
     btDiscreteDynamicsWorld* GetWorld() { return world_.get(); }
 
+    /// Return the manager that updates the raycast vehicles, creating it if necessary.
+    /// @nobind
+    RaycastVehicleManager* GetVehicleManager();
+
     /// Clean up the geometry cache.
     void CleanupGeometryCache();
 
@@ -315,6 +321,9 @@ private:
     /// Bullet physics world.
     std::unique_ptr<btDiscreteDynamicsWorld> world_;
 
+    /// Raycast vehicle manager, created when the first vehicle is added.
+    std::unique_ptr<RaycastVehicleManager> vehicleManager_;
+
     /// Extra weak pointer to scene to allow for cleanup in case the world is destroyed before other components.
     WeakPtr<Scene> scene_;
     /// Rigid bodies in the world.
@@ -363,6 +372,8 @@ private:
     bool debugDepthTest_{};
     /// Debug renderer.
     DebugRenderer* debugRenderer_{};
+    /// Debug lines collected during a debug draw, added to the debug renderer at once.
+    Vector<DebugLine> debugLines_;
     /// Debug draw flags.
     int debugMode_{};
 };
@@ -8,6 +8,7 @@
 #include "../Scene/Scene.h"
 #include "../IO/Log.h"
 #include "../Physics/RaycastVehicle.h"
+#include "../Physics/RaycastVehicleManager.h"
 
 #include <Bullet/BulletDynamics/Vehicle/btRaycastVehicle.h>
 #include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
@@ -40,9 +41,7 @@ struct RaycastVehicleData
         {
             if (physWorld_ && added_)
             {
-                btDynamicsWorld* pbtDynWorld = physWorld_->GetWorld();
-                if (pbtDynWorld)
-                    pbtDynWorld->removeAction(vehicle_);
+                physWorld_->GetVehicleManager()->RemoveVehicle(vehicle_);
                 added_ = false;
             }
             delete vehicle_;
@@ -67,16 +66,18 @@ struct RaycastVehicleData
         if (vehicle_)
         {
             if (added_)
-                pbtDynWorld->removeAction(vehicle_);
+                pPhysWorld->GetVehicleManager()->RemoveVehicle(vehicle_);
             delete vehicle_;
         }
 
-        vehicleRayCaster_ = new btDefaultVehicleRaycaster(pbtDynWorld);
+        // The vehicles are updated by the manager, which casts the wheel rays of all vehicles at once
+        vehicleRayCaster_ = new RaycastVehicleRaycaster(pbtDynWorld);
         btRigidBody* bthullBody = body->GetBody();
         vehicle_ = new btRaycastVehicle(tuning_, bthullBody, vehicleRayCaster_);
+        added_ = false;
         if (enabled)
         {
-            pbtDynWorld->addAction(vehicle_);
+            pPhysWorld->GetVehicleManager()->AddVehicle(vehicle_, vehicleRayCaster_);
             added_ = true;
         }
 
@@ -94,24 +95,23 @@ struct RaycastVehicleData
     {
         if (!physWorld_ || !vehicle_)
             return;
-        btDynamicsWorld* pbtDynWorld = physWorld_->GetWorld();
-        if (!pbtDynWorld)
+        if (!physWorld_->GetWorld())
             return;
 
         if (enabled && !added_)
         {
-            pbtDynWorld->addAction(vehicle_);
+            physWorld_->GetVehicleManager()->AddVehicle(vehicle_, vehicleRayCaster_);
             added_ = true;
         }
         else if (!enabled && added_)
         {
-            pbtDynWorld->removeAction(vehicle_);
+            physWorld_->GetVehicleManager()->RemoveVehicle(vehicle_);
             added_ = false;
         }
     }
 
     WeakPtr<PhysicsWorld> physWorld_;
-    btVehicleRaycaster* vehicleRayCaster_;
+    RaycastVehicleRaycaster* vehicleRayCaster_;
     btRaycastVehicle* vehicle_;
     btRaycastVehicle::btVehicleTuning tuning_;
     bool added_;
@@ -272,7 +272,7 @@ void RaycastVehicle::FixedUpdate(float timeStep)
     btRaycastVehicle* vehicle = vehicleData_->Get();
     for (int i = 0; i < GetNumWheels(); i++)
     {
-        btWheelInfo whInfo = vehicle->getWheelInfo(i);
+        const btWheelInfo& whInfo = vehicle->getWheelInfo(i);
         if (whInfo.m_engineForce != 0.0f || whInfo.m_steering != 0.0f)
         {
             hullBody_->Activate();
@@ -287,12 +287,21 @@ void RaycastVehicle::PostUpdate(float timeStep)
     for (int i = 0; i < GetNumWheels(); i++)
     {
         vehicle->updateWheelTransform(i, true);
-        btTransform transform = vehicle->getWheelTransformWS(i);
+        const btTransform& transform = vehicle->getWheelTransformWS(i);
         Vector3 origin = ToVector3(transform.getOrigin());
-        Quaternion qRot = ToQuaternion(transform.getRotation());
+        Quaternion qRot = ToQuaternion(transform.getRotation()) * origRotation_[i];
         Node* pWheel = wheelNodes_[i];
-        pWheel->SetWorldPosition(origin);
-        pWheel->SetWorldRotation(qRot * origRotation_[i]);
+
+        // Parked vehicles do not move their wheels, so skip dirtying the nodes. Otherwise set position and rotation
+        // at once so that the wheel and its children are dirtied once
+        if (origin.Equals(pWheel->GetWorldPosition()) && qRot.Equals(pWheel->GetWorldRotation()))
+            continue;
+
+        Node* parent = pWheel->GetParent();
+        if (!parent || parent == GetScene())
+            pWheel->SetTransform(origin, qRot);
+        else
+            pWheel->SetTransform(parent->GetWorldTransform().Inverse() * origin, parent->GetWorldRotation().Inverse() * qRot);
     }
 }
 
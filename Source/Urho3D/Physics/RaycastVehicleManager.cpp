@@ -0,0 +1,256 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../Precompiled.h"
+
+#include "../Core/WorkQueue.h"
+#include "../Physics/PhysicsWorld.h"
+#include "../Physics/RaycastVehicleManager.h"
+
+#include <Bullet/BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Minimum number of wheel rays to cast them in the worker threads.
+static const i32 MIN_PARALLEL_WHEEL_RAYS = 64;
+
+/// Broadphase ray callback that tests the collision objects with a closest hit result callback. Same as the one used by
+/// btCollisionWorld::rayTest(), which is not visible outside Bullet.
+struct WheelRayCallback : public btBroadphaseRayCallback
+{
+    /// Construct.
+    WheelRayCallback(const btVector3& from, const btVector3& to, btCollisionWorld::RayResultCallback& resultCallback) :
+        resultCallback_(resultCallback)
+    {
+        fromTransform_.setIdentity();
+        fromTransform_.setOrigin(from);
+        toTransform_.setIdentity();
+        toTransform_.setOrigin(to);
+
+        btVector3 direction = (to - from).normalized();
+        for (i32 i = 0; i < 3; ++i)
+        {
+            m_rayDirectionInverse[i] = direction[i] == btScalar(0) ? btScalar(BT_LARGE_FLOAT) : btScalar(1) / direction[i];
+            m_signs[i] = m_rayDirectionInverse[i] < btScalar(0);
+        }
+        m_lambda_max = direction.dot(to - from);
+    }
+
+    /// Test a collision object whose bounding box the ray hits.
+    bool process(const btBroadphaseProxy* proxy) override
+    {
+        if (resultCallback_.m_closestHitFraction == btScalar(0))
+            return false;
+
+        auto* collisionObject = static_cast<btCollisionObject*>(proxy->m_clientObject);
+        if (resultCallback_.needsCollision(collisionObject->getBroadphaseHandle()))
+        {
+            btCollisionWorld::rayTestSingle(fromTransform_, toTransform_, collisionObject, collisionObject->getCollisionShape(),
+                collisionObject->getWorldTransform(), resultCallback_);
+        }
+
+        return true;
+    }
+
+    /// Ray start transform.
+    btTransform fromTransform_;
+    /// Ray end transform.
+    btTransform toTransform_;
+    /// Result callback.
+    btCollisionWorld::RayResultCallback& resultCallback_;
+};
+
+/// Dbvt leaf callback that passes the proxies to a broadphase ray callback.
+struct WheelRayTester : public btDbvt::ICollide
+{
+    /// Construct.
+    explicit WheelRayTester(btBroadphaseRayCallback& rayCallback) :
+        rayCallback_(rayCallback)
+    {
+    }
+
+    /// Process a leaf.
+    void Process(const btDbvtNode* leaf) override
+    {
+        rayCallback_.process(static_cast<btBroadphaseProxy*>(leaf->data));
+    }
+
+    /// Ray callback.
+    btBroadphaseRayCallback& rayCallback_;
+};
+
+/// Cast a wheel ray with the same result as btDefaultVehicleRaycaster. The Dbvt broadphase uses one shared traversal stack
+/// in btDbvtBroadphase::rayTest(), so the trees are traversed here with the caller's stack to allow casting in parallel.
+static void CastWheelRay(btDbvtBroadphase* broadphase, RaycastVehicleWheelRay& ray, btAlignedObjectArray<const btDbvtNode*>& stack)
+{
+    btCollisionWorld::ClosestRayResultCallback resultCallback(ray.from_, ray.to_);
+    WheelRayCallback rayCallback(ray.from_, ray.to_, resultCallback);
+    WheelRayTester tester(rayCallback);
+    const btVector3 zero(0, 0, 0);
+
+    for (btDbvt& tree : broadphase->m_sets)
+    {
+        tree.rayTestInternal(tree.m_root, ray.from_, ray.to_, rayCallback.m_rayDirectionInverse, rayCallback.m_signs,
+            rayCallback.m_lambda_max, zero, zero, stack, tester);
+    }
+
+    ray.hitObject_ = nullptr;
+    if (resultCallback.hasHit())
+    {
+        const btRigidBody* body = btRigidBody::upcast(resultCallback.m_collisionObject);
+        if (body && body->hasContactResponse())
+        {
+            ray.result_.m_hitPointInWorld = resultCallback.m_hitPointWorld;
+            ray.result_.m_hitNormalInWorld = resultCallback.m_hitNormalWorld.normalized();
+            ray.result_.m_distFraction = resultCallback.m_closestHitFraction;
+            ray.hitObject_ = const_cast<btRigidBody*>(body);
+        }
+    }
+}
+
+void* RaycastVehicleRaycaster::castRay(const btVector3& from, const btVector3& to, btVehicleRaycasterResult& result)
+{
+    if (nextRay_ < numRays_)
+    {
+        const RaycastVehicleWheelRay& ray = rays_[nextRay_++];
+        if (ray.from_ == from && ray.to_ == to)
+        {
+            if (ray.hitObject_)
+                result = ray.result_;
+            return ray.hitObject_;
+        }
+
+        // Out of sync with the vehicle, so cast the rest of the rays directly
+        numRays_ = 0;
+    }
+
+    return btDefaultVehicleRaycaster::castRay(from, to, result);
+}
+
+RaycastVehicleManager::RaycastVehicleManager(PhysicsWorld* physicsWorld) :
+    physicsWorld_(physicsWorld)
+{
+}
+
+RaycastVehicleManager::~RaycastVehicleManager()
+{
+    btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
+    if (added_ && world)
+        world->removeAction(this);
+}
+
+void RaycastVehicleManager::AddVehicle(btRaycastVehicle* vehicle, RaycastVehicleRaycaster* raycaster)
+{
+    vehicles_.Push(MakePair(vehicle, raycaster));
+
+    btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
+    if (!added_ && world)
+    {
+        world->addAction(this);
+        added_ = true;
+    }
+}
+
+void RaycastVehicleManager::RemoveVehicle(btRaycastVehicle* vehicle)
+{
+    for (i32 i = 0; i < vehicles_.Size(); ++i)
+    {
+        if (vehicles_[i].first_ == vehicle)
+        {
+            vehicles_.Erase(i);
+            break;
+        }
+    }
+
+    btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
+    if (added_ && vehicles_.Empty() && world)
+    {
+        world->removeAction(this);
+        added_ = false;
+    }
+}
+
+void RaycastVehicleManager::updateAction(btCollisionWorld* collisionWorld, btScalar step)
+{
+    // Sleeping vehicles keep their last wheel contact state. Bullet wakes the chassis when something touches it
+    activeVehicles_.Clear();
+    rays_.resize(0);
+    for (i32 i = 0; i < vehicles_.Size(); ++i)
+    {
+        btRaycastVehicle* vehicle = vehicles_[i].first_;
+        if (!vehicle->getRigidBody()->isActive())
+            continue;
+
+        activeVehicles_.Push(i);
+
+        // Same rays as btRaycastVehicle::rayCast() will request during the update, as the chassis does not move in between
+        for (i32 j = 0; j < vehicle->getNumWheels(); ++j)
+        {
+            btWheelInfo& wheel = vehicle->getWheelInfo(j);
+            vehicle->updateWheelTransformsWS(wheel, false);
+
+            RaycastVehicleWheelRay& ray = rays_.expandNonInitializing();
+            ray.from_ = wheel.m_raycastInfo.m_hardPointWS;
+            ray.to_ = ray.from_ + wheel.m_raycastInfo.m_wheelDirectionWS * (wheel.getSuspensionRestLength() + wheel.m_wheelsRadius);
+            ray.hitObject_ = nullptr;
+        }
+    }
+
+    // Cast all wheel rays first. Other broadphases than the default are left to the vehicles' own raycasts
+    auto* broadphase = dynamic_cast<btDbvtBroadphase*>(collisionWorld->getBroadphase());
+    i32 numRays = rays_.size();
+    if (broadphase && numRays)
+    {
+        auto* queue = physicsWorld_->GetSubsystem<WorkQueue>();
+        if (queue && numRays >= MIN_PARALLEL_WHEEL_RAYS)
+            queue->RunParallel(CastWheelRaysWork, &rays_[0], numRays, 0, broadphase);
+        else
+        {
+            btAlignedObjectArray<const btDbvtNode*> stack;
+            for (i32 i = 0; i < numRays; ++i)
+                CastWheelRay(broadphase, rays_[i], stack);
+        }
+    }
+
+    // Update the vehicles in order, each reading back its own wheel rays. Suspension and friction stay in
+    // btRaycastVehicle::updateVehicle() rather than running in SoA loops over all wheels. Friction resolves impulses
+    // against the ground body wheel by wheel, reading velocities that the previous wheels changed, and the wheels of
+    // many vehicles usually share the same ground body, so batching it would change the results. The suspension is only
+    // a few operations per wheel between the raycast and the friction, and splitting it out would mean maintaining a copy
+    // of updateVehicle() apart from Bullet
+    i32 firstRay = 0;
+    for (i32 index : activeVehicles_)
+    {
+        btRaycastVehicle* vehicle = vehicles_[index].first_;
+        RaycastVehicleRaycaster* raycaster = vehicles_[index].second_;
+        i32 numWheels = vehicle->getNumWheels();
+
+        raycaster->SetRays(broadphase && numWheels ? &rays_[firstRay] : nullptr, broadphase ? numWheels : 0);
+        vehicle->updateAction(collisionWorld, step);
+        raycaster->SetRays(nullptr, 0);
+        firstRay += numWheels;
+    }
+}
+
+void RaycastVehicleManager::debugDraw(btIDebugDraw* debugDrawer)
+{
+    for (const Pair<btRaycastVehicle*, RaycastVehicleRaycaster*>& vehicle : vehicles_)
+        vehicle.first_->debugDraw(debugDrawer);
+}
+
+void RaycastVehicleManager::CastWheelRaysWork(const WorkItem* item, i32 /*threadIndex*/)
+{
+    auto* broadphase = reinterpret_cast<btDbvtBroadphase*>(item->aux_);
+    auto* start = reinterpret_cast<RaycastVehicleWheelRay*>(item->start_);
+    auto* end = reinterpret_cast<RaycastVehicleWheelRay*>(item->end_);
+
+    btAlignedObjectArray<const btDbvtNode*> stack;
+    for (RaycastVehicleWheelRay* ray = start; ray != end; ++ray)
+        CastWheelRay(broadphase, *ray, stack);
+}
+
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+/// \file
+/// @nobindfile
+
+#pragma once
+
+#include "../Container/Vector.h"
+
+#include <Bullet/BulletDynamics/Dynamics/btActionInterface.h>
+#include <Bullet/BulletDynamics/Vehicle/btRaycastVehicle.h>
+
+namespace Urho3D
+{
+
+class PhysicsWorld;
+struct WorkItem;
+
+/// Wheel ray cast by the vehicle manager before the vehicles are updated.
+struct RaycastVehicleWheelRay
+{
+    /// Ray start in world space.
+    btVector3 from_;
+    /// Ray end in world space.
+    btVector3 to_;
+    /// Hit result.
+    btVehicleRaycaster::btVehicleRaycasterResult result_;
+    /// Body that was hit, or null if none.
+    void* hitObject_;
+};
+
+/// Vehicle raycaster that returns the wheel rays cast in advance by the vehicle manager, and casts other rays itself.
+class RaycastVehicleRaycaster : public btDefaultVehicleRaycaster
+{
+public:
+    /// Construct.
+    explicit RaycastVehicleRaycaster(btDynamicsWorld* world) :
+        btDefaultVehicleRaycaster(world)
+    {
+    }
+
+    /// Cast a ray, returning the result cast in advance if the ray matches the next one.
+    void* castRay(const btVector3& from, const btVector3& to, btVehicleRaycasterResult& result) override;
+
+    /// Set the rays cast in advance for the next vehicle update.
+    void SetRays(const RaycastVehicleWheelRay* rays, i32 numRays)
+    {
+        rays_ = rays;
+        numRays_ = numRays;
+        nextRay_ = 0;
+    }
+
+private:
+    /// Rays cast in advance.
+    const RaycastVehicleWheelRay* rays_{};
+    /// Number of rays cast in advance.
+    i32 numRays_{};
+    /// Index of the next ray expected.
+    i32 nextRay_{};
+};
+
+/// Bullet action that updates all raycast vehicles of a physics world. Casts the wheel rays of all awake vehicles as one
+/// batch, in parallel when there are enough of them, and skips sleeping vehicles. Suspension and friction are solved by
+/// each vehicle in turn.
+class RaycastVehicleManager : public btActionInterface
+{
+public:
+    /// Construct.
+    explicit RaycastVehicleManager(PhysicsWorld* physicsWorld);
+    /// Destruct. Remove from the Bullet world if still added.
+    ~RaycastVehicleManager() override;
+
+    /// Add a vehicle. It must use the given raycaster.
+    void AddVehicle(btRaycastVehicle* vehicle, RaycastVehicleRaycaster* raycaster);
+    /// Remove a vehicle.
+    void RemoveVehicle(btRaycastVehicle* vehicle);
+
+    /// Update the vehicles during the simulation step.
+    void updateAction(btCollisionWorld* collisionWorld, btScalar step) override;
+    /// Draw the vehicles for debugging.
+    void debugDraw(btIDebugDraw* debugDrawer) override;
+
+    /// Return number of vehicles.
+    i32 GetNumVehicles() const { return vehicles_.Size(); }
+
+private:
+    /// Cast a range of wheel rays in a worker thread.
+    static void CastWheelRaysWork(const WorkItem* item, i32 threadIndex);
+
+    /// Physics world.
+    PhysicsWorld* physicsWorld_;
+    /// Vehicles and their raycasters.
+    Vector<Pair<btRaycastVehicle*, RaycastVehicleRaycaster*>> vehicles_;
+    /// Indices of the vehicles awake on this step.
+    Vector<i32> activeVehicles_;
+    /// Wheel rays of the awake vehicles on this step, in vehicle and wheel order.
+    btAlignedObjectArray<RaycastVehicleWheelRay> rays_;
+    /// Added to the Bullet world flag.
+    bool added_{};
+};
+
+}
@@ -1012,8 +1012,10 @@ void RigidBody::RemoveBodyFromWorld()
 {
     if (physicsWorld_ && body_ && inWorld_)
     {
+        // The world is already gone when the physics world is being destroyed
         btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
-        world->removeRigidBody(body_.get());
+        if (world)
+            world->removeRigidBody(body_.get());
         inWorld_ = false;
     }
 }
@@ -105,7 +105,8 @@ void PhysicsWorld2D::BeginContact(b2Contact* contact)
 
 void PhysicsWorld2D::EndContact(b2Contact* contact)
 {
-    if (!physicsStepping_)
+    // Also handle contacts ended by contact event handlers destroying bodies or shapes
+    if (!physicsStepping_ && !sendingContactEvents_)
         return;
 
     b2Fixture* fixtureA = contact->GetFixtureA();
@@ -123,6 +124,16 @@ void PhysicsWorld2D::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
     if (!fixtureA || !fixtureB)
         return;
 
+    // This is called for every touching contact on every step, so return early if there is nobody to tell
+    if (!HasEventReceivers(E_PHYSICSUPDATECONTACT2D))
+    {
+        Node* nodeA = ((RigidBody2D*)(fixtureA->GetBody()->GetUserData().pointer))->GetNode();
+        Node* nodeB = ((RigidBody2D*)(fixtureB->GetBody()->GetUserData().pointer))->GetNode();
+        if ((!nodeA || !nodeA->HasEventReceivers(E_NODEUPDATECONTACT2D)) &&
+            (!nodeB || !nodeB->HasEventReceivers(E_NODEUPDATECONTACT2D)))
+            return;
+    }
+
     ContactInfo contactInfo(contact);
 
     // Send global event
@@ -310,11 +321,27 @@ void PhysicsWorld2D::Update(float timeStep)
         }
     }
 
+    // Send the events from the step's own buffers. Handlers may destroy bodies, which records more ended contacts;
+    // send those too until no more are recorded
+    sendingContactEvents_ = true;
+    stepBeginContactInfos_.Swap(beginContactInfos_);
+    beginContactInfos_.Clear();
     SendBeginContactEvents();
-    SendEndContactEvents();
+    while (!endContactInfos_.Empty())
+    {
+        i32 start = stepEndContactInfos_.Size();
+        stepEndContactInfos_.Push(endContactInfos_);
+        endContactInfos_.Clear();
+        SendEndContactEvents(start);
+    }
+    sendingContactEvents_ = false;
 
     using namespace PhysicsPostStep;
     SendEvent(E_PHYSICSPOSTSTEP, eventData);
+
+    // Post-step handlers may read the contacts of the whole step through GetBeginContacts() and GetEndContacts()
+    stepBeginContactInfos_.Clear();
+    stepEndContactInfos_.Clear();
 }
 
 void PhysicsWorld2D::DrawDebugGeometry()
@@ -707,7 +734,7 @@ void PhysicsWorld2D::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap
 
 void PhysicsWorld2D::SendBeginContactEvents()
 {
-    if (beginContactInfos_.Empty())
+    if (stepBeginContactInfos_.Empty())
         return;
 
     using namespace PhysicsBeginContact2D;
@@ -715,21 +742,34 @@ void PhysicsWorld2D::SendBeginContactEvents()
     VariantMap nodeEventData;
     eventData[P_WORLD] = this;
 
-    for (const ContactInfo& contactInfo : beginContactInfos_)
+    // Building the event data is the main cost with many contacts, so skip events that nobody listens to
+    bool sendWorldEvents = HasEventReceivers(E_PHYSICSBEGINCONTACT2D);
+
+    for (const ContactInfo& contactInfo : stepBeginContactInfos_)
     {
-        eventData[P_BODYA] = contactInfo.bodyA_.Get();
-        eventData[P_BODYB] = contactInfo.bodyB_.Get();
-        eventData[P_NODEA] = contactInfo.nodeA_.Get();
-        eventData[P_NODEB] = contactInfo.nodeB_.Get();
-        eventData[P_CONTACTS] = contactInfo.Serialize(contacts_);
-        eventData[P_SHAPEA] = contactInfo.shapeA_.Get();
-        eventData[P_SHAPEB] = contactInfo.shapeB_.Get();
+        bool sendEventA = contactInfo.nodeA_ && contactInfo.nodeA_->HasEventReceivers(E_NODEBEGINCONTACT2D);
+        bool sendEventB = contactInfo.nodeB_ && contactInfo.nodeB_->HasEventReceivers(E_NODEBEGINCONTACT2D);
+        if (!sendWorldEvents && !sendEventA && !sendEventB)
+            continue;
+
+        const Vector<byte>& contacts = contactInfo.Serialize(contacts_);
 
-        SendEvent(E_PHYSICSBEGINCONTACT2D, eventData);
+        if (sendWorldEvents)
+        {
+            eventData[P_BODYA] = contactInfo.bodyA_.Get();
+            eventData[P_BODYB] = contactInfo.bodyB_.Get();
+            eventData[P_NODEA] = contactInfo.nodeA_.Get();
+            eventData[P_NODEB] = contactInfo.nodeB_.Get();
+            eventData[P_CONTACTS] = contacts;
+            eventData[P_SHAPEA] = contactInfo.shapeA_.Get();
+            eventData[P_SHAPEB] = contactInfo.shapeB_.Get();
+
+            SendEvent(E_PHYSICSBEGINCONTACT2D, eventData);
+        }
 
-        nodeEventData[NodeBeginContact2D::P_CONTACTS] = contactInfo.Serialize(contacts_);
+        nodeEventData[NodeBeginContact2D::P_CONTACTS] = contacts;
 
-        if (contactInfo.nodeA_)
+        if (sendEventA)
         {
             nodeEventData[NodeBeginContact2D::P_BODY] = contactInfo.bodyA_.Get();
             nodeEventData[NodeBeginContact2D::P_OTHERNODE] = contactInfo.nodeB_.Get();
@@ -740,7 +780,7 @@ void PhysicsWorld2D::SendBeginContactEvents()
             contactInfo.nodeA_->SendEvent(E_NODEBEGINCONTACT2D, nodeEventData);
         }
 
-        if (contactInfo.nodeB_)
+        if (sendEventB)
         {
             nodeEventData[NodeBeginContact2D::P_BODY] = contactInfo.bodyB_.Get();
             nodeEventData[NodeBeginContact2D::P_OTHERNODE] = contactInfo.nodeA_.Get();
@@ -751,35 +791,45 @@ void PhysicsWorld2D::SendBeginContactEvents()
             contactInfo.nodeB_->SendEvent(E_NODEBEGINCONTACT2D, nodeEventData);
         }
     }
-
-    beginContactInfos_.Clear();
 }
 
-void PhysicsWorld2D::SendEndContactEvents()
+void PhysicsWorld2D::SendEndContactEvents(i32 start)
 {
-    if (endContactInfos_.Empty())
-        return;
 
     using namespace PhysicsEndContact2D;
     VariantMap& eventData = GetEventDataMap();
     VariantMap nodeEventData;
     eventData[P_WORLD] = this;
 
-    for (const ContactInfo& contactInfo : endContactInfos_)
+    // Building the event data is the main cost with many contacts, so skip events that nobody listens to
+    bool sendWorldEvents = HasEventReceivers(E_PHYSICSENDCONTACT2D);
+
+    for (i32 i = start; i < stepEndContactInfos_.Size(); ++i)
     {
-        eventData[P_BODYA] = contactInfo.bodyA_.Get();
-        eventData[P_BODYB] = contactInfo.bodyB_.Get();
-        eventData[P_NODEA] = contactInfo.nodeA_.Get();
-        eventData[P_NODEB] = contactInfo.nodeB_.Get();
-        eventData[P_CONTACTS] = contactInfo.Serialize(contacts_);
-        eventData[P_SHAPEA] = contactInfo.shapeA_.Get();
-        eventData[P_SHAPEB] = contactInfo.shapeB_.Get();
+        const ContactInfo& contactInfo = stepEndContactInfos_[i];
+        bool sendEventA = contactInfo.nodeA_ && contactInfo.nodeA_->HasEventReceivers(E_NODEENDCONTACT2D);
+        bool sendEventB = contactInfo.nodeB_ && contactInfo.nodeB_->HasEventReceivers(E_NODEENDCONTACT2D);
+        if (!sendWorldEvents && !sendEventA && !sendEventB)
+            continue;
 
-        SendEvent(E_PHYSICSENDCONTACT2D, eventData);
+        const Vector<byte>& contacts = contactInfo.Serialize(contacts_);
 
-        nodeEventData[NodeEndContact2D::P_CONTACTS] = contactInfo.Serialize(contacts_);
+        if (sendWorldEvents)
+        {
+            eventData[P_BODYA] = contactInfo.bodyA_.Get();
+            eventData[P_BODYB] = contactInfo.bodyB_.Get();
+            eventData[P_NODEA] = contactInfo.nodeA_.Get();
+            eventData[P_NODEB] = contactInfo.nodeB_.Get();
+            eventData[P_CONTACTS] = contacts;
+            eventData[P_SHAPEA] = contactInfo.shapeA_.Get();
+            eventData[P_SHAPEB] = contactInfo.shapeB_.Get();
+
+            SendEvent(E_PHYSICSENDCONTACT2D, eventData);
+        }
 
-        if (contactInfo.nodeA_)
+        nodeEventData[NodeEndContact2D::P_CONTACTS] = contacts;
+
+        if (sendEventA)
         {
             nodeEventData[NodeEndContact2D::P_BODY] = contactInfo.bodyA_.Get();
             nodeEventData[NodeEndContact2D::P_OTHERNODE] = contactInfo.nodeB_.Get();
@@ -790,7 +840,7 @@ void PhysicsWorld2D::SendEndContactEvents()
             contactInfo.nodeA_->SendEvent(E_NODEENDCONTACT2D, nodeEventData);
         }
 
-        if (contactInfo.nodeB_)
+        if (sendEventB)
         {
             nodeEventData[NodeEndContact2D::P_BODY] = contactInfo.bodyB_.Get();
             nodeEventData[NodeEndContact2D::P_OTHERNODE] = contactInfo.nodeA_.Get();
@@ -801,8 +851,6 @@ void PhysicsWorld2D::SendEndContactEvents()
             contactInfo.nodeB_->SendEvent(E_NODEENDCONTACT2D, nodeEventData);
         }
     }
-
-    endContactInfos_.Clear();
 }
 
 PhysicsWorld2D::ContactInfo::ContactInfo() = default;
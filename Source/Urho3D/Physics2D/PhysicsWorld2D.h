@@ -55,6 +55,38 @@ class URHO3D_API PhysicsWorld2D : public Component, public b2ContactListener, pu
     URHO3D_OBJECT(PhysicsWorld2D, Component);
 
 public:
+    /// Contact info.
+    struct ContactInfo
+    {
+        /// Construct.
+        ContactInfo();
+        /// Construct.
+        explicit ContactInfo(b2Contact* contact);
+        /// Write contact info to buffer.
+        const Vector<byte>& Serialize(VectorBuffer& buffer) const;
+
+        /// Rigid body A.
+        SharedPtr<RigidBody2D> bodyA_;
+        /// Rigid body B.
+        SharedPtr<RigidBody2D> bodyB_;
+        /// Node A.
+        SharedPtr<Node> nodeA_;
+        /// Node B.
+        SharedPtr<Node> nodeB_;
+        /// Shape A.
+        SharedPtr<CollisionShape2D> shapeA_;
+        /// Shape B.
+        SharedPtr<CollisionShape2D> shapeB_;
+        /// Number of contact points.
+        int numPoints_{};
+        /// Contact normal in world space.
+        Vector2 worldNormal_;
+        /// Contact positions in world space.
+        Vector2 worldPositions_[b2_maxManifoldPoints];
+        /// Contact overlap values.
+        float separations_[b2_maxManifoldPoints]{};
+    };
+
     /// Construct.
     explicit PhysicsWorld2D(Context* context);
     /// Destruct.
@@ -211,6 +243,13 @@ public:
     /// Return the Box2D physics world.
     b2World* GetWorld() { return world_.get(); }
 
+    /// Return the contacts that began during the current step. Valid until the physics post-step event has been sent, so that a post-step handler can process all contacts of the step without per-contact events.
+    /// @nobind
+    const Vector<ContactInfo>& GetBeginContacts() const { return stepBeginContactInfos_; }
+    /// Return the contacts that ended during the current step, including those ended by contact event handlers destroying bodies. Valid until the physics post-step event has been sent.
+    /// @nobind
+    const Vector<ContactInfo>& GetEndContacts() const { return stepEndContactInfos_; }
+
     /// Set node dirtying to be disregarded.
     void SetApplyingTransforms(bool enable) { applyingTransforms_ = enable; }
 
@@ -225,8 +264,8 @@ protected:
     void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
     /// Send begin contact events.
     void SendBeginContactEvents();
-    /// Send end contact events.
-    void SendEndContactEvents();
+    /// Send end contact events starting from an index in the step's end contacts.
+    void SendEndContactEvents(i32 start);
 
     /// Box2D physics world.
     std::unique_ptr<b2World> world_;
@@ -249,6 +288,8 @@ protected:
     bool updateEnabled_{true};
     /// Whether is currently stepping the world. Used internally.
     bool physicsStepping_{};
+    /// Whether is currently sending contact events. Used internally.
+    bool sendingContactEvents_{};
     /// Applying transforms.
     bool applyingTransforms_{};
     /// Rigid bodies.
@@ -256,41 +297,14 @@ protected:
     /// Delayed (parented) world transform assignments.
     HashMap<RigidBody2D*, DelayedWorldTransform2D> delayedWorldTransforms_;
 
-    /// Contact info.
-    struct ContactInfo
-    {
-        /// Construct.
-        ContactInfo();
-        /// Construct.
-        explicit ContactInfo(b2Contact* contact);
-        /// Write contact info to buffer.
-        const Vector<byte>& Serialize(VectorBuffer& buffer) const;
-
-        /// Rigid body A.
-        SharedPtr<RigidBody2D> bodyA_;
-        /// Rigid body B.
-        SharedPtr<RigidBody2D> bodyB_;
-        /// Node A.
-        SharedPtr<Node> nodeA_;
-        /// Node B.
-        SharedPtr<Node> nodeB_;
-        /// Shape A.
-        SharedPtr<CollisionShape2D> shapeA_;
-        /// Shape B.
-        SharedPtr<CollisionShape2D> shapeB_;
-        /// Number of contact points.
-        int numPoints_{};
-        /// Contact normal in world space.
-        Vector2 worldNormal_;
-        /// Contact positions in world space.
-        Vector2 worldPositions_[b2_maxManifoldPoints];
-        /// Contact overlap values.
-        float separations_[b2_maxManifoldPoints]{};
-    };
-    /// Begin contact infos.
+    /// Begin contact infos recorded since the contact events were last sent.
     Vector<ContactInfo> beginContactInfos_;
-    /// End contact infos.
+    /// End contact infos recorded since the contact events were last sent.
     Vector<ContactInfo> endContactInfos_;
+    /// Begin contact infos of the current step.
+    Vector<ContactInfo> stepBeginContactInfos_;
+    /// End contact infos of the current step.
+    Vector<ContactInfo> stepEndContactInfos_;
     /// Temporary buffer with contact data.
     VectorBuffer contacts_;
 };
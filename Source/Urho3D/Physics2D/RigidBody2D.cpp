@@ -405,15 +405,18 @@ void RigidBody2D::ApplyWorldTransform()
     if (!body_ || !node_)
         return;
 
-    // If the rigid body is parented to another rigid body, can not set the transform immediately.
-    // In that case store it to PhysicsWorld2D for delayed assignment
-    RigidBody2D* parentRigidBody = nullptr;
+    // If body is not parented and is static or sleeping, no need to update. Check this before looking for a parent
+    // rigid body, as most bodies in a large world are sleeping
+    bool moving = body_->IsEnabled() && body_->GetType() != b2_staticBody && body_->IsAwake();
     Node* parent = node_->GetParent();
-    if (parent != GetScene() && parent)
-        parentRigidBody = parent->GetComponent<RigidBody2D>();
+    bool unparented = !parent || parent == GetScene();
+    if (!moving && unparented)
+        return;
 
-    // If body is not parented and is static or sleeping, no need to update
-    if (!parentRigidBody && (!body_->IsEnabled() || body_->GetType() == b2_staticBody || !body_->IsAwake()))
+    // If the rigid body is parented to another rigid body, can not set the transform immediately.
+    // In that case store it to PhysicsWorld2D for delayed assignment
+    RigidBody2D* parentRigidBody = unparented ? nullptr : parent->GetComponent<RigidBody2D>();
+    if (!parentRigidBody && !moving)
         return;
 
     const b2Transform& transform = body_->GetTransform();
@@ -441,8 +444,13 @@ void RigidBody2D::ApplyWorldTransform(const Vector3& newWorldPosition, const Qua
     {
         // Do not feed changed position back to simulation now
         physicsWorld_->SetApplyingTransforms(true);
-        node_->SetWorldPosition(newWorldPosition);
-        node_->SetWorldRotation(newWorldRotation);
+        // Set both at once so that the node and its children are dirtied only once
+        Node* parent = node_->GetParent();
+        if (!parent || parent == GetScene())
+            node_->SetTransform(newWorldPosition, newWorldRotation);
+        else
+            node_->SetTransform(parent->GetWorldTransform().Inverse() * newWorldPosition,
+                parent->GetWorldRotation().Inverse() * newWorldRotation);
         physicsWorld_->SetApplyingTransforms(false);
     }
 }
@@ -12,42 +12,81 @@
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 
+#include <algorithm>
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+/// Return whether a load order entry comes after another, for keeping the resource to load next at the top of the heap.
+static bool CompareLoadOrder(const BackgroundLoadOrder& lhs, const BackgroundLoadOrder& rhs)
+{
+    if (lhs.priority_ != rhs.priority_)
+        return lhs.priority_ < rhs.priority_;
+    return lhs.sequence_ > rhs.sequence_;
+}
+
+/// Additional background loading thread.
+class BackgroundLoadThread : public Thread, public RefCounted
+{
+public:
+    /// Construct.
+    explicit BackgroundLoadThread(BackgroundLoader* owner) :
+        owner_(owner)
+    {
+        SetPriority(ThreadPriority::Low);
+    }
+
+    /// Load queued resources until stopped.
+    void ThreadFunction() override
+    {
+        URHO3D_PROFILE_THREAD("BackgroundLoader Thread");
+        owner_->ProcessQueue(shouldRun_);
+    }
+
+private:
+    /// Background loader.
+    BackgroundLoader* owner_;
+};
+
 BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
-    owner_(owner)
+    owner_(owner),
+    numThreads_(1),
+    nextSequence_(0),
+    recording_(false)
 {
+    // Keep loading from competing with the main and worker threads for CPU time
+    SetPriority(ThreadPriority::Low);
 }
 
 BackgroundLoader::~BackgroundLoader()
 {
+    // Stop all loading threads before clearing the queue they work on
+    for (const SharedPtr<BackgroundLoadThread>& thread : threads_)
+        thread->Stop();
+    Stop();
+
     MutexLock lock(backgroundLoadMutex_);
 
     backgroundLoadQueue_.Clear();
+    loadOrder_.Clear();
 }
 
 void BackgroundLoader::ThreadFunction()
 {
     URHO3D_PROFILE_THREAD("BackgroundLoader Thread");
+    ProcessQueue(shouldRun_);
+}
 
-    while (shouldRun_)
+void BackgroundLoader::ProcessQueue(volatile bool& shouldRun)
+{
+    while (shouldRun)
     {
         backgroundLoadMutex_.Acquire();
 
-        // Search for a queued resource that has not been loaded yet
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-        while (i != backgroundLoadQueue_.End())
-        {
-            if (i->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
-        }
-
-        if (i == backgroundLoadQueue_.End())
+        BackgroundLoadItem* next = TakeNextItem();
+        if (!next)
         {
             // No resources to load found
             backgroundLoadMutex_.Release();
@@ -55,19 +94,17 @@ void BackgroundLoader::ThreadFunction()
         }
         else
         {
-            BackgroundLoadItem& item = i->second_;
+            BackgroundLoadItem& item = *next;
             Resource* resource = item.resource_;
-            // We can be sure that the item is not removed from the queue as long as it is in the
-            // "queued" or "loading" state
+            // Claim the resource before releasing the mutex so that other loading threads skip it. We can be sure that
+            // the item is not removed from the queue as long as it is in the "queued" or "loading" state
+            resource->SetAsyncLoadState(ASYNC_LOADING);
             backgroundLoadMutex_.Release();
 
             bool success = false;
             SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
             if (file)
-            {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
                 success = resource->BeginLoad(*file);
-            }
 
             // Process dependencies now
             // Need to lock the queue again when manipulating other entries
@@ -87,21 +124,52 @@ void BackgroundLoader::ThreadFunction()
             }
 
             resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+
+            ResourceLoadRecord* record = recording_ ? GetRecord(key) : nullptr;
+            if (record)
+            {
+                record->loadedUSec_ = recordTimer_.GetUSec(false);
+                record->size_ = file ? file->GetSize() : 0;
+            }
+
             backgroundLoadMutex_.Release();
         }
     }
 }
 
-bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller)
+bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller, i32 priority,
+    bool prefetch)
 {
     StringHash nameHash(name);
     Pair<StringHash, StringHash> key = MakePair(type, nameHash);
 
     MutexLock lock(backgroundLoadMutex_);
 
-    // Check if already exists in the queue
-    if (backgroundLoadQueue_.Find(key) != backgroundLoadQueue_.End())
+    // Check if already exists in the queue. If it has not loaded yet, for example because it was prefetched, the caller still
+    // needs to wait for it
+    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator existing = backgroundLoadQueue_.Find(key);
+    if (existing != backgroundLoadQueue_.End())
+    {
+        if (!prefetch)
+        {
+            BackgroundLoadItem& item = existing->second_;
+            AsyncLoadState state = item.resource_->GetAsyncLoadState();
+            if (caller && (state == ASYNC_QUEUED || state == ASYNC_LOADING))
+            {
+                // Load it no later than the caller would have been, now that the caller waits for it
+                BackgroundLoadItem* callerItem = AddDependency(item, key, caller);
+                if (callerItem && state == ASYNC_QUEUED && callerItem->priority_ > item.priority_)
+                {
+                    item.priority_ = callerItem->priority_;
+                    AddLoadOrder(item, key);
+                }
+            }
+            if (recording_)
+                RecordRequest(key, name, caller, true);
+        }
+
         return false;
+    }
 
     BackgroundLoadItem& item = backgroundLoadQueue_[key];
     item.sendEventOnFailure_ = sendEventOnFailure;
@@ -129,26 +197,27 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
 
     item.resource_->SetName(name);
     item.resource_->SetAsyncLoadState(ASYNC_QUEUED);
+    item.priority_ = priority;
 
-    // If this is a resource calling for the background load of more resources, mark the dependency as necessary
+    // If this is a resource calling for the background load of more resources, mark the dependency as necessary. Load it
+    // no later than the caller would have been
     if (caller)
     {
-        Pair<StringHash, StringHash> callerKey = MakePair(caller->GetType(), caller->GetNameHash());
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(callerKey);
-        if (j != backgroundLoadQueue_.End())
-        {
-            BackgroundLoadItem& callerItem = j->second_;
-            item.dependents_.Insert(callerKey);
-            callerItem.dependencies_.Insert(key);
-        }
-        else
-            URHO3D_LOGWARNING("Resource " + caller->GetName() +
-                       " requested for a background loaded resource but was not in the background load queue");
+        BackgroundLoadItem* callerItem = AddDependency(item, key, caller);
+        if (callerItem)
+            item.priority_ = Max(item.priority_, callerItem->priority_);
     }
 
-    // Start the background loader thread now
+    AddLoadOrder(item, key);
+    if (recording_)
+        RecordRequest(key, name, caller, !prefetch);
+
+    // Start the background loader threads now
     if (!IsStarted())
+    {
         Run();
+        StartThreads();
+    }
 
     return true;
 }
@@ -198,8 +267,10 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
         backgroundLoadMutex_.Release();
 }
 
-void BackgroundLoader::FinishResources(int maxMs)
+bool BackgroundLoader::FinishResources(long long maxUSec)
 {
+    bool remaining = false;
+
     if (IsStarted())
     {
         HiresTimer timer;
@@ -225,12 +296,15 @@ void BackgroundLoader::FinishResources(int maxMs)
             }
 
             // Break when the time limit passed so that we keep sufficient FPS
-            if (timer.GetUSec(false) >= maxMs * 1000LL)
+            if (timer.GetUSec(false) >= maxUSec)
                 break;
         }
 
+        remaining = !backgroundLoadQueue_.Empty();
         backgroundLoadMutex_.Release();
     }
+
+    return remaining;
 }
 
 unsigned BackgroundLoader::GetNumQueuedResources() const
@@ -239,6 +313,200 @@ unsigned BackgroundLoader::GetNumQueuedResources() const
     return backgroundLoadQueue_.Size();
 }
 
+bool BackgroundLoader::IsQueued(StringHash type, StringHash nameHash) const
+{
+    MutexLock lock(backgroundLoadMutex_);
+    return backgroundLoadQueue_.Contains(MakePair(type, nameHash));
+}
+
+void BackgroundLoader::SetNumThreads(i32 num)
+{
+    Vector<SharedPtr<BackgroundLoadThread>> stopped;
+
+    {
+        MutexLock lock(backgroundLoadMutex_);
+
+        numThreads_ = Max(num, 1);
+        while (threads_.Size() > numThreads_ - 1)
+        {
+            stopped.Push(threads_.Back());
+            threads_.Pop();
+        }
+
+        // If not started yet, the threads start on the first request
+        if (IsStarted())
+            StartThreads();
+    }
+
+    // Stop outside the lock, as the threads finish the resource they are loading first
+    for (const SharedPtr<BackgroundLoadThread>& thread : stopped)
+        thread->Stop();
+}
+
+void BackgroundLoader::StartRecording()
+{
+    MutexLock lock(backgroundLoadMutex_);
+
+    records_.Clear();
+    recordIndices_.Clear();
+    recordTimer_.Reset();
+    recording_ = true;
+}
+
+Vector<ResourceLoadRecord> BackgroundLoader::StopRecording()
+{
+    MutexLock lock(backgroundLoadMutex_);
+
+    recording_ = false;
+
+    // Depth is the length of the parent chain. Resources depending on each other would make it loop, so cap the walk
+    for (ResourceLoadRecord& record : records_)
+    {
+        record.depth_ = 0;
+        for (i32 parent = record.parent_; parent >= 0 && record.depth_ < records_.Size(); parent = records_[parent].parent_)
+            ++record.depth_;
+    }
+
+    Vector<ResourceLoadRecord> ret;
+    ret.Swap(records_);
+    recordIndices_.Clear();
+    return ret;
+}
+
+void BackgroundLoader::RecordRequest(StringHash type, const String& name, Resource* caller)
+{
+    MutexLock lock(backgroundLoadMutex_);
+
+    Pair<StringHash, StringHash> key = MakePair(type, StringHash(name));
+    if (recording_ && GetRecord(key))
+        RecordRequest(key, name, caller, true);
+}
+
+void BackgroundLoader::StartThreads()
+{
+    while (threads_.Size() < numThreads_ - 1)
+    {
+        SharedPtr<BackgroundLoadThread> thread(new BackgroundLoadThread(this));
+        thread->Run();
+        threads_.Push(thread);
+    }
+}
+
+void BackgroundLoader::AddLoadOrder(const BackgroundLoadItem& item, const Pair<StringHash, StringHash>& key)
+{
+    loadOrder_.Push(BackgroundLoadOrder{item.priority_, nextSequence_++, key});
+    std::push_heap(loadOrder_.Begin(), loadOrder_.End(), CompareLoadOrder);
+}
+
+BackgroundLoadItem* BackgroundLoader::TakeNextItem()
+{
+    while (!loadOrder_.Empty())
+    {
+        std::pop_heap(loadOrder_.Begin(), loadOrder_.End(), CompareLoadOrder);
+        BackgroundLoadOrder order = loadOrder_.Back();
+        loadOrder_.Pop();
+
+        // Resources may have been loaded already by another thread or when requested, or added again with a higher priority
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(order.key_);
+        if (i != backgroundLoadQueue_.End() && i->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED &&
+            i->second_.priority_ == order.priority_)
+            return &i->second_;
+    }
+
+    return nullptr;
+}
+
+BackgroundLoadItem* BackgroundLoader::AddDependency(BackgroundLoadItem& item, const Pair<StringHash, StringHash>& key, Resource* caller)
+{
+    Pair<StringHash, StringHash> callerKey = MakePair(caller->GetType(), caller->GetNameHash());
+    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(callerKey);
+    if (j == backgroundLoadQueue_.End())
+    {
+        URHO3D_LOGWARNING("Resource " + caller->GetName() +
+                   " requested for a background loaded resource but was not in the background load queue");
+        return nullptr;
+    }
+
+    // Resources requesting each other would both wait for the other to load before finishing. Let the one requesting
+    // last go without waiting, like for a resource that has loaded already
+    if (key == callerKey || DependsOn(item, callerKey))
+    {
+        URHO3D_LOGDEBUG("Resource " + caller->GetName() + " requested " + item.resource_->GetName() +
+            " which depends on it, not waiting for it");
+        return nullptr;
+    }
+
+    BackgroundLoadItem& callerItem = j->second_;
+    item.dependents_.Insert(callerKey);
+    callerItem.dependencies_.Insert(key);
+    return &callerItem;
+}
+
+bool BackgroundLoader::DependsOn(const BackgroundLoadItem& item, const Pair<StringHash, StringHash>& key) const
+{
+    HashSet<Pair<StringHash, StringHash>> visited;
+    Vector<const BackgroundLoadItem*> stack;
+    stack.Push(&item);
+
+    while (!stack.Empty())
+    {
+        const BackgroundLoadItem* current = stack.Back();
+        stack.Pop();
+
+        for (const Pair<StringHash, StringHash>& dependency : current->dependencies_)
+        {
+            if (dependency == key)
+                return true;
+            bool visitedBefore;
+            visited.Insert(dependency, visitedBefore);
+            if (visitedBefore)
+                continue;
+
+            HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::ConstIterator i = backgroundLoadQueue_.Find(dependency);
+            if (i != backgroundLoadQueue_.End())
+                stack.Push(&i->second_);
+        }
+    }
+
+    return false;
+}
+
+void BackgroundLoader::RecordRequest(const Pair<StringHash, StringHash>& key, const String& name, Resource* caller, bool requested)
+{
+    i32 callerIndex = -1;
+    if (caller)
+    {
+        HashMap<Pair<StringHash, StringHash>, i32>::ConstIterator i =
+            recordIndices_.Find(MakePair(caller->GetType(), caller->GetNameHash()));
+        if (i != recordIndices_.End())
+            callerIndex = i->second_;
+    }
+
+    ResourceLoadRecord* record = GetRecord(key);
+    if (!record)
+    {
+        recordIndices_[key] = records_.Size();
+        records_.Resize(records_.Size() + 1);
+        record = &records_.Back();
+        record->type_ = key.first_;
+        record->name_ = name;
+        record->queuedUSec_ = recordTimer_.GetUSec(false);
+    }
+
+    if (requested)
+    {
+        record->requested_ = true;
+        if (record->parent_ < 0 && callerIndex >= 0 && callerIndex != recordIndices_[key])
+            record->parent_ = callerIndex;
+    }
+}
+
+ResourceLoadRecord* BackgroundLoader::GetRecord(const Pair<StringHash, StringHash>& key)
+{
+    HashMap<Pair<StringHash, StringHash>, i32>::ConstIterator i = recordIndices_.Find(key);
+    return i != recordIndices_.End() ? &records_[i->second_] : nullptr;
+}
+
 void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
 {
     Resource* resource = item.resource_;
@@ -270,6 +538,16 @@ void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
     }
     resource->SetAsyncLoadState(ASYNC_DONE);
 
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        ResourceLoadRecord* record = recording_ ? GetRecord(MakePair(resource->GetType(), resource->GetNameHash())) : nullptr;
+        if (record)
+        {
+            record->finishedUSec_ = recordTimer_.GetUSec(false);
+            record->success_ = success;
+        }
+    }
+
     if (!success && item.sendEventOnFailure_)
     {
         using namespace LoadFailed;
@@ -9,11 +9,14 @@
 #include "../Container/Ptr.h"
 #include "../Container/RefCounted.h"
 #include "../Core/Thread.h"
+#include "../Core/Timer.h"
 #include "../Math/StringHash.h"
+#include "../Resource/ResourceManifest.h"
 
 namespace Urho3D
 {
 
+class BackgroundLoadThread;
 class Resource;
 class ResourceCache;
 
@@ -26,14 +29,29 @@ struct BackgroundLoadItem
     HashSet<Pair<StringHash, StringHash>> dependencies_;
     /// Resources that depend on this resource's loading.
     HashSet<Pair<StringHash, StringHash>> dependents_;
+    /// Priority. Higher value = will be loaded first.
+    i32 priority_{};
     /// Whether to send failure event.
     bool sendEventOnFailure_;
 };
 
+/// Entry in the order of loading the queued resources.
+struct BackgroundLoadOrder
+{
+    /// Priority of the resource when added.
+    i32 priority_;
+    /// Sequence number. Resources with the same priority are loaded in the order they were queued.
+    u32 sequence_;
+    /// Resource type and name hash.
+    Pair<StringHash, StringHash> key_;
+};
+
 /// Background loader of resources. Owned by the ResourceCache.
 /// @nobind
 class BackgroundLoader : public RefCounted, public Thread
 {
+    friend class BackgroundLoadThread;
+
 public:
     /// Construct.
     explicit BackgroundLoader(ResourceCache* owner);
@@ -44,17 +62,47 @@ public:
     /// Resource background loading loop.
     void ThreadFunction() override;
 
-    /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
-    bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller);
+    /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type). Prefetched resources do not count as requested when recording.
+    bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller, i32 priority = 0, bool prefetch = false);
     /// Wait and finish possible loading of a resource when being requested from the cache.
     void WaitForResource(StringHash type, StringHash nameHash);
-    /// Process resources that are ready to finish.
-    void FinishResources(int maxMs);
+    /// Process resources that are ready to finish, within a time limit in microseconds. Return true if resources remain in the load queue.
+    bool FinishResources(long long maxUSec);
+    /// Set number of loading threads, including this one.
+    void SetNumThreads(i32 num);
+    /// Start recording loads. Clears the previous recording.
+    void StartRecording();
+    /// Stop recording and return the recorded loads.
+    Vector<ResourceLoadRecord> StopRecording();
+    /// Record a request for a resource that was loaded already. No-op unless recording and the resource was loaded while recording.
+    void RecordRequest(StringHash type, const String& name, Resource* caller);
 
     /// Return amount of resources in the load queue.
     unsigned GetNumQueuedResources() const;
+    /// Return whether a resource is in the load queue.
+    bool IsQueued(StringHash type, StringHash nameHash) const;
+    /// Return number of loading threads, including this one.
+    i32 GetNumThreads() const { return numThreads_; }
+    /// Return whether recording loads.
+    bool IsRecording() const { return recording_; }
 
 private:
+    /// Load queued resources until stopped. Called by all loading threads.
+    void ProcessQueue(volatile bool& shouldRun);
+    /// Start the additional loading threads. Called with the queue locked.
+    void StartThreads();
+    /// Add a queued resource to the load order. Called with the queue locked.
+    void AddLoadOrder(const BackgroundLoadItem& item, const Pair<StringHash, StringHash>& key);
+    /// Remove and return the queued resource to load next, or null if none. Called with the queue locked.
+    BackgroundLoadItem* TakeNextItem();
+    /// Make a queued resource a dependency of the resource requesting it. Return the caller's queue item, or null if it is not queued or the dependency would be circular.
+    BackgroundLoadItem* AddDependency(BackgroundLoadItem& item, const Pair<StringHash, StringHash>& key, Resource* caller);
+    /// Return whether a queued resource waits for another, directly or through other queued resources. Called with the queue locked.
+    bool DependsOn(const BackgroundLoadItem& item, const Pair<StringHash, StringHash>& key) const;
+    /// Record a request to load a resource. Called with the queue locked.
+    void RecordRequest(const Pair<StringHash, StringHash>& key, const String& name, Resource* caller, bool requested);
+    /// Return the record of a resource, or null if not recorded. Called with the queue locked.
+    ResourceLoadRecord* GetRecord(const Pair<StringHash, StringHash>& key);
     /// Finish one background loaded resource.
     void FinishBackgroundLoading(BackgroundLoadItem& item);
 
@@ -64,6 +112,22 @@ private:
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Additional loading threads.
+    Vector<SharedPtr<BackgroundLoadThread>> threads_;
+    /// Number of loading threads, including this one.
+    i32 numThreads_;
+    /// Queued resources as a binary heap with the resource to load next first. Entries of resources that have started loading or changed priority since are skipped.
+    Vector<BackgroundLoadOrder> loadOrder_;
+    /// Sequence number for the next entry in the load order.
+    u32 nextSequence_;
+    /// Recording flag.
+    bool recording_;
+    /// Recorded loads.
+    Vector<ResourceLoadRecord> records_;
+    /// Indices of recorded loads by type and name.
+    HashMap<Pair<StringHash, StringHash>, i32> recordIndices_;
+    /// Time since recording started.
+    HiresTimer recordTimer_;
 };
 
 }
@@ -5,12 +5,14 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/FrameScheduler.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
 #include "../IO/FileSystem.h"
 #include "../IO/FileWatcher.h"
 #include "../IO/Log.h"
 #include "../IO/PackageFile.h"
+#include "../IO/VectorBuffer.h"
 #include "../Resource/BackgroundLoader.h"
 #include "../Resource/Image.h"
 #include "../Resource/JSONFile.h"
@@ -26,6 +28,37 @@
 namespace Urho3D
 {
 
+/// Maximum number of changed resource files read into memory at once when reloading.
+static const i32 MAX_PARALLEL_RELOADS = 64;
+
+/// Resource to reload, with its file read into memory by a worker thread.
+struct ReloadTask
+{
+    /// Resource cache.
+    ResourceCache* cache_;
+    /// Resource.
+    SharedPtr<Resource> resource_;
+    /// File contents.
+    VectorBuffer data_;
+    /// Whether the file was read.
+    bool read_{};
+};
+
+static void ReadReloadFileWork(const WorkItem* item, i32 /*threadIndex*/)
+{
+    auto* task = reinterpret_cast<ReloadTask*>(item->start_);
+
+    // Failures are not reported here, as the resource not found event can not be sent from a worker thread
+    SharedPtr<File> file = task->cache_->GetFile(task->resource_->GetName(), false);
+    if (!file)
+        return;
+
+    auto size = (i32)file->GetSize();
+    task->data_.SetData(*file, size);
+    task->data_.SetName(file->GetName());
+    task->read_ = task->data_.GetSize() == size;
+}
+
 static const char* checkDirs[] =
 {
     "Fonts",
@@ -66,6 +99,21 @@ ResourceCache::ResourceCache(Context* context) :
 
     // Subscribe BeginFrame for handling directory watchers and background loaded resource finalization
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(ResourceCache, HandleBeginFrame));
+
+    // Reloading and finishing resources are deferred to the time left in the frame if the frame scheduler exists
+    frameScheduler_ = GetSubsystem<FrameScheduler>();
+    if (frameScheduler_)
+    {
+        reloadTask_ = frameScheduler_->AddTask(this, "ReloadResources", [this](long long) { return ReloadChangedFiles(); },
+            FT_PRIORITY_LOW, 1);
+#ifdef URHO3D_THREADING
+        finishResourcesTask_ = frameScheduler_->AddTask(this, "FinishBackgroundResources", [this](long long maxUSec)
+        {
+            URHO3D_PROFILE(FinishBackgroundResources);
+            return backgroundLoader_->FinishResources(maxUSec);
+        }, FT_PRIORITY_HIGH, finishBackgroundResourcesMs_);
+#endif
+    }
 }
 
 ResourceCache::~ResourceCache()
@@ -104,13 +152,13 @@ bool ResourceCache::AddResourceDir(const String& pathName, i32 priority)
     else
         resourceDirs_.Push(fixedPath);
 
-    // If resource auto-reloading active, create a file watcher for the directory
-    if (autoReloadResources_)
-    {
-        SharedPtr<FileWatcher> watcher(new FileWatcher(context_));
-        watcher->StartWatching(fixedPath, true);
-        fileWatchers_.Push(watcher);
-    }
+    // If resource auto-reloading or the index is active, create a file watcher for the directory. Start watching
+    // before indexing, so that files added during the scan are not missed
+    if (autoReloadResources_ || useResourceIndex_)
+        CreateFileWatcher(fixedPath);
+
+    if (useResourceIndex_)
+        resourceIndex_.AddDir(fileSystem, fixedPath);
 
     URHO3D_LOGINFO("Added resource path " + fixedPath);
     return true;
@@ -177,6 +225,7 @@ void ResourceCache::RemoveResourceDir(const String& pathName)
         if (!resourceDirs_[i].Compare(fixedPath, false))
         {
             resourceDirs_.Erase(i);
+            resourceIndex_.RemoveDir(fixedPath);
             // Remove the filewatcher with the matching path
             for (unsigned j = 0; j < fileWatchers_.Size(); ++j)
             {
@@ -327,6 +376,13 @@ void ResourceCache::ReleaseResources(const String& partialName, bool force)
     } while (released && !force);
 }
 
+void ResourceCache::SetNumBackgroundLoadThreads(i32 num)
+{
+#ifdef URHO3D_THREADING
+    backgroundLoader_->SetNumThreads(num);
+#endif
+}
+
 void ResourceCache::ReleaseAllResources(bool force)
 {
     bool released;
@@ -362,10 +418,13 @@ bool ResourceCache::ReloadResource(Resource* resource)
 
     resource->SendEvent(E_RELOADSTARTED);
 
-    bool success = false;
     SharedPtr<File> file = GetFile(resource->GetName());
-    if (file)
-        success = resource->Load(*(file.Get()));
+    return FinishReloadResource(resource, file.Get());
+}
+
+bool ResourceCache::FinishReloadResource(Resource* resource, Deserializer* source)
+{
+    bool success = source && resource->Load(*source);
 
     if (success)
     {
@@ -419,31 +478,210 @@ void ResourceCache::ReloadResourceWithDependencies(const String& fileName)
     }
 }
 
-void ResourceCache::SetMemoryBudget(StringHash type, unsigned long long budget)
+void ResourceCache::ReloadResourcesWithDependencies(const Vector<String>& fileNames)
 {
-    resourceGroups_[type].memoryBudget_ = budget;
-}
+    URHO3D_PROFILE(ReloadResources);
 
-void ResourceCache::SetAutoReloadResources(bool enable)
-{
-    if (enable != autoReloadResources_)
+    // Collect the dependents of all changed files first, so that a resource which changed itself but also depends on
+    // another changed file is reloaded once, after that file
+    Vector<StringHash> dependents;
+    HashSet<StringHash> isDependent;
+    for (const String& fileName : fileNames)
     {
-        if (enable)
+        StringHash fileNameHash(fileName);
+        const SharedPtr<Resource>& resource = FindResource(fileNameHash);
+        // Always perform dependency resource check for resource loaded from XML file as it could be used in inheritance
+        if (resource && GetExtension(resource->GetName()) != ".xml")
+            continue;
+
+        HashMap<StringHash, HashSet<StringHash>>::ConstIterator j = dependentResources_.Find(fileNameHash);
+        if (j == dependentResources_.End())
+            continue;
+
+        for (HashSet<StringHash>::ConstIterator k = j->second_.Begin(); k != j->second_.End(); ++k)
         {
-            for (const String& resourceDir : resourceDirs_)
+            if (!isDependent.Contains(*k))
             {
-                SharedPtr<FileWatcher> watcher(new FileWatcher(context_));
-                watcher->StartWatching(resourceDir, true);
-                fileWatchers_.Push(watcher);
+                isDependent.Insert(*k);
+                dependents.Push(*k);
             }
         }
-        else
+    }
+
+    // Reloading a resource may modify the dependency tracking structure. Therefore collect the resources first
+    Vector<SharedPtr<Resource>> resources;
+    HashSet<StringHash> queued;
+    for (const String& fileName : fileNames)
+    {
+        StringHash fileNameHash(fileName);
+        if (isDependent.Contains(fileNameHash) || queued.Contains(fileNameHash))
+            continue;
+
+        const SharedPtr<Resource>& resource = FindResource(fileNameHash);
+        if (resource)
+        {
+            queued.Insert(fileNameHash);
+            resources.Push(resource);
+        }
+    }
+    for (StringHash nameHash : dependents)
+    {
+        if (queued.Contains(nameHash))
+            continue;
+
+        const SharedPtr<Resource>& resource = FindResource(nameHash);
+        if (resource)
+        {
+            queued.Insert(nameHash);
+            resources.Push(resource);
+        }
+    }
+
+    if (resources.Empty())
+        return;
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue || !queue->GetNumThreads())
+    {
+        for (const SharedPtr<Resource>& resource : resources)
         {
-            fileWatchers_.Clear();
+            URHO3D_LOGDEBUG("Reloading resource " + resource->GetName());
+            ReloadResource(resource);
         }
+        return;
+    }
+
+    // Read the files in parallel, a limited number at a time to bound the memory held. Loading stays on the main
+    // thread, as the resources are in use and their loading is not thread-safe
+    for (i32 start = 0; start < resources.Size(); start += MAX_PARALLEL_RELOADS)
+    {
+        i32 count = Min(resources.Size() - start, MAX_PARALLEL_RELOADS);
+        Vector<ReloadTask> tasks(count);
+        for (i32 i = 0; i < count; ++i)
+        {
+            ReloadTask& task = tasks[i];
+            task.cache_ = this;
+            task.resource_ = resources[start + i];
+        }
+
+        queue->RunParallel(ReadReloadFileWork, tasks.Buffer(), count, count);
+
+        for (ReloadTask& task : tasks)
+        {
+            Resource* resource = task.resource_;
+            URHO3D_LOGDEBUG("Reloading resource " + resource->GetName());
 
+            // Reload the normal way if the read failed, so that it is reported on the main thread
+            if (!task.read_)
+            {
+                ReloadResource(resource);
+                continue;
+            }
+
+            resource->SendEvent(E_RELOADSTARTED);
+            FinishReloadResource(resource, &task.data_);
+        }
+    }
+}
+
+void ResourceCache::SetMemoryBudget(StringHash type, unsigned long long budget)
+{
+    resourceGroups_[type].memoryBudget_ = budget;
+}
+
+void ResourceCache::SetAutoReloadResources(bool enable)
+{
+    if (enable != autoReloadResources_)
+    {
         autoReloadResources_ = enable;
+        UpdateFileWatchers();
+    }
+}
+
+void ResourceCache::SetUseResourceIndex(bool enable)
+{
+    if (enable == useResourceIndex_)
+        return;
+
+    MutexLock lock(resourceMutex_);
+
+    // Start watching before indexing, so that files added during the scan are not missed
+    useResourceIndex_ = enable;
+    UpdateFileWatchers();
+
+    if (enable)
+    {
+        URHO3D_PROFILE(IndexResourceDirs);
+
+        auto* fileSystem = GetSubsystem<FileSystem>();
+        for (const String& resourceDir : resourceDirs_)
+            resourceIndex_.AddDir(fileSystem, resourceDir);
+        URHO3D_LOGINFOF("Indexed %d resource files", resourceIndex_.GetNumFiles());
+    }
+    else
+        resourceIndex_.Clear();
+}
+
+bool ResourceCache::SaveResourceIndex(const String& fileName) const
+{
+    MutexLock lock(resourceMutex_);
+
+    if (!useResourceIndex_)
+    {
+        URHO3D_LOGERROR("Resource index is not enabled, can not save it");
+        return false;
+    }
+
+    File file(context_, fileName, FILE_WRITE);
+    return file.IsOpen() && resourceIndex_.Save(file);
+}
+
+bool ResourceCache::LoadResourceIndex(const String& fileName)
+{
+    if (useResourceIndex_)
+        return true;
+
+    MutexLock lock(resourceMutex_);
+
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    if (!fileSystem->FileExists(fileName))
+        return false;
+
+    // Start watching before validating, so that files added meanwhile are not missed
+    useResourceIndex_ = true;
+    UpdateFileWatchers();
+
+    File file(context_, fileName);
+    if (!resourceIndex_.Load(file, fileSystem, resourceDirs_))
+    {
+        URHO3D_LOGERROR("Invalid resource index file " + fileName);
+        resourceIndex_.Clear();
+        useResourceIndex_ = false;
+        UpdateFileWatchers();
+        return false;
+    }
+
+    URHO3D_LOGINFOF("Loaded resource index with %d files", resourceIndex_.GetNumFiles());
+    return true;
+}
+
+void ResourceCache::SetCompiledCacheDir(const String& path)
+{
+    if (path.Empty())
+    {
+        compiledCacheDir_.Clear();
+        return;
+    }
+
+    String fixedPath = AddTrailingSlash(path);
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    if (fileSystem && !fileSystem->DirExists(fixedPath) && !fileSystem->CreateDir(fixedPath))
+    {
+        URHO3D_LOGERROR("Could not create compiled resource cache directory " + fixedPath);
+        return;
     }
+
+    compiledCacheDir_ = fixedPath;
 }
 
 void ResourceCache::AddResourceRouter(ResourceRouter* router, bool addAsFirst)
@@ -637,7 +875,11 @@ bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name,
     // First check if already exists as a loaded resource
     StringHash nameHash(sanitatedName);
     if (FindResource(type, nameHash) != noResource)
+    {
+        // A prefetched resource may have loaded before it was requested
+        backgroundLoader_->RecordRequest(type, sanitatedName, caller);
         return false;
+    }
 
     return backgroundLoader_->QueueResource(type, sanitatedName, sendEventOnFailure, caller);
 #else
@@ -646,6 +888,107 @@ bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name,
 #endif
 }
 
+SharedPtr<AsyncValue<SharedPtr<Resource>>> ResourceCache::GetResourceAsync(StringHash type, const String& name)
+{
+    String sanitatedName = SanitateResourceName(name);
+    StringHash nameHash(sanitatedName);
+    Pair<StringHash, StringHash> key = MakePair(type, nameHash);
+
+    HashMap<Pair<StringHash, StringHash>, SharedPtr<AsyncValue<SharedPtr<Resource>>>>::ConstIterator i = asyncRequests_.Find(key);
+    if (i != asyncRequests_.End())
+        return i->second_;
+
+    SharedPtr<AsyncValue<SharedPtr<Resource>>> operation(new AsyncValue<SharedPtr<Resource>>());
+    if (sanitatedName.Empty())
+    {
+        operation->Complete(false);
+        return operation;
+    }
+
+    const SharedPtr<Resource>& existing = FindResource(type, nameHash);
+    if (existing)
+    {
+        operation->Complete(existing);
+        return operation;
+    }
+
+#ifdef URHO3D_THREADING
+    // The resource may already have been queued without an operation, in which case wait for it all the same
+    if (!backgroundLoader_->QueueResource(type, sanitatedName, true, nullptr) && !backgroundLoader_->IsQueued(type, nameHash))
+    {
+        operation->Complete(false);
+        return operation;
+    }
+
+    asyncRequests_[key] = operation;
+    SubscribeToEvent(this, E_RESOURCEBACKGROUNDLOADED, URHO3D_HANDLER(ResourceCache, HandleResourceBackgroundLoaded));
+#else
+    // When threading not supported, fall back to synchronous loading
+    SharedPtr<Resource> resource(GetResource(type, sanitatedName));
+    operation->Complete(resource, resource.NotNull());
+#endif
+
+    return operation;
+}
+
+i32 ResourceCache::PrefetchResources(const ResourceManifest& manifest)
+{
+#ifdef URHO3D_THREADING
+    const Vector<ResourceManifestEntry>& resources = manifest.GetResources();
+    i32 numQueued = 0;
+
+    for (i32 i = 0; i < resources.Size(); ++i)
+    {
+        const ResourceManifestEntry& entry = resources[i];
+        String sanitatedName = SanitateResourceName(entry.name_);
+        if (sanitatedName.Empty() || FindResource(entry.type_, StringHash(sanitatedName)) != noResource)
+            continue;
+
+        // Give each resource a priority above the default, loading in the manifest order
+        if (backgroundLoader_->QueueResource(entry.type_, sanitatedName, true, nullptr, resources.Size() - i, true))
+            ++numQueued;
+    }
+
+    return numQueued;
+#else
+    return 0;
+#endif
+}
+
+void ResourceCache::StartLoadRecording()
+{
+#ifdef URHO3D_THREADING
+    backgroundLoader_->StartRecording();
+#endif
+}
+
+Vector<ResourceLoadRecord> ResourceCache::StopLoadRecording()
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->StopRecording();
+#else
+    return Vector<ResourceLoadRecord>();
+#endif
+}
+
+bool ResourceCache::IsLoadRecording() const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->IsRecording();
+#else
+    return false;
+#endif
+}
+
+bool ResourceCache::IsBackgroundLoadQueued(StringHash type, const String& name) const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->IsQueued(type, StringHash(SanitateResourceName(name)));
+#else
+    return false;
+#endif
+}
+
 SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String& name, bool sendEventOnFailure)
 {
     String sanitatedName = SanitateResourceName(name);
@@ -699,6 +1042,15 @@ SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String
     return resource;
 }
 
+i32 ResourceCache::GetNumBackgroundLoadThreads() const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->GetNumThreads();
+#else
+    return 1;
+#endif
+}
+
 unsigned ResourceCache::GetNumBackgroundLoadResources() const
 {
 #ifdef URHO3D_THREADING
@@ -745,16 +1097,11 @@ bool ResourceCache::Exists(const String& name) const
             return true;
     }
 
-    FileSystem* fileSystem = GetSubsystem<FileSystem>();
-
-    for (const String& resourceDir : resourceDirs_)
-    {
-        if (fileSystem->FileExists(resourceDir + sanitatedName))
-            return true;
-    }
+    if (!FindResourceDir(sanitatedName).Empty())
+        return true;
 
     // Fallback using absolute path
-    return fileSystem->FileExists(sanitatedName);
+    return GetSubsystem<FileSystem>()->FileExists(sanitatedName);
 }
 
 unsigned long long ResourceCache::GetMemoryBudget(StringHash type) const
@@ -777,15 +1124,22 @@ unsigned long long ResourceCache::GetTotalMemoryUse() const
     return total;
 }
 
+String ResourceCache::GetCompiledCacheFileName(const String& name, const String& extension) const
+{
+    if (compiledCacheDir_.Empty() || name.Empty())
+        return String::EMPTY;
+
+    // Flatten the resource name into a single file name. Resources store their name in the file to detect collisions
+    return compiledCacheDir_ + StringHash(name).ToString() + extension;
+}
+
 String ResourceCache::GetResourceFileName(const String& name) const
 {
     FileSystem* fileSystem = GetSubsystem<FileSystem>();
 
-    for (const String& resourceDir : resourceDirs_)
-    {
-        if (fileSystem->FileExists(resourceDir + name))
-            return resourceDir + name;
-    }
+    const String& resourceDir = FindResourceDir(name);
+    if (!resourceDir.Empty())
+        return resourceDir + name;
 
     if (IsAbsolutePath(name) && fileSystem->FileExists(name))
         return name;
@@ -1066,48 +1420,192 @@ void ResourceCache::UpdateResourceGroup(StringHash type)
     }
 }
 
+void ResourceCache::SetFinishBackgroundResourcesMs(int ms)
+{
+    finishBackgroundResourcesMs_ = Max(ms, 1);
+    if (frameScheduler_ && finishResourcesTask_)
+        frameScheduler_->SetTaskSlice(finishResourcesTask_, finishBackgroundResourcesMs_);
+}
+
+bool ResourceCache::ReloadChangedFiles()
+{
+    if (changedFiles_.Empty())
+        return false;
+
+    // Reload the changes of all watchers as one batch, so that a burst of changes (for example a version control
+    // checkout) reloads each affected resource once
+    Vector<Pair<String, String>> changedFiles;
+    changedFiles.Swap(changedFiles_);
+
+    Vector<String> changedNames;
+    HashSet<String> changedNameSet;
+    for (const Pair<String, String>& file : changedFiles)
+    {
+        if (!changedNameSet.Contains(file.second_))
+        {
+            changedNameSet.Insert(file.second_);
+            changedNames.Push(file.second_);
+        }
+    }
+
+    ReloadResourcesWithDependencies(changedNames);
+
+    // Finally send a general file changed event even if the file was not a tracked resource
+    using namespace FileChanged;
+
+    for (const Pair<String, String>& file : changedFiles)
+    {
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_FILENAME] = file.first_ + file.second_;
+        eventData[P_RESOURCENAME] = file.second_;
+        SendEvent(E_FILECHANGED, eventData);
+    }
+
+    return false;
+}
+
+void ResourceCache::HandleResourceBackgroundLoaded(StringHash /*eventType*/, VariantMap& eventData)
+{
+    using namespace ResourceBackgroundLoaded;
+
+    auto* resource = static_cast<Resource*>(eventData[P_RESOURCE].GetPtr());
+    if (!resource)
+        return;
+
+    HashMap<Pair<StringHash, StringHash>, SharedPtr<AsyncValue<SharedPtr<Resource>>>>::Iterator i =
+        asyncRequests_.Find(MakePair(resource->GetType(), resource->GetNameHash()));
+    if (i == asyncRequests_.End())
+        return;
+
+    // Remove first, as the functions waiting for the resource may request it again
+    SharedPtr<AsyncValue<SharedPtr<Resource>>> operation = i->second_;
+    asyncRequests_.Erase(i);
+
+    bool success = eventData[P_SUCCESS].GetBool();
+    operation->Complete(SharedPtr<Resource>(success || returnFailedResources_ ? resource : nullptr), success);
+}
+
 void ResourceCache::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
-    for (unsigned i = 0; i < fileWatchers_.Size(); ++i)
+    if (!fileWatchers_.Empty())
     {
-        String fileName;
-        while (fileWatchers_[i]->GetNextChange(fileName))
+        // Take the settled changes of all watchers. The index is updated right away so that lookups see the new files
+        Vector<String> changes;
+
+        for (i32 i = 0; i < fileWatchers_.Size(); ++i)
         {
-            ReloadResourceWithDependencies(fileName);
+            const String& path = fileWatchers_[i]->GetPath();
+
+            // Additions and removals are reported without delay and only update the index
+            if (useResourceIndex_ && fileWatchers_[i]->GetNextFileListChanges(changes))
+            {
+                auto* fileSystem = GetSubsystem<FileSystem>();
+                MutexLock lock(resourceMutex_);
+                for (const String& fileName : changes)
+                    resourceIndex_.UpdateFile(fileSystem, path, fileName);
+                changes.Clear();
+            }
 
-            // Finally send a general file changed event even if the file was not a tracked resource
-            using namespace FileChanged;
+            if (autoReloadResources_ && fileWatchers_[i]->GetNextChanges(changes))
+            {
+                for (const String& fileName : changes)
+                    changedFiles_.Push(MakePair(path, fileName));
+                changes.Clear();
+            }
+        }
 
-            VariantMap& eventData = GetEventDataMap();
-            eventData[P_FILENAME] = fileWatchers_[i]->GetPath() + fileName;
-            eventData[P_RESOURCENAME] = fileName;
-            SendEvent(E_FILECHANGED, eventData);
+        if (!changedFiles_.Empty())
+        {
+            if (reloadTask_ && frameScheduler_)
+                frameScheduler_->WakeTask(reloadTask_);
+            else
+                ReloadChangedFiles();
         }
     }
 
-    // Check for background loaded resources that can be finished
+    // Check for background loaded resources that can be finished. Resources are queued also from the loader thread,
+    // so the frame scheduler task is woken here rather than when queuing
 #ifdef URHO3D_THREADING
+    if (finishResourcesTask_ && frameScheduler_)
+    {
+        if (backgroundLoader_->GetNumQueuedResources())
+            frameScheduler_->WakeTask(finishResourcesTask_);
+    }
+    else
     {
         URHO3D_PROFILE(FinishBackgroundResources);
-        backgroundLoader_->FinishResources(finishBackgroundResourcesMs_);
+        backgroundLoader_->FinishResources(finishBackgroundResourcesMs_ * 1000LL);
     }
 #endif
 }
 
-File* ResourceCache::SearchResourceDirs(const String& name)
+void ResourceCache::UpdateFileWatchers()
+{
+    MutexLock lock(resourceMutex_);
+
+    if (autoReloadResources_ || useResourceIndex_)
+    {
+        if (fileWatchers_.Empty())
+        {
+            for (const String& resourceDir : resourceDirs_)
+                CreateFileWatcher(resourceDir);
+        }
+        else
+        {
+            for (const SharedPtr<FileWatcher>& watcher : fileWatchers_)
+                watcher->SetReportFileListChanges(useResourceIndex_);
+        }
+    }
+    else
+        fileWatchers_.Clear();
+}
+
+void ResourceCache::CreateFileWatcher(const String& resourceDir)
+{
+    SharedPtr<FileWatcher> watcher(new FileWatcher(context_));
+    watcher->SetReportFileListChanges(useResourceIndex_);
+    watcher->StartWatching(resourceDir, true);
+    fileWatchers_.Push(watcher);
+}
+
+const String& ResourceCache::FindResourceDir(const String& name) const
 {
     FileSystem* fileSystem = GetSubsystem<FileSystem>();
 
-    for (const String& resourceDir : resourceDirs_)
+    if (useResourceIndex_)
     {
-        if (fileSystem->FileExists(resourceDir + name))
+        for (const String& resourceDir : resourceDirs_)
         {
-            // Construct the file first with full path, then rename it to not contain the resource path,
-            // so that the file's sanitatedName can be used in further GetFile() calls (for example over the network)
-            File* file(new File(context_, resourceDir + name));
-            file->SetName(name);
-            return file;
+            if (resourceIndex_.IsIndexed(resourceDir) ? resourceIndex_.Contains(resourceDir, name) :
+                fileSystem->FileExists(resourceDir + name))
+                return resourceDir;
         }
+
+        // A file created since the file watchers last reported is not in the index yet, so check the file system too.
+        // This costs the same as without the index, and only when the file is not found
+    }
+
+    for (const String& resourceDir : resourceDirs_)
+    {
+        if (fileSystem->FileExists(resourceDir + name))
+            return resourceDir;
+    }
+
+    return String::EMPTY;
+}
+
+File* ResourceCache::SearchResourceDirs(const String& name)
+{
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+
+    const String& resourceDir = FindResourceDir(name);
+    if (!resourceDir.Empty())
+    {
+        // Construct the file first with full path, then rename it to not contain the resource path,
+        // so that the file's sanitatedName can be used in further GetFile() calls (for example over the network)
+        File* file(new File(context_, resourceDir + name));
+        file->SetName(name);
+        return file;
     }
 
     // Fallback using absolute path
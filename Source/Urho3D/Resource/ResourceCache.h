@@ -6,15 +6,19 @@
 #pragma once
 
 #include "../Container/HashSet.h"
+#include "../Core/AsyncOperation.h"
 #include "../Core/Mutex.h"
 #include "../IO/File.h"
 #include "../Resource/Resource.h"
+#include "../Resource/ResourceIndex.h"
+#include "../Resource/ResourceManifest.h"
 
 namespace Urho3D
 {
 
 class BackgroundLoader;
 class FileWatcher;
+class FrameScheduler;
 class PackageFile;
 
 /// Sets to priority so that a package or file is pushed to the end of the vector.
@@ -99,12 +103,21 @@ public:
     bool ReloadResource(Resource* resource);
     /// Reload a resource based on filename. Causes also reload of dependent resources if necessary.
     void ReloadResourceWithDependencies(const String& fileName);
+    /// Reload a batch of changed files and the resources depending on them. Each resource is reloaded once, dependents after the files they depend on. The files are read on worker threads.
+    void ReloadResourcesWithDependencies(const Vector<String>& fileNames);
     /// Set memory budget for a specific resource type, default 0 is unlimited.
     /// @property
     void SetMemoryBudget(StringHash type, unsigned long long budget);
     /// Enable or disable automatic reloading of resources as files are modified. Default false.
     /// @property
     void SetAutoReloadResources(bool enable);
+    /// Enable or disable indexing the files in resource directories, so that finding a resource file does not need file system calls. The index is kept current with file watchers. Default false.
+    /// @property
+    void SetUseResourceIndex(bool enable);
+    /// Save the resource directory index to a file for faster startup on the next run. Return true if successful.
+    bool SaveResourceIndex(const String& fileName) const;
+    /// Load a resource directory index saved earlier and enable indexing. Directories modified since saving are rescanned. Return true if successful.
+    bool LoadResourceIndex(const String& fileName);
     /// Enable or disable returning resources that failed to load. Default false. This may be useful in editing to not lose resource ref attributes.
     /// @property
     void SetReturnFailedResources(bool enable) { returnFailedResources_ = enable; }
@@ -113,9 +126,17 @@ public:
     /// @property
     void SetSearchPackagesFirst(bool value) { searchPackagesFirst_ = value; }
 
-    /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources.
+    /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources. With the frame scheduler the time left in the frame is used instead, and this is the minimum time they get every frame.
+    /// @property
+    void SetFinishBackgroundResourcesMs(int ms);
+
+    /// Set number of threads for background loading. More threads load independent resources in parallel, which requires the resources' BeginLoad() to be safe to run concurrently. Default 1.
     /// @property
-    void SetFinishBackgroundResourcesMs(int ms) { finishBackgroundResourcesMs_ = Max(ms, 1); }
+    void SetNumBackgroundLoadThreads(i32 num);
+
+    /// Set directory for compiled binary versions of text resources, which are written on first load and reused while the source is unchanged. Empty (default) disables.
+    /// @property
+    void SetCompiledCacheDir(const String& path);
 
     /// Add a resource router object. By default there is none, so the routing process is skipped.
     void AddResourceRouter(ResourceRouter* router, bool addAsFirst = false);
@@ -130,6 +151,21 @@ public:
     SharedPtr<Resource> GetTempResource(StringHash type, const String& name, bool sendEventOnFailure = true);
     /// Background load a resource. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Can be called from outside the main thread.
     bool BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure = true, Resource* caller = nullptr);
+    /// Background load a resource and return an operation that completes with it in the main thread, or with null if loading fails. Completes immediately if the resource is already loaded. Requests for a resource already being loaded share the operation.
+    /// @nobind
+    SharedPtr<AsyncValue<SharedPtr<Resource>>> GetResourceAsync(StringHash type, const String& name);
+    /// Background load the resources of a manifest in its order, before other queued resources. Resources that depend on them still wait for them when requesting them. Return the number of resources queued.
+    /// @nobind
+    i32 PrefetchResources(const ResourceManifest& manifest);
+    /// Start recording background loads with their dependencies and times. Clears the previous recording.
+    void StartLoadRecording();
+    /// Stop recording background loads and return them.
+    /// @nobind
+    Vector<ResourceLoadRecord> StopLoadRecording();
+    /// Return whether background loads are being recorded.
+    bool IsLoadRecording() const;
+    /// Return whether a resource is queued for background loading.
+    bool IsBackgroundLoadQueued(StringHash type, const String& name) const;
     /// Return number of pending background-loaded resources.
     /// @property
     unsigned GetNumBackgroundLoadResources() const;
@@ -159,6 +195,8 @@ public:
     template <class T> void ReleaseResource(const String& name, bool force = false);
     /// Template version of queueing a resource background load.
     template <class T> bool BackgroundLoadResource(const String& name, bool sendEventOnFailure = true, Resource* caller = nullptr);
+    /// Template version of background loading a resource and returning an operation that completes with it.
+    template <class T> SharedPtr<AsyncValue<SharedPtr<T>>> GetResourceAsync(const String& name);
     /// Template version of returning loaded resources of a specific type.
     template <class T> void GetResources(Vector<T*>& result) const;
     /// Return whether a file exists in the resource directories or package files. Does not check manually added in-memory resources.
@@ -179,6 +217,10 @@ public:
     /// @property
     bool GetAutoReloadResources() const { return autoReloadResources_; }
 
+    /// Return whether resource directories are indexed.
+    /// @property
+    bool GetUseResourceIndex() const { return useResourceIndex_; }
+
     /// Return whether resources that failed to load are returned.
     /// @property
     bool GetReturnFailedResources() const { return returnFailedResources_; }
@@ -191,6 +233,16 @@ public:
     /// @property
     int GetFinishBackgroundResourcesMs() const { return finishBackgroundResourcesMs_; }
 
+    /// Return number of threads for background loading.
+    /// @property
+    i32 GetNumBackgroundLoadThreads() const;
+
+    /// Return directory for compiled binary resources.
+    /// @property
+    const String& GetCompiledCacheDir() const { return compiledCacheDir_; }
+    /// Return compiled cache file name for a resource, or empty if the compiled cache is disabled. Can be called from outside the main thread.
+    String GetCompiledCacheFileName(const String& name, const String& extension) const;
+
     /// Return a resource router by index.
     ResourceRouter* GetResourceRouter(unsigned index) const;
 
@@ -217,8 +269,20 @@ private:
     void ReleasePackageResources(PackageFile* package, bool force = false);
     /// Update a resource group. Recalculate memory use and release resources if over memory budget.
     void UpdateResourceGroup(StringHash type);
-    /// Handle begin frame event. Automatic resource reloads and the finalization of background loaded resources are processed here.
+    /// Load a reloaded resource from a source, or fail if there is none. Send the reload finished or failed event. Return true on success.
+    bool FinishReloadResource(Resource* resource, Deserializer* source);
+    /// Reload the resources of changed files and send the file changed events. Return false, as the changes are handled in one batch.
+    bool ReloadChangedFiles();
+    /// Handle begin frame event. Collect changed files and check for background loaded resources to finish. Without the frame scheduler they are also processed here.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Handle a background loaded resource. Complete the operations waiting for it.
+    void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
+    /// Create or remove file watchers depending on whether automatic reloading or the resource index needs them.
+    void UpdateFileWatchers();
+    /// Create a file watcher for a resource directory.
+    void CreateFileWatcher(const String& resourceDir);
+    /// Return the first resource directory containing a file, or empty if none. Uses the index if enabled, falling back to the file system for files the index does not know of yet.
+    const String& FindResourceDir(const String& name) const;
     /// Search FileSystem for file.
     File* SearchResourceDirs(const String& name);
     /// Search resource packages for file.
@@ -230,18 +294,26 @@ private:
     HashMap<StringHash, ResourceGroup> resourceGroups_;
     /// Resource load directories.
     Vector<String> resourceDirs_;
-    /// File watchers for resource directories, if automatic reloading enabled.
+    /// File watchers for resource directories, if automatic reloading or the resource index is enabled.
     Vector<SharedPtr<FileWatcher>> fileWatchers_;
+    /// Changed files waiting for reload as resource directory and file name.
+    Vector<Pair<String, String>> changedFiles_;
+    /// Index of the files in resource directories.
+    ResourceIndex resourceIndex_;
     /// Package files.
     Vector<SharedPtr<PackageFile>> packages_;
     /// Dependent resources. Only used with automatic reload to eg. trigger reload of a cube texture when any of its faces change.
     HashMap<StringHash, HashSet<StringHash>> dependentResources_;
     /// Resource background loader.
     SharedPtr<BackgroundLoader> backgroundLoader_;
+    /// Operations waiting for background loaded resources by type and name.
+    HashMap<Pair<StringHash, StringHash>, SharedPtr<AsyncValue<SharedPtr<Resource>>>> asyncRequests_;
     /// Resource routers.
     Vector<SharedPtr<ResourceRouter>> resourceRouters_;
     /// Automatic resource reloading flag.
     bool autoReloadResources_;
+    /// Resource directory index flag.
+    bool useResourceIndex_{};
     /// Return failed resources flag.
     bool returnFailedResources_;
     /// Search priority flag.
@@ -250,6 +322,14 @@ private:
     mutable bool isRouting_;
     /// How many milliseconds maximum per frame to spend on finishing background loaded resources.
     int finishBackgroundResourcesMs_;
+    /// Frame scheduler for reloads and finishing background loaded resources.
+    WeakPtr<FrameScheduler> frameScheduler_;
+    /// Frame scheduler task for reloading changed files, or 0 if there is no frame scheduler.
+    u32 reloadTask_{};
+    /// Frame scheduler task for finishing background loaded resources, or 0 if there is no frame scheduler.
+    u32 finishResourcesTask_{};
+    /// Directory for compiled binary resources.
+    String compiledCacheDir_;
 };
 
 template <class T> T* ResourceCache::GetExistingResource(const String& name)
@@ -282,6 +362,15 @@ template <class T> bool ResourceCache::BackgroundLoadResource(const String& name
     return BackgroundLoadResource(type, name, sendEventOnFailure, caller);
 }
 
+template <class T> SharedPtr<AsyncValue<SharedPtr<T>>> ResourceCache::GetResourceAsync(const String& name)
+{
+    SharedPtr<AsyncValue<SharedPtr<T>>> result(new AsyncValue<SharedPtr<T>>());
+    SharedPtr<AsyncValue<SharedPtr<Resource>>> operation = GetResourceAsync(T::GetTypeStatic(), name);
+    AsyncValue<SharedPtr<Resource>>* source = operation.Get();
+    operation->Then([result, source]() { result->Complete(StaticCast<T>(source->GetValue()), source->IsSucceeded()); });
+    return result;
+}
+
 template <class T> void ResourceCache::GetResources(Vector<T*>& result) const
 {
     Vector<Resource*>& resources = reinterpret_cast<Vector<Resource*>&>(result);
@@ -0,0 +1,279 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../Precompiled.h"
+
+#include "../Core/Timer.h"
+#include "../IO/Deserializer.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Serializer.h"
+#include "../Resource/ResourceIndex.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Return the index key for a relative path. File names are case-insensitive on Windows.
+static String GetIndexKey(const String& name)
+{
+#ifdef _WIN32
+    return name.ToLower();
+#else
+    return name;
+#endif
+}
+
+/// Return whether a scanned directory name is the current or parent directory entry.
+static bool IsDotEntry(const String& name)
+{
+    return name == "." || name == ".." || name.EndsWith("/.") || name.EndsWith("/..");
+}
+
+void ResourceIndex::AddDir(FileSystem* fileSystem, const String& dir)
+{
+    DirIndex& index = dirs_[dir];
+    index.files_.Clear();
+    index.subDirs_.Clear();
+    AddSubDir(fileSystem, index, dir, String::EMPTY);
+}
+
+void ResourceIndex::RemoveDir(const String& dir)
+{
+    dirs_.Erase(dir);
+}
+
+void ResourceIndex::UpdateFile(FileSystem* fileSystem, const String& dir, const String& name)
+{
+    HashMap<String, DirIndex>::Iterator i = dirs_.Find(dir);
+    if (i == dirs_.End())
+        return;
+
+    DirIndex& index = i->second_;
+    String key = GetIndexKey(name);
+    String fullName = dir + name;
+
+    if (fileSystem->FileExists(fullName))
+        index.files_.Insert(key);
+    else
+    {
+        index.files_.Erase(key);
+        RemoveSubDir(index, key + "/");
+        if (fileSystem->DirExists(fullName))
+            AddSubDir(fileSystem, index, dir, key + "/");
+    }
+
+    // Keep the parent's modification time current so that a saved index does not rescan it needlessly
+    String parentKey = GetPath(key);
+    HashMap<String, unsigned>::Iterator j = index.subDirs_.Find(parentKey);
+    if (j != index.subDirs_.End())
+        j->second_ = fileSystem->GetLastModifiedTime(dir + parentKey);
+}
+
+bool ResourceIndex::Save(Serializer& dest) const
+{
+    if (!dest.WriteFileID("RIDX"))
+        return false;
+
+    // Modification times have a resolution of one second, so the save time is needed to find the directories that
+    // may have changed after saving without their modification time changing
+    dest.WriteU32(Time::GetTimeSinceEpoch());
+    dest.WriteVLE(dirs_.Size());
+    for (HashMap<String, DirIndex>::ConstIterator i = dirs_.Begin(); i != dirs_.End(); ++i)
+    {
+        dest.WriteString(i->first_);
+
+        const DirIndex& index = i->second_;
+        dest.WriteVLE(index.subDirs_.Size());
+        for (HashMap<String, unsigned>::ConstIterator j = index.subDirs_.Begin(); j != index.subDirs_.End(); ++j)
+        {
+            dest.WriteString(j->first_);
+            dest.WriteU32(j->second_);
+        }
+
+        dest.WriteVLE(index.files_.Size());
+        for (const String& file : index.files_)
+            dest.WriteString(file);
+
+        // Total entry count, checked after loading to reject truncated or corrupt data
+        dest.WriteU32(index.subDirs_.Size() + index.files_.Size());
+    }
+
+    return true;
+}
+
+bool ResourceIndex::Load(Deserializer& source, FileSystem* fileSystem, const Vector<String>& resourceDirs)
+{
+    if (source.ReadFileID() != "RIDX")
+        return false;
+
+    dirs_.Clear();
+
+    unsigned saveTime = source.ReadU32();
+    if (source.IsEof())
+        return false;
+
+    // Each entry takes at least one byte, so larger counts mean a truncated or corrupt stream
+    unsigned numDirs = source.ReadVLE();
+    if (numDirs > source.GetSize() - source.GetPosition())
+    {
+        dirs_.Clear();
+        return false;
+    }
+
+    for (unsigned i = 0; i < numDirs; ++i)
+    {
+        String dir = source.ReadString();
+        // Read into a scratch index if the directory is no longer used
+        DirIndex unused;
+        DirIndex& index = resourceDirs.Contains(dir) ? dirs_[dir] : unused;
+
+        unsigned numSubDirs = source.ReadVLE();
+        unsigned numFiles = 0;
+        if (numSubDirs <= source.GetSize() - source.GetPosition())
+        {
+            for (unsigned j = 0; j < numSubDirs; ++j)
+            {
+                String subDir = source.ReadString();
+                index.subDirs_[subDir] = source.ReadU32();
+            }
+
+            numFiles = source.ReadVLE();
+            if (numFiles <= source.GetSize() - source.GetPosition())
+            {
+                for (unsigned j = 0; j < numFiles; ++j)
+                    index.files_.Insert(source.ReadString());
+            }
+        }
+
+        // A short read leaves fewer entries than the saved count
+        u32 numEntries;
+        if (source.Read(&numEntries, sizeof numEntries) != sizeof numEntries || numEntries != numSubDirs + numFiles ||
+            index.subDirs_.Size() != numSubDirs || index.files_.Size() != numFiles)
+        {
+            dirs_.Clear();
+            return false;
+        }
+    }
+
+    // Validate with one stat() per directory. Adding, removing or renaming an entry updates its parent's modification
+    // time. A directory modified during the second of saving may have changed afterwards within the same second, so
+    // rescan those too
+    for (const String& dir : resourceDirs)
+    {
+        HashMap<String, DirIndex>::Iterator i = dirs_.Find(dir);
+        if (i == dirs_.End())
+        {
+            AddDir(fileSystem, dir);
+            continue;
+        }
+
+        DirIndex& index = i->second_;
+        Vector<String> changedSubDirs;
+        for (HashMap<String, unsigned>::ConstIterator j = index.subDirs_.Begin(); j != index.subDirs_.End(); ++j)
+        {
+            if (fileSystem->GetLastModifiedTime(dir + j->first_) != j->second_ || j->second_ + 1 >= saveTime)
+                changedSubDirs.Push(j->first_);
+        }
+
+        for (const String& subDir : changedSubDirs)
+        {
+            // May have been removed already along with its parent
+            if (!index.subDirs_.Contains(subDir))
+                continue;
+
+            if (fileSystem->DirExists(dir + subDir))
+                RescanSubDir(fileSystem, index, dir, subDir);
+            else
+                RemoveSubDir(index, subDir);
+        }
+    }
+
+    return true;
+}
+
+bool ResourceIndex::Contains(const String& dir, const String& name) const
+{
+    HashMap<String, DirIndex>::ConstIterator i = dirs_.Find(dir);
+    return i != dirs_.End() && i->second_.files_.Contains(GetIndexKey(name));
+}
+
+i32 ResourceIndex::GetNumFiles() const
+{
+    i32 numFiles = 0;
+    for (HashMap<String, DirIndex>::ConstIterator i = dirs_.Begin(); i != dirs_.End(); ++i)
+        numFiles += i->second_.files_.Size();
+    return numFiles;
+}
+
+void ResourceIndex::AddSubDir(FileSystem* fileSystem, DirIndex& index, const String& dir, const String& subDir)
+{
+    // Hidden files can be opened by name, so index them too
+    Vector<String> names;
+    fileSystem->ScanDir(names, dir + subDir, "*", SCAN_FILES | SCAN_HIDDEN, true);
+    for (const String& name : names)
+        index.files_.Insert(GetIndexKey(subDir + name));
+
+    fileSystem->ScanDir(names, dir + subDir, "*", SCAN_DIRS | SCAN_HIDDEN, true);
+    index.subDirs_[subDir] = fileSystem->GetLastModifiedTime(dir + subDir);
+    for (const String& name : names)
+    {
+        if (!IsDotEntry(name))
+        {
+            String key = GetIndexKey(subDir + name) + "/";
+            index.subDirs_[key] = fileSystem->GetLastModifiedTime(dir + key);
+        }
+    }
+}
+
+void ResourceIndex::RemoveSubDir(DirIndex& index, const String& subDir)
+{
+    if (!index.subDirs_.Contains(subDir))
+        return;
+
+    for (HashSet<String>::Iterator i = index.files_.Begin(); i != index.files_.End();)
+    {
+        if (i->StartsWith(subDir))
+            i = index.files_.Erase(i);
+        else
+            ++i;
+    }
+
+    for (HashMap<String, unsigned>::Iterator i = index.subDirs_.Begin(); i != index.subDirs_.End();)
+    {
+        if (i->first_.StartsWith(subDir))
+            i = index.subDirs_.Erase(i);
+        else
+            ++i;
+    }
+}
+
+void ResourceIndex::RescanSubDir(FileSystem* fileSystem, DirIndex& index, const String& dir, const String& subDir)
+{
+    // Forget the files directly in the directory, then add back what is there now
+    for (HashSet<String>::Iterator i = index.files_.Begin(); i != index.files_.End();)
+    {
+        if (GetPath(*i) == subDir)
+            i = index.files_.Erase(i);
+        else
+            ++i;
+    }
+
+    Vector<String> names;
+    fileSystem->ScanDir(names, dir + subDir, "*", SCAN_FILES | SCAN_HIDDEN, false);
+    for (const String& name : names)
+        index.files_.Insert(GetIndexKey(subDir + name));
+
+    // Subdirectories not seen before are scanned whole. Removed ones are noticed through their own modification time
+    fileSystem->ScanDir(names, dir + subDir, "*", SCAN_DIRS | SCAN_HIDDEN, false);
+    for (const String& name : names)
+    {
+        String key = GetIndexKey(subDir + name) + "/";
+        if (!IsDotEntry(name) && !index.subDirs_.Contains(key))
+            AddSubDir(fileSystem, index, dir, key);
+    }
+
+    index.subDirs_[subDir] = fileSystem->GetLastModifiedTime(dir + subDir);
+}
+
+}
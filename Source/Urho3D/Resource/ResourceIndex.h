@@ -0,0 +1,66 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Container/HashSet.h"
+#include "../Container/Str.h"
+
+namespace Urho3D
+{
+
+class Deserializer;
+class FileSystem;
+class Serializer;
+
+/// Index of the files in resource directories, so that finding a resource file does not need file system calls.
+/// @nobind
+class URHO3D_API ResourceIndex
+{
+public:
+    /// Construct empty.
+    ResourceIndex() = default;
+
+    /// Scan a resource directory into the index. The directory must be an absolute path with a trailing slash.
+    void AddDir(FileSystem* fileSystem, const String& dir);
+    /// Remove a resource directory from the index.
+    void RemoveDir(const String& dir);
+    /// Update the index after a file or directory inside a resource directory was added, changed or removed.
+    void UpdateFile(FileSystem* fileSystem, const String& dir, const String& name);
+    /// Clear the index.
+    void Clear() { dirs_.Clear(); }
+    /// Save to a stream. Return true if successful.
+    bool Save(Serializer& dest) const;
+    /// Load from a stream, keeping only the given resource directories. Directories modified since saving, or within a second of saving, are rescanned, and directories missing from the stream are scanned. Return true if successful.
+    bool Load(Deserializer& source, FileSystem* fileSystem, const Vector<String>& resourceDirs);
+
+    /// Return whether a resource directory is indexed.
+    bool IsIndexed(const String& dir) const { return dirs_.Contains(dir); }
+    /// Return whether an indexed resource directory contains a file.
+    bool Contains(const String& dir, const String& name) const;
+    /// Return total number of indexed files.
+    i32 GetNumFiles() const;
+
+private:
+    /// Indexed resource directory.
+    struct DirIndex
+    {
+        /// Relative paths of all files.
+        HashSet<String> files_;
+        /// Relative paths of all subdirectories with a trailing slash, including the empty root, and their last modified times.
+        HashMap<String, unsigned> subDirs_;
+    };
+
+    /// Scan a subdirectory tree into a directory index.
+    void AddSubDir(FileSystem* fileSystem, DirIndex& index, const String& dir, const String& subDir);
+    /// Remove a subdirectory tree from a directory index.
+    void RemoveSubDir(DirIndex& index, const String& subDir);
+    /// Rescan the entries directly in a subdirectory.
+    void RescanSubDir(FileSystem* fileSystem, DirIndex& index, const String& dir, const String& subDir);
+
+    /// Indexed resource directories.
+    HashMap<String, DirIndex> dirs_;
+};
+
+}
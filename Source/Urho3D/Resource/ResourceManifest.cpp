@@ -0,0 +1,165 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
+#include "../Resource/ResourceManifest.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Return whether a recorded resource belongs to the load.
+static bool IsNeeded(const ResourceLoadRecord& record)
+{
+    return record.requested_ && record.success_ && record.finishedUSec_ >= 0;
+}
+
+/// Compare manifest entries for prefetching.
+static bool CompareEntries(const ResourceManifestEntry& lhs, const ResourceManifestEntry& rhs)
+{
+    if (lhs.depth_ != rhs.depth_)
+        return lhs.depth_ > rhs.depth_;
+    if (lhs.size_ != rhs.size_)
+        return lhs.size_ > rhs.size_;
+    return lhs.name_ < rhs.name_;
+}
+
+String ResourceLoadReport::ToString() const
+{
+    String ret;
+    ret.AppendWithFormat("%d resources (%u KB) in %d ms, critical path %d ms", numResources_, (unsigned)(totalSize_ / 1024),
+        (int)(totalUSec_ / 1000), (int)(criticalPathUSec_ / 1000));
+
+    for (i32 i = 0; i < criticalPath_.Size(); ++i)
+        ret += (i ? " -> " : ": ") + criticalPath_[i];
+
+    return ret;
+}
+
+void ResourceManifest::SetRecords(const Vector<ResourceLoadRecord>& records)
+{
+    resources_.Clear();
+
+    for (const ResourceLoadRecord& record : records)
+    {
+        if (!IsNeeded(record))
+            continue;
+
+        ResourceManifestEntry entry;
+        entry.type_ = record.type_;
+        entry.name_ = record.name_;
+        entry.size_ = record.size_;
+        entry.depth_ = record.depth_;
+        resources_.Push(entry);
+    }
+
+    Sort();
+}
+
+void ResourceManifest::Sort()
+{
+    Urho3D::Sort(resources_.Begin(), resources_.End(), CompareEntries);
+}
+
+bool ResourceManifest::Save(Serializer& dest) const
+{
+    if (!dest.WriteFileID("UPRE"))
+        return false;
+
+    dest.WriteVLE(resources_.Size());
+    for (const ResourceManifestEntry& entry : resources_)
+    {
+        dest.WriteStringHash(entry.type_);
+        dest.WriteString(entry.name_);
+        dest.WriteU32(entry.size_);
+        dest.WriteVLE(entry.depth_);
+    }
+
+    return true;
+}
+
+bool ResourceManifest::Load(Deserializer& source)
+{
+    resources_.Clear();
+
+    if (source.ReadFileID() != "UPRE" || source.IsEof())
+        return false;
+
+    unsigned numResources = source.ReadVLE();
+    for (unsigned i = 0; i < numResources; ++i)
+    {
+        ResourceManifestEntry entry;
+        entry.type_ = source.ReadStringHash();
+        entry.name_ = source.ReadString();
+
+        // A short read means a truncated stream. The depth takes at least one more byte
+        if (source.Read(&entry.size_, sizeof entry.size_) != sizeof entry.size_ || source.IsEof())
+        {
+            resources_.Clear();
+            return false;
+        }
+
+        entry.depth_ = source.ReadVLE();
+        resources_.Push(entry);
+    }
+
+    return true;
+}
+
+unsigned long long ResourceManifest::GetTotalSize() const
+{
+    unsigned long long totalSize = 0;
+    for (const ResourceManifestEntry& entry : resources_)
+        totalSize += entry.size_;
+    return totalSize;
+}
+
+ResourceLoadReport CreateResourceLoadReport(const Vector<ResourceLoadRecord>& records)
+{
+    ResourceLoadReport report;
+
+    i32 last = -1;
+    for (i32 i = 0; i < records.Size(); ++i)
+    {
+        const ResourceLoadRecord& record = records[i];
+        if (!IsNeeded(record))
+            continue;
+
+        ++report.numResources_;
+        report.totalSize_ += record.size_;
+        if (last < 0 || record.finishedUSec_ > records[last].finishedUSec_)
+            last = i;
+    }
+
+    if (last < 0)
+        return report;
+
+    report.totalUSec_ = records[last].finishedUSec_;
+    report.criticalPathUSec_ = records[last].finishedUSec_ - records[last].queuedUSec_;
+
+    // A resource finishes only after its dependencies have loaded, so follow the dependency that loaded last for as long as it
+    // loaded after the resource itself
+    for (i32 current = last; current >= 0 && report.criticalPath_.Size() < records.Size();)
+    {
+        report.criticalPath_.Push(records[current].name_);
+
+        i32 next = -1;
+        for (i32 i = 0; i < records.Size(); ++i)
+        {
+            if (records[i].parent_ == current && IsNeeded(records[i]) &&
+                (next < 0 || records[i].loadedUSec_ > records[next].loadedUSec_))
+                next = i;
+        }
+
+        current = next >= 0 && records[next].loadedUSec_ > records[current].loadedUSec_ ? next : -1;
+    }
+
+    return report;
+}
+
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2008-2022 the Urho3D project
+// License: MIT
+
+#pragma once
+
+#include "../Container/Str.h"
+#include "../Container/Vector.h"
+#include "../Math/StringHash.h"
+
+namespace Urho3D
+{
+
+class Deserializer;
+class Serializer;
+
+/// Background load of a resource recorded by the resource cache.
+/// @nobind
+struct ResourceLoadRecord
+{
+    /// Resource type.
+    StringHash type_;
+    /// Resource name.
+    String name_;
+    /// Index of the first resource that requested this as a dependency, or -1 if none did.
+    i32 parent_{-1};
+    /// Dependency depth. 0 if no resource depends on this, 1 for the dependencies of those and so on.
+    i32 depth_{};
+    /// File size in bytes.
+    u32 size_{};
+    /// Time queued in microseconds since recording started.
+    long long queuedUSec_{-1};
+    /// Time the background thread finished loading, or -1 if not reached.
+    long long loadedUSec_{-1};
+    /// Time finished in the main thread, or -1 if not reached.
+    long long finishedUSec_{-1};
+    /// Whether requested other than by prefetching. Resources only prefetched are not needed anymore.
+    bool requested_{};
+    /// Whether loading succeeded.
+    bool success_{};
+};
+
+/// Report of recorded background loads.
+/// @nobind
+struct ResourceLoadReport
+{
+    /// Number of resources loaded.
+    i32 numResources_{};
+    /// Total file size in bytes.
+    unsigned long long totalSize_{};
+    /// Time from starting recording until the last resource finished in microseconds.
+    long long totalUSec_{};
+    /// Time from queuing the resource that finished last until it finished in microseconds.
+    long long criticalPathUSec_{};
+    /// Resources along the critical path, from the resource that finished last down through the dependencies that held it up.
+    Vector<String> criticalPath_;
+
+    /// Return as a human-readable string.
+    String ToString() const;
+};
+
+/// Resource in a preload manifest.
+/// @nobind
+struct ResourceManifestEntry
+{
+    /// Resource type.
+    StringHash type_;
+    /// Resource name.
+    String name_;
+    /// File size in bytes.
+    u32 size_{};
+    /// Dependency depth.
+    i32 depth_{};
+};
+
+/// Resource dependency closure recorded during a load, so that the next load can queue all of it at once instead of discovering dependencies as their parents load.
+/// @nobind
+class URHO3D_API ResourceManifest
+{
+public:
+    /// Construct empty.
+    ResourceManifest() = default;
+
+    /// Set from recorded background loads, keeping the resources that were requested and loaded successfully. Sorts for prefetching.
+    void SetRecords(const Vector<ResourceLoadRecord>& records);
+    /// Sort for prefetching. Deepest dependencies first, as the resources depending on them wait for them, and largest first within a depth.
+    void Sort();
+    /// Clear.
+    void Clear() { resources_.Clear(); }
+    /// Save to a stream. Return true if successful.
+    bool Save(Serializer& dest) const;
+    /// Load from a stream. Return true if successful.
+    bool Load(Deserializer& source);
+
+    /// Return resources.
+    const Vector<ResourceManifestEntry>& GetResources() const { return resources_; }
+    /// Return total file size in bytes.
+    unsigned long long GetTotalSize() const;
+
+private:
+    /// Resources.
+    Vector<ResourceManifestEntry> resources_;
+};
+
+/// Create a report of recorded background loads, considering the resources that were requested.
+URHO3D_API ResourceLoadReport CreateResourceLoadReport(const Vector<ResourceLoadRecord>& records);
+
+}
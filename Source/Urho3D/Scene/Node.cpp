@@ -2095,8 +2095,9 @@ void Node::RemoveChild(Vector<SharedPtr<Node>>::Iterator i)
     // erase and a crash
     SharedPtr<Node> child(*i);
 
-    // Send change event. Do not send when this node is already being destroyed
-    if (Refs() > 0 && scene_)
+    // Send change event. Do not send when this node is already being destroyed, or when the scene is being unloaded
+    bool unloading = scene_ && scene_->IsUnloading();
+    if (Refs() > 0 && scene_ && !unloading)
     {
         using namespace NodeRemoved;
 
@@ -2109,8 +2110,11 @@ void Node::RemoveChild(Vector<SharedPtr<Node>>::Iterator i)
     }
 
     child->parent_ = nullptr;
-    child->MarkDirty();
-    child->MarkNetworkUpdate();
+    if (!unloading)
+    {
+        child->MarkDirty();
+        child->MarkNetworkUpdate();
+    }
     if (scene_)
         scene_->NodeRemoved(child);
 
@@ -2223,8 +2227,8 @@ Node* Node::CloneRecursive(Node* parent, SceneResolver& resolver, CreateMode mod
 
 void Node::RemoveComponent(Vector<SharedPtr<Component>>::Iterator i)
 {
-    // Send node change event. Do not send when already being destroyed
-    if (Refs() > 0 && scene_)
+    // Send node change event. Do not send when already being destroyed, or when the scene is being unloaded
+    if (Refs() > 0 && scene_ && !scene_->IsUnloading())
     {
         using namespace ComponentRemoved;
 
@@ -5,11 +5,17 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/FrameScheduler.h"
 #include "../Core/Profiler.h"
 #include "../Core/WorkQueue.h"
 #include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/PackageFile.h"
+#ifdef URHO3D_NETWORK
+#include "../Network/Connection.h"
+#include "../Network/Network.h"
+#endif
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Resource/XMLFile.h"
@@ -72,6 +78,11 @@ Scene::~Scene()
         i->second_->ResetScene();
     for (HashMap<NodeId, Node*>::Iterator i = localNodes_.Begin(); i != localNodes_.End(); ++i)
         i->second_->ResetScene();
+
+    // Stop recording a preload manifest if destroyed while loading
+    auto* cache = GetSubsystem<ResourceCache>();
+    if (!preloadManifestFileName_.Empty() && cache)
+        cache->StopLoadRecording();
 }
 
 void Scene::RegisterObject(Context* context)
@@ -318,11 +329,15 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
     }
 
     asyncLoading_ = true;
+    StartAsyncLoadingTask();
     asyncProgress_.file_ = file;
     asyncProgress_.mode_ = mode;
     asyncProgress_.loadedNodes_ = asyncProgress_.totalNodes_ = asyncProgress_.loadedResources_ = asyncProgress_.totalResources_ = 0;
     asyncProgress_.resources_.Clear();
 
+    if (mode != LOAD_SCENE)
+        StartPreloadManifest(file);
+
     if (mode > LOAD_RESOURCES_ONLY)
     {
         // Preload resources if appropriate, then return to the original position for loading the scene content
@@ -381,12 +396,16 @@ bool Scene::LoadAsyncXML(File* file, LoadMode mode)
     }
 
     asyncLoading_ = true;
+    StartAsyncLoadingTask();
     asyncProgress_.xmlFile_ = xml;
     asyncProgress_.file_ = file;
     asyncProgress_.mode_ = mode;
     asyncProgress_.loadedNodes_ = asyncProgress_.totalNodes_ = asyncProgress_.loadedResources_ = asyncProgress_.totalResources_ = 0;
     asyncProgress_.resources_.Clear();
 
+    if (mode != LOAD_SCENE)
+        StartPreloadManifest(file);
+
     if (mode > LOAD_RESOURCES_ONLY)
     {
         XMLElement rootElement = xml->GetRoot();
@@ -450,12 +469,16 @@ bool Scene::LoadAsyncJSON(File* file, LoadMode mode)
     }
 
     asyncLoading_ = true;
+    StartAsyncLoadingTask();
     asyncProgress_.jsonFile_ = json;
     asyncProgress_.file_ = file;
     asyncProgress_.mode_ = mode;
     asyncProgress_.loadedNodes_ = asyncProgress_.totalNodes_ = asyncProgress_.loadedResources_ = asyncProgress_.totalResources_ = 0;
     asyncProgress_.resources_.Clear();
 
+    if (mode != LOAD_SCENE)
+        StartPreloadManifest(file);
+
     if (mode > LOAD_RESOURCES_ONLY)
     {
         JSONValue rootVal = json->GetRoot();
@@ -496,6 +519,14 @@ bool Scene::LoadAsyncJSON(File* file, LoadMode mode)
 
 void Scene::StopAsyncLoading()
 {
+    if (asyncLoadingTask_)
+    {
+        auto* frameScheduler = GetSubsystem<FrameScheduler>();
+        if (frameScheduler)
+            frameScheduler->RemoveTask(asyncLoadingTask_);
+        asyncLoadingTask_ = 0;
+    }
+
     asyncLoading_ = false;
     asyncProgress_.file_.Reset();
     asyncProgress_.xmlFile_.Reset();
@@ -504,6 +535,21 @@ void Scene::StopAsyncLoading()
     asyncProgress_.jsonIndex_ = 0;
     asyncProgress_.resources_.Clear();
     resolver_.Reset();
+
+    // Loading that was stopped does not record a manifest
+    if (!preloadManifestFileName_.Empty())
+    {
+        GetSubsystem<ResourceCache>()->StopLoadRecording();
+        preloadManifestFileName_.Clear();
+    }
+
+    // Loading that was stopped before it finished fails
+    if (asyncLoadOperation_)
+    {
+        SharedPtr<AsyncOperation> operation = asyncLoadOperation_;
+        asyncLoadOperation_.Reset();
+        operation->Complete(false);
+    }
 }
 
 Node* Scene::Instantiate(Deserializer& source, const Vector3& position, const Quaternion& rotation, CreateMode mode)
@@ -648,6 +694,10 @@ void Scene::SetSnapThreshold(float threshold)
 void Scene::SetAsyncLoadingMs(int ms)
 {
     asyncLoadingMs_ = Max(ms, 1);
+
+    auto* frameScheduler = GetSubsystem<FrameScheduler>();
+    if (frameScheduler && asyncLoadingTask_)
+        frameScheduler->SetTaskSlice(asyncLoadingTask_, asyncLoadingMs_);
 }
 
 void Scene::SetElapsedTime(float time)
@@ -655,6 +705,58 @@ void Scene::SetElapsedTime(float time)
     elapsedTime_ = time;
 }
 
+void Scene::Unload()
+{
+    URHO3D_PROFILE(UnloadScene);
+
+    StopAsyncLoading();
+
+    using namespace SceneUnloading;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_SCENE] = this;
+    SendEvent(E_SCENEUNLOADING, eventData);
+
+#ifdef URHO3D_NETWORK
+    // Detach the client connections replicating this scene, so that the removed nodes are not replicated one by one. The
+    // scene is assigned to them again afterward, which tells the clients to clear their replicated content at once
+    Vector<SharedPtr<Connection>> connections;
+    if (auto* network = GetSubsystem<Network>())
+    {
+        for (const SharedPtr<Connection>& connection : network->GetClientConnections())
+        {
+            if (connection->GetScene() == this)
+            {
+                connection->SetScene(nullptr);
+                connections.Push(connection);
+            }
+        }
+    }
+#endif
+
+    unloading_ = true;
+
+    // Drop the tag cache at once instead of removing each node from it, then re-add own tags
+    taggedNodes_.Clear();
+    for (const String& tag : GetTags())
+        NodeTagAdded(this, tag);
+
+    // Remove root-level components first, so that scene subsystems such as the octree, physics world and navigation mesh
+    // destroy themselves and detach their contents wholesale. Removing child nodes' components is then cheap
+    RemoveAllComponents();
+    RemoveAllChildren();
+
+    unloading_ = false;
+
+    // Reset name, variables and ID generators. There is nothing left to remove
+    Clear();
+
+#ifdef URHO3D_NETWORK
+    for (const SharedPtr<Connection>& connection : connections)
+        connection->SetScene(this);
+#endif
+}
+
 void Scene::AddRequiredPackageFile(PackageFile* package)
 {
     // Do not add packages that failed to load
@@ -732,6 +834,20 @@ float Scene::GetAsyncProgress() const
         (float)(asyncProgress_.totalNodes_ + asyncProgress_.totalResources_);
 }
 
+SharedPtr<AsyncOperation> Scene::GetAsyncLoadOperation()
+{
+    if (asyncLoadOperation_)
+        return asyncLoadOperation_;
+
+    SharedPtr<AsyncOperation> operation(new AsyncOperation());
+    if (asyncLoading_)
+        asyncLoadOperation_ = operation;
+    else
+        operation->Complete();
+
+    return operation;
+}
+
 const String& Scene::GetVarName(StringHash hash) const
 {
     HashMap<StringHash, String>::ConstIterator i = varNames_.Find(hash);
@@ -742,7 +858,9 @@ void Scene::Update(float timeStep)
 {
     if (asyncLoading_)
     {
-        UpdateAsyncLoading();
+        // Without the frame scheduler, load here within the per-frame limit
+        if (!asyncLoadingTask_)
+            UpdateAsyncLoading(asyncLoadingMs_ * 1000LL);
         // If only preloading resources, scene update can continue
         if (asyncProgress_.mode_ > LOAD_RESOURCES_ONLY)
             return;
@@ -973,8 +1091,8 @@ void Scene::NodeRemoved(Node* node)
 
     node->ResetScene();
 
-    // Remove node from tag cache
-    if (!node->GetTags().Empty())
+    // Remove node from tag cache. When unloading the whole cache is cleared instead
+    if (!unloading_ && !node->GetTags().Empty())
     {
         const StringVector& tags = node->GetTags();
         for (unsigned i = 0; i < tags.Size(); ++i)
@@ -1166,7 +1284,21 @@ void Scene::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eve
     }
 }
 
-void Scene::UpdateAsyncLoading()
+void Scene::StartAsyncLoadingTask()
+{
+    auto* frameScheduler = GetSubsystem<FrameScheduler>();
+    if (!frameScheduler || asyncLoadingTask_)
+        return;
+
+    asyncLoadingTask_ = frameScheduler->AddTask(this, "AsyncLoadScene", [this](long long maxUSec)
+    {
+        if (asyncLoading_)
+            UpdateAsyncLoading(maxUSec);
+        return asyncLoading_;
+    }, FT_PRIORITY_HIGH, asyncLoadingMs_);
+}
+
+void Scene::UpdateAsyncLoading(long long maxUSec)
 {
     URHO3D_PROFILE(UpdateAsyncLoading);
 
@@ -1216,7 +1348,7 @@ void Scene::UpdateAsyncLoading()
         ++asyncProgress_.loadedNodes_;
 
         // Break if time limit exceeded, so that we keep sufficient FPS
-        if (asyncLoadTimer.GetUSec(false) >= asyncLoadingMs_ * 1000LL)
+        if (asyncLoadTimer.GetUSec(false) >= maxUSec)
             break;
     }
 
@@ -1241,6 +1373,10 @@ void Scene::FinishAsyncLoading()
         FinishLoading(asyncProgress_.file_);
     }
 
+    FinishPreloadManifest();
+
+    SharedPtr<AsyncOperation> operation = asyncLoadOperation_;
+    asyncLoadOperation_.Reset();
     StopAsyncLoading();
 
     using namespace AsyncLoadFinished;
@@ -1248,6 +1384,9 @@ void Scene::FinishAsyncLoading()
     VariantMap& eventData = GetEventDataMap();
     eventData[P_SCENE] = this;
     SendEvent(E_ASYNCLOADFINISHED, eventData);
+
+    if (operation)
+        operation->Complete();
 }
 
 void Scene::FinishLoading(Deserializer* source)
@@ -1311,28 +1450,13 @@ void Scene::PreloadResources(File* file, bool isSceneFile)
                 if (attr.type_ == VAR_RESOURCEREF)
                 {
                     const ResourceRef& ref = varValue.GetResourceRef();
-                    // Sanitate resource name beforehand so that when we get the background load event, the name matches exactly
-                    String name = cache->SanitateResourceName(ref.name_);
-                    bool success = cache->BackgroundLoadResource(ref.type_, name);
-                    if (success)
-                    {
-                        ++asyncProgress_.totalResources_;
-                        asyncProgress_.resources_.Insert(StringHash(name));
-                    }
+                    PreloadResource(cache, ref.type_, ref.name_);
                 }
                 else if (attr.type_ == VAR_RESOURCEREFLIST)
                 {
                     const ResourceRefList& refList = varValue.GetResourceRefList();
                     for (unsigned k = 0; k < refList.names_.Size(); ++k)
-                    {
-                        String name = cache->SanitateResourceName(refList.names_[k]);
-                        bool success = cache->BackgroundLoadResource(refList.type_, name);
-                        if (success)
-                        {
-                            ++asyncProgress_.totalResources_;
-                            asyncProgress_.resources_.Insert(StringHash(name));
-                        }
-                    }
+                        PreloadResource(cache, refList.type_, refList.names_[k]);
                 }
             }
         }
@@ -1376,27 +1500,13 @@ void Scene::PreloadResourcesXML(const XMLElement& element)
                         if (attr.type_ == VAR_RESOURCEREF)
                         {
                             ResourceRef ref = attrElem.GetVariantValue(attr.type_).GetResourceRef();
-                            String name = cache->SanitateResourceName(ref.name_);
-                            bool success = cache->BackgroundLoadResource(ref.type_, name);
-                            if (success)
-                            {
-                                ++asyncProgress_.totalResources_;
-                                asyncProgress_.resources_.Insert(StringHash(name));
-                            }
+                            PreloadResource(cache, ref.type_, ref.name_);
                         }
                         else if (attr.type_ == VAR_RESOURCEREFLIST)
                         {
                             ResourceRefList refList = attrElem.GetVariantValue(attr.type_).GetResourceRefList();
                             for (unsigned k = 0; k < refList.names_.Size(); ++k)
-                            {
-                                String name = cache->SanitateResourceName(refList.names_[k]);
-                                bool success = cache->BackgroundLoadResource(refList.type_, name);
-                                if (success)
-                                {
-                                    ++asyncProgress_.totalResources_;
-                                    asyncProgress_.resources_.Insert(StringHash(name));
-                                }
-                            }
+                                PreloadResource(cache, refList.type_, refList.names_[k]);
                         }
 
                         startIndex = (i + 1) % attributes->Size();
@@ -1425,6 +1535,73 @@ void Scene::PreloadResourcesXML(const XMLElement& element)
 #endif
 }
 
+void Scene::PreloadResource(ResourceCache* cache, StringHash type, const String& name)
+{
+    // Sanitate resource name beforehand so that when we get the background load event, the name matches exactly
+    String sanitatedName = cache->SanitateResourceName(name);
+    StringHash nameHash(sanitatedName);
+    if (asyncProgress_.resources_.Contains(nameHash))
+        return;
+
+    // A resource already queued, for example by prefetching, is waited for the same way
+    if (cache->BackgroundLoadResource(type, sanitatedName) || cache->IsBackgroundLoadQueued(type, sanitatedName))
+    {
+        ++asyncProgress_.totalResources_;
+        asyncProgress_.resources_.Insert(nameHash);
+    }
+}
+
+void Scene::StartPreloadManifest(File* file)
+{
+#ifdef URHO3D_THREADING
+    auto* cache = GetSubsystem<ResourceCache>();
+    // Recording covers all background loads, so only one load can record at a time
+    if (!preloadManifests_ || cache->IsLoadRecording())
+        return;
+
+    String manifestFileName = cache->GetCompiledCacheFileName(file->GetName(), ".upre");
+    if (manifestFileName.Empty())
+        return;
+
+    cache->StartLoadRecording();
+    preloadManifestFileName_ = manifestFileName;
+
+    // Queue the whole dependency closure of the previous load, so that dependencies need not wait for their parents to load
+    // before being discovered
+    if (GetSubsystem<FileSystem>()->FileExists(manifestFileName))
+    {
+        File manifestFile(context_, manifestFileName);
+        ResourceManifest manifest;
+        if (manifest.Load(manifestFile))
+        {
+            i32 numQueued = cache->PrefetchResources(manifest);
+            URHO3D_LOGINFOF("Prefetching %d resources (%u KB) from preload manifest of %s", numQueued,
+                (unsigned)(manifest.GetTotalSize() / 1024), file->GetName().CString());
+        }
+        else
+            URHO3D_LOGWARNING("Invalid preload manifest " + manifestFileName);
+    }
+#endif
+}
+
+void Scene::FinishPreloadManifest()
+{
+    if (preloadManifestFileName_.Empty())
+        return;
+
+    Vector<ResourceLoadRecord> records = GetSubsystem<ResourceCache>()->StopLoadRecording();
+    preloadReport_ = CreateResourceLoadReport(records);
+    URHO3D_LOGINFO("Preloaded " + preloadReport_.ToString());
+
+    ResourceManifest manifest;
+    manifest.SetRecords(records);
+    File manifestFile(context_, preloadManifestFileName_, FILE_WRITE);
+    if (!manifestFile.IsOpen() || !manifest.Save(manifestFile))
+        URHO3D_LOGERROR("Could not save preload manifest " + preloadManifestFileName_);
+
+    preloadManifestFileName_.Clear();
+}
+
 void Scene::PreloadResourcesJSON(const JSONValue& value)
 {
     // If not threaded, can not background load resources, so rather load synchronously later when needed
@@ -1461,27 +1638,13 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
                         if (attr.type_ == VAR_RESOURCEREF)
                         {
                             ResourceRef ref = attrVal.Get("value").GetVariantValue(attr.type_).GetResourceRef();
-                            String name = cache->SanitateResourceName(ref.name_);
-                            bool success = cache->BackgroundLoadResource(ref.type_, name);
-                            if (success)
-                            {
-                                ++asyncProgress_.totalResources_;
-                                asyncProgress_.resources_.Insert(StringHash(name));
-                            }
+                            PreloadResource(cache, ref.type_, ref.name_);
                         }
                         else if (attr.type_ == VAR_RESOURCEREFLIST)
                         {
                             ResourceRefList refList = attrVal.Get("value").GetVariantValue(attr.type_).GetResourceRefList();
                             for (unsigned k = 0; k < refList.names_.Size(); ++k)
-                            {
-                                String name = cache->SanitateResourceName(refList.names_[k]);
-                                bool success = cache->BackgroundLoadResource(refList.type_, name);
-                                if (success)
-                                {
-                                    ++asyncProgress_.totalResources_;
-                                    asyncProgress_.resources_.Insert(StringHash(name));
-                                }
-                            }
+                                PreloadResource(cache, refList.type_, refList.names_[k]);
                         }
 
                         startIndex = (i + 1) % attributes->Size();
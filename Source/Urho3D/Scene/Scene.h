@@ -6,9 +6,11 @@
 #pragma once
 
 #include "../Container/HashSet.h"
+#include "../Core/AsyncOperation.h"
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
+#include "../Resource/ResourceManifest.h"
 #include "../Scene/Node.h"
 #include "../Scene/SceneResolver.h"
 
@@ -17,6 +19,7 @@ namespace Urho3D
 
 class File;
 class PackageFile;
+class ResourceCache;
 
 inline constexpr id32 FIRST_REPLICATED_ID = 0x1;
 inline constexpr id32 LAST_REPLICATED_ID = 0xffffff;
@@ -129,6 +132,8 @@ public:
 
     /// Clear scene completely of either replicated, local or all nodes and components.
     void Clear(bool clearReplicated = true, bool clearLocal = true);
+    /// Clear scene completely in bulk, for unloading a level. Sends E_SCENEUNLOADING once instead of node and component removal events, and destroys scene subsystems such as the octree and physics world first so that their contents are released wholesale. Clients replicating the scene are told to clear it at once instead of receiving a removal for each node. Much faster than Clear() for large scenes.
+    void Unload();
     /// Enable or disable scene update.
     /// @property
     void SetUpdateEnabled(bool enable);
@@ -144,9 +149,12 @@ public:
     /// Set network client motion smoothing snap threshold.
     /// @property
     void SetSnapThreshold(float threshold);
-    /// Set maximum milliseconds per frame to spend on async scene loading.
+    /// Set maximum milliseconds per frame to spend on async scene loading. With the frame scheduler loading uses the time left in the frame instead, and this is the minimum time it gets every frame.
     /// @property
     void SetAsyncLoadingMs(int ms);
+    /// Set whether async loading uses preload manifests. Loading that preloads resources then records every resource it background loads, including dependencies, into a manifest in the resource cache's compiled cache directory, and the next load of the same file prefetches the whole manifest first. Requires a compiled cache directory.
+    /// @property
+    void SetPreloadManifests(bool enable) { preloadManifests_ = enable; }
     /// Add a required package file for networking. To be called on the server.
     void AddRequiredPackageFile(PackageFile* package);
     /// Clear required package files.
@@ -173,6 +181,9 @@ public:
     /// @property
     bool IsAsyncLoading() const { return asyncLoading_; }
 
+    /// Return whether the scene is being unloaded. Node and component removal skips per-object events and bookkeeping then.
+    bool IsUnloading() const { return unloading_; }
+
     /// Return asynchronous loading progress between 0.0 and 1.0, or 1.0 if not in progress.
     /// @property
     float GetAsyncProgress() const;
@@ -181,6 +192,10 @@ public:
     /// @property
     LoadMode GetAsyncLoadMode() const { return asyncProgress_.mode_; }
 
+    /// Return an operation that completes when the asynchronous loading operation finishes, or fails if it is stopped. Completed already if not in progress.
+    /// @nobind
+    SharedPtr<AsyncOperation> GetAsyncLoadOperation();
+
     /// Return source file name.
     /// @property
     const String& GetFileName() const { return fileName_; }
@@ -209,6 +224,14 @@ public:
     /// @property
     int GetAsyncLoadingMs() const { return asyncLoadingMs_; }
 
+    /// Return whether async loading uses preload manifests.
+    /// @property
+    bool GetPreloadManifests() const { return preloadManifests_; }
+
+    /// Return the report of the last async load that recorded a preload manifest.
+    /// @nobind
+    const ResourceLoadReport& GetPreloadReport() const { return preloadReport_; }
+
     /// Return required package files.
     /// @property
     const Vector<SharedPtr<PackageFile>>& GetRequiredPackageFiles() const { return requiredPackageFiles_; }
@@ -269,8 +292,10 @@ private:
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
     /// Handle a background loaded resource completing.
     void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
-    /// Update asynchronous loading.
-    void UpdateAsyncLoading();
+    /// Start updating asynchronous loading from the frame scheduler, if it exists.
+    void StartAsyncLoadingTask();
+    /// Update asynchronous loading within a time limit in microseconds.
+    void UpdateAsyncLoading(long long maxUSec);
     /// Finish asynchronous loading.
     void FinishAsyncLoading();
     /// Finish loading. Sets the scene filename and checksum.
@@ -283,6 +308,12 @@ private:
     void PreloadResourcesXML(const XMLElement& element);
     /// Preload resources from a JSON scene or object prefab file.
     void PreloadResourcesJSON(const JSONValue& value);
+    /// Queue a resource for preloading and wait for it during async loading.
+    void PreloadResource(ResourceCache* cache, StringHash type, const String& name);
+    /// Prefetch the preload manifest of a file and start recording a new one, if enabled.
+    void StartPreloadManifest(File* file);
+    /// Stop recording the preload manifest and save it.
+    void FinishPreloadManifest();
 
     /// Replicated scene nodes by ID.
     HashMap<NodeId, Node*> replicatedNodes_;
@@ -326,6 +357,14 @@ private:
     mutable hash32 checksum_;
     /// Maximum milliseconds per frame to spend on async scene loading.
     int asyncLoadingMs_;
+    /// Frame scheduler task for async loading, or 0 if not loading or there is no frame scheduler.
+    u32 asyncLoadingTask_{};
+    /// Operation waiting for async loading to finish, or null if none requested.
+    SharedPtr<AsyncOperation> asyncLoadOperation_;
+    /// Preload manifest file being recorded, or empty if not recording.
+    String preloadManifestFileName_;
+    /// Report of the last load that recorded a preload manifest.
+    ResourceLoadReport preloadReport_;
     /// Scene update time scale.
     float timeScale_;
     /// Elapsed time accumulator.
@@ -340,6 +379,10 @@ private:
     bool asyncLoading_;
     /// Threaded update flag.
     bool threadedUpdate_;
+    /// Unloading flag.
+    bool unloading_{};
+    /// Preload manifests flag.
+    bool preloadManifests_{};
 };
 
 /// Register Scene library objects.
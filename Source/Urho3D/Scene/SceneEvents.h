@@ -123,6 +123,12 @@ URHO3D_EVENT(E_COMPONENTREMOVED, ComponentRemoved)
     URHO3D_PARAM(P_COMPONENT, Component);          // Component pointer
 }
 
+/// A scene is about to remove all its nodes and components with Scene::Unload(). Node and component removal events will not be sent.
+URHO3D_EVENT(E_SCENEUNLOADING, SceneUnloading)
+{
+    URHO3D_PARAM(P_SCENE, Scene);                  // Scene pointer
+}
+
 /// A node's name has changed.
 URHO3D_EVENT(E_NODENAMECHANGED, NodeNameChanged)
 {
@@ -301,6 +301,8 @@ void UI::Update(float timeStep)
 
     URHO3D_PROFILE(UpdateUI);
 
+    UpdateDirtyLayouts();
+
     // Expire hovers
     for (HashMap<WeakPtr<UIElement>, bool>::Iterator i = hoveredElements_.Begin(); i != hoveredElements_.End(); ++i)
         i->second_ = false;
@@ -941,6 +943,29 @@ void UI::Initialize()
     URHO3D_LOGINFO("Initialized user interface");
 }
 
+void UI::QueueLayoutUpdate(UIElement* root)
+{
+    dirtyLayoutRoots_.Push(WeakPtr<UIElement>(root));
+}
+
+void UI::UpdateDirtyLayouts()
+{
+    if (dirtyLayoutRoots_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateDirtyLayouts);
+
+    // Updating may queue the roots again, which are then handled next frame
+    Vector<WeakPtr<UIElement>> roots;
+    roots.Swap(dirtyLayoutRoots_);
+    for (const WeakPtr<UIElement>& root : roots)
+    {
+        SharedPtr<UIElement> element = root.Lock();
+        if (element)
+            element->UpdateDirtyLayouts();
+    }
+}
+
 void UI::Update(float timeStep, UIElement* element)
 {
     // Keep a weak pointer to the element in case it destroys itself on update
@@ -248,6 +248,8 @@ public:
 
     /// Set texture to which element will be rendered.
     void SetElementRenderTexture(UIElement* element, Texture2D* texture);
+    /// Queue the root of an element hierarchy with layout updates requested while they were disabled, so that they are done once at the next UI update. Called by UIElement.
+    void QueueLayoutUpdate(UIElement* root);
 
     /// Data structure used to represent the drag data associated to a UIElement.
     struct DragData
@@ -292,6 +294,8 @@ private:
     void Initialize();
     /// Update UI element logic recursively.
     void Update(float timeStep, UIElement* element);
+    /// Update the layouts that were deferred while layout updates were disabled.
+    void UpdateDirtyLayouts();
     /// Upload UI geometry into a vertex buffer.
     void SetVertexData(VertexBuffer* dest, const Vector<float>& vertexData);
     /// Render UI batches to the current rendertarget. Geometry must have been uploaded first.
@@ -454,6 +458,8 @@ private:
     int dragConfirmedCount_;
     /// UI elements that are being touched with touch input.
     HashMap<WeakPtr<UIElement>, MouseButtonFlags> touchDragElements_;
+    /// Roots of the element hierarchies with deferred layout updates.
+    Vector<WeakPtr<UIElement>> dirtyLayoutRoots_;
     /// Confirmed drag elements cache.
     Vector<UIElement*> dragElementsConfirmed_;
     /// Current scale of UI.
@@ -156,6 +156,9 @@ bool UIElement::LoadXML(const XMLElement& source)
 
 bool UIElement::LoadXML(const XMLElement& source, XMLFile* styleFile)
 {
+    // Prevent updates while applying the style and loading attributes
+    DisableLayoutUpdate();
+
     // Get style override if defined
     String styleName = source.GetAttribute("style");
 
@@ -183,12 +186,12 @@ bool UIElement::LoadXML(const XMLElement& source, XMLFile* styleFile)
         }
     }
 
-    // Prevent updates while loading attributes
-    DisableLayoutUpdate();
-
     // Then load rest of the attributes from the source
     if (!Animatable::LoadXML(source))
+    {
+        EnableLayoutUpdate();
         return false;
+    }
 
     i32 nextInternalChild = 0;
 
@@ -228,7 +231,10 @@ bool UIElement::LoadXML(const XMLElement& source, XMLFile* styleFile)
             if (!styleFile)
                 styleFile = GetDefaultStyle();
             if (!child->LoadXML(childElem, styleFile))
+            {
+                EnableLayoutUpdate();
                 return false;
+            }
         }
 
         childElem = childElem.GetNext("element");
@@ -1077,102 +1083,23 @@ void UIElement::SetIndentSpacing(int indentSpacing)
 void UIElement::UpdateLayout()
 {
     if (layoutNestingLevel_)
-        return;
-
-    // Prevent further updates while this update happens
-    DisableLayoutUpdate();
-
-    Vector<int> positions;
-    Vector<int> sizes;
-    Vector<int> minSizes;
-    Vector<int> maxSizes;
-    Vector<float> flexScales;
-
-    int baseIndentWidth = GetIndentWidth();
-
-    if (layoutMode_ == LM_HORIZONTAL)
     {
-        int minChildHeight = 0;
-
-        for (const SharedPtr<UIElement>& child : children_)
-        {
-            if (!child->IsVisible())
-                continue;
-
-            positions.Push(baseIndentWidth);
-            i32 indent = child->GetIndentWidth();
-            sizes.Push(child->GetWidth() + indent);
-            minSizes.Push(child->GetEffectiveMinSize().x_ + indent);
-            maxSizes.Push(child->GetMaxWidth() + indent);
-            flexScales.Push(child->GetLayoutFlexScale().x_);
-            minChildHeight = Max(minChildHeight, child->GetEffectiveMinSize().y_);
-        }
-
-        CalculateLayout(positions, sizes, minSizes, maxSizes, flexScales, GetWidth(), layoutBorder_.left_, layoutBorder_.right_,
-            layoutSpacing_);
-
-        int width = CalculateLayoutParentSize(sizes, layoutBorder_.left_, layoutBorder_.right_, layoutSpacing_);
-        int height = Max(GetHeight(), minChildHeight + layoutBorder_.top_ + layoutBorder_.bottom_);
-        int minWidth = CalculateLayoutParentSize(minSizes, layoutBorder_.left_, layoutBorder_.right_, layoutSpacing_);
-        int minHeight = minChildHeight + layoutBorder_.top_ + layoutBorder_.bottom_;
-        layoutMinSize_ = IntVector2(minWidth, minHeight);
-        SetSize(width, height);
-        // Validate the size before resizing child elements, in case of min/max limits
-        width = size_.x_;
-        height = size_.y_;
-
-        i32 j = 0;
-        for (const SharedPtr<UIElement>& child : children_)
+        // Requests from children resized by this update itself are redundant. Otherwise the updates were disabled
+        // from outside, so remember to update once at the next UI update in case nobody does it explicitly
+        if (!updatingLayout_)
         {
-            if (!child->IsVisible())
-                continue;
-
-            child->SetPosition(positions[j], GetLayoutChildPosition(child).y_);
-            child->SetSize(sizes[j], height - layoutBorder_.top_ - layoutBorder_.bottom_);
-            ++j;
+            layoutDirty_ = true;
+            MarkLayoutPathDirty();
         }
+        return;
     }
-    else if (layoutMode_ == LM_VERTICAL)
-    {
-        int minChildWidth = 0;
-
-        for (const SharedPtr<UIElement>& child : children_)
-        {
-            if (!child->IsVisible())
-                continue;
 
-            positions.Push(0);
-            sizes.Push(child->GetHeight());
-            minSizes.Push(child->GetEffectiveMinSize().y_);
-            maxSizes.Push(child->GetMaxHeight());
-            flexScales.Push(child->GetLayoutFlexScale().y_);
-            minChildWidth = Max(minChildWidth, child->GetEffectiveMinSize().x_ + child->GetIndentWidth());
-        }
-
-        CalculateLayout(positions, sizes, minSizes, maxSizes, flexScales, GetHeight(), layoutBorder_.top_, layoutBorder_.bottom_,
-            layoutSpacing_);
-
-        int height = CalculateLayoutParentSize(sizes, layoutBorder_.top_, layoutBorder_.bottom_, layoutSpacing_);
-        int width = Max(GetWidth(), minChildWidth + layoutBorder_.left_ + layoutBorder_.right_);
-        int minHeight = CalculateLayoutParentSize(minSizes, layoutBorder_.top_, layoutBorder_.bottom_, layoutSpacing_);
-        int minWidth = minChildWidth + layoutBorder_.left_ + layoutBorder_.right_;
-        layoutMinSize_ = IntVector2(minWidth, minHeight);
-        SetSize(width, height);
-        width = size_.x_;
-        height = size_.y_;
-
-        i32 j = 0;
-        for (const SharedPtr<UIElement>& child : children_)
-        {
-            if (!child->IsVisible())
-                continue;
+    // Prevent further updates while this update happens
+    DisableLayoutUpdate();
+    updatingLayout_ = true;
+    layoutDirty_ = false;
 
-            child->SetPosition(GetLayoutChildPosition(child).x_ + baseIndentWidth, positions[j]);
-            child->SetSize(width - layoutBorder_.left_ - layoutBorder_.right_, sizes[j]);
-            ++j;
-        }
-    }
-    else
+    if (layoutMode_ == LM_FREE)
     {
         for (const SharedPtr<UIElement>& child : children_)
         {
@@ -1180,6 +1107,11 @@ void UIElement::UpdateLayout()
                 child->UpdateAnchoring();
         }
     }
+    else
+    {
+        MeasureLayout();
+        ArrangeLayout();
+    }
 
     using namespace LayoutUpdated;
 
@@ -1187,6 +1119,7 @@ void UIElement::UpdateLayout()
     eventData[P_ELEMENT] = this;
     SendEvent(E_LAYOUTUPDATED, eventData);
 
+    updatingLayout_ = false;
     EnableLayoutUpdate();
 }
 
@@ -1200,6 +1133,31 @@ void UIElement::EnableLayoutUpdate()
     --layoutNestingLevel_;
 }
 
+void UIElement::UpdateDirtyLayouts()
+{
+    layoutQueued_ = false;
+
+    // If attached to another element since queued, the dirty layouts are reached from the new root
+    if (parent_)
+        return;
+
+    // Measure first so that each layout sees the final minimum sizes of its children, then arrange from the top down
+    // so that each element is resized by its parent before laying out its own children
+    MeasureDirtyLayouts();
+    ArrangeDirtyLayouts();
+
+    // Elements with layout updates still disabled are visited again at the next UI update
+    if (childLayoutDirty_ || (layoutDirty_ && layoutNestingLevel_))
+    {
+        auto* ui = GetSubsystem<UI>();
+        if (ui)
+        {
+            ui->QueueLayoutUpdate(this);
+            layoutQueued_ = true;
+        }
+    }
+}
+
 void UIElement::BringToFront()
 {
     // Follow the parent chain to the top level window. If it has BringToFront mode, bring it to front now
@@ -1312,6 +1270,10 @@ void UIElement::InsertChild(i32 index, UIElement* element)
     element->parent_ = this;
     element->MarkDirty();
 
+    // Layouts left dirty in the element's hierarchy are now updated through this hierarchy's root
+    if (element->layoutDirty_ || element->childLayoutDirty_)
+        element->MarkLayoutPathDirty();
+
     // Apply style now if child element (and its children) has it defined
     ApplyStyleRecursive(element);
 
@@ -2077,6 +2039,168 @@ void UIElement::ApplyStyleRecursive(UIElement* element)
     }
 }
 
+void UIElement::MarkLayoutPathDirty()
+{
+    // Flag the path to the root, so that only the hierarchies and subtrees with dirty layouts are visited. Once a flagged
+    // ancestor is found, the rest of the path and the root queue entry already exist
+    UIElement* element = this;
+    while (element->parent_)
+    {
+        element = element->parent_;
+        if (element->childLayoutDirty_)
+            return;
+        element->childLayoutDirty_ = true;
+    }
+
+    if (!element->layoutQueued_)
+    {
+        auto* ui = GetSubsystem<UI>();
+        if (ui)
+        {
+            ui->QueueLayoutUpdate(element);
+            element->layoutQueued_ = true;
+        }
+    }
+}
+
+void UIElement::MeasureDirtyLayouts()
+{
+    if (childLayoutDirty_)
+    {
+        for (const SharedPtr<UIElement>& child : children_)
+        {
+            if (child->layoutDirty_ || child->childLayoutDirty_)
+                child->MeasureDirtyLayouts();
+        }
+    }
+
+    if (layoutDirty_ && !layoutNestingLevel_ && layoutMode_ != LM_FREE)
+        MeasureLayout();
+}
+
+void UIElement::ArrangeDirtyLayouts()
+{
+    if (layoutDirty_ && !layoutNestingLevel_)
+        UpdateLayout();
+
+    if (!childLayoutDirty_)
+        return;
+
+    childLayoutDirty_ = false;
+
+    // Layout updated events may modify the child vector. Use just index-based iteration to be safe
+    for (i32 i = 0; i < children_.Size(); ++i)
+    {
+        SharedPtr<UIElement> child(children_[i]);
+        if (!child->layoutDirty_ && !child->childLayoutDirty_)
+            continue;
+
+        child->ArrangeDirtyLayouts();
+        if (child->childLayoutDirty_ || child->layoutDirty_)
+            childLayoutDirty_ = true;
+    }
+}
+
+void UIElement::MeasureLayout()
+{
+    if (!layoutCache_)
+        layoutCache_ = std::make_unique<LayoutCache>();
+    LayoutCache& cache = *layoutCache_;
+    cache.childMinSizes_.Clear();
+    cache.childMaxSizes_.Clear();
+    cache.childFlexScales_.Clear();
+
+    bool horizontal = layoutMode_ == LM_HORIZONTAL;
+    int minChildSize = 0;
+
+    for (const SharedPtr<UIElement>& child : children_)
+    {
+        if (!child->IsVisible())
+            continue;
+
+        IntVector2 childMinSize = child->GetEffectiveMinSize();
+        if (horizontal)
+        {
+            i32 indent = child->GetIndentWidth();
+            cache.childMinSizes_.Push(childMinSize.x_ + indent);
+            cache.childMaxSizes_.Push(child->GetMaxWidth() + indent);
+            cache.childFlexScales_.Push(child->GetLayoutFlexScale().x_);
+            minChildSize = Max(minChildSize, childMinSize.y_);
+        }
+        else
+        {
+            cache.childMinSizes_.Push(childMinSize.y_);
+            cache.childMaxSizes_.Push(child->GetMaxHeight());
+            cache.childFlexScales_.Push(child->GetLayoutFlexScale().y_);
+            minChildSize = Max(minChildSize, childMinSize.x_ + child->GetIndentWidth());
+        }
+    }
+
+    if (horizontal)
+    {
+        layoutMinSize_ = IntVector2(CalculateLayoutParentSize(cache.childMinSizes_, layoutBorder_.left_, layoutBorder_.right_,
+            layoutSpacing_), minChildSize + layoutBorder_.top_ + layoutBorder_.bottom_);
+    }
+    else
+    {
+        layoutMinSize_ = IntVector2(minChildSize + layoutBorder_.left_ + layoutBorder_.right_,
+            CalculateLayoutParentSize(cache.childMinSizes_, layoutBorder_.top_, layoutBorder_.bottom_, layoutSpacing_));
+    }
+}
+
+void UIElement::ArrangeLayout()
+{
+    const LayoutCache& cache = *layoutCache_;
+    i32 numChildren = cache.childMinSizes_.Size();
+    Vector<int> positions(numChildren);
+    Vector<int> sizes(numChildren);
+    int baseIndentWidth = GetIndentWidth();
+
+    if (layoutMode_ == LM_HORIZONTAL)
+    {
+        CalculateLayout(positions, sizes, cache.childMinSizes_, cache.childMaxSizes_, cache.childFlexScales_, GetWidth(),
+            layoutBorder_.left_, layoutBorder_.right_, layoutSpacing_);
+
+        int width = CalculateLayoutParentSize(sizes, layoutBorder_.left_, layoutBorder_.right_, layoutSpacing_);
+        int height = Max(GetHeight(), layoutMinSize_.y_);
+        SetSize(width, height);
+        // Validate the size before resizing child elements, in case of min/max limits
+        height = size_.y_;
+
+        i32 j = 0;
+        for (const SharedPtr<UIElement>& child : children_)
+        {
+            if (!child->IsVisible())
+                continue;
+
+            child->SetPosition(positions[j], GetLayoutChildPosition(child).y_);
+            child->SetSize(sizes[j], height - layoutBorder_.top_ - layoutBorder_.bottom_);
+            ++j;
+        }
+    }
+    else
+    {
+        CalculateLayout(positions, sizes, cache.childMinSizes_, cache.childMaxSizes_, cache.childFlexScales_, GetHeight(),
+            layoutBorder_.top_, layoutBorder_.bottom_, layoutSpacing_);
+
+        int height = CalculateLayoutParentSize(sizes, layoutBorder_.top_, layoutBorder_.bottom_, layoutSpacing_);
+        int width = Max(GetWidth(), layoutMinSize_.x_);
+        SetSize(width, height);
+        width = size_.x_;
+
+        i32 j = 0;
+        for (const SharedPtr<UIElement>& child : children_)
+        {
+            if (!child->IsVisible())
+                continue;
+
+            child->SetPosition(GetLayoutChildPosition(child).x_ + baseIndentWidth, positions[j]);
+            child->SetSize(width - layoutBorder_.left_ - layoutBorder_.right_, sizes[j]);
+            ++j;
+        }
+    }
+}
+
 int UIElement::CalculateLayoutParentSize(const Vector<int>& sizes, int begin, int end, int spacing)
 {
     int width = begin + end;
@@ -2100,6 +2224,20 @@ void UIElement::CalculateLayout(Vector<int>& positions, Vector<int>& sizes, cons
     i32 numChildren = sizes.Size();
     if (!numChildren)
         return;
+
+    // The result depends only on the constraints, not on the current child sizes. Elements are often laid out again
+    // with unchanged constraints, for example when a child is added or resized within its limits
+    if (!layoutCache_)
+        layoutCache_ = std::make_unique<LayoutCache>();
+    LayoutCache& cache = *layoutCache_;
+    if (cache.targetSize_ == targetSize && cache.begin_ == begin && cache.end_ == end && cache.spacing_ == spacing &&
+        cache.minSizes_ == minSizes && cache.maxSizes_ == maxSizes && cache.flexScales_ == flexScales)
+    {
+        sizes = cache.sizes_;
+        CalculateLayoutPositions(positions, sizes, begin, spacing);
+        return;
+    }
+
     int targetTotalSize = targetSize - begin - end - (numChildren - 1) * spacing;
     if (targetTotalSize < 0)
         targetTotalSize = 0;
@@ -2173,10 +2311,24 @@ void UIElement::CalculateLayout(Vector<int>& positions, Vector<int>& sizes, cons
         }
     }
 
+    cache.minSizes_ = minSizes;
+    cache.maxSizes_ = maxSizes;
+    cache.flexScales_ = flexScales;
+    cache.targetSize_ = targetSize;
+    cache.begin_ = begin;
+    cache.end_ = end;
+    cache.spacing_ = spacing;
+    cache.sizes_ = sizes;
+
+    CalculateLayoutPositions(positions, sizes, begin, spacing);
+}
+
+void UIElement::CalculateLayoutPositions(Vector<int>& positions, const Vector<int>& sizes, int begin, int spacing)
+{
     // Calculate final positions and store the maximum child element size for optimizations
     layoutElementMaxSize_ = 0;
     int position = begin;
-    for (i32 i = 0; i < numChildren; ++i)
+    for (i32 i = 0; i < sizes.Size(); ++i)
     {
         positions[i] = position;
         position += sizes[i] + spacing;
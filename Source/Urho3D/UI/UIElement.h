@@ -11,6 +11,8 @@
 #include "../Scene/Animatable.h"
 #include "../UI/UIBatch.h"
 
+#include <memory>
+
 namespace Urho3D
 {
 
@@ -367,10 +369,12 @@ public:
     void SetIndentSpacing(int indentSpacing);
     /// Manually update layout. Should not be necessary in most cases, but is provided for completeness.
     void UpdateLayout();
-    /// Disable automatic layout update. Should only be used if there are performance problems.
+    /// Disable automatic layout update. Use around bulk changes such as creating many child elements. Layout updates requested meanwhile are done once at the next UI update, unless UpdateLayout() is called after enabling.
     void DisableLayoutUpdate();
     /// Enable automatic layout update.
     void EnableLayoutUpdate();
+    /// Update the layouts requested in this element hierarchy while their updates were disabled and not done since. Called by UI for the root of the hierarchy.
+    void UpdateDirtyLayouts();
     /// Bring UI element to front.
     void BringToFront();
 
@@ -838,6 +842,14 @@ protected:
     unsigned resizeNestingLevel_{};
     /// Layout update nesting level to prevent endless loop.
     unsigned layoutNestingLevel_{};
+    /// Layout update in progress flag.
+    bool updatingLayout_{};
+    /// Layout update requested while disabled flag.
+    bool layoutDirty_{};
+    /// Child element or its descendant has a layout update requested while disabled flag.
+    bool childLayoutDirty_{};
+    /// Queued to the UI subsystem as the root of a hierarchy with dirty layouts flag.
+    bool layoutQueued_{};
     /// Layout element maximum size in layout direction.
     int layoutElementMaxSize_{};
     /// Horizontal indentation.
@@ -864,12 +876,24 @@ private:
     void GetChildrenWithTagRecursive(Vector<UIElement*>& dest, const String& tag) const;
     /// Recursively apply style to a child element hierarchy when adding to an element.
     void ApplyStyleRecursive(UIElement* element);
+    /// Flag the path to the root as leading to dirty layouts and queue the root to the UI subsystem.
+    void MarkLayoutPathDirty();
+    /// Measure the dirty layouts of the hierarchy, children before parents.
+    void MeasureDirtyLayouts();
+    /// Update the dirty layouts of the hierarchy, parents before children.
+    void ArrangeDirtyLayouts();
+    /// Gather the child constraints and calculate the minimum size of the layout, without resizing anything.
+    void MeasureLayout();
+    /// Resize and position self and child elements from the measured constraints.
+    void ArrangeLayout();
     /// Calculate layout width for resizing the parent element.
     int CalculateLayoutParentSize(const Vector<int>& sizes, int begin, int end, int spacing);
-    /// Calculate child widths/positions in the layout.
+    /// Calculate child widths/positions in the layout. Reuses the previous result if the constraints have not changed.
     void CalculateLayout
         (Vector<int>& positions, Vector<int>& sizes, const Vector<int>& minSizes, const Vector<int>& maxSizes,
             const Vector<float>& flexScales, int targetSize, int begin, int end, int spacing);
+    /// Calculate child positions in the layout from their sizes.
+    void CalculateLayoutPositions(Vector<int>& positions, const Vector<int>& sizes, int begin, int spacing);
     /// Get child element constant position in a layout.
     IntVector2 GetLayoutChildPosition(UIElement* child);
     /// Detach from parent.
@@ -879,6 +903,35 @@ private:
     /// Handle logic post-update event.
     void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
 
+    /// Child constraints from the last measure and the inputs and result of the previous layout calculation.
+    struct LayoutCache
+    {
+        /// Measured child minimum sizes in the layout direction.
+        Vector<int> childMinSizes_;
+        /// Measured child maximum sizes in the layout direction.
+        Vector<int> childMaxSizes_;
+        /// Measured child flex scales in the layout direction.
+        Vector<float> childFlexScales_;
+        /// Child minimum sizes.
+        Vector<int> minSizes_;
+        /// Child maximum sizes.
+        Vector<int> maxSizes_;
+        /// Child flex scales.
+        Vector<float> flexScales_;
+        /// Target size.
+        int targetSize_{};
+        /// Border at the start.
+        int begin_{};
+        /// Border at the end.
+        int end_{};
+        /// Spacing.
+        int spacing_{};
+        /// Resulting child sizes.
+        Vector<int> sizes_;
+    };
+
+    /// Measured constraints and previous layout calculation, created on first use.
+    std::unique_ptr<LayoutCache> layoutCache_;
     /// Size.
     IntVector2 size_;
     /// Minimum size.
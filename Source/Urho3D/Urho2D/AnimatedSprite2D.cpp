@@ -458,10 +458,12 @@ void AnimatedSprite2D::UpdateSourceBatchesSpriter()
         vertex2.position_ = worldTransform * Vector3(drawRect.max_.x_, drawRect.max_.y_, 0.0f);
         vertex3.position_ = worldTransform * Vector3(drawRect.max_.x_, drawRect.min_.y_, 0.0f);
 
-        vertex0.uv_ = textureRect.min_;
-        vertex1.uv_ = Vector2(textureRect.min_.x_, textureRect.max_.y_);
-        vertex2.uv_ = textureRect.max_;
-        vertex3.uv_ = Vector2(textureRect.max_.x_, textureRect.min_.y_);
+        Vector2 uvs[4];
+        sprite->GetTextureCoords(textureRect, uvs);
+        vertex0.uv_ = uvs[0];
+        vertex1.uv_ = uvs[1];
+        vertex2.uv_ = uvs[2];
+        vertex3.uv_ = uvs[3];
 
         Color finalColor;
         finalColor.FromU32(color);
@@ -18,7 +18,8 @@ namespace Urho3D
 
 SourceBatch2D::SourceBatch2D() :
     distance_(0.0f),
-    drawOrder_(0)
+    drawOrder_(0),
+    vertexCount_(0)
 {
 }
 
@@ -42,6 +42,8 @@ struct SourceBatch2D
     SharedPtr<Material> material_;
     /// Vertices.
     Vector<Vertex2D> vertices_;
+    /// Number of vertices the owner writes with Drawable2D::WriteVertices() when vertices_ is empty.
+    i32 vertexCount_;
 };
 
 /// Base class for 2D visible components.
@@ -78,6 +80,8 @@ public:
 
     /// Return all source batches (called by Renderer2D).
     const Vector<SourceBatch2D>& GetSourceBatches();
+    /// Write the vertices of a source batch that does not store them in its vertices_ into a locked vertex buffer (called by Renderer2D).
+    virtual void WriteVertices(const SourceBatch2D& batch, Vertex2D* dest) { }
 
 protected:
     /// Handle scene being assigned.
@@ -4,6 +4,8 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/Material.h"
 #include "../Resource/ResourceCache.h"
@@ -15,6 +17,10 @@
 #include "../Urho2D/Sprite2D.h"
 #include "../Urho2D/Urho2DEvents.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -23,12 +29,281 @@ namespace Urho3D
 extern const char* URHO2D_CATEGORY;
 extern const char* blendModeNames[];
 
+/// Particle value arrays, in order, in the particle data of ParticleEmitter2D.
+enum ParticleField2D
+{
+    PF_TIMETOLIVE = 0,
+    PF_TIMESTEP,
+    PF_POSITION_X,
+    PF_POSITION_Y,
+    PF_POSITION_Z,
+    PF_SIZE,
+    PF_SIZE_DELTA,
+    PF_ROTATION,
+    PF_ROTATION_DELTA,
+    PF_COLOR_R,
+    PF_COLOR_G,
+    PF_COLOR_B,
+    PF_COLOR_A,
+    PF_COLOR_DELTA_R,
+    PF_COLOR_DELTA_G,
+    PF_COLOR_DELTA_B,
+    PF_COLOR_DELTA_A,
+    PF_START_X,
+    PF_START_Y,
+    PF_VELOCITY_X,
+    PF_VELOCITY_Y,
+    PF_RADIAL_ACCELERATION,
+    PF_TANGENTIAL_ACCELERATION,
+    PF_EMIT_RADIUS,
+    PF_EMIT_RADIUS_DELTA,
+    PF_EMIT_ROTATION,
+    PF_EMIT_ROTATION_DELTA,
+    MAX_PARTICLE_FIELDS
+};
+
+/// Minimum number of particles for splitting an emitter's update across worker threads.
+static const unsigned PARALLEL_UPDATE_PARTICLES = 4096;
+
+/// Shared parameters for updating a range of particles.
+struct ParticleUpdate2D
+{
+    /// Particle data.
+    float* data_;
+    /// Size of each particle value array.
+    unsigned stride_;
+    /// Emitter type.
+    EmitterType2D emitterType_;
+    /// Gravity in world units.
+    Vector2 gravity_;
+    /// Time step.
+    float timeStep_;
+};
+
+/// Range of particles updated in a worker thread.
+struct ParticleUpdateTask2D
+{
+    /// Shared parameters.
+    const ParticleUpdate2D* update_;
+    /// First particle.
+    unsigned start_;
+    /// End particle (exclusive).
+    unsigned end_;
+    /// Bounding box min point of the range.
+    Vector3 boundingBoxMin_;
+    /// Bounding box max point of the range.
+    Vector3 boundingBoxMax_;
+};
+
+#ifdef URHO3D_SSE
+/// Return the smallest of four floats.
+static inline float HorizontalMin(__m128 value)
+{
+    value = _mm_min_ps(value, _mm_movehl_ps(value, value));
+    value = _mm_min_ss(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(value);
+}
+
+/// Return the largest of four floats.
+static inline float HorizontalMax(__m128 value)
+{
+    value = _mm_max_ps(value, _mm_movehl_ps(value, value));
+    value = _mm_max_ss(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(value);
+}
+#endif
+
+/// Update a range of particles and merge their bounds. Each value is updated in its own pass over the arrays, four
+/// particles at a time where SSE is available.
+static void UpdateParticleRange(const ParticleUpdate2D& update, unsigned start, unsigned end, Vector3& boundingBoxMin,
+    Vector3& boundingBoxMax)
+{
+    if (start >= end)
+        return;
+
+    float* data = update.data_;
+    const unsigned stride = update.stride_;
+    float* timeToLive = data + PF_TIMETOLIVE * stride;
+    float* timeStep = data + PF_TIMESTEP * stride;
+    float* positionX = data + PF_POSITION_X * stride;
+    float* positionY = data + PF_POSITION_Y * stride;
+    const float* positionZ = data + PF_POSITION_Z * stride;
+    float* size = data + PF_SIZE * stride;
+    const float* startX = data + PF_START_X * stride;
+    const float* startY = data + PF_START_Y * stride;
+
+    // The step of a particle ends with its life. Later passes read the clamped step back
+    unsigned i = start;
+#ifdef URHO3D_SSE
+    __m128 maxStep = _mm_set1_ps(update.timeStep_);
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 life = _mm_loadu_ps(timeToLive + i);
+        __m128 step = _mm_min_ps(maxStep, life);
+        _mm_storeu_ps(timeStep + i, step);
+        _mm_storeu_ps(timeToLive + i, _mm_sub_ps(life, step));
+    }
+#endif
+    for (; i < end; ++i)
+    {
+        timeStep[i] = Min(update.timeStep_, timeToLive[i]);
+        timeToLive[i] -= timeStep[i];
+    }
+
+    if (update.emitterType_ == EMITTER_TYPE_RADIAL)
+    {
+        float* emitRadius = data + PF_EMIT_RADIUS * stride;
+        const float* emitRadiusDelta = data + PF_EMIT_RADIUS_DELTA * stride;
+        float* emitRotation = data + PF_EMIT_ROTATION * stride;
+        const float* emitRotationDelta = data + PF_EMIT_ROTATION_DELTA * stride;
+
+        // Sine and cosine have no SIMD counterpart here, but the pass still streams through contiguous arrays
+        for (i = start; i < end; ++i)
+        {
+            emitRotation[i] += emitRotationDelta[i] * timeStep[i];
+            emitRadius[i] += emitRadiusDelta[i] * timeStep[i];
+
+            positionX[i] = startX[i] - Cos(emitRotation[i]) * emitRadius[i];
+            positionY[i] = startY[i] + Sin(emitRotation[i]) * emitRadius[i];
+        }
+    }
+    else
+    {
+        float* velocityX = data + PF_VELOCITY_X * stride;
+        float* velocityY = data + PF_VELOCITY_Y * stride;
+        const float* radialAcceleration = data + PF_RADIAL_ACCELERATION * stride;
+        const float* tangentialAcceleration = data + PF_TANGENTIAL_ACCELERATION * stride;
+
+        // Radial acceleration pushes away from the start position, tangential acceleration along its perpendicular
+        i = start;
+#ifdef URHO3D_SSE
+        __m128 gravityX = _mm_set1_ps(update.gravity_.x_);
+        __m128 gravityY = _mm_set1_ps(update.gravity_.y_);
+        __m128 minDistance = _mm_set1_ps(0.0001f);
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 posX = _mm_loadu_ps(positionX + i);
+            __m128 posY = _mm_loadu_ps(positionY + i);
+            __m128 distanceX = _mm_sub_ps(posX, _mm_loadu_ps(startX + i));
+            __m128 distanceY = _mm_sub_ps(posY, _mm_loadu_ps(startY + i));
+            __m128 distance = _mm_max_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(distanceX, distanceX),
+                _mm_mul_ps(distanceY, distanceY))), minDistance);
+            __m128 radialX = _mm_div_ps(distanceX, distance);
+            __m128 radialY = _mm_div_ps(distanceY, distance);
+            __m128 radial = _mm_loadu_ps(radialAcceleration + i);
+            __m128 tangential = _mm_loadu_ps(tangentialAcceleration + i);
+            __m128 step = _mm_loadu_ps(timeStep + i);
+
+            __m128 accelX = _mm_add_ps(gravityX, _mm_add_ps(_mm_mul_ps(radialX, radial), _mm_mul_ps(radialY, tangential)));
+            __m128 accelY = _mm_add_ps(gravityY, _mm_sub_ps(_mm_mul_ps(radialX, tangential), _mm_mul_ps(radialY, radial)));
+            __m128 velX = _mm_add_ps(_mm_loadu_ps(velocityX + i), _mm_mul_ps(accelX, step));
+            __m128 velY = _mm_sub_ps(_mm_loadu_ps(velocityY + i), _mm_mul_ps(accelY, step));
+            _mm_storeu_ps(velocityX + i, velX);
+            _mm_storeu_ps(velocityY + i, velY);
+            _mm_storeu_ps(positionX + i, _mm_add_ps(posX, _mm_mul_ps(velX, step)));
+            _mm_storeu_ps(positionY + i, _mm_add_ps(posY, _mm_mul_ps(velY, step)));
+        }
+#endif
+        for (; i < end; ++i)
+        {
+            float distanceX = positionX[i] - startX[i];
+            float distanceY = positionY[i] - startY[i];
+            float distance = Max(sqrtf(distanceX * distanceX + distanceY * distanceY), 0.0001f);
+            float radialX = distanceX / distance;
+            float radialY = distanceY / distance;
+
+            velocityX[i] += (update.gravity_.x_ + radialX * radialAcceleration[i] + radialY * tangentialAcceleration[i]) *
+                timeStep[i];
+            velocityY[i] -= (update.gravity_.y_ + radialX * tangentialAcceleration[i] - radialY * radialAcceleration[i]) *
+                timeStep[i];
+            positionX[i] += velocityX[i] * timeStep[i];
+            positionY[i] += velocityY[i] * timeStep[i];
+        }
+    }
+
+    // Size, rotation and color all interpolate linearly and are laid out as value and delta arrays
+    static const ParticleField2D interpolatedFields[][2] = {
+        {PF_SIZE, PF_SIZE_DELTA},
+        {PF_ROTATION, PF_ROTATION_DELTA},
+        {PF_COLOR_R, PF_COLOR_DELTA_R},
+        {PF_COLOR_G, PF_COLOR_DELTA_G},
+        {PF_COLOR_B, PF_COLOR_DELTA_B},
+        {PF_COLOR_A, PF_COLOR_DELTA_A}
+    };
+    for (const ParticleField2D* fields : interpolatedFields)
+    {
+        float* value = data + fields[0] * stride;
+        const float* delta = data + fields[1] * stride;
+        i = start;
+#ifdef URHO3D_SSE
+        for (; i + 4 <= end; i += 4)
+        {
+            _mm_storeu_ps(value + i, _mm_add_ps(_mm_loadu_ps(value + i),
+                _mm_mul_ps(_mm_loadu_ps(delta + i), _mm_loadu_ps(timeStep + i))));
+        }
+#endif
+        for (; i < end; ++i)
+            value[i] += delta[i] * timeStep[i];
+    }
+
+    i = start;
+#ifdef URHO3D_SSE
+    if (i + 4 <= end)
+    {
+        __m128 half = _mm_set1_ps(0.5f);
+        __m128 minX = _mm_set1_ps(M_INFINITY);
+        __m128 minY = minX;
+        __m128 minZ = minX;
+        __m128 maxX = _mm_set1_ps(-M_INFINITY);
+        __m128 maxY = maxX;
+        __m128 maxZ = maxX;
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 halfSize = _mm_mul_ps(_mm_loadu_ps(size + i), half);
+            __m128 posX = _mm_loadu_ps(positionX + i);
+            __m128 posY = _mm_loadu_ps(positionY + i);
+            __m128 posZ = _mm_loadu_ps(positionZ + i);
+            minX = _mm_min_ps(minX, _mm_sub_ps(posX, halfSize));
+            minY = _mm_min_ps(minY, _mm_sub_ps(posY, halfSize));
+            minZ = _mm_min_ps(minZ, posZ);
+            maxX = _mm_max_ps(maxX, _mm_add_ps(posX, halfSize));
+            maxY = _mm_max_ps(maxY, _mm_add_ps(posY, halfSize));
+            maxZ = _mm_max_ps(maxZ, posZ);
+        }
+
+        boundingBoxMin.x_ = Min(boundingBoxMin.x_, HorizontalMin(minX));
+        boundingBoxMin.y_ = Min(boundingBoxMin.y_, HorizontalMin(minY));
+        boundingBoxMin.z_ = Min(boundingBoxMin.z_, HorizontalMin(minZ));
+        boundingBoxMax.x_ = Max(boundingBoxMax.x_, HorizontalMax(maxX));
+        boundingBoxMax.y_ = Max(boundingBoxMax.y_, HorizontalMax(maxY));
+        boundingBoxMax.z_ = Max(boundingBoxMax.z_, HorizontalMax(maxZ));
+    }
+#endif
+    for (; i < end; ++i)
+    {
+        float halfSize = size[i] * 0.5f;
+        boundingBoxMin.x_ = Min(boundingBoxMin.x_, positionX[i] - halfSize);
+        boundingBoxMin.y_ = Min(boundingBoxMin.y_, positionY[i] - halfSize);
+        boundingBoxMin.z_ = Min(boundingBoxMin.z_, positionZ[i]);
+        boundingBoxMax.x_ = Max(boundingBoxMax.x_, positionX[i] + halfSize);
+        boundingBoxMax.y_ = Max(boundingBoxMax.y_, positionY[i] + halfSize);
+        boundingBoxMax.z_ = Max(boundingBoxMax.z_, positionZ[i]);
+    }
+}
+
+static void UpdateParticlesWork(const WorkItem* item, i32 /*threadIndex*/)
+{
+    auto* task = reinterpret_cast<ParticleUpdateTask2D*>(item->start_);
+    UpdateParticleRange(*task->update_, task->start_, task->end_, task->boundingBoxMin_, task->boundingBoxMax_);
+}
+
 ParticleEmitter2D::ParticleEmitter2D(Context* context) :
     Drawable2D(context),
     blendMode_(BLEND_ADDALPHA),
     numParticles_(0),
     emissionTime_(0.0f),
     emitParticleTime_(0.0f),
+    maxParticles_(0),
     boundingBoxMinPoint_(Vector3::ZERO),
     boundingBoxMaxPoint_(Vector3::ZERO),
     emitting_(true)
@@ -111,11 +386,18 @@ void ParticleEmitter2D::SetBlendMode(BlendMode blendMode)
 void ParticleEmitter2D::SetMaxParticles(unsigned maxParticles)
 {
     maxParticles = Max(maxParticles, 1U);
-
-    particles_.Resize(maxParticles);
-    sourceBatches_[0].vertices_.Reserve(maxParticles * 4);
+    if (maxParticles == maxParticles_)
+        return;
 
     numParticles_ = Min(maxParticles, numParticles_);
+
+    // Every value array changes size, so move the live particles over one array at a time
+    Vector<float> particleData(maxParticles * MAX_PARTICLE_FIELDS);
+    for (unsigned i = 0; i < MAX_PARTICLE_FIELDS && numParticles_; ++i)
+        memcpy(&particleData[i * maxParticles], &particleData_[i * maxParticles_], numParticles_ * sizeof(float));
+
+    particleData_.Swap(particleData);
+    maxParticles_ = maxParticles;
 }
 
 ParticleEffect2D* ParticleEmitter2D::GetEffect() const
@@ -192,15 +474,26 @@ void ParticleEmitter2D::UpdateSourceBatches()
     if (!sourceBatchesDirty_)
         return;
 
-    Vector<Vertex2D>& vertices = sourceBatches_[0].vertices_;
-    vertices.Clear();
+    // Only count the vertices here. WriteVertices() writes them straight into the renderer's vertex buffer
+    SourceBatch2D& sourceBatch = sourceBatches_[0];
+    sourceBatch.vertexCount_ = 0;
 
-    if (!sprite_)
+    Rect textureRect;
+    if (!sprite_ || !sprite_->GetTextureRectangle(textureRect))
         return;
 
+    sourceBatch.vertexCount_ = numParticles_ * 4;
+    sourceBatchesDirty_ = false;
+}
+
+void ParticleEmitter2D::WriteVertices(const SourceBatch2D& batch, Vertex2D* dest)
+{
+    unsigned numVertices = (unsigned)batch.vertexCount_;
+    unsigned numParticles = Min(numVertices / 4, numParticles_);
+
     Rect textureRect;
-    if (!sprite_->GetTextureRectangle(textureRect))
-        return;
+    if (!sprite_ || !sprite_->GetTextureRectangle(textureRect))
+        numParticles = 0;
 
     /*
     V1---------V2
@@ -211,40 +504,50 @@ void ParticleEmitter2D::UpdateSourceBatches()
     | /         |
     V0---------V3
     */
-    Vertex2D vertex0;
-    Vertex2D vertex1;
-    Vertex2D vertex2;
-    Vertex2D vertex3;
-
-    vertex0.uv_ = textureRect.min_;
-    vertex1.uv_ = Vector2(textureRect.min_.x_, textureRect.max_.y_);
-    vertex2.uv_ = textureRect.max_;
-    vertex3.uv_ = Vector2(textureRect.max_.x_, textureRect.min_.y_);
-
-    for (unsigned i = 0; i < numParticles_; ++i)
+    Vector2 uvs[4];
+    if (numParticles)
+        sprite_->GetTextureCoords(textureRect, uvs);
+
+    const float* data = particleData_.Buffer();
+    const float* positionX = data + PF_POSITION_X * maxParticles_;
+    const float* positionY = data + PF_POSITION_Y * maxParticles_;
+    const float* positionZ = data + PF_POSITION_Z * maxParticles_;
+    const float* size = data + PF_SIZE * maxParticles_;
+    const float* rotation = data + PF_ROTATION * maxParticles_;
+    const float* colorR = data + PF_COLOR_R * maxParticles_;
+    const float* colorG = data + PF_COLOR_G * maxParticles_;
+    const float* colorB = data + PF_COLOR_B * maxParticles_;
+    const float* colorA = data + PF_COLOR_A * maxParticles_;
+
+    for (unsigned i = 0; i < numParticles; ++i)
     {
-        Particle2D& p = particles_[i];
-
-        float rotation = -p.rotation_;
-        float c = Cos(rotation);
-        float s = Sin(rotation);
-        float add = (c + s) * p.size_ * 0.5f;
-        float sub = (c - s) * p.size_ * 0.5f;
-
-        vertex0.position_ = Vector3(p.position_.x_ - sub, p.position_.y_ - add, p.position_.z_);
-        vertex1.position_ = Vector3(p.position_.x_ - add, p.position_.y_ + sub, p.position_.z_);
-        vertex2.position_ = Vector3(p.position_.x_ + sub, p.position_.y_ + add, p.position_.z_);
-        vertex3.position_ = Vector3(p.position_.x_ + add, p.position_.y_ - sub, p.position_.z_);
-
-        vertex0.color_ = vertex1.color_ = vertex2.color_ = vertex3.color_ = p.color_.ToU32();
-
-        vertices.Push(vertex0);
-        vertices.Push(vertex1);
-        vertices.Push(vertex2);
-        vertices.Push(vertex3);
+        float c = Cos(-rotation[i]);
+        float s = Sin(-rotation[i]);
+        float add = (c + s) * size[i] * 0.5f;
+        float sub = (c - s) * size[i] * 0.5f;
+        float x = positionX[i];
+        float y = positionY[i];
+        float z = positionZ[i];
+        unsigned color = Color(colorR[i], colorG[i], colorB[i], colorA[i]).ToU32();
+
+        dest[0].position_ = Vector3(x - sub, y - add, z);
+        dest[0].color_ = color;
+        dest[0].uv_ = uvs[0];
+        dest[1].position_ = Vector3(x - add, y + sub, z);
+        dest[1].color_ = color;
+        dest[1].uv_ = uvs[1];
+        dest[2].position_ = Vector3(x + sub, y + add, z);
+        dest[2].color_ = color;
+        dest[2].uv_ = uvs[2];
+        dest[3].position_ = Vector3(x + add, y - sub, z);
+        dest[3].color_ = color;
+        dest[3].uv_ = uvs[3];
+        dest += 4;
     }
 
-    sourceBatchesDirty_ = false;
+    // Should particles have expired since the vertices were counted, leave degenerate quads in their place
+    if (numParticles * 4 < numVertices)
+        memset(dest, 0, (numVertices - numParticles * 4) * sizeof(Vertex2D));
 }
 
 void ParticleEmitter2D::UpdateMaterial()
@@ -300,34 +603,70 @@ void ParticleEmitter2D::Update(float timeStep)
     boundingBoxMinPoint_ = Vector3(M_INFINITY, M_INFINITY, M_INFINITY);
     boundingBoxMaxPoint_ = Vector3(-M_INFINITY, -M_INFINITY, -M_INFINITY);
 
-    unsigned particleIndex = 0;
-    while (particleIndex < numParticles_)
+    // Remove expired particles first so that the update passes see live particles only
+    const float* timeToLive = particleData_.Buffer() + PF_TIMETOLIVE * maxParticles_;
+    for (unsigned i = 0; i < numParticles_;)
+    {
+        if (timeToLive[i] > 0.0f)
+            ++i;
+        else
+            MoveParticle(i, --numParticles_);
+    }
+
+    ParticleUpdate2D update;
+    update.data_ = particleData_.Buffer();
+    update.stride_ = maxParticles_;
+    update.emitterType_ = effect_->GetEmitterType();
+    update.gravity_ = effect_->GetGravity() * worldScale;
+    update.timeStep_ = timeStep;
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (numParticles_ >= PARALLEL_UPDATE_PARTICLES && queue && queue->GetNumThreads())
     {
-        Particle2D& particle = particles_[particleIndex];
-        if (particle.timeToLive_ > 0.0f)
+        URHO3D_PROFILE(UpdateParticles2D);
+
+        // One range per thread including the main thread, in whole SIMD widths. The range bounds are merged afterward
+        unsigned numTasks = (unsigned)queue->GetNumThreads() + 1;
+        unsigned rangeSize = ((numParticles_ + numTasks - 1) / numTasks + 3) & ~3U;
+        Vector<ParticleUpdateTask2D> tasks;
+        tasks.Reserve(numTasks);
+
+        for (unsigned start = 0; start < numParticles_; start += rangeSize)
         {
-            UpdateParticle(particle, timeStep, worldPosition, worldScale);
-            ++particleIndex;
+            ParticleUpdateTask2D task;
+            task.update_ = &update;
+            task.start_ = start;
+            task.end_ = Min(start + rangeSize, numParticles_);
+            task.boundingBoxMin_ = boundingBoxMinPoint_;
+            task.boundingBoxMax_ = boundingBoxMaxPoint_;
+            tasks.Push(task);
         }
-        else
+
+        queue->RunParallel(UpdateParticlesWork, tasks.Buffer(), tasks.Size(), tasks.Size());
+
+        for (const ParticleUpdateTask2D& task : tasks)
         {
-            if (particleIndex != numParticles_ - 1)
-                particles_[particleIndex] = particles_[numParticles_ - 1];
-            --numParticles_;
+            boundingBoxMinPoint_ = VectorMin(boundingBoxMinPoint_, task.boundingBoxMin_);
+            boundingBoxMaxPoint_ = VectorMax(boundingBoxMaxPoint_, task.boundingBoxMax_);
         }
     }
+    else
+        UpdateParticleRange(update, 0, numParticles_, boundingBoxMinPoint_, boundingBoxMaxPoint_);
 
     if (emitting_ && emissionTime_ > 0.0f)
     {
         float worldAngle = GetNode()->GetWorldRotation().RollAngle();
 
-        float timeBetweenParticles = effect_->GetParticleLifeSpan() / particles_.Size();
+        float timeBetweenParticles = effect_->GetParticleLifeSpan() / maxParticles_;
         emitParticleTime_ += timeStep;
 
         while (emitParticleTime_ > 0.0f)
         {
             if (EmitParticle(worldPosition, worldAngle, worldScale))
-                UpdateParticle(particles_[numParticles_ - 1], emitParticleTime_, worldPosition, worldScale);
+            {
+                update.timeStep_ = emitParticleTime_;
+                UpdateParticleRange(update, numParticles_ - 1, numParticles_, boundingBoxMinPoint_, boundingBoxMaxPoint_);
+            }
 
             emitParticleTime_ -= timeBetweenParticles;
         }
@@ -343,7 +682,7 @@ void ParticleEmitter2D::Update(float timeStep)
 
 bool ParticleEmitter2D::EmitParticle(const Vector3& worldPosition, float worldAngle, float worldScale)
 {
-    if (numParticles_ >= (unsigned)effect_->GetMaxParticles() || numParticles_ >= particles_.Size())
+    if (numParticles_ >= (unsigned)effect_->GetMaxParticles() || numParticles_ >= maxParticles_)
         return false;
 
     float lifespan = effect_->GetParticleLifeSpan() + effect_->GetParticleLifespanVariance() * Random(-1.0f, 1.0f);
@@ -352,7 +691,7 @@ bool ParticleEmitter2D::EmitParticle(const Vector3& worldPosition, float worldAn
 
     float invLifespan = 1.0f / lifespan;
 
-    Particle2D& particle = particles_[numParticles_++];
+    Particle2D particle;
     particle.timeToLive_ = lifespan;
 
     particle.position_.x_ = worldPosition.x_ + worldScale * effect_->GetSourcePositionVariance().x_ * Random(-1.0f, 1.0f);
@@ -392,63 +731,53 @@ bool ParticleEmitter2D::EmitParticle(const Vector3& worldPosition, float worldAn
     float endRotation = worldAngle + effect_->GetRotationEnd() + effect_->GetRotationEndVariance() * Random(-1.0f, 1.0f);
     particle.rotationDelta_ = (endRotation - particle.rotation_) * invLifespan;
 
+    SetParticle(numParticles_++, particle);
     return true;
 }
 
-void ParticleEmitter2D::UpdateParticle(Particle2D& particle, float timeStep, const Vector3& worldPosition, float worldScale)
+void ParticleEmitter2D::SetParticle(unsigned index, const Particle2D& particle)
 {
-    if (timeStep > particle.timeToLive_)
-        timeStep = particle.timeToLive_;
-
-    particle.timeToLive_ -= timeStep;
-
-    if (effect_->GetEmitterType() == EMITTER_TYPE_RADIAL)
-    {
-        particle.emitRotation_ += particle.emitRotationDelta_ * timeStep;
-        particle.emitRadius_ += particle.emitRadiusDelta_ * timeStep;
-
-        particle.position_.x_ = particle.startPos_.x_ - Cos(particle.emitRotation_) * particle.emitRadius_;
-        particle.position_.y_ = particle.startPos_.y_ + Sin(particle.emitRotation_) * particle.emitRadius_;
-    }
-    else
-    {
-        float distanceX = particle.position_.x_ - particle.startPos_.x_;
-        float distanceY = particle.position_.y_ - particle.startPos_.y_;
-
-        float distanceScalar = Vector2(distanceX, distanceY).Length();
-        if (distanceScalar < 0.0001f)
-            distanceScalar = 0.0001f;
-
-        float radialX = distanceX / distanceScalar;
-        float radialY = distanceY / distanceScalar;
-
-        float tangentialX = radialX;
-        float tangentialY = radialY;
-
-        radialX *= particle.radialAcceleration_;
-        radialY *= particle.radialAcceleration_;
-
-        float newY = tangentialX;
-        tangentialX = -tangentialY * particle.tangentialAcceleration_;
-        tangentialY = newY * particle.tangentialAcceleration_;
+    float* data = particleData_.Buffer() + index;
+    const unsigned stride = maxParticles_;
+
+    data[PF_TIMETOLIVE * stride] = particle.timeToLive_;
+    data[PF_TIMESTEP * stride] = 0.0f;
+    data[PF_POSITION_X * stride] = particle.position_.x_;
+    data[PF_POSITION_Y * stride] = particle.position_.y_;
+    data[PF_POSITION_Z * stride] = particle.position_.z_;
+    data[PF_SIZE * stride] = particle.size_;
+    data[PF_SIZE_DELTA * stride] = particle.sizeDelta_;
+    data[PF_ROTATION * stride] = particle.rotation_;
+    data[PF_ROTATION_DELTA * stride] = particle.rotationDelta_;
+    data[PF_COLOR_R * stride] = particle.color_.r_;
+    data[PF_COLOR_G * stride] = particle.color_.g_;
+    data[PF_COLOR_B * stride] = particle.color_.b_;
+    data[PF_COLOR_A * stride] = particle.color_.a_;
+    data[PF_COLOR_DELTA_R * stride] = particle.colorDelta_.r_;
+    data[PF_COLOR_DELTA_G * stride] = particle.colorDelta_.g_;
+    data[PF_COLOR_DELTA_B * stride] = particle.colorDelta_.b_;
+    data[PF_COLOR_DELTA_A * stride] = particle.colorDelta_.a_;
+    data[PF_START_X * stride] = particle.startPos_.x_;
+    data[PF_START_Y * stride] = particle.startPos_.y_;
+    data[PF_VELOCITY_X * stride] = particle.velocity_.x_;
+    data[PF_VELOCITY_Y * stride] = particle.velocity_.y_;
+    data[PF_RADIAL_ACCELERATION * stride] = particle.radialAcceleration_;
+    data[PF_TANGENTIAL_ACCELERATION * stride] = particle.tangentialAcceleration_;
+    data[PF_EMIT_RADIUS * stride] = particle.emitRadius_;
+    data[PF_EMIT_RADIUS_DELTA * stride] = particle.emitRadiusDelta_;
+    data[PF_EMIT_ROTATION * stride] = particle.emitRotation_;
+    data[PF_EMIT_ROTATION_DELTA * stride] = particle.emitRotationDelta_;
+}
 
-        particle.velocity_.x_ += (effect_->GetGravity().x_ * worldScale + radialX - tangentialX) * timeStep;
-        particle.velocity_.y_ -= (effect_->GetGravity().y_ * worldScale - radialY + tangentialY) * timeStep;
-        particle.position_.x_ += particle.velocity_.x_ * timeStep;
-        particle.position_.y_ += particle.velocity_.y_ * timeStep;
-    }
+void ParticleEmitter2D::MoveParticle(unsigned dest, unsigned src)
+{
+    if (dest == src)
+        return;
 
-    particle.size_ += particle.sizeDelta_ * timeStep;
-    particle.rotation_ += particle.rotationDelta_ * timeStep;
-    particle.color_ += particle.colorDelta_ * timeStep;
-
-    float halfSize = particle.size_ * 0.5f;
-    boundingBoxMinPoint_.x_ = Min(boundingBoxMinPoint_.x_, particle.position_.x_ - halfSize);
-    boundingBoxMinPoint_.y_ = Min(boundingBoxMinPoint_.y_, particle.position_.y_ - halfSize);
-    boundingBoxMinPoint_.z_ = Min(boundingBoxMinPoint_.z_, particle.position_.z_);
-    boundingBoxMaxPoint_.x_ = Max(boundingBoxMaxPoint_.x_, particle.position_.x_ + halfSize);
-    boundingBoxMaxPoint_.y_ = Max(boundingBoxMaxPoint_.y_, particle.position_.y_ + halfSize);
-    boundingBoxMaxPoint_.z_ = Max(boundingBoxMaxPoint_.z_, particle.position_.z_);
+    float* data = particleData_.Buffer();
+    for (unsigned i = 0; i < MAX_PARTICLE_FIELDS; ++i)
+        data[i * maxParticles_ + dest] = data[i * maxParticles_ + src];
 }
 
+
 }
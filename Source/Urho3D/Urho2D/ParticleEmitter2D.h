@@ -97,7 +97,7 @@ public:
     BlendMode GetBlendMode() const { return blendMode_; }
 
     /// Return max particles.
-    unsigned GetMaxParticles() const { return particles_.Size(); }
+    unsigned GetMaxParticles() const { return maxParticles_; }
 
     /// Set particle model attr.
     void SetParticleEffectAttr(const ResourceRef& value);
@@ -111,6 +111,9 @@ public:
     /// @property
     bool IsEmitting() const { return emitting_; }
 
+    /// Write the particle quads directly into a locked vertex buffer (called by Renderer2D).
+    void WriteVertices(const SourceBatch2D& batch, Vertex2D* dest) override;
+
 private:
     /// Handle scene being assigned.
     void OnSceneSet(Scene* scene) override;
@@ -128,8 +131,10 @@ private:
     void Update(float timeStep);
     /// Emit particle.
     bool EmitParticle(const Vector3& worldPosition, float worldAngle, float worldScale);
-    /// Update particle.
-    void UpdateParticle(Particle2D& particle, float timeStep, const Vector3& worldPosition, float worldScale);
+    /// Store a particle's values at an index of the particle value arrays.
+    void SetParticle(unsigned index, const Particle2D& particle);
+    /// Copy a particle's values to another index of the particle value arrays.
+    void MoveParticle(unsigned dest, unsigned src);
 
     /// Particle effect.
     SharedPtr<ParticleEffect2D> effect_;
@@ -145,8 +150,10 @@ private:
     float emitParticleTime_;
     /// Currently emitting flag.
     bool emitting_;
-    /// Particles.
-    Vector<Particle2D> particles_;
+    /// Particle values, one array of maxParticles_ floats per value so that the update loops run over contiguous data.
+    Vector<float> particleData_;
+    /// Max particles, which is the size of each particle value array.
+    unsigned maxParticles_;
     /// Bounding box min point.
     Vector3 boundingBoxMinPoint_;
     /// Bounding box max point.
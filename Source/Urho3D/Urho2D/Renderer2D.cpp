@@ -31,6 +31,12 @@ extern const char* blendModeNames[];
 
 static const VertexElements MASK_VERTEX2D = VertexElements::Position | VertexElements::Color | VertexElements::TexCoord1;
 
+/// Return number of vertices in a source batch, whether stored or written by the owner.
+static inline i32 GetVertexCount(const SourceBatch2D& batch)
+{
+    return batch.vertices_.Empty() ? batch.vertexCount_ : batch.vertices_.Size();
+}
+
 ViewBatchInfo2D::ViewBatchInfo2D() :
     vertexBufferUpdateFrameNumber_(0),
     indexCount_(0),
@@ -184,10 +190,13 @@ void Renderer2D::UpdateGeometry(const FrameInfo& frame)
                 const Vector<const SourceBatch2D*>& sourceBatches = viewBatchInfo.sourceBatches_;
                 for (unsigned b = 0; b < sourceBatches.Size(); ++b)
                 {
-                    const Vector<Vertex2D>& vertices = sourceBatches[b]->vertices_;
-                    for (unsigned i = 0; i < vertices.Size(); ++i)
-                        dest[i] = vertices[i];
-                    dest += vertices.Size();
+                    const SourceBatch2D* sourceBatch = sourceBatches[b];
+                    const Vector<Vertex2D>& vertices = sourceBatch->vertices_;
+                    if (vertices.Empty())
+                        sourceBatch->owner_->WriteVertices(*sourceBatch, dest);
+                    else
+                        memcpy(dest, vertices.Buffer(), vertices.Size() * sizeof(Vertex2D));
+                    dest += GetVertexCount(*sourceBatch);
                 }
 
                 vertexBuffer->Unlock();
@@ -319,29 +328,7 @@ void Renderer2D::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventDa
         URHO3D_PROFILE(CheckDrawableVisibility);
 
         auto* queue = GetSubsystem<WorkQueue>();
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = drawables_.Size() / numWorkItems;
-
-        Vector<Drawable2D*>::Iterator start = drawables_.Begin();
-        for (int i = 0; i < numWorkItems; ++i)
-        {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = WI_MAX_PRIORITY;
-            item->workFunction_ = CheckDrawableVisibilityWork;
-            item->aux_ = this;
-
-            Vector<Drawable2D*>::Iterator end = drawables_.End();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
-
-        queue->Complete(WI_MAX_PRIORITY);
+        queue->RunParallel(CheckDrawableVisibilityWork, drawables_.Buffer(), drawables_.Size(), 0, this);
     }
 
     ViewBatchInfo2D& viewBatchInfo = viewBatchInfos_[camera];
@@ -414,7 +401,7 @@ void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* cam
 
         for (const SourceBatch2D& batch : batches)
         {
-            if (batch.material_ && !batch.vertices_.Empty())
+            if (batch.material_ && GetVertexCount(batch))
                 sourceBatches.Push(&batch);
         }
     }
@@ -439,7 +426,7 @@ void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* cam
     {
         distance = Min(distance, sourceBatches[b]->distance_);
         Material* material = sourceBatches[b]->material_;
-        const Vector<Vertex2D>& vertices = sourceBatches[b]->vertices_;
+        i32 vertexCount = GetVertexCount(*sourceBatches[b]);
 
         // When new material encountered, finish the current batch and start new
         if (currMaterial != material)
@@ -457,8 +444,8 @@ void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* cam
             currMaterial = material;
         }
 
-        iCount += vertices.Size() * 6 / 4;
-        vCount += vertices.Size();
+        iCount += vertexCount * 6 / 4;
+        vCount += vertexCount;
     }
 
     // Add the final batch if necessary
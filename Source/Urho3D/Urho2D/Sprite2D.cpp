@@ -116,6 +116,11 @@ void Sprite2D::SetTextureEdgeOffset(float offset)
     edgeOffset_ = offset;
 }
 
+void Sprite2D::SetRotated(bool enable)
+{
+    rotated_ = enable;
+}
+
 void Sprite2D::SetSpriteSheet(SpriteSheet2D* spriteSheet)
 {
     spriteSheet_ = spriteSheet;
@@ -131,8 +136,9 @@ bool Sprite2D::GetDrawRectangle(Rect& rect, const Vector2& hotSpot, bool flipX,
     if (rectangle_.Width() == 0 || rectangle_.Height() == 0)
         return false;
 
-    float width = (float)rectangle_.Width() * PIXEL_SIZE;
-    float height = (float)rectangle_.Height() * PIXEL_SIZE;
+    IntVector2 imageSize = GetImageSize();
+    float width = (float)imageSize.x_ * PIXEL_SIZE;
+    float height = (float)imageSize.y_ * PIXEL_SIZE;
 
     float hotSpotX = flipX ? (1.0f - hotSpot.x_) : hotSpot.x_;
     float hotSpotY = flipY ? (1.0f - hotSpot.y_) : hotSpot.y_;
@@ -159,6 +165,10 @@ bool Sprite2D::GetTextureRectangle(Rect& rect, bool flipX, bool flipY) const
     rect.min_.y_ = ((float)rectangle_.bottom_ - edgeOffset_) * invHeight;
     rect.max_.y_ = ((float)rectangle_.top_ + edgeOffset_) * invHeight;
 
+    // The image x axis runs along the texture y axis when rotated
+    if (rotated_)
+        Swap(flipX, flipY);
+
     if (flipX)
         Swap(rect.min_.x_, rect.max_.x_);
 
@@ -168,6 +178,25 @@ bool Sprite2D::GetTextureRectangle(Rect& rect, bool flipX, bool flipY) const
     return true;
 }
 
+void Sprite2D::GetTextureCoords(const Rect& textureRect, Vector2* coords) const
+{
+    if (!rotated_)
+    {
+        coords[0] = textureRect.min_;
+        coords[1] = Vector2(textureRect.min_.x_, textureRect.max_.y_);
+        coords[2] = textureRect.max_;
+        coords[3] = Vector2(textureRect.max_.x_, textureRect.min_.y_);
+    }
+    else
+    {
+        // Rotated clockwise, so the image's bottom left corner is at the texture area's top left
+        coords[0] = Vector2(textureRect.min_.x_, textureRect.max_.y_);
+        coords[1] = textureRect.max_;
+        coords[2] = Vector2(textureRect.max_.x_, textureRect.min_.y_);
+        coords[3] = textureRect.min_;
+    }
+}
+
 ResourceRef Sprite2D::SaveToResourceRef(Sprite2D* sprite)
 {
     SpriteSheet2D* spriteSheet = nullptr;
@@ -46,6 +46,9 @@ public:
     /// Set texture edge offset in pixels. This affects the left/right and top/bottom edges equally to prevent edge sampling artifacts. Default 0.
     /// @property
     void SetTextureEdgeOffset(float offset);
+    /// Set whether the image is stored rotated 90 degrees clockwise in the texture. The rectangle is then the texture area, with the image height as its width.
+    /// @nobind
+    void SetRotated(bool enable);
     /// Set sprite sheet.
     void SetSpriteSheet(SpriteSheet2D* spriteSheet);
 
@@ -69,6 +72,14 @@ public:
     /// @property
     float GetTextureEdgeOffset() const { return edgeOffset_; }
 
+    /// Return whether the image is stored rotated in the texture.
+    /// @nobind
+    bool IsRotated() const { return rotated_; }
+
+    /// Return image size in pixels. Same as the rectangle size unless rotated.
+    /// @nobind
+    IntVector2 GetImageSize() const { return rotated_ ? IntVector2(rectangle_.Height(), rectangle_.Width()) : rectangle_.Size(); }
+
     /// Return sprite sheet.
     SpriteSheet2D* GetSpriteSheet() const { return spriteSheet_; }
 
@@ -79,6 +90,9 @@ public:
     bool GetDrawRectangle(Rect& rect, const Vector2& hotSpot, bool flipX = false, bool flipY = false) const;
     /// Return texture rectangle.
     bool GetTextureRectangle(Rect& rect, bool flipX = false, bool flipY = false) const;
+    /// Return texture coordinates of the bottom left, top left, top right and bottom right corners of the drawn image from a texture rectangle returned by GetTextureRectangle().
+    /// @nobind
+    void GetTextureCoords(const Rect& textureRect, Vector2* coords) const;
 
     /// Save sprite to ResourceRef.
     static ResourceRef SaveToResourceRef(Sprite2D* sprite);
@@ -100,6 +114,8 @@ private:
     SharedPtr<Texture2D> loadTexture_;
     /// Offset to fix texture edge bleeding.
     float edgeOffset_;
+    /// Image stored rotated in the texture.
+    bool rotated_{};
 };
 
 }
@@ -76,6 +76,12 @@ void SpriteSheet2D::SetTexture(Texture2D* texture)
 }
 
 void SpriteSheet2D::DefineSprite(const String& name, const IntRect& rectangle, const Vector2& hotSpot, const IntVector2& offset)
+{
+    DefineSprite(name, rectangle, hotSpot, offset, false);
+}
+
+void SpriteSheet2D::DefineSprite(const String& name, const IntRect& rectangle, const Vector2& hotSpot, const IntVector2& offset,
+    bool rotated)
 {
     if (!texture_)
         return;
@@ -86,7 +92,11 @@ void SpriteSheet2D::DefineSprite(const String& name, const IntRect& rectangle, c
     SharedPtr<Sprite2D> sprite(new Sprite2D(context_));
     sprite->SetName(name);
     sprite->SetTexture(texture_);
-    sprite->SetRectangle(rectangle);
+    if (rotated)
+        sprite->SetRectangle(IntRect(rectangle.left_, rectangle.top_, rectangle.left_ + rectangle.Height(), rectangle.top_ + rectangle.Width()));
+    else
+        sprite->SetRectangle(rectangle);
+    sprite->SetRotated(rotated);
     sprite->SetHotSpot(hotSpot);
     sprite->SetOffset(offset);
     sprite->SetSpriteSheet(this);
@@ -146,12 +156,6 @@ bool SpriteSheet2D::EndLoadFromPListFile()
         String name = i->first_.Split('.')[0];
 
         const PListValueMap& frameInfo = i->second_.GetValueMap();
-        if (frameInfo["rotated"]->GetBool())
-        {
-            URHO3D_LOGWARNING("Rotated sprite is not support now");
-            continue;
-        }
-
         IntRect rectangle = frameInfo["frame"]->GetIntRect();
         Vector2 hotSpot(0.5f, 0.5f);
         IntVector2 offset(0, 0);
@@ -167,7 +171,7 @@ bool SpriteSheet2D::EndLoadFromPListFile()
             hotSpot.y_ = 1.0f - (offset.y_ + sourceSize.y_ / 2.f) / rectangle.Height();
         }
 
-        DefineSprite(name, rectangle, hotSpot, offset);
+        DefineSprite(name, rectangle, hotSpot, offset, frameInfo["rotated"]->GetBool());
     }
 
     loadPListFile_.Reset();
@@ -239,7 +243,7 @@ bool SpriteSheet2D::EndLoadFromXMLFile()
             hotSpot.y_ = 1.0f - (offset.y_ + frameHeight / 2.f) / height;
         }
 
-        DefineSprite(name, rectangle, hotSpot, offset);
+        DefineSprite(name, rectangle, hotSpot, offset, subTextureElem.GetBool("rotated"));
 
         subTextureElem = subTextureElem.GetNext("SubTexture");
     }
@@ -317,7 +321,7 @@ bool SpriteSheet2D::EndLoadFromJSONFile()
             hotSpot.y_ = 1.0f - (offset.y_ + frameHeight / 2.f) / height;
         }
 
-        DefineSprite(name, rectangle, hotSpot, offset);
+        DefineSprite(name, rectangle, hotSpot, offset, subTextureVal.Get("rotated").GetBool());
     }
 
     loadJSONFile_.Reset();
@@ -50,6 +50,8 @@ public:
     const HashMap<String, SharedPtr<Sprite2D>>& GetSpriteMapping() const { return spriteMapping_; }
 
 private:
+    /// Define sprite, optionally stored rotated 90 degrees clockwise. The size of the rectangle is the unrotated image size.
+    void DefineSprite(const String& name, const IntRect& rectangle, const Vector2& hotSpot, const IntVector2& offset, bool rotated);
     /// Begin load from PList file.
     bool BeginLoadFromPListFile(Deserializer& source);
     /// End load from PList file.
@@ -61,7 +61,7 @@ void prepareUVCoords(float coords[4], float low, float high, float lowBorder, fl
 }
 
 void prepareVertices(Vertex2D vtx[4][4], const float xs[4], const float ys[4], const float us[4], const float vs[4], color32 color,
-    const Vector3& position, const Quaternion& rotation)
+    const Vector3& position, const Quaternion& rotation, bool rotated)
 {
     for (unsigned i = 0; i < 4; ++i)
     {
@@ -69,7 +69,7 @@ void prepareVertices(Vertex2D vtx[4][4], const float xs[4], const float ys[4], c
         {
             vtx[i][j].position_ = position + rotation * Vector3{xs[i], ys[j], 0.0f};
             vtx[i][j].color_ = color;
-            vtx[i][j].uv_ = Vector2{us[i], vs[j]};
+            vtx[i][j].uv_ = rotated ? Vector2{vs[j], us[i]} : Vector2{us[i], vs[j]};
         }
     }
 }
@@ -161,13 +161,25 @@ void StretchableSprite2D::UpdateSourceBatches()
     prepareXYCoords(xs, drawRect_.min_.x_, drawRect_.max_.x_, effectiveBorder.min_.x_, effectiveBorder.max_.x_, signedScale.x_);
     prepareXYCoords(ys, drawRect_.min_.y_, drawRect_.max_.y_, effectiveBorder.min_.y_, effectiveBorder.max_.y_, signedScale.y_);
 
-    prepareUVCoords(us, textureRect_.min_.x_, textureRect_.max_.x_, effectiveBorder.min_.x_, effectiveBorder.max_.x_,
-        drawRect_.max_.x_ - drawRect_.min_.x_);
-    prepareUVCoords(vs, textureRect_.min_.y_, textureRect_.max_.y_, -effectiveBorder.min_.y_,
-        -effectiveBorder.max_.y_ /* texture y direction inverted*/, drawRect_.max_.y_ - drawRect_.min_.y_);
+    bool rotated = sprite_->IsRotated();
+    if (!rotated)
+    {
+        prepareUVCoords(us, textureRect_.min_.x_, textureRect_.max_.x_, effectiveBorder.min_.x_, effectiveBorder.max_.x_,
+            drawRect_.max_.x_ - drawRect_.min_.x_);
+        prepareUVCoords(vs, textureRect_.min_.y_, textureRect_.max_.y_, -effectiveBorder.min_.y_,
+            -effectiveBorder.max_.y_ /* texture y direction inverted*/, drawRect_.max_.y_ - drawRect_.min_.y_);
+    }
+    else
+    {
+        /* image stored rotated clockwise: image x runs down the texture, image y runs right */
+        prepareUVCoords(us, textureRect_.max_.y_, textureRect_.min_.y_, effectiveBorder.min_.x_, effectiveBorder.max_.x_,
+            drawRect_.max_.x_ - drawRect_.min_.x_);
+        prepareUVCoords(vs, textureRect_.min_.x_, textureRect_.max_.x_, effectiveBorder.min_.y_, effectiveBorder.max_.y_,
+            drawRect_.max_.y_ - drawRect_.min_.y_);
+    }
 
     Vertex2D vtx[4][4]; // prepare all vertices
-    prepareVertices(vtx, xs, ys, us, vs, color_.ToU32(), node_->GetWorldPosition(), node_->GetWorldRotation());
+    prepareVertices(vtx, xs, ys, us, vs, color_.ToU32(), node_->GetWorldPosition(), node_->GetWorldRotation(), rotated);
 
     pushVertices(vertices, vtx); // push the vertices that make up each patch
 
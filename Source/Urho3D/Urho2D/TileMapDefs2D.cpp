@@ -3,6 +3,8 @@
 
 #include "../Precompiled.h"
 
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
 #include "../Urho2D/TileMapDefs2D.h"
@@ -126,6 +128,26 @@ void PropertySet2D::Load(const XMLElement& element)
         nameToValueMapping_[propertyElem.GetAttribute("name")] = propertyElem.GetAttribute("value");
 }
 
+void PropertySet2D::Load(Deserializer& source)
+{
+    unsigned numProperties = source.ReadVLE();
+    for (unsigned i = 0; i < numProperties && !source.IsEof(); ++i)
+    {
+        String name = source.ReadString();
+        nameToValueMapping_[name] = source.ReadString();
+    }
+}
+
+void PropertySet2D::Save(Serializer& dest) const
+{
+    dest.WriteVLE(nameToValueMapping_.Size());
+    for (HashMap<String, String>::ConstIterator i = nameToValueMapping_.Begin(); i != nameToValueMapping_.End(); ++i)
+    {
+        dest.WriteString(i->first_);
+        dest.WriteString(i->second_);
+    }
+}
+
 bool PropertySet2D::HasProperty(const String& name) const
 {
     return nameToValueMapping_.Find(name) != nameToValueMapping_.End();
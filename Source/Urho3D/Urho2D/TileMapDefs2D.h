@@ -11,6 +11,8 @@
 namespace Urho3D
 {
 
+class Deserializer;
+class Serializer;
 class XMLElement;
 
 /// Orientation.
@@ -94,6 +96,10 @@ public:
 
     /// Load from XML element.
     void Load(const XMLElement& element);
+    /// Load from compiled binary data.
+    void Load(Deserializer& source);
+    /// Save to compiled binary data.
+    void Save(Serializer& dest) const;
     /// Return has property.
     bool HasProperty(const String& name) const;
     /// Return property value.
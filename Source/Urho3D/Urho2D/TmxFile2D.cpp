@@ -4,22 +4,82 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Graphics.h"
 #include "../GraphicsAPI/Texture2D.h"
+#include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../Math/AreaAllocator.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
 #include "../Urho2D/Sprite2D.h"
 #include "../Urho2D/TmxFile2D.h"
 
-#include "../DebugNew.h"
+#include <STB/stb_image.h>
 
+#include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+/// Compiled binary tile map format version. Increment when the layout changes to invalidate cached files.
+static const u32 TMX_BINARY_VERSION = 1;
+/// Minimum size of an object in compiled binary data: type, two empty strings, position, size, point count, GID and property set flag.
+static const unsigned MIN_BINARY_OBJECT_SIZE = 1 + 1 + 1 + 8 + 8 + 1 + 4 + 1;
+
+/// Read an element count from compiled binary data. Return false if the rest of the data is too short to hold that many elements of the given minimum size.
+static bool ReadCount(Deserializer& source, unsigned minElementSize, unsigned& count)
+{
+    count = source.ReadVLE();
+    return (u64)count * minElementSize <= source.GetSize() - source.GetPosition();
+}
+
+/// Log an error about invalid compiled tile map data and return false.
+static bool InvalidBinaryData(const String& name)
+{
+    URHO3D_LOGERROR("Invalid data in compiled tile map " + name);
+    return false;
+}
+
+/// Read a resource file and return its size and hash. Return false if it could not be opened.
+static bool GetResourceFileHash(ResourceCache* cache, const String& name, i32& size, hash32& hash)
+{
+    SharedPtr<File> file = cache->GetFile(name, false);
+    if (!file)
+        return false;
+
+    Vector<byte> data((i32)file->GetSize());
+    if (!data.Empty())
+        file->Read(data.Buffer(), data.Size());
+    size = data.Size();
+    hash = StringHash::CalculateData(data.Buffer(), data.Size());
+    return true;
+}
+
+/// Read the TSX file list of a compiled tile map and return whether all the files are unchanged.
+static bool CheckTsxFiles(Deserializer& source, ResourceCache* cache)
+{
+    unsigned numTsxFiles;
+    if (!ReadCount(source, 9, numTsxFiles))
+        return false;
+
+    for (unsigned i = 0; i < numTsxFiles; ++i)
+    {
+        String name = source.ReadString();
+        i32 size = source.ReadI32();
+        hash32 hash = source.ReadU32();
+
+        i32 currentSize;
+        hash32 currentHash;
+        if (!GetResourceFileHash(cache, name, currentSize, currentHash) || currentSize != size || currentHash != hash)
+            return false;
+    }
+
+    return !source.IsEof();
+}
+
 TmxLayer2D::TmxLayer2D(TmxFile2D* tmxFile, TileMapLayerType2D type) :
     tmxFile_(tmxFile),
     type_(type)
@@ -62,6 +122,30 @@ void TmxLayer2D::LoadPropertySet(const XMLElement& element)
     propertySet_->Load(element);
 }
 
+void TmxLayer2D::LoadInfo(Deserializer& source)
+{
+    name_ = source.ReadString();
+    width_ = source.ReadI32();
+    height_ = source.ReadI32();
+    visible_ = source.ReadBool();
+    if (source.ReadBool())
+    {
+        propertySet_ = new PropertySet2D();
+        propertySet_->Load(source);
+    }
+}
+
+void TmxLayer2D::SaveInfo(Serializer& dest) const
+{
+    dest.WriteString(name_);
+    dest.WriteI32(width_);
+    dest.WriteI32(height_);
+    dest.WriteBool(visible_);
+    dest.WriteBool(propertySet_.NotNull());
+    if (propertySet_)
+        propertySet_->Save(dest);
+}
+
 TmxTileLayer2D::TmxTileLayer2D(TmxFile2D* tmxFile) :
     TmxLayer2D(tmxFile, LT_TILE_LAYER)
 {
@@ -73,10 +157,32 @@ enum LayerEncoding {
     Base64,
 };
 
-bool TmxTileLayer2D::Load(const XMLElement& element, const TileMapInfo2D& info)
+enum LayerCompression {
+    NoCompression,
+    Zlib,
+    Gzip,
+};
+
+/// Tile layer data read from XML. CSV and Base64 text is decoded separately, so that it can be done in worker threads.
+struct TileLayerData
 {
-    LoadInfo(element);
+    /// Encoding.
+    LayerEncoding encoding_;
+    /// Compression of Base64 data.
+    LayerCompression compression_;
+    /// Number of tiles.
+    i32 numTiles_;
+    /// Text of the data element for CSV and Base64 encodings.
+    String text_;
+    /// Decoded GIDs in row order.
+    Vector<u32>* gids_;
+    /// Decoding success flag.
+    bool success_;
+};
 
+/// Read the tile data of a layer element. Tiles stored as XML elements are decoded right away. Return true if successful.
+static bool ReadTileLayerData(const XMLElement& element, TileLayerData& data)
+{
     XMLElement dataElem = element.GetChild("data");
     if (!dataElem)
     {
@@ -84,22 +190,30 @@ bool TmxTileLayer2D::Load(const XMLElement& element, const TileMapInfo2D& info)
         return false;
     }
 
-    LayerEncoding encoding;
+    data.compression_ = NoCompression;
     if (dataElem.HasAttribute("compression"))
     {
-        URHO3D_LOGERROR("Compression not supported now");
-        return false;
+        String compressionAttribute = dataElem.GetAttribute("compression");
+        if (compressionAttribute == "zlib")
+            data.compression_ = Zlib;
+        else if (compressionAttribute == "gzip")
+            data.compression_ = Gzip;
+        else
+        {
+            URHO3D_LOGERROR("Compression not supported: " + compressionAttribute);
+            return false;
+        }
     }
 
     if (dataElem.HasAttribute("encoding"))
     {
         String encodingAttribute = dataElem.GetAttribute("encoding");
         if (encodingAttribute == "xml")
-            encoding = XML;
+            data.encoding_ = XML;
         else if (encodingAttribute == "csv")
-            encoding = CSV;
+            data.encoding_ = CSV;
         else if (encodingAttribute == "base64")
-            encoding = Base64;
+            data.encoding_ = Base64;
         else
         {
             URHO3D_LOGERROR("Invalid encoding: " + encodingAttribute);
@@ -107,94 +221,251 @@ bool TmxTileLayer2D::Load(const XMLElement& element, const TileMapInfo2D& info)
         }
     }
     else
-        encoding = XML;
+        data.encoding_ = XML;
 
-    tiles_.Resize((unsigned)(width_ * height_));
-    if (encoding == XML)
+    if (data.compression_ != NoCompression && data.encoding_ != Base64)
     {
-        XMLElement tileElem = dataElem.GetChild("tile");
+        URHO3D_LOGERROR("Compressed tile data must be Base64 encoded");
+        return false;
+    }
 
-        for (int y = 0; y < height_; ++y)
-        {
-            for (int x = 0; x < width_; ++x)
-            {
-                if (!tileElem)
-                    return false;
+    data.numTiles_ = Max(element.GetI32("width"), 0) * Max(element.GetI32("height"), 0);
+    data.gids_->Resize(data.numTiles_);
 
-                unsigned gid = tileElem.GetU32("gid");
-                if (gid > 0)
-                {
-                    SharedPtr<Tile2D> tile(new Tile2D());
-                    tile->gid_ = gid;
-                    tile->sprite_ = tmxFile_->GetTileSprite(gid & ~FLIP_ALL);
-                    tile->propertySet_ = tmxFile_->GetTilePropertySet(gid & ~FLIP_ALL);
-                    tiles_[y * width_ + x] = tile;
-                }
+    if (data.encoding_ != XML)
+    {
+        data.text_ = dataElem.GetValue();
+        return true;
+    }
 
-                tileElem = tileElem.GetNext("tile");
-            }
+    u32* gids = data.gids_->Buffer();
+    XMLElement tileElem = dataElem.GetChild("tile");
+    for (i32 i = 0; i < data.numTiles_; ++i)
+    {
+        if (!tileElem)
+            return false;
+
+        gids[i] = tileElem.GetU32("gid");
+        tileElem = tileElem.GetNext("tile");
+    }
+
+    return true;
+}
+
+/// Decompress zlib or gzip compressed tile data in place. Return true if successful.
+static bool DecompressTileData(Vector<unsigned char>& buffer, LayerCompression compression, i32 size)
+{
+    const char* input = reinterpret_cast<const char*>(buffer.Buffer());
+    i32 inputSize = buffer.Size();
+
+    // A gzip stream is a raw deflate stream after a header with optional fields
+    if (compression == Gzip)
+    {
+        if (inputSize < 18 || buffer[0] != 0x1f || buffer[1] != 0x8b || buffer[2] != 8)
+            return false;
+
+        unsigned char flags = buffer[3];
+        i32 pos = 10;
+        if (flags & 0x04)
+            pos += 2 + (buffer[pos] | (buffer[pos + 1] << 8));
+        if (flags & 0x08)
+        {
+            while (pos < inputSize && buffer[pos])
+                ++pos;
+            ++pos;
+        }
+        if (flags & 0x10)
+        {
+            while (pos < inputSize && buffer[pos])
+                ++pos;
+            ++pos;
         }
+        if (flags & 0x02)
+            pos += 2;
+
+        // The stream ends with a CRC and the uncompressed size
+        if (pos > inputSize - 8)
+            return false;
+
+        input += pos;
+        inputSize -= pos + 8;
     }
-    else if (encoding == CSV)
+
+    Vector<unsigned char> output(size);
+    if (size)
     {
-        String dataValue = dataElem.GetValue();
-        Vector<String> gidVector = dataValue.Split(',');
-        int currentIndex = 0;
-        for (int y = 0; y < height_; ++y)
+        char* dest = reinterpret_cast<char*>(output.Buffer());
+        i32 outputSize = compression == Gzip ? stbi_zlib_decode_noheader_buffer(dest, size, input, inputSize) :
+            stbi_zlib_decode_buffer(dest, size, input, inputSize);
+        if (outputSize != size)
+            return false;
+    }
+
+    buffer.Swap(output);
+    return true;
+}
+
+/// Decode CSV or Base64 tile data read by ReadTileLayerData(). Return true if successful.
+static bool DecodeTileLayerText(TileLayerData& data)
+{
+    u32* gids = data.gids_->Buffer();
+    const String& text = data.text_;
+
+    if (data.encoding_ == CSV)
+    {
+        // Parse in place, as splitting into strings would allocate for every tile
+        const char* ptr = text.CString();
+        for (i32 i = 0; i < data.numTiles_; ++i)
         {
-            for (int x = 0; x < width_; ++x)
+            if (!*ptr)
             {
-                gidVector[currentIndex].Replace("\n", "");
-                unsigned gid = ToU32(gidVector[currentIndex]);
-                if (gid > 0)
-                {
-                    SharedPtr<Tile2D> tile(new Tile2D());
-                    tile->gid_ = gid;
-                    tile->sprite_ = tmxFile_->GetTileSprite(gid & ~FLIP_ALL);
-                    tile->propertySet_ = tmxFile_->GetTilePropertySet(gid & ~FLIP_ALL);
-                    tiles_[y * width_ + x] = tile;
-                }
-                ++currentIndex;
+                URHO3D_LOGERROR("Not enough tile data in layer");
+                return false;
             }
+
+            while (*ptr == ' ' || *ptr == '\t' || *ptr == '\r' || *ptr == '\n')
+                ++ptr;
+
+            u32 gid = 0;
+            while (IsDigit((unsigned)*ptr))
+                gid = gid * 10 + (u32)(*ptr++ - '0');
+            gids[i] = gid;
+
+            while (*ptr && *ptr != ',')
+                ++ptr;
+            if (*ptr)
+                ++ptr;
         }
     }
-    else if (encoding == Base64)
+    else
     {
-        String dataValue = dataElem.GetValue();
-        int startPosition = 0;
-        while (!IsAlpha(dataValue[startPosition]) && !IsDigit(dataValue[startPosition])
-              && dataValue[startPosition] != '+' && dataValue[startPosition] != '/') ++startPosition;
-        dataValue = dataValue.Substring(startPosition);
-        Vector<unsigned char> buffer = DecodeBase64(dataValue);
-        int currentIndex = 0;
-        for (int y = 0; y < height_; ++y)
+        i32 startPosition = 0;
+        while (startPosition < text.Length() && !IsAlpha(text[startPosition]) && !IsDigit(text[startPosition])
+              && text[startPosition] != '+' && text[startPosition] != '/') ++startPosition;
+        Vector<unsigned char> buffer = DecodeBase64(text.Substring(startPosition));
+        if (data.compression_ != NoCompression && !DecompressTileData(buffer, data.compression_, data.numTiles_ * 4))
         {
-            for (int x = 0; x < width_; ++x)
-            {
-                // buffer contains 32-bit integers in little-endian format
-                unsigned gid = ((unsigned)buffer[currentIndex+3] << 24u)
-                             | ((unsigned)buffer[currentIndex+2] << 16u)
-                             | ((unsigned)buffer[currentIndex+1] << 8u)
-                             | (unsigned)buffer[currentIndex];
-                if (gid > 0)
-                {
-                    SharedPtr<Tile2D> tile(new Tile2D());
-                    tile->gid_ = gid;
-                    tile->sprite_ = tmxFile_->GetTileSprite(gid & ~FLIP_ALL);
-                    tile->propertySet_ = tmxFile_->GetTilePropertySet(gid & ~FLIP_ALL);
-                    tiles_[y * width_ + x] = tile;
-                }
-                currentIndex += 4;
-            }
+            URHO3D_LOGERROR("Could not decompress tile data in layer");
+            return false;
+        }
+
+        if (buffer.Size() < data.numTiles_ * 4)
+        {
+            URHO3D_LOGERROR("Not enough tile data in layer");
+            return false;
+        }
+
+        for (i32 i = 0; i < data.numTiles_; ++i)
+        {
+            // buffer contains 32-bit integers in little-endian format
+            const unsigned char* bytes = &buffer[i * 4];
+            gids[i] = ((u32)bytes[3] << 24u) | ((u32)bytes[2] << 16u) | ((u32)bytes[1] << 8u) | (u32)bytes[0];
         }
     }
 
+    return true;
+}
+
+static void DecodeTileLayerWork(const WorkItem* item, i32 /*threadIndex*/)
+{
+    auto* data = reinterpret_cast<TileLayerData*>(item->start_);
+    if (data->encoding_ != XML)
+        data->success_ = DecodeTileLayerText(*data);
+}
+
+bool TmxTileLayer2D::Load(const XMLElement& element, const TileMapInfo2D& info)
+{
+    Vector<u32> gids;
+    if (!DecodeTileData(element, gids))
+        return false;
+
+    return Load(element, gids);
+}
+
+bool TmxTileLayer2D::Load(const XMLElement& element, const Vector<u32>& gids)
+{
+    LoadInfo(element);
+    SetTiles(gids);
+
     if (element.HasChild("properties"))
         LoadPropertySet(element.GetChild("properties"));
 
     return true;
 }
 
+bool TmxTileLayer2D::LoadBinary(Deserializer& source)
+{
+    LoadInfo(source);
+
+    // GIDs are stored as one block in row order
+    i64 numTiles = (i64)Max(width_, 0) * Max(height_, 0);
+    if (numTiles * (i64)sizeof(u32) > (i64)(source.GetSize() - source.GetPosition()))
+    {
+        URHO3D_LOGERROR("Not enough tile data in layer " + name_);
+        return false;
+    }
+
+    Vector<u32> gids((i32)numTiles);
+    if (!gids.Empty())
+    {
+        i32 dataSize = gids.Size() * (i32)sizeof(u32);
+        if (source.Read(gids.Buffer(), dataSize) != dataSize)
+        {
+            URHO3D_LOGERROR("Not enough tile data in layer " + name_);
+            return false;
+        }
+    }
+
+    SetTiles(gids);
+    return true;
+}
+
+void TmxTileLayer2D::SaveBinary(Serializer& dest) const
+{
+    SaveInfo(dest);
+
+    Vector<u32> gids(Max(width_, 0) * Max(height_, 0));
+    for (i32 i = 0; i < gids.Size(); ++i)
+        gids[i] = i < tiles_.Size() && tiles_[i] ? tiles_[i]->gid_ : 0;
+    if (!gids.Empty())
+        dest.Write(gids.Buffer(), gids.Size() * (i32)sizeof(u32));
+}
+
+bool TmxTileLayer2D::DecodeTileData(const XMLElement& element, Vector<u32>& gids)
+{
+    TileLayerData data;
+    data.gids_ = &gids;
+    if (!ReadTileLayerData(element, data))
+        return false;
+
+    return data.encoding_ == XML || DecodeTileLayerText(data);
+}
+
+void TmxTileLayer2D::SetTiles(const Vector<u32>& gids)
+{
+    tiles_.Clear();
+    tiles_.Resize(Max(width_, 0) * Max(height_, 0));
+
+    // Cells with the same GID share a tile, so that the sprite and property set are looked up once per GID
+    HashMap<u32, SharedPtr<Tile2D>> gidTiles;
+    for (i32 i = 0; i < tiles_.Size() && i < gids.Size(); ++i)
+    {
+        u32 gid = gids[i];
+        if (!gid)
+            continue;
+
+        SharedPtr<Tile2D>& tile = gidTiles[gid];
+        if (!tile)
+        {
+            tile = new Tile2D();
+            tile->gid_ = gid;
+            tile->sprite_ = tmxFile_->GetTileSprite(gid & ~FLIP_ALL);
+            tile->propertySet_ = tmxFile_->GetTilePropertySet(gid & ~FLIP_ALL);
+        }
+        tiles_[i] = tile;
+    }
+}
+
 Tile2D* TmxTileLayer2D::GetTile(int x, int y) const
 {
     if (x < 0 || x >= width_ || y < 0 || y >= height_)
@@ -225,6 +496,34 @@ bool TmxObjectGroup2D::Load(const XMLElement& element, const TileMapInfo2D& info
     return true;
 }
 
+bool TmxObjectGroup2D::LoadBinary(Deserializer& source)
+{
+    LoadInfo(source);
+
+    unsigned numObjects;
+    if (!ReadCount(source, MIN_BINARY_OBJECT_SIZE, numObjects))
+        return false;
+
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        SharedPtr<TileMapObject2D> object(new TileMapObject2D());
+        if (!ReadObject(source, object))
+            return false;
+        objects_.Push(object);
+    }
+
+    return true;
+}
+
+void TmxObjectGroup2D::SaveBinary(Serializer& dest) const
+{
+    SaveInfo(dest);
+
+    dest.WriteVLE(objects_.Size());
+    for (const SharedPtr<TileMapObject2D>& object : objects_)
+        WriteObject(dest, object);
+}
+
 void TmxObjectGroup2D::StoreObject(const XMLElement& objectElem, const SharedPtr<TileMapObject2D>& object, const TileMapInfo2D& info, bool isTile)
 {
         if (objectElem.HasAttribute("name"))
@@ -303,6 +602,55 @@ void TmxObjectGroup2D::StoreObject(const XMLElement& objectElem, const SharedPtr
         }
 }
 
+bool TmxObjectGroup2D::ReadObject(Deserializer& source, TileMapObject2D* object)
+{
+    // Positions, sizes and points are stored already converted
+    object->objectType_ = (TileMapObjectType2D)source.ReadU8();
+    object->name_ = source.ReadString();
+    object->type_ = source.ReadString();
+    object->position_ = source.ReadVector2();
+    object->size_ = source.ReadVector2();
+
+    unsigned numPoints;
+    if (!ReadCount(source, sizeof(Vector2), numPoints))
+        return false;
+
+    object->points_.Resize(numPoints);
+    for (Vector2& point : object->points_)
+        point = source.ReadVector2();
+
+    object->gid_ = source.ReadU32();
+    if (object->objectType_ == OT_TILE)
+        object->sprite_ = tmxFile_->GetTileSprite(object->gid_ & ~FLIP_ALL);
+
+    if (source.ReadBool())
+    {
+        object->propertySet_ = new PropertySet2D();
+        object->propertySet_->Load(source);
+    }
+
+    return true;
+}
+
+void TmxObjectGroup2D::WriteObject(Serializer& dest, const TileMapObject2D* object)
+{
+    dest.WriteU8((u8)object->objectType_);
+    dest.WriteString(object->name_);
+    dest.WriteString(object->type_);
+    dest.WriteVector2(object->position_);
+    dest.WriteVector2(object->size_);
+
+    dest.WriteVLE(object->points_.Size());
+    for (const Vector2& point : object->points_)
+        dest.WriteVector2(point);
+
+    dest.WriteU32(object->gid_);
+
+    dest.WriteBool(object->propertySet_.NotNull());
+    if (object->propertySet_)
+        object->propertySet_->Save(dest);
+}
+
 TileMapObject2D* TmxObjectGroup2D::GetObject(unsigned index) const
 {
     if (index >= objects_.Size())
@@ -326,6 +674,34 @@ bool TmxImageLayer2D::Load(const XMLElement& element, const TileMapInfo2D& info)
 
     position_ = Vector2(0.0f, info.GetMapHeight());
     source_ = imageElem.GetAttribute("source");
+    if (!LoadSprite())
+        return false;
+
+    if (element.HasChild("properties"))
+        LoadPropertySet(element.GetChild("properties"));
+
+    return true;
+}
+
+bool TmxImageLayer2D::LoadBinary(Deserializer& source)
+{
+    LoadInfo(source);
+
+    position_ = source.ReadVector2();
+    source_ = source.ReadString();
+    return LoadSprite();
+}
+
+void TmxImageLayer2D::SaveBinary(Serializer& dest) const
+{
+    SaveInfo(dest);
+
+    dest.WriteVector2(position_);
+    dest.WriteString(source_);
+}
+
+bool TmxImageLayer2D::LoadSprite()
+{
     String textureFilePath = GetParentPath(tmxFile_->GetName()) + source_;
     auto* cache = tmxFile_->GetSubsystem<ResourceCache>();
     SharedPtr<Texture2D> texture(cache->GetResource<Texture2D>(textureFilePath));
@@ -340,10 +716,6 @@ bool TmxImageLayer2D::Load(const XMLElement& element, const TileMapInfo2D& info)
     sprite_->SetRectangle(IntRect(0, 0, texture->GetWidth(), texture->GetHeight()));
     // Set image hot spot at left top
     sprite_->SetHotSpot(Vector2(0.0f, 1.0f));
-
-    if (element.HasChild("properties"))
-        LoadPropertySet(element.GetChild("properties"));
-
     return true;
 }
 
@@ -374,6 +746,27 @@ bool TmxFile2D::BeginLoad(Deserializer& source)
     if (GetName().Empty())
         SetName(source.GetName());
 
+    saveCacheFileName_.Clear();
+    tsxFileNames_.Clear();
+
+    // Compiled binary tile maps need no parsing
+    i64 start = source.GetPosition();
+    String fileID = source.ReadFileID();
+    source.Seek(start);
+    if (fileID == "UTMX")
+        return BeginLoadBinary(source);
+
+    String cacheFileName = GetSubsystem<ResourceCache>()->GetCompiledCacheFileName(GetName(), ".utmx");
+    if (!cacheFileName.Empty())
+        return BeginLoadCached(source, cacheFileName);
+
+    return BeginLoadXML(source);
+}
+
+bool TmxFile2D::BeginLoadXML(Deserializer& source)
+{
+    loadBinaryData_.Clear();
+
     loadXMLFile_ = new XMLFile(context_);
     if (!loadXMLFile_->Load(source))
     {
@@ -424,14 +817,153 @@ bool TmxFile2D::BeginLoad(Deserializer& source)
         }
     }
 
+    // Tile data does not depend on the tile sets, so decode it here rather than in EndLoad()
+    if (!DecodeTileLayers(rootElem))
+    {
+        loadXMLFile_.Reset();
+        loadTileLayerGids_.Clear();
+        return false;
+    }
+
     return true;
 }
 
-bool TmxFile2D::EndLoad()
+bool TmxFile2D::BeginLoadBinary(Deserializer& source)
 {
-    if (!loadXMLFile_)
+    loadXMLFile_.Reset();
+    loadTileLayerGids_.Clear();
+
+    loadBinaryData_.Resize((i32)(source.GetSize() - source.GetPosition()));
+    if (!loadBinaryData_.Empty())
+        source.Read(loadBinaryData_.Buffer(), loadBinaryData_.Size());
+
+    MemoryBuffer buffer(loadBinaryData_);
+    if (buffer.ReadFileID() != "UTMX" || buffer.ReadU32() != TMX_BINARY_VERSION)
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid compiled tile map file");
+        loadBinaryData_.Clear();
         return false;
+    }
+
+    // If we're async loading, request the textures and tile atlas images now. Finish during EndLoad().
+    if (GetAsyncLoadState() == ASYNC_LOADING)
+    {
+        auto* cache = GetSubsystem<ResourceCache>();
+
+        // Invalid counts are reported by LoadBinary() in EndLoad()
+        buffer.ReadString();
+        buffer.ReadI32();
+        buffer.ReadU32();
+        unsigned numTsxFiles;
+        if (!ReadCount(buffer, 9, numTsxFiles))
+            return true;
+        for (unsigned i = 0; i < numTsxFiles; ++i)
+        {
+            buffer.ReadString();
+            buffer.ReadI32();
+            buffer.ReadU32();
+        }
+        buffer.ReadU8();
+        buffer.ReadI32();
+        buffer.ReadI32();
+        buffer.ReadFloat();
+        buffer.ReadFloat();
+
+        unsigned numTextures;
+        if (!ReadCount(buffer, 1, numTextures))
+            return true;
+        for (unsigned i = 0; i < numTextures; ++i)
+            cache->BackgroundLoadResource<Texture2D>(buffer.ReadString(), true, this);
+
+        unsigned numAtlases;
+        if (!ReadCount(buffer, 9, numAtlases))
+            return true;
+        for (unsigned i = 0; i < numAtlases; ++i)
+        {
+            buffer.ReadIntVector2();
+            unsigned numImages;
+            if (!ReadCount(buffer, 9, numImages))
+                return true;
+            for (unsigned j = 0; j < numImages; ++j)
+            {
+                cache->BackgroundLoadResource<Image>(buffer.ReadString(), false, this);
+                buffer.ReadIntVector2();
+            }
+        }
+    }
+
+    return true;
+}
+
+bool TmxFile2D::BeginLoadCached(Deserializer& source, const String& cacheFileName)
+{
+    Vector<byte> sourceData((i32)source.GetSize());
+    if (!sourceData.Empty())
+        source.Read(sourceData.Buffer(), sourceData.Size());
+    hash32 sourceHash = StringHash::CalculateData(sourceData.Buffer(), sourceData.Size());
 
+    if (GetSubsystem<FileSystem>()->FileExists(cacheFileName))
+    {
+        File cacheFile(context_, cacheFileName);
+        if (cacheFile.ReadFileID() == "UTMX" && cacheFile.ReadU32() == TMX_BINARY_VERSION &&
+            cacheFile.ReadString() == GetName() && cacheFile.ReadI32() == sourceData.Size() && cacheFile.ReadU32() == sourceHash &&
+            CheckTsxFiles(cacheFile, GetSubsystem<ResourceCache>()))
+        {
+            cacheFile.Seek(0);
+            if (BeginLoadBinary(cacheFile))
+                return true;
+        }
+    }
+
+    // Missing or stale cache, load the source instead
+    MemoryBuffer sourceBuffer(sourceData);
+    sourceBuffer.SetName(source.GetName());
+    if (!BeginLoadXML(sourceBuffer))
+        return false;
+
+    saveCacheFileName_ = cacheFileName;
+    sourceHash_ = sourceHash;
+    sourceSize_ = sourceData.Size();
+    return true;
+}
+
+bool TmxFile2D::EndLoad()
+{
+    for (const TmxLayer2D* layer : layers_)
+        delete layer;
+    layers_.Clear();
+    gidToSpriteMapping_.Clear();
+    gidToPropertySetMapping_.Clear();
+    gidToCollisionShapeMapping_.Clear();
+    tileAtlases_.Clear();
+
+    bool success = false;
+    if (loadXMLFile_)
+        success = EndLoadXML();
+    else if (!loadBinaryData_.Empty())
+    {
+        MemoryBuffer buffer(loadBinaryData_);
+        success = LoadBinary(buffer);
+    }
+
+    // Write the compiled cache now that the tile sets have been resolved
+    if (success && !saveCacheFileName_.Empty())
+    {
+        File cacheFile(context_);
+        if (cacheFile.Open(saveCacheFileName_, FILE_WRITE))
+            SaveBinary(cacheFile, sourceHash_, sourceSize_);
+    }
+
+    loadXMLFile_.Reset();
+    tsxXMLFiles_.Clear();
+    loadTileLayerGids_.Clear();
+    loadBinaryData_.Clear();
+    saveCacheFileName_.Clear();
+    return success;
+}
+
+bool TmxFile2D::EndLoadXML()
+{
     XMLElement rootElem = loadXMLFile_->GetRoot("map");
     String version = rootElem.GetAttribute("version");
     if (!version.StartsWith("1."))
@@ -460,10 +992,7 @@ bool TmxFile2D::EndLoad()
     info_.tileWidth_ = rootElem.GetFloat("tilewidth") * PIXEL_SIZE;
     info_.tileHeight_ = rootElem.GetFloat("tileheight") * PIXEL_SIZE;
 
-    for (const TmxLayer2D* layer : layers_)
-        delete layer;
-    layers_.Clear();
-
+    i32 tileLayerIndex = 0;
     for (XMLElement childElement = rootElem.GetChild(); childElement; childElement = childElement.GetNext())
     {
         bool ret = true;
@@ -473,7 +1002,7 @@ bool TmxFile2D::EndLoad()
         else if (name == "layer")
         {
             auto* tileLayer = new TmxTileLayer2D(this);
-            ret = tileLayer->Load(childElement, info_);
+            ret = tileLayer->Load(childElement, loadTileLayerGids_[tileLayerIndex++]);
 
             layers_.Push(tileLayer);
         }
@@ -494,15 +1023,344 @@ bool TmxFile2D::EndLoad()
         }
 
         if (!ret)
+            return false;
+    }
+
+    return true;
+}
+
+bool TmxFile2D::LoadBinary(Deserializer& source)
+{
+    // Header was validated in BeginLoad()
+    source.ReadFileID();
+    source.ReadU32();
+    source.ReadString();
+    source.ReadI32();
+    source.ReadU32();
+
+    // Counts are checked against the remaining data, so that corrupt data can not cause huge allocations or loops
+    unsigned numTsxFiles;
+    if (!ReadCount(source, 9, numTsxFiles))
+        return InvalidBinaryData(GetName());
+    for (unsigned i = 0; i < numTsxFiles; ++i)
+    {
+        tsxFileNames_.Push(source.ReadString());
+        source.ReadI32();
+        source.ReadU32();
+    }
+
+    info_.orientation_ = (Orientation2D)source.ReadU8();
+    info_.width_ = source.ReadI32();
+    info_.height_ = source.ReadI32();
+    info_.tileWidth_ = source.ReadFloat();
+    info_.tileHeight_ = source.ReadFloat();
+
+    // Tile sprites refer to textures by index, loaded textures first and then tile atlases
+    auto* cache = GetSubsystem<ResourceCache>();
+    Vector<SharedPtr<Texture2D>> textures;
+    unsigned numTextures;
+    if (!ReadCount(source, 1, numTextures))
+        return InvalidBinaryData(GetName());
+    for (unsigned i = 0; i < numTextures; ++i)
+        textures.Push(SharedPtr<Texture2D>(cache->GetResource<Texture2D>(source.ReadString())));
+
+    unsigned numAtlases;
+    if (!ReadCount(source, 9, numAtlases))
+        return InvalidBinaryData(GetName());
+    for (unsigned i = 0; i < numAtlases; ++i)
+    {
+        TileAtlas atlas;
+        atlas.size_ = source.ReadIntVector2();
+        unsigned numImages;
+        if (!ReadCount(source, 9, numImages))
+            return InvalidBinaryData(GetName());
+        for (unsigned j = 0; j < numImages; ++j)
         {
-            loadXMLFile_.Reset();
-            tsxXMLFiles_.Clear();
+            String imageName = source.ReadString();
+            atlas.images_.Push(MakePair(imageName, source.ReadIntVector2()));
+        }
+
+        if (!CreateTileAtlasTexture(atlas))
+            return false;
+
+        textures.Push(atlas.texture_);
+        tileAtlases_.Push(atlas);
+    }
+
+    // GID, texture index, rectangle and hot spot
+    unsigned numSprites;
+    if (!ReadCount(source, 4 + 1 + 16 + 8, numSprites))
+        return InvalidBinaryData(GetName());
+    for (unsigned i = 0; i < numSprites; ++i)
+    {
+        unsigned gid = source.ReadU32();
+        unsigned textureIndex = source.ReadVLE();
+        IntRect rectangle = source.ReadIntRect();
+        Vector2 hotSpot = source.ReadVector2();
+        if (textureIndex >= (unsigned)textures.Size() || !textures[textureIndex])
+        {
+            URHO3D_LOGERROR("Could not load tile set texture for " + GetName());
             return false;
         }
+
+        SharedPtr<Sprite2D> sprite(new Sprite2D(context_));
+        sprite->SetTexture(textures[textureIndex]);
+        sprite->SetRectangle(rectangle);
+        sprite->SetHotSpot(hotSpot);
+        gidToSpriteMapping_[gid] = sprite;
+    }
+
+    unsigned numPropertySets;
+    if (!ReadCount(source, 5, numPropertySets))
+        return InvalidBinaryData(GetName());
+    for (unsigned i = 0; i < numPropertySets; ++i)
+    {
+        unsigned gid = source.ReadU32();
+        SharedPtr<PropertySet2D> propertySet(new PropertySet2D());
+        propertySet->Load(source);
+        gidToPropertySetMapping_[gid] = propertySet;
+    }
+
+    TmxObjectGroup2D objectGroup(this);
+    unsigned numCollisionShapeSets;
+    if (!ReadCount(source, 5, numCollisionShapeSets))
+        return InvalidBinaryData(GetName());
+    for (unsigned i = 0; i < numCollisionShapeSets; ++i)
+    {
+        unsigned gid = source.ReadU32();
+        unsigned numObjects;
+        if (!ReadCount(source, MIN_BINARY_OBJECT_SIZE, numObjects))
+            return InvalidBinaryData(GetName());
+
+        Vector<SharedPtr<TileMapObject2D>>& objects = gidToCollisionShapeMapping_[gid];
+        objects.Resize(numObjects);
+        for (SharedPtr<TileMapObject2D>& object : objects)
+        {
+            object = new TileMapObject2D();
+            if (!objectGroup.ReadObject(source, object))
+                return InvalidBinaryData(GetName());
+        }
+    }
+
+    unsigned numLayers;
+    if (!ReadCount(source, 1, numLayers))
+        return InvalidBinaryData(GetName());
+    for (unsigned i = 0; i < numLayers; ++i)
+    {
+        bool ret;
+        auto type = (TileMapLayerType2D)source.ReadU8();
+        if (type == LT_TILE_LAYER)
+        {
+            auto* tileLayer = new TmxTileLayer2D(this);
+            ret = tileLayer->LoadBinary(source);
+
+            layers_.Push(tileLayer);
+        }
+        else if (type == LT_OBJECT_GROUP)
+        {
+            auto* objectGroup = new TmxObjectGroup2D(this);
+            ret = objectGroup->LoadBinary(source);
+
+            layers_.Push(objectGroup);
+        }
+        else if (type == LT_IMAGE_LAYER)
+        {
+            auto* imageLayer = new TmxImageLayer2D(this);
+            ret = imageLayer->LoadBinary(source);
+
+            layers_.Push(imageLayer);
+        }
+        else
+        {
+            URHO3D_LOGERROR("Invalid layer type in compiled tile map " + GetName());
+            ret = false;
+        }
+
+        if (!ret)
+            return false;
+    }
+
+    return true;
+}
+
+bool TmxFile2D::SaveBinary(Serializer& dest, hash32 sourceHash, i32 sourceSize) const
+{
+    if (!dest.WriteFileID("UTMX"))
+    {
+        URHO3D_LOGERROR("Can not save compiled tile map");
+        return false;
+    }
+
+    dest.WriteU32(TMX_BINARY_VERSION);
+    dest.WriteString(GetName());
+    dest.WriteI32(sourceSize);
+    dest.WriteU32(sourceHash);
+
+    // Changed TSX files invalidate the compiled cache as well
+    auto* cache = GetSubsystem<ResourceCache>();
+    dest.WriteVLE(tsxFileNames_.Size());
+    for (const String& tsxFileName : tsxFileNames_)
+    {
+        i32 size = 0;
+        hash32 hash = 0;
+        GetResourceFileHash(cache, tsxFileName, size, hash);
+        dest.WriteString(tsxFileName);
+        dest.WriteI32(size);
+        dest.WriteU32(hash);
+    }
+
+    dest.WriteU8((u8)info_.orientation_);
+    dest.WriteI32(info_.width_);
+    dest.WriteI32(info_.height_);
+    dest.WriteFloat(info_.tileWidth_);
+    dest.WriteFloat(info_.tileHeight_);
+
+    // Loaded textures first, then the tile atlases. Image layer textures are listed so that asynchronous loading can
+    // request them early
+    Vector<String> textureNames;
+    HashMap<Texture2D*, unsigned> textureIndices;
+    for (HashMap<unsigned, SharedPtr<Sprite2D>>::ConstIterator i = gidToSpriteMapping_.Begin(); i != gidToSpriteMapping_.End(); ++i)
+    {
+        Texture2D* texture = i->second_->GetTexture();
+        if (texture && !texture->GetName().Empty() && !textureIndices.Contains(texture))
+        {
+            textureIndices[texture] = textureNames.Size();
+            textureNames.Push(texture->GetName());
+        }
+    }
+    for (const TmxLayer2D* layer : layers_)
+    {
+        if (layer->GetType() != LT_IMAGE_LAYER)
+            continue;
+
+        Sprite2D* sprite = static_cast<const TmxImageLayer2D*>(layer)->GetSprite();
+        if (sprite && sprite->GetTexture())
+            textureNames.Push(sprite->GetTexture()->GetName());
+    }
+    for (i32 i = 0; i < tileAtlases_.Size(); ++i)
+        textureIndices[tileAtlases_[i].texture_] = textureNames.Size() + i;
+
+    dest.WriteVLE(textureNames.Size());
+    for (const String& textureName : textureNames)
+        dest.WriteString(textureName);
+
+    dest.WriteVLE(tileAtlases_.Size());
+    for (const TileAtlas& atlas : tileAtlases_)
+    {
+        dest.WriteIntVector2(atlas.size_);
+        dest.WriteVLE(atlas.images_.Size());
+        for (const Pair<String, IntVector2>& image : atlas.images_)
+        {
+            dest.WriteString(image.first_);
+            dest.WriteIntVector2(image.second_);
+        }
+    }
+
+    unsigned numSprites = 0;
+    for (HashMap<unsigned, SharedPtr<Sprite2D>>::ConstIterator i = gidToSpriteMapping_.Begin(); i != gidToSpriteMapping_.End(); ++i)
+    {
+        if (textureIndices.Contains(i->second_->GetTexture()))
+            ++numSprites;
+    }
+
+    dest.WriteVLE(numSprites);
+    for (HashMap<unsigned, SharedPtr<Sprite2D>>::ConstIterator i = gidToSpriteMapping_.Begin(); i != gidToSpriteMapping_.End(); ++i)
+    {
+        Sprite2D* sprite = i->second_;
+        HashMap<Texture2D*, unsigned>::ConstIterator j = textureIndices.Find(sprite->GetTexture());
+        if (j == textureIndices.End())
+            continue;
+
+        dest.WriteU32(i->first_);
+        dest.WriteVLE(j->second_);
+        dest.WriteIntRect(sprite->GetRectangle());
+        dest.WriteVector2(sprite->GetHotSpot());
+    }
+
+    dest.WriteVLE(gidToPropertySetMapping_.Size());
+    for (HashMap<unsigned, SharedPtr<PropertySet2D>>::ConstIterator i = gidToPropertySetMapping_.Begin();
+         i != gidToPropertySetMapping_.End(); ++i)
+    {
+        dest.WriteU32(i->first_);
+        i->second_->Save(dest);
+    }
+
+    dest.WriteVLE(gidToCollisionShapeMapping_.Size());
+    for (HashMap<unsigned, Vector<SharedPtr<TileMapObject2D>>>::ConstIterator i = gidToCollisionShapeMapping_.Begin();
+         i != gidToCollisionShapeMapping_.End(); ++i)
+    {
+        dest.WriteU32(i->first_);
+        dest.WriteVLE(i->second_.Size());
+        for (const SharedPtr<TileMapObject2D>& object : i->second_)
+            TmxObjectGroup2D::WriteObject(dest, object);
+    }
+
+    dest.WriteVLE(layers_.Size());
+    for (const TmxLayer2D* layer : layers_)
+    {
+        dest.WriteU8((u8)layer->GetType());
+        switch (layer->GetType())
+        {
+        case LT_TILE_LAYER:
+            static_cast<const TmxTileLayer2D*>(layer)->SaveBinary(dest);
+            break;
+
+        case LT_OBJECT_GROUP:
+            static_cast<const TmxObjectGroup2D*>(layer)->SaveBinary(dest);
+            break;
+
+        case LT_IMAGE_LAYER:
+            static_cast<const TmxImageLayer2D*>(layer)->SaveBinary(dest);
+            break;
+
+        default: break;
+        }
+    }
+
+    return true;
+}
+
+bool TmxFile2D::DecodeTileLayers(const XMLElement& rootElem)
+{
+    Vector<XMLElement> layerElems;
+    for (XMLElement layerElem = rootElem.GetChild("layer"); layerElem; layerElem = layerElem.GetNext("layer"))
+        layerElems.Push(layerElem);
+
+    loadTileLayerGids_.Clear();
+    loadTileLayerGids_.Resize(layerElems.Size());
+
+    // XML access stays on this thread, only the CSV and Base64 text is decoded in the worker threads
+    Vector<TileLayerData> layers(layerElems.Size());
+    i32 numTextLayers = 0;
+    for (i32 i = 0; i < layerElems.Size(); ++i)
+    {
+        layers[i].gids_ = &loadTileLayerGids_[i];
+        layers[i].success_ = true;
+        if (!ReadTileLayerData(layerElems[i], layers[i]))
+            return false;
+        if (layers[i].encoding_ != XML)
+            ++numTextLayers;
+    }
+
+    // Background loading decodes serially, as the work queue can only be completed from the main thread
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (numTextLayers > 1 && queue)
+        queue->RunParallel(DecodeTileLayerWork, layers.Buffer(), layers.Size(), layers.Size());
+    else
+    {
+        for (TileLayerData& layer : layers)
+        {
+            if (layer.encoding_ != XML)
+                layer.success_ = DecodeTileLayerText(layer);
+        }
+    }
+
+    for (const TileLayerData& layer : layers)
+    {
+        if (!layer.success_)
+            return false;
     }
 
-    loadXMLFile_.Reset();
-    tsxXMLFiles_.Clear();
     return true;
 }
 
@@ -584,11 +1442,13 @@ SharedPtr<XMLFile> TmxFile2D::LoadTSXFile(const String& source)
         return SharedPtr<XMLFile>();
     }
 
+    if (!tsxFileNames_.Contains(tsxFilePath))
+        tsxFileNames_.Push(tsxFilePath);
     return tsxXMLFile;
 }
 
 struct TileImageInfo {
-    Image* image;
+    String imageName;
     unsigned tileGid;
     int imageWidth;
     int imageHeight;
@@ -690,7 +1550,7 @@ bool TmxFile2D::LoadTileSet(const XMLElement& element)
                 }
                 tileWidth = imageWidth = imageElem.GetI32("width");
                 tileHeight = imageHeight = imageElem.GetI32("height");
-                TileImageInfo info = {image, gid, imageWidth, imageHeight, 0, 0};
+                TileImageInfo info = {textureFilePath, gid, imageWidth, imageHeight, 0, 0};
                 tileImageInfos.Push(info);
             }
         }
@@ -736,35 +1596,63 @@ bool TmxFile2D::LoadTileSet(const XMLElement& element)
             }
         }
 
-        SharedPtr<Texture2D> texture(new Texture2D(context_));
-        texture->SetMipsToSkip(QUALITY_LOW, 0);
-        texture->SetNumLevels(1);
-        texture->SetSize(allocator.GetWidth(), allocator.GetHeight(), Graphics::GetRGBAFormat());
-
-        auto textureDataSize = (unsigned)allocator.GetWidth() * allocator.GetHeight() * 4;
-        SharedArrayPtr<unsigned char> textureData(new unsigned char[textureDataSize]);
-        memset(textureData.Get(), 0, textureDataSize);
+        TileAtlas atlas;
+        atlas.size_ = IntVector2(allocator.GetWidth(), allocator.GetHeight());
+        for (const TileImageInfo& info : tileImageInfos)
+            atlas.images_.Push(MakePair(info.imageName, IntVector2(info.x, info.y)));
+        if (!CreateTileAtlasTexture(atlas))
+            return false;
 
-        for (int i = 0; i < tileImageInfos.Size(); ++i)
+        for (const TileImageInfo& info : tileImageInfos)
         {
-            TileImageInfo& info = tileImageInfos[i];
-            SharedPtr<Image> image = info.image->ConvertToRGBA();
-
-            for (int y = 0; y < image->GetHeight(); ++y)
-            {
-                memcpy(textureData.Get() + ((info.y + y) * allocator.GetWidth() + info.x) * 4,
-                    image->GetData() + y * image->GetWidth() * 4, (size_t)image->GetWidth() * 4);
-            }
-
             SharedPtr<Sprite2D> sprite(new Sprite2D(context_));
-            sprite->SetTexture(texture);
+            sprite->SetTexture(atlas.texture_);
             sprite->SetRectangle(IntRect(info.x, info.y, info.x + info.imageWidth, info.y + info.imageHeight));
             sprite->SetHotSpot(Vector2::ZERO);
             gidToSpriteMapping_[info.tileGid] = sprite;
         }
-        texture->SetData(0, 0, 0, allocator.GetWidth(), allocator.GetHeight(), textureData.Get());
+
+        tileAtlases_.Push(atlas);
+    }
+
+    return true;
+}
+
+bool TmxFile2D::CreateTileAtlasTexture(TileAtlas& atlas)
+{
+    SharedPtr<Texture2D> texture(new Texture2D(context_));
+    texture->SetMipsToSkip(QUALITY_LOW, 0);
+    texture->SetNumLevels(1);
+    texture->SetSize(atlas.size_.x_, atlas.size_.y_, Graphics::GetRGBAFormat());
+
+    auto textureDataSize = (unsigned)atlas.size_.x_ * atlas.size_.y_ * 4;
+    SharedArrayPtr<unsigned char> textureData(new unsigned char[textureDataSize]);
+    memset(textureData.Get(), 0, textureDataSize);
+
+    auto* cache = GetSubsystem<ResourceCache>();
+    for (const Pair<String, IntVector2>& atlasImage : atlas.images_)
+    {
+        SharedPtr<Image> image(cache->GetResource<Image>(atlasImage.first_));
+        if (!image)
+        {
+            URHO3D_LOGERROR("Could not load image " + atlasImage.first_);
+            return false;
+        }
+        image = image->ConvertToRGBA();
+
+        // Images larger than the size given in the tile set are cut to the atlas
+        const IntVector2& position = atlasImage.second_;
+        int width = Min(image->GetWidth(), atlas.size_.x_ - position.x_);
+        int height = Min(image->GetHeight(), atlas.size_.y_ - position.y_);
+        for (int y = 0; y < height; ++y)
+        {
+            memcpy(textureData.Get() + ((position.y_ + y) * atlas.size_.x_ + position.x_) * 4,
+                image->GetData() + y * image->GetWidth() * 4, (size_t)Max(width, 0) * 4);
+        }
     }
 
+    texture->SetData(0, 0, 0, atlas.size_.x_, atlas.size_.y_, textureData.Get());
+    atlas.texture_ = texture;
     return true;
 }
 
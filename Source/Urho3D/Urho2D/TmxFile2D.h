@@ -9,6 +9,8 @@
 namespace Urho3D
 {
 
+class Deserializer;
+class Serializer;
 class Sprite2D;
 class Texture2D;
 class TmxFile2D;
@@ -51,6 +53,10 @@ protected:
     void LoadInfo(const XMLElement& element);
     /// Load property set.
     void LoadPropertySet(const XMLElement& element);
+    /// Load layer info and property set from compiled binary data.
+    void LoadInfo(Deserializer& source);
+    /// Save layer info and property set to compiled binary data.
+    void SaveInfo(Serializer& dest) const;
 
     /// Tmx file.
     WeakPtr<TmxFile2D> tmxFile_;
@@ -76,10 +82,22 @@ public:
 
     /// Load from XML element.
     bool Load(const XMLElement& element, const TileMapInfo2D& info);
+    /// Load from XML element with the tile data already decoded by DecodeTileData().
+    bool Load(const XMLElement& element, const Vector<u32>& gids);
+    /// Load from compiled binary data.
+    bool LoadBinary(Deserializer& source);
+    /// Save to compiled binary data.
+    void SaveBinary(Serializer& dest) const;
     /// Return tile.
     Tile2D* GetTile(int x, int y) const;
 
+    /// Decode the tile GIDs of a layer element in row order. Does not touch the tmx file, so may be called from worker threads. Return true if successful.
+    static bool DecodeTileData(const XMLElement& element, Vector<u32>& gids);
+
 protected:
+    /// Create the tiles from GIDs in row order.
+    void SetTiles(const Vector<u32>& gids);
+
     /// Tiles.
     Vector<SharedPtr<Tile2D>> tiles_;
 };
@@ -93,8 +111,17 @@ public:
     /// Load from XML element.
     bool Load(const XMLElement& element, const TileMapInfo2D& info);
 
+    /// Load from compiled binary data.
+    bool LoadBinary(Deserializer& source);
+    /// Save to compiled binary data.
+    void SaveBinary(Serializer& dest) const;
+
     /// Store object.
     void StoreObject(const XMLElement& objectElem, const SharedPtr<TileMapObject2D>& object, const TileMapInfo2D& info, bool isTile = false);
+    /// Read object from compiled binary data. Return true if successful.
+    bool ReadObject(Deserializer& source, TileMapObject2D* object);
+    /// Write object to compiled binary data.
+    static void WriteObject(Serializer& dest, const TileMapObject2D* object);
 
     /// Return number of objects.
     unsigned GetNumObjects() const { return objects_.Size(); }
@@ -115,6 +142,10 @@ public:
 
     /// Load from XML element.
     bool Load(const XMLElement& element, const TileMapInfo2D& info);
+    /// Load from compiled binary data.
+    bool LoadBinary(Deserializer& source);
+    /// Save to compiled binary data.
+    void SaveBinary(Serializer& dest) const;
 
     /// Return position.
     const Vector2& GetPosition() const { return position_; }
@@ -126,6 +157,9 @@ public:
     Sprite2D* GetSprite() const;
 
 private:
+    /// Create the sprite from the source image.
+    bool LoadSprite();
+
     /// Position.
     Vector2 position_;
     /// Source.
@@ -153,6 +187,9 @@ public:
     /// Finish resource loading. Always called from the main thread. Return true if successful.
     bool EndLoad() override;
 
+    /// Save to compiled binary data, which loads without XML parsing or tile data decoding. The source hash is used by the compiled resource cache to detect changes. Return true if successful.
+    bool SaveBinary(Serializer& dest, hash32 sourceHash = 0, i32 sourceSize = 0) const;
+
     /// Set Tilemap information.
     bool SetInfo(Orientation2D orientation, int width, int height, float tileWidth, float tileHeight);
 
@@ -189,13 +226,52 @@ public:
     float GetSpriteTextureEdgeOffset() const { return edgeOffset_; }
 
 private:
+    /// Texture atlas built from the separate images of a tile set.
+    struct TileAtlas
+    {
+        /// Texture.
+        SharedPtr<Texture2D> texture_;
+        /// Texture size.
+        IntVector2 size_;
+        /// Resource names of the images and their positions in the texture.
+        Vector<Pair<String, IntVector2>> images_;
+    };
+
+    /// Helper function for loading XML files.
+    bool BeginLoadXML(Deserializer& source);
+    /// Helper function for loading compiled binary files.
+    bool BeginLoadBinary(Deserializer& source);
+    /// Load from the compiled resource cache if it matches the source and its TSX files. Otherwise load the source and remember to write the cache in EndLoad().
+    bool BeginLoadCached(Deserializer& source, const String& cacheFileName);
+    /// Finish loading from XML.
+    bool EndLoadXML();
+    /// Finish loading from compiled binary data.
+    bool LoadBinary(Deserializer& source);
+    /// Decode the data of all tile layers, in parallel when called from the main thread.
+    bool DecodeTileLayers(const XMLElement& rootElem);
     /// Load TSX file.
     SharedPtr<XMLFile> LoadTSXFile(const String& source);
     /// Load tile set.
     bool LoadTileSet(const XMLElement& element);
+    /// Create the texture of a tile atlas from its images.
+    bool CreateTileAtlasTexture(TileAtlas& atlas);
 
     /// XML file used during loading.
     SharedPtr<XMLFile> loadXMLFile_;
+    /// Decoded data of the XML tile layers in document order, used during loading.
+    Vector<Vector<u32>> loadTileLayerGids_;
+    /// Compiled binary data used during loading.
+    Vector<byte> loadBinaryData_;
+    /// Compiled cache file to write after loading from XML, empty if none.
+    String saveCacheFileName_;
+    /// Hash of the source data for the compiled cache.
+    hash32 sourceHash_{};
+    /// Size of the source data for the compiled cache.
+    i32 sourceSize_{};
+    /// Resource names of the TSX files used, for validating the compiled cache.
+    Vector<String> tsxFileNames_;
+    /// Tile atlases of image collection tile sets.
+    Vector<TileAtlas> tileAtlases_;
     /// TSX name to XML file mapping.
     HashMap<String, SharedPtr<XMLFile>> tsxXMLFiles_;
     /// Tile map information.